@@ -179,6 +179,23 @@ float2 ndc_to_uv(float3 x)
     return x.xy * float2(0.5f, -0.5f) + 0.5f;
 }
 
+/*------------------------------------------------------------------------------
+    SKINNING
+------------------------------------------------------------------------------*/
+#if SKINNED
+// The weighted bones of a vertex, they take packed positions to model space (the vertex transform of the model is part of every bone)
+matrix skin_transform(float4 bone_indices, float4 bone_weights)
+{
+    uint4 index = (uint4)(bone_indices * 255.0f + 0.5f) + g_bone_offset;
+
+    return
+        bones[index.x] * bone_weights.x +
+        bones[index.y] * bone_weights.y +
+        bones[index.z] * bone_weights.z +
+        bones[index.w] * bone_weights.w;
+}
+#endif
+
 /*------------------------------------------------------------------------------
     NORMAL
 ------------------------------------------------------------------------------*/
@@ -187,6 +204,15 @@ float3 normal_decode(float3 normal)  { return normalize(normal); }
 // No encoding required (just normalise)
 float3 normal_encode(float3 normal)  { return normalize(normal); }
 
+// Vertex normals and tangents are octahedral encoded
+float3 octahedral_decode(float2 value)
+{
+    float3 direction = float3(value.x, value.y, 1.0f - abs(value.x) - abs(value.y));
+    float fold       = saturate(-direction.z);
+    direction.xy     += direction.xy >= 0.0f ? -fold : fold;
+    return normalize(direction);
+}
+
 float3 get_normal(uint2 pos)
 {
     return tex_normal[pos].xyz;
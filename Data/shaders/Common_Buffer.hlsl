@@ -95,7 +95,10 @@ cbuffer BufferUber : register(b2)
     float g_mat_id;
     float g_mip_index;
     float g_is_transprent_pass;
-    float g_padding2;
+    float g_mat_bindless_index;
+
+    uint g_bone_offset;
+    uint3 g_padding;
 };
 
 // High frequency - Updates per light
@@ -108,3 +111,61 @@ cbuffer LightBuffer : register(b3)
     float4 cb_light_position;
     float4 cb_light_direction;
 };
+
+// Low frequency - Updates once per frame
+static const uint g_cluster_max_lights  = 128;
+static const uint g_cluster_count       = 16 * 8 * 24;
+static const uint g_cluster_max_indices = 16384;
+cbuffer LightClustersBuffer : register(b4)
+{
+    float4 cb_clusters_params; // x: slice scale, y: slice bias, z: directional light count, w: light count
+    float4 cb_clusters_position_range[g_cluster_max_lights];
+    float4 cb_clusters_color_intensity[g_cluster_max_lights];
+    float4 cb_clusters_direction_angle[g_cluster_max_lights];
+    uint4 cb_clusters_flags[g_cluster_max_lights / 4];
+    uint4 cb_clusters_offset_count[g_cluster_count / 4];
+    uint4 cb_clusters_indices[g_cluster_max_indices / 16];
+};
+
+#if BINDLESS
+// Bindless - Every material drawn this frame, looked up by index (must match RHI_BindlessMaterial)
+static const uint g_bindless_index_invalid = 0xFFFFFFFF;
+struct BindlessMaterial
+{
+    float4 color;
+    float2 tiling;
+    float2 offset;
+    float roughness;
+    float metallic;
+    float normal;
+    float height;
+    uint4 textures_0; // albedo, roughness, metallic, normal
+    uint4 textures_1; // height, occlusion, emission, mask
+};
+[[vk::binding(1, 1)]] StructuredBuffer<BindlessMaterial> bindless_materials;
+#endif
+
+#if INDIRECT
+// GPU-driven drawing - Every instance of the pass (must match BufferInstance)
+struct Instance
+{
+    matrix transform;
+    matrix transform_previous;
+    float3 aabb_min;
+    uint index_count;
+    float3 aabb_max;
+    uint index_offset;
+    int vertex_offset;
+    uint batch;
+    uint batch_offset;
+    uint mat_id;
+    uint mat_bindless_index;
+    uint3 padding;
+};
+StructuredBuffer<Instance> instances : register(t35);
+#endif
+
+#if SKINNED
+// GPU skinning - The bones of every animator of the frame, an animator's start at g_bone_offset
+StructuredBuffer<matrix> bones : register(t36);
+#endif
@@ -134,10 +134,10 @@ struct Light
         return attenuation * attenuation;
     }
 
-    // Attenuation over angle (approaching the outer cone)
-    float compute_attenuation_angle(const float3 direction)
+    // Attenuation over the angle between the spot's axis and the pixel (approaching the outer cone), expects the direction to the pixel to be computed
+    float compute_attenuation_angle(const float3 spot_direction)
     {
-        float light_dot_pixel   = dot(direction, direction);
+        float light_dot_pixel   = dot(direction, normalize(spot_direction));
         float cutoffAngle       = 1.0f - angle;
         float epsilon           = cutoffAngle - cutoffAngle * 0.9f;
         float attenuation       = saturate((light_dot_pixel - cutoffAngle) / epsilon);
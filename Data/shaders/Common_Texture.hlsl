@@ -29,6 +29,11 @@ Texture2D tex_material_occlusion        : register (t5);
 Texture2D tex_material_emission         : register (t6);
 Texture2D tex_material_mask             : register (t7);
 
+// Bindless material textures (indexed by BindlessMaterial)
+#if BINDLESS
+[[vk::binding(0, 1)]] Texture2D bindless_textures[];
+#endif
+
 // G-buffer
 Texture2D tex_albedo                    : register(t8);
 Texture2D tex_normal                    : register(t9);
@@ -22,6 +22,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 struct Vertex_Pos
 {
     float4 position : POSITION0;
+    #if SKINNED
+    float4 bones    : BLENDINDICES0;
+    float4 weights  : BLENDWEIGHT0;
+    #endif
 };
 
 struct Vertex_PosUv
@@ -36,12 +40,18 @@ struct Vertex_PosColor
     float4 color    : COLOR0;
 };
 
+// Packed (see RHI_Vertex_PosTexNorTan_Packed), the position is relative to the model bounds
+// and is transformed back by the transform, the normal and the tangent are octahedral encoded.
+// Skinned, the bones (indices, stored as unorm) and their weights follow (see RHI_Vertex_PosTexNorTanSkin_Packed).
 struct Vertex_PosUvNorTan
 {
-    float4 position     : POSITION0;
-    float2 uv           : TEXCOORD0;
-    float3 normal       : NORMAL0;
-    float3 tangent      : TANGENT0;
+    float4 position         : POSITION0;
+    float2 uv               : TEXCOORD0;
+    float4 normal_tangent   : NORMAL0;
+    #if SKINNED
+    float4 bones            : BLENDINDICES0;
+    float4 weights          : BLENDWEIGHT0;
+    #endif
 };
 
 struct Vertex_Pos2dUvColor
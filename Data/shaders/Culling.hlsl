@@ -0,0 +1,100 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES =========
+#include "Common.hlsl"
+//====================
+
+// Must match RHI_DrawIndexedIndirectArguments
+struct DrawArguments
+{
+    uint index_count;
+    uint instance_count;
+    uint index_offset;
+    int vertex_offset;
+    uint instance_offset;
+};
+
+RWStructuredBuffer<DrawArguments> indirect_arguments    : register(u7);
+RWStructuredBuffer<uint> indirect_count                 : register(u8);
+
+// Tests a world space box against the planes of the view frustum, the box is
+// only rejected when it's entirely behind one of them (so it's conservative).
+bool is_in_view_frustum(float3 aabb_min, float3 aabb_max)
+{
+    // Extract the planes from the view projection (the rows of the transpose are the columns of the matrix)
+    float4x4 m = transpose(g_view_projection);
+    float4 planes[6] =
+    {
+        m[3] + m[0], // left
+        m[3] - m[0], // right
+        m[3] + m[1], // bottom
+        m[3] - m[1], // top
+        m[2],        // near or far (depending on reverse-z)
+        m[3] - m[2]  // far or near
+    };
+
+    [unroll]
+    for (uint i = 0; i < 6; i++)
+    {
+        // The corner which is the furthest along the plane normal
+        float3 corner = float3
+        (
+            planes[i].x >= 0.0f ? aabb_max.x : aabb_min.x,
+            planes[i].y >= 0.0f ? aabb_max.y : aabb_min.y,
+            planes[i].z >= 0.0f ? aabb_max.z : aabb_min.z
+        );
+
+        if (dot(planes[i].xyz, corner) + planes[i].w < 0.0f)
+            return false;
+    }
+
+    return true;
+}
+
+[numthreads(64, 1, 1)]
+void mainCS(uint3 thread_id : SV_DispatchThreadID)
+{
+    // The buffer range covers exactly the instances of this frame
+    uint instance_count, stride;
+    instances.GetDimensions(instance_count, stride);
+
+    const uint instance_index = thread_id.x;
+    if (instance_index >= instance_count)
+        return;
+
+    Instance instance = instances[instance_index];
+    if (!is_in_view_frustum(instance.aabb_min, instance.aabb_max))
+        return;
+
+    // Append a draw to the model's range of arguments
+    uint draw_index;
+    InterlockedAdd(indirect_count[instance.batch], 1, draw_index);
+
+    DrawArguments arguments;
+    arguments.index_count       = instance.index_count;
+    arguments.instance_count    = 1;
+    arguments.index_offset      = instance.index_offset;
+    arguments.vertex_offset     = instance.vertex_offset;
+    arguments.instance_offset   = instance_index; // SV_InstanceID starts from here, so the vertex shader can find the instance
+    indirect_arguments[instance.batch_offset + draw_index] = arguments;
+}
@@ -23,16 +23,46 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Common.hlsl"
 //====================
 
+#if POSITION_ONLY
+// Opaque objects only need the position stream
+Pixel_Pos mainVS(Vertex_Pos input)
+{
+    Pixel_Pos output;
+
+    #if SKINNED
+    matrix transform    = mul(skin_transform(input.bones, input.weights), g_transform);
+    #else
+    matrix transform    = g_transform;
+    #endif
+
+    input.position.w    = 1.0f;
+    output.position     = mul(input.position, transform);
+
+    return output;
+}
+#else
+// Skinned vertices carry the normal and tangent before the bones, so the full layout has to be declared
+#if SKINNED
+Pixel_PosUv mainVS(Vertex_PosUvNorTan input)
+#else
 Pixel_PosUv mainVS(Vertex_PosUv input)
+#endif
 {
     Pixel_PosUv output;
 
+    #if SKINNED
+    matrix transform    = mul(skin_transform(input.bones, input.weights), g_transform);
+    #else
+    matrix transform    = g_transform;
+    #endif
+
     input.position.w    = 1.0f; 
-    output.position     = mul(input.position, g_transform);
+    output.position     = mul(input.position, transform);
     output.uv           = input.uv;
 
     return output;
 }
+#endif
 
 // Translucent shadows
 float4 mainPS(Pixel_PosUv input) : SV_TARGET
@@ -35,10 +35,16 @@ PixelInputType mainVS(Vertex_PosUvNorTan input)
 {
     PixelInputType output;
 
+    #if SKINNED
+    matrix transform    = mul(skin_transform(input.bones, input.weights), g_transform);
+    #else
+    matrix transform    = g_transform;
+    #endif
+
     input.position.w    = 1.0f;
-    output.positionWS   = mul(input.position, g_transform).xyz;
+    output.positionWS   = mul(input.position, transform).xyz;
     output.position     = mul(float4(output.positionWS, 1.0f), g_view_projection_unjittered);
-    output.normal       = mul(input.normal, (float3x3)g_transform);
+    output.normal       = mul(octahedral_decode(input.normal_tangent.xy), (float3x3)transform);
     output.uv           = input.uv;
 
     return output;
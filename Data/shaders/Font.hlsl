@@ -23,6 +23,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Common.hlsl"
 //====================
 
+// The outline color and the distance field thresholds which the outline spans, the fill is above the second one
+#define g_font_color_outline        g_mat_color
+#define g_font_outline_thresholds   g_mat_tiling
+
 Pixel_PosUv mainVS(Vertex_PosUv input)
 {
     Pixel_PosUv output;
@@ -36,16 +40,16 @@ Pixel_PosUv mainVS(Vertex_PosUv input)
 
 float4 mainPS(Pixel_PosUv input) : SV_TARGET
 {
-    float4 color = float4(0.0f, 0.0f, 0.0f, 1.0f);
-    
-    // Sample text from texture atlas
-    color.r = tex_font_atlas.Sample(sampler_bilinear_wrap, input.uv).r;
-    color.g = color.r;
-    color.b = color.r;
-    color.a = color.r;
-    
-    // Color it
-    color *= g_color;
+    // Signed distance field, 0.5 is the edge of the glyph
+    float distance  = tex_font_atlas.Sample(sampler_bilinear_clamp, input.uv).r;
+    float width     = max(fwidth(distance) * 0.5f, 0.0001f);
+
+    float outline   = smoothstep(g_font_outline_thresholds.x - width, g_font_outline_thresholds.x + width, distance);
+    float fill      = smoothstep(g_font_outline_thresholds.y - width, g_font_outline_thresholds.y + width, distance);
+
+    // The outline is under the fill, without one both thresholds are the same
+    float4 color = lerp(g_font_color_outline, g_color, fill);
+    color.a *= outline;
     
     return color;
 }
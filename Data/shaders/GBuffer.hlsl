@@ -29,6 +29,9 @@ struct PixelInputType
     float3 tangent              : TANGENT;
     float4 position_ss_current  : SCREEN_POS;
     float4 position_ss_previous : SCREEN_POS_PREVIOUS;
+    #if INDIRECT
+    nointerpolation uint2 material : MATERIAL; // id, bindless index
+    #endif
 };
 
 struct PixelOutputType
@@ -39,35 +42,97 @@ struct PixelOutputType
     float2 velocity : SV_Target3;
 };
 
+#if INDIRECT
+PixelInputType mainVS(Vertex_PosUvNorTan input, uint instance_id : SV_InstanceID)
+#else
 PixelInputType mainVS(Vertex_PosUvNorTan input)
+#endif
 {
     PixelInputType output;
+
+    // Indirect draws read everything which is per object from the instance buffer
+    #if INDIRECT
+    Instance instance           = instances[instance_id];
+    matrix transform            = instance.transform;
+    matrix transform_previous   = instance.transform_previous;
+    output.material             = uint2(instance.mat_id, instance.mat_bindless_index);
+    #else
+    matrix transform            = g_transform;
+    matrix transform_previous   = g_transform_previous;
+    #endif
+
+    // Skinned on the GPU, the bones take the vertex to model space first
+    #if SKINNED
+    matrix skin                 = skin_transform(input.bones, input.weights);
+    transform                   = mul(skin, transform);
+    transform_previous          = mul(skin, transform_previous);
+    #endif
     
     input.position.w            = 1.0f;
-    output.position             = mul(input.position, g_transform);
+    output.position             = mul(input.position, transform);
     output.position             = mul(output.position, g_view_projection);
     output.position_ss_current  = output.position;
-    output.position_ss_previous = mul(input.position, g_transform_previous);
+    output.position_ss_previous = mul(input.position, transform_previous);
     output.position_ss_previous = mul(output.position_ss_previous, g_view_projection_previous);
-    output.normal               = normalize(mul(input.normal, (float3x3)g_transform)).xyz;
-    output.tangent              = normalize(mul(input.tangent, (float3x3)g_transform)).xyz;
+    output.normal               = normalize(mul(octahedral_decode(input.normal_tangent.xy), (float3x3)transform)).xyz;
+    output.tangent              = normalize(mul(octahedral_decode(input.normal_tangent.zw), (float3x3)transform)).xyz;
     output.uv                   = input.uv;
     
     return output;
 }
 
+// Material textures are either bound to their own slots or, when bindless, looked up by index
+#if BINDLESS
+#define HAS_TEXTURE(index)          (index != g_bindless_index_invalid)
+#define MATERIAL_TEXTURE(index, tex) bindless_textures[NonUniformResourceIndex(index)]
+#else
+#define HAS_TEXTURE(index)          true
+#define MATERIAL_TEXTURE(index, tex) tex
+#endif
+
 PixelOutputType mainPS(PixelInputType input)
 {
     PixelOutputType g_buffer;
 
-    float2 uv           = float2(input.uv.x * g_mat_tiling.x + g_mat_offset.x, input.uv.y * g_mat_tiling.y + g_mat_offset.y);
-    float4 albedo       = g_mat_color;
-    float roughness     = g_mat_roughness;
-    float metallic      = g_mat_metallic;
+    #if INDIRECT
+    float mat_id                = (float)input.material.x;
+    uint mat_bindless_index     = input.material.y;
+    #else
+    float mat_id                = g_mat_id;
+    uint mat_bindless_index     = (uint)g_mat_bindless_index;
+    #endif
+
+    #if BINDLESS
+    BindlessMaterial material   = bindless_materials[mat_bindless_index];
+    float4 mat_color            = material.color;
+    float2 mat_tiling           = material.tiling;
+    float2 mat_offset           = material.offset;
+    float mat_roughness         = material.roughness;
+    float mat_metallic          = material.metallic;
+    float mat_normal            = material.normal;
+    float mat_height            = material.height;
+    uint4 mat_textures_0        = material.textures_0;
+    uint4 mat_textures_1        = material.textures_1;
+    #else
+    float4 mat_color            = g_mat_color;
+    float2 mat_tiling           = g_mat_tiling;
+    float2 mat_offset           = g_mat_offset;
+    float mat_roughness         = g_mat_roughness;
+    float mat_metallic          = g_mat_metallic;
+    float mat_normal            = g_mat_normal;
+    float mat_height            = g_mat_height;
+    uint4 mat_textures_0        = 0;
+    uint4 mat_textures_1        = 0;
+    #endif
+
+    float2 uv           = float2(input.uv.x * mat_tiling.x + mat_offset.x, input.uv.y * mat_tiling.y + mat_offset.y);
+    float4 albedo       = mat_color;
+    float roughness     = mat_roughness;
+    float metallic      = mat_metallic;
     float3 normal       = input.normal.xyz;
     float emission      = 0.0f;
     float occlusion     = 1.0f;
-    float material_id   = g_mat_id / float(FLT_MAX_16);
+    float material_id   = mat_id / float(FLT_MAX_16);
     
     // Velocity
     float2 position_current     = (input.position_ss_current.xy / input.position_ss_current.w);
@@ -81,52 +146,76 @@ PixelOutputType mainPS(PixelInputType input)
     #endif
 
     #if HEIGHT_MAP
+    if (HAS_TEXTURE(mat_textures_1.x))
+    {
         // Parallax Mapping
-        float height_scale      = g_mat_height * 0.04f;
+        float height_scale      = mat_height * 0.04f;
         float3 camera_to_pixel  = normalize(g_camera_position - input.position.xyz);
-        uv                      = ParallaxMapping(tex_material_height, sampler_anisotropic_wrap, uv, camera_to_pixel, TBN, height_scale);
+        uv                      = ParallaxMapping(MATERIAL_TEXTURE(mat_textures_1.x, tex_material_height), sampler_anisotropic_wrap, uv, camera_to_pixel, TBN, height_scale);
+    }
     #endif
     
     float mask_threshold = 0.6f;
     
     #if MASK_MAP
-        float3 maskSample = tex_material_mask.Sample(sampler_anisotropic_wrap, uv).rgb;
+    if (HAS_TEXTURE(mat_textures_1.w))
+    {
+        float3 maskSample = MATERIAL_TEXTURE(mat_textures_1.w, tex_material_mask).Sample(sampler_anisotropic_wrap, uv).rgb;
         if (maskSample.r <= mask_threshold && maskSample.g <= mask_threshold && maskSample.b <= mask_threshold)
             discard;
+    }
     #endif
 
     #if ALBEDO_MAP
-        float4 albedo_sample = tex_material_albedo.Sample(sampler_anisotropic_wrap, uv);
+    if (HAS_TEXTURE(mat_textures_0.x))
+    {
+        float4 albedo_sample = MATERIAL_TEXTURE(mat_textures_0.x, tex_material_albedo).Sample(sampler_anisotropic_wrap, uv);
         if (albedo_sample.a <= mask_threshold)
             discard;
 
         albedo_sample.a     = 1.0f;
         albedo_sample.rgb   = degamma(albedo_sample.rgb);
         albedo              *= albedo_sample;
+    }
     #endif
     
     #if ROUGHNESS_MAP
-        roughness *= tex_material_roughness.Sample(sampler_anisotropic_wrap, uv).r;
+    if (HAS_TEXTURE(mat_textures_0.y))
+    {
+        roughness *= MATERIAL_TEXTURE(mat_textures_0.y, tex_material_roughness).Sample(sampler_anisotropic_wrap, uv).r;
+    }
     #endif
     
     #if METALLIC_MAP
-        metallic *= tex_material_metallic.Sample(sampler_anisotropic_wrap, uv).r;
+    if (HAS_TEXTURE(mat_textures_0.z))
+    {
+        metallic *= MATERIAL_TEXTURE(mat_textures_0.z, tex_material_metallic).Sample(sampler_anisotropic_wrap, uv).r;
+    }
     #endif
     
     #if NORMAL_MAP
+    if (HAS_TEXTURE(mat_textures_0.w))
+    {
         // Get tangent space normal and apply intensity
-        float3 tangent_normal   = normalize(unpack(tex_material_normal.Sample(sampler_anisotropic_wrap, uv).rgb));
-        float normal_intensity  = clamp(g_mat_normal, 0.012f, g_mat_normal);
+        float3 tangent_normal   = normalize(unpack(MATERIAL_TEXTURE(mat_textures_0.w, tex_material_normal).Sample(sampler_anisotropic_wrap, uv).rgb));
+        float normal_intensity  = clamp(mat_normal, 0.012f, mat_normal);
         tangent_normal.xy       *= saturate(normal_intensity);
         normal                  = normalize(mul(tangent_normal, TBN).xyz); // Transform to world space
+    }
     #endif
 
     #if OCCLUSION_MAP
-        occlusion = tex_material_occlusion.Sample(sampler_anisotropic_wrap, uv).r;
+    if (HAS_TEXTURE(mat_textures_1.y))
+    {
+        occlusion = MATERIAL_TEXTURE(mat_textures_1.y, tex_material_occlusion).Sample(sampler_anisotropic_wrap, uv).r;
+    }
     #endif
     
     #if EMISSION_MAP
-        emission = luminance(tex_material_emission.Sample(sampler_anisotropic_wrap, uv).rgb);
+    if (HAS_TEXTURE(mat_textures_1.z))
+    {
+        emission = luminance(MATERIAL_TEXTURE(mat_textures_1.z, tex_material_emission).Sample(sampler_anisotropic_wrap, uv).rgb);
+    }
     #endif
 
     // Write to G-Buffer
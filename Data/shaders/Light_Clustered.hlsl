@@ -0,0 +1,215 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ======================
+#include "Common.hlsl"
+#include "BRDF.hlsl"
+#include "ScreenSpaceShadows.hlsl"
+//=================================
+
+// Must match LightClusters.h
+static const uint g_cluster_grid_x = 16;
+static const uint g_cluster_grid_y = 8;
+static const uint g_cluster_grid_z = 24;
+
+static const uint g_cluster_flag_spot                   = 1 << 0;
+static const uint g_cluster_flag_shadows_screen_space   = 1 << 1;
+
+uint get_cluster_flags(uint light_index)
+{
+    return cb_clusters_flags[light_index >> 2][light_index & 3];
+}
+
+uint get_cluster_offset_count(uint cluster_index)
+{
+    return cb_clusters_offset_count[cluster_index >> 2][cluster_index & 3];
+}
+
+// Light indices are 8-bit, packed four per uint
+uint get_cluster_light_index(uint i)
+{
+    uint packed = cb_clusters_indices[i >> 4][(i >> 2) & 3];
+    return (packed >> ((i & 3) * 8)) & 0xFF;
+}
+
+uint get_cluster_index(Surface surface)
+{
+    uint2 tile  = min(uint2(surface.uv * float2(g_cluster_grid_x, g_cluster_grid_y)), uint2(g_cluster_grid_x - 1, g_cluster_grid_y - 1));
+    float z     = max(world_to_view(surface.position).z, g_camera_near);
+    uint slice  = (uint)clamp(log(z) * cb_clusters_params.x + cb_clusters_params.y, 0.0f, (float)(g_cluster_grid_z - 1));
+
+    return tile.x + tile.y * g_cluster_grid_x + slice * g_cluster_grid_x * g_cluster_grid_y;
+}
+
+Light build_light(Surface surface, uint light_index, bool is_directional)
+{
+    float4 position_range   = cb_clusters_position_range[light_index];
+    float4 color_intensity  = cb_clusters_color_intensity[light_index];
+    float4 direction_angle  = cb_clusters_direction_angle[light_index];
+
+    Light light;
+    light.color             = color_intensity.rgb;
+    light.intensity         = color_intensity.a;
+    light.position          = position_range.xyz;
+    light.far               = position_range.w;
+    light.near              = 0.1f;
+    light.angle             = direction_angle.w;
+    light.bias              = 0.0f;
+    light.normal_bias       = 0.0f;
+    light.array_size        = 1;
+    light.distance_to_pixel = length(surface.position - light.position);
+
+    if (is_directional)
+    {
+        light.direction     = normalize(direction_angle.xyz);
+        light.attenuation   = saturate(dot(-light.direction, float3(0.0f, 1.0f, 0.0f)));
+    }
+    else
+    {
+        light.direction     = normalize(surface.position - light.position);
+        light.attenuation   = light.compute_attenuation_distance(surface.position);
+
+        // Attenuation over the angle between the spot's axis and the pixel
+        if (get_cluster_flags(light_index) & g_cluster_flag_spot)
+        {
+            light.attenuation *= light.compute_attenuation_angle(direction_angle.xyz);
+        }
+    }
+
+    light.n_dot_l   = saturate(dot(surface.normal, -light.direction));
+    light.radiance  = light.color * light.intensity * light.attenuation * light.n_dot_l * surface.occlusion;
+
+    return light;
+}
+
+void accumulate_light(Surface surface, uint light_index, bool is_directional, inout float3 light_diffuse, inout float3 light_specular)
+{
+    Light light = build_light(surface, light_index, is_directional);
+
+    [branch]
+    if (!any(light.radiance))
+        return;
+
+    // Screen space shadows
+    float shadow = 1.0f;
+    if (get_cluster_flags(light_index) & g_cluster_flag_shadows_screen_space)
+    {
+        shadow = ScreenSpaceShadows(surface, light);
+    }
+
+    // Ensure that the shadow is as transparent as the material
+    if (g_is_transprent_pass)
+    {
+        shadow = clamp(shadow, surface.alpha, 1.0f);
+    }
+
+    light.radiance *= shadow;
+
+    // Compute some vectors and dot products
+    float3 l        = -light.direction;
+    float3 v        = -surface.camera_to_pixel;
+    float3 h        = normalize(v + l);
+    float l_dot_h   = saturate(dot(l, h));
+    float v_dot_h   = saturate(dot(v, h));
+    float n_dot_v   = saturate(dot(surface.normal, v));
+    float n_dot_h   = saturate(dot(surface.normal, h));
+
+    float3 diffuse_energy       = 1.0f;
+    float3 reflective_energy    = 1.0f;
+    float3 specular             = 0.0f;
+
+    // Specular
+    if (surface.anisotropic == 0.0f)
+    {
+        specular += BRDF_Specular_Isotropic(surface, n_dot_v, light.n_dot_l, n_dot_h, v_dot_h, diffuse_energy, reflective_energy);
+    }
+    else
+    {
+        specular += BRDF_Specular_Anisotropic(surface, v, l, h, n_dot_v, light.n_dot_l, n_dot_h, l_dot_h, diffuse_energy, reflective_energy);
+    }
+
+    // Specular clearcoat
+    if (surface.clearcoat != 0.0f)
+    {
+        specular += BRDF_Specular_Clearcoat(surface, n_dot_h, v_dot_h, diffuse_energy, reflective_energy);
+    }
+
+    // Sheen
+    if (surface.sheen != 0.0f)
+    {
+        specular += BRDF_Specular_Sheen(surface, n_dot_v, light.n_dot_l, n_dot_h, diffuse_energy, reflective_energy);
+    }
+
+    // Diffuse, toned down such as that only non metals have it
+    float3 diffuse = BRDF_Diffuse(surface, n_dot_v, light.n_dot_l, v_dot_h) * diffuse_energy;
+
+    light_diffuse   += diffuse * light.radiance;
+    light_specular  += specular * light.radiance;
+}
+
+// Shades all the unshadowed lights in a single dispatch.
+// Directional lights apply everywhere, point and spot lights are read from the cluster that the pixel falls into.
+[numthreads(thread_group_count_x, thread_group_count_y, 1)]
+void mainCS(uint3 thread_id : SV_DispatchThreadID)
+{
+    if (thread_id.x >= uint(g_resolution.x) || thread_id.y >= uint(g_resolution.y))
+        return;
+
+    // Create surface
+    Surface surface;
+    bool use_albedo = false; // we write out pure light color (just a choice)
+    surface.Build(thread_id.xy, use_albedo);
+
+    // If this is a transparent pass, ignore all opaque pixels, and vice versa.
+    if ((g_is_transprent_pass && surface.is_opaque()) || (!g_is_transprent_pass && surface.is_transparent()))
+        return;
+
+    float3 light_diffuse    = 0.0f;
+    float3 light_specular   = 0.0f;
+
+    [branch]
+    if (!surface.is_sky())
+    {
+        uint directional_count = (uint)cb_clusters_params.z;
+
+        // Directional lights
+        for (uint i = 0; i < directional_count; i++)
+        {
+            accumulate_light(surface, i, true, light_diffuse, light_specular);
+        }
+
+        // Point and spot lights of the cluster
+        uint offset_count   = get_cluster_offset_count(get_cluster_index(surface));
+        uint offset         = offset_count & 0xFFFF;
+        uint count          = offset_count >> 16;
+        for (uint j = 0; j < count; j++)
+        {
+            accumulate_light(surface, directional_count + get_cluster_light_index(offset + j), false, light_diffuse, light_specular);
+        }
+    }
+
+    // The per-light path adds the emissive once per light, so do the same to keep the composition identical
+    float3 emissive = surface.emissive * cb_clusters_params.w;
+
+    tex_out_rgb[thread_id.xy]   += saturate_16(light_diffuse + emissive);
+    tex_out_rgb2[thread_id.xy]  += saturate_16(light_specular);
+}
@@ -244,7 +244,6 @@ namespace ImGui::RHI
         pipeline_state.clear_color[0]           = clear ? Vector4(0.0f, 0.0f, 0.0f, 1.0f) : rhi_color_load;
         pipeline_state.viewport.width           = draw_data->DisplaySize.x;
         pipeline_state.viewport.height          = draw_data->DisplaySize.y;
-        pipeline_state.dynamic_scissor          = true;
         pipeline_state.primitive_topology       = RHI_PrimitiveTopology_TriangleList;
         pipeline_state.pass_name                = is_child_window ? "pass_imgui_window_child" : "pass_imgui_window_main";
 
@@ -427,6 +427,7 @@ void Widget_Properties::ShowRenderable(Renderable* renderable) const
         Material* material      = renderable->GetMaterial();
         string material_name    = material ? material->GetResourceName() : "N/A";
         bool cast_shadows       = renderable->GetCastShadows();
+        bool occluder           = renderable->IsOccluder();
         //=======================================================================
 
         ImGui::Text("Mesh");
@@ -449,8 +450,13 @@ void Widget_Properties::ShowRenderable(Renderable* renderable) const
         ImGui::Text("Cast Shadows");
         ImGui::SameLine(ComponentProperty::g_column); ImGui::Checkbox("##RenderableCastShadows", &cast_shadows);
 
+        // Occluder
+        ImGui::Text("Occluder");
+        ImGui::SameLine(ComponentProperty::g_column); ImGui::Checkbox("##RenderableOccluder", &occluder);
+
         //= MAP ===================================================================================
         if (cast_shadows != renderable->GetCastShadows()) renderable->SetCastShadows(cast_shadows);
+        if (occluder != renderable->IsOccluder())         renderable->SetOccluder(occluder);
         //=========================================================================================
     }
     ComponentProperty::End();
@@ -325,6 +325,13 @@ void Widget_RenderOptions::TickVisible()
         // Reflect from engine
         auto do_depth_prepass   = m_renderer->GetOption(Render_DepthPrepass);
         auto do_reverse_z       = m_renderer->GetOption(Render_ReverseZ);
+        auto do_occlusion       = m_renderer->GetOption(Render_OcclusionCulling);
+        auto do_clustered       = m_renderer->GetOption(Render_ClusteredLighting);
+        auto do_parallel        = m_renderer->GetOption(Render_ParallelRecording);
+        auto do_bindless        = m_renderer->GetOption(Render_Bindless);
+        auto do_gpu_driven      = m_renderer->GetOption(Render_GpuDriven);
+        auto do_async_compute   = m_renderer->GetOption(Render_AsyncCompute);
+        auto do_gpu_skinning    = m_renderer->GetOption(Render_GpuSkinning);
 
         {
             // Buffer
@@ -386,10 +393,38 @@ void Widget_RenderOptions::TickVisible()
 
             // Reverse-Z
             ImGui::Checkbox("Reverse-Z", &do_reverse_z);
+
+            // Occlusion culling
+            ImGui::Checkbox("Occlusion Culling", &do_occlusion);
+
+            // Clustered lighting
+            ImGui::Checkbox("Clustered Lighting", &do_clustered);
+
+            // Parallel recording
+            ImGui::Checkbox("Parallel Recording", &do_parallel);
+
+            // Bindless materials
+            ImGui::Checkbox("Bindless Materials", &do_bindless);
+
+            // GPU-driven drawing (opaque G-Buffer, requires bindless materials)
+            ImGui::Checkbox("GPU Driven", &do_gpu_driven);
+
+            // Async compute (SSAO, SSR and SSGI overlap shadow rendering)
+            ImGui::Checkbox("Async Compute", &do_async_compute);
+
+            // GPU skinning (animated meshes are skinned by the vertex shaders)
+            ImGui::Checkbox("GPU Skinning", &do_gpu_skinning);
         }
 
         // Map back to engine
         m_renderer->SetOption(Render_DepthPrepass, do_depth_prepass);
         m_renderer->SetOption(Render_ReverseZ, do_reverse_z);
+        m_renderer->SetOption(Render_OcclusionCulling, do_occlusion);
+        m_renderer->SetOption(Render_ClusteredLighting, do_clustered);
+        m_renderer->SetOption(Render_ParallelRecording, do_parallel);
+        m_renderer->SetOption(Render_Bindless, do_bindless);
+        m_renderer->SetOption(Render_GpuDriven, do_gpu_driven);
+        m_renderer->SetOption(Render_AsyncCompute, do_async_compute);
+        m_renderer->SetOption(Render_GpuSkinning, do_gpu_skinning);
     }
 }
@@ -58,6 +58,11 @@ namespace Spartan
                 LOG_ERROR("Failed to open \"%s\" for reading", path.c_str());
                 return;
             }
+
+            // Keep the size, so lengths read from the file can be validated
+            in.seekg(0, ios::end);
+            m_size = static_cast<uint64_t>(in.tellg());
+            in.seekg(0, ios::beg);
         }
 
         m_is_open = true;
@@ -142,11 +147,34 @@ namespace Spartan
         }
     }
 
+    uint64_t FileStream::GetRemaining()
+    {
+        if (!(m_flags & FileStream_Read) || in.fail())
+            return 0;
+
+        const streamoff position = in.tellg();
+        return position < 0 ? 0 : m_size - static_cast<uint64_t>(position);
+    }
+
+    bool FileStream::CanRead(const uint64_t size)
+    {
+        // A length which runs past the end of the file means it's corrupt, so fail the stream instead of allocating for it
+        if (size <= GetRemaining())
+            return true;
+
+        in.setstate(ios::failbit);
+        return false;
+    }
+
     void FileStream::Read(string* value)
     {
         uint32_t length = 0;
         Read(&length);
 
+        value->clear();
+        if (!CanRead(length))
+            return;
+
         value->resize(length);
         in.read(const_cast<char*>(value->c_str()), length);
     }
@@ -162,6 +190,10 @@ namespace Spartan
         uint32_t size = 0;
         Read(&size);
 
+        // Every string takes at least it's length
+        if (!CanRead(static_cast<uint64_t>(size) * sizeof(uint32_t)))
+            return;
+
         string str;
         for (uint32_t i = 0; i < size; i++)
         {
@@ -179,6 +211,8 @@ namespace Spartan
         vec->shrink_to_fit();
 
         const auto length = ReadAs<uint32_t>();
+        if (!CanRead(static_cast<uint64_t>(length) * sizeof(RHI_Vertex_PosTexNorTan)))
+            return;
 
         vec->reserve(length);
         vec->resize(length);
@@ -195,6 +229,8 @@ namespace Spartan
         vec->shrink_to_fit();
 
         const auto length = ReadAs<uint32_t>();
+        if (!CanRead(static_cast<uint64_t>(length) * sizeof(uint32_t)))
+            return;
 
         vec->reserve(length);
         vec->resize(length);
@@ -211,6 +247,8 @@ namespace Spartan
         vec->shrink_to_fit();
 
         const auto length = ReadAs<uint32_t>();
+        if (!CanRead(static_cast<uint64_t>(length) * sizeof(unsigned char)))
+            return;
 
         vec->reserve(length);
         vec->resize(length);
@@ -227,6 +265,8 @@ namespace Spartan
         vec->shrink_to_fit();
 
         const auto length = ReadAs<uint32_t>();
+        if (!CanRead(static_cast<uint64_t>(length) * sizeof(std::byte)))
+            return;
 
         vec->reserve(length);
         vec->resize(length);
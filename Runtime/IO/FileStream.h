@@ -49,6 +49,8 @@ namespace Spartan
         ~FileStream();
 
         auto IsOpen() const { return m_is_open; }
+        bool IsGood() const { return m_is_open && !((m_flags & FileStream_Write) ? out.fail() : in.fail()); } // false once a read or write has failed
+        uint64_t GetRemaining(); // bytes left to read
         void Close();
 
         //= WRITING ==================================================
@@ -154,7 +156,10 @@ namespace Spartan
     private:
         std::ofstream out;
         std::ifstream in;
+        bool CanRead(uint64_t size);
+
         uint32_t m_flags;
         bool m_is_open;
+        uint64_t m_size = 0;
     };
 }
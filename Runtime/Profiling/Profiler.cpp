@@ -26,6 +26,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Resource/ResourceCache.h"
 #include "../RHI/RHI_Device.h"
 #include "../RHI/RHI_CommandList.h"
+#include "../RHI/RHI_ShaderCache.h"
+#include "../RHI/RHI_PipelineCache.h"
+#include "../RHI/RHI_DescriptorSetLayoutCache.h"
+#include "../RHI/RHI_UploadAllocator.h"
+#include "../RHI/RHI_UploadManager.h"
+#include "../RHI/RHI_BindlessTable.h"
 #include "../RHI/RHI_Implementation.h"
 //====================================
 
@@ -180,8 +186,6 @@ namespace Spartan
     {
         // Clear time blocks
         {
-            uint32_t pass_index_gpu = 0;
-
             for (uint32_t i = 0; i < m_time_block_count; i++)
             {
                 TimeBlock& time_block = m_time_blocks_write[i];
@@ -190,12 +194,7 @@ namespace Spartan
                 {
                     // Must not happen when TimeBlockEnd() ends as D3D11 waits
                     // too much for the results to be ready, which increases CPU time.
-                    time_block.ComputeDuration(pass_index_gpu);
-                    if (time_block.GetType() == TimeBlockType::Gpu)
-                    {
-                        pass_index_gpu += 2;
-                    }
-
+                    time_block.ComputeDuration();
                     m_time_blocks_read[i] = time_block;
                 }
                 else
@@ -304,6 +303,13 @@ namespace Spartan
     {
         const auto texture_count    = m_resource_manager->GetResourceCount(ResourceType::Texture) + m_resource_manager->GetResourceCount(ResourceType::Texture2d) + m_resource_manager->GetResourceCount(ResourceType::TextureCube);
         const auto material_count   = m_resource_manager->GetResourceCount(ResourceType::Material);
+        RHI_ShaderCache* shader_cache       = m_renderer->GetShaderCache();
+        RHI_PipelineCache* pipeline_cache   = m_renderer->GetPipelineCache();
+        RHI_DescriptorSetLayoutCache* descriptor_set_layout_cache = m_renderer->GetDescriptorLayoutSetCache();
+        RHI_UploadAllocator* upload_allocator = m_renderer->GetUploadAllocator();
+        RHI_Device* rhi_device = m_renderer->GetRhiDevice().get();
+        RHI_UploadManager* upload_manager = rhi_device ? rhi_device->GetUploadManager() : nullptr;
+        RHI_BindlessTable* bindless_table = m_renderer->GetBindlessTable();
 
         static const char* text =
             // Times
@@ -326,11 +332,32 @@ namespace Spartan
             // Renderer
             "Resolution:\t\t%dx%d\n"
             "Meshes rendered:\t%d\n"
+            "Meshes occluded:\t%d\n"
+            "Meshes GPU driven:\t%d\n"
+            "Triangles:\t\t%d (%d saved by LODs)\n"
+            "Meshlets culled:\t\t%d/%d\n"
+            "Animators:\t\t%d (%.2f ms, %.0f per ms)\n"
+            "Occluders:\t\t%d\n"
+            "Shadow casters culled:\t%d\n"
+            "Shadow slices cached:\t%d\n"
+            "Lights clustered:\t%d\n"
+            "Light cluster indices:\t%d (%d dropped)\n"
+            "Passes:\t\t\t%d (%d culled)\n"
+            "Transient memory:\t%d/%d MB\n"
+            "Async compute:\t\t%d passes, %.2f ms (%.2f ms overlapped)\n"
             "Textures:\t\t\t%d\n"
             "Materials:\t\t%d\n"
+            "Shader cache:\t\t%d hits (%.0f ms), %d misses (%.0f ms)\n"
+            "Pipelines:\t\t\t%d (%d pre-warmed, %d hitches, %.0f ms)\n"
+            "Key collisions:\t\t%d pipelines, %d descriptors\n"
+            "Uploads:\t\t\t%d KB/frame (%d pages, %d KB each)\n"
+            "Transfers:\t\t%d KB/frame (%d batches, %d stalls, %d MB ring)\n"
+            "Deletion queue:\t\t%d\n"
+            "Bindless:\t\t\t%d/%d textures, %d/%d materials\n"
             "\n"
             // RHI
             "Draw:\t\t\t%d\n"
+            "Draw indirect:\t\t%d\n"
             "Dispatch:\t\t\t%d\n"
             "Index buffer:\t\t%d\n"
             "Vertex buffer:\t\t%d\n"
@@ -344,9 +371,11 @@ namespace Spartan
             "Render target:\t%d\n"
             "Pipeline:\t\t\t%d\n"
             "Descriptor set:\t%d\n"
-            "Pipeline barrier:\t%d";
+            "Pipeline barrier:\t%d\n"
+            "Secondary cmd lists:\t%d\n"
+            "Descriptor sets:\t\t%d allocated, %d reused, %d skipped, %d freed (%d live)";
 
-        static char buffer[2048];
+        static char buffer[4096];
         sprintf_s
         (
             buffer, text,
@@ -365,15 +394,41 @@ namespace Spartan
 
             // Renderer
             static_cast<int>(m_renderer->GetResolution().x), static_cast<int>(m_renderer->GetResolution().y),
-            m_renderer_meshes_rendered,
+            m_renderer_meshes_rendered.load(),
+            m_renderer_meshes_occluded,
+            m_renderer_instances_gpu_driven,
+            m_renderer_triangles.load(), m_renderer_triangles_lod_saved.load(),
+            m_renderer_meshlets_culled.load(), m_renderer_meshlets.load(),
+            m_renderer_animators, m_renderer_animators_time, m_renderer_animators_time > 0.0f ? static_cast<float>(m_renderer_animators) / m_renderer_animators_time : 0.0f,
+            m_renderer_occluders,
+            m_renderer_shadow_casters_culled,
+            m_renderer_shadow_slices_cached,
+            m_renderer_lights_clustered,
+            m_renderer_light_cluster_indices, m_renderer_light_cluster_indices_dropped,
+            m_renderer_passes, m_renderer_passes_culled,
+            m_renderer_transient_memory, m_renderer_transient_memory_unaliased,
+            m_renderer_passes_async, m_renderer_async_time, m_renderer_async_overlap,
             texture_count,
             material_count,
+            shader_cache ? shader_cache->GetHitCount() : 0, shader_cache ? shader_cache->GetHitTimeMs() : 0.0f,
+            shader_cache ? shader_cache->GetMissCount() : 0, shader_cache ? shader_cache->GetMissTimeMs() : 0.0f,
+            pipeline_cache ? pipeline_cache->GetPipelineCount() : 0, pipeline_cache ? pipeline_cache->GetPrewarmedCount() : 0,
+            pipeline_cache ? pipeline_cache->GetHitchCount() : 0, pipeline_cache ? pipeline_cache->GetHitchTimeMs() : 0.0f,
+            pipeline_cache ? pipeline_cache->GetCollisionCount() : 0, descriptor_set_layout_cache ? descriptor_set_layout_cache->GetCollisionCount() : 0,
+            upload_allocator ? static_cast<uint32_t>(upload_allocator->GetBytesUploaded() / 1024) : 0, upload_allocator ? upload_allocator->GetPageCount() : 0,
+            upload_allocator ? static_cast<uint32_t>(upload_allocator->GetPageSize() / 1024) : 0,
+            upload_manager ? static_cast<uint32_t>(upload_manager->GetBytesUploaded() / 1024) : 0, upload_manager ? upload_manager->GetBatchCount() : 0,
+            upload_manager ? upload_manager->GetStallCount() : 0, upload_manager ? static_cast<uint32_t>(upload_manager->GetRingSize() / 1024 / 1024) : 0,
+            rhi_device ? rhi_device->DeletionQueue_GetCount() : 0,
+            bindless_table ? bindless_table->GetTextureCount() : 0, bindless_table ? bindless_table->GetTextureCapacity() : 0,
+            bindless_table ? bindless_table->GetMaterialCount() : 0, bindless_table ? bindless_table->GetMaterialCapacity() : 0,
 
             // RHI
-            m_rhi_draw,
-            m_rhi_dispatch,
-            m_rhi_bindings_buffer_index,
-            m_rhi_bindings_buffer_vertex,
+            m_rhi_draw.load(),
+            m_rhi_draw_indirect.load(),
+            m_rhi_dispatch.load(),
+            m_rhi_bindings_buffer_index.load(),
+            m_rhi_bindings_buffer_vertex.load(),
             m_rhi_bindings_buffer_constant,
             m_rhi_bindings_sampler,
             m_rhi_bindings_texture_sampled,
@@ -382,9 +437,12 @@ namespace Spartan
             m_rhi_bindings_shader_pixel,
             m_rhi_bindings_shader_compute,
             m_rhi_bindings_render_target,
-            m_rhi_bindings_pipeline,
-            m_rhi_bindings_descriptor_set,
-            m_rhi_pipeline_barriers
+            m_rhi_bindings_pipeline.load(),
+            m_rhi_bindings_descriptor_set.load(),
+            m_rhi_pipeline_barriers,
+            m_rhi_command_lists_secondary.load(),
+            m_rhi_descriptor_sets_allocated.load(), m_rhi_descriptor_sets_reused.load(), m_rhi_descriptor_sets_skipped.load(), m_rhi_descriptor_sets_freed.load(),
+            descriptor_set_layout_cache ? descriptor_set_layout_cache->GetDescriptorSetCount() : 0
         );
 
         m_metrics = string(buffer);
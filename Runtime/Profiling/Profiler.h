@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ===========================
 #include <string>
 #include <vector>
+#include <atomic>
 #include "TimeBlock.h"
 #include "../Core/ISubsystem.h"
 #include "../Core/Stopwatch.h"
@@ -75,11 +76,12 @@ namespace Spartan
         bool IsCpuStuttering()                          const { return m_is_stuttering_cpu; }
         bool IsGpuStuttering()                          const { return m_is_stuttering_gpu; }
         
-        // Metrics - RHI
-        uint32_t m_rhi_draw                     = 0;
-        uint32_t m_rhi_dispatch                 = 0;
-        uint32_t m_rhi_bindings_buffer_index    = 0;
-        uint32_t m_rhi_bindings_buffer_vertex   = 0;
+        // Metrics - RHI (atomic when they can be incremented by command lists which are recorded on worker threads)
+        std::atomic<uint32_t> m_rhi_draw                     = 0;
+        std::atomic<uint32_t> m_rhi_draw_indirect            = 0;
+        std::atomic<uint32_t> m_rhi_dispatch                 = 0;
+        std::atomic<uint32_t> m_rhi_bindings_buffer_index    = 0;
+        std::atomic<uint32_t> m_rhi_bindings_buffer_vertex   = 0;
         uint32_t m_rhi_bindings_buffer_constant = 0;
         uint32_t m_rhi_bindings_sampler         = 0;
         uint32_t m_rhi_bindings_texture_sampled = 0;
@@ -88,12 +90,38 @@ namespace Spartan
         uint32_t m_rhi_bindings_shader_compute  = 0;
         uint32_t m_rhi_bindings_render_target   = 0;
         uint32_t m_rhi_bindings_texture_storage = 0;
-        uint32_t m_rhi_bindings_descriptor_set  = 0;
-        uint32_t m_rhi_bindings_pipeline        = 0;
+        std::atomic<uint32_t> m_rhi_bindings_descriptor_set  = 0;
+        std::atomic<uint32_t> m_rhi_bindings_pipeline        = 0;
         uint32_t m_rhi_pipeline_barriers        = 0;
+        std::atomic<uint32_t> m_rhi_command_lists_secondary  = 0;
+        std::atomic<uint32_t> m_rhi_descriptor_sets_allocated = 0;
+        std::atomic<uint32_t> m_rhi_descriptor_sets_reused    = 0;
+        std::atomic<uint32_t> m_rhi_descriptor_sets_skipped   = 0;
+        std::atomic<uint32_t> m_rhi_descriptor_sets_freed     = 0;
 
         // Metrics - Renderer
-        uint32_t m_renderer_meshes_rendered = 0;
+        std::atomic<uint32_t> m_renderer_meshes_rendered     = 0;
+        uint32_t m_renderer_meshes_occluded         = 0;
+        uint32_t m_renderer_instances_gpu_driven    = 0;
+        std::atomic<uint32_t> m_renderer_triangles           = 0;
+        std::atomic<uint32_t> m_renderer_triangles_lod_saved = 0;
+        std::atomic<uint32_t> m_renderer_meshlets            = 0;
+        std::atomic<uint32_t> m_renderer_meshlets_culled     = 0;
+        uint32_t m_renderer_animators               = 0;
+        float m_renderer_animators_time             = 0.0f;
+        uint32_t m_renderer_occluders               = 0;
+        uint32_t m_renderer_shadow_casters_culled   = 0;
+        uint32_t m_renderer_shadow_slices_cached    = 0;
+        uint32_t m_renderer_lights_clustered        = 0;
+        uint32_t m_renderer_light_cluster_indices   = 0;
+        uint32_t m_renderer_light_cluster_indices_dropped = 0;
+        uint32_t m_renderer_passes                  = 0;
+        uint32_t m_renderer_passes_culled           = 0;
+        uint32_t m_renderer_transient_memory        = 0;
+        uint32_t m_renderer_transient_memory_unaliased = 0;
+        uint32_t m_renderer_passes_async            = 0;
+        float m_renderer_async_time                 = 0.0f;
+        float m_renderer_async_overlap              = 0.0f;
 
         // Metrics - Time
         float m_time_frame_avg  = 0.0f;
@@ -113,8 +141,28 @@ namespace Spartan
         void ClearRhiMetrics()
         {
             m_rhi_draw                      = 0;
+            m_rhi_draw_indirect             = 0;
             m_rhi_dispatch                  = 0;
             m_renderer_meshes_rendered      = 0;
+            m_renderer_meshes_occluded      = 0;
+            m_renderer_instances_gpu_driven = 0;
+            m_renderer_triangles            = 0;
+            m_renderer_triangles_lod_saved  = 0;
+            m_renderer_meshlets             = 0;
+            m_renderer_meshlets_culled      = 0;
+            m_renderer_animators            = 0;
+            m_renderer_animators_time       = 0.0f;
+            m_renderer_occluders            = 0;
+            m_renderer_shadow_casters_culled = 0;
+            m_renderer_shadow_slices_cached = 0;
+            m_renderer_lights_clustered     = 0;
+            m_renderer_light_cluster_indices = 0;
+            m_renderer_light_cluster_indices_dropped = 0;
+            m_renderer_passes               = 0;
+            m_renderer_passes_culled        = 0;
+            m_renderer_transient_memory     = 0;
+            m_renderer_transient_memory_unaliased = 0;
+            m_renderer_passes_async         = 0;
             m_rhi_bindings_buffer_index     = 0;
             m_rhi_bindings_buffer_vertex    = 0;
             m_rhi_bindings_buffer_constant  = 0;
@@ -128,6 +176,11 @@ namespace Spartan
             m_rhi_bindings_descriptor_set   = 0;
             m_rhi_bindings_pipeline         = 0;
             m_rhi_pipeline_barriers         = 0;
+            m_rhi_command_lists_secondary   = 0;
+            m_rhi_descriptor_sets_allocated = 0;
+            m_rhi_descriptor_sets_reused    = 0;
+            m_rhi_descriptor_sets_skipped   = 0;
+            m_rhi_descriptor_sets_freed     = 0;
         }
 
         TimeBlock* GetNewTimeBlock();
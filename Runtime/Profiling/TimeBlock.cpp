@@ -65,6 +65,7 @@ namespace Spartan
 
             if (cmd_list)
             {
+                m_timestamp_index = cmd_list->Timestamp_GetIndex();
                 cmd_list->Timestamp_Start(m_query_disjoint, m_query_start);
             }
         }
@@ -87,7 +88,7 @@ namespace Spartan
         m_is_complete = true;
     }
 
-    void TimeBlock::ComputeDuration(const uint32_t pass_index)
+    void TimeBlock::ComputeDuration()
     {
         if (!m_is_complete)
         {
@@ -104,7 +105,7 @@ namespace Spartan
         {
             if (m_cmd_list)
             {
-                m_duration = m_cmd_list->Timestamp_GetDuration(m_query_disjoint, m_query_start, m_query_end, pass_index);
+                m_duration = m_cmd_list->Timestamp_GetDuration(m_query_disjoint, m_query_start, m_query_end, m_timestamp_index);
             }
         }
     }
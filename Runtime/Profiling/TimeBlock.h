@@ -46,7 +46,7 @@ namespace Spartan
 
         void Begin(const char* name, TimeBlockType type, const TimeBlock* parent = nullptr, RHI_CommandList* cmd_list = nullptr, const std::shared_ptr<RHI_Device>& rhi_device = nullptr);
         void End();
-        void ComputeDuration(const uint32_t pass_index);
+        void ComputeDuration();
         void Reset();
         TimeBlockType GetType()         const { return m_type; }
         const char* GetName()           const { return m_name; }
@@ -77,5 +77,6 @@ namespace Spartan
         void* m_query_start         = nullptr;
         void* m_query_end           = nullptr;
         RHI_CommandList* m_cmd_list = nullptr;
+        uint32_t m_timestamp_index  = 0; // of the start timestamp, within the command list
     };
 }
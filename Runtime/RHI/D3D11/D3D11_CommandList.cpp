@@ -51,9 +51,10 @@ namespace Spartan
 {
     bool RHI_CommandList::memory_query_support = true;
 
-    RHI_CommandList::RHI_CommandList(uint32_t index, RHI_SwapChain* swap_chain, Context* context)
+    RHI_CommandList::RHI_CommandList(uint32_t index, RHI_SwapChain* swap_chain, Context* context, const RHI_Queue_Type queue_type /*= RHI_Queue_Graphics*/)
     {
         m_swap_chain                    = swap_chain;
+        m_queue_type                    = queue_type;
         m_renderer                      = context->GetSubsystem<Renderer>();
         m_profiler                      = context->GetSubsystem<Profiler>();
         m_rhi_device                    = m_renderer->GetRhiDevice().get();
@@ -76,18 +77,35 @@ namespace Spartan
         return true;
     }
 
-    bool RHI_CommandList::Submit()
+    bool RHI_CommandList::Submit(RHI_Semaphore* signal_semaphore /*= nullptr*/, const uint64_t signal_value /*= 0*/)
     {
         m_state = RHI_CommandListState::Submitted;
         return true;
     }
 
+    bool RHI_CommandList::Split(RHI_Semaphore* signal_semaphore /*= nullptr*/, const uint64_t signal_value /*= 0*/)
+    {
+        // The immediate context executes everything in order, so there is nothing to synchronise
+        return true;
+    }
+
     bool RHI_CommandList::Reset()
     {
         m_state = RHI_CommandListState::Idle;
         return true;
     }
 
+    RHI_CommandList* RHI_CommandList::GetSecondary(const uint32_t thread_index)
+    {
+        // Deferred contexts are not supported, so the caller records on the primary
+        return nullptr;
+    }
+
+    bool RHI_CommandList::ExecuteSecondary(const vector<RHI_CommandList*>& cmd_lists)
+    {
+        return false;
+    }
+
     bool RHI_CommandList::BeginRenderPass(RHI_PipelineState& pipeline_state)
     {
         if (!pipeline_state.IsValid())
@@ -433,6 +451,23 @@ namespace Spartan
         }
     }
 
+    void RHI_CommandList::Copy(RHI_Texture* source, RHI_Texture* destination)
+    {
+        if (!source || !source->Get_Resource() || !destination || !destination->Get_Resource())
+        {
+            LOG_ERROR("Texture is null.");
+            return;
+        }
+
+        if (source->GetWidth() != destination->GetWidth() || source->GetHeight() != destination->GetHeight() || source->GetArraySize() != destination->GetArraySize() || source->GetFormat() != destination->GetFormat())
+        {
+            LOG_ERROR("Source and destination textures must have the same dimensions and format");
+            return;
+        }
+
+        m_rhi_device->GetContextRhi()->device_context->CopyResource(static_cast<ID3D11Resource*>(destination->Get_Resource()), static_cast<ID3D11Resource*>(source->Get_Resource()));
+    }
+
     bool RHI_CommandList::Draw(const uint32_t vertex_count)
     {
         m_rhi_device->GetContextRhi()->device_context->Draw(static_cast<UINT>(vertex_count), 0);
@@ -455,6 +490,12 @@ namespace Spartan
         return true;
     }
 
+    bool RHI_CommandList::DrawIndexedIndirectCount(RHI_StructuredBuffer* arguments, const uint32_t arguments_index, RHI_StructuredBuffer* count, const uint32_t count_index, const uint32_t max_draw_count)
+    {
+        // Not supported, GPU-driven drawing is Vulkan only
+        return false;
+    }
+
     bool RHI_CommandList::Dispatch(uint32_t x, uint32_t y, uint32_t z, bool async /*= false*/)
     {
         ID3D11Device5* device = m_rhi_device->GetContextRhi()->device;
@@ -676,6 +717,21 @@ namespace Spartan
         }
     }
 
+    void RHI_CommandList::SetStructuredBuffer(const uint32_t slot, RHI_StructuredBuffer* structured_buffer, const bool storage /*= false*/) const
+    {
+
+    }
+
+    void RHI_CommandList::ClearStructuredBuffer(RHI_StructuredBuffer* structured_buffer, const uint32_t value /*= 0*/)
+    {
+
+    }
+
+    void RHI_CommandList::InsertBarrier(RHI_StructuredBuffer* structured_buffer)
+    {
+
+    }
+
     bool RHI_CommandList::Timestamp_Start(void* query_disjoint /*= nullptr*/, void* query_start /*= nullptr*/)
     {
         if (!query_disjoint || !query_start)
@@ -756,6 +812,16 @@ namespace Spartan
         return static_cast<float>(duration_ms);
     }
 
+    uint32_t RHI_CommandList::Timestamp_Write()
+    {
+        return m_max_timestamps;
+    }
+
+    double RHI_CommandList::Timestamp_GetMs(const uint32_t index) const
+    {
+        return 0.0;
+    }
+
     uint32_t RHI_CommandList::Gpu_GetMemory(RHI_Device* rhi_device)
     {
         if (const PhysicalDevice* physical_device = rhi_device->GetPrimaryPhysicalDevice())
@@ -882,7 +948,7 @@ namespace Spartan
         }
     }
 
-    bool RHI_CommandList::Deferred_BeginRenderPass()
+    bool RHI_CommandList::Deferred_BeginRenderPass(const bool contents_secondary /*= false*/)
     {
         return true;
     }
@@ -37,11 +37,30 @@ namespace Spartan
         d3d11_utility::release(*reinterpret_cast<ID3D11Buffer**>(&m_buffer));
     }
 
-    RHI_ConstantBuffer::RHI_ConstantBuffer(const std::shared_ptr<RHI_Device>& rhi_device, const string& name, bool is_dynamic /*= false*/)
+    RHI_ConstantBuffer::RHI_ConstantBuffer(const std::shared_ptr<RHI_Device>& rhi_device, const string& name, RHI_UploadAllocator* upload_allocator /*= nullptr*/)
     {
-        m_rhi_device    = rhi_device;
-        m_name          = name;
-        m_is_dynamic    = false; // D3D11 doesn't do that
+        m_rhi_device        = rhi_device;
+        m_name              = name;
+        m_upload_allocator  = nullptr; // D3D11 doesn't do that, WRITE_DISCARD renames the buffer instead
+    }
+
+    bool RHI_ConstantBuffer::Update(const void* data)
+    {
+        void* mapped = Map();
+        if (!mapped)
+        {
+            LOG_ERROR("Failed to map %s buffer", m_name.c_str());
+            return false;
+        }
+
+        memcpy(mapped, data, m_size_cpu);
+
+        return Unmap();
+    }
+
+    bool RHI_ConstantBuffer::IsStale() const
+    {
+        return false;
     }
 
     void* RHI_ConstantBuffer::Map()
@@ -49,6 +49,7 @@ namespace Spartan
 
         // Resource limits
         RHI_Context::texture_2d_dimension_max = D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION;
+        RHI_Context::constant_buffer_size_max = D3D11_REQ_CONSTANT_BUFFER_ELEMENT_COUNT * 16;
 
         const PhysicalDevice* physical_device = GetPrimaryPhysicalDevice();
         if (!physical_device)
@@ -218,7 +219,7 @@ namespace Spartan
         d3d11_utility::release(m_rhi_context->annotation);
     }
 
-    bool RHI_Device::Queue_Submit(const RHI_Queue_Type type, const uint32_t wait_flags, void* cmd_buffer, RHI_Semaphore* wait_semaphore /*= nullptr*/, RHI_Semaphore* signal_semaphore /*= nullptr*/, RHI_Fence* signal_fence /*= nullptr*/) const
+    bool RHI_Device::Queue_Submit(const RHI_Queue_Type type, const uint32_t wait_flags, void* cmd_buffer, RHI_Semaphore* wait_semaphore /*= nullptr*/, RHI_Semaphore* signal_semaphore /*= nullptr*/, RHI_Fence* signal_fence /*= nullptr*/, const uint64_t signal_value /*= 0*/, RHI_Semaphore* wait_semaphore_timeline /*= nullptr*/, const uint64_t wait_value /*= 0*/) const
     {
         return true;
     }
@@ -228,4 +229,11 @@ namespace Spartan
         m_rhi_context->device_context->Flush();
         return true;
     }
+
+    void RHI_Device::DeletionQueue_Parse(const bool force /*= false*/)
+    {
+        // Resources are released by their owners, so the queue is never used
+        lock_guard<mutex> lock(m_deletion_queue_mutex);
+        m_deletion_queue.clear();
+    }
 }
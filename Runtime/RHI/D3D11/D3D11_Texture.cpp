@@ -128,7 +128,7 @@ namespace Spartan
             {
                 D3D11_SUBRESOURCE_DATA& subresource_data    = vec_subresource_data.emplace_back(D3D11_SUBRESOURCE_DATA{});
                 subresource_data.pSysMem                    = i < data.size()? data[i].data() : nullptr;        // Data pointer
-                subresource_data.SysMemPitch                = (width >> i) * channels * (bits_per_channel / 8); // Line width in bytes
+                subresource_data.SysMemPitch                = Math::Helper::Max(width >> i, 1u) * channels * (bits_per_channel / 8); // Line width in bytes
                 subresource_data.SysMemSlicePitch           = 0;                                                // This is only used for 3D textures
             }
         }
@@ -399,7 +399,7 @@ namespace Spartan
                     // D3D11_SUBRESOURCE_DATA
                     auto & subresource_data             = vec_subresource_data.emplace_back(D3D11_SUBRESOURCE_DATA{});
                     subresource_data.pSysMem            = mip_data.data();                                          // Data pointer
-                    subresource_data.SysMemPitch        = (width >> mip_level) * channels * (bits_per_channel / 8); // Line width in bytes
+                    subresource_data.SysMemPitch        = Math::Helper::Max(width >> mip_level, 1u) * channels * (bits_per_channel / 8); // Line width in bytes
                     subresource_data.SysMemSlicePitch   = 0;                                                        // This is only used for 3D textures
                 }
 
@@ -49,7 +49,7 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
-    RHI_CommandList::RHI_CommandList(uint32_t index, RHI_SwapChain* swap_chain, Context* context)
+    RHI_CommandList::RHI_CommandList(uint32_t index, RHI_SwapChain* swap_chain, Context* context, const RHI_Queue_Type queue_type /*= RHI_Queue_Graphics*/)
     {
     
     }
@@ -66,7 +66,12 @@ namespace Spartan
         return true;
     }
 
-    bool RHI_CommandList::Submit()
+    bool RHI_CommandList::Submit(RHI_Semaphore* signal_semaphore /*= nullptr*/, const uint64_t signal_value /*= 0*/)
+    {
+        return true;
+    }
+
+    bool RHI_CommandList::Split(RHI_Semaphore* signal_semaphore /*= nullptr*/, const uint64_t signal_value /*= 0*/)
     {
         return true;
     }
@@ -76,6 +81,16 @@ namespace Spartan
         return true;
     }
 
+    RHI_CommandList* RHI_CommandList::GetSecondary(const uint32_t thread_index)
+    {
+        return nullptr;
+    }
+
+    bool RHI_CommandList::ExecuteSecondary(const vector<RHI_CommandList*>& cmd_lists)
+    {
+        return false;
+    }
+
     bool RHI_CommandList::BeginRenderPass(RHI_PipelineState& pipeline_state)
     {
         return true;
@@ -103,6 +118,11 @@ namespace Spartan
 
     }
 
+    void RHI_CommandList::Copy(RHI_Texture* source, RHI_Texture* destination)
+    {
+
+    }
+
     bool RHI_CommandList::Draw(const uint32_t vertex_count)
     {
        
@@ -114,6 +134,11 @@ namespace Spartan
         return true;
     }
     
+    bool RHI_CommandList::DrawIndexedIndirectCount(RHI_StructuredBuffer* arguments, const uint32_t arguments_index, RHI_StructuredBuffer* count, const uint32_t count_index, const uint32_t max_draw_count)
+    {
+        return false;
+    }
+
     bool RHI_CommandList::Dispatch(uint32_t x, uint32_t y, uint32_t z, bool async /*= false*/)
     {
         return true;
@@ -154,6 +179,21 @@ namespace Spartan
     
     }
 
+    void RHI_CommandList::SetStructuredBuffer(const uint32_t slot, RHI_StructuredBuffer* structured_buffer, const bool storage /*= false*/) const
+    {
+
+    }
+
+    void RHI_CommandList::ClearStructuredBuffer(RHI_StructuredBuffer* structured_buffer, const uint32_t value /*= 0*/)
+    {
+
+    }
+
+    void RHI_CommandList::InsertBarrier(RHI_StructuredBuffer* structured_buffer)
+    {
+
+    }
+
     bool RHI_CommandList::Timestamp_Start(void* query_disjoint /*= nullptr*/, void* query_start /*= nullptr*/)
     {
         return true;
@@ -164,11 +204,21 @@ namespace Spartan
         return true;
     }
 
-    float RHI_CommandList::Timestamp_GetDuration(void* query_disjoint, void* query_start, void* query_end, const uint32_t pass_index)
+    float RHI_CommandList::Timestamp_GetDuration(void* query_disjoint, void* query_start, void* query_end, const uint32_t index)
     {
         return 0.0f;
     }
 
+    uint32_t RHI_CommandList::Timestamp_Write()
+    {
+        return m_max_timestamps;
+    }
+
+    double RHI_CommandList::Timestamp_GetMs(const uint32_t index) const
+    {
+        return 0.0;
+    }
+
     uint32_t RHI_CommandList::Gpu_GetMemory(RHI_Device* rhi_device)
     {
         return 0;
@@ -199,7 +249,7 @@ namespace Spartan
 
     }
 
-    bool RHI_CommandList::Deferred_BeginRenderPass()
+    bool RHI_CommandList::Deferred_BeginRenderPass(const bool contents_secondary /*= false*/)
     {
         return true;
     }
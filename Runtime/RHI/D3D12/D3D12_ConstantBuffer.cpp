@@ -37,9 +37,19 @@ namespace Spartan
         
     }
 
-    RHI_ConstantBuffer::RHI_ConstantBuffer(const std::shared_ptr<RHI_Device>& rhi_device, const string& name, bool is_dynamic /*= false*/)
+    RHI_ConstantBuffer::RHI_ConstantBuffer(const std::shared_ptr<RHI_Device>& rhi_device, const string& name, RHI_UploadAllocator* upload_allocator /*= nullptr*/)
     {
         
+    }
+
+    bool RHI_ConstantBuffer::Update(const void* data)
+    {
+        return true;
+    }
+
+    bool RHI_ConstantBuffer::IsStale() const
+    {
+        return false;
     }
 
 	void* RHI_ConstantBuffer::Map()
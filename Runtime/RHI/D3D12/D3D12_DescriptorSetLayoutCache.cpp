@@ -37,18 +37,28 @@ namespace Spartan
 
     }
 
-    void RHI_DescriptorSetLayoutCache::Reset(uint32_t descriptor_set_capacity /*= 0*/)
+    void RHI_DescriptorSetLayoutCache::Reset()
     {
 
     }
 
-    void RHI_DescriptorSetLayoutCache::SetDescriptorSetCapacity(uint32_t descriptor_set_capacity)
+    bool RHI_DescriptorSetLayoutCache::AllocateDescriptorSet(void* descriptor_set_layout, void*& descriptor_set, void*& descriptor_pool)
+    {
+        return true;
+    }
+
+    void RHI_DescriptorSetLayoutCache::FreeDescriptorSet(void* descriptor_set, void* descriptor_pool)
     {
 
     }
 
-    bool RHI_DescriptorSetLayoutCache::CreateDescriptorPool(uint32_t descriptor_set_capacity)
+    bool RHI_DescriptorSetLayoutCache::CreateDescriptorPool()
     {
         return true;
     }
+
+    void RHI_DescriptorSetLayoutCache::DestroyDescriptorPools()
+    {
+
+    }
 }
@@ -108,7 +108,7 @@ namespace Spartan
         d3d12_utility::release(m_rhi_context->device);
     }
 
-    bool RHI_Device::Queue_Submit(const RHI_Queue_Type type, const uint32_t wait_flags, void* cmd_buffer, RHI_Semaphore* wait_semaphore /*= nullptr*/, RHI_Semaphore* signal_semaphore /*= nullptr*/, RHI_Fence* signal_fence /*= nullptr*/) const
+    bool RHI_Device::Queue_Submit(const RHI_Queue_Type type, const uint32_t wait_flags, void* cmd_buffer, RHI_Semaphore* wait_semaphore /*= nullptr*/, RHI_Semaphore* signal_semaphore /*= nullptr*/, RHI_Fence* signal_fence /*= nullptr*/, const uint64_t signal_value /*= 0*/, RHI_Semaphore* wait_semaphore_timeline /*= nullptr*/, const uint64_t wait_value /*= 0*/) const
     {
         return true;
     }
@@ -117,4 +117,11 @@ namespace Spartan
     {
         return true;
     }
+
+    void RHI_Device::DeletionQueue_Parse(const bool force /*= false*/)
+    {
+        // Resources are released by their owners, so the queue is never used
+        lock_guard<mutex> lock(m_deletion_queue_mutex);
+        m_deletion_queue.clear();
+    }
 }
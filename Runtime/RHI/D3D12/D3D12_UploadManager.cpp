@@ -0,0 +1,79 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES =====================
+#include "Spartan.h"
+#include "../RHI_UploadManager.h"
+//================================
+
+namespace Spartan
+{
+    bool RHI_UploadManager::CreateRing()
+    {
+        return false;
+    }
+
+    void RHI_UploadManager::DestroyRing()
+    {
+
+    }
+
+    bool RHI_UploadManager::CreateStaging(const uint64_t size, Staging& staging)
+    {
+        return false;
+    }
+
+    void RHI_UploadManager::DestroyStaging(void*& buffer)
+    {
+
+    }
+
+    bool RHI_UploadManager::CreateBatch(Batch* batch)
+    {
+        return false;
+    }
+
+    void RHI_UploadManager::DestroyBatch(Batch* batch)
+    {
+
+    }
+
+    bool RHI_UploadManager::BeginBatch(Batch* batch)
+    {
+        return false;
+    }
+
+    bool RHI_UploadManager::SubmitBatch(Batch* batch)
+    {
+        return false;
+    }
+
+    void RHI_UploadManager::RecordCopy(Batch* batch, const Staging& staging, void* buffer, const uint64_t size)
+    {
+
+    }
+
+    void RHI_UploadManager::RecordCopy(Batch* batch, const Staging& staging, RHI_Texture* texture, const RHI_Image_Layout layout)
+    {
+
+    }
+}
@@ -0,0 +1,180 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==================
+#include "Spartan.h"
+#include "RHI_BindlessTable.h"
+#include "RHI_Device.h"
+#include "RHI_Texture.h"
+//=============================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    RHI_BindlessTable::RHI_BindlessTable(const shared_ptr<RHI_Device>& rhi_device, const uint32_t frame_count, const uint32_t material_capacity, const uint32_t texture_capacity /*= 4096*/)
+    {
+        m_rhi_device        = rhi_device;
+        m_name              = "bindless_table";
+        m_frame_count       = frame_count != 0 ? frame_count : 1;
+        m_material_capacity = material_capacity;
+        m_texture_capacity  = texture_capacity;
+
+        if (!m_rhi_device->IsBindlessSupported())
+            return;
+
+        if (!CreateResources())
+        {
+            LOG_ERROR("Failed to create bindless table");
+            DestroyResources();
+        }
+    }
+
+    RHI_BindlessTable::~RHI_BindlessTable()
+    {
+        // Wait in case the table is still in use by the GPU
+        m_rhi_device->Queue_WaitAll();
+
+        DestroyResources();
+    }
+
+    void RHI_BindlessTable::BeginFrame(const uint32_t frame_index)
+    {
+        m_frame_index       = frame_index % m_frame_count;
+        m_material_count    = 0;
+        m_frame++;
+
+        // Retire the slots of textures which haven't been used in a while
+        for (auto it = m_textures.begin(); it != m_textures.end();)
+        {
+            if (it->second.frame_used + m_texture_lifetime < m_frame)
+            {
+                RetireTextureIndex(it->second.index);
+                it = m_textures.erase(it);
+            }
+            else
+            {
+                it++;
+            }
+        }
+
+        // Retired slots can be reused once no frame in flight can be sampling them
+        for (auto it = m_texture_indices_retired.begin(); it != m_texture_indices_retired.end();)
+        {
+            if (it->second + m_frame_count < m_frame)
+            {
+                m_texture_indices_free.emplace_back(it->first);
+                it = m_texture_indices_retired.erase(it);
+            }
+            else
+            {
+                it++;
+            }
+        }
+    }
+
+    uint32_t RHI_BindlessTable::AddTexture(RHI_Texture* texture)
+    {
+        if (!IsValid() || !texture)
+            return rhi_bindless_index_invalid;
+
+        // Only textures which are done loading can be sampled
+        void* view = texture->Get_Resource_View(0);
+        if (!view || texture->GetLayout() != RHI_Image_Layout::Shader_Read_Only_Optimal)
+            return rhi_bindless_index_invalid;
+
+        auto it = m_textures.find(texture->GetId());
+        if (it != m_textures.end())
+        {
+            TextureSlot& slot = it->second;
+
+            // A slot might still be sampled by a frame in flight, so a texture which was re-created gets a new one
+            if (slot.view != view)
+            {
+                const uint32_t index = AcquireTextureIndex();
+                if (index == rhi_bindless_index_invalid)
+                    return rhi_bindless_index_invalid;
+
+                RetireTextureIndex(slot.index);
+                SetTextureRhi(index, texture);
+                slot.view   = view;
+                slot.index  = index;
+            }
+
+            slot.frame_used = m_frame;
+            return slot.index;
+        }
+
+        const uint32_t index = AcquireTextureIndex();
+        if (index == rhi_bindless_index_invalid)
+            return rhi_bindless_index_invalid;
+
+        SetTextureRhi(index, texture);
+        m_textures[texture->GetId()] = { view, index, m_frame };
+
+        return index;
+    }
+
+    uint32_t RHI_BindlessTable::AddMaterial(const RHI_BindlessMaterial& material)
+    {
+        if (!IsValid())
+            return rhi_bindless_index_invalid;
+
+        if (m_material_count == m_material_capacity)
+        {
+            LOG_ERROR("Material buffer has reached it's maximum capacity of %d elements", m_material_capacity);
+            return rhi_bindless_index_invalid;
+        }
+
+        const uint64_t offset = m_frame_index * m_material_region_size + m_material_count * sizeof(RHI_BindlessMaterial);
+        memcpy(m_material_mapped + offset, &material, sizeof(RHI_BindlessMaterial));
+
+        if (!m_material_coherent)
+        {
+            FlushMaterials(offset, sizeof(RHI_BindlessMaterial));
+        }
+
+        return m_material_count++;
+    }
+
+    uint32_t RHI_BindlessTable::AcquireTextureIndex()
+    {
+        if (!m_texture_indices_free.empty())
+        {
+            const uint32_t index = m_texture_indices_free.back();
+            m_texture_indices_free.pop_back();
+            return index;
+        }
+
+        if (m_texture_index_next < m_texture_capacity)
+            return m_texture_index_next++;
+
+        LOG_ERROR("Texture array has reached it's maximum capacity of %d elements", m_texture_capacity);
+        return rhi_bindless_index_invalid;
+    }
+
+    void RHI_BindlessTable::RetireTextureIndex(const uint32_t index)
+    {
+        m_texture_indices_retired.emplace_back(index, m_frame);
+    }
+}
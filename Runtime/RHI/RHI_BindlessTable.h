@@ -0,0 +1,136 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =======================
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "RHI_Definition.h"
+#include "../Core/Spartan_Object.h"
+#include "../Math/Vector2.h"
+#include "../Math/Vector4.h"
+//==================================
+
+namespace Spartan
+{
+    // A material as seen by the shader, must match BindlessMaterial in Common_Buffer.hlsl
+    struct RHI_BindlessMaterial
+    {
+        Math::Vector4 color     = Math::Vector4::One;
+        Math::Vector2 tiling    = Math::Vector2::One;
+        Math::Vector2 offset    = Math::Vector2::Zero;
+        float roughness         = 1.0f;
+        float metallic          = 0.0f;
+        float normal            = 0.0f;
+        float height            = 0.0f;
+
+        // Albedo, roughness, metallic, normal, height, occlusion, emission, mask
+        std::array<uint32_t, 8> textures =
+        {
+            rhi_bindless_index_invalid,
+            rhi_bindless_index_invalid,
+            rhi_bindless_index_invalid,
+            rhi_bindless_index_invalid,
+            rhi_bindless_index_invalid,
+            rhi_bindless_index_invalid,
+            rhi_bindless_index_invalid,
+            rhi_bindless_index_invalid
+        };
+    };
+
+    // A descriptor set which holds every registered texture in one large array, along with a buffer of materials which
+    // reference those textures by index. It's bound as a second set, so shaders can sample any material without the
+    // first set having to change. Textures are registered on use and their slots are retired once they stop being used.
+    // Every frame (swapchain command list) owns a region of the material buffer, which is only rewritten once that frame begins again.
+    class SPARTAN_CLASS RHI_BindlessTable : public Spartan_Object
+    {
+    public:
+        RHI_BindlessTable(const std::shared_ptr<RHI_Device>& rhi_device, const uint32_t frame_count, const uint32_t material_capacity, const uint32_t texture_capacity = 4096);
+        ~RHI_BindlessTable();
+
+        // Makes the given frame's material region current, must be called after its command list has begun
+        void BeginFrame(const uint32_t frame_index);
+
+        // Returns the index shaders can sample the texture with, or rhi_bindless_index_invalid if it can't be sampled yet
+        uint32_t AddTexture(RHI_Texture* texture);
+
+        // Returns the index shaders can read the material with, or rhi_bindless_index_invalid if the buffer is full
+        uint32_t AddMaterial(const RHI_BindlessMaterial& material);
+
+        bool IsValid()                  const { return m_descriptor_set_layout != nullptr; }
+        void* GetResource()             const { return IsValid() ? m_descriptor_sets[m_frame_index] : nullptr; }
+        void* GetLayout()               const { return m_descriptor_set_layout; }
+        uint32_t GetTextureCount()      const { return static_cast<uint32_t>(m_textures.size()); }
+        uint32_t GetTextureCapacity()   const { return m_texture_capacity; }
+        uint32_t GetMaterialCount()     const { return m_material_count; }
+        uint32_t GetMaterialCapacity()  const { return m_material_capacity; }
+
+    private:
+        struct TextureSlot
+        {
+            void* view          = nullptr;
+            uint32_t index      = 0;
+            uint64_t frame_used = 0;
+        };
+
+        uint32_t AcquireTextureIndex();
+        void RetireTextureIndex(const uint32_t index);
+
+        // API
+        bool CreateResources();
+        void DestroyResources();
+        void SetTextureRhi(const uint32_t index, RHI_Texture* texture);
+        void FlushMaterials(const uint64_t offset, const uint64_t size);
+
+        // Textures, keyed by their id
+        std::unordered_map<uint32_t, TextureSlot> m_textures;
+        std::vector<uint32_t> m_texture_indices_free;
+        std::vector<std::pair<uint32_t, uint64_t>> m_texture_indices_retired; // <index, frame it was retired in>
+        uint32_t m_texture_index_next   = 0;
+        uint32_t m_texture_capacity     = 0;
+        uint32_t m_texture_lifetime     = 60; // frames a texture can go unused before its slot is retired
+
+        // Materials
+        uint32_t m_material_capacity        = 0;
+        uint32_t m_material_count           = 0;
+        uint64_t m_material_region_size     = 0;
+        void* m_material_buffer             = nullptr;
+        void* m_material_allocation         = nullptr;
+        std::byte* m_material_mapped        = nullptr;
+        bool m_material_coherent            = true;
+
+        // Frames
+        uint32_t m_frame_count  = 0;
+        uint32_t m_frame_index  = 0;
+        uint64_t m_frame        = 0;
+
+        // API
+        void* m_descriptor_set_layout   = nullptr;
+        void* m_descriptor_pool         = nullptr;
+        std::vector<void*> m_descriptor_sets;
+
+        // Dependencies
+        std::shared_ptr<RHI_Device> m_rhi_device;
+    };
+}
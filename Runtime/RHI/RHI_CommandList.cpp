@@ -19,12 +19,11 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES ============================
+//= INCLUDES ===============
 #include "Spartan.h"
 #include "RHI_CommandList.h"
 #include "RHI_Fence.h"
-#include "RHI_DescriptorSetLayoutCache.h"
-//=======================================
+//==========================
 
 namespace Spartan
 {
@@ -35,7 +34,6 @@ namespace Spartan
         if (!m_processed_fence->Wait())
             return false;
 
-        m_descriptor_set_layout_cache->GrowIfNeeded();
         m_state = RHI_CommandListState::Idle;
 
         return true;
@@ -46,6 +44,13 @@ namespace Spartan
         if (m_state == RHI_CommandListState::Idle)
             return true;
 
+        // Secondary command lists are submitted as part of their primary
+        if (IsSecondary())
+        {
+            LOG_ERROR("Secondary command lists can't be flushed");
+            return false;
+        }
+
         // If recording, end
         bool was_recording      = false;
         bool had_render_pass    = false;
@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ===========================
 #include <array>
 #include <atomic>
+#include <vector>
 #include "RHI_Definition.h"
 #include "../Core/Spartan_Object.h"
 #include "../Rendering/Renderer_Enums.h"
@@ -51,17 +52,33 @@ namespace Spartan
     class SPARTAN_CLASS RHI_CommandList : public Spartan_Object
     {
     public:
-        RHI_CommandList(uint32_t index, RHI_SwapChain* swap_chain, Context* context);
+        RHI_CommandList(uint32_t index, RHI_SwapChain* swap_chain, Context* context, const RHI_Queue_Type queue_type = RHI_Queue_Graphics);
+        RHI_CommandList(RHI_CommandList* cmd_list_primary, const uint32_t thread_index, void* cmd_pool); // secondary
         ~RHI_CommandList();
     
         // Command list
         bool Begin();
         bool End();
-        bool Submit();
+        bool Submit(RHI_Semaphore* signal_semaphore = nullptr, const uint64_t signal_value = 0);
         bool Wait();
         bool Reset();
         bool Flush();
 
+        // Cross-queue synchronisation (timeline semaphores)
+        // Split() submits what has been recorded so far (signalling the semaphore, if any) and carries on recording into another command buffer,
+        // which is what allows another queue to start on the work recorded so far, while this list is still recording. QueueWait() makes the next
+        // submission (Split() or Submit()) wait on the GPU for the semaphore to reach the value. Both must be called outside of a render pass.
+        bool Split(RHI_Semaphore* signal_semaphore = nullptr, const uint64_t signal_value = 0);
+        void QueueWait(RHI_Semaphore* semaphore, const uint64_t value) { m_wait_semaphore = semaphore; m_wait_value = value; }
+
+        // Secondary command lists
+        // A secondary is acquired (on the thread which records the primary) once the primary has begun a render pass, after that it can
+        // be recorded by any thread, as long as each thread index is recorded by a single thread at a time. Begin() inherits the render pass
+        // and pipeline of the primary, End() ends it and ExecuteSecondary() executes them in the render pass of the primary, in order.
+        RHI_CommandList* GetSecondary(const uint32_t thread_index);
+        bool ExecuteSecondary(const std::vector<RHI_CommandList*>& cmd_lists);
+        bool IsSecondary() const { return m_cmd_list_primary != nullptr; }
+
         // Render pass
         bool BeginRenderPass(RHI_PipelineState& pipeline_state);
         bool EndRenderPass();
@@ -70,9 +87,15 @@ namespace Spartan
         void ClearPipelineStateRenderTargets(RHI_PipelineState& pipeline_state);
         void ClearRenderTarget(RHI_Texture* texture, const uint32_t color_index = 0, const uint32_t depth_stencil_index = 0, const bool storage = false, const Math::Vector4& clear_color = rhi_color_load, const float clear_depth = rhi_depth_load, const uint32_t clear_stencil = rhi_stencil_load);
 
+        // Copy
+        void Copy(RHI_Texture* source, RHI_Texture* destination);
+
         // Draw
         bool Draw(uint32_t vertex_count);
         bool DrawIndexed(uint32_t index_count, uint32_t index_offset = 0, uint32_t vertex_offset = 0);
+
+        // Draws up to max_draw_count indexed draws, the arguments and the actual draw count are read from GPU buffers (indices are in elements)
+        bool DrawIndexedIndirectCount(RHI_StructuredBuffer* arguments, const uint32_t arguments_index, RHI_StructuredBuffer* count, const uint32_t count_index, const uint32_t max_draw_count);
         
         // Dispatch
         bool Dispatch(uint32_t x, uint32_t y, uint32_t z, bool async = false);
@@ -103,11 +126,26 @@ namespace Spartan
         inline void SetTexture(const RendererBindingsUav slot, const std::shared_ptr<RHI_Texture>& texture) { SetTexture(static_cast<uint32_t>(slot), texture.get(), true); }
         inline void SetTexture(const RendererBindingsSrv slot, RHI_Texture* texture)                        { SetTexture(static_cast<uint32_t>(slot), texture, false); }
         inline void SetTexture(const RendererBindingsSrv slot, const std::shared_ptr<RHI_Texture>& texture) { SetTexture(static_cast<uint32_t>(slot), texture.get(), false); }
+
+        // Structured buffer
+        void SetStructuredBuffer(const uint32_t slot, RHI_StructuredBuffer* structured_buffer, const bool storage = false) const;
+        inline void SetStructuredBuffer(const RendererBindingsUav slot, RHI_StructuredBuffer* structured_buffer) const { SetStructuredBuffer(static_cast<uint32_t>(slot), structured_buffer, true); }
+        inline void SetStructuredBuffer(const RendererBindingsSrv slot, RHI_StructuredBuffer* structured_buffer) const { SetStructuredBuffer(static_cast<uint32_t>(slot), structured_buffer, false); }
+
+        // Both must be called outside of a render pass. Clearing waits for previous reads of the buffer and makes the clear visible to
+        // compute shaders, the barrier makes compute shader writes visible to the shaders and indirect draws which follow.
+        void ClearStructuredBuffer(RHI_StructuredBuffer* structured_buffer, const uint32_t value = 0);
+        void InsertBarrier(RHI_StructuredBuffer* structured_buffer);
         
         // Timestamps
         bool Timestamp_Start(void* query_disjoint = nullptr, void* query_start = nullptr);
         bool Timestamp_End(void* query_disjoint = nullptr, void* query_end = nullptr);
-        float Timestamp_GetDuration(void* query_disjoint, void* query_start, void* query_end, const uint32_t pass_index);
+        float Timestamp_GetDuration(void* query_disjoint, void* query_start, void* query_end, const uint32_t index);
+        uint32_t Timestamp_GetIndex() const { return m_timestamp_index; } // index of the next timestamp
+
+        // Raw timestamps, for correlating work across queues, the values can be read once the command list has been waited for
+        uint32_t Timestamp_Write();
+        double Timestamp_GetMs(const uint32_t index) const;
 
         static uint32_t Gpu_GetMemory(RHI_Device* rhi_device);
         static uint32_t Gpu_GetMemoryUsed(RHI_Device* rhi_device);
@@ -119,17 +157,21 @@ namespace Spartan
         void* GetResource_CommandBuffer()       const { return m_cmd_buffer; }
         RHI_Semaphore* GetProcessedSemaphore()        { return m_processed_semaphore.get(); }
         const RHI_CommandListState GetState()   const { return m_state; }
+        RHI_Queue_Type GetQueueType()           const { return m_queue_type; }
 
     private:
         void Timeblock_Start(const RHI_PipelineState* pipeline_state);
         void Timeblock_End(const RHI_PipelineState* pipeline_state);
-        bool Deferred_BeginRenderPass();
+        bool Begin_Secondary();
+        bool Deferred_BeginRenderPass(const bool contents_secondary = false);
         bool Deferred_BindPipeline();
         bool Deferred_BindDescriptorSet();
         bool OnDraw();
 
         RHI_Pipeline* m_pipeline                                    = nullptr; 
         RHI_SwapChain* m_swap_chain                                 = nullptr;
+        RHI_SwapChain* m_render_target_swapchain                    = nullptr;
+        void* m_frame_buffer                                        = nullptr;
         Renderer* m_renderer                                        = nullptr;
         RHI_PipelineCache* m_pipeline_cache                         = nullptr;
         RHI_DescriptorSetLayoutCache* m_descriptor_set_layout_cache = nullptr;
@@ -137,6 +179,7 @@ namespace Spartan
         RHI_Device* m_rhi_device                                    = nullptr;
         Profiler* m_profiler                                        = nullptr;
         void* m_cmd_buffer                                          = nullptr;
+        RHI_Queue_Type m_queue_type                                 = RHI_Queue_Graphics;
         std::shared_ptr<RHI_Fence> m_processed_fence                = nullptr;
         std::shared_ptr<RHI_Semaphore> m_processed_semaphore        = nullptr;
         void* m_query_pool                                          = nullptr;
@@ -147,6 +190,19 @@ namespace Spartan
         static bool memory_query_support;
         std::mutex m_mutex_reset;
 
+        // Command buffers which Split() carries on recording into, the first one is begun by Begin()
+        std::vector<void*> m_cmd_buffers;
+        uint32_t m_cmd_buffer_index     = 0;
+        RHI_Semaphore* m_wait_semaphore = nullptr;
+        uint64_t m_wait_value           = 0;
+
+        // Secondary command lists (per thread index, each with it's own command pool)
+        RHI_CommandList* m_cmd_list_primary = nullptr;
+        void* m_cmd_pool                    = nullptr; // the pool the command buffers are allocated from
+        std::vector<void*> m_secondary_cmd_pools;
+        std::vector<std::vector<std::shared_ptr<RHI_CommandList>>> m_secondary_cmd_lists;
+        std::vector<uint32_t> m_secondary_cmd_lists_used;
+
         // Profiling
         uint32_t m_timestamp_index = 0;
         static const uint32_t m_max_timestamps = 256;
@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ======================
 #include <memory>
+#include "RHI_Definition.h"
 #include "../Core/Spartan_Object.h"
 //=================================
 
@@ -31,48 +32,44 @@ namespace Spartan
     class SPARTAN_CLASS RHI_ConstantBuffer : public Spartan_Object
     {
     public:
-        RHI_ConstantBuffer(const std::shared_ptr<RHI_Device>& rhi_device, const std::string& name, bool is_dynamic = false);
+        // Buffers with an upload allocator are dynamic, every update is sub-allocated from the allocator's pages (Vulkan only)
+        RHI_ConstantBuffer(const std::shared_ptr<RHI_Device>& rhi_device, const std::string& name, RHI_UploadAllocator* upload_allocator = nullptr);
         ~RHI_ConstantBuffer() { _destroy(); }
 
         template<typename T>
-        bool Create(const uint32_t offset_count = 1)
+        bool Create()
         {
-            m_stride        = static_cast<uint32_t>(sizeof(T));
-            m_offset_count  = offset_count;
-            m_size_gpu      = static_cast<uint64_t>(m_stride * m_offset_count);
+            m_size_cpu  = static_cast<uint64_t>(sizeof(T));
+            m_stride    = static_cast<uint32_t>(sizeof(T));
+            m_size_gpu  = static_cast<uint64_t>(m_stride);
 
             return _create();
         }
 
+        bool Update(const void* data);
         void* Map();  
         bool Unmap(const uint64_t offset = 0, const uint64_t size = 0);
 
         void* GetResource()         const { return m_buffer; }
         uint32_t GetStride()        const { return m_stride; }
-        uint32_t GetOffsetCount()   const { return m_offset_count; }
+        uint32_t GetOffset()        const { return 0; }
 
-        // Static offset - The kind of offset that is used when updating the buffer.
-        uint32_t GetOffset()                                const { return m_offset_index * m_stride; }
-        uint32_t GetOffsetIndex()                           const { return m_offset_index; }
-        void SetOffsetIndex(const uint32_t offset_index)          { m_offset_index = offset_index; }
-        
         // Dynamic offset - The kind of offset that is used when binding descriptor sets.
-        bool IsDynamic()                                        const { return m_is_dynamic; }
-        uint32_t GetOffsetDynamic()                             const { return m_offset_dynamic_index * m_stride; }
-        uint32_t GetOffsetIndexDynamic()                        const { return m_offset_dynamic_index; }
-        void SetOffsetIndexDynamic(const uint32_t offset_index)       { m_offset_dynamic_index = offset_index; }
+        bool IsDynamic()            const { return m_upload_allocator != nullptr; }
+        uint32_t GetOffsetDynamic() const { return m_offset_dynamic; }
+
+        // A dynamic buffer which hasn't been updated this frame refers to memory which is about to be recycled
+        bool IsStale() const;
 
     private:
         bool _create();
         void _destroy();
 
-        bool m_is_dynamic               = false;    // only affects Vulkan
-        bool m_persistent_mapping       = true;     // only affects Vulkan, saves 2 ms of CPU time
-        void* m_mapped                  = nullptr;
-        uint32_t m_stride               = 0;
-        uint32_t m_offset_count         = 1;
-        uint32_t m_offset_index         = 0;
-        uint32_t m_offset_dynamic_index = 0;
+        bool m_persistent_mapping   = true;     // only affects Vulkan, saves 2 ms of CPU time
+        void* m_mapped              = nullptr;
+        uint32_t m_stride           = 0;
+        uint32_t m_offset_dynamic   = 0;
+        uint64_t m_upload_frame     = 0;
 
         // API
         void* m_buffer      = nullptr;
@@ -80,5 +77,6 @@ namespace Spartan
 
         // Dependencies
         std::shared_ptr<RHI_Device> m_rhi_device;
+        RHI_UploadAllocator* m_upload_allocator = nullptr;
     };
 }
@@ -34,6 +34,7 @@ namespace Spartan
     class RHI_CommandList;
     class RHI_PipelineState;
     class RHI_PipelineCache;
+    class RHI_ShaderCache;
     class RHI_Pipeline;
     class RHI_DescriptorSet;
     class RHI_DescriptorSetLayout;
@@ -46,6 +47,10 @@ namespace Spartan
     class RHI_VertexBuffer;
     class RHI_IndexBuffer;
     class RHI_ConstantBuffer;
+    class RHI_StructuredBuffer;
+    class RHI_UploadAllocator;
+    class RHI_UploadManager;
+    class RHI_BindlessTable;
     class RHI_Sampler;
     class RHI_Viewport;
     class RHI_Texture;
@@ -237,6 +242,7 @@ namespace Spartan
         Sampler,
         Texture,
         ConstantBuffer,
+        StructuredBuffer,
         Undefined
     };
 
@@ -249,6 +255,7 @@ namespace Spartan
         Depth_Stencil_Attachment_Optimal,
         Depth_Stencil_Read_Only_Optimal,
         Shader_Read_Only_Optimal,
+        Transfer_Src_Optimal,
         Transfer_Dst_Optimal,
         Present_Src
     };
@@ -260,6 +267,13 @@ namespace Spartan
         Signaled
     };
 
+    enum class RHI_Resource_Type
+    {
+        Buffer,
+        Image,
+        ImageView
+    };
+
     inline const char* rhi_format_to_string(const RHI_Format result)
     {
         switch (result)
@@ -312,6 +326,13 @@ namespace Spartan
     static const uint8_t rhi_descriptor_max_constant_buffers_dynamic    = 10;
     static const uint8_t rhi_descriptor_max_samplers                    = 10;
     static const uint8_t rhi_descriptor_max_textures                    = 10;
+    static const uint8_t rhi_descriptor_max_structured_buffers          = 10;
+
+    // Descriptor sets and frame buffers are released after they go unused for a few frames, the resources they refer to
+    // have to outlive them in the deletion queue, or a new resource could reuse the handle of one that a cached object refers to
+    static const uint64_t rhi_max_frames_unused     = 8;
+    static const uint64_t rhi_deletion_queue_frames = 10;
+    static_assert(rhi_max_frames_unused < rhi_deletion_queue_frames, "Resources have to outlive the descriptor sets and frame buffers which refer to them");
     
     static const Math::Vector4  rhi_color_dont_care           = Math::Vector4(-std::numeric_limits<float>::infinity(), 0.0f, 0.0f, 0.0f);
     static const Math::Vector4  rhi_color_load                = Math::Vector4(std::numeric_limits<float>::infinity(), 0.0f, 0.0f, 0.0f);
@@ -322,4 +343,5 @@ namespace Spartan
     static const uint8_t        rhi_max_render_target_count   = 8;
     static const uint8_t        rhi_max_constant_buffer_count = 8;
     static const uint32_t       rhi_dynamic_offset_empty      = (std::numeric_limits<uint32_t>::max)();
+    static const uint32_t       rhi_bindless_index_invalid    = (std::numeric_limits<uint32_t>::max)();
 }
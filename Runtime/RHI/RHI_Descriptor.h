@@ -21,10 +21,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES =================
+//= INCLUDES ==============
 #include "RHI_Definition.h"
-#include "../Utilities/Hash.h"
-//============================
+//=========================
 
 namespace Spartan
 {
@@ -52,24 +51,15 @@ namespace Spartan
             this->name                          = name;
         }
 
-        uint32_t ComputeHash(bool include_resource) const
+        // Packs everything which affects the descriptor set layout (the slot and the stage flags always fit in 16 bits)
+        uint64_t GetLayoutKey() const
         {
-            uint32_t hash = 0;
-
-            Utility::Hash::hash_combine(hash, slot);
-            Utility::Hash::hash_combine(hash, stage);
-            Utility::Hash::hash_combine(hash, offset);
-            Utility::Hash::hash_combine(hash, range);
-            Utility::Hash::hash_combine(hash, is_storage);
-            Utility::Hash::hash_combine(hash, is_dynamic_constant_buffer);
-            Utility::Hash::hash_combine(hash, static_cast<uint32_t>(type));
-            Utility::Hash::hash_combine(hash, static_cast<uint32_t>(layout));
-            if (include_resource)
-            {
-                Utility::Hash::hash_combine(hash, resource);
-            }
-           
-            return hash;
+            return
+                static_cast<uint64_t>(slot  & 0xffff)                   |
+                static_cast<uint64_t>(stage & 0xffff)               << 16 |
+                static_cast<uint64_t>(type)                         << 32 |
+                static_cast<uint64_t>(is_storage)                   << 40 |
+                static_cast<uint64_t>(is_dynamic_constant_buffer)   << 41;
         }
 
         uint32_t slot                   = 0;
@@ -30,7 +30,7 @@ using namespace std;
 
 namespace Spartan
 {
-    RHI_DescriptorSet::RHI_DescriptorSet(const RHI_Device* rhi_device, const RHI_DescriptorSetLayoutCache* descriptor_set_layout_cache, const vector<RHI_Descriptor>& descriptors)
+    RHI_DescriptorSet::RHI_DescriptorSet(const RHI_Device* rhi_device, RHI_DescriptorSetLayoutCache* descriptor_set_layout_cache, const vector<RHI_Descriptor>& descriptors)
     {
         m_rhi_device                    = rhi_device;
         m_descriptor_set_layout_cache   = descriptor_set_layout_cache;
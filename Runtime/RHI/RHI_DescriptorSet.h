@@ -34,17 +34,19 @@ namespace Spartan
     {
     public:
         RHI_DescriptorSet() = default;
-        RHI_DescriptorSet(const RHI_Device* rhi_device, const RHI_DescriptorSetLayoutCache* descriptor_set_layout_cache, const std::vector<RHI_Descriptor>& descriptors);
+        RHI_DescriptorSet(const RHI_Device* rhi_device, RHI_DescriptorSetLayoutCache* descriptor_set_layout_cache, const std::vector<RHI_Descriptor>& descriptors);
         ~RHI_DescriptorSet();
 
-        void* GetResource() { return m_resource; }
+        void* GetResource()         { return m_resource; }
+        void* GetDescriptorPool()   { return m_descriptor_pool; }
 
     private:
         bool Create();
         void Update(const std::vector<RHI_Descriptor>& descriptors);
 
-        void* m_resource = nullptr;
-        const RHI_DescriptorSetLayoutCache* m_descriptor_set_layout_cache = nullptr;
+        void* m_resource        = nullptr;
+        void* m_descriptor_pool = nullptr;
+        RHI_DescriptorSetLayoutCache* m_descriptor_set_layout_cache = nullptr;
         const RHI_Device* m_rhi_device = nullptr;
     };
 }
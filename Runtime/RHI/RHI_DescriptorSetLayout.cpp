@@ -25,8 +25,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "RHI_ConstantBuffer.h"
 #include "RHI_Sampler.h"
 #include "RHI_Texture.h"
+#include "RHI_StructuredBuffer.h"
 #include "RHI_DescriptorSetLayoutCache.h"
 #include "RHI_DescriptorSet.h"
+#include "../Utilities/Hash.h"
 //=======================================
 
 //= NAMESPACES =====
@@ -43,16 +45,25 @@ namespace Spartan
         CreateResource(m_descriptors);
         m_dynamic_offsets.fill(rhi_dynamic_offset_empty);
 
+        m_key.reserve(m_descriptors.size());
         for (const RHI_Descriptor& descriptor : m_descriptors)
         {
-            Utility::Hash::hash_combine(m_hash, descriptor.ComputeHash(false));
+            m_key.emplace_back(descriptor.GetLayoutKey());
+        }
+
+        m_descriptor_set_key.resize(m_descriptors.size() * 4, 0);
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_descriptors.size()); i++)
+        {
+            UpdateDescriptorSetKey(i);
         }
     }
 
     bool RHI_DescriptorSetLayout::SetConstantBuffer(const uint32_t slot, RHI_ConstantBuffer* constant_buffer)
     {
-        for (RHI_Descriptor& descriptor : m_descriptors)
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_descriptors.size()); i++)
         {
+            RHI_Descriptor& descriptor = m_descriptors[i];
+
             if ((descriptor.type == RHI_Descriptor_Type::ConstantBuffer) && descriptor.slot == slot + rhi_shader_shift_buffer)
             {
                 // Determine if the descriptor set needs to bind
@@ -76,6 +87,7 @@ namespace Spartan
                 descriptor.resource = constant_buffer->GetResource();
                 descriptor.offset   = constant_buffer->GetOffset();
                 descriptor.range    = constant_buffer->GetStride();
+                UpdateDescriptorSetKey(i);
 
                 return true;
             }
@@ -86,8 +98,10 @@ namespace Spartan
 
     void RHI_DescriptorSetLayout::SetSampler(const uint32_t slot, RHI_Sampler* sampler)
     {
-        for (RHI_Descriptor& descriptor : m_descriptors)
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_descriptors.size()); i++)
         {
+            RHI_Descriptor& descriptor = m_descriptors[i];
+
             if (descriptor.type == RHI_Descriptor_Type::Sampler && descriptor.slot == slot + rhi_shader_shift_sampler)
             {
                 // Determine if the descriptor set needs to bind
@@ -95,6 +109,7 @@ namespace Spartan
 
                 // Update
                 descriptor.resource = sampler->GetResource();
+                UpdateDescriptorSetKey(i);
 
                 break;
             }
@@ -115,8 +130,9 @@ namespace Spartan
             return;
         }
 
-        for (RHI_Descriptor& descriptor : m_descriptors)
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_descriptors.size()); i++)
         {
+            RHI_Descriptor& descriptor = m_descriptors[i];
             const uint32_t slot_match = slot + (storage ? rhi_shader_shift_storage_texture : rhi_shader_shift_texture);
 
             if (descriptor.type == RHI_Descriptor_Type::Texture && descriptor.slot == slot_match)
@@ -127,6 +143,32 @@ namespace Spartan
                 // Update
                 descriptor.resource = texture->Get_Resource_View();
                 descriptor.layout   = texture->GetLayout();
+                UpdateDescriptorSetKey(i);
+
+                break;
+            }
+        }
+    }
+
+    void RHI_DescriptorSetLayout::SetStructuredBuffer(const uint32_t slot, RHI_StructuredBuffer* structured_buffer, const bool storage)
+    {
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_descriptors.size()); i++)
+        {
+            RHI_Descriptor& descriptor = m_descriptors[i];
+            const uint32_t slot_match = slot + (storage ? rhi_shader_shift_storage_texture : rhi_shader_shift_texture);
+
+            if (descriptor.type == RHI_Descriptor_Type::StructuredBuffer && descriptor.slot == slot_match)
+            {
+                // Determine if the descriptor set needs to bind
+                m_needs_to_bind = descriptor.resource   != structured_buffer->GetResource() ? true : m_needs_to_bind; // affects vkUpdateDescriptorSets
+                m_needs_to_bind = descriptor.offset     != structured_buffer->GetOffset()   ? true : m_needs_to_bind; // affects vkUpdateDescriptorSets
+                m_needs_to_bind = descriptor.range      != structured_buffer->GetRange()    ? true : m_needs_to_bind; // affects vkUpdateDescriptorSets
+
+                // Update
+                descriptor.resource = structured_buffer->GetResource();
+                descriptor.offset   = structured_buffer->GetOffset();
+                descriptor.range    = structured_buffer->GetRange();
+                UpdateDescriptorSetKey(i);
 
                 break;
             }
@@ -135,36 +177,46 @@ namespace Spartan
 
     bool RHI_DescriptorSetLayout::GetDescriptorSet(RHI_DescriptorSetLayoutCache* descriptor_set_layout_cache, RHI_DescriptorSet*& descriptor_set)
     {
-        // Integrate resource into the hash
-        uint32_t hash = m_hash;
-        for (const RHI_Descriptor& descriptor : m_descriptors)
+        // Only re-hash the key if a descriptor has changed
+        if (m_descriptor_set_key_dirty)
         {
-            Utility::Hash::hash_combine(hash, descriptor.resource);
+            m_descriptor_set_hash       = Utility::Hash::fnv1a_64(m_descriptor_set_key.data(), m_descriptor_set_key.size() * sizeof(uint64_t));
+            m_descriptor_set_key_dirty  = false;
         }
 
+        // Find a descriptor set with a matching key, the hash only narrows the search down
+        const auto range    = m_descriptor_sets.equal_range(m_descriptor_set_hash);
+        const auto it       = find_if(range.first, range.second, [this](const auto& entry) { return entry.second.key == m_descriptor_set_key; });
+
         // If we don't have a descriptor set to match that state, create one
-        const auto it = m_descriptor_sets.find(hash);
-        if (it == m_descriptor_sets.end())
+        if (it == range.second)
         {
-            // Only allocate if the descriptor set cache hash enough capacity
-            if (descriptor_set_layout_cache->HasEnoughCapacity())
+            // Different resources, same hash
+            if (range.first != range.second)
             {
-                // Create descriptor set
-                m_descriptor_sets[hash] = RHI_DescriptorSet(m_rhi_device, descriptor_set_layout_cache, m_descriptors);
-
-                // Out
-                descriptor_set = &m_descriptor_sets[hash];
+                descriptor_set_layout_cache->OnKeyCollision();
             }
-            else
-            {
+
+            // Create descriptor set, if allocation fails the draw is skipped
+            RHI_DescriptorSet descriptor_set_new(m_rhi_device, descriptor_set_layout_cache, m_descriptors);
+            if (!descriptor_set_new.GetResource())
                 return false;
-            }
+
+            auto it_new = m_descriptor_sets.emplace(m_descriptor_set_hash, DescriptorSet{ m_descriptor_set_key, descriptor_set_new, descriptor_set_layout_cache->GetFrame() });
+
+            // Out
+            descriptor_set  = &it_new->second.descriptor_set;
+            m_needs_to_bind = false;
         }
         else // retrieve the existing one
         {
+            it->second.frame_used = descriptor_set_layout_cache->GetFrame();
+
             if (m_needs_to_bind)
             {
-                descriptor_set  = &it->second;
+                descriptor_set_layout_cache->OnDescriptorSetReused();
+
+                descriptor_set  = &it->second.descriptor_set;
                 m_needs_to_bind = false;
             }
         }
@@ -172,6 +224,28 @@ namespace Spartan
         return true;
     }
 
+    uint32_t RHI_DescriptorSetLayout::FreeUnusedDescriptorSets(RHI_DescriptorSetLayoutCache* descriptor_set_layout_cache, const uint64_t frame_min)
+    {
+        uint32_t count = 0;
+
+        for (auto it = m_descriptor_sets.begin(); it != m_descriptor_sets.end();)
+        {
+            if (it->second.frame_used < frame_min)
+            {
+                RHI_DescriptorSet& descriptor_set = it->second.descriptor_set;
+                descriptor_set_layout_cache->FreeDescriptorSet(descriptor_set.GetResource(), descriptor_set.GetDescriptorPool());
+                it = m_descriptor_sets.erase(it);
+                count++;
+            }
+            else
+            {
+                it++;
+            }
+        }
+
+        return count;
+    }
+
     const std::array<uint32_t, Spartan::rhi_max_constant_buffer_count> RHI_DescriptorSetLayout::GetDynamicOffsets() const
     {
         // vkCmdBindDescriptorSets expects an array without empty values
@@ -205,4 +279,28 @@ namespace Spartan
 
         return dynamic_offset_count;
     }
+
+    void RHI_DescriptorSetLayout::UpdateDescriptorSetKey(const uint32_t descriptor_index)
+    {
+        const RHI_Descriptor& descriptor = m_descriptors[descriptor_index];
+
+        const array<uint64_t, 4> key =
+        {
+            reinterpret_cast<uint64_t>(descriptor.resource),
+            descriptor.offset,
+            descriptor.range,
+            static_cast<uint64_t>(descriptor.layout)
+        };
+
+        // Only the changed part of the key is written, the hash is re-computed lazily
+        uint64_t* key_current = &m_descriptor_set_key[descriptor_index * 4];
+        if (!equal(key.begin(), key.end(), key_current))
+        {
+            copy(key.begin(), key.end(), key_current);
+            m_descriptor_set_key_dirty = true;
+
+            // A different key means a different descriptor set, even if only the layout changed
+            m_needs_to_bind = true;
+        }
+    }
 }
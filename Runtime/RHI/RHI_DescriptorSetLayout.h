@@ -27,6 +27,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <vector>
 #include <array>
 #include "RHI_Descriptor.h"
+#include "RHI_DescriptorSet.h"
 //=================================
 
 namespace Spartan
@@ -41,23 +42,38 @@ namespace Spartan
         bool SetConstantBuffer(const uint32_t slot, RHI_ConstantBuffer* constant_buffer);
         void SetSampler(const uint32_t slot, RHI_Sampler* sampler);
         void SetTexture(const uint32_t slot, RHI_Texture* texture, const bool storage);
+        void SetStructuredBuffer(const uint32_t slot, RHI_StructuredBuffer* structured_buffer, const bool storage);
 
         bool GetDescriptorSet(RHI_DescriptorSetLayoutCache* descriptor_set_layout_cache, RHI_DescriptorSet*& descriptor_set);
+        uint32_t FreeUnusedDescriptorSets(RHI_DescriptorSetLayoutCache* descriptor_set_layout_cache, const uint64_t frame_min);
         const std::array<uint32_t, rhi_max_constant_buffer_count> GetDynamicOffsets() const;
         uint32_t GetDynamicOffsetCount()    const;
         uint32_t GetDescriptorSetCount()    const { return static_cast<uint32_t>(m_descriptor_sets.size()); }
+        const std::vector<uint64_t>& GetKey() const { return m_key; }
         void NeedsToBind()                        { m_needs_to_bind = true; }
         void* GetResource()                 const { return m_resource; }
 
     private:
         void CreateResource(const std::vector<RHI_Descriptor>& descriptors);
+        void UpdateDescriptorSetKey(const uint32_t descriptor_index);
 
         // Descriptor set layout
         void* m_resource = nullptr;
-        uint32_t m_hash = 0;
+        std::vector<uint64_t> m_key;
 
-        // Descriptor sets
-        std::unordered_map<uint32_t, RHI_DescriptorSet> m_descriptor_sets;
+        // Descriptor sets, keyed by the resources of the descriptors (resource, offset, range and layout per descriptor).
+        // The key is updated as descriptors change and sets which share a hash are told apart by their full key.
+        // Sets which go unused for a few frames are freed, so that the cache doesn't grow with every resource combination ever bound.
+        struct DescriptorSet
+        {
+            std::vector<uint64_t> key;
+            RHI_DescriptorSet descriptor_set;
+            uint64_t frame_used = 0;
+        };
+        std::unordered_multimap<uint64_t, DescriptorSet> m_descriptor_sets;
+        std::vector<uint64_t> m_descriptor_set_key;
+        uint64_t m_descriptor_set_hash      = 0;
+        bool m_descriptor_set_key_dirty     = true;
 
         // Descriptors
         std::vector<RHI_Descriptor> m_descriptors;
@@ -25,6 +25,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "RHI_Shader.h"
 #include "RHI_PipelineState.h"
 #include "RHI_DescriptorSetLayout.h"
+#include "RHI_Device.h"
+#include "../Utilities/Hash.h"
+#include "../Profiling/Profiler.h"
 //=======================================
 
 //= NAMESPACES =====
@@ -35,10 +38,23 @@ namespace Spartan
 {
     RHI_DescriptorSetLayoutCache::RHI_DescriptorSetLayoutCache(const RHI_Device* rhi_device)
     {
-        m_rhi_device = rhi_device;
+        m_rhi_device    = rhi_device;
+        m_profiler      = rhi_device->GetContext()->GetSubsystem<Profiler>();
+    }
+
+    void RHI_DescriptorSetLayoutCache::BeginFrame()
+    {
+        m_frame++;
+
+        // Free the descriptor sets which haven't been used for a while, by now no command list in flight can reference them
+        if (m_frame <= rhi_max_frames_unused)
+            return;
 
-        // Set the descriptor set capacity to an initial value
-        SetDescriptorSetCapacity(m_descriptor_set_capacity);
+        const uint64_t frame_min = m_frame - rhi_max_frames_unused;
+        for (auto& it : m_descriptor_set_layouts)
+        {
+            m_profiler->m_rhi_descriptor_sets_freed += it.second->FreeUnusedDescriptorSets(this, frame_min);
+        }
     }
 
     void RHI_DescriptorSetLayoutCache::SetPipelineState(RHI_PipelineState& pipeline_state)
@@ -46,24 +62,34 @@ namespace Spartan
         // Get pipeline descriptors
         GetDescriptors(pipeline_state, m_descriptors);
 
-        // Compute a hash for the descriptors
-        uint32_t hash = 0;
+        // Compute a key and a hash for the descriptors
+        m_descriptors_key.clear();
         for (const RHI_Descriptor& descriptor : m_descriptors)
         {
-            Utility::Hash::hash_combine(hash, descriptor.ComputeHash(false));
+            m_descriptors_key.emplace_back(descriptor.GetLayoutKey());
         }
+        const uint64_t hash = Utility::Hash::fnv1a_64(m_descriptors_key.data(), m_descriptors_key.size() * sizeof(uint64_t));
 
-        // If there is no descriptor set layout for this particular hash, create one
-        auto it = m_descriptor_set_layouts.find(hash);
-        if (it == m_descriptor_set_layouts.end())
+        // Find a descriptor set layout with a matching key, the hash only narrows the search down
+        const auto range    = m_descriptor_set_layouts.equal_range(hash);
+        auto it             = find_if(range.first, range.second, [this](const auto& entry) { return entry.second->GetKey() == m_descriptors_key; });
+
+        // If there is no descriptor set layout for these descriptors, create one
+        if (it == range.second)
         {
+            // Different descriptors, same hash
+            if (range.first != range.second)
+            {
+                OnKeyCollision();
+            }
+
             // Create a name for the descriptor set layout, very useful for Vulkan debugging
             string name = "CS:"     + (pipeline_state.shader_compute    ? pipeline_state.shader_compute->GetName()  : "null");
             name        += "-VS:"   + (pipeline_state.shader_vertex     ? pipeline_state.shader_vertex->GetName()   : "null");
             name        += "-PS:"   + (pipeline_state.shader_pixel      ? pipeline_state.shader_pixel->GetName()    : "null");
 
             // Emplace a new descriptor set layout
-            it = m_descriptor_set_layouts.emplace(make_pair(hash, make_shared<RHI_DescriptorSetLayout>(m_rhi_device, m_descriptors, name.c_str()))).first;
+            it = m_descriptor_set_layouts.emplace(make_pair(hash, make_shared<RHI_DescriptorSetLayout>(m_rhi_device, m_descriptors, name.c_str())));
         }
 
         // Get the descriptor set layout we will be using
@@ -89,22 +115,21 @@ namespace Spartan
         m_descriptor_layout_current->SetTexture(slot, texture, storage);
     }
 
+    void RHI_DescriptorSetLayoutCache::SetStructuredBuffer(const uint32_t slot, RHI_StructuredBuffer* structured_buffer, const bool storage)
+    {
+        SP_ASSERT(m_descriptor_layout_current != nullptr);
+        m_descriptor_layout_current->SetStructuredBuffer(slot, structured_buffer, storage);
+    }
+
     bool RHI_DescriptorSetLayoutCache::GetDescriptorSet(RHI_DescriptorSet*& descriptor_set)
     {
         SP_ASSERT(m_descriptor_layout_current != nullptr);
         return m_descriptor_layout_current->GetDescriptorSet(this, descriptor_set);
     }
 
-    void RHI_DescriptorSetLayoutCache::GrowIfNeeded()
+    void RHI_DescriptorSetLayoutCache::OnDescriptorSetReused()
     {
-        // If there is room for at least one more descriptor set (hence +1), we don't need to re-allocate yet
-        const uint32_t required_capacity = GetDescriptorSetCount() + 1;
-
-        // If we are over-budget, re-allocate the descriptor pool with double size
-        if (required_capacity > m_descriptor_set_capacity)
-        {
-            SetDescriptorSetCapacity(m_descriptor_set_capacity * 2);
-        }
+        m_profiler->m_rhi_descriptor_sets_reused++;
     }
 
     uint32_t RHI_DescriptorSetLayoutCache::GetDescriptorSetCount() const
@@ -28,6 +28,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace Spartan
 {
+    class Profiler;
+
     class SPARTAN_CLASS RHI_DescriptorSetLayoutCache : public Spartan_Object
     {
     public:
@@ -35,38 +37,53 @@ namespace Spartan
         ~RHI_DescriptorSetLayoutCache();
 
         void SetPipelineState(RHI_PipelineState& pipeline_state);
-        void Reset(uint32_t descriptor_set_capacity = 0);
+        void Reset();
+
+        // Frees descriptor sets which haven't been used for a while, can't be called while a command list is recording with this cache
+        void BeginFrame();
+        uint64_t GetFrame() const { return m_frame; }
 
         // Descriptor resource updating
         bool SetConstantBuffer(const uint32_t slot, RHI_ConstantBuffer* constant_buffer);
         void SetSampler(const uint32_t slot, RHI_Sampler* sampler);
         void SetTexture(const uint32_t slot, RHI_Texture* texture, const bool storage);
+        void SetStructuredBuffer(const uint32_t slot, RHI_StructuredBuffer* structured_buffer, const bool storage);
 
         RHI_DescriptorSetLayout* GetCurrentDescriptorSetLayout() const { return m_descriptor_layout_current; }
         bool GetDescriptorSet(RHI_DescriptorSet*& descriptor_set);
-        void* GetResource_DescriptorPool() const { return m_descriptor_pool; }
 
-        // Capacity
-        bool HasEnoughCapacity() const { return m_descriptor_set_capacity > GetDescriptorSetCount(); }
-        void GrowIfNeeded();
+        // Descriptor set allocation, pools are added as they fill up so allocation only fails if the device is out of memory
+        bool AllocateDescriptorSet(void* descriptor_set_layout, void*& descriptor_set, void*& descriptor_pool);
+        void FreeDescriptorSet(void* descriptor_set, void* descriptor_pool);
+        uint32_t GetDescriptorSetCount() const;
+        uint32_t GetDescriptorPoolCount() const { return static_cast<uint32_t>(m_descriptor_pools.size()); }
+        void OnDescriptorSetReused();
+
+        // Hash collisions (descriptor set layouts and descriptor sets), they are resolved by comparing full keys
+        void OnKeyCollision()               { m_collision_count++; }
+        uint32_t GetCollisionCount() const  { return m_collision_count; }
 
     private:
-        uint32_t GetDescriptorSetCount() const;
-        void SetDescriptorSetCapacity(uint32_t descriptor_capacity);
-        bool CreateDescriptorPool(uint32_t descriptor_set_capacity);
+        bool CreateDescriptorPool();
+        void DestroyDescriptorPools();
         void GetDescriptors(RHI_PipelineState& pipeline_state, std::vector<RHI_Descriptor>& descriptors);
 
         // Descriptor set layouts 
-        std::unordered_map<std::size_t, std::shared_ptr<RHI_DescriptorSetLayout>> m_descriptor_set_layouts;
+        std::unordered_multimap<uint64_t, std::shared_ptr<RHI_DescriptorSetLayout>> m_descriptor_set_layouts;
         RHI_DescriptorSetLayout* m_descriptor_layout_current = nullptr;
         std::vector<RHI_Descriptor> m_descriptors;
+        std::vector<uint64_t> m_descriptors_key;
 
-        // Descriptor pool
-        uint32_t m_descriptor_set_capacity = 16;
-        void* m_descriptor_pool = nullptr;
+        // Descriptor pools
+        std::vector<void*> m_descriptor_pools;
+        uint32_t m_descriptor_pool_index                = 0;    // the pool which served the last allocation
+        const uint32_t m_descriptor_pool_capacity       = 256;  // descriptor sets per pool
+        uint64_t m_frame                                = 0;
 
         // Misc
         std::atomic<bool> m_descriptor_set_layouts_being_cleared = false;
+        std::atomic<uint32_t> m_collision_count = 0;
+        Profiler* m_profiler = nullptr;
         const RHI_Device* m_rhi_device;
     };
 }
@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Spartan.h"
 #include "RHI_Device.h"
 #include "RHI_Implementation.h"
+#include "RHI_UploadManager.h"
 //=============================
 
 //= NAMESPACES ===============
@@ -112,4 +113,25 @@ namespace Spartan
 
         return 0;
     }
+
+    void RHI_Device::DeletionQueue_Add(const RHI_Resource_Type type, void* resource)
+    {
+        if (!resource)
+            return;
+
+        DeletionQueueEntry entry;
+        entry.type          = type;
+        entry.resource      = resource;
+        entry.upload_value  = m_upload_manager ? m_upload_manager->GetValuePending() : 0;
+
+        lock_guard<mutex> lock(m_deletion_queue_mutex);
+        entry.frame = m_deletion_queue_frame;
+        m_deletion_queue.emplace_back(entry);
+    }
+
+    uint32_t RHI_Device::DeletionQueue_GetCount() const
+    {
+        lock_guard<mutex> lock(m_deletion_queue_mutex);
+        return static_cast<uint32_t>(m_deletion_queue.size());
+    }
 }
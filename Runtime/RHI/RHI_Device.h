@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Core/Spartan_Object.h"
 #include <mutex>
 #include <memory>
+#include <deque>
 #include "../Display/DisplayMode.h"
 #include "RHI_PhysicalDevice.h"
 //=================================
@@ -45,25 +46,48 @@ namespace Spartan
 
         // Queue
         bool Queue_Present(void* swapchain_view, uint32_t* image_index, RHI_Semaphore* wait_semaphore = nullptr) const;
-        bool Queue_Submit(const RHI_Queue_Type type, const uint32_t wait_flags, void* cmd_buffer, RHI_Semaphore* wait_semaphore = nullptr, RHI_Semaphore* signal_semaphore = nullptr, RHI_Fence* signal_fence = nullptr) const;
+        bool Queue_Submit(const RHI_Queue_Type type, const uint32_t wait_flags, void* cmd_buffer, RHI_Semaphore* wait_semaphore = nullptr, RHI_Semaphore* signal_semaphore = nullptr, RHI_Fence* signal_fence = nullptr, const uint64_t signal_value = 0, RHI_Semaphore* wait_semaphore_timeline = nullptr, const uint64_t wait_value = 0) const;
         bool Queue_Wait(const RHI_Queue_Type type) const;
         bool Queue_WaitAll() const;
         void* Queue_Get(const RHI_Queue_Type type) const;
         uint32_t Queue_Index(const RHI_Queue_Type type) const;
 
+        // Deletion queue, resources which the GPU might still be using are destroyed a few frames later instead of waiting for the queues
+        void DeletionQueue_Add(const RHI_Resource_Type type, void* resource);
+        void DeletionQueue_Parse(const bool force = false); // once per frame, force destroys everything (the GPU has to be idle)
+        uint32_t DeletionQueue_GetCount() const;
+
         // Misc
         bool ValidateResolution(const uint32_t width, const uint32_t height) const;
-        auto IsInitialized()                const { return m_initialized; }
-        RHI_Context* GetContextRhi()        const { return m_rhi_context.get(); }
-        Context* GetContext()               const { return m_context; }
-        uint32_t GetEnabledGraphicsStages() const { return m_enabled_graphics_shader_stages; }
+        auto IsInitialized()                   const { return m_initialized; }
+        RHI_Context* GetContextRhi()           const { return m_rhi_context.get(); }
+        Context* GetContext()                  const { return m_context; }
+        RHI_UploadManager* GetUploadManager()  const { return m_upload_manager.get(); }
+        uint32_t GetEnabledGraphicsStages()    const { return m_enabled_graphics_shader_stages; }
+        bool IsBindlessSupported()             const { return m_bindless_supported; }
+        bool IsDrawIndirectCountSupported()    const { return m_draw_indirect_count_supported; }
 
     private:    
         std::vector<PhysicalDevice> m_physical_devices;
         uint32_t m_physical_device_index            = 0;
         uint32_t m_enabled_graphics_shader_stages   = 0;
+        bool m_bindless_supported                   = false;
+        bool m_draw_indirect_count_supported        = false;
         bool m_initialized                          = false;
         mutable std::mutex m_queue_mutex;
         std::shared_ptr<RHI_Context> m_rhi_context;
+        std::shared_ptr<RHI_UploadManager> m_upload_manager;
+
+        // Deletion queue
+        struct DeletionQueueEntry
+        {
+            RHI_Resource_Type type  = RHI_Resource_Type::Buffer;
+            void* resource          = nullptr;
+            uint64_t frame          = 0; // frame it was added on
+            uint64_t upload_value   = 0; // uploads which might still be writing to it
+        };
+        std::deque<DeletionQueueEntry> m_deletion_queue;
+        mutable std::mutex m_deletion_queue_mutex;
+        uint64_t m_deletion_queue_frame = 0;
     };
 }
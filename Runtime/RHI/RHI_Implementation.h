@@ -295,6 +295,7 @@ static const VkImageLayout vulkan_image_layout[] =
     VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
     VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
     VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
 };
@@ -306,6 +307,7 @@ static const VkImageLayout vulkan_image_layout[] =
     #include "Vulkan/vk_mem_alloc.h"
     #include <vector>
     #include <unordered_map>
+    #include <mutex>
 #endif
 
 // RHI_Context
@@ -337,7 +339,9 @@ namespace Spartan
             VkFormat surface_format                                 = VK_FORMAT_UNDEFINED;
             VkColorSpaceKHR surface_color_space                     = VK_COLOR_SPACE_MAX_ENUM_KHR;
             VmaAllocator allocator                                  = nullptr;
+            VkPipelineCache pipeline_cache                          = nullptr;
             std::unordered_map<uint64_t, VmaAllocation> allocations;
+            std::mutex allocations_mutex;
 
             // Extensions
             #ifdef DEBUG
@@ -385,6 +389,7 @@ namespace Spartan
 
         // Device limits
         static inline uint32_t texture_2d_dimension_max = 16384;
+        static inline uint32_t constant_buffer_size_max = 16384; // the range a single constant buffer binding can cover
         static const uint8_t descriptors_max            = 255;
 
         // Queues
@@ -117,6 +117,47 @@ namespace Spartan
                 };
             }
 
+            if (vertex_type == RHI_Vertex_Type_PositionTextureNormalTangentPacked)
+            {
+                m_vertex_attributes =
+                {
+                    { "POSITION",   0, binding, RHI_Format_R16G16B16A16_Snorm,  offsetof(RHI_Vertex_PosTexNorTan_Packed, pos) },
+                    { "TEXCOORD",   1, binding, RHI_Format_R16G16_Float,        offsetof(RHI_Vertex_PosTexNorTan_Packed, tex) },
+                    { "NORMAL",     2, binding, RHI_Format_R16G16B16A16_Snorm,  offsetof(RHI_Vertex_PosTexNorTan_Packed, nor_tan) }
+                };
+            }
+
+            if (vertex_type == RHI_Vertex_Type_PositionPacked)
+            {
+                m_vertex_attributes =
+                {
+                    { "POSITION", 0, binding, RHI_Format_R16G16B16A16_Snorm, offsetof(RHI_Vertex_Pos_Packed, pos) }
+                };
+            }
+
+            if (vertex_type == RHI_Vertex_Type_PositionTextureNormalTangentSkinPacked)
+            {
+                const uint32_t offset = offsetof(RHI_Vertex_PosTexNorTanSkin_Packed, vertex_packed);
+                m_vertex_attributes =
+                {
+                    { "POSITION",       0, binding, RHI_Format_R16G16B16A16_Snorm,  offset + offsetof(RHI_Vertex_PosTexNorTan_Packed, pos) },
+                    { "TEXCOORD",       1, binding, RHI_Format_R16G16_Float,        offset + offsetof(RHI_Vertex_PosTexNorTan_Packed, tex) },
+                    { "NORMAL",         2, binding, RHI_Format_R16G16B16A16_Snorm,  offset + offsetof(RHI_Vertex_PosTexNorTan_Packed, nor_tan) },
+                    { "BLENDINDICES",   3, binding, RHI_Format_R8G8B8A8_Unorm,      offsetof(RHI_Vertex_PosTexNorTanSkin_Packed, bones) },
+                    { "BLENDWEIGHT",    4, binding, RHI_Format_R8G8B8A8_Unorm,      offsetof(RHI_Vertex_PosTexNorTanSkin_Packed, weights) }
+                };
+            }
+
+            if (vertex_type == RHI_Vertex_Type_PositionSkinPacked)
+            {
+                m_vertex_attributes =
+                {
+                    { "POSITION",       0, binding, RHI_Format_R16G16B16A16_Snorm,  offsetof(RHI_Vertex_PosSkin_Packed, pos) },
+                    { "BLENDINDICES",   1, binding, RHI_Format_R8G8B8A8_Unorm,      offsetof(RHI_Vertex_PosSkin_Packed, bones) },
+                    { "BLENDWEIGHT",    2, binding, RHI_Format_R8G8B8A8_Unorm,      offsetof(RHI_Vertex_PosSkin_Packed, weights) }
+                };
+            }
+
             if (vertex_shader_blob && !m_vertex_attributes.empty())
             {
                 return _CreateResource(vertex_shader_blob);
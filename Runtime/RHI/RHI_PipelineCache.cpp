@@ -23,9 +23,17 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Spartan.h"
 #include "RHI_PipelineCache.h"
 #include "RHI_Texture.h"
+#include "RHI_Shader.h"
 #include "RHI_Pipeline.h"
 #include "RHI_SwapChain.h"
+#include "RHI_BlendState.h"
+#include "RHI_RasterizerState.h"
+#include "RHI_DepthStencilState.h"
+#include "RHI_BindlessTable.h"
 #include "RHI_DescriptorSetLayoutCache.h"
+#include "../Core/Stopwatch.h"
+#include "../IO/FileStream.h"
+#include "../Threading/Threading.h"
 //=======================================
 
 //= NAMESPACES =====
@@ -34,6 +42,45 @@ using namespace std;
 
 namespace Spartan
 {
+    // Bump whenever the layout of a description changes
+    static const uint32_t pipeline_descriptions_version = 3;
+
+    static uint8_t get_load_op(const Math::Vector4& clear_color)
+    {
+        return clear_color == rhi_color_dont_care ? 0 : clear_color == rhi_color_load ? 1 : 2;
+    }
+
+    static uint8_t get_load_op_depth(const float clear_depth)
+    {
+        return clear_depth == rhi_depth_dont_care ? 0 : clear_depth == rhi_depth_load ? 1 : 2;
+    }
+
+    static uint8_t get_load_op_stencil(const uint32_t clear_stencil)
+    {
+        return clear_stencil == rhi_stencil_dont_care ? 0 : clear_stencil == rhi_stencil_load ? 1 : 2;
+    }
+
+    RHI_PipelineCache::RHI_PipelineCache(const RHI_Device* rhi_device, const string& directory)
+    {
+        m_rhi_device    = rhi_device;
+        m_directory     = directory;
+
+        if (!FileSystem::Exists(m_directory))
+        {
+            FileSystem::CreateDirectory_(m_directory);
+        }
+
+        CreateDriverCache();
+        LoadDescriptions();
+    }
+
+    RHI_PipelineCache::~RHI_PipelineCache()
+    {
+        SaveDescriptions();
+        m_cache.clear();
+        DestroyDriverCache();
+    }
+
     RHI_Pipeline* RHI_PipelineCache::GetPipeline(RHI_CommandList* cmd_list, RHI_PipelineState& pipeline_state, RHI_DescriptorSetLayout* descriptor_set_layout)
     {
         // Validate it
@@ -47,17 +94,346 @@ namespace Spartan
         pipeline_state.TransitionRenderTargetLayouts(cmd_list);
 
         // Compute a hash for it
-        uint32_t hash = pipeline_state.ComputeHash();
+        const uint64_t hash = pipeline_state.ComputeHash();
+
+        // Find a pipeline with a matching key, the hash only narrows the search down
+        const auto range = m_cache.equal_range(hash);
+        auto it = find_if(range.first, range.second, [&pipeline_state](const auto& entry) { return *entry.second->GetPipelineState() == pipeline_state; });
 
         // If no pipeline exists for this state, create one
-        auto it = m_cache.find(hash);
-        if (it == m_cache.end())
+        if (it == range.second)
         {
+            Stopwatch stopwatch;
+
+            // Different state, same hash
+            if (range.first != range.second)
+            {
+                m_collision_count++;
+                LOG_WARNING("Pipeline state hash collision (%llu), the pipelines will be told apart by their keys.", hash);
+            }
+
             // Cache a new pipeline
-            it = m_cache.emplace(make_pair(hash, move(make_shared<RHI_Pipeline>(m_rhi_device, pipeline_state, descriptor_set_layout)))).first;
-            LOG_INFO("A new pipeline has been created.");
+            it = m_cache.emplace(make_pair(hash, move(make_shared<RHI_Pipeline>(m_rhi_device, pipeline_state, descriptor_set_layout))));
+
+            // Remember it, so that it can be pre-warmed the next time
+            PipelineDescription description;
+            if (Describe(pipeline_state, description))
+            {
+                m_descriptions[hash] = description;
+            }
+
+            // Creating a pipeline mid-frame is a hitch
+            const float duration_ms = stopwatch.GetElapsedTimeMs();
+            m_hitch_count++;
+            m_hitch_time_ms += duration_ms;
+
+            LOG_INFO("A new pipeline has been created (%.2f ms).", duration_ms);
         }
 
         return it->second.get();
     }
+
+    void RHI_PipelineCache::RegisterObject(const string& name, Spartan_Object* object)
+    {
+        if (!object)
+            return;
+
+        lock_guard<mutex> lock(m_mutex_objects);
+        m_objects[name]                 = object;
+        m_object_names[object->GetId()] = name;
+    }
+
+    void RHI_PipelineCache::Prewarm(RHI_DescriptorSetLayoutCache* descriptor_set_layout_cache, Threading* threading)
+    {
+        if (m_prewarmed)
+            return;
+
+        m_prewarmed = true;
+
+        if (m_descriptions_previous.empty())
+            return;
+
+        Stopwatch stopwatch;
+
+        // Resolve the pipeline states and their descriptor set layouts on this thread, the descriptor set layout cache is not thread safe
+        vector<RHI_PipelineState> pipeline_states;
+        vector<RHI_DescriptorSetLayout*> descriptor_set_layouts;
+        pipeline_states.reserve(m_descriptions_previous.size());
+        descriptor_set_layouts.reserve(m_descriptions_previous.size());
+        for (const PipelineDescription& description : m_descriptions_previous)
+        {
+            RHI_PipelineState& pipeline_state = pipeline_states.emplace_back();
+            if (!Resolve(description, pipeline_state) || !pipeline_state.IsValid() || pipeline_state.IsDummy())
+            {
+                pipeline_states.pop_back();
+                continue;
+            }
+
+            // Deduce the render target layouts, without transitioning anything
+            pipeline_state.TransitionRenderTargetLayouts(nullptr);
+
+            const uint64_t hash = pipeline_state.ComputeHash();
+            if (m_descriptions.find(hash) != m_descriptions.end())
+            {
+                pipeline_states.pop_back();
+                continue;
+            }
+
+            descriptor_set_layout_cache->SetPipelineState(pipeline_state);
+            descriptor_set_layouts.emplace_back(descriptor_set_layout_cache->GetCurrentDescriptorSetLayout());
+            m_descriptions[hash] = description;
+        }
+        m_descriptions_previous.clear();
+
+        // Create the pipelines in parallel, this is where the driver compiles them
+        atomic<uint32_t> pipelines_remaining = static_cast<uint32_t>(pipeline_states.size());
+        for (uint32_t i = 0; i < static_cast<uint32_t>(pipeline_states.size()); i++)
+        {
+            threading->AddTask([this, &pipeline_states, &descriptor_set_layouts, &pipelines_remaining, i]()
+            {
+                shared_ptr<RHI_Pipeline> pipeline = make_shared<RHI_Pipeline>(m_rhi_device, pipeline_states[i], descriptor_set_layouts[i]);
+
+                {
+                    lock_guard<mutex> lock(m_mutex);
+                    m_cache.emplace(make_pair(pipeline_states[i].GetHash(), move(pipeline)));
+                }
+
+                m_prewarmed_count++;
+                pipelines_remaining--;
+            });
+        }
+
+        // Wait
+        while (pipelines_remaining != 0)
+        {
+            this_thread::yield();
+        }
+
+        LOG_INFO("%d pipelines have been pre-warmed (%.2f ms).", m_prewarmed_count.load(), stopwatch.GetElapsedTimeMs());
+    }
+
+    bool RHI_PipelineCache::Describe(const RHI_PipelineState& pipeline_state, PipelineDescription& description) const
+    {
+        lock_guard<mutex> lock(m_mutex_objects);
+
+        // Returns false if the object is not registered, in which case the pipeline can't be described
+        auto get_name = [this](const Spartan_Object* object, string& name)
+        {
+            if (!object)
+                return true;
+
+            auto it = m_object_names.find(object->GetId());
+            if (it == m_object_names.end())
+                return false;
+
+            name = it->second;
+            return true;
+        };
+
+        bool registered = true;
+        registered &= get_name(pipeline_state.shader_vertex,               description.shader_vertex);
+        registered &= get_name(pipeline_state.shader_pixel,                description.shader_pixel);
+        registered &= get_name(pipeline_state.shader_compute,              description.shader_compute);
+        registered &= get_name(pipeline_state.rasterizer_state,            description.rasterizer_state);
+        registered &= get_name(pipeline_state.blend_state,                 description.blend_state);
+        registered &= get_name(pipeline_state.depth_stencil_state,         description.depth_stencil_state);
+        registered &= get_name(pipeline_state.render_target_swapchain,     description.render_target_swapchain);
+        registered &= get_name(pipeline_state.render_target_depth_texture, description.render_target_depth_texture);
+        registered &= get_name(pipeline_state.bindless_table,              description.bindless_table);
+        for (uint32_t i = 0; i < rhi_max_render_target_count; i++)
+        {
+            registered &= get_name(pipeline_state.render_target_color_textures[i], description.render_target_color_textures[i]);
+            description.load_op_color[i] = get_load_op(pipeline_state.clear_color[i]);
+        }
+
+        if (!registered)
+            return false;
+
+        description.load_op_depth                           = get_load_op_depth(pipeline_state.clear_depth);
+        description.load_op_stencil                         = get_load_op_stencil(pipeline_state.clear_stencil);
+        description.primitive_topology                      = static_cast<uint32_t>(pipeline_state.primitive_topology);
+        description.vertex_buffer_stride                    = pipeline_state.vertex_buffer_stride;
+        description.render_target_depth_texture_read_only   = pipeline_state.render_target_depth_texture_read_only;
+
+        return true;
+    }
+
+    bool RHI_PipelineCache::Resolve(const PipelineDescription& description, RHI_PipelineState& pipeline_state)
+    {
+        // Returns false if a named object can't be found
+        auto get_object = [this](const string& name, auto*& object)
+        {
+            object = nullptr;
+            if (name.empty())
+                return true;
+
+            object = static_cast<remove_reference_t<decltype(object)>>(ResolveObject(name));
+            return object != nullptr;
+        };
+
+        // Shaders have to be compiled (and of the expected type) before a pipeline can be created with them
+        auto get_shader = [&get_object](const string& name, RHI_Shader*& shader, const RHI_Shader_Type type)
+        {
+            if (!get_object(name, shader))
+                return false;
+
+            if (shader)
+            {
+                shader->WaitForCompilation();
+                return shader->IsCompiled() && shader->GetShaderStage() == type;
+            }
+
+            return true;
+        };
+
+        if (!get_shader(description.shader_vertex,                  pipeline_state.shader_vertex, RHI_Shader_Vertex))   return false;
+        if (!get_shader(description.shader_pixel,                   pipeline_state.shader_pixel, RHI_Shader_Pixel))     return false;
+        if (!get_shader(description.shader_compute,                 pipeline_state.shader_compute, RHI_Shader_Compute)) return false;
+        if (!get_object(description.rasterizer_state,               pipeline_state.rasterizer_state))                   return false;
+        if (!get_object(description.blend_state,                    pipeline_state.blend_state))                        return false;
+        if (!get_object(description.depth_stencil_state,            pipeline_state.depth_stencil_state))                return false;
+        if (!get_object(description.render_target_swapchain,        pipeline_state.render_target_swapchain))            return false;
+        if (!get_object(description.render_target_depth_texture,    pipeline_state.render_target_depth_texture))        return false;
+        if (!get_object(description.bindless_table,                 pipeline_state.bindless_table))                     return false;
+        for (uint32_t i = 0; i < rhi_max_render_target_count; i++)
+        {
+            if (!get_object(description.render_target_color_textures[i], pipeline_state.render_target_color_textures[i]))
+                return false;
+
+            // Any value which is not one of the special ones results in a clear
+            const uint8_t load_op           = description.load_op_color[i];
+            pipeline_state.clear_color[i]   = load_op == 0 ? rhi_color_dont_care : load_op == 1 ? rhi_color_load : Math::Vector4::Zero;
+        }
+
+        pipeline_state.clear_depth                              = description.load_op_depth   == 0 ? rhi_depth_dont_care   : description.load_op_depth   == 1 ? rhi_depth_load   : 0.0f;
+        pipeline_state.clear_stencil                            = description.load_op_stencil == 0 ? rhi_stencil_dont_care : description.load_op_stencil == 1 ? rhi_stencil_load : 0;
+        pipeline_state.primitive_topology                       = static_cast<RHI_PrimitiveTopology_Mode>(description.primitive_topology);
+        pipeline_state.vertex_buffer_stride                     = description.vertex_buffer_stride;
+        pipeline_state.render_target_depth_texture_read_only    = description.render_target_depth_texture_read_only;
+
+        return true;
+    }
+
+    Spartan_Object* RHI_PipelineCache::ResolveObject(const string& name)
+    {
+        {
+            lock_guard<mutex> lock(m_mutex_objects);
+
+            auto it = m_objects.find(name);
+            if (it != m_objects.end())
+                return it->second;
+        }
+
+        // Objects which are created on demand
+        if (m_resolver)
+        {
+            if (Spartan_Object* object = m_resolver(name))
+            {
+                RegisterObject(name, object);
+                return object;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void RHI_PipelineCache::LoadDescriptions()
+    {
+        const string file_path = m_directory + "\\pipelines.bin";
+        if (!FileSystem::Exists(file_path))
+            return;
+
+        auto file = make_unique<FileStream>(file_path, FileStream_Read);
+        if (!file->IsOpen())
+            return;
+
+        if (file->ReadAs<uint32_t>() != pipeline_descriptions_version)
+            return;
+
+        // The smallest description is the length of every name (all empty) and the fixed size fields
+        const uint32_t count                = file->ReadAs<uint32_t>();
+        const uint64_t description_size_min = (9 + rhi_max_render_target_count) * sizeof(uint32_t) + (rhi_max_render_target_count + 2) * sizeof(uint8_t) + 2 * sizeof(uint32_t) + sizeof(bool);
+        if (!file->IsGood() || count * description_size_min > file->GetRemaining())
+        {
+            LOG_WARNING("Ignoring corrupt pipeline descriptions \"%s\"", file_path.c_str());
+            return;
+        }
+
+        m_descriptions_previous.resize(count);
+        for (PipelineDescription& description : m_descriptions_previous)
+        {
+            file->Read(&description.shader_vertex);
+            file->Read(&description.shader_pixel);
+            file->Read(&description.shader_compute);
+            file->Read(&description.rasterizer_state);
+            file->Read(&description.blend_state);
+            file->Read(&description.depth_stencil_state);
+            file->Read(&description.render_target_swapchain);
+            file->Read(&description.render_target_depth_texture);
+            file->Read(&description.bindless_table);
+            for (uint32_t i = 0; i < rhi_max_render_target_count; i++)
+            {
+                file->Read(&description.render_target_color_textures[i]);
+                file->Read(&description.load_op_color[i]);
+            }
+            file->Read(&description.load_op_depth);
+            file->Read(&description.load_op_stencil);
+            file->Read(&description.primitive_topology);
+            file->Read(&description.vertex_buffer_stride);
+            file->Read(&description.render_target_depth_texture_read_only);
+
+            // Whatever was read so far can't be trusted either, so warm up with nothing rather than with garbage
+            if (!file->IsGood())
+            {
+                LOG_WARNING("Ignoring corrupt pipeline descriptions \"%s\"", file_path.c_str());
+                m_descriptions_previous.clear();
+                return;
+            }
+        }
+    }
+
+    void RHI_PipelineCache::SaveDescriptions() const
+    {
+        // Write to a temporary file and move it in place once complete, so a crash while writing doesn't leave a truncated file behind
+        const string file_path      = m_directory + "\\pipelines.bin";
+        const string file_path_temp = file_path + ".tmp";
+
+        auto file = make_unique<FileStream>(file_path_temp, FileStream_Write);
+        if (!file->IsOpen())
+            return;
+
+        file->Write(pipeline_descriptions_version);
+        file->Write(static_cast<uint32_t>(m_descriptions.size()));
+        for (const auto& it : m_descriptions)
+        {
+            const PipelineDescription& description = it.second;
+
+            file->Write(description.shader_vertex);
+            file->Write(description.shader_pixel);
+            file->Write(description.shader_compute);
+            file->Write(description.rasterizer_state);
+            file->Write(description.blend_state);
+            file->Write(description.depth_stencil_state);
+            file->Write(description.render_target_swapchain);
+            file->Write(description.render_target_depth_texture);
+            file->Write(description.bindless_table);
+            for (uint32_t i = 0; i < rhi_max_render_target_count; i++)
+            {
+                file->Write(description.render_target_color_textures[i]);
+                file->Write(description.load_op_color[i]);
+            }
+            file->Write(description.load_op_depth);
+            file->Write(description.load_op_stencil);
+            file->Write(description.primitive_topology);
+            file->Write(description.vertex_buffer_stride);
+            file->Write(description.render_target_depth_texture_read_only);
+        }
+
+        const bool written = file->IsGood();
+        file->Close();
+        if (!written || !FileSystem::Rename(file_path_temp, file_path))
+        {
+            FileSystem::Delete(file_path_temp);
+        }
+    }
 }
@@ -22,7 +22,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES ======================
+#include <array>
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <unordered_map>
 #include "RHI_Definition.h"
 #include "../Core/Spartan_Object.h"
@@ -30,17 +35,83 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace Spartan
 {
+    class Threading;
+
     class RHI_PipelineCache : public Spartan_Object
     {
     public:
-        RHI_PipelineCache(const RHI_Device* rhi_device) { m_rhi_device = rhi_device; }
+        RHI_PipelineCache(const RHI_Device* rhi_device, const std::string& directory);
+        ~RHI_PipelineCache();
+
         RHI_Pipeline* GetPipeline(RHI_CommandList* cmd_list, RHI_PipelineState& pipeline_state, RHI_DescriptorSetLayout* descriptor_set_layout);
 
+        // Pre-warming
+        // Pipelines are remembered across sessions by the names of the objects they reference (shaders, states, render targets),
+        // so only pipelines which exclusively reference registered objects can be pre-warmed. The resolver can create objects on demand (e.g. shader variations).
+        void RegisterObject(const std::string& name, Spartan_Object* object);
+        void SetResolver(const std::function<Spartan_Object*(const std::string& name)>& resolver) { m_resolver = resolver; }
+        void Prewarm(RHI_DescriptorSetLayoutCache* descriptor_set_layout_cache, Threading* threading);
+
+        // Statistics
+        uint32_t GetPipelineCount()     const { return static_cast<uint32_t>(m_cache.size()); }
+        uint32_t GetPrewarmedCount()    const { return m_prewarmed_count; }
+        uint32_t GetHitchCount()        const { return m_hitch_count; }
+        float GetHitchTimeMs()          const { return m_hitch_time_ms; }
+        uint32_t GetCollisionCount()    const { return m_collision_count; }
+
     private:
-        // <hash of pipeline state, pipeline state object>
-        std::unordered_map<uint32_t, std::shared_ptr<RHI_Pipeline>> m_cache;
+        // A pipeline state in terms of object names, so that it outlives the session
+        struct PipelineDescription
+        {
+            std::string shader_vertex;
+            std::string shader_pixel;
+            std::string shader_compute;
+            std::string rasterizer_state;
+            std::string blend_state;
+            std::string depth_stencil_state;
+            std::string render_target_swapchain;
+            std::string render_target_depth_texture;
+            std::string bindless_table;
+            std::array<std::string, rhi_max_render_target_count> render_target_color_textures;
+            std::array<uint8_t, rhi_max_render_target_count> load_op_color = {};
+            uint8_t load_op_depth                                   = 0;
+            uint8_t load_op_stencil                                 = 0;
+            uint32_t primitive_topology                             = 0;
+            uint32_t vertex_buffer_stride                           = 0;
+            bool render_target_depth_texture_read_only              = false;
+        };
+
+        bool Describe(const RHI_PipelineState& pipeline_state, PipelineDescription& description) const;
+        bool Resolve(const PipelineDescription& description, RHI_PipelineState& pipeline_state);
+        Spartan_Object* ResolveObject(const std::string& name);
+        void LoadDescriptions();
+        void SaveDescriptions() const;
+
+        // Driver cache (implemented per API)
+        void CreateDriverCache();
+        void DestroyDriverCache();
+
+        // <hash of pipeline state, pipeline state object>, pipelines which share a hash are told apart by their full key
+        std::unordered_multimap<uint64_t, std::shared_ptr<RHI_Pipeline>> m_cache;
+        std::mutex m_mutex;
+
+        // Pre-warming (objects can be registered from any thread, e.g. shader variations requested by materials which are being loaded)
+        std::unordered_map<std::string, Spartan_Object*> m_objects;
+        std::unordered_map<uint32_t, std::string> m_object_names; // <object id, name>
+        std::function<Spartan_Object*(const std::string& name)> m_resolver;
+        mutable std::mutex m_mutex_objects;
+        std::vector<PipelineDescription> m_descriptions_previous;
+        std::unordered_map<uint64_t, PipelineDescription> m_descriptions; // <hash of pipeline state, description>
+        bool m_prewarmed = false;
+
+        // Statistics
+        std::atomic<uint32_t> m_prewarmed_count = 0;
+        uint32_t m_hitch_count                  = 0;
+        float m_hitch_time_ms                   = 0.0f;
+        uint32_t m_collision_count              = 0;
 
-        // Dependencies
+        // Misc
+        std::string m_directory;
         const RHI_Device* m_rhi_device;
     };
 }
@@ -29,6 +29,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "RHI_InputLayout.h"
 #include "RHI_RasterizerState.h"
 #include "RHI_DepthStencilState.h"
+#include "RHI_BindlessTable.h"
 #include "..\Utilities\Hash.h"
 //================================
 
@@ -38,15 +39,29 @@ using namespace std;
 
 namespace Spartan
 {
+    static uint32_t get_load_op(const Math::Vector4& clear_color)
+    {
+        return clear_color == rhi_color_dont_care ? 0 : clear_color == rhi_color_load ? 1 : 2;
+    }
+
+    static uint32_t get_load_op_depth(const float clear_depth)
+    {
+        return clear_depth == rhi_depth_dont_care ? 0 : clear_depth == rhi_depth_load ? 1 : 2;
+    }
+
+    static uint32_t get_load_op_stencil(const uint32_t clear_stencil)
+    {
+        return clear_stencil == rhi_stencil_dont_care ? 0 : clear_stencil == rhi_stencil_load ? 1 : 2;
+    }
+
     RHI_PipelineState::RHI_PipelineState()
     {
-        m_frame_buffers.fill(nullptr);
         clear_color.fill(rhi_color_load);
     }
 
     RHI_PipelineState::~RHI_PipelineState()
     {
-        DestroyFrameBuffer();
+        DestroyRenderPass();
     }
 
     bool RHI_PipelineState::IsValid()
@@ -122,6 +137,23 @@ namespace Spartan
         return 0;
     }
 
+    RHI_Viewport RHI_PipelineState::GetViewport() const
+    {
+        if (viewport.IsDefined())
+            return viewport;
+
+        return RHI_Viewport(0.0f, 0.0f, static_cast<float>(GetWidth()), static_cast<float>(GetHeight()));
+    }
+
+    Math::Rectangle RHI_PipelineState::GetScissor() const
+    {
+        if (scissor.IsDefined())
+            return scissor;
+
+        const RHI_Viewport viewport_effective = GetViewport();
+        return Math::Rectangle(viewport_effective.x, viewport_effective.y, viewport_effective.x + viewport_effective.width, viewport_effective.y + viewport_effective.height);
+    }
+
     void RHI_PipelineState::ResetClearValues()
     {
         clear_color.fill(rhi_color_load);
@@ -129,109 +161,72 @@ namespace Spartan
         clear_stencil = rhi_stencil_load;
     }
 
-    uint32_t RHI_PipelineState::ComputeHash()
+    uint64_t RHI_PipelineState::ComputeHash()
     {
-        m_hash = 0;
-
-        Utility::Hash::hash_combine(m_hash, dynamic_scissor);
-        Utility::Hash::hash_combine(m_hash, viewport.x);
-        Utility::Hash::hash_combine(m_hash, viewport.y);
-        Utility::Hash::hash_combine(m_hash, viewport.width);
-        Utility::Hash::hash_combine(m_hash, viewport.height);
-        Utility::Hash::hash_combine(m_hash, primitive_topology);
-        Utility::Hash::hash_combine(m_hash, vertex_buffer_stride);
-        Utility::Hash::hash_combine(m_hash, render_target_color_texture_array_index);
-        Utility::Hash::hash_combine(m_hash, render_target_depth_stencil_texture_array_index);
-        Utility::Hash::hash_combine(m_hash, render_target_swapchain ? render_target_swapchain->GetId() : 0);
-
-        if (!dynamic_scissor)
-        {
-            Utility::Hash::hash_combine(m_hash, scissor.left);
-            Utility::Hash::hash_combine(m_hash, scissor.top);
-            Utility::Hash::hash_combine(m_hash, scissor.right);
-            Utility::Hash::hash_combine(m_hash, scissor.bottom);
-        }
-
-        if (rasterizer_state)
-        {
-            Utility::Hash::hash_combine(m_hash, rasterizer_state->GetId());
-        }
-
-        if (blend_state)
-        {
-            Utility::Hash::hash_combine(m_hash, blend_state->GetId());
-        }
-
-        if (depth_stencil_state)
-        {
-            Utility::Hash::hash_combine(m_hash, depth_stencil_state->GetId());
-        }
-
-        // Shaders
-        {
-            if (shader_compute)
-            {
-                Utility::Hash::hash_combine(m_hash, shader_compute->GetId());
-            }
-
-            if (shader_vertex)
-            {
-                Utility::Hash::hash_combine(m_hash, shader_vertex->GetId());
-            }
-
-            if (shader_pixel)
-            {
-                Utility::Hash::hash_combine(m_hash, shader_pixel->GetId());
-            }
-        }
-
-        // RTs
-        bool has_rt_color = false;
+        // Viewport, scissor and render target array slices are dynamic state, while the render targets
+        // themselves are bound via frame buffers, so only their formats can affect the pipeline.
+        m_key.fill(0);
+
+        // Shaders and states
+        m_key[0] = shader_vertex        ? shader_vertex->GetId()        : 0;
+        m_key[1] = shader_pixel         ? shader_pixel->GetId()         : 0;
+        m_key[2] = shader_compute       ? shader_compute->GetId()       : 0;
+        m_key[3] = rasterizer_state     ? rasterizer_state->GetId()     : 0;
+        m_key[4] = blend_state          ? blend_state->GetId()          : 0;
+        m_key[5] = depth_stencil_state  ? depth_stencil_state->GetId()  : 0;
+        m_key[6] = static_cast<uint32_t>(primitive_topology);
+        m_key[7] = vertex_buffer_stride;
+
+        // Bindless table (appended, so that the packing below stays the same)
+        m_key[13] = bindless_table ? bindless_table->GetId() : 0;
+
+        // Render target formats (8 bits each) and load operations (2 bits each)
+        bool has_rt_color = render_target_swapchain != nullptr;
         {
-            uint8_t load_op = 0;
-
             // Color
             for (uint32_t i = 0; i < rhi_max_render_target_count; i++)
             {
                 if (RHI_Texture* texture = render_target_color_textures[i])
                 {
-                    Utility::Hash::hash_combine(m_hash, texture->GetId());
-
-                    load_op = clear_color[i] == rhi_color_dont_care ? 0 : clear_color[i] == rhi_color_load ? 1 : 2;
-                    Utility::Hash::hash_combine(m_hash, load_op);
-
-                    has_rt_color = true;
+                    m_key[8 + i / 4] |= (static_cast<uint32_t>(texture->GetFormat()) & 0xff) << ((i % 4) * 8);
+                    m_key[11]        |= get_load_op(clear_color[i]) << (i * 2);
+                    has_rt_color     = true;
                 }
             }
 
+            // Swapchain
+            if (render_target_swapchain)
+            {
+                m_key[10] |= 1 | ((static_cast<uint32_t>(render_target_swapchain->GetFormat()) & 0xff) << 8);
+                m_key[11] |= get_load_op(clear_color[0]);
+            }
+
             // Depth
             if (render_target_depth_texture)
             {
-                Utility::Hash::hash_combine(m_hash, render_target_depth_texture->GetId());
-
-                load_op = clear_depth == rhi_depth_dont_care ? 0 : clear_depth == rhi_depth_load ? 1 : 2;
-                Utility::Hash::hash_combine(m_hash, load_op);
-
-                load_op = clear_stencil == rhi_stencil_dont_care ? 0 : clear_stencil == rhi_stencil_load ? 1 : 2;
-                Utility::Hash::hash_combine(m_hash, load_op);
+                m_key[10] |= 2 | ((static_cast<uint32_t>(render_target_depth_texture->GetFormat()) & 0xff) << 16);
+                m_key[11] |= get_load_op_depth(clear_depth)     << 16;
+                m_key[11] |= get_load_op_stencil(clear_stencil) << 18;
             }
         }
 
-        // Initial and final layouts
+        // Initial and final layouts (8 bits each)
         {
             if (has_rt_color)
             {
-                Utility::Hash::hash_combine(m_hash, render_target_color_layout_initial);
-                Utility::Hash::hash_combine(m_hash, render_target_color_layout_final);
+                m_key[12] |= static_cast<uint32_t>(render_target_color_layout_initial);
+                m_key[12] |= static_cast<uint32_t>(render_target_color_layout_final) << 8;
             }
 
             if (render_target_depth_texture)
             {
-                Utility::Hash::hash_combine(m_hash, render_target_depth_layout_initial);
-                Utility::Hash::hash_combine(m_hash, render_target_depth_layout_final);
+                m_key[12] |= static_cast<uint32_t>(render_target_depth_layout_initial) << 16;
+                m_key[12] |= static_cast<uint32_t>(render_target_depth_layout_final)   << 24;
             }
         }
 
+        m_hash = Utility::Hash::fnv1a_64(m_key.data(), m_key.size() * sizeof(uint32_t));
+
         return m_hash;
     }
 
@@ -246,7 +241,11 @@ namespace Spartan
                 {
                     RHI_Image_Layout layout = RHI_Image_Layout::Color_Attachment_Optimal;
 
-                    texture->SetLayout(layout, cmd_list);
+                    if (cmd_list)
+                    {
+                        texture->SetLayout(layout, cmd_list);
+                    }
+
                     render_target_color_layout_initial   = layout;
                     render_target_color_layout_final     = layout;
                 }
@@ -267,7 +266,11 @@ namespace Spartan
         {
             RHI_Image_Layout layout = render_target_depth_texture_read_only ? RHI_Image_Layout::Depth_Stencil_Read_Only_Optimal :  RHI_Image_Layout::Depth_Stencil_Attachment_Optimal;
         
-            texture->SetLayout(layout, cmd_list);
+            if (cmd_list)
+            {
+                texture->SetLayout(layout, cmd_list);
+            }
+
             render_target_depth_layout_initial   = layout;
             render_target_depth_layout_final     = layout;
         }
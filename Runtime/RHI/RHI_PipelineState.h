@@ -27,6 +27,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Core/Spartan_Object.h"
 #include "../Math/Rectangle.h"
 #include <array>
+#include <map>
 //=================================
 
 namespace Spartan
@@ -38,19 +39,21 @@ namespace Spartan
         ~RHI_PipelineState();
 
         bool IsValid();
-        bool CreateFrameBuffer(const RHI_Device* rhi_device);
-        void* GetFrameBuffer() const;
-        uint32_t ComputeHash();
+        bool CreateRenderPass(const RHI_Device* rhi_device);
+        void* GetFrameBuffer(const RHI_PipelineState& pipeline_state, const uint64_t frame);
+        uint64_t ComputeHash();
         void TransitionRenderTargetLayouts(RHI_CommandList* cmd_list);
         uint32_t GetWidth() const;
         uint32_t GetHeight() const;
+        RHI_Viewport GetViewport() const;
+        Math::Rectangle GetScissor() const;
         void ResetClearValues();
-        uint32_t GetHash()                              const { return m_hash; }
+        uint64_t GetHash()                              const { return m_hash; }
         bool IsGraphics()                               const { return (shader_vertex != nullptr || shader_pixel != nullptr) && !shader_compute; }
         bool IsCompute()                                const { return shader_compute != nullptr && !IsGraphics(); }
         bool IsDummy()                                  const { return !shader_compute && !shader_vertex && !shader_pixel; }
         void* GetRenderPass()                           const { return m_render_pass; }
-        bool operator==(const RHI_PipelineState& rhs)   const { return m_hash == rhs.GetHash(); }
+        bool operator==(const RHI_PipelineState& rhs)   const { return m_key == rhs.m_key; }
 
         //= Static, modification can potentially generate a new pipeline ===================
         RHI_Shader* shader_vertex                       = nullptr;
@@ -61,12 +64,10 @@ namespace Spartan
         RHI_DepthStencilState* depth_stencil_state      = nullptr;
         RHI_SwapChain* render_target_swapchain          = nullptr;
         RHI_PrimitiveTopology_Mode primitive_topology   = RHI_PrimitiveTopology_Unknown;
-        RHI_Viewport viewport                           = RHI_Viewport::Undefined;
-        Math::Rectangle scissor                         = Math::Rectangle::Zero;
-        bool dynamic_scissor                            = false;
         uint32_t vertex_buffer_stride                   = 0;
+        RHI_BindlessTable* bindless_table               = nullptr; // bound as a second descriptor set
 
-        // RTs
+        // RTs (only their formats affect the pipeline, the textures themselves are bound via a frame buffer)
         RHI_Texture* render_target_depth_texture = nullptr;
         std::array<RHI_Texture*, rhi_max_render_target_count> render_target_color_textures =
         {
@@ -80,10 +81,6 @@ namespace Spartan
             nullptr
         };
 
-        // RT indices (affect render pass)
-        uint32_t render_target_color_texture_array_index            = 0;
-        uint32_t render_target_depth_stencil_texture_array_index    = 0;
-
         // Clear values
         float clear_depth       = rhi_depth_load;
         uint32_t clear_stencil  = rhi_stencil_load;
@@ -91,7 +88,11 @@ namespace Spartan
         //==================================================================================
 
         //= Dynamic, modification is free ============================================
-        bool render_target_depth_texture_read_only = false;
+        RHI_Viewport viewport                                       = RHI_Viewport::Undefined;
+        Math::Rectangle scissor                                     = Math::Rectangle::Zero;
+        bool render_target_depth_texture_read_only                  = false;
+        uint32_t render_target_color_texture_array_index            = 0;
+        uint32_t render_target_depth_stencil_texture_array_index    = 0;
 
         // Constant buffer slots which refer to dynamic buffers (-1 means unused)
         std::array<int, rhi_max_constant_buffer_count> dynamic_constant_buffer_slots =
@@ -106,16 +107,25 @@ namespace Spartan
         //============================================================================
 
     private:
-        void DestroyFrameBuffer();
+        void DestroyRenderPass();
 
         RHI_Image_Layout render_target_color_layout_initial = RHI_Image_Layout::Undefined;
         RHI_Image_Layout render_target_color_layout_final   = RHI_Image_Layout::Undefined;
         RHI_Image_Layout render_target_depth_layout_initial = RHI_Image_Layout::Undefined;
         RHI_Image_Layout render_target_depth_layout_final   = RHI_Image_Layout::Undefined;
 
-        uint32_t m_hash  = 0;
-        void* m_render_pass = nullptr;
-        std::array<void*, rhi_max_constant_buffer_count> m_frame_buffers;
+        // Everything that affects the pipeline, packed. The hash only narrows down lookups, equality is decided by the key.
+        std::array<uint32_t, 14> m_key  = {};
+        uint64_t m_hash                 = 0;
+        void* m_render_pass             = nullptr;
+
+        // Frame buffers compatible with the render pass, keyed by the exact attachments they were created with
+        struct FrameBuffer
+        {
+            void* resource      = nullptr;
+            uint64_t frame_used = 0;
+        };
+        std::map<std::array<uint32_t, rhi_max_render_target_count + 5>, FrameBuffer> m_frame_buffers;
 
         // Dependencies
         const RHI_Device* m_rhi_device = nullptr;
@@ -0,0 +1,231 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ======================
+#include "Spartan.h"
+#include <thread>
+#include "RHI_ShaderCache.h"
+#include "../IO/FileStream.h"
+#include "../Utilities/Hash.h"
+//=================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    // Bump whenever the layout of a cache entry or the reflected descriptors change
+    static const uint32_t shader_cache_version = 2;
+    static const uint32_t shader_cache_magic   = 0x53505343; // SPSC
+
+    static void hash_fnv1a(uint64_t& hash, const string& str)
+    {
+        // The size goes in first, so that fields can't bleed into each other
+        const uint64_t size = static_cast<uint64_t>(str.size());
+        hash = Utility::Hash::fnv1a_64(&size, sizeof(size), hash);
+        hash = Utility::Hash::fnv1a_64(str.data(), str.size(), hash);
+    }
+
+    static string read_file(const string& file_path)
+    {
+        ifstream in(file_path);
+        stringstream buffer;
+        buffer << in.rdbuf();
+        return buffer.str();
+    }
+
+    RHI_ShaderCache::RHI_ShaderCache(const string& directory)
+    {
+        m_directory = directory;
+
+        if (!FileSystem::Exists(m_directory))
+        {
+            FileSystem::CreateDirectory_(m_directory);
+        }
+    }
+
+    uint64_t RHI_ShaderCache::ComputeKey(const string& shader, const vector<string>& arguments, const string& compiler_version) const
+    {
+        uint64_t hash = Utility::Hash::fnv1a_64_offset;
+
+        // Source
+        if (FileSystem::IsFile(shader))
+        {
+            hash_fnv1a(hash, read_file(shader));
+
+            // Included files (their paths too, as they decide what gets included)
+            vector<string> file_paths_included;
+            FileSystem::GetIncludedFilePathsFromFilePath(shader, file_paths_included);
+            for (const string& file_path : file_paths_included)
+            {
+                hash_fnv1a(hash, file_path);
+                hash_fnv1a(hash, read_file(file_path));
+            }
+        }
+        else
+        {
+            hash_fnv1a(hash, shader);
+        }
+
+        // Arguments (entry point, profile, defines etc.)
+        for (const string& argument : arguments)
+        {
+            hash_fnv1a(hash, argument);
+        }
+
+        // Compiler
+        hash_fnv1a(hash, compiler_version);
+
+        return hash;
+    }
+
+    bool RHI_ShaderCache::Load(const uint64_t key, vector<uint32_t>* bytecode, vector<RHI_Descriptor>* descriptors) const
+    {
+        const string file_path = GetFilePath(key);
+        if (!FileSystem::Exists(file_path))
+            return false;
+
+        auto file = make_unique<FileStream>(file_path, FileStream_Read);
+        if (!file->IsOpen())
+            return false;
+
+        // Validate header
+        if (file->ReadAs<uint32_t>() != shader_cache_magic || file->ReadAs<uint32_t>() != shader_cache_version || file->ReadAs<uint64_t>() != key)
+        {
+            LOG_WARNING("Ignoring outdated or corrupt shader cache entry \"%s\"", file_path.c_str());
+            return false;
+        }
+
+        // Bytecode (a length past the end of the file fails the stream)
+        file->Read(bytecode);
+        if (!file->IsGood())
+        {
+            LOG_WARNING("Ignoring corrupt shader cache entry \"%s\"", file_path.c_str());
+            return false;
+        }
+
+        // Descriptors, the smallest one is a name length, a type, a slot, a stage and two flags
+        const uint32_t descriptor_count     = file->ReadAs<uint32_t>();
+        const uint64_t descriptor_size_min  = 4 * sizeof(uint32_t) + 2 * sizeof(bool);
+        if (!file->IsGood() || descriptor_count * descriptor_size_min > file->GetRemaining())
+        {
+            LOG_WARNING("Ignoring corrupt shader cache entry \"%s\"", file_path.c_str());
+            return false;
+        }
+
+        descriptors->clear();
+        descriptors->reserve(descriptor_count);
+        for (uint32_t i = 0; i < descriptor_count; i++)
+        {
+            RHI_Descriptor& descriptor            = descriptors->emplace_back();
+            descriptor.name                       = file->ReadAs<string>();
+            descriptor.type                       = static_cast<RHI_Descriptor_Type>(file->ReadAs<uint32_t>());
+            descriptor.slot                       = file->ReadAs<uint32_t>();
+            descriptor.stage                      = file->ReadAs<uint32_t>();
+            descriptor.is_storage                 = file->ReadAs<bool>();
+            descriptor.is_dynamic_constant_buffer = file->ReadAs<bool>();
+
+            if (!file->IsGood())
+            {
+                LOG_WARNING("Ignoring corrupt shader cache entry \"%s\"", file_path.c_str());
+                return false;
+            }
+        }
+
+        // The entry is only complete if it ends with the magic (it could have been cut short by a crash)
+        if (file->ReadAs<uint32_t>() != shader_cache_magic || !file->IsGood() || bytecode->empty())
+        {
+            LOG_WARNING("Ignoring incomplete shader cache entry \"%s\"", file_path.c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    bool RHI_ShaderCache::Save(const uint64_t key, const vector<uint32_t>& bytecode, const vector<RHI_Descriptor>& descriptors) const
+    {
+        // Write to a file of this thread and move it in place once complete, so the entry is never seen half written
+        // (shaders compile in parallel, and the engine could go down in the middle of writing)
+        const string file_path      = GetFilePath(key);
+        const string file_path_temp = file_path + "." + to_string(hash<thread::id>()(this_thread::get_id())) + ".tmp";
+
+        auto file = make_unique<FileStream>(file_path_temp, FileStream_Write);
+        if (!file->IsOpen())
+            return false;
+
+        // Header
+        file->Write(shader_cache_magic);
+        file->Write(shader_cache_version);
+        file->Write(key);
+
+        // Bytecode
+        file->Write(bytecode);
+
+        // Descriptors
+        file->Write(static_cast<uint32_t>(descriptors.size()));
+        for (const RHI_Descriptor& descriptor : descriptors)
+        {
+            file->Write(descriptor.name);
+            file->Write(static_cast<uint32_t>(descriptor.type));
+            file->Write(descriptor.slot);
+            file->Write(descriptor.stage);
+            file->Write(descriptor.is_storage);
+            file->Write(descriptor.is_dynamic_constant_buffer);
+        }
+
+        file->Write(shader_cache_magic);
+
+        const bool written = file->IsGood();
+        file->Close();
+        if (!written || !FileSystem::Rename(file_path_temp, file_path))
+        {
+            FileSystem::Delete(file_path_temp);
+            return false;
+        }
+
+        return true;
+    }
+
+    void RHI_ShaderCache::AddCompilation(const bool hit, const float duration_ms)
+    {
+        const uint64_t duration_us = static_cast<uint64_t>(duration_ms * 1000.0f);
+
+        if (hit)
+        {
+            m_hit_count++;
+            m_hit_time_us += duration_us;
+        }
+        else
+        {
+            m_miss_count++;
+            m_miss_time_us += duration_us;
+        }
+    }
+
+    string RHI_ShaderCache::GetFilePath(const uint64_t key) const
+    {
+        char file_name[32];
+        snprintf(file_name, sizeof(file_name), "%016llx.bin", static_cast<unsigned long long>(key));
+        return m_directory + "\\" + file_name;
+    }
+}
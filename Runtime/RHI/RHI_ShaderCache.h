@@ -0,0 +1,65 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES ======================
+#include <atomic>
+#include <string>
+#include <vector>
+#include "RHI_Descriptor.h"
+#include "../Core/Spartan_Object.h"
+//=================================
+
+namespace Spartan
+{
+    // An on-disk cache of compiled shaders (bytecode and reflected descriptors), so that only new or modified shaders have to be compiled.
+    // Entries are content addressed, the key covers the source (and the included files), the compiler arguments (which include the defines)
+    // and the compiler version. Entries which no longer match anything are simply never read again.
+    class SPARTAN_CLASS RHI_ShaderCache : public Spartan_Object
+    {
+    public:
+        RHI_ShaderCache(const std::string& directory);
+        ~RHI_ShaderCache() = default;
+
+        // Thread safe, shaders compile in parallel
+        uint64_t ComputeKey(const std::string& shader, const std::vector<std::string>& arguments, const std::string& compiler_version) const;
+        bool Load(const uint64_t key, std::vector<uint32_t>* bytecode, std::vector<RHI_Descriptor>* descriptors) const;
+        bool Save(const uint64_t key, const std::vector<uint32_t>& bytecode, const std::vector<RHI_Descriptor>& descriptors) const;
+
+        // Statistics
+        void AddCompilation(const bool hit, const float duration_ms);
+        uint32_t GetHitCount()  const { return m_hit_count; }
+        uint32_t GetMissCount() const { return m_miss_count; }
+        float GetHitTimeMs()    const { return static_cast<float>(m_hit_time_us) / 1000.0f; }
+        float GetMissTimeMs()   const { return static_cast<float>(m_miss_time_us) / 1000.0f; }
+
+    private:
+        std::string GetFilePath(const uint64_t key) const;
+
+        std::string m_directory;
+        std::atomic<uint32_t> m_hit_count       = 0;
+        std::atomic<uint32_t> m_miss_count      = 0;
+        std::atomic<uint64_t> m_hit_time_us     = 0;
+        std::atomic<uint64_t> m_miss_time_us    = 0;
+    };
+}
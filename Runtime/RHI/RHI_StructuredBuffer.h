@@ -0,0 +1,78 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES ======================
+#include <memory>
+#include "RHI_Definition.h"
+#include "../Core/Spartan_Object.h"
+//=================================
+
+namespace Spartan
+{
+    // Arguments of an indexed indirect draw, laid out like VkDrawIndexedIndirectCommand (and D3D12_DRAW_INDEXED_ARGUMENTS)
+    struct RHI_DrawIndexedIndirectArguments
+    {
+        uint32_t index_count;
+        uint32_t instance_count;
+        uint32_t index_offset;
+        int32_t vertex_offset;
+        uint32_t instance_offset;
+    };
+
+    class SPARTAN_CLASS RHI_StructuredBuffer : public Spartan_Object
+    {
+    public:
+        // Buffers with an upload allocator are dynamic, every update is sub-allocated from the allocator's pages and is valid for a frame.
+        // The rest live in device memory and can only be written by the GPU (compute shaders, clears), they can also hold indirect arguments (Vulkan only).
+        RHI_StructuredBuffer(const std::shared_ptr<RHI_Device>& rhi_device, const uint32_t stride, const uint32_t element_count, const std::string& name, RHI_UploadAllocator* upload_allocator = nullptr);
+        ~RHI_StructuredBuffer() { _destroy(); }
+
+        // Dynamic buffers only
+        bool Update(const void* data, const uint32_t element_count);
+
+        void* GetResource()         const { return m_buffer; }
+        uint32_t GetStride()        const { return m_stride; }
+        uint32_t GetElementCount()  const { return m_element_count; }
+        uint64_t GetOffset()        const { return m_offset; }
+        uint64_t GetRange()         const { return m_range; }
+        bool IsDynamic()            const { return m_upload_allocator != nullptr; }
+
+    private:
+        bool _create();
+        void _destroy();
+
+        uint32_t m_stride           = 0;
+        uint32_t m_element_count    = 0;
+        uint64_t m_offset           = 0;
+        uint64_t m_range            = 0;
+
+        // API
+        void* m_buffer      = nullptr;
+        void* m_allocation  = nullptr;
+
+        // Dependencies
+        std::shared_ptr<RHI_Device> m_rhi_device;
+        RHI_UploadAllocator* m_upload_allocator = nullptr;
+    };
+}
@@ -58,6 +58,7 @@ namespace Spartan
         uint32_t GetFlags()                     const { return m_flags; }
         uint32_t GetCmdIndex()                  const { return m_cmd_index; }
         uint32_t GetImageIndex()                const { return m_image_index; }
+        RHI_Format GetFormat()                  const { return m_format; }
         bool IsInitialized()                    const { return m_initialized; }
         bool PresentEnabled()                   const { return m_present_enabled; }
         RHI_CommandList* GetCmdList()                 { return m_cmd_index < static_cast<uint32_t>(m_cmd_lists.size()) ? m_cmd_lists[m_cmd_index].get() : nullptr; }
@@ -165,8 +165,8 @@ namespace Spartan
             m_size_gpu = 0;
             for (uint8_t mip_index = 0; mip_index < m_mip_count; mip_index++)
             {
-                const uint32_t mip_width  = m_width >> mip_index;
-                const uint32_t mip_height = m_height >> mip_index;
+                const uint32_t mip_width  = Math::Helper::Max(m_width >> mip_index, 1u);
+                const uint32_t mip_height = Math::Helper::Max(m_height >> mip_index, 1u);
 
                 m_size_cpu += mip_index < m_data.size() ? m_data[mip_index].size() * sizeof(std::byte) : 0;
                 m_size_gpu += mip_width * mip_height * (m_bits_per_channel / 8);
@@ -33,14 +33,16 @@ namespace Spartan
 {
     enum RHI_Texture_Flags : uint16_t
     {
-        RHI_Texture_Sampled                    = 1 << 0,
+        RHI_Texture_Sampled                 = 1 << 0,
         RHI_Texture_Storage                 = 1 << 1,
         RHI_Texture_RenderTarget            = 1 << 2,
         RHI_Texture_DepthStencil            = 1 << 3,
         RHI_Texture_DepthStencilReadOnly    = 1 << 4,
         RHI_Texture_Grayscale               = 1 << 5,
         RHI_Texture_Transparent             = 1 << 6,
-        RHI_Texture_GenerateMipsWhenLoading = 1 << 7
+        RHI_Texture_GenerateMipsWhenLoading = 1 << 7,
+        RHI_Texture_Srgb                    = 1 << 8, // the color channels are gamma encoded, mips are generated in linear space
+        RHI_Texture_AsyncCompute            = 1 << 9  // shared with the compute queue, only for textures which async compute passes access
     };
 
     enum RHI_Shader_View_Type : uint8_t
@@ -73,6 +75,9 @@ namespace Spartan
         auto GetTransparency() const                                    { return m_flags & RHI_Texture_Transparent; }
         void SetTransparency(const bool is_transparent)                 { is_transparent ? m_flags |= RHI_Texture_Transparent : m_flags &= ~RHI_Texture_Transparent; }
 
+        auto GetSrgb() const                                            { return m_flags & RHI_Texture_Srgb; }
+        void SetSrgb(const bool is_srgb)                                { is_srgb ? m_flags |= RHI_Texture_Srgb : m_flags &= ~RHI_Texture_Srgb; }
+
         uint32_t GetBitsPerChannel() const                              { return m_bits_per_channel; }
         void SetBitsPerChannel(const uint32_t bits)                     { m_bits_per_channel = bits; }
         uint32_t GetBytesPerChannel() const                             { return m_bits_per_channel / 8; }
@@ -99,6 +104,7 @@ namespace Spartan
         bool IsStorage()        const { return m_flags & RHI_Texture_Storage; }
         bool IsDepthStencil()   const { return m_flags & RHI_Texture_DepthStencil; }
         bool IsRenderTarget()   const { return m_flags & RHI_Texture_RenderTarget; }
+        bool IsAsyncCompute()   const { return m_flags & RHI_Texture_AsyncCompute; }
 
         // Format type
         bool IsDepthFormat()            const { return m_format == RHI_Format_D32_Float || m_format == RHI_Format_D32_Float_S8X24_Uint; }
@@ -0,0 +1,153 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ====================
+#include "Spartan.h"
+#include "RHI_UploadAllocator.h"
+#include "RHI_Device.h"
+//===============================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    RHI_UploadAllocator::RHI_UploadAllocator(const shared_ptr<RHI_Device>& rhi_device, const uint32_t frame_count, const uint64_t page_size /*= 2 * 1024 * 1024*/)
+    {
+        m_rhi_device    = rhi_device;
+        m_name          = "upload_allocator";
+        m_page_size     = page_size;
+        m_alignment     = GetAlignmentRhi();
+        m_pages_frame.resize(frame_count != 0 ? frame_count : 1);
+    }
+
+    RHI_UploadAllocator::~RHI_UploadAllocator()
+    {
+        // Wait in case any page is still in use by the GPU
+        m_rhi_device->Queue_WaitAll();
+
+        for (unique_ptr<Page>& page : m_pages)
+        {
+            DestroyPage(page.get());
+        }
+    }
+
+    void RHI_UploadAllocator::BeginFrame(const uint32_t frame_index)
+    {
+        lock_guard<mutex> lock(m_mutex);
+
+        // The GPU is done with the pages of this frame, so they can be reused
+        m_frame_index = frame_index % static_cast<uint32_t>(m_pages_frame.size());
+        for (Page* page : m_pages_frame[m_frame_index])
+        {
+            page->offset = 0;
+            m_pages_free.emplace_back(page);
+        }
+        m_pages_frame[m_frame_index].clear();
+
+        // The current page belongs to the previous frame
+        m_page_current = nullptr;
+
+        m_bytes_uploaded_last_frame = m_bytes_uploaded.exchange(0);
+        m_frame++;
+    }
+
+    bool RHI_UploadAllocator::Upload(const void* data, const uint64_t size, RHI_UploadAllocation& allocation)
+    {
+        const uint64_t size_aligned = (size + m_alignment - 1) & ~static_cast<uint64_t>(m_alignment - 1);
+        if (!data || size == 0 || size_aligned > m_page_size)
+        {
+            LOG_ERROR("Can't upload %d bytes, the page size is %d bytes", static_cast<uint32_t>(size), static_cast<uint32_t>(m_page_size));
+            return false;
+        }
+
+        // Bump the offset of the current page, and only lock when it's full
+        Page* page      = m_page_current.load();
+        uint64_t offset = 0;
+        while (true)
+        {
+            if (page)
+            {
+                offset = page->offset.fetch_add(size_aligned);
+                if (offset + size_aligned <= m_page_size)
+                    break;
+            }
+
+            lock_guard<mutex> lock(m_mutex);
+
+            // Another thread might have switched pages already
+            if (m_page_current.load() != page)
+            {
+                page = m_page_current.load();
+                continue;
+            }
+
+            page = AcquirePage();
+            if (!page)
+                return false;
+
+            m_page_current = page;
+        }
+
+        memcpy(page->mapped + offset, data, size);
+
+        if (!page->coherent)
+        {
+            FlushPage(page, offset, size_aligned);
+        }
+
+        allocation.buffer   = page->buffer;
+        allocation.offset   = static_cast<uint32_t>(offset);
+        m_bytes_uploaded    += size_aligned;
+
+        return true;
+    }
+
+    RHI_UploadAllocator::Page* RHI_UploadAllocator::AcquirePage()
+    {
+        Page* page = nullptr;
+
+        if (!m_pages_free.empty())
+        {
+            page = m_pages_free.back();
+            m_pages_free.pop_back();
+        }
+        else
+        {
+            unique_ptr<Page> page_new = make_unique<Page>();
+            if (!CreatePage(page_new.get()))
+            {
+                LOG_ERROR("Failed to create a %d KB upload page", static_cast<uint32_t>(m_page_size / 1024));
+                return nullptr;
+            }
+
+            page = page_new.get();
+            m_pages.emplace_back(move(page_new));
+            m_size_gpu = m_pages.size() * m_page_size;
+        }
+
+        page->offset = 0;
+        m_pages_frame[m_frame_index].emplace_back(page);
+
+        return page;
+    }
+}
@@ -0,0 +1,95 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =======================
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "RHI_Definition.h"
+#include "../Core/Spartan_Object.h"
+//==================================
+
+namespace Spartan
+{
+    // A region of an upload page, valid until the frame it was allocated in comes around again
+    struct RHI_UploadAllocation
+    {
+        void* buffer    = nullptr;
+        uint32_t offset = 0;
+    };
+
+    // Linear allocator over large, persistently mapped pages. Every frame (swapchain command list) owns the pages it allocated from,
+    // and they are only recycled once that frame begins again, at which point its command list fence has been waited on.
+    class SPARTAN_CLASS RHI_UploadAllocator : public Spartan_Object
+    {
+    public:
+        RHI_UploadAllocator(const std::shared_ptr<RHI_Device>& rhi_device, const uint32_t frame_count, const uint64_t page_size = 2 * 1024 * 1024);
+        ~RHI_UploadAllocator();
+
+        // Recycles the pages of the given frame, must be called after its command list has begun
+        void BeginFrame(const uint32_t frame_index);
+
+        // Thread safe
+        bool Upload(const void* data, const uint64_t size, RHI_UploadAllocation& allocation);
+
+        uint32_t GetAlignment()         const { return m_alignment; }
+        uint64_t GetFrame()             const { return m_frame; }
+        uint64_t GetPageSize()          const { return m_page_size; }
+        uint32_t GetPageCount()         const { return static_cast<uint32_t>(m_pages.size()); }
+        uint64_t GetBytesUploaded()     const { return m_bytes_uploaded_last_frame; }
+
+    private:
+        struct Page
+        {
+            void* buffer                    = nullptr;
+            void* allocation                = nullptr;
+            std::byte* mapped               = nullptr;
+            bool coherent                   = true;
+            std::atomic<uint64_t> offset    = 0;
+        };
+
+        Page* AcquirePage();
+
+        // API
+        bool CreatePage(Page* page);
+        void DestroyPage(Page* page);
+        void FlushPage(Page* page, const uint64_t offset, const uint64_t size);
+        uint32_t GetAlignmentRhi() const;
+
+        std::vector<std::unique_ptr<Page>> m_pages;
+        std::vector<Page*> m_pages_free;
+        std::vector<std::vector<Page*>> m_pages_frame;
+        std::atomic<Page*> m_page_current           = nullptr;
+        uint32_t m_frame_index                      = 0;
+        std::atomic<uint64_t> m_frame               = 0;
+        uint64_t m_page_size                        = 0;
+        uint32_t m_alignment                        = 256;
+        std::atomic<uint64_t> m_bytes_uploaded      = 0;
+        uint64_t m_bytes_uploaded_last_frame        = 0;
+        std::mutex m_mutex;
+
+        // Dependencies
+        std::shared_ptr<RHI_Device> m_rhi_device;
+    };
+}
@@ -0,0 +1,399 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ==================
+#include "Spartan.h"
+#include "RHI_UploadManager.h"
+#include "RHI_Device.h"
+#include "RHI_Semaphore.h"
+#include "RHI_Texture.h"
+//=============================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    // Not necessarily a power of two, texel sizes can be 12 bytes for example
+    static uint64_t align(const uint64_t offset, const uint64_t alignment)
+    {
+        return ((offset + alignment - 1) / alignment) * alignment;
+    }
+
+    RHI_UploadManager::RHI_UploadManager(RHI_Device* rhi_device, const uint64_t ring_size /*= 64 * 1024 * 1024*/)
+    {
+        m_rhi_device    = rhi_device;
+        m_name          = "upload_manager";
+        m_ring_size     = ring_size;
+        m_semaphore     = make_shared<RHI_Semaphore>(rhi_device, true, "upload_manager");
+
+        if (!CreateRing())
+        {
+            LOG_ERROR("Failed to create a %d MB staging ring", static_cast<uint32_t>(m_ring_size / 1024 / 1024));
+            m_ring_size = 0;
+        }
+
+        m_size_gpu = m_ring_size;
+    }
+
+    RHI_UploadManager::~RHI_UploadManager()
+    {
+        // Wait for the copies which are still in flight
+        Flush();
+        m_semaphore->Wait(m_value_submitted);
+        Retire();
+
+        for (unique_ptr<Batch>& batch : m_batches)
+        {
+            for (void*& buffer : batch->staging)
+            {
+                DestroyStaging(buffer);
+            }
+
+            DestroyBatch(batch.get());
+        }
+
+        DestroyRing();
+    }
+
+    void RHI_UploadManager::BeginFrame()
+    {
+        {
+            lock_guard<mutex> lock(m_mutex);
+            Retire();
+        }
+
+        m_bytes_uploaded_last_frame = m_bytes_uploaded.exchange(0);
+        m_batch_count_last_frame    = m_batch_count.exchange(0);
+        m_stall_count_last_frame    = m_stall_count.exchange(0);
+    }
+
+    uint64_t RHI_UploadManager::Upload(void* buffer, const void* data, const uint64_t size)
+    {
+        if (!buffer || !data || size == 0)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return 0;
+        }
+
+        unique_lock<mutex> lock(m_mutex);
+
+        // Copy the data to the staging memory
+        Staging staging;
+        if (!Allocate(lock, size, 16, staging))
+            return 0;
+
+        memcpy(staging.mapped, data, size);
+
+        // Record the copy into the staging memory's batch
+        Batch* batch = AcquireBatch(staging);
+        if (!batch)
+        {
+            Release(staging);
+            return 0;
+        }
+
+        RecordCopy(batch, staging, buffer, size);
+        m_bytes_uploaded += size;
+
+        return batch->value;
+    }
+
+    uint64_t RHI_UploadManager::Upload(RHI_Texture* texture, const RHI_Image_Layout layout)
+    {
+        if (!texture || !texture->Get_Resource() || !texture->HasData())
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return 0;
+        }
+
+        // Array slices and their mips are tightly packed, in the same order as the texture data
+        const uint32_t array_size       = texture->GetArraySize();
+        const uint32_t mip_count        = texture->GetMipCount();
+        const uint64_t bytes_per_pixel  = texture->GetBytesPerPixel();
+        uint64_t size = 0;
+        for (uint32_t array_index = 0; array_index < array_size; array_index++)
+        {
+            for (uint32_t mip_index = 0; mip_index < mip_count; mip_index++)
+            {
+                const uint64_t mip_size = static_cast<uint64_t>(Math::Helper::Max(texture->GetWidth() >> mip_index, 1u)) * Math::Helper::Max(texture->GetHeight() >> mip_index, 1u) * bytes_per_pixel;
+                if (texture->GetMip(array_index * mip_count + mip_index).size() < mip_size)
+                {
+                    LOG_ERROR("Mip %d of array slice %d is missing data", mip_index, array_index);
+                    return 0;
+                }
+
+                size += mip_size;
+            }
+        }
+
+        unique_lock<mutex> lock(m_mutex);
+
+        // Copy the data to the staging memory, the offsets of the copies have to be a multiple of the texel size as well as 4
+        Staging staging;
+        if (!Allocate(lock, size, bytes_per_pixel * 4, staging))
+            return 0;
+
+        uint64_t offset = 0;
+        for (uint32_t array_index = 0; array_index < array_size; array_index++)
+        {
+            for (uint32_t mip_index = 0; mip_index < mip_count; mip_index++)
+            {
+                const uint64_t mip_size = static_cast<uint64_t>(Math::Helper::Max(texture->GetWidth() >> mip_index, 1u)) * Math::Helper::Max(texture->GetHeight() >> mip_index, 1u) * bytes_per_pixel;
+                memcpy(staging.mapped + offset, texture->GetMip(array_index * mip_count + mip_index).data(), mip_size);
+                offset += mip_size;
+            }
+        }
+
+        // Record the copy (and the layout transitions around it) into the staging memory's batch
+        Batch* batch = AcquireBatch(staging);
+        if (!batch)
+        {
+            Release(staging);
+            return 0;
+        }
+
+        RecordCopy(batch, staging, texture, layout);
+        m_bytes_uploaded += size;
+
+        return batch->value;
+    }
+
+    void RHI_UploadManager::Flush()
+    {
+        lock_guard<mutex> lock(m_mutex);
+        Submit();
+    }
+
+    bool RHI_UploadManager::Wait(const uint64_t value)
+    {
+        // Copies which haven't been submitted yet would never complete
+        if (value > m_value_submitted)
+        {
+            Flush();
+        }
+
+        return m_semaphore->Wait(value);
+    }
+
+    bool RHI_UploadManager::IsComplete(const uint64_t value)
+    {
+        return value <= m_semaphore->GetValue();
+    }
+
+    uint64_t RHI_UploadManager::GetValuePending()
+    {
+        lock_guard<mutex> lock(m_mutex);
+        return m_batch_recording ? m_batch_recording->value : m_value_submitted.load();
+    }
+
+    bool RHI_UploadManager::Allocate(unique_lock<mutex>& lock, const uint64_t size, const uint64_t alignment, Staging& staging)
+    {
+        // Uploads which would take up most of the ring get a staging buffer of their own
+        if (size > m_ring_size / 2)
+        {
+            if (!CreateStaging(size, staging))
+            {
+                LOG_ERROR("Failed to create a %d KB staging buffer", static_cast<uint32_t>(size / 1024));
+                return false;
+            }
+
+            staging.dedicated = true;
+            return true;
+        }
+
+        while (true)
+        {
+            Retire();
+
+            const uint64_t ring_head = m_ring_head;
+            if (AllocateFromRing(size, alignment, staging.offset))
+            {
+                staging.buffer      = m_ring_buffer;
+                staging.mapped      = m_ring_mapped + staging.offset;
+                staging.dedicated   = false;
+                staging.ring_head   = ring_head;
+                return true;
+            }
+
+            // The ring is full, submit what's recorded and wait for the oldest batch to free up some space
+            Submit();
+            if (m_batches_pending.empty())
+            {
+                LOG_ERROR("Failed to allocate %d KB from the staging ring", static_cast<uint32_t>(size / 1024));
+                return false;
+            }
+
+            const uint64_t value = m_batches_pending.front()->value;
+            m_stall_count++;
+
+            // Other threads can keep recording while this one waits
+            lock.unlock();
+            m_semaphore->Wait(value);
+            lock.lock();
+        }
+    }
+
+    void RHI_UploadManager::Release(Staging& staging)
+    {
+        // Only valid while the lock which the allocation was made under is still held, since then
+        // nothing else can have been allocated after it, and no batch can have claimed it's space.
+        if (staging.dedicated)
+        {
+            DestroyStaging(staging.buffer);
+        }
+        else
+        {
+            m_ring_head = staging.ring_head;
+        }
+
+        staging = Staging();
+    }
+
+    bool RHI_UploadManager::AllocateFromRing(const uint64_t size, const uint64_t alignment, uint64_t& offset)
+    {
+        // The head never catches up with the tail, so that head == tail can only mean that the ring is empty
+        const uint64_t offset_aligned = align(m_ring_head, alignment);
+
+        if (m_ring_head >= m_ring_tail)
+        {
+            // The free space is [head, end) followed by [0, tail)
+            if (offset_aligned + size <= m_ring_size)
+            {
+                offset      = offset_aligned;
+                m_ring_head = offset_aligned + size;
+                return true;
+            }
+
+            if (size < m_ring_tail)
+            {
+                offset      = 0;
+                m_ring_head = size;
+                return true;
+            }
+        }
+        else if (offset_aligned + size < m_ring_tail)
+        {
+            // The free space is [head, tail)
+            offset      = offset_aligned;
+            m_ring_head = offset_aligned + size;
+            return true;
+        }
+
+        return false;
+    }
+
+    RHI_UploadManager::Batch* RHI_UploadManager::AcquireBatch(const Staging& staging)
+    {
+        if (!m_batch_recording)
+        {
+            Batch* batch = nullptr;
+
+            if (!m_batches_free.empty())
+            {
+                batch = m_batches_free.back();
+                m_batches_free.pop_back();
+            }
+            else
+            {
+                unique_ptr<Batch> batch_new = make_unique<Batch>();
+                if (!CreateBatch(batch_new.get()))
+                {
+                    LOG_ERROR("Failed to create an upload batch");
+                    return nullptr;
+                }
+
+                batch = batch_new.get();
+                m_batches.emplace_back(move(batch_new));
+            }
+
+            if (!BeginBatch(batch))
+            {
+                LOG_ERROR("Failed to begin an upload batch");
+                m_batches_free.emplace_back(batch);
+                return nullptr;
+            }
+
+            batch->value        = m_value_submitted + 1;
+            m_batch_recording   = batch;
+        }
+
+        // The batch owns dedicated staging buffers, they are destroyed once it completes
+        if (staging.dedicated)
+        {
+            m_batch_recording->staging.emplace_back(staging.buffer);
+        }
+
+        return m_batch_recording;
+    }
+
+    void RHI_UploadManager::Submit()
+    {
+        Batch* batch = m_batch_recording;
+        if (!batch)
+            return;
+
+        m_batch_recording   = nullptr;
+        batch->ring_end     = m_ring_head;
+
+        // If the submission failed, signal the value from the CPU (after the previous one), so that nothing waits for it forever
+        if (!SubmitBatch(batch))
+        {
+            LOG_ERROR("Failed to submit an upload batch");
+            m_semaphore->Wait(batch->value - 1);
+            m_semaphore->Signal(batch->value);
+        }
+
+        m_value_submitted = batch->value;
+        m_batches_pending.emplace_back(batch);
+        m_batch_count++;
+    }
+
+    void RHI_UploadManager::Retire()
+    {
+        const uint64_t value_completed = m_semaphore->GetValue();
+
+        while (!m_batches_pending.empty() && m_batches_pending.front()->value <= value_completed)
+        {
+            Batch* batch = m_batches_pending.front();
+            m_batches_pending.pop_front();
+
+            // The GPU is done reading from the batch's staging memory
+            m_ring_tail = batch->ring_end;
+            for (void*& buffer : batch->staging)
+            {
+                DestroyStaging(buffer);
+            }
+            batch->staging.clear();
+
+            m_batches_free.emplace_back(batch);
+        }
+
+        // Nothing is in flight, start over from the beginning of the ring
+        if (m_batches_pending.empty() && !m_batch_recording)
+        {
+            m_ring_head = 0;
+            m_ring_tail = 0;
+        }
+    }
+}
@@ -0,0 +1,138 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES =======================
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "RHI_Definition.h"
+#include "../Core/Spartan_Object.h"
+//==================================
+
+namespace Spartan
+{
+    // Uploads static resources (vertex/index buffers, textures) through a persistently mapped staging ring. Copies are recorded into
+    // batches which are submitted to the transfer queue, each one signaling a timeline semaphore. Submissions to the other queues wait
+    // on that semaphore, so nothing blocks on a copy and a resource can be used by the very next command list that gets submitted.
+    class SPARTAN_CLASS RHI_UploadManager : public Spartan_Object
+    {
+    public:
+        RHI_UploadManager(RHI_Device* rhi_device, const uint64_t ring_size = 64 * 1024 * 1024);
+        ~RHI_UploadManager();
+
+        // Snapshots the metrics of the previous frame and recycles completed batches
+        void BeginFrame();
+
+        // Thread safe, they return the timeline value the copy will have completed at (0 if it failed)
+        uint64_t Upload(void* buffer, const void* data, const uint64_t size);
+        uint64_t Upload(RHI_Texture* texture, const RHI_Image_Layout layout);
+
+        // Submits the copies recorded so far to the transfer queue
+        void Flush();
+
+        // Blocks the calling thread (not the queues) until the copies up to the given value have completed
+        bool Wait(const uint64_t value);
+        bool IsComplete(const uint64_t value);
+
+        // The value which covers every copy recorded so far, submitted or not
+        uint64_t GetValuePending();
+
+        uint64_t GetValueSubmitted()        const { return m_value_submitted; }
+        RHI_Semaphore* GetSemaphore()       const { return m_semaphore.get(); }
+        uint64_t GetRingSize()              const { return m_ring_size; }
+        uint64_t GetBytesUploaded()         const { return m_bytes_uploaded_last_frame; }
+        uint32_t GetBatchCount()            const { return m_batch_count_last_frame; }
+        uint32_t GetStallCount()            const { return m_stall_count_last_frame; }
+
+    private:
+        // Copies which are submitted together
+        struct Batch
+        {
+            void* cmd_pool                  = nullptr;
+            void* cmd_buffer                = nullptr;
+            uint64_t value                  = 0; // the semaphore value which is signaled once the copies have completed
+            uint64_t ring_end               = 0; // the ring can reclaim everything up to here, once the batch has completed
+            std::vector<void*> staging;          // dedicated staging buffers, for uploads which are too large for the ring
+        };
+
+        // Where the data of an upload is written to
+        struct Staging
+        {
+            void* buffer        = nullptr;
+            uint64_t offset     = 0;
+            std::byte* mapped   = nullptr;
+            bool dedicated      = false;
+            uint64_t ring_head  = 0; // the head before the allocation, to give the space back
+        };
+
+        bool Allocate(std::unique_lock<std::mutex>& lock, const uint64_t size, const uint64_t alignment, Staging& staging);
+        void Release(Staging& staging);
+        bool AllocateFromRing(const uint64_t size, const uint64_t alignment, uint64_t& offset);
+        Batch* AcquireBatch(const Staging& staging);
+        void Submit();
+        void Retire();
+
+        // API
+        bool CreateRing();
+        void DestroyRing();
+        bool CreateStaging(const uint64_t size, Staging& staging);
+        void DestroyStaging(void*& buffer);
+        bool CreateBatch(Batch* batch);
+        void DestroyBatch(Batch* batch);
+        bool BeginBatch(Batch* batch);
+        bool SubmitBatch(Batch* batch);
+        void RecordCopy(Batch* batch, const Staging& staging, void* buffer, const uint64_t size);
+        void RecordCopy(Batch* batch, const Staging& staging, RHI_Texture* texture, const RHI_Image_Layout layout);
+
+        // Ring
+        void* m_ring_buffer         = nullptr;
+        void* m_ring_allocation     = nullptr;
+        std::byte* m_ring_mapped    = nullptr;
+        uint64_t m_ring_size        = 0;
+        uint64_t m_ring_head        = 0; // where the next allocation goes
+        uint64_t m_ring_tail        = 0; // the oldest allocation which the GPU might still be reading from, head == tail means empty
+
+        // Batches
+        std::vector<std::unique_ptr<Batch>> m_batches;
+        std::vector<Batch*> m_batches_free;
+        std::deque<Batch*> m_batches_pending;
+        Batch* m_batch_recording                = nullptr;
+        std::atomic<uint64_t> m_value_submitted = 0;
+        std::shared_ptr<RHI_Semaphore> m_semaphore;
+        std::mutex m_mutex;
+
+        // Metrics
+        std::atomic<uint64_t> m_bytes_uploaded  = 0;
+        std::atomic<uint32_t> m_batch_count     = 0;
+        std::atomic<uint32_t> m_stall_count     = 0;
+        uint64_t m_bytes_uploaded_last_frame    = 0;
+        uint32_t m_batch_count_last_frame       = 0;
+        uint32_t m_stall_count_last_frame       = 0;
+
+        // Dependencies
+        RHI_Device* m_rhi_device = nullptr;
+    };
+}
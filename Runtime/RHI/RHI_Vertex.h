@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES ===============
+#include <cstring>
 #include "../Math/Vector2.h"
 #include "../Math/Vector3.h"
 #include "../Math/Vector4.h"
@@ -29,6 +30,80 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace Spartan
 {
+    namespace vertex_packing
+    {
+        inline int16_t float_to_snorm16(const float value)
+        {
+            return static_cast<int16_t>(Math::Helper::Round(Math::Helper::Clamp(value, -1.0f, 1.0f) * 32767.0f));
+        }
+
+        inline uint16_t float_to_half(const float value)
+        {
+            uint32_t bits;
+            memcpy(&bits, &value, sizeof(float));
+
+            const uint32_t sign     = (bits >> 16) & 0x8000;
+            const uint32_t exponent = (bits >> 23) & 0xff;
+            uint32_t mantissa       = bits & 0x7fffff;
+
+            // Inf/NaN
+            if (exponent == 0xff)
+                return static_cast<uint16_t>(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+
+            const int32_t exponent_half = static_cast<int32_t>(exponent) - 127 + 15;
+
+            // Overflow
+            if (exponent_half >= 31)
+                return static_cast<uint16_t>(sign | 0x7c00);
+
+            // Denormal (or zero)
+            if (exponent_half <= 0)
+            {
+                if (exponent_half < -10)
+                    return static_cast<uint16_t>(sign);
+
+                mantissa            |= 0x800000;
+                const uint32_t shift = static_cast<uint32_t>(14 - exponent_half);
+                uint32_t half        = mantissa >> shift;
+                half                += (mantissa >> (shift - 1)) & 1; // round
+                return static_cast<uint16_t>(sign | half);
+            }
+
+            // Round to nearest, a carry into the exponent is still correct
+            uint32_t half = sign | (static_cast<uint32_t>(exponent_half) << 10) | (mantissa >> 13);
+            half          += (mantissa >> 12) & 1;
+            return static_cast<uint16_t>(half);
+        }
+
+        // Positions are stored relative to the center of the bounds, scaled by the largest half extent (uniformly, so normals can be transformed by the same matrix)
+        inline void pack_position(const float* position, const Math::Vector3& center, const float scale_inverse, int16_t* packed)
+        {
+            packed[0] = float_to_snorm16((position[0] - center.x) * scale_inverse);
+            packed[1] = float_to_snorm16((position[1] - center.y) * scale_inverse);
+            packed[2] = float_to_snorm16((position[2] - center.z) * scale_inverse);
+            packed[3] = 32767; // w = 1.0
+        }
+
+        // Unit vector to the octahedron, unfolded onto a square
+        inline void pack_octahedral(const float* direction, int16_t* packed)
+        {
+            const float length_l1   = Math::Helper::Abs(direction[0]) + Math::Helper::Abs(direction[1]) + Math::Helper::Abs(direction[2]);
+            float x                 = length_l1 > 0.0f ? direction[0] / length_l1 : 0.0f;
+            float y                 = length_l1 > 0.0f ? direction[1] / length_l1 : 0.0f;
+
+            if (direction[2] < 0.0f)
+            {
+                const float x_folded = (1.0f - Math::Helper::Abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+                const float y_folded = (1.0f - Math::Helper::Abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+                x = x_folded;
+                y = y_folded;
+            }
+
+            packed[0] = float_to_snorm16(x);
+            packed[1] = float_to_snorm16(y);
+        }
+    }
+
     struct RHI_Vertex_Undefined{};
 
     struct RHI_Vertex_Pos
@@ -129,11 +204,82 @@ namespace Spartan
         float tan[3] = { 0 };
     };
 
+    // The layout models use on the GPU (20 bytes instead of 44), positions are relative to the model bounds (see Model::GetVertexTransform())
+    struct RHI_Vertex_PosTexNorTan_Packed
+    {
+        RHI_Vertex_PosTexNorTan_Packed() = default;
+
+        RHI_Vertex_PosTexNorTan_Packed(const RHI_Vertex_PosTexNorTan& vertex, const Math::Vector3& center, const float scale_inverse)
+        {
+            vertex_packing::pack_position(vertex.pos, center, scale_inverse, pos);
+
+            tex[0] = vertex_packing::float_to_half(vertex.tex[0]);
+            tex[1] = vertex_packing::float_to_half(vertex.tex[1]);
+
+            vertex_packing::pack_octahedral(vertex.nor, &nor_tan[0]);
+            vertex_packing::pack_octahedral(vertex.tan, &nor_tan[2]);
+        }
+
+        int16_t pos[4]      = { 0 }; // snorm
+        uint16_t tex[2]     = { 0 }; // half
+        int16_t nor_tan[4]  = { 0 }; // snorm, octahedral encoded normal and tangent
+    };
+
+    // Position only stream, for passes which only output depth
+    struct RHI_Vertex_Pos_Packed
+    {
+        RHI_Vertex_Pos_Packed() = default;
+
+        RHI_Vertex_Pos_Packed(const RHI_Vertex_PosTexNorTan& vertex, const Math::Vector3& center, const float scale_inverse)
+        {
+            vertex_packing::pack_position(vertex.pos, center, scale_inverse, pos);
+        }
+
+        int16_t pos[4] = { 0 }; // snorm
+    };
+
+    // Skinned on the GPU, the packed layouts followed by the bones (indices into the palette) and the weights of the vertex
+    struct RHI_Vertex_PosTexNorTanSkin_Packed
+    {
+        RHI_Vertex_PosTexNorTanSkin_Packed() = default;
+
+        RHI_Vertex_PosTexNorTanSkin_Packed(const RHI_Vertex_PosTexNorTan& vertex, const Math::Vector3& center, const float scale_inverse, const uint8_t* bones, const uint8_t* weights)
+        {
+            vertex_packed = RHI_Vertex_PosTexNorTan_Packed(vertex, center, scale_inverse);
+            memcpy(this->bones, bones, sizeof(this->bones));
+            memcpy(this->weights, weights, sizeof(this->weights));
+        }
+
+        RHI_Vertex_PosTexNorTan_Packed vertex_packed;
+        uint8_t bones[4]    = { 0 }; // unorm, times 255 in the shader
+        uint8_t weights[4]  = { 0 }; // unorm
+    };
+
+    struct RHI_Vertex_PosSkin_Packed
+    {
+        RHI_Vertex_PosSkin_Packed() = default;
+
+        RHI_Vertex_PosSkin_Packed(const RHI_Vertex_PosTexNorTan& vertex, const Math::Vector3& center, const float scale_inverse, const uint8_t* bones, const uint8_t* weights)
+        {
+            vertex_packing::pack_position(vertex.pos, center, scale_inverse, pos);
+            memcpy(this->bones, bones, sizeof(this->bones));
+            memcpy(this->weights, weights, sizeof(this->weights));
+        }
+
+        int16_t pos[4]      = { 0 }; // snorm
+        uint8_t bones[4]    = { 0 }; // unorm, times 255 in the shader
+        uint8_t weights[4]  = { 0 }; // unorm
+    };
+
     static_assert(std::is_trivially_copyable<RHI_Vertex_Pos>::value,            "RHI_Vertex_Pos is not trivially copyable");
     static_assert(std::is_trivially_copyable<RHI_Vertex_PosTex>::value,            "RHI_Vertex_PosTex is not trivially copyable");
     static_assert(std::is_trivially_copyable<RHI_Vertex_PosCol>::value,            "RHI_Vertex_PosCol is not trivially copyable");
     static_assert(std::is_trivially_copyable<RHI_Vertex_Pos2dTexCol8>::value,    "RHI_Vertex_Pos2dTexCol8 is not trivially copyable");
     static_assert(std::is_trivially_copyable<RHI_Vertex_PosTexNorTan>::value,    "RHI_Vertex_PosTexNorTan is not trivially copyable");
+    static_assert(std::is_trivially_copyable<RHI_Vertex_PosTexNorTan_Packed>::value, "RHI_Vertex_PosTexNorTan_Packed is not trivially copyable");
+    static_assert(std::is_trivially_copyable<RHI_Vertex_Pos_Packed>::value,      "RHI_Vertex_Pos_Packed is not trivially copyable");
+    static_assert(std::is_trivially_copyable<RHI_Vertex_PosTexNorTanSkin_Packed>::value, "RHI_Vertex_PosTexNorTanSkin_Packed is not trivially copyable");
+    static_assert(std::is_trivially_copyable<RHI_Vertex_PosSkin_Packed>::value,  "RHI_Vertex_PosSkin_Packed is not trivially copyable");
 
     enum RHI_Vertex_Type
     {
@@ -142,7 +288,11 @@ namespace Spartan
         RHI_Vertex_Type_PositionColor,
         RHI_Vertex_Type_PositionTexture,
         RHI_Vertex_Type_PositionTextureNormalTangent,
-        RHI_Vertex_Type_Position2dTextureColor8
+        RHI_Vertex_Type_Position2dTextureColor8,
+        RHI_Vertex_Type_PositionTextureNormalTangentPacked,
+        RHI_Vertex_Type_PositionPacked,
+        RHI_Vertex_Type_PositionTextureNormalTangentSkinPacked,
+        RHI_Vertex_Type_PositionSkinPacked
     };
 
     template <typename T>
@@ -153,4 +303,8 @@ namespace Spartan
     template<> inline RHI_Vertex_Type RHI_Vertex_Type_To_Enum<RHI_Vertex_PosCol>()            { return RHI_Vertex_Type_PositionColor; }
     template<> inline RHI_Vertex_Type RHI_Vertex_Type_To_Enum<RHI_Vertex_Pos2dTexCol8>()    { return RHI_Vertex_Type_Position2dTextureColor8; }
     template<> inline RHI_Vertex_Type RHI_Vertex_Type_To_Enum<RHI_Vertex_PosTexNorTan>()    { return RHI_Vertex_Type_PositionTextureNormalTangent; }
+    template<> inline RHI_Vertex_Type RHI_Vertex_Type_To_Enum<RHI_Vertex_PosTexNorTan_Packed>() { return RHI_Vertex_Type_PositionTextureNormalTangentPacked; }
+    template<> inline RHI_Vertex_Type RHI_Vertex_Type_To_Enum<RHI_Vertex_Pos_Packed>()      { return RHI_Vertex_Type_PositionPacked; }
+    template<> inline RHI_Vertex_Type RHI_Vertex_Type_To_Enum<RHI_Vertex_PosTexNorTanSkin_Packed>() { return RHI_Vertex_Type_PositionTextureNormalTangentSkinPacked; }
+    template<> inline RHI_Vertex_Type RHI_Vertex_Type_To_Enum<RHI_Vertex_PosSkin_Packed>()  { return RHI_Vertex_Type_PositionSkinPacked; }
 }
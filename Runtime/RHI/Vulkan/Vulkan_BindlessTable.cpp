@@ -0,0 +1,240 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ======================
+#include "Spartan.h"
+#include "../RHI_Implementation.h"
+#include "../RHI_BindlessTable.h"
+#include "../RHI_Device.h"
+#include "../RHI_Texture.h"
+//=================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    bool RHI_BindlessTable::CreateResources()
+    {
+        RHI_Context* rhi_context = m_rhi_device->GetContextRhi();
+
+        // Respect the device limits for descriptors which can be updated after being bound
+        {
+            VkPhysicalDeviceVulkan12Properties properties_1_2   = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES };
+            VkPhysicalDeviceProperties2 properties              = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, &properties_1_2 };
+            vkGetPhysicalDeviceProperties2(rhi_context->device_physical, &properties);
+
+            const uint32_t texture_capacity_max = Math::Helper::Min(properties_1_2.maxPerStageDescriptorUpdateAfterBindSampledImages, properties_1_2.maxDescriptorSetUpdateAfterBindSampledImages);
+            if (m_texture_capacity > texture_capacity_max)
+            {
+                LOG_WARNING("Requested %d textures but the device supports up to %d", m_texture_capacity, texture_capacity_max);
+                m_texture_capacity = texture_capacity_max;
+            }
+        }
+
+        // Layout
+        {
+            // Binding 0: Textures, only the slots which are sampled have to be valid and they can be written while the set is bound
+            // Binding 1: Materials
+            array<VkDescriptorSetLayoutBinding, 2> layout_bindings = {};
+            layout_bindings[0].binding          = 0;
+            layout_bindings[0].descriptorType   = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+            layout_bindings[0].descriptorCount  = m_texture_capacity;
+            layout_bindings[0].stageFlags       = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
+            layout_bindings[1].binding          = 1;
+            layout_bindings[1].descriptorType   = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            layout_bindings[1].descriptorCount  = 1;
+            layout_bindings[1].stageFlags       = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
+
+            array<VkDescriptorBindingFlags, 2> binding_flags =
+            {
+                VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT,
+                0
+            };
+
+            VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_info  = {};
+            binding_flags_info.sType                                        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+            binding_flags_info.bindingCount                                 = static_cast<uint32_t>(binding_flags.size());
+            binding_flags_info.pBindingFlags                                = binding_flags.data();
+
+            VkDescriptorSetLayoutCreateInfo create_info = {};
+            create_info.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            create_info.flags                           = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+            create_info.pNext                           = &binding_flags_info;
+            create_info.bindingCount                    = static_cast<uint32_t>(layout_bindings.size());
+            create_info.pBindings                       = layout_bindings.data();
+
+            if (!vulkan_utility::error::check(vkCreateDescriptorSetLayout(rhi_context->device, &create_info, nullptr, reinterpret_cast<VkDescriptorSetLayout*>(&m_descriptor_set_layout))))
+                return false;
+
+            vulkan_utility::debug::set_name(static_cast<VkDescriptorSetLayout>(m_descriptor_set_layout), m_name.c_str());
+        }
+
+        // Pool
+        {
+            array<VkDescriptorPoolSize, 2> pool_sizes =
+            {
+                VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,     m_texture_capacity * m_frame_count },
+                VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,    m_frame_count }
+            };
+
+            VkDescriptorPoolCreateInfo create_info  = {};
+            create_info.sType                       = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+            create_info.flags                       = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+            create_info.poolSizeCount               = static_cast<uint32_t>(pool_sizes.size());
+            create_info.pPoolSizes                  = pool_sizes.data();
+            create_info.maxSets                     = m_frame_count;
+
+            if (!vulkan_utility::error::check(vkCreateDescriptorPool(rhi_context->device, &create_info, nullptr, reinterpret_cast<VkDescriptorPool*>(&m_descriptor_pool))))
+                return false;
+
+            vulkan_utility::debug::set_name(static_cast<VkDescriptorPool>(m_descriptor_pool), m_name.c_str());
+        }
+
+        // Descriptor sets, one per frame
+        {
+            vector<VkDescriptorSetLayout> layouts(m_frame_count, static_cast<VkDescriptorSetLayout>(m_descriptor_set_layout));
+            m_descriptor_sets.resize(m_frame_count);
+
+            VkDescriptorSetAllocateInfo allocate_info   = {};
+            allocate_info.sType                         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            allocate_info.descriptorPool                = static_cast<VkDescriptorPool>(m_descriptor_pool);
+            allocate_info.descriptorSetCount            = m_frame_count;
+            allocate_info.pSetLayouts                   = layouts.data();
+
+            if (!vulkan_utility::error::check(vkAllocateDescriptorSets(rhi_context->device, &allocate_info, reinterpret_cast<VkDescriptorSet*>(m_descriptor_sets.data()))))
+                return false;
+        }
+
+        // Material buffer, one region per frame
+        {
+            const uint64_t alignment    = Math::Helper::Max<uint64_t>(rhi_context->device_properties.limits.minStorageBufferOffsetAlignment, 16);
+            m_material_region_size      = (static_cast<uint64_t>(m_material_capacity) * sizeof(RHI_BindlessMaterial) + alignment - 1) & ~(alignment - 1);
+
+            VmaAllocation allocation = vulkan_utility::buffer::create(m_material_buffer, m_material_region_size * m_frame_count, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, true);
+            if (!allocation)
+            {
+                LOG_ERROR("Failed to allocate buffer");
+                return false;
+            }
+            m_material_allocation = static_cast<void*>(allocation);
+
+            // Map persistently
+            if (!vulkan_utility::error::check(vmaMapMemory(rhi_context->allocator, allocation, reinterpret_cast<void**>(&m_material_mapped))))
+            {
+                LOG_ERROR("Failed to map memory");
+                return false;
+            }
+
+            // Find out if flushing is needed
+            VmaAllocationInfo allocation_info;
+            vmaGetAllocationInfo(rhi_context->allocator, allocation, &allocation_info);
+            VkMemoryPropertyFlags memory_flags;
+            vmaGetMemoryTypeProperties(rhi_context->allocator, allocation_info.memoryType, &memory_flags);
+            m_material_coherent = (memory_flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+
+            vulkan_utility::debug::set_name(static_cast<VkBuffer>(m_material_buffer), "bindless_materials");
+
+            // Point every frame's descriptor set to its region
+            vector<VkDescriptorBufferInfo> buffer_infos(m_frame_count);
+            vector<VkWriteDescriptorSet> writes(m_frame_count);
+            for (uint32_t i = 0; i < m_frame_count; i++)
+            {
+                buffer_infos[i].buffer  = static_cast<VkBuffer>(m_material_buffer);
+                buffer_infos[i].offset  = i * m_material_region_size;
+                buffer_infos[i].range   = m_material_region_size;
+
+                writes[i].sType             = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                writes[i].dstSet            = static_cast<VkDescriptorSet>(m_descriptor_sets[i]);
+                writes[i].dstBinding        = 1;
+                writes[i].dstArrayElement   = 0;
+                writes[i].descriptorCount   = 1;
+                writes[i].descriptorType    = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                writes[i].pBufferInfo       = &buffer_infos[i];
+            }
+            vkUpdateDescriptorSets(rhi_context->device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+        }
+
+        return true;
+    }
+
+    void RHI_BindlessTable::DestroyResources()
+    {
+        RHI_Context* rhi_context = m_rhi_device->GetContextRhi();
+
+        if (m_material_mapped)
+        {
+            vmaUnmapMemory(rhi_context->allocator, static_cast<VmaAllocation>(m_material_allocation));
+            m_material_mapped = nullptr;
+        }
+
+        if (m_material_buffer)
+        {
+            vulkan_utility::buffer::destroy(m_material_buffer);
+            m_material_allocation = nullptr;
+        }
+
+        // Descriptor sets are freed along with their pool
+        m_descriptor_sets.clear();
+        if (m_descriptor_pool)
+        {
+            vkDestroyDescriptorPool(rhi_context->device, static_cast<VkDescriptorPool>(m_descriptor_pool), nullptr);
+            m_descriptor_pool = nullptr;
+        }
+
+        if (m_descriptor_set_layout)
+        {
+            vkDestroyDescriptorSetLayout(rhi_context->device, static_cast<VkDescriptorSetLayout>(m_descriptor_set_layout), nullptr);
+            m_descriptor_set_layout = nullptr;
+        }
+    }
+
+    void RHI_BindlessTable::SetTextureRhi(const uint32_t index, RHI_Texture* texture)
+    {
+        VkDescriptorImageInfo image_info    = {};
+        image_info.sampler                  = nullptr;
+        image_info.imageView                = static_cast<VkImageView>(texture->Get_Resource_View(0));
+        image_info.imageLayout              = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        // The slot is not sampled by any frame in flight, so it can be written while the sets are bound
+        vector<VkWriteDescriptorSet> writes(m_frame_count);
+        for (uint32_t i = 0; i < m_frame_count; i++)
+        {
+            writes[i].sType             = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet            = static_cast<VkDescriptorSet>(m_descriptor_sets[i]);
+            writes[i].dstBinding        = 0;
+            writes[i].dstArrayElement   = index;
+            writes[i].descriptorCount   = 1;
+            writes[i].descriptorType    = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+            writes[i].pImageInfo        = &image_info;
+        }
+        vkUpdateDescriptorSets(m_rhi_device->GetContextRhi()->device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    }
+
+    void RHI_BindlessTable::FlushMaterials(const uint64_t offset, const uint64_t size)
+    {
+        if (!vulkan_utility::error::check(vmaFlushAllocation(m_rhi_device->GetContextRhi()->allocator, static_cast<VmaAllocation>(m_material_allocation), offset, size)))
+        {
+            LOG_ERROR("Failed to flush memory");
+        }
+    }
+}
@@ -27,6 +27,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI_VertexBuffer.h"
 #include "../RHI_IndexBuffer.h"
 #include "../RHI_ConstantBuffer.h"
+#include "../RHI_StructuredBuffer.h"
 #include "../RHI_Sampler.h"
 #include "../RHI_DescriptorSet.h"
 #include "../RHI_DescriptorSetLayout.h"
@@ -34,6 +35,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI_PipelineCache.h"
 #include "../RHI_Semaphore.h"
 #include "../RHI_Fence.h"
+#include "../RHI_BindlessTable.h"
 #include "../../Profiling/Profiler.h"
 #include "../../Rendering/Renderer.h"
 //==========================================
@@ -45,9 +47,10 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
-    RHI_CommandList::RHI_CommandList(uint32_t index, RHI_SwapChain* swap_chain, Context* context)
+    RHI_CommandList::RHI_CommandList(uint32_t index, RHI_SwapChain* swap_chain, Context* context, const RHI_Queue_Type queue_type /*= RHI_Queue_Graphics*/)
     {
         m_swap_chain                    = swap_chain;
+        m_queue_type                    = queue_type;
         m_renderer                      = context->GetSubsystem<Renderer>();
         m_profiler                      = context->GetSubsystem<Profiler>();
         m_rhi_device                    = m_renderer->GetRhiDevice().get();
@@ -56,9 +59,20 @@ namespace Spartan
 
         RHI_Context* rhi_context = m_rhi_device->GetContextRhi();
 
+        // Command pool, graphics command lists use the one of the swapchain, the others get their own (on the family of their queue)
+        if (m_queue_type == RHI_Queue_Graphics)
+        {
+            m_cmd_pool = m_swap_chain->GetCmdPool();
+        }
+        else if (vulkan_utility::command_pool::create(m_cmd_pool, m_queue_type))
+        {
+            vulkan_utility::debug::set_name(static_cast<VkCommandPool>(m_cmd_pool), "cmd_pool_compute");
+        }
+
         // Command buffer
-        vulkan_utility::command_buffer::create(m_swap_chain->GetCmdPool(), m_cmd_buffer, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+        vulkan_utility::command_buffer::create(m_cmd_pool, m_cmd_buffer, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
         vulkan_utility::debug::set_name(static_cast<VkCommandBuffer>(m_cmd_buffer), "cmd_buffer");
+        m_cmd_buffers.emplace_back(m_cmd_buffer);
 
         // Sync - Fence
         m_processed_fence = make_shared<RHI_Fence>(m_rhi_device, "cmd_buffer_processed");
@@ -81,6 +95,24 @@ namespace Spartan
         }
     }
 
+    RHI_CommandList::RHI_CommandList(RHI_CommandList* cmd_list_primary, const uint32_t thread_index, void* cmd_pool)
+    {
+        m_cmd_list_primary              = cmd_list_primary;
+        m_cmd_pool                      = cmd_pool;
+        m_swap_chain                    = cmd_list_primary->m_swap_chain;
+        m_renderer                      = cmd_list_primary->m_renderer;
+        m_profiler                      = cmd_list_primary->m_profiler;
+        m_rhi_device                    = cmd_list_primary->m_rhi_device;
+        m_pipeline_cache                = cmd_list_primary->m_pipeline_cache;
+        m_descriptor_set_layout_cache   = m_renderer->GetDescriptorLayoutSetCache(thread_index); // descriptor pools can't be shared across threads
+
+        // Command buffer
+        vulkan_utility::command_buffer::create(m_cmd_pool, m_cmd_buffer, VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+        vulkan_utility::debug::set_name(static_cast<VkCommandBuffer>(m_cmd_buffer), "cmd_buffer_secondary");
+
+        // No sync objects or query pool, the primary is the one which gets submitted and profiled
+    }
+
     RHI_CommandList::~RHI_CommandList()
     {
         RHI_Context* rhi_context = m_rhi_device->GetContextRhi();
@@ -88,8 +120,37 @@ namespace Spartan
         // Wait in case it's still in use by the GPU
         m_rhi_device->Queue_WaitAll();
 
-        // Command buffer
-        vulkan_utility::command_buffer::destroy(m_swap_chain->GetCmdPool(), m_cmd_buffer);
+        // Secondary command list
+        if (IsSecondary())
+        {
+            vulkan_utility::command_buffer::destroy(m_cmd_pool, m_cmd_buffer);
+            return;
+        }
+
+        // Secondary command lists (they have to go before the pools they were allocated from)
+        m_secondary_cmd_lists.clear();
+        for (void*& cmd_pool : m_secondary_cmd_pools)
+        {
+            if (cmd_pool)
+            {
+                vulkan_utility::command_pool::destroy(cmd_pool);
+            }
+        }
+        m_secondary_cmd_pools.clear();
+
+        // Command buffers
+        for (void*& cmd_buffer : m_cmd_buffers)
+        {
+            vulkan_utility::command_buffer::destroy(m_cmd_pool, cmd_buffer);
+        }
+        m_cmd_buffers.clear();
+        m_cmd_buffer = nullptr;
+
+        // Command pool
+        if (m_queue_type != RHI_Queue_Graphics && m_cmd_pool)
+        {
+            vulkan_utility::command_pool::destroy(m_cmd_pool);
+        }
 
         // Query pool
         if (m_query_pool)
@@ -101,6 +162,9 @@ namespace Spartan
 
     bool RHI_CommandList::Begin()
     {
+        if (IsSecondary())
+            return Begin_Secondary();
+
         // If the command list is in use, wait for it
         if (m_state == RHI_CommandListState::Submitted)
         {
@@ -114,6 +178,22 @@ namespace Spartan
         // Validate command list state
         SP_ASSERT(m_state == RHI_CommandListState::Idle);
 
+        // The GPU is done with the secondary command lists which were executed by this command list, so their pools can be reset
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_secondary_cmd_pools.size()); i++)
+        {
+            if (m_secondary_cmd_lists_used[i] == 0)
+                continue;
+
+            vkResetCommandPool(m_rhi_device->GetContextRhi()->device, static_cast<VkCommandPool>(m_secondary_cmd_pools[i]), 0);
+
+            for (uint32_t j = 0; j < m_secondary_cmd_lists_used[i]; j++)
+            {
+                m_secondary_cmd_lists[i][j]->m_state = RHI_CommandListState::Idle;
+            }
+
+            m_secondary_cmd_lists_used[i] = 0;
+        }
+
         // Get queries
         {
             if (m_rhi_device->GetContextRhi()->profiler)
@@ -143,6 +223,10 @@ namespace Spartan
             m_timestamp_index = 0;
         }
 
+        // Recording starts from the first command buffer, the rest are only used if the list is split
+        m_cmd_buffer_index  = 0;
+        m_cmd_buffer        = m_cmd_buffers[0];
+
         VkCommandBufferBeginInfo begin_info = {};
         begin_info.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
         begin_info.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
@@ -169,7 +253,130 @@ namespace Spartan
         return true;
     }
 
-    bool RHI_CommandList::Submit()
+    bool RHI_CommandList::Begin_Secondary()
+    {
+        // Validate command list state
+        SP_ASSERT(m_state == RHI_CommandListState::Idle);
+
+        // The render pass and the pipeline are inherited from the primary
+        RHI_Pipeline* pipeline = m_cmd_list_primary->m_pipeline;
+        SP_ASSERT(pipeline != nullptr);
+        RHI_PipelineState* pipeline_state = pipeline->GetPipelineState();
+        SP_ASSERT(pipeline_state != nullptr);
+        SP_ASSERT(!pipeline_state->IsCompute());
+        SP_ASSERT(pipeline_state->GetRenderPass() != nullptr);
+        SP_ASSERT(m_cmd_list_primary->m_frame_buffer != nullptr);
+
+        VkCommandBufferInheritanceInfo inheritance_info = {};
+        inheritance_info.sType                          = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritance_info.renderPass                     = static_cast<VkRenderPass>(pipeline_state->GetRenderPass());
+        inheritance_info.subpass                        = 0;
+        inheritance_info.framebuffer                    = static_cast<VkFramebuffer>(m_cmd_list_primary->m_frame_buffer);
+
+        VkCommandBufferBeginInfo begin_info = {};
+        begin_info.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        begin_info.pInheritanceInfo         = &inheritance_info;
+        if (!vulkan_utility::error::check(vkBeginCommandBuffer(static_cast<VkCommandBuffer>(m_cmd_buffer), &begin_info)))
+            return false;
+
+        m_state                 = RHI_CommandListState::Recording;
+        m_flushed               = false;
+        m_pipeline              = pipeline;
+        m_pipeline_state        = m_cmd_list_primary->m_pipeline_state;
+        m_frame_buffer          = m_cmd_list_primary->m_frame_buffer;
+        m_render_pass_active    = true; // begun by the primary
+        m_pipeline_active       = false;
+        m_vertex_buffer_id      = 0;
+        m_index_buffer_id       = 0;
+
+        // Dynamic state isn't inherited either
+        SetViewport(m_pipeline_state->GetViewport());
+        SetScissorRectangle(m_pipeline_state->GetScissor());
+
+        // Bindings don't carry over from the primary, so the descriptor cache of this thread has to be set up too
+        m_descriptor_set_layout_cache->SetPipelineState(*m_pipeline_state);
+        m_renderer->SetGlobalSamplersAndConstantBuffers(this);
+
+        return true;
+    }
+
+    RHI_CommandList* RHI_CommandList::GetSecondary(const uint32_t thread_index)
+    {
+        // Validate command list state
+        SP_ASSERT(!IsSecondary());
+        SP_ASSERT(m_state == RHI_CommandListState::Recording);
+
+        if (thread_index >= static_cast<uint32_t>(m_secondary_cmd_pools.size()))
+        {
+            m_secondary_cmd_pools.resize(thread_index + 1, nullptr);
+            m_secondary_cmd_lists.resize(thread_index + 1);
+            m_secondary_cmd_lists_used.resize(thread_index + 1, 0);
+        }
+
+        // Each thread index gets it's own pool, since a pool (and the buffers allocated from it) can't be used by multiple threads at once
+        void*& cmd_pool = m_secondary_cmd_pools[thread_index];
+        if (!cmd_pool)
+        {
+            if (!vulkan_utility::command_pool::create(cmd_pool, RHI_Queue_Graphics))
+            {
+                LOG_ERROR("Failed to create command pool");
+                return nullptr;
+            }
+
+            vulkan_utility::debug::set_name(static_cast<VkCommandPool>(cmd_pool), "cmd_pool_secondary");
+        }
+
+        vector<shared_ptr<RHI_CommandList>>& cmd_lists = m_secondary_cmd_lists[thread_index];
+        uint32_t& cmd_lists_used = m_secondary_cmd_lists_used[thread_index];
+        if (cmd_lists_used == static_cast<uint32_t>(cmd_lists.size()))
+        {
+            cmd_lists.emplace_back(make_shared<RHI_CommandList>(this, thread_index, cmd_pool));
+        }
+
+        return cmd_lists[cmd_lists_used++].get();
+    }
+
+    bool RHI_CommandList::ExecuteSecondary(const vector<RHI_CommandList*>& cmd_lists)
+    {
+        // Validate command list state
+        SP_ASSERT(!IsSecondary());
+        SP_ASSERT(m_state == RHI_CommandListState::Recording);
+
+        if (m_flushed || cmd_lists.empty())
+            return false;
+
+        // The render pass has to be begun with secondary command buffer contents, which also means that it can't contain any inline commands
+        if (m_render_pass_active)
+        {
+            LOG_ERROR("The render pass has already been begun with inline contents");
+            return false;
+        }
+
+        if (!Deferred_BeginRenderPass(true))
+        {
+            LOG_ERROR("Failed to begin render pass");
+            return false;
+        }
+
+        vector<VkCommandBuffer> cmd_buffers;
+        cmd_buffers.reserve(cmd_lists.size());
+        for (RHI_CommandList* cmd_list : cmd_lists)
+        {
+            SP_ASSERT(cmd_list->m_cmd_list_primary == this);
+            SP_ASSERT(cmd_list->m_state == RHI_CommandListState::Ended);
+
+            cmd_buffers.emplace_back(static_cast<VkCommandBuffer>(cmd_list->m_cmd_buffer));
+            cmd_list->m_state = RHI_CommandListState::Submitted;
+        }
+
+        vkCmdExecuteCommands(static_cast<VkCommandBuffer>(m_cmd_buffer), static_cast<uint32_t>(cmd_buffers.size()), cmd_buffers.data());
+        m_profiler->m_rhi_command_lists_secondary += static_cast<uint32_t>(cmd_buffers.size());
+
+        return true;
+    }
+
+    bool RHI_CommandList::Submit(RHI_Semaphore* signal_semaphore /*= nullptr*/, const uint64_t signal_value /*= 0*/)
     {
         // Validate command list state
         SP_ASSERT(m_state == RHI_CommandListState::Ended);
@@ -178,48 +385,95 @@ namespace Spartan
         SP_ASSERT(m_processed_semaphore->GetState() == RHI_Semaphore_State::Idle);
 
         // Get wait and signal semaphores
-        RHI_Semaphore* wait_semaphore    = nullptr;
-        RHI_Semaphore* signal_semaphore  = nullptr;
-        if (m_pipeline)
+        RHI_Semaphore* wait_semaphore = nullptr;
+        if (RHI_SwapChain* swapchain = m_render_target_swapchain)
         {
-            if (RHI_PipelineState* state = m_pipeline->GetPipelineState())
+            // If the swapchain is not presenting (e.g. minimised window), don't submit any work
+            if (!swapchain->PresentEnabled())
             {
-                if (state->render_target_swapchain)
-                {
-                    // If the swapchain is not presenting (e.g. minimised window), don't submit any work
-                    if (!state->render_target_swapchain->PresentEnabled())
-                    {
-                        m_state = RHI_CommandListState::Submitted;
-                        return true;
-                    }
-
-                    // Wait semaphore
-                    if (state->render_target_swapchain->GetImageAcquiredSemaphore()->GetState() == RHI_Semaphore_State::Signaled)
-                    {
-                        wait_semaphore = state->render_target_swapchain->GetImageAcquiredSemaphore();
-                    }
+                m_state = RHI_CommandListState::Submitted;
+                return true;
+            }
 
-                    signal_semaphore = m_processed_semaphore.get(); // swapchain waits for this when presenting
-                }
+            // Wait semaphore
+            if (swapchain->GetImageAcquiredSemaphore()->GetState() == RHI_Semaphore_State::Signaled)
+            {
+                wait_semaphore = swapchain->GetImageAcquiredSemaphore();
             }
+
+            SP_ASSERT(signal_semaphore == nullptr);
+            signal_semaphore = m_processed_semaphore.get(); // swapchain waits for this when presenting
         }
 
         m_processed_fence->Reset();
 
         if (!m_rhi_device->Queue_Submit(
-            RHI_Queue_Graphics,                             // queue
+            m_queue_type,                                   // queue
             VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,  // wait flags
             static_cast<VkCommandBuffer>(m_cmd_buffer),     // cmd buffer
             wait_semaphore,                                 // wait semaphore
             signal_semaphore,                               // signal semaphore
-            m_processed_fence.get()                         // signal fence
+            m_processed_fence.get(),                        // signal fence
+            signal_value,                                   // signal value (timeline semaphores)
+            m_wait_semaphore,                               // wait semaphore (timeline)
+            m_wait_value                                    // wait value
             ))
         {
             LOG_ERROR("Failed to submit the command list.");
             return false;
         }
 
-        m_state = RHI_CommandListState::Submitted;
+        m_wait_semaphore    = nullptr;
+        m_wait_value        = 0;
+        m_state             = RHI_CommandListState::Submitted;
+        return true;
+    }
+
+    bool RHI_CommandList::Split(RHI_Semaphore* signal_semaphore /*= nullptr*/, const uint64_t signal_value /*= 0*/)
+    {
+        // Validate command list state
+        SP_ASSERT(!IsSecondary());
+        SP_ASSERT(m_state == RHI_CommandListState::Recording);
+        SP_ASSERT(!m_render_pass_active);
+
+        if (!End())
+            return false;
+
+        // Submit without a fence, the fence of the final submission is signalled after everything submitted to the queue before it
+        if (!m_rhi_device->Queue_Submit(m_queue_type, 0, static_cast<VkCommandBuffer>(m_cmd_buffer), nullptr, signal_semaphore, nullptr, signal_value, m_wait_semaphore, m_wait_value))
+        {
+            LOG_ERROR("Failed to submit the command list.");
+            return false;
+        }
+
+        m_wait_semaphore    = nullptr;
+        m_wait_value        = 0;
+
+        // Carry on into the next command buffer
+        m_cmd_buffer_index++;
+        if (m_cmd_buffer_index == static_cast<uint32_t>(m_cmd_buffers.size()))
+        {
+            void* cmd_buffer = nullptr;
+            if (!vulkan_utility::command_buffer::create(m_cmd_pool, cmd_buffer, VK_COMMAND_BUFFER_LEVEL_PRIMARY))
+                return false;
+
+            vulkan_utility::debug::set_name(static_cast<VkCommandBuffer>(cmd_buffer), "cmd_buffer_split");
+            m_cmd_buffers.emplace_back(cmd_buffer);
+        }
+        m_cmd_buffer = m_cmd_buffers[m_cmd_buffer_index];
+
+        VkCommandBufferBeginInfo begin_info = {};
+        begin_info.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        if (!vulkan_utility::error::check(vkBeginCommandBuffer(static_cast<VkCommandBuffer>(m_cmd_buffer), &begin_info)))
+            return false;
+
+        // Nothing which was bound carries over to the new command buffer
+        m_state             = RHI_CommandListState::Recording;
+        m_pipeline_active   = false;
+        m_vertex_buffer_id  = 0;
+        m_index_buffer_id   = 0;
+
         return true;
     }
 
@@ -259,6 +513,25 @@ namespace Spartan
 
             // Keep a local pointer for convenience
             m_pipeline_state = &pipeline_state;
+
+            // The pipeline can be shared by pipeline states with different (but compatible) render targets
+            m_render_target_swapchain = pipeline_state.render_target_swapchain;
+        }
+
+        // Frame buffer, viewport and scissor
+        if (pipeline_state.IsGraphics())
+        {
+            // Get (or create) a frame buffer for the render targets of this pipeline state
+            m_frame_buffer = m_pipeline->GetPipelineState()->GetFrameBuffer(pipeline_state, m_renderer->GetFrameNum());
+            if (!m_frame_buffer)
+            {
+                LOG_ERROR("Failed to acquire appropriate frame buffer");
+                return false;
+            }
+
+            // Viewport and scissor are always dynamic, default to the render target and let the caller override them
+            SetViewport(pipeline_state.GetViewport());
+            SetScissorRectangle(pipeline_state.GetScissor());
         }
 
         // Start marker and profiler (if used)
@@ -413,6 +686,52 @@ namespace Spartan
         }
     }
 
+    void RHI_CommandList::Copy(RHI_Texture* source, RHI_Texture* destination)
+    {
+        // Validate command list state
+        SP_ASSERT(m_state == RHI_CommandListState::Recording);
+
+        if (m_render_pass_active)
+        {
+            LOG_ERROR("Must only be called outside of a render pass instance");
+            return;
+        }
+
+        if (!source || !source->Get_Resource() || !destination || !destination->Get_Resource())
+        {
+            LOG_ERROR("Texture is null.");
+            return;
+        }
+
+        if (source->GetWidth() != destination->GetWidth() || source->GetHeight() != destination->GetHeight() || source->GetArraySize() != destination->GetArraySize() || source->GetFormat() != destination->GetFormat())
+        {
+            LOG_ERROR("Source and destination textures must have the same dimensions and format");
+            return;
+        }
+
+        // Required layouts for copy functions
+        source->SetLayout(RHI_Image_Layout::Transfer_Src_Optimal, this);
+        destination->SetLayout(RHI_Image_Layout::Transfer_Dst_Optimal, this);
+
+        // Copy the top mip of every array slice
+        VkImageCopy copy_region                     = {};
+        copy_region.srcSubresource.aspectMask       = vulkan_utility::image::get_aspect_mask(source);
+        copy_region.srcSubresource.mipLevel         = 0;
+        copy_region.srcSubresource.baseArrayLayer   = 0;
+        copy_region.srcSubresource.layerCount       = source->GetArraySize();
+        copy_region.dstSubresource                  = copy_region.srcSubresource;
+        copy_region.extent.width                    = source->GetWidth();
+        copy_region.extent.height                   = source->GetHeight();
+        copy_region.extent.depth                    = 1;
+
+        vkCmdCopyImage(
+            static_cast<VkCommandBuffer>(m_cmd_buffer),
+            static_cast<VkImage>(source->Get_Resource()),       VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            static_cast<VkImage>(destination->Get_Resource()),  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            1, &copy_region
+        );
+    }
+
     bool RHI_CommandList::Draw(const uint32_t vertex_count)
     {
         // Validate command list state
@@ -458,6 +777,39 @@ namespace Spartan
         return true;
     }
 
+    bool RHI_CommandList::DrawIndexedIndirectCount(RHI_StructuredBuffer* arguments, const uint32_t arguments_index, RHI_StructuredBuffer* count, const uint32_t count_index, const uint32_t max_draw_count)
+    {
+        // Validate command list state
+        SP_ASSERT(m_state == RHI_CommandListState::Recording);
+
+        if (!m_rhi_device->IsDrawIndirectCountSupported())
+        {
+            LOG_ERROR("Indirect draws with a draw count are not supported by the device");
+            return false;
+        }
+
+        // The arguments are laid out as VkDrawIndexedIndirectCommand
+        SP_ASSERT(arguments->GetStride() == sizeof(VkDrawIndexedIndirectCommand));
+
+        // Ensure correct state before attempting to draw
+        if (!OnDraw())
+            return false;
+
+        vkCmdDrawIndexedIndirectCount(
+            static_cast<VkCommandBuffer>(m_cmd_buffer),                                                 // commandBuffer
+            static_cast<VkBuffer>(arguments->GetResource()),                                            // buffer
+            arguments->GetOffset() + static_cast<uint64_t>(arguments_index) * arguments->GetStride(),   // offset
+            static_cast<VkBuffer>(count->GetResource()),                                                // countBuffer
+            count->GetOffset() + static_cast<uint64_t>(count_index) * count->GetStride(),               // countBufferOffset
+            max_draw_count,                                                                             // maxDrawCount
+            arguments->GetStride()                                                                      // stride
+        );
+
+        m_profiler->m_rhi_draw_indirect++;
+
+        return true;
+    }
+
     bool RHI_CommandList::Dispatch(uint32_t x, uint32_t y, uint32_t z, bool async /*= false*/)
     {
         // Validate command list state
@@ -664,6 +1016,93 @@ namespace Spartan
         m_descriptor_set_layout_cache->SetTexture(slot, texture, storage);
     }
 
+    void RHI_CommandList::SetStructuredBuffer(const uint32_t slot, RHI_StructuredBuffer* structured_buffer, const bool storage /*= false*/) const
+    {
+        // Validate command list state
+        SP_ASSERT(m_state == RHI_CommandListState::Recording);
+
+        if (!m_descriptor_set_layout_cache->GetCurrentDescriptorSetLayout())
+        {
+            LOG_WARNING("Descriptor layout not set, try setting structured buffer \"%s\" within a render pass", structured_buffer->GetName().c_str());
+            return;
+        }
+
+        if (!structured_buffer->GetResource())
+        {
+            LOG_ERROR("Structured buffer \"%s\" has no resource", structured_buffer->GetName().c_str());
+            return;
+        }
+
+        // Set (will only happen if it's not already set)
+        m_descriptor_set_layout_cache->SetStructuredBuffer(slot, structured_buffer, storage);
+    }
+
+    static void insert_buffer_barrier(VkCommandBuffer cmd_buffer, RHI_StructuredBuffer* buffer, VkPipelineStageFlags stage_src, VkAccessFlags access_src, VkPipelineStageFlags stage_dst, VkAccessFlags access_dst)
+    {
+        VkBufferMemoryBarrier barrier   = {};
+        barrier.sType                   = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask           = access_src;
+        barrier.dstAccessMask           = access_dst;
+        barrier.srcQueueFamilyIndex     = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex     = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer                  = static_cast<VkBuffer>(buffer->GetResource());
+        barrier.offset                  = buffer->GetOffset();
+        barrier.size                    = buffer->GetRange();
+
+        vkCmdPipelineBarrier(cmd_buffer, stage_src, stage_dst, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+    }
+
+    void RHI_CommandList::ClearStructuredBuffer(RHI_StructuredBuffer* structured_buffer, const uint32_t value /*= 0*/)
+    {
+        // Validate command list state
+        SP_ASSERT(m_state == RHI_CommandListState::Recording);
+
+        if (m_render_pass_active)
+        {
+            LOG_ERROR("Must only be called outside of a render pass instance");
+            return;
+        }
+
+        if (structured_buffer->IsDynamic())
+        {
+            LOG_ERROR("Dynamic buffers are written by the CPU");
+            return;
+        }
+
+        VkCommandBuffer cmd_buffer              = static_cast<VkCommandBuffer>(m_cmd_buffer);
+        const VkPipelineStageFlags stages_read  = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | m_rhi_device->GetEnabledGraphicsStages() | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        const VkAccessFlags access_read         = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+        // Wait for previous reads (previous submissions included), since the buffer is re-used every frame
+        insert_buffer_barrier(cmd_buffer, structured_buffer, stages_read, access_read, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+
+        vkCmdFillBuffer(cmd_buffer, static_cast<VkBuffer>(structured_buffer->GetResource()), structured_buffer->GetOffset(), structured_buffer->GetRange(), value);
+
+        // Make the clear visible to compute shaders
+        insert_buffer_barrier(cmd_buffer, structured_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+        m_profiler->m_rhi_pipeline_barriers += 2;
+    }
+
+    void RHI_CommandList::InsertBarrier(RHI_StructuredBuffer* structured_buffer)
+    {
+        // Validate command list state
+        SP_ASSERT(m_state == RHI_CommandListState::Recording);
+
+        if (m_render_pass_active)
+        {
+            LOG_ERROR("Must only be called outside of a render pass instance");
+            return;
+        }
+
+        const VkPipelineStageFlags stages_read  = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | m_rhi_device->GetEnabledGraphicsStages() | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        const VkAccessFlags access_read         = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+        insert_buffer_barrier(static_cast<VkCommandBuffer>(m_cmd_buffer), structured_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, stages_read, access_read);
+
+        m_profiler->m_rhi_pipeline_barriers++;
+    }
+
     uint32_t RHI_CommandList::Gpu_GetMemory(RHI_Device* rhi_device)
     {
         if (!rhi_device || !rhi_device->GetContextRhi())
@@ -725,16 +1164,16 @@ namespace Spartan
         return true;
     }
 
-    float RHI_CommandList::Timestamp_GetDuration(void* query_disjoint, void* query_start, void* query_end, const uint32_t pass_index)
+    float RHI_CommandList::Timestamp_GetDuration(void* query_disjoint, void* query_start, void* query_end, const uint32_t index)
     {
-        if (pass_index + 1 >= m_timestamps.size())
+        if (index + 1 >= m_timestamps.size())
         {
-            LOG_ERROR("Pass index out of timestamp array range");
+            LOG_ERROR("Timestamp index out of timestamp array range");
             return 0.0f;
         }
 
-        uint64_t start  = m_timestamps[pass_index];
-        uint64_t end    = m_timestamps[pass_index + 1];
+        uint64_t start  = m_timestamps[index];
+        uint64_t end    = m_timestamps[index + 1];
 
         // If end has not been acquired yet (zero), early exit
         if (end < start)
@@ -746,6 +1185,24 @@ namespace Spartan
         return duration_ms;
     }
 
+    uint32_t RHI_CommandList::Timestamp_Write()
+    {
+        const uint32_t index = m_timestamp_index;
+        if (!m_query_pool || index >= m_max_timestamps || !Timestamp_Start())
+            return m_max_timestamps;
+
+        return index;
+    }
+
+    double RHI_CommandList::Timestamp_GetMs(const uint32_t index) const
+    {
+        if (index >= m_max_timestamps)
+            return 0.0;
+
+        // Timestamps from different queues of the same device share the same time domain, so they can be compared
+        return static_cast<double>(m_timestamps[index]) * m_rhi_device->GetContextRhi()->device_properties.limits.timestampPeriod * 1e-6;
+    }
+
     bool RHI_CommandList::Gpu_QueryCreate(RHI_Device* rhi_device, void** query /*= nullptr*/, RHI_Query_Type type /*= RHI_Query_Timestamp*/)
     {
         // Not needed
@@ -809,7 +1266,7 @@ namespace Spartan
         }
     }
 
-    bool RHI_CommandList::Deferred_BeginRenderPass()
+    bool RHI_CommandList::Deferred_BeginRenderPass(const bool contents_secondary /*= false*/)
     {
         // Validate command list state
         SP_ASSERT(m_state == RHI_CommandListState::Recording);
@@ -820,7 +1277,7 @@ namespace Spartan
         // Validate pipeline state
         SP_ASSERT(pipeline_state != nullptr);
         SP_ASSERT(pipeline_state->GetRenderPass() != nullptr);
-        SP_ASSERT(pipeline_state->GetFrameBuffer() != nullptr);
+        SP_ASSERT(m_frame_buffer != nullptr);
 
         // Clear values
         array<VkClearValue, rhi_max_render_target_count + 1> clear_values; // +1 for depth-stencil
@@ -854,13 +1311,14 @@ namespace Spartan
         VkRenderPassBeginInfo render_pass_info      = {};
         render_pass_info.sType                      = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
         render_pass_info.renderPass                 = static_cast<VkRenderPass>(pipeline_state->GetRenderPass());
-        render_pass_info.framebuffer                = static_cast<VkFramebuffer>(pipeline_state->GetFrameBuffer());
+        render_pass_info.framebuffer                = static_cast<VkFramebuffer>(m_frame_buffer);
         render_pass_info.renderArea.offset          = { 0, 0 };
-        render_pass_info.renderArea.extent.width    = pipeline_state->GetWidth();
-        render_pass_info.renderArea.extent.height   = pipeline_state->GetHeight();
+        render_pass_info.renderArea.extent.width    = m_pipeline_state->GetWidth();
+        render_pass_info.renderArea.extent.height   = m_pipeline_state->GetHeight();
         render_pass_info.clearValueCount            = clear_value_count;
         render_pass_info.pClearValues               = clear_values.data();
-        vkCmdBeginRenderPass(static_cast<VkCommandBuffer>(m_cmd_buffer), &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+        VkSubpassContents subpass_contents          = contents_secondary ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE;
+        vkCmdBeginRenderPass(static_cast<VkCommandBuffer>(m_cmd_buffer), &render_pass_info, subpass_contents);
 
         m_render_pass_active = true;
 
@@ -874,7 +1332,7 @@ namespace Spartan
 
         // Descriptor set != null, result = true    -> a descriptor set must be bound
         // Descriptor set == null, result = true    -> a descriptor set is already bound
-        // Descriptor set == null, result = false   -> a new descriptor was needed but we are out of memory (allocates next frame)
+        // Descriptor set == null, result = false   -> a new descriptor was needed but allocating it failed (the draw is skipped)
 
         RHI_DescriptorSet* descriptor_set = nullptr;
         bool result = m_descriptor_set_layout_cache->GetDescriptorSet(descriptor_set);
@@ -889,9 +1347,11 @@ namespace Spartan
             const std::array<uint32_t, rhi_max_constant_buffer_count> dynamic_offsets = descriptor_set_layout->GetDynamicOffsets();
             uint32_t dynamic_offset_count = descriptor_set_layout->GetDynamicOffsetCount();
 
-            // Validate descriptor sets
-            array<void*, 1> descriptor_sets = { descriptor_set->GetResource() };
-            for (uint32_t i = 0; i < static_cast<uint32_t>(descriptor_sets.size()); i++)
+            // Validate descriptor sets (the bindless set is rebound along with the first one, since a new set layout disturbs the sets after it)
+            RHI_BindlessTable* bindless_table   = m_pipeline_state->bindless_table;
+            array<void*, 2> descriptor_sets     = { descriptor_set->GetResource(), bindless_table ? bindless_table->GetResource() : nullptr };
+            uint32_t descriptor_set_count       = bindless_table ? 2 : 1;
+            for (uint32_t i = 0; i < descriptor_set_count; i++)
             {
                 SP_ASSERT(descriptor_sets[i] != nullptr);
             }
@@ -903,7 +1363,7 @@ namespace Spartan
                 pipeline_bind_point,                                            // pipelineBindPoint
                 static_cast<VkPipelineLayout>(m_pipeline->GetPipelineLayout()), // layout
                 0,                                                              // firstSet
-                static_cast<uint32_t>(descriptor_sets.size()),                  // descriptorSetCount
+                descriptor_set_count,                                           // descriptorSetCount
                 reinterpret_cast<VkDescriptorSet*>(descriptor_sets.data()),     // pDescriptorSets
                 dynamic_offset_count,                                           // dynamicOffsetCount
                 !dynamic_offsets.empty() ? dynamic_offsets.data() : nullptr     // pDynamicOffsets
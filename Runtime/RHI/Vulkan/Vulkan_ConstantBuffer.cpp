@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Spartan.h"
 #include "../RHI_Implementation.h"
 #include "../RHI_ConstantBuffer.h"
+#include "../RHI_UploadAllocator.h"
 #include "../RHI_Device.h"
 #include "../RHI_CommandList.h"
 //================================
@@ -35,8 +36,12 @@ namespace Spartan
 {
     void RHI_ConstantBuffer::_destroy()
     {
-        // Wait in case it's still in use by the GPU
-        m_rhi_device->Queue_WaitAll();
+        // Dynamic buffers point into the pages of the upload allocator, which owns them
+        if (IsDynamic())
+        {
+            m_buffer = nullptr;
+            return;
+        }
 
         // Unmap
         if (m_mapped)
@@ -45,15 +50,16 @@ namespace Spartan
             m_mapped = nullptr;
         }
 
-        // Destroy
-        vulkan_utility::buffer::destroy(m_buffer);
+        // Destroy, once it's no longer in use by the GPU
+        m_rhi_device->DeletionQueue_Add(RHI_Resource_Type::Buffer, m_buffer);
+        m_buffer = nullptr;
     }
 
-    RHI_ConstantBuffer::RHI_ConstantBuffer(const std::shared_ptr<RHI_Device>& rhi_device, const string& name, bool is_dynamic /*= false*/)
+    RHI_ConstantBuffer::RHI_ConstantBuffer(const std::shared_ptr<RHI_Device>& rhi_device, const string& name, RHI_UploadAllocator* upload_allocator /*= nullptr*/)
     {
-        m_rhi_device    = rhi_device;
-        m_name          = name;
-        m_is_dynamic    = is_dynamic;
+        m_rhi_device        = rhi_device;
+        m_name              = name;
+        m_upload_allocator  = upload_allocator;
     }
 
     bool RHI_ConstantBuffer::_create()
@@ -73,7 +79,14 @@ namespace Spartan
         {
             m_stride = static_cast<uint32_t>((m_stride + min_ubo_alignment - 1) & ~(min_ubo_alignment - 1));
         }
-        m_size_gpu = m_offset_count * m_stride;
+        m_size_gpu = m_stride;
+
+        // Dynamic buffers live in the pages of the upload allocator, start with zeroed data so that they can be bound right away
+        if (IsDynamic())
+        {
+            vector<byte> data(m_size_cpu, byte(0));
+            return Update(data.data());
+        }
 
         // Create buffer
         VkMemoryPropertyFlags flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
@@ -93,6 +106,43 @@ namespace Spartan
         return true;
     }
 
+    bool RHI_ConstantBuffer::Update(const void* data)
+    {
+        // Dynamic
+        if (IsDynamic())
+        {
+            RHI_UploadAllocation allocation;
+            if (!m_upload_allocator->Upload(data, m_size_cpu, allocation))
+            {
+                LOG_ERROR("Failed to upload %s buffer", m_name.c_str());
+                return false;
+            }
+
+            m_buffer            = allocation.buffer;
+            m_offset_dynamic    = allocation.offset;
+            m_upload_frame      = m_upload_allocator->GetFrame();
+
+            return true;
+        }
+
+        // Static
+        void* mapped = Map();
+        if (!mapped)
+        {
+            LOG_ERROR("Failed to map %s buffer", m_name.c_str());
+            return false;
+        }
+
+        memcpy(mapped, data, m_size_cpu);
+
+        return Unmap(0, m_size_cpu);
+    }
+
+    bool RHI_ConstantBuffer::IsStale() const
+    {
+        return IsDynamic() && m_upload_frame != m_upload_allocator->GetFrame();
+    }
+
     void* RHI_ConstantBuffer::Map()
     {
         if (!m_rhi_device || !m_rhi_device->GetContextRhi()->device)
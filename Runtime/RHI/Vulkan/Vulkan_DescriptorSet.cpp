@@ -43,18 +43,9 @@ namespace Spartan
         // Validate descriptor set
         SP_ASSERT(m_resource == nullptr);
 
-        // Descriptor set layouts
-        array<void*, 1> descriptor_set_layouts = { m_descriptor_set_layout_cache->GetCurrentDescriptorSetLayout()->GetResource() };
-
-        // Allocate info
-        VkDescriptorSetAllocateInfo allocate_info   = {};
-        allocate_info.sType                         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        allocate_info.descriptorPool                = static_cast<VkDescriptorPool>(m_descriptor_set_layout_cache->GetResource_DescriptorPool());
-        allocate_info.descriptorSetCount            = 1;
-        allocate_info.pSetLayouts                   = reinterpret_cast<VkDescriptorSetLayout*>(descriptor_set_layouts.data());
-
-        // Allocate
-        if (!vulkan_utility::error::check(vkAllocateDescriptorSets(m_rhi_device->GetContextRhi()->device, &allocate_info, reinterpret_cast<VkDescriptorSet*>(&m_resource))))
+        // Allocate, from whichever pool of the cache has room
+        void* descriptor_set_layout = m_descriptor_set_layout_cache->GetCurrentDescriptorSetLayout()->GetResource();
+        if (!m_descriptor_set_layout_cache->AllocateDescriptorSet(descriptor_set_layout, m_resource, m_descriptor_pool))
             return false;
 
         // Name
@@ -93,8 +84,8 @@ namespace Spartan
                 image_infos[i].imageView    = static_cast<VkImageView>(descriptor.resource);
                 image_infos[i].imageLayout  = descriptor.resource ? vulkan_image_layout[static_cast<uint8_t>(descriptor.layout)] : VK_IMAGE_LAYOUT_UNDEFINED;
             }
-            // Constant/Uniform buffer
-            else if (descriptor.type == RHI_Descriptor_Type::ConstantBuffer)
+            // Constant/Uniform and structured/storage buffers
+            else if (descriptor.type == RHI_Descriptor_Type::ConstantBuffer || descriptor.type == RHI_Descriptor_Type::StructuredBuffer)
             {
                 buffer_infos[i].buffer  = static_cast<VkBuffer>(descriptor.resource);
                 buffer_infos[i].offset  = descriptor.offset;
@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI_Implementation.h"
 #include "../RHI_DescriptorSetLayoutCache.h"
 #include "../RHI_Shader.h"
+#include "../../Profiling/Profiler.h"
 //==========================================
 
 //= NAMESPACES =====
@@ -34,101 +35,130 @@ namespace Spartan
 {
     RHI_DescriptorSetLayoutCache::~RHI_DescriptorSetLayoutCache()
     {
-        if (m_descriptor_pool)
-        {
-            // Wait in case it's still in use by the GPU
-            m_rhi_device->Queue_WaitAll();
+        // Descriptor sets are freed along with their pools
+        m_descriptor_set_layouts.clear();
 
-            vkDestroyDescriptorPool(m_rhi_device->GetContextRhi()->device, static_cast<VkDescriptorPool>(m_descriptor_pool), nullptr);
-            m_descriptor_pool = nullptr;
-        }
+        DestroyDescriptorPools();
     }
 
-    void RHI_DescriptorSetLayoutCache::Reset(uint32_t descriptor_set_capacity /*= 0*/)
+    void RHI_DescriptorSetLayoutCache::Reset()
     {
-        // If the requested capacity is zero, then only recreate the descriptor pool
-        if (descriptor_set_capacity == 0)
-        {
-            descriptor_set_capacity = m_descriptor_set_capacity;
-        }
-
         // Destroy layouts (and descriptor sets)
         m_descriptor_set_layouts_being_cleared = true;
         m_descriptor_set_layouts.clear();
         m_descriptor_set_layouts_being_cleared = false;
         m_descriptor_layout_current = nullptr;
 
-        // Destroy pool
-        if (m_descriptor_pool)
-        {
-            // Wait in case it's still in use by the GPU
-            m_rhi_device->Queue_WaitAll();
+        // Destroy pools, new ones are created as descriptor sets get allocated
+        DestroyDescriptorPools();
 
-            vkDestroyDescriptorPool(m_rhi_device->GetContextRhi()->device, static_cast<VkDescriptorPool>(m_descriptor_pool), nullptr);
-            m_descriptor_pool = nullptr;
-        }
+        LOG_INFO("Descriptor pools have been reset");
+    }
 
-        // Create pool
-        CreateDescriptorPool(descriptor_set_capacity);
+    bool RHI_DescriptorSetLayoutCache::AllocateDescriptorSet(void* descriptor_set_layout, void*& descriptor_set, void*& descriptor_pool)
+    {
+        // Descriptor set layouts
+        array<void*, 1> descriptor_set_layouts = { descriptor_set_layout };
 
-        // Log
-        if (descriptor_set_capacity > m_descriptor_set_capacity)
-        {
-            LOG_INFO("Capacity has been increased to %d elements", descriptor_set_capacity);
-        }
-        else if (descriptor_set_capacity < m_descriptor_set_capacity)
+        // Allocate info
+        VkDescriptorSetAllocateInfo allocate_info   = {};
+        allocate_info.sType                         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocate_info.descriptorSetCount            = 1;
+        allocate_info.pSetLayouts                   = reinterpret_cast<VkDescriptorSetLayout*>(descriptor_set_layouts.data());
+
+        auto allocate = [this, &allocate_info, &descriptor_set, &descriptor_pool](const uint32_t pool_index)
         {
-            LOG_INFO("Capacity has been decreased to %d elements", descriptor_set_capacity);
-        }
-        else
+            allocate_info.descriptorPool    = static_cast<VkDescriptorPool>(m_descriptor_pools[pool_index]);
+            const VkResult result           = vkAllocateDescriptorSets(m_rhi_device->GetContextRhi()->device, &allocate_info, reinterpret_cast<VkDescriptorSet*>(&descriptor_set));
+
+            if (result == VK_SUCCESS)
+            {
+                descriptor_pool         = m_descriptor_pools[pool_index];
+                m_descriptor_pool_index = pool_index;
+                m_profiler->m_rhi_descriptor_sets_allocated++;
+            }
+
+            return result;
+        };
+
+        // Try the existing pools, starting with the one which served the last allocation
+        const uint32_t pool_count = static_cast<uint32_t>(m_descriptor_pools.size());
+        for (uint32_t i = 0; i < pool_count; i++)
         {
-            LOG_INFO("Descriptor pool has been reset");
+            const VkResult result = allocate((m_descriptor_pool_index + i) % pool_count);
+
+            if (result == VK_SUCCESS)
+                return true;
+
+            // A full pool is expected, anything else is an actual error
+            if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL)
+            {
+                vulkan_utility::error::check(result);
+                m_profiler->m_rhi_descriptor_sets_skipped++;
+                return false;
+            }
         }
+
+        // All pools are full, add one
+        if (CreateDescriptorPool() && vulkan_utility::error::check(allocate(pool_count)))
+            return true;
+
+        m_profiler->m_rhi_descriptor_sets_skipped++;
+        return false;
     }
 
-    void RHI_DescriptorSetLayoutCache::SetDescriptorSetCapacity(uint32_t descriptor_set_capacity)
+    void RHI_DescriptorSetLayoutCache::FreeDescriptorSet(void* descriptor_set, void* descriptor_pool)
     {
-        if (!m_rhi_device || !m_rhi_device->GetContextRhi())
-        {
-            LOG_ERROR_INVALID_INTERNALS();
+        if (!descriptor_set || !descriptor_pool)
             return;
-        }
 
-        if (m_descriptor_set_capacity == descriptor_set_capacity)
-        {
-            LOG_INFO("Capacity is already %d elements", m_descriptor_set_capacity);
-            return;
-        }
-
-        // Re-create descriptor pool
-        Reset(descriptor_set_capacity);
-
-        // Update capacity
-        m_descriptor_set_capacity = descriptor_set_capacity;
+        vkFreeDescriptorSets(m_rhi_device->GetContextRhi()->device, static_cast<VkDescriptorPool>(descriptor_pool), 1, reinterpret_cast<VkDescriptorSet*>(&descriptor_set));
     }
 
-    bool RHI_DescriptorSetLayoutCache::CreateDescriptorPool(uint32_t descriptor_set_capacity)
+    bool RHI_DescriptorSetLayoutCache::CreateDescriptorPool()
     {
-        // Pool sizes
-        std::array<VkDescriptorPoolSize, 5> pool_sizes =
+        // Pool sizes, enough for every descriptor set to use the maximum amount of each descriptor type
+        std::array<VkDescriptorPoolSize, 6> pool_sizes =
         {
-            VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_SAMPLER,                   rhi_descriptor_max_samplers },
-            VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,             rhi_descriptor_max_textures },
-            VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,             rhi_descriptor_max_storage_textures },
-            VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,            rhi_descriptor_max_constant_buffers },
-            VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,    rhi_descriptor_max_constant_buffers_dynamic }
+            VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_SAMPLER,                   rhi_descriptor_max_samplers                 * m_descriptor_pool_capacity },
+            VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,             rhi_descriptor_max_textures                 * m_descriptor_pool_capacity },
+            VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,             rhi_descriptor_max_storage_textures         * m_descriptor_pool_capacity },
+            VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,            rhi_descriptor_max_constant_buffers         * m_descriptor_pool_capacity },
+            VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,    rhi_descriptor_max_constant_buffers_dynamic * m_descriptor_pool_capacity },
+            VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,            rhi_descriptor_max_structured_buffers       * m_descriptor_pool_capacity }
         };
 
-        // Create info
+        // Create info, descriptor sets are freed individually when they go unused
         VkDescriptorPoolCreateInfo pool_create_info = {};
         pool_create_info.sType          = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-        pool_create_info.flags          = 0;
+        pool_create_info.flags          = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
         pool_create_info.poolSizeCount  = static_cast<uint32_t>(pool_sizes.size());
         pool_create_info.pPoolSizes     = pool_sizes.data();
-        pool_create_info.maxSets        = descriptor_set_capacity;
+        pool_create_info.maxSets        = m_descriptor_pool_capacity;
 
         // Pool
-        const auto descriptor_pool = reinterpret_cast<VkDescriptorPool*>(&m_descriptor_pool);
-        return vulkan_utility::error::check(vkCreateDescriptorPool(m_rhi_device->GetContextRhi()->device, &pool_create_info, nullptr, descriptor_pool));
+        void* descriptor_pool = nullptr;
+        if (!vulkan_utility::error::check(vkCreateDescriptorPool(m_rhi_device->GetContextRhi()->device, &pool_create_info, nullptr, reinterpret_cast<VkDescriptorPool*>(&descriptor_pool))))
+            return false;
+
+        m_descriptor_pools.emplace_back(descriptor_pool);
+
+        return true;
+    }
+
+    void RHI_DescriptorSetLayoutCache::DestroyDescriptorPools()
+    {
+        if (m_descriptor_pools.empty())
+            return;
+
+        // Wait in case they are still in use by the GPU
+        m_rhi_device->Queue_WaitAll();
+
+        for (void* descriptor_pool : m_descriptor_pools)
+        {
+            vkDestroyDescriptorPool(m_rhi_device->GetContextRhi()->device, static_cast<VkDescriptorPool>(descriptor_pool), nullptr);
+        }
+        m_descriptor_pools.clear();
+        m_descriptor_pool_index = 0;
     }
 }
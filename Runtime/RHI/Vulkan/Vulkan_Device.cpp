@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI_Implementation.h"
 #include "../RHI_Semaphore.h"
 #include "../RHI_Fence.h"
+#include "../RHI_UploadManager.h"
 //================================
 
 //= NAMESPACES ===============
@@ -168,6 +169,7 @@ namespace Spartan
 
             // Resource limits
             RHI_Context::texture_2d_dimension_max = m_rhi_context->device_properties.limits.maxImageDimension2D;
+            RHI_Context::constant_buffer_size_max = m_rhi_context->device_properties.limits.maxUniformBufferRange;
 
             // Disable profiler if timestamps are not supported
             if (m_rhi_context->profiler && !m_rhi_context->device_properties.limits.timestampComputeAndGraphics)
@@ -201,6 +203,29 @@ namespace Spartan
                 ENABLE_FEATURE(m_rhi_context->device_features.features, device_features_enabled.features, wideLines)
                 ENABLE_FEATURE(m_rhi_context->device_features.features, device_features_enabled.features, imageCubeArray)
                 ENABLE_FEATURE(m_rhi_context->device_features_1_2, device_features_1_2_enabled, timelineSemaphore)
+
+                // Descriptor indexing (bindless textures)
+                ENABLE_FEATURE(m_rhi_context->device_features_1_2, device_features_1_2_enabled, descriptorIndexing)
+                ENABLE_FEATURE(m_rhi_context->device_features_1_2, device_features_1_2_enabled, runtimeDescriptorArray)
+                ENABLE_FEATURE(m_rhi_context->device_features_1_2, device_features_1_2_enabled, descriptorBindingPartiallyBound)
+                ENABLE_FEATURE(m_rhi_context->device_features_1_2, device_features_1_2_enabled, descriptorBindingSampledImageUpdateAfterBind)
+                ENABLE_FEATURE(m_rhi_context->device_features_1_2, device_features_1_2_enabled, shaderSampledImageArrayNonUniformIndexing)
+                m_bindless_supported =
+                    device_features_1_2_enabled.descriptorIndexing                              &&
+                    device_features_1_2_enabled.runtimeDescriptorArray                          &&
+                    device_features_1_2_enabled.descriptorBindingPartiallyBound                 &&
+                    device_features_1_2_enabled.descriptorBindingSampledImageUpdateAfterBind    &&
+                    device_features_1_2_enabled.shaderSampledImageArrayNonUniformIndexing;
+
+                // Indirect drawing with a GPU written draw count (the arguments start each draw at the instance it was culled from)
+                ENABLE_FEATURE(m_rhi_context->device_features.features, device_features_enabled.features, multiDrawIndirect)
+                ENABLE_FEATURE(m_rhi_context->device_features.features, device_features_enabled.features, drawIndirectFirstInstance)
+                ENABLE_FEATURE(m_rhi_context->device_features_1_2, device_features_1_2_enabled, drawIndirectCount)
+                m_draw_indirect_count_supported =
+                    m_rhi_context->api_version >= VK_API_VERSION_1_2            &&
+                    device_features_enabled.features.multiDrawIndirect          &&
+                    device_features_enabled.features.drawIndirectFirstInstance  &&
+                    device_features_1_2_enabled.drawIndirectCount;
             }
 
             // Determine enabled graphics shader stages
@@ -264,6 +289,9 @@ namespace Spartan
         LOG_INFO("Vulkan %s", version.c_str());
 
         m_initialized = true;
+
+        // Static resources are uploaded via the transfer queue
+        m_upload_manager = make_shared<RHI_UploadManager>(this);
     }
 
     RHI_Device::~RHI_Device()
@@ -274,6 +302,8 @@ namespace Spartan
         // Release resources
         if (Queue_WaitAll())
         {
+            m_upload_manager = nullptr;
+            DeletionQueue_Parse(true);
             m_rhi_context->destroy_allocator();
 
             if (m_rhi_context->debug)
@@ -312,28 +342,75 @@ namespace Spartan
         return true;
     }
 
-    bool RHI_Device::Queue_Submit(const RHI_Queue_Type type, const uint32_t wait_flags, void* cmd_buffer, RHI_Semaphore* wait_semaphore /*= nullptr*/, RHI_Semaphore* signal_semaphore /*= nullptr*/, RHI_Fence* signal_fence /*= nullptr*/) const
+    bool RHI_Device::Queue_Submit(const RHI_Queue_Type type, const uint32_t wait_flags, void* cmd_buffer, RHI_Semaphore* wait_semaphore /*= nullptr*/, RHI_Semaphore* signal_semaphore /*= nullptr*/, RHI_Fence* signal_fence /*= nullptr*/, const uint64_t signal_value /*= 0*/, RHI_Semaphore* wait_semaphore_timeline /*= nullptr*/, const uint64_t wait_value /*= 0*/) const
     {
         // Validate input
         SP_ASSERT(cmd_buffer != nullptr);
 
-        // Validate semaphore states
-        if (wait_semaphore)     SP_ASSERT(wait_semaphore->GetState() == RHI_Semaphore_State::Signaled);
-        if (signal_semaphore)   SP_ASSERT(signal_semaphore->GetState() == RHI_Semaphore_State::Idle);
+        // Validate semaphore states (timeline semaphores have values instead)
+        const bool wait_binary      = wait_semaphore && !wait_semaphore->IsTimelineSemaphore();
+        const bool signal_binary    = signal_semaphore && !signal_semaphore->IsTimelineSemaphore();
+        if (wait_binary)    SP_ASSERT(wait_semaphore->GetState() == RHI_Semaphore_State::Signaled);
+        if (signal_binary)  SP_ASSERT(signal_semaphore->GetState() == RHI_Semaphore_State::Idle);
+
+        // Wait semaphores
+        array<VkSemaphore, 3> vk_wait_semaphores    = {};
+        array<uint64_t, 3> wait_values              = {};
+        array<VkPipelineStageFlags, 3> wait_stages  = {};
+        uint32_t wait_count                         = 0;
+        if (wait_semaphore)
+        {
+            vk_wait_semaphores[wait_count]  = static_cast<VkSemaphore>(wait_semaphore->GetResource());
+            wait_stages[wait_count]         = wait_flags;
+            wait_count++;
+        }
+
+        // Work on another queue (e.g. async compute), which has to complete before anything in this submission executes
+        if (wait_semaphore_timeline)
+        {
+            SP_ASSERT(wait_semaphore_timeline->IsTimelineSemaphore());
+
+            vk_wait_semaphores[wait_count]  = static_cast<VkSemaphore>(wait_semaphore_timeline->GetResource());
+            wait_values[wait_count]         = wait_value;
+            wait_stages[wait_count]         = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+            wait_count++;
+        }
+
+        // Any queue other than the transfer queue waits for the uploads which have been recorded so far, so that they can be used right away
+        if (type != RHI_Queue_Transfer && m_upload_manager)
+        {
+            m_upload_manager->Flush();
+
+            const uint64_t upload_value = m_upload_manager->GetValueSubmitted();
+            if (upload_value != 0 && !m_upload_manager->IsComplete(upload_value))
+            {
+                vk_wait_semaphores[wait_count]  = static_cast<VkSemaphore>(m_upload_manager->GetSemaphore()->GetResource());
+                wait_values[wait_count]         = upload_value;
+                wait_stages[wait_count]         = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+                wait_count++;
+            }
+        }
+
+        // Signal semaphore
+        void* vk_signal_semaphore = signal_semaphore ? signal_semaphore->GetResource() : nullptr;
 
-        // Get semaphore Vulkan resources
-        void* vk_wait_semaphore     = wait_semaphore    ? wait_semaphore->GetResource()     : nullptr;
-        void* vk_signal_semaphore   = signal_semaphore  ? signal_semaphore->GetResource()   : nullptr;
+        // Timeline values (ignored for binary semaphores)
+        VkTimelineSemaphoreSubmitInfo timeline_info = {};
+        timeline_info.sType                         = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timeline_info.waitSemaphoreValueCount       = wait_count;
+        timeline_info.pWaitSemaphoreValues          = wait_values.data();
+        timeline_info.signalSemaphoreValueCount     = signal_semaphore ? 1 : 0;
+        timeline_info.pSignalSemaphoreValues        = &signal_value;
 
         // Submit info
         VkSubmitInfo submit_info            = {};
         submit_info.sType                   = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submit_info.pNext                   = nullptr;
-        submit_info.waitSemaphoreCount      = wait_semaphore ? 1 : 0;
-        submit_info.pWaitSemaphores         = wait_semaphore ? reinterpret_cast<VkSemaphore*>(&vk_wait_semaphore) : nullptr;
+        submit_info.pNext                   = &timeline_info;
+        submit_info.waitSemaphoreCount      = wait_count;
+        submit_info.pWaitSemaphores         = vk_wait_semaphores.data();
         submit_info.signalSemaphoreCount    = signal_semaphore ? 1 : 0;
         submit_info.pSignalSemaphores       = signal_semaphore ? reinterpret_cast<VkSemaphore*>(&vk_signal_semaphore) : nullptr;
-        submit_info.pWaitDstStageMask       = &wait_flags;
+        submit_info.pWaitDstStageMask       = wait_stages.data();
         submit_info.commandBufferCount      = 1;
         submit_info.pCommandBuffers         = reinterpret_cast<VkCommandBuffer*>(&cmd_buffer);
 
@@ -345,8 +422,8 @@ namespace Spartan
             return false;
 
         // Update semaphore states
-        if (wait_semaphore)     wait_semaphore->SetState(RHI_Semaphore_State::Idle);
-        if (signal_semaphore)   signal_semaphore->SetState(RHI_Semaphore_State::Signaled);
+        if (wait_binary)    wait_semaphore->SetState(RHI_Semaphore_State::Idle);
+        if (signal_binary)  signal_semaphore->SetState(RHI_Semaphore_State::Signaled);
 
         return true;
     }
@@ -356,4 +433,35 @@ namespace Spartan
         lock_guard<mutex> lock(m_queue_mutex);
         return vulkan_utility::error::check(vkQueueWaitIdle(static_cast<VkQueue>(Queue_Get(type))));
     }
+
+    void RHI_Device::DeletionQueue_Parse(const bool force /*= false*/)
+    {
+        // Resources have to outlive the command lists in flight, as well as the descriptor sets and frame buffers which refer to them
+        lock_guard<mutex> lock(m_deletion_queue_mutex);
+
+        // Entries are in the order they were added, so the first one which has to wait means the rest have to wait too
+        while (!m_deletion_queue.empty())
+        {
+            DeletionQueueEntry& entry = m_deletion_queue.front();
+
+            if (!force)
+            {
+                const bool frames_passed    = m_deletion_queue_frame - entry.frame >= rhi_deletion_queue_frames;
+                const bool upload_complete  = !m_upload_manager || m_upload_manager->IsComplete(entry.upload_value);
+                if (!frames_passed || !upload_complete)
+                    break;
+            }
+
+            switch (entry.type)
+            {
+                case RHI_Resource_Type::Buffer:     vulkan_utility::buffer::destroy(entry.resource);            break;
+                case RHI_Resource_Type::Image:      vulkan_utility::image::destroy(entry.resource);             break;
+                case RHI_Resource_Type::ImageView:  vulkan_utility::image::view::destroy(entry.resource);       break;
+            }
+
+            m_deletion_queue.pop_front();
+        }
+
+        m_deletion_queue_frame++;
+    }
 }
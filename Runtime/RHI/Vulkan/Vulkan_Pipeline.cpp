@@ -28,6 +28,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI_InputLayout.h"
 #include "../RHI_DescriptorSetLayout.h"
 #include "../RHI_RasterizerState.h"
+#include "../RHI_BindlessTable.h"
 //=====================================
 
 //= NAMESPACES =====
@@ -43,7 +44,13 @@ namespace Spartan
 
         // Pipeline layout
         {
-            array<void*, 1> layouts = { descriptor_set_layout->GetResource() };
+            vector<void*> layouts = { descriptor_set_layout->GetResource() };
+
+            // Bindless textures and materials
+            if (pipeline_state.bindless_table)
+            {
+                layouts.emplace_back(pipeline_state.bindless_table->GetLayout());
+            }
 
             // Validate descriptor set layouts
             for (void* layout : layouts)
@@ -90,7 +97,7 @@ namespace Spartan
 
                 // Pipeline creation
                 VkPipeline* pipeline = reinterpret_cast<VkPipeline*>(&m_pipeline);
-                if (!vulkan_utility::error::check(vkCreateComputePipelines(m_rhi_device->GetContextRhi()->device, nullptr, 1, &pipeline_info, nullptr, pipeline)))
+                if (!vulkan_utility::error::check(vkCreateComputePipelines(m_rhi_device->GetContextRhi()->device, m_rhi_device->GetContextRhi()->pipeline_cache, 1, &pipeline_info, nullptr, pipeline)))
                     return;
 
                 // Name
@@ -101,62 +108,27 @@ namespace Spartan
         {
             if (pipeline_state.IsGraphics())
             {
-                m_state.CreateFrameBuffer(rhi_device);
+                m_state.CreateRenderPass(rhi_device);
             }
 
-            // Viewport & Scissor
-            vector<VkDynamicState> dynamic_states;
+            // Viewport & Scissor (always dynamic, so that they don't affect the pipeline's identity)
+            array<VkDynamicState, 2> dynamic_states             = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
             VkPipelineDynamicStateCreateInfo dynamic_state      = {};
-            VkViewport vkViewport                               = {};
-            VkRect2D scissor                                    = {};
             VkPipelineViewportStateCreateInfo viewport_state    = {};
             {
-                // If no viewport has been provided, assume dynamic
-                if (!m_state.viewport.IsDefined())
-                {
-                    dynamic_states.emplace_back(VK_DYNAMIC_STATE_VIEWPORT);
-                }
-
-                if (m_state.dynamic_scissor)
-                {
-                    dynamic_states.emplace_back(VK_DYNAMIC_STATE_SCISSOR);
-                }
-
                 // Dynamic states
                 dynamic_state.sType             = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
                 dynamic_state.pNext             = nullptr;
                 dynamic_state.flags             = 0;
                 dynamic_state.dynamicStateCount = static_cast<uint32_t>(dynamic_states.size());
                 dynamic_state.pDynamicStates    = dynamic_states.data();
-            
-                // Viewport
-                vkViewport.x        = m_state.viewport.x;
-                vkViewport.y        = m_state.viewport.y;
-                vkViewport.width    = m_state.viewport.width;
-                vkViewport.height   = m_state.viewport.height;
-                vkViewport.minDepth = m_state.viewport.depth_min;
-                vkViewport.maxDepth = m_state.viewport.depth_max;
-            
-                // Scissor
-                if (!m_state.scissor.IsDefined())
-                {
-                    scissor.offset          = { 0, 0 };
-                    scissor.extent.width    = static_cast<uint32_t>(vkViewport.width);
-                    scissor.extent.height   = static_cast<uint32_t>(vkViewport.height);
-                }
-                else
-                {
-                    scissor.offset          = { static_cast<int32_t>(m_state.scissor.left), static_cast<int32_t>(m_state.scissor.top) };
-                    scissor.extent.width    = static_cast<uint32_t>(m_state.scissor.Width());
-                    scissor.extent.height   = static_cast<uint32_t>(m_state.scissor.Height());
-                }
-            
+
                 // Viewport state
                 viewport_state.sType            = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
                 viewport_state.viewportCount    = 1;
-                viewport_state.pViewports       = &vkViewport;
+                viewport_state.pViewports       = nullptr;
                 viewport_state.scissorCount     = 1;
-                viewport_state.pScissors        = &scissor;
+                viewport_state.pScissors        = nullptr;
             }
             
             // Shader stages
@@ -355,7 +327,7 @@ namespace Spartan
             
                 // Create
                 auto pipeline = reinterpret_cast<VkPipeline*>(&m_pipeline);
-                if (!vulkan_utility::error::check(vkCreateGraphicsPipelines(m_rhi_device->GetContextRhi()->device, nullptr, 1, &pipeline_info, nullptr, pipeline)))
+                if (!vulkan_utility::error::check(vkCreateGraphicsPipelines(m_rhi_device->GetContextRhi()->device, m_rhi_device->GetContextRhi()->pipeline_cache, 1, &pipeline_info, nullptr, pipeline)))
                     return;
 
                 // Name
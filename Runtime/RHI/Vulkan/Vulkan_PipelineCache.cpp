@@ -0,0 +1,125 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ========================
+#include "Spartan.h"
+#include "../RHI_Implementation.h"
+#include "../RHI_Device.h"
+#include "../RHI_PipelineCache.h"
+#include "../../IO/FileStream.h"
+//===================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    // The header which the driver writes at the start of the data (VkPipelineCacheHeaderVersionOne)
+    static bool is_driver_cache_compatible(const vector<std::byte>& data, const VkPhysicalDeviceProperties& properties)
+    {
+        const uint32_t header_size = 16 + VK_UUID_SIZE;
+        if (data.size() < header_size)
+            return false;
+
+        uint32_t header[4];
+        memcpy(header, data.data(), sizeof(header));
+
+        return
+            header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE   &&
+            header[2] == properties.vendorID                    &&
+            header[3] == properties.deviceID                    &&
+            memcmp(data.data() + 16, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+
+    void RHI_PipelineCache::CreateDriverCache()
+    {
+        RHI_Context* rhi_context = m_rhi_device->GetContextRhi();
+
+        // Load the data which the driver produced in a previous session (if it was produced by this device and driver)
+        vector<std::byte> data;
+        const string file_path = m_directory + "\\pipeline_cache.bin";
+        if (FileSystem::Exists(file_path))
+        {
+            auto file = make_unique<FileStream>(file_path, FileStream_Read);
+            if (file->IsOpen())
+            {
+                file->Read(&data);
+            }
+
+            if (!is_driver_cache_compatible(data, rhi_context->device_properties))
+            {
+                LOG_INFO("The pipeline cache was produced by a different device or driver, ignoring it.");
+                data.clear();
+            }
+        }
+
+        VkPipelineCacheCreateInfo create_info   = {};
+        create_info.sType                       = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        create_info.initialDataSize             = data.size();
+        create_info.pInitialData                = data.empty() ? nullptr : data.data();
+
+        if (!vulkan_utility::error::check(vkCreatePipelineCache(rhi_context->device, &create_info, nullptr, &rhi_context->pipeline_cache)))
+        {
+            LOG_ERROR("Failed to create pipeline cache");
+            rhi_context->pipeline_cache = nullptr;
+        }
+    }
+
+    void RHI_PipelineCache::DestroyDriverCache()
+    {
+        RHI_Context* rhi_context = m_rhi_device->GetContextRhi();
+        if (!rhi_context->pipeline_cache)
+            return;
+
+        // Save the data, so that the next session can skip compiling the same pipelines
+        size_t size = 0;
+        if (vulkan_utility::error::check(vkGetPipelineCacheData(rhi_context->device, rhi_context->pipeline_cache, &size, nullptr)) && size != 0)
+        {
+            vector<std::byte> data(size);
+            if (vulkan_utility::error::check(vkGetPipelineCacheData(rhi_context->device, rhi_context->pipeline_cache, &size, data.data())))
+            {
+                data.resize(size);
+
+                // Written the same way as the pipeline descriptions, to a temporary file which replaces the old one once complete
+                const string file_path      = m_directory + "\\pipeline_cache.bin";
+                const string file_path_temp = file_path + ".tmp";
+
+                auto file = make_unique<FileStream>(file_path_temp, FileStream_Write);
+                if (file->IsOpen())
+                {
+                    file->Write(data);
+
+                    const bool written = file->IsGood();
+                    file->Close();
+                    if (!written || !FileSystem::Rename(file_path_temp, file_path))
+                    {
+                        FileSystem::Delete(file_path_temp);
+                    }
+                }
+            }
+        }
+
+        vkDestroyPipelineCache(rhi_context->device, rhi_context->pipeline_cache, nullptr);
+        rhi_context->pipeline_cache = nullptr;
+    }
+}
@@ -199,36 +199,97 @@ namespace Spartan
         return vulkan_utility::error::check(vkCreateFramebuffer(rhi_context->device, &create_info, nullptr, reinterpret_cast<VkFramebuffer*>(&frame_buffer)));
     }
   
-    void* RHI_PipelineState::GetFrameBuffer() const
+    void* RHI_PipelineState::GetFrameBuffer(const RHI_PipelineState& pipeline_state, const uint64_t frame)
     {
-        // If this is a swapchain, return the appropriate buffer
-        if (render_target_swapchain)
+        if (!m_render_pass)
+            return nullptr;
+
+        // The frame buffer attachments come from the live pipeline state, since the pipeline (and therefore this render pass)
+        // can be shared by any pipeline state which has the same formats, while using different textures or array slices.
+        std::array<uint32_t, rhi_max_render_target_count + 5> key = {};
+        vector<void*> attachments;
+
+        // Swapchain
+        if (RHI_SwapChain* swapchain = pipeline_state.render_target_swapchain)
         {
-            if (render_target_swapchain->GetImageIndex() >= rhi_max_render_target_count)
+            if (swapchain->GetImageIndex() >= swapchain->GetBufferCount())
             {
-                LOG_ERROR("Invalid image index, %d", render_target_swapchain->GetImageIndex());
+                LOG_ERROR("Invalid image index, %d", swapchain->GetImageIndex());
                 return nullptr;
             }
 
-            return m_frame_buffers[render_target_swapchain->GetImageIndex()];
+            key[0] = swapchain->GetId();
+            key[1] = swapchain->GetImageIndex();
+            attachments.emplace_back(swapchain->Get_Resource_View(swapchain->GetImageIndex()));
         }
+        else
+        {
+            // Color
+            for (uint32_t i = 0; i < rhi_max_render_target_count; i++)
+            {
+                if (RHI_Texture* texture = pipeline_state.render_target_color_textures[i])
+                {
+                    key[2 + i] = texture->GetId();
+                    attachments.emplace_back(texture->Get_Resource_View_RenderTarget(pipeline_state.render_target_color_texture_array_index));
+                }
+            }
+            key[rhi_max_render_target_count + 2] = pipeline_state.render_target_color_texture_array_index;
+
+            // Depth
+            if (RHI_Texture* texture = pipeline_state.render_target_depth_texture)
+            {
+                key[rhi_max_render_target_count + 3] = texture->GetId();
+                key[rhi_max_render_target_count + 4] = pipeline_state.render_target_depth_stencil_texture_array_index;
+                attachments.emplace_back(texture->Get_Resource_View_DepthStencil(pipeline_state.render_target_depth_stencil_texture_array_index));
+            }
+        }
+
+        // Return an existing frame buffer
+        auto it = m_frame_buffers.find(key);
+        if (it != m_frame_buffers.end())
+        {
+            it->second.frame_used = frame;
+            return it->second.resource;
+        }
+
+        // Destroy frame buffers which haven't been used for a while, their attachments were most likely
+        // destroyed (e.g. due to a resolution change) and they can't be in flight anymore, so no wait is needed.
+        for (auto it = m_frame_buffers.begin(); it != m_frame_buffers.end();)
+        {
+            if (frame - it->second.frame_used > rhi_max_frames_unused)
+            {
+                vkDestroyFramebuffer(m_rhi_device->GetContextRhi()->device, static_cast<VkFramebuffer>(it->second.resource), nullptr);
+                it = m_frame_buffers.erase(it);
+            }
+            else
+            {
+                it++;
+            }
+        }
+
+        // Create a frame buffer
+        FrameBuffer frame_buffer;
+        frame_buffer.frame_used = frame;
+        if (!create_frame_buffer(m_rhi_device->GetContextRhi(), m_render_pass, attachments, pipeline_state.GetWidth(), pipeline_state.GetHeight(), frame_buffer.resource))
+            return nullptr;
+
+        // Name the frame buffer
+        vulkan_utility::debug::set_name(static_cast<VkFramebuffer>(frame_buffer.resource), pipeline_state.render_target_swapchain ? "frame_buffer_swapchain" : "frame_buffer_texture");
 
-        // If this is a render texture, return the first buffer 
-        return m_frame_buffers[0];
+        m_frame_buffers[key] = frame_buffer;
+
+        return frame_buffer.resource;
     }
 
-    bool RHI_PipelineState::CreateFrameBuffer(const RHI_Device* rhi_device)
+    bool RHI_PipelineState::CreateRenderPass(const RHI_Device* rhi_device)
     {
         if (IsCompute())
             return true;
 
         m_rhi_device = rhi_device;
 
-        const uint32_t render_target_width  = GetWidth();
-        const uint32_t render_target_height = GetHeight();
-
         // Destroy existing frame resources
-        DestroyFrameBuffer();
+        DestroyRenderPass();
 
         // Create a render pass
         if (!create_render_pass(m_rhi_device->GetContextRhi(), depth_stencil_state, render_target_swapchain, render_target_color_textures, clear_color, render_target_depth_texture, clear_depth, clear_stencil, m_render_pass))
@@ -238,70 +299,23 @@ namespace Spartan
         string name = render_target_swapchain ? ("render_pass_swapchain_" + to_string(m_hash)) : ("render_pass_texture_" + to_string(m_hash));
         vulkan_utility::debug::set_name(static_cast<VkRenderPass>(m_render_pass), name.c_str());
 
-        // Create frame buffer
-        if (render_target_swapchain)
-        {
-            // Create one frame buffer per image
-            for (uint32_t i = 0; i < render_target_swapchain->GetBufferCount(); i++)
-            {
-                vector<void*> attachments = { render_target_swapchain->Get_Resource_View(i) };
-                if (!create_frame_buffer(m_rhi_device->GetContextRhi(), m_render_pass, attachments, render_target_width, render_target_height, m_frame_buffers[i]))
-                    return false;
-
-                // Name the frame buffer
-                vulkan_utility::debug::set_name(static_cast<VkFramebuffer>(m_frame_buffers[i]), "frame_bufer_swapchain");
-            }
-
-            return true;
-        }
-        else
-        {
-            vector<void*> attachments;
-            
-            // Color
-            for (uint32_t i = 0; i < rhi_max_render_target_count; i++)
-            {
-                if (RHI_Texture* texture = render_target_color_textures[i])
-                {
-                    attachments.emplace_back(texture->Get_Resource_View_RenderTarget(render_target_color_texture_array_index));
-                }
-            }
-            
-            // Depth
-            if (render_target_depth_texture)
-            {
-                attachments.emplace_back(render_target_depth_texture->Get_Resource_View_DepthStencil(render_target_depth_stencil_texture_array_index));
-            }
-
-            // Create a frame buffer
-            if (!create_frame_buffer(m_rhi_device->GetContextRhi(), m_render_pass, attachments, render_target_width, render_target_height, m_frame_buffers[0]))
-                return false;
-            
-            // Name the frame buffer
-            vulkan_utility::debug::set_name(static_cast<VkFramebuffer>(m_frame_buffers[0]), "frame_bufer_texture");
-            
-            return true;
-        }
-
         return true;
     }
 
-    void RHI_PipelineState::DestroyFrameBuffer()
+    void RHI_PipelineState::DestroyRenderPass()
     {
         if (!m_rhi_device)
             return;
 
-        // Wait in case the buffer is still in use by the graphics queue
+        // Wait in case the buffers are still in use by the graphics queue
         m_rhi_device->Queue_Wait(RHI_Queue_Graphics);
 
-        for (uint32_t i = 0; i < rhi_max_render_target_count; i++)
+        // Destroy frame buffers
+        for (const auto& it : m_frame_buffers)
         {
-            if (void* frame_buffer = m_frame_buffers[i])
-            {
-                vkDestroyFramebuffer(m_rhi_device->GetContextRhi()->device, static_cast<VkFramebuffer>(frame_buffer), nullptr);
-            }
+            vkDestroyFramebuffer(m_rhi_device->GetContextRhi()->device, static_cast<VkFramebuffer>(it.second.resource), nullptr);
         }
-        m_frame_buffers.fill(nullptr);
+        m_frame_buffers.clear();
 
         // Destroy render pass
         vkDestroyRenderPass(m_rhi_device->GetContextRhi()->device, static_cast<VkRenderPass>(m_render_pass), nullptr);
@@ -19,18 +19,21 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES ========================
+//= INCLUDES ==========================
 #include "Spartan.h"
 #include "../RHI_Implementation.h"
 #include "../RHI_Device.h"
 #include "../RHI_Shader.h"
 #include "../RHI_InputLayout.h"
+#include "../RHI_ShaderCache.h"
+#include "../../Core/Stopwatch.h"
+#include "../../Rendering/Renderer.h"
 SP_WARNINGS_OFF
 #include <spirv_cross/spirv_hlsl.hpp>
 #include <atlbase.h>
 #include <dxcapi.h>
 SP_WARNINGS_ON
-//===================================
+//=====================================
 
 //= NAMESPACES =====
 using namespace std;
@@ -257,6 +260,19 @@ namespace Spartan
             {
                 DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(&m_utils));
                 DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&m_compiler));;
+
+                // Get the version (it's part of the shader cache key, a different compiler can produce different bytecode)
+                CComPtr<IDxcVersionInfo2> version_info = nullptr;
+                if (m_compiler && SUCCEEDED(m_compiler->QueryInterface(IID_PPV_ARGS(&version_info))))
+                {
+                    uint32_t major = 0, minor = 0, commit_count = 0;
+                    char* commit_hash = nullptr;
+                    version_info->GetVersion(&major, &minor);
+                    version_info->GetCommitInfo(&commit_count, &commit_hash);
+
+                    m_version = to_string(major) + "." + to_string(minor) + "." + to_string(commit_count) + "-" + (commit_hash ? commit_hash : "");
+                    CoTaskMemFree(commit_hash);
+                }
             }
 
             CComPtr<IDxcBlob> Compile(const string& shader, vector<string>& arguments)
@@ -335,8 +351,11 @@ namespace Spartan
                 return blob_compiled;
             }
             
+            const string& GetVersion() const { return m_version; }
+
             CComPtr<IDxcUtils> m_utils          = nullptr;
             CComPtr<IDxcCompiler3> m_compiler   = nullptr;
+            string m_version                    = "unknown";
         };
 
         static Compiler& Instance()
@@ -390,52 +409,79 @@ namespace Spartan
             arguments.emplace_back("-D"); arguments.emplace_back("PS="+ to_string(static_cast<uint8_t>(m_shader_type == RHI_Shader_Pixel)));
             arguments.emplace_back("-D"); arguments.emplace_back("CS="+ to_string(static_cast<uint8_t>(m_shader_type == RHI_Shader_Compute)));
 
-            // Add the rest of the defines
-            for (const auto& define : m_defines)
+            // Add the rest of the defines (sorted, so that the shader cache key doesn't depend on the hash map's order)
+            for (const auto& define : map<string, string>(m_defines.begin(), m_defines.end()))
             {
                 arguments.emplace_back("-D"); arguments.emplace_back(define.first + "=" + define.second);
             }
         }
 
-        // Compile
-        if (CComPtr<IDxcBlob> shader_buffer = DxcHelper::Instance().Compile(shader, arguments))
+        Stopwatch stopwatch;
+
+        // Look the shader up in the cache, compile (and reflect) it only if it's not there
+        RHI_ShaderCache* shader_cache   = m_context ? m_context->GetSubsystem<Renderer>()->GetShaderCache() : nullptr;
+        const uint64_t cache_key        = shader_cache ? shader_cache->ComputeKey(shader, arguments, DxcHelper::Instance().GetVersion()) : 0;
+        vector<uint32_t> bytecode;
+        vector<RHI_Descriptor> descriptors;
+        const bool cache_hit = shader_cache && shader_cache->Load(cache_key, &bytecode, &descriptors);
+        if (cache_hit)
         {
-            // Create shader module
-            VkShaderModule shader_module            = nullptr;
-            VkShaderModuleCreateInfo create_info    = {};
-            create_info.sType                       = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-            create_info.codeSize                    = static_cast<size_t>(shader_buffer->GetBufferSize());
-            create_info.pCode                       = reinterpret_cast<const uint32_t*>(shader_buffer->GetBufferPointer());
-
-            if (!vulkan_utility::error::check(vkCreateShaderModule(m_rhi_device->GetContextRhi()->device, &create_info, nullptr, &shader_module)))
+            m_descriptors.insert(m_descriptors.end(), descriptors.begin(), descriptors.end());
+        }
+        else
+        {
+            // Compile
+            CComPtr<IDxcBlob> shader_buffer = DxcHelper::Instance().Compile(shader, arguments);
+            if (!shader_buffer)
             {
-                LOG_ERROR("Failed to create shader module.");
+                LOG_ERROR("Failed to compile %s", shader.c_str());
                 return nullptr;
             }
 
+            const uint32_t* ptr = reinterpret_cast<uint32_t*>(shader_buffer->GetBufferPointer());
+            bytecode.assign(ptr, ptr + shader_buffer->GetBufferSize() / 4);
+
             // Reflect shader resources (so that descriptor sets can be created later)
-            _Reflect
-            (
-                m_shader_type,
-                reinterpret_cast<uint32_t*>(shader_buffer->GetBufferPointer()),
-                static_cast<uint32_t>(shader_buffer->GetBufferSize() / 4)
-            );
-            
-            // Create input layout
-            if (m_vertex_type != RHI_Vertex_Type_Unknown)
+            const size_t descriptor_offset = m_descriptors.size();
+            _Reflect(m_shader_type, bytecode.data(), static_cast<uint32_t>(bytecode.size()));
+
+            // Cache
+            if (shader_cache)
             {
-                if (!m_input_layout->Create(m_vertex_type, nullptr))
-                {
-                    LOG_ERROR("Failed to create input layout for %s", FileSystem::GetFileNameFromFilePath(shader).c_str());
-                    return nullptr;
-                }
+                descriptors.assign(m_descriptors.begin() + descriptor_offset, m_descriptors.end());
+                shader_cache->Save(cache_key, bytecode, descriptors);
             }
-            
-            return static_cast<void*>(shader_module);
         }
 
-        LOG_ERROR("Failed to compile %s", shader.c_str());
-        return nullptr;
+        // Create shader module
+        VkShaderModule shader_module            = nullptr;
+        VkShaderModuleCreateInfo create_info    = {};
+        create_info.sType                       = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        create_info.codeSize                    = bytecode.size() * sizeof(uint32_t);
+        create_info.pCode                       = bytecode.data();
+
+        if (!vulkan_utility::error::check(vkCreateShaderModule(m_rhi_device->GetContextRhi()->device, &create_info, nullptr, &shader_module)))
+        {
+            LOG_ERROR("Failed to create shader module.");
+            return nullptr;
+        }
+
+        // Create input layout
+        if (m_vertex_type != RHI_Vertex_Type_Unknown)
+        {
+            if (!m_input_layout->Create(m_vertex_type, nullptr))
+            {
+                LOG_ERROR("Failed to create input layout for %s", FileSystem::GetFileNameFromFilePath(shader).c_str());
+                return nullptr;
+            }
+        }
+
+        if (shader_cache)
+        {
+            shader_cache->AddCompilation(cache_hit, stopwatch.GetElapsedTimeMs());
+        }
+
+        return static_cast<void*>(shader_module);
     }
 
     void RHI_Shader::_Reflect(const RHI_Shader_Type shader_type, const uint32_t* ptr, const uint32_t size)
@@ -446,9 +492,15 @@ namespace Spartan
         // The SPIR-V is now parsed, and we can perform reflection on it
         spirv_cross::ShaderResources resources = compiler.get_shader_resources();
 
+        // Resources in other sets (e.g. bindless textures) are bound through their own descriptor sets
+        auto is_in_first_set = [&compiler](const spirv_cross::Resource& resource) { return compiler.get_decoration(resource.id, spv::DecorationDescriptorSet) == 0; };
+
         // Get storage images
         for (const auto& resource : resources.storage_images)
         {
+            if (!is_in_first_set(resource))
+                continue;
+
             m_descriptors.emplace_back
             (
                 resource.name,                                                  // name
@@ -463,6 +515,9 @@ namespace Spartan
         // Get constant buffers
         for (const auto& resource : resources.uniform_buffers)
         {
+            if (!is_in_first_set(resource))
+                continue;
+
             m_descriptors.emplace_back
             (
                 resource.name,                                                  // name
@@ -477,6 +532,9 @@ namespace Spartan
         // Get textures
         for (const auto& resource : resources.separate_images)
         {
+            if (!is_in_first_set(resource))
+                continue;
+
             m_descriptors.emplace_back
             (
                 resource.name,                                                  // name
@@ -488,9 +546,29 @@ namespace Spartan
             );
         }
 
+        // Get structured buffers (read only buffers are bound to t registers, read/write buffers to u registers)
+        for (const auto& resource : resources.storage_buffers)
+        {
+            if (!is_in_first_set(resource))
+                continue;
+
+            m_descriptors.emplace_back
+            (
+                resource.name,                                                                      // name
+                RHI_Descriptor_Type::StructuredBuffer,                                              // type
+                compiler.get_decoration(resource.id, spv::DecorationBinding),                       // slot
+                shader_type,                                                                        // stage
+                !compiler.get_buffer_block_flags(resource.id).get(spv::DecorationNonWritable),      // is_storage
+                false                                                                               // is_dynamic_constant_buffer
+            );
+        }
+
         // Get samplers
         for (const auto& resource : resources.separate_samplers)
         {
+            if (!is_in_first_set(resource))
+                continue;
+
             m_descriptors.emplace_back
             (
                 resource.name,                                                  // name
@@ -0,0 +1,131 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES =======================
+#include "Spartan.h"
+#include "../RHI_Implementation.h"
+#include "../RHI_StructuredBuffer.h"
+#include "../RHI_UploadAllocator.h"
+#include "../RHI_Device.h"
+//==================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    RHI_StructuredBuffer::RHI_StructuredBuffer(const shared_ptr<RHI_Device>& rhi_device, const uint32_t stride, const uint32_t element_count, const string& name, RHI_UploadAllocator* upload_allocator /*= nullptr*/)
+    {
+        m_rhi_device        = rhi_device;
+        m_stride            = stride;
+        m_element_count     = element_count;
+        m_name              = name;
+        m_upload_allocator  = upload_allocator;
+        m_size_cpu          = static_cast<uint64_t>(m_stride) * m_element_count;
+        m_size_gpu          = m_size_cpu;
+
+        if (!_create())
+        {
+            LOG_ERROR("Failed to create %s buffer", m_name.c_str());
+        }
+    }
+
+    void RHI_StructuredBuffer::_destroy()
+    {
+        // Dynamic buffers point into the pages of the upload allocator, which owns them
+        if (IsDynamic())
+        {
+            m_buffer = nullptr;
+            return;
+        }
+
+        if (!m_buffer)
+            return;
+
+        // Destroy, once it's no longer in use by the GPU
+        m_rhi_device->DeletionQueue_Add(RHI_Resource_Type::Buffer, m_buffer);
+        m_buffer        = nullptr;
+        m_allocation    = nullptr;
+    }
+
+    bool RHI_StructuredBuffer::_create()
+    {
+        if (!m_rhi_device || !m_rhi_device->GetContextRhi()->device || m_size_gpu == 0)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return false;
+        }
+
+        // Dynamic buffers live in the pages of the upload allocator, they are acquired with every update
+        if (IsDynamic())
+            return true;
+
+        // Create buffer, it's written by compute shaders and transfers and read by shaders and indirect draws
+        VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        VmaAllocation allocation = vulkan_utility::buffer::create(m_buffer, m_size_gpu, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        if (!allocation)
+        {
+            LOG_ERROR("Failed to allocate buffer");
+            return false;
+        }
+
+        m_allocation    = static_cast<void*>(allocation);
+        m_offset        = 0;
+        m_range         = m_size_gpu;
+
+        // Set debug name
+        vulkan_utility::debug::set_name(static_cast<VkBuffer>(m_buffer), m_name.c_str());
+
+        return true;
+    }
+
+    bool RHI_StructuredBuffer::Update(const void* data, const uint32_t element_count)
+    {
+        if (!IsDynamic())
+        {
+            LOG_ERROR("%s can only be written by the GPU", m_name.c_str());
+            return false;
+        }
+
+        if (element_count == 0 || element_count > m_element_count)
+        {
+            LOG_ERROR("Can't update %d elements of %s, the capacity is %d elements", element_count, m_name.c_str(), m_element_count);
+            return false;
+        }
+
+        const uint64_t size = static_cast<uint64_t>(m_stride) * element_count;
+
+        RHI_UploadAllocation allocation;
+        if (!m_upload_allocator->Upload(data, size, allocation))
+        {
+            LOG_ERROR("Failed to upload %s buffer", m_name.c_str());
+            return false;
+        }
+
+        m_buffer    = allocation.buffer;
+        m_offset    = allocation.offset;
+        m_range     = size;
+
+        return true;
+    }
+}
@@ -19,17 +19,16 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES ========================
+//= INCLUDES =========================
 #include "Spartan.h"
 #include "../RHI_Implementation.h"
 #include "../RHI_Device.h"
 #include "../RHI_Texture2D.h"
 #include "../RHI_TextureCube.h"
 #include "../RHI_CommandList.h"
+#include "../RHI_UploadManager.h"
 #include "../../Profiling/Profiler.h"
-#include "../../Rendering/Renderer.h"
-#include "../RHI_DescriptorSetLayoutCache.h"
-//===================================
+//====================================
 
 //= NAMESPACES ===============
 using namespace std;
@@ -70,113 +69,6 @@ namespace Spartan
         }
     }
 
-    inline bool copy_to_staging_buffer(RHI_Texture* texture, std::vector<VkBufferImageCopy>& buffer_image_copies, void*& staging_buffer)
-    {
-        if (!texture->HasData())
-        {
-            LOG_WARNING("No data to stage");
-            return true;
-        }
-
-        const uint32_t width            = texture->GetWidth();
-        const uint32_t height           = texture->GetHeight();
-        const uint32_t array_size       = texture->GetArraySize();
-        const uint32_t mip_levels       = texture->GetMipCount();
-        const uint32_t bytes_per_pixel  = texture->GetBytesPerPixel();
-
-        // Fill out VkBufferImageCopy structs describing the array and the mip levels   
-        VkDeviceSize buffer_offset = 0;
-        for (uint32_t array_index = 0; array_index < array_size; array_index++)
-        {
-            for (uint32_t mip_index = 0; mip_index < mip_levels; mip_index++)
-            {
-                uint32_t mip_width  = width >> mip_index;
-                uint32_t mip_height = height >> mip_index;
-
-                VkBufferImageCopy region                = {};
-                region.bufferOffset                     = buffer_offset;
-                region.bufferRowLength                  = 0;
-                region.bufferImageHeight                = 0;
-                region.imageSubresource.aspectMask      = vulkan_utility::image::get_aspect_mask(texture);
-                region.imageSubresource.mipLevel        = mip_index;
-                region.imageSubresource.baseArrayLayer  = array_index;
-                region.imageSubresource.layerCount      = array_size;
-                region.imageOffset                      = { 0, 0, 0 };
-                region.imageExtent                      = { mip_width, mip_height, 1 };
-
-                buffer_image_copies[mip_index] = region;
-
-                // Update staging buffer memory requirement (in bytes)
-                buffer_offset += mip_width * mip_height * bytes_per_pixel;
-            }
-        }
-
-        // Create staging buffer
-        VmaAllocation allocation = vulkan_utility::buffer::create(staging_buffer, buffer_offset, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-        // Copy array and mip level data to the staging buffer
-        void* data = nullptr;
-        buffer_offset = 0;
-        if (vulkan_utility::error::check(vmaMapMemory(vulkan_utility::globals::rhi_context->allocator, allocation, &data)))
-        {
-            for (uint32_t array_index = 0; array_index < array_size; array_index++)
-            {
-                for (uint32_t mip_index = 0; mip_index < mip_levels; mip_index++)
-                {
-                    uint64_t buffer_size = (width >> mip_index) * (height >> mip_index) * bytes_per_pixel;
-                    memcpy(static_cast<std::byte*>(data) + buffer_offset, texture->GetMip(array_index + mip_index).data(), buffer_size);
-                    buffer_offset += buffer_size;
-                }
-            }
-
-            vmaUnmapMemory(vulkan_utility::globals::rhi_context->allocator, allocation);
-        }
-
-        return true;
-    }
-
-    inline bool stage(RHI_Texture* texture, RHI_Image_Layout& texture_layout)
-    {
-        // Copy the texture's data to a staging buffer
-        void* staging_buffer = nullptr;
-        std::vector<VkBufferImageCopy> buffer_image_copies(texture->GetMipCount());
-        if (!copy_to_staging_buffer(texture, buffer_image_copies, staging_buffer))
-            return false;
-
-        // Copy the staging buffer into the image
-        if (VkCommandBuffer cmd_buffer = vulkan_utility::command_buffer_immediate::begin(RHI_Queue_Graphics))
-        {
-            // Optimal layout for images which are the destination of a transfer format
-            RHI_Image_Layout layout = RHI_Image_Layout::Transfer_Dst_Optimal;
-
-            // Transition to layout
-            if (!vulkan_utility::image::set_layout(cmd_buffer, texture, layout))
-                return false;
-
-            // Copy the staging buffer to the image
-            vkCmdCopyBufferToImage(
-                cmd_buffer,
-                static_cast<VkBuffer>(staging_buffer),
-                static_cast<VkImage>(texture->Get_Resource()),
-                vulkan_image_layout[static_cast<uint8_t>(layout)],
-                static_cast<uint32_t>(buffer_image_copies.size()),
-                buffer_image_copies.data()
-            );
-
-            // End/flush
-            if (!vulkan_utility::command_buffer_immediate::end(RHI_Queue_Graphics))
-                return false;
-
-            // Free staging buffer
-            vulkan_utility::buffer::destroy(staging_buffer);
-
-            // Let the texture know about it's new layout
-            texture_layout = layout;
-        }
-
-        return true;
-    }
-
     inline RHI_Image_Layout GetAppropriateLayout(RHI_Texture* texture)
     {
         RHI_Image_Layout target_layout = RHI_Image_Layout::Preinitialized;
@@ -203,28 +95,15 @@ namespace Spartan
             LOG_ERROR("Invalid RHI Device.");
         }
 
-        // Wait in case it's still in use by the GPU
-        m_rhi_device->Queue_WaitAll();
-        
-        // Make sure that no descriptor sets refer to this texture.
-        // Right now I just reset the descriptor set layout cache, which works but it's not ideal.
-        // Todo: Get only the referring descriptor sets, and simply update the slot this texture is bound to.
-        if (Renderer* renderer = m_rhi_device->GetContext()->GetSubsystem<Renderer>())
-        {
-            if (RHI_DescriptorSetLayoutCache* descriptor_set_layout_cache = renderer->GetDescriptorLayoutSetCache())
-            {
-                descriptor_set_layout_cache->Reset();
-            }
-        }
-
-        // De-allocate everything
+        // De-allocate everything, the views and the image are destroyed once the GPU is no longer using them.
+        // This also means that their handles can't be reused before the descriptor sets which refer to them have been freed.
         m_data.clear();
-        vulkan_utility::image::view::destroy(m_resource_view[0]);
-        vulkan_utility::image::view::destroy(m_resource_view[1]);
+        m_rhi_device->DeletionQueue_Add(RHI_Resource_Type::ImageView, m_resource_view[0]);
+        m_rhi_device->DeletionQueue_Add(RHI_Resource_Type::ImageView, m_resource_view[1]);
         for (uint32_t i = 0; i < rhi_max_render_target_count; i++)
         {
-            vulkan_utility::image::view::destroy(m_resource_view_depthStencil[i]);
-            vulkan_utility::image::view::destroy(m_resource_view_renderTarget[i]);
+            m_rhi_device->DeletionQueue_Add(RHI_Resource_Type::ImageView, m_resource_view_depthStencil[i]);
+            m_rhi_device->DeletionQueue_Add(RHI_Resource_Type::ImageView, m_resource_view_renderTarget[i]);
         }
         vulkan_utility::image::destroy(this);
     }
@@ -241,7 +120,8 @@ namespace Spartan
          // If a command list is provided, this means we should insert a pipeline barrier
         if (command_list)
         {
-            if (!vulkan_utility::image::set_layout(static_cast<VkCommandBuffer>(command_list->GetResource_CommandBuffer()), this, new_layout))
+            const bool compute_queue = command_list->GetQueueType() == RHI_Queue_Compute;
+            if (!vulkan_utility::image::set_layout(static_cast<VkCommandBuffer>(command_list->GetResource_CommandBuffer()), this, new_layout, compute_queue))
                 return;
 
             m_context->GetSubsystem<Profiler>()->m_rhi_pipeline_barriers++;
@@ -259,22 +139,23 @@ namespace Spartan
             return false;
         }
 
-        // If the texture has any data, stage it
+        RHI_Image_Layout target_layout = GetAppropriateLayout(this);
+
+        // If the texture has any data, upload it via the transfer queue, which also transitions it to the target layout
         if (HasData())
         {
-            if (!stage(this, m_layout))
+            RHI_UploadManager* upload_manager = m_rhi_device->GetUploadManager();
+            if (!upload_manager || upload_manager->Upload(this, target_layout) == 0)
             {
-                LOG_ERROR("Failed to stage");
+                LOG_ERROR("Failed to upload");
                 return false;
             }
-        }
 
-        // Transition to target layout
-        if (VkCommandBuffer cmd_buffer = vulkan_utility::command_buffer_immediate::begin(RHI_Queue_Graphics))
-        {    
-            RHI_Image_Layout target_layout = GetAppropriateLayout(this);
-                
-            // Transition to the final layout
+            m_layout = target_layout;
+        }
+        // Otherwise transition to the target layout right away
+        else if (VkCommandBuffer cmd_buffer = vulkan_utility::command_buffer_immediate::begin(RHI_Queue_Graphics))
+        {
             if (!vulkan_utility::image::set_layout(cmd_buffer, this, target_layout))
             {
                 LOG_ERROR("Failed to transition layout");
@@ -346,15 +227,14 @@ namespace Spartan
         if (!m_rhi_device->IsInitialized())
             return;
 
-        m_rhi_device->Queue_WaitAll();
+        // The views and the image are destroyed once the GPU is no longer using them
         m_data.clear();
-
-        vulkan_utility::image::view::destroy(m_resource_view[0]);
-        vulkan_utility::image::view::destroy(m_resource_view[1]);
+        m_rhi_device->DeletionQueue_Add(RHI_Resource_Type::ImageView, m_resource_view[0]);
+        m_rhi_device->DeletionQueue_Add(RHI_Resource_Type::ImageView, m_resource_view[1]);
         for (uint32_t i = 0; i < rhi_max_render_target_count; i++)
         {
-            vulkan_utility::image::view::destroy(m_resource_view_depthStencil[i]);
-            vulkan_utility::image::view::destroy(m_resource_view_renderTarget[i]);
+            m_rhi_device->DeletionQueue_Add(RHI_Resource_Type::ImageView, m_resource_view_depthStencil[i]);
+            m_rhi_device->DeletionQueue_Add(RHI_Resource_Type::ImageView, m_resource_view_renderTarget[i]);
         }
         vulkan_utility::image::destroy(this);
     }
@@ -368,19 +248,20 @@ namespace Spartan
             return false;
         }
 
-        // If the texture has any data, stage it
+        RHI_Image_Layout target_layout = GetAppropriateLayout(this);
+
+        // If the texture has any data, upload it via the transfer queue, which also transitions it to the target layout
         if (HasData())
         {
-            if (!stage(this, m_layout))
+            RHI_UploadManager* upload_manager = m_rhi_device->GetUploadManager();
+            if (!upload_manager || upload_manager->Upload(this, target_layout) == 0)
                 return false;
-        }
 
-        // Transition to target layout
-        if (VkCommandBuffer cmd_buffer = vulkan_utility::command_buffer_immediate::begin(RHI_Queue_Graphics))
+            m_layout = target_layout;
+        }
+        // Otherwise transition to the target layout right away
+        else if (VkCommandBuffer cmd_buffer = vulkan_utility::command_buffer_immediate::begin(RHI_Queue_Graphics))
         {
-            RHI_Image_Layout target_layout = GetAppropriateLayout(this);
-
-            // Transition to the final layout
             if (!vulkan_utility::image::set_layout(cmd_buffer, this, target_layout))
                 return false;
 
@@ -0,0 +1,98 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =======================
+#include "Spartan.h"
+#include "../RHI_Implementation.h"
+#include "../RHI_UploadAllocator.h"
+#include "../RHI_Device.h"
+//==================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    bool RHI_UploadAllocator::CreatePage(Page* page)
+    {
+        VmaAllocator allocator = m_rhi_device->GetContextRhi()->allocator;
+
+        // Host coherent is preferred, so that writes don't have to be flushed (pages hold constant buffers as well as structured buffers)
+        const VkBufferUsageFlags usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        VmaAllocation allocation = vulkan_utility::buffer::create(page->buffer, m_page_size, usage, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, true);
+        if (!allocation)
+        {
+            LOG_ERROR("Failed to allocate buffer");
+            return false;
+        }
+        page->allocation = static_cast<void*>(allocation);
+
+        // Map persistently
+        if (!vulkan_utility::error::check(vmaMapMemory(allocator, allocation, reinterpret_cast<void**>(&page->mapped))))
+        {
+            LOG_ERROR("Failed to map memory");
+            vulkan_utility::buffer::destroy(page->buffer);
+            return false;
+        }
+
+        // Find out if flushing is needed
+        VmaAllocationInfo allocation_info;
+        vmaGetAllocationInfo(allocator, allocation, &allocation_info);
+        VkMemoryPropertyFlags memory_flags;
+        vmaGetMemoryTypeProperties(allocator, allocation_info.memoryType, &memory_flags);
+        page->coherent = (memory_flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+
+        // Set debug name
+        vulkan_utility::debug::set_name(static_cast<VkBuffer>(page->buffer), "upload_page");
+
+        return true;
+    }
+
+    void RHI_UploadAllocator::DestroyPage(Page* page)
+    {
+        if (page->mapped)
+        {
+            vmaUnmapMemory(m_rhi_device->GetContextRhi()->allocator, static_cast<VmaAllocation>(page->allocation));
+            page->mapped = nullptr;
+        }
+
+        vulkan_utility::buffer::destroy(page->buffer);
+        page->allocation = nullptr;
+    }
+
+    void RHI_UploadAllocator::FlushPage(Page* page, const uint64_t offset, const uint64_t size)
+    {
+        if (!vulkan_utility::error::check(vmaFlushAllocation(m_rhi_device->GetContextRhi()->allocator, static_cast<VmaAllocation>(page->allocation), offset, size)))
+        {
+            LOG_ERROR("Failed to flush memory");
+        }
+    }
+
+    uint32_t RHI_UploadAllocator::GetAlignmentRhi() const
+    {
+        // Offsets have to satisfy dynamic uniform buffer offsets, storage buffer offsets as well as flushing (for non-coherent memory)
+        const VkPhysicalDeviceLimits& limits = m_rhi_device->GetContextRhi()->device_properties.limits;
+        uint64_t alignment = Math::Helper::Max<uint64_t>(limits.minUniformBufferOffsetAlignment, limits.nonCoherentAtomSize);
+        alignment          = Math::Helper::Max<uint64_t>(alignment, limits.minStorageBufferOffsetAlignment);
+        return static_cast<uint32_t>(Math::Helper::Max<uint64_t>(alignment, 16));
+    }
+}
@@ -0,0 +1,220 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ======================
+#include "Spartan.h"
+#include "../RHI_Implementation.h"
+#include "../RHI_UploadManager.h"
+#include "../RHI_Device.h"
+#include "../RHI_Semaphore.h"
+#include "../RHI_Texture.h"
+//=================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    bool RHI_UploadManager::CreateRing()
+    {
+        // Staging memory is host coherent (VMA_MEMORY_USAGE_CPU_ONLY), so writes never have to be flushed
+        VmaAllocation allocation = vulkan_utility::buffer::create(m_ring_buffer, m_ring_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        if (!allocation)
+            return false;
+
+        m_ring_allocation = static_cast<void*>(allocation);
+
+        // Map persistently
+        if (!vulkan_utility::error::check(vmaMapMemory(m_rhi_device->GetContextRhi()->allocator, allocation, reinterpret_cast<void**>(&m_ring_mapped))))
+        {
+            vulkan_utility::buffer::destroy(m_ring_buffer);
+            m_ring_allocation = nullptr;
+            return false;
+        }
+
+        vulkan_utility::debug::set_name(static_cast<VkBuffer>(m_ring_buffer), "upload_ring");
+
+        return true;
+    }
+
+    void RHI_UploadManager::DestroyRing()
+    {
+        if (m_ring_mapped)
+        {
+            vmaUnmapMemory(m_rhi_device->GetContextRhi()->allocator, static_cast<VmaAllocation>(m_ring_allocation));
+            m_ring_mapped = nullptr;
+        }
+
+        vulkan_utility::buffer::destroy(m_ring_buffer);
+        m_ring_allocation = nullptr;
+    }
+
+    bool RHI_UploadManager::CreateStaging(const uint64_t size, Staging& staging)
+    {
+        VmaAllocation allocation = vulkan_utility::buffer::create(staging.buffer, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        if (!allocation)
+            return false;
+
+        // Stays mapped until the buffer is destroyed
+        if (!vulkan_utility::error::check(vmaMapMemory(m_rhi_device->GetContextRhi()->allocator, allocation, reinterpret_cast<void**>(&staging.mapped))))
+        {
+            vulkan_utility::buffer::destroy(staging.buffer);
+            return false;
+        }
+
+        staging.offset = 0;
+        vulkan_utility::debug::set_name(static_cast<VkBuffer>(staging.buffer), "upload_staging");
+
+        return true;
+    }
+
+    void RHI_UploadManager::DestroyStaging(void*& buffer)
+    {
+        if (VmaAllocation allocation = vulkan_utility::buffer::get_allocation(buffer))
+        {
+            vmaUnmapMemory(m_rhi_device->GetContextRhi()->allocator, allocation);
+        }
+
+        vulkan_utility::buffer::destroy(buffer);
+    }
+
+    bool RHI_UploadManager::CreateBatch(Batch* batch)
+    {
+        if (!vulkan_utility::command_pool::create(batch->cmd_pool, RHI_Queue_Transfer))
+            return false;
+
+        if (!vulkan_utility::command_buffer::create(batch->cmd_pool, batch->cmd_buffer, VK_COMMAND_BUFFER_LEVEL_PRIMARY))
+        {
+            vulkan_utility::command_pool::destroy(batch->cmd_pool);
+            return false;
+        }
+
+        vulkan_utility::debug::set_name(static_cast<VkCommandPool>(batch->cmd_pool), "upload_batch");
+        vulkan_utility::debug::set_name(static_cast<VkCommandBuffer>(batch->cmd_buffer), "upload_batch");
+
+        return true;
+    }
+
+    void RHI_UploadManager::DestroyBatch(Batch* batch)
+    {
+        if (!batch->cmd_pool)
+            return;
+
+        vulkan_utility::command_buffer::destroy(batch->cmd_pool, batch->cmd_buffer);
+        vulkan_utility::command_pool::destroy(batch->cmd_pool);
+        batch->cmd_buffer = nullptr;
+    }
+
+    bool RHI_UploadManager::BeginBatch(Batch* batch)
+    {
+        // The batch has completed (or was never used), so its command buffer can be recorded again
+        if (!vulkan_utility::error::check(vkResetCommandPool(m_rhi_device->GetContextRhi()->device, static_cast<VkCommandPool>(batch->cmd_pool), 0)))
+            return false;
+
+        VkCommandBufferBeginInfo begin_info = {};
+        begin_info.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        return vulkan_utility::error::check(vkBeginCommandBuffer(static_cast<VkCommandBuffer>(batch->cmd_buffer), &begin_info));
+    }
+
+    bool RHI_UploadManager::SubmitBatch(Batch* batch)
+    {
+        if (!vulkan_utility::error::check(vkEndCommandBuffer(static_cast<VkCommandBuffer>(batch->cmd_buffer))))
+            return false;
+
+        return m_rhi_device->Queue_Submit(RHI_Queue_Transfer, VK_PIPELINE_STAGE_TRANSFER_BIT, batch->cmd_buffer, nullptr, m_semaphore.get(), nullptr, batch->value);
+    }
+
+    void RHI_UploadManager::RecordCopy(Batch* batch, const Staging& staging, void* buffer, const uint64_t size)
+    {
+        VkBufferCopy copy_region    = {};
+        copy_region.srcOffset       = staging.offset;
+        copy_region.dstOffset       = 0;
+        copy_region.size            = size;
+
+        vkCmdCopyBuffer(static_cast<VkCommandBuffer>(batch->cmd_buffer), static_cast<VkBuffer>(staging.buffer), static_cast<VkBuffer>(buffer), 1, &copy_region);
+    }
+
+    void RHI_UploadManager::RecordCopy(Batch* batch, const Staging& staging, RHI_Texture* texture, const RHI_Image_Layout layout)
+    {
+        VkCommandBuffer cmd_buffer              = static_cast<VkCommandBuffer>(batch->cmd_buffer);
+        VkImage image                           = static_cast<VkImage>(texture->Get_Resource());
+        const VkImageAspectFlags aspect_mask    = vulkan_utility::image::get_aspect_mask(texture);
+        const uint32_t array_size               = texture->GetArraySize();
+        const uint32_t mip_count                = texture->GetMipCount();
+
+        // The image is created with concurrent sharing (when the transfer queue is a family of it's own), so no ownership transfers are needed
+        VkImageMemoryBarrier image_barrier              = {};
+        image_barrier.sType                             = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        image_barrier.srcQueueFamilyIndex               = VK_QUEUE_FAMILY_IGNORED;
+        image_barrier.dstQueueFamilyIndex               = VK_QUEUE_FAMILY_IGNORED;
+        image_barrier.image                             = image;
+        image_barrier.subresourceRange.aspectMask       = aspect_mask;
+        image_barrier.subresourceRange.baseMipLevel     = 0;
+        image_barrier.subresourceRange.levelCount       = mip_count;
+        image_barrier.subresourceRange.baseArrayLayer   = 0;
+        image_barrier.subresourceRange.layerCount       = array_size;
+
+        // Transition to transfer destination
+        image_barrier.oldLayout     = vulkan_image_layout[static_cast<uint8_t>(texture->GetLayout())];
+        image_barrier.newLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        image_barrier.srcAccessMask = 0;
+        image_barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(cmd_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &image_barrier);
+
+        // One region per array slice and mip, tightly packed (same as RHI_UploadManager::Upload())
+        vector<VkBufferImageCopy> regions;
+        regions.reserve(static_cast<size_t>(array_size) * mip_count);
+        VkDeviceSize offset = staging.offset;
+        for (uint32_t array_index = 0; array_index < array_size; array_index++)
+        {
+            for (uint32_t mip_index = 0; mip_index < mip_count; mip_index++)
+            {
+                const uint32_t mip_width  = Math::Helper::Max(texture->GetWidth() >> mip_index, 1u);
+                const uint32_t mip_height = Math::Helper::Max(texture->GetHeight() >> mip_index, 1u);
+
+                VkBufferImageCopy& region               = regions.emplace_back();
+                region.bufferOffset                     = offset;
+                region.bufferRowLength                  = 0;
+                region.bufferImageHeight                = 0;
+                region.imageSubresource.aspectMask      = aspect_mask;
+                region.imageSubresource.mipLevel        = mip_index;
+                region.imageSubresource.baseArrayLayer  = array_index;
+                region.imageSubresource.layerCount      = 1;
+                region.imageOffset                      = { 0, 0, 0 };
+                region.imageExtent                      = { mip_width, mip_height, 1 };
+
+                offset += static_cast<VkDeviceSize>(mip_width) * mip_height * texture->GetBytesPerPixel();
+            }
+        }
+        vkCmdCopyBufferToImage(cmd_buffer, static_cast<VkBuffer>(staging.buffer), image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
+
+        // Transition to the layout it will be used in, the queues which use it wait on the timeline semaphore, which makes the writes available
+        image_barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        image_barrier.newLayout     = vulkan_image_layout[static_cast<uint8_t>(layout)];
+        image_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        image_barrier.dstAccessMask = 0;
+        vkCmdPipelineBarrier(cmd_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &image_barrier);
+    }
+}
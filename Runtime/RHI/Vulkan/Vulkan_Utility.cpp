@@ -44,6 +44,34 @@ namespace Spartan::vulkan_utility
     mutex                                                                   command_buffer_immediate::m_mutex_end;
     unordered_map<RHI_Queue_Type, command_buffer_immediate::cmdbi_object>   command_buffer_immediate::m_objects;
 
+    // Resources which are written by the transfer queue, or used by the compute queue as well as the graphics queue, are shared concurrently instead
+    // of transferring ownership between queue families (which would need a release barrier on one queue and an acquire on the other)
+    static VkSharingMode get_sharing_mode(const bool written_by_transfer_queue, const bool used_by_compute_queue, vector<uint32_t>& queue_family_indices)
+    {
+        queue_family_indices.clear();
+
+        const auto add = [&queue_family_indices](const uint32_t index)
+        {
+            if (find(queue_family_indices.begin(), queue_family_indices.end(), index) == queue_family_indices.end())
+            {
+                queue_family_indices.emplace_back(index);
+            }
+        };
+
+        if (written_by_transfer_queue || used_by_compute_queue)
+        {
+            add(globals::rhi_context->queue_graphics_index);
+            add(globals::rhi_context->queue_compute_index);
+        }
+
+        if (written_by_transfer_queue)
+        {
+            add(globals::rhi_context->queue_transfer_index);
+        }
+
+        return queue_family_indices.size() > 1 ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+    }
+
     bool image::create(RHI_Texture* texture)
     {
         // Get format support
@@ -83,7 +111,13 @@ namespace Spartan::vulkan_utility
         create_info.initialLayout       = vulkan_image_layout[static_cast<uint8_t>(texture->GetLayout())];
         create_info.usage               = get_usage_flags(texture);
         create_info.samples             = VK_SAMPLE_COUNT_1_BIT;
-        create_info.sharingMode         = VK_SHARING_MODE_EXCLUSIVE;
+
+        // Textures with data are uploaded by the transfer queue, textures which async compute passes access are flagged as such.
+        // Everything else stays exclusive, concurrent sharing can disable compression of render targets on some hardware.
+        vector<uint32_t> queue_family_indices;
+        create_info.sharingMode             = get_sharing_mode(texture->HasData(), texture->IsAsyncCompute(), queue_family_indices);
+        create_info.queueFamilyIndexCount   = static_cast<uint32_t>(queue_family_indices.size());
+        create_info.pQueueFamilyIndices     = queue_family_indices.data();
 
         VmaAllocationCreateInfo allocation_info = {};
         allocation_info.usage                   = VMA_MEMORY_USAGE_GPU_ONLY;
@@ -96,24 +130,32 @@ namespace Spartan::vulkan_utility
 
         texture->Set_Resource(resource);
 
-        // Keep allocation reference
-        globals::rhi_context->allocations[texture->GetId()] = allocation;
+        // Keep allocation reference (keyed by the image, so that the image can outlive the texture in the deletion queue)
+        lock_guard<mutex> lock(globals::rhi_context->allocations_mutex);
+        globals::rhi_context->allocations[reinterpret_cast<uint64_t>(resource)] = allocation;
 
         return true;
     }
 
     void image::destroy(RHI_Texture* texture)
     {
-        void* resource          = texture->Get_Resource();
-        uint64_t allocation_id  = texture->GetId();
+        // The GPU might still be using the image, so the deletion queue will destroy it
+        globals::rhi_device->DeletionQueue_Add(RHI_Resource_Type::Image, texture->Get_Resource());
+        texture->Set_Resource(nullptr);
+    }
 
-        auto it = globals::rhi_context->allocations.find(allocation_id);
+    void image::destroy(void*& image)
+    {
+        if (!image)
+            return;
+
+        lock_guard<mutex> lock(globals::rhi_context->allocations_mutex);
+        auto it = globals::rhi_context->allocations.find(reinterpret_cast<uint64_t>(image));
         if (it != globals::rhi_context->allocations.end())
         {
-            VmaAllocation allocation = it->second;
-            vmaDestroyImage(globals::rhi_context->allocator, static_cast<VkImage>(resource), allocation);
-            globals::rhi_context->allocations.erase(allocation_id);
-            texture->Set_Resource(nullptr);
+            vmaDestroyImage(globals::rhi_context->allocator, static_cast<VkImage>(image), it->second);
+            globals::rhi_context->allocations.erase(it);
+            image = nullptr;
         }
     }
 
@@ -125,7 +167,13 @@ namespace Spartan::vulkan_utility
         buffer_create_info.sType                = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
         buffer_create_info.size                 = size;
         buffer_create_info.usage                = usage;
-        buffer_create_info.sharingMode          = VK_SHARING_MODE_EXCLUSIVE;
+
+        // Buffers which are copied to are uploaded by the transfer queue, constant and storage buffers can be used by async compute passes
+        vector<uint32_t> queue_family_indices;
+        const bool used_by_compute_queue            = (usage & (VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)) != 0;
+        buffer_create_info.sharingMode              = get_sharing_mode((usage & VK_BUFFER_USAGE_TRANSFER_DST_BIT) != 0, used_by_compute_queue, queue_family_indices);
+        buffer_create_info.queueFamilyIndexCount    = static_cast<uint32_t>(queue_family_indices.size());
+        buffer_create_info.pQueueFamilyIndices      = queue_family_indices.data();
 
         bool used_for_staging = (usage & VK_BUFFER_USAGE_TRANSFER_SRC_BIT) != 0;
 
@@ -140,7 +188,10 @@ namespace Spartan::vulkan_utility
             return false;
 
         // Keep allocation reference
-        globals::rhi_context->allocations[reinterpret_cast<uint64_t>(_buffer)] = allocation;
+        {
+            lock_guard<mutex> lock(globals::rhi_context->allocations_mutex);
+            globals::rhi_context->allocations[reinterpret_cast<uint64_t>(_buffer)] = allocation;
+        }
 
         // If a pointer to the buffer data has been passed, map the buffer and copy over the data
         if (data != nullptr)
@@ -192,6 +243,7 @@ namespace Spartan::vulkan_utility
         if (!_buffer)
             return;
 
+        lock_guard<mutex> lock(globals::rhi_context->allocations_mutex);
         uint64_t allocation_id = reinterpret_cast<uint64_t>(_buffer);
         auto it = globals::rhi_context->allocations.find(allocation_id);
         if (it != globals::rhi_context->allocations.end())
@@ -202,4 +254,11 @@ namespace Spartan::vulkan_utility
             _buffer = nullptr;
         }
     }
+
+    VmaAllocation buffer::get_allocation(void* _buffer)
+    {
+        lock_guard<mutex> lock(globals::rhi_context->allocations_mutex);
+        auto it = globals::rhi_context->allocations.find(reinterpret_cast<uint64_t>(_buffer));
+        return it != globals::rhi_context->allocations.end() ? it->second : nullptr;
+    }
 }
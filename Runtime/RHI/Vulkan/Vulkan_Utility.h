@@ -479,6 +479,7 @@ namespace Spartan::vulkan_utility
     {
         VmaAllocation create(void*& _buffer, const uint64_t size, VkBufferUsageFlags usage, VkMemoryPropertyFlags memory_property_flags, const bool written_frequently = false, const void* data = nullptr);
         void destroy(void*& _buffer);
+        VmaAllocation get_allocation(void* _buffer);
     }
 
     namespace image
@@ -516,9 +517,10 @@ namespace Spartan::vulkan_utility
                 flags |= VK_IMAGE_USAGE_TRANSFER_DST_BIT; // destination of a transfer command.
             }
 
-            // If the texture is a render target, it's possible that it can be cleared
-            if (texture->IsRenderTarget())
+            // If the texture is a render target, it's possible that it can be cleared or copied
+            if (texture->IsRenderTarget() || texture->IsDepthStencil())
             {
+                flags |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
                 flags |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
             }
 
@@ -557,8 +559,12 @@ namespace Spartan::vulkan_utility
 
         bool create(RHI_Texture* texture);
 
+        // Defers to the deletion queue
         void destroy(RHI_Texture* texture);
 
+        // Immediate, the image must no longer be in use by the GPU
+        void destroy(void*& image);
+
         inline VkPipelineStageFlags access_flags_to_pipeline_stage(VkAccessFlags access_flags, const VkPipelineStageFlags enabled_graphics_shader_stages)
         {
             VkPipelineStageFlags stages = 0;
@@ -717,7 +723,21 @@ namespace Spartan::vulkan_utility
             return access_mask;
         }
 
-        inline bool set_layout(void* cmd_buffer, void* image, const VkImageAspectFlags aspect_mask, const uint32_t level_count, const uint32_t layer_count, const RHI_Image_Layout layout_old, const RHI_Image_Layout layout_new)
+        // On the compute queue, only the compute and transfer stages exist. Whatever another queue did to the image before has already
+        // been made visible by the semaphore which the compute queue waited for, so the remaining stages are dropped from the barrier.
+        inline void clamp_to_compute_queue(VkPipelineStageFlags& stages, VkAccessFlags& access_mask, const VkPipelineStageFlags stages_fallback)
+        {
+            stages      &= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+            access_mask &= VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+
+            if (stages == 0)
+            {
+                stages      = stages_fallback;
+                access_mask = 0;
+            }
+        }
+
+        inline bool set_layout(void* cmd_buffer, void* image, const VkImageAspectFlags aspect_mask, const uint32_t level_count, const uint32_t layer_count, const RHI_Image_Layout layout_old, const RHI_Image_Layout layout_new, const bool compute_queue = false)
         {
             VkImageMemoryBarrier image_barrier              = {};
             image_barrier.sType                             = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -767,6 +787,12 @@ namespace Spartan::vulkan_utility
                 }
             }
 
+            if (compute_queue)
+            {
+                clamp_to_compute_queue(source_stage, image_barrier.srcAccessMask, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+                clamp_to_compute_queue(destination_stage, image_barrier.dstAccessMask, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+            }
+
             vkCmdPipelineBarrier
             (
                 static_cast<VkCommandBuffer>(cmd_buffer),
@@ -780,9 +806,9 @@ namespace Spartan::vulkan_utility
             return true;
         }
 
-        inline bool set_layout(void* cmd_buffer, const RHI_Texture* texture, const RHI_Image_Layout layout_new)
+        inline bool set_layout(void* cmd_buffer, const RHI_Texture* texture, const RHI_Image_Layout layout_new, const bool compute_queue = false)
         {
-            return set_layout(cmd_buffer, texture->Get_Resource(), get_aspect_mask(texture), texture->GetMipCount(), texture->GetArraySize(), texture->GetLayout(), layout_new);
+            return set_layout(cmd_buffer, texture->Get_Resource(), get_aspect_mask(texture), texture->GetMipCount(), texture->GetArraySize(), texture->GetLayout(), layout_new, compute_queue);
         }
 
         namespace view
@@ -1323,6 +1349,9 @@ namespace Spartan::vulkan_utility
         if (descriptor.type == RHI_Descriptor_Type::Sampler)
             return VK_DESCRIPTOR_TYPE_SAMPLER;
 
+        if (descriptor.type == RHI_Descriptor_Type::StructuredBuffer)
+            return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
         LOG_ERROR("Invalid descriptor type");
         return VK_DESCRIPTOR_TYPE_MAX_ENUM;
     }
@@ -26,6 +26,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI_VertexBuffer.h"
 #include "../RHI_Vertex.h"
 #include "../RHI_CommandList.h"
+#include "../RHI_UploadManager.h"
 //================================
 
 //= NAMESPACES =====
@@ -36,9 +37,6 @@ namespace Spartan
 {
     void RHI_VertexBuffer::_destroy()
     {
-        // Wait in case it's still in use by the GPU
-        m_rhi_device->Queue_WaitAll();
-
         // Unmap
         if (m_mapped)
         {
@@ -46,8 +44,9 @@ namespace Spartan
             m_mapped = nullptr;
         }
 
-        // Destroy
-        vulkan_utility::buffer::destroy(m_buffer);
+        // Destroy, once it's no longer in use by the GPU
+        m_rhi_device->DeletionQueue_Add(RHI_Resource_Type::Buffer, m_buffer);
+        m_buffer = nullptr;
     }
 
     bool RHI_VertexBuffer::_create(const void* vertices)
@@ -82,37 +81,15 @@ namespace Spartan
         {
             // The reason we use staging is because memory with VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT is not mappable but it's fast, we want that.
 
-            // Create staging/source buffer and copy the vertices to it
-            void* staging_buffer = nullptr;
-            VmaAllocation allocation_staging = vulkan_utility::buffer::create(staging_buffer, m_size_gpu, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, false, vertices);
-            if (!allocation_staging)
-                return false;
-
             // Create destination buffer
-            VmaAllocation allocation = vulkan_utility::buffer::create(m_buffer, m_size_gpu, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, nullptr);
+            VmaAllocation allocation = vulkan_utility::buffer::create(m_buffer, m_size_gpu, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
             if (!allocation)
                 return false;
 
-            // Copy staging buffer to destination buffer
-            {
-                // Create command buffer
-                VkCommandBuffer cmd_buffer = vulkan_utility::command_buffer_immediate::begin(RHI_Queue_Transfer);
-
-                VkBuffer* buffer_vk         = reinterpret_cast<VkBuffer*>(&m_buffer);
-                VkBuffer* buffer_staging_vk = reinterpret_cast<VkBuffer*>(&staging_buffer);
-
-                // Copy
-                VkBufferCopy copy_region = {};
-                copy_region.size         = m_size_gpu;
-                vkCmdCopyBuffer(cmd_buffer, *buffer_staging_vk, *buffer_vk, 1, &copy_region);
-
-                // Flush and free command buffer
-                if (!vulkan_utility::command_buffer_immediate::end(RHI_Queue_Transfer))
-                    return false;
-
-                // Destroy staging resources
-                vulkan_utility::buffer::destroy(staging_buffer);
-            }
+            // Copy the vertices via the transfer queue, the queues which use the buffer wait for the copy on their own
+            RHI_UploadManager* upload_manager = m_rhi_device->GetUploadManager();
+            if (!upload_manager || upload_manager->Upload(m_buffer, vertices, m_size_gpu) == 0)
+                return false;
 
             m_allocation    = static_cast<void*>(allocation);
             m_is_mappable   = false;
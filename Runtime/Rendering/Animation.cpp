@@ -19,17 +19,90 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES =========
+//= INCLUDES =================
 #include "Spartan.h"
 #include "Animation.h"
-//====================
+#include "Skinning.h"
+#include "../IO/FileStream.h"
+//============================
 
-//= NAMESPACES =====
+//= NAMESPACES ================
 using namespace std;
-//==================
+using namespace Spartan::Math;
+//=============================
 
 namespace Spartan
 {
+    namespace
+    {
+        void measure_compression(const Animation& animation, const AnimationCompression::Clip& clip, AnimationCompression::Report* report)
+        {
+            uint32_t bone_count = 0;
+            for (const AnimationNode& channel : animation.GetChannels())
+            {
+                bone_count = Helper::Max(bone_count, static_cast<uint32_t>(channel.bone + 1));
+            }
+
+            // Round trip error, at every source key and halfway to the next one
+            vector<Skinning::BoneTransform> pose(bone_count);
+            vector<Skinning::BoneTransform> pose_compressed(bone_count);
+            AnimationCompression::Cursor cursor;
+            vector<double> times;
+            for (const AnimationNode& channel : animation.GetChannels())
+            {
+                for (const KeyVector& key : channel.positionFrames)    times.emplace_back(key.time);
+                for (const KeyQuaternion& key : channel.rotationFrames) times.emplace_back(key.time);
+                for (const KeyVector& key : channel.scaleFrames)       times.emplace_back(key.time);
+            }
+            sort(times.begin(), times.end());
+            times.erase(unique(times.begin(), times.end()), times.end());
+
+            const double seconds_per_tick = animation.GetTicksPerSec() > 0.0 ? 1.0 / animation.GetTicksPerSec() : 1.0;
+            for (uint32_t i = 0; i < static_cast<uint32_t>(times.size()); i++)
+            {
+                for (uint32_t half = 0; half < 2; half++)
+                {
+                    if (half == 1 && i + 1 == times.size())
+                        continue;
+
+                    const double time_sec = (half == 0 ? times[i] : (times[i] + times[i + 1]) * 0.5) * seconds_per_tick;
+                    Skinning::sample(animation, time_sec, pose.data(), bone_count);
+                    AnimationCompression::sample(clip, &cursor, static_cast<float>(time_sec), pose_compressed.data(), bone_count);
+
+                    for (uint32_t bone = 0; bone < bone_count; bone++)
+                    {
+                        const Skinning::BoneTransform& a = pose[bone];
+                        const Skinning::BoneTransform& b = pose_compressed[bone];
+                        const float dot                  = Helper::Min(Helper::Abs(a.rotation.x * b.rotation.x + a.rotation.y * b.rotation.y + a.rotation.z * b.rotation.z + a.rotation.w * b.rotation.w), 1.0f);
+
+                        report->error_position = Helper::Max(report->error_position, (a.position - b.position).Length());
+                        report->error_rotation = Helper::Max(report->error_rotation, 2.0f * acos(dot) * Helper::RAD_TO_DEG);
+                        report->error_scale    = Helper::Max(report->error_scale, (a.scale - b.scale).Length());
+                    }
+                }
+            }
+
+            // Sampling throughput, playing forward at 60 Hz (over a few loops if the clip is short)
+            const double duration_sec   = animation.GetDurationSec();
+            const uint32_t pose_count   = Helper::Max(static_cast<uint32_t>(duration_sec * 60.0), 1000u);
+            auto time_at                = [duration_sec](const uint32_t index) { return duration_sec > 0.0 ? fmod(index / 60.0, duration_sec) : 0.0; };
+
+            Stopwatch stopwatch;
+            for (uint32_t i = 0; i < pose_count; i++)
+            {
+                Skinning::sample(animation, time_at(i), pose.data(), bone_count);
+            }
+            report->poses_per_ms_before = pose_count / Helper::Max(static_cast<float>(stopwatch.GetElapsedTimeMs()), Helper::EPSILON);
+
+            stopwatch.Start();
+            for (uint32_t i = 0; i < pose_count; i++)
+            {
+                AnimationCompression::sample(clip, &cursor, static_cast<float>(time_at(i)), pose_compressed.data(), bone_count);
+            }
+            report->poses_per_ms_after = pose_count / Helper::Max(static_cast<float>(stopwatch.GetElapsedTimeMs()), Helper::EPSILON);
+        }
+    }
+
     Animation::Animation(Context* context): IResource(context, ResourceType::Animation)
     {
 
@@ -37,11 +110,140 @@ namespace Spartan
 
     bool Animation::LoadFromFile(const string& filePath)
     {
+        auto file = make_unique<FileStream>(filePath, FileStream_Read);
+        if (!file->IsOpen())
+            return false;
+
+        Deserialize(file.get());
+
         return true;
     }
 
     bool Animation::SaveToFile(const string& filePath)
     {
+        auto file = make_unique<FileStream>(filePath, FileStream_Write);
+        if (!file->IsOpen())
+            return false;
+
+        Serialize(file.get());
+        file->Close();
+
         return true;
     }
+
+    template<typename T>
+    static void write_keys(FileStream* stream, const vector<T>& keys)
+    {
+        stream->Write(static_cast<uint32_t>(keys.size()));
+        for (const T& key : keys)
+        {
+            stream->Write(key.time);
+            stream->Write(key.value);
+        }
+    }
+
+    template<typename T>
+    static void read_keys(FileStream* stream, vector<T>* keys)
+    {
+        keys->resize(stream->ReadAs<uint32_t>());
+        for (T& key : *keys)
+        {
+            stream->Read(&key.time);
+            stream->Read(&key.value);
+        }
+    }
+
+    void Animation::Serialize(FileStream* stream) const
+    {
+        stream->Write(m_name);
+        stream->Write(m_duration);
+        stream->Write(m_ticksPerSec);
+
+        stream->Write(static_cast<uint32_t>(m_channels.size()));
+        for (const AnimationNode& channel : m_channels)
+        {
+            stream->Write(channel.name);
+            stream->Write(channel.bone);
+            write_keys(stream, channel.positionFrames);
+            write_keys(stream, channel.rotationFrames);
+            write_keys(stream, channel.scaleFrames);
+        }
+
+        stream->Write(static_cast<uint32_t>(m_clip.tracks.size()));
+        for (const AnimationCompression::Track& track : m_clip.tracks)
+        {
+            stream->Write(track.bone);
+            stream->Write(static_cast<uint16_t>(track.type));
+            stream->Write(track.key_count);
+            stream->Write(track.range_min);
+            stream->Write(track.range_extent);
+        }
+
+        // Keys are plain data
+        vector<std::byte> keys(m_clip.keys.size() * sizeof(AnimationCompression::Key));
+        memcpy(keys.data(), m_clip.keys.data(), keys.size());
+        stream->Write(keys);
+    }
+
+    void Animation::Deserialize(FileStream* stream)
+    {
+        stream->Read(&m_name);
+        stream->Read(&m_duration);
+        stream->Read(&m_ticksPerSec);
+
+        m_channels.resize(stream->ReadAs<uint32_t>());
+        for (AnimationNode& channel : m_channels)
+        {
+            stream->Read(&channel.name);
+            stream->Read(&channel.bone);
+            read_keys(stream, &channel.positionFrames);
+            read_keys(stream, &channel.rotationFrames);
+            read_keys(stream, &channel.scaleFrames);
+        }
+
+        m_clip.tracks.resize(stream->ReadAs<uint32_t>());
+        for (AnimationCompression::Track& track : m_clip.tracks)
+        {
+            stream->Read(&track.bone);
+            track.type = static_cast<AnimationCompression::TrackType>(stream->ReadAs<uint16_t>());
+            stream->Read(&track.key_count);
+            stream->Read(&track.range_min);
+            stream->Read(&track.range_extent);
+        }
+
+        vector<std::byte> keys;
+        stream->Read(&keys);
+        m_clip.keys.resize(keys.size() / sizeof(AnimationCompression::Key));
+        memcpy(m_clip.keys.data(), keys.data(), m_clip.keys.size() * sizeof(AnimationCompression::Key));
+    }
+
+    void Animation::Compress(const AnimationCompression::Settings& settings, AnimationCompression::Report* report /*= nullptr*/)
+    {
+        if (m_channels.empty())
+            return;
+
+        AnimationCompression::compress(m_channels, m_ticksPerSec, settings, &m_clip);
+
+        if (report)
+        {
+            *report = AnimationCompression::Report();
+            report->size_after      = m_clip.GetSize();
+            report->key_count_after = static_cast<uint32_t>(m_clip.keys.size());
+
+            for (const AnimationNode& channel : m_channels)
+            {
+                report->key_count_before    += static_cast<uint32_t>(channel.positionFrames.size() + channel.rotationFrames.size() + channel.scaleFrames.size());
+                report->size_before         += static_cast<uint32_t>((channel.positionFrames.size() + channel.scaleFrames.size()) * sizeof(KeyVector) + channel.rotationFrames.size() * sizeof(KeyQuaternion));
+            }
+
+            // Comparing against the source needs the channels, so it can only happen before they are dropped
+            if (settings.measure)
+            {
+                measure_compression(*this, m_clip, report);
+            }
+        }
+
+        m_channels.clear();
+        m_channels.shrink_to_fit();
+    }
 }
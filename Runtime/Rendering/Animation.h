@@ -21,25 +21,15 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES =====================
+//= INCLUDES ======================
 #include "../Resource/IResource.h"
 #include "../Math/Matrix.h"
-//================================
+#include "AnimationCompression.h"
+//=================================
 
 namespace Spartan
 {
-    struct AnimationVertexWeight
-    {
-        uint32_t vertexID;
-        float weight;
-    };
-
-    struct AnimationBone
-    {
-        std::string name;
-        std::vector<AnimationVertexWeight> vertexWeights;
-        Math::Matrix offset;
-    };
+    class FileStream;
 
     struct KeyVector
     {
@@ -56,6 +46,7 @@ namespace Spartan
     struct AnimationNode
     {
         std::string name;
+        int32_t bone = -1; // the skeleton bone the channel animates
         std::vector<KeyVector> positionFrames;
         std::vector<KeyQuaternion> rotationFrames;
         std::vector<KeyVector> scaleFrames;
@@ -75,6 +66,22 @@ namespace Spartan
         void SetName(const std::string& name)   { m_name = name; }
         void SetDuration(double duration)       { m_duration = duration; }
         void SetTicksPerSec(double ticksPerSec) { m_ticksPerSec = ticksPerSec; }
+        const std::string& GetName()    const   { return m_name; }
+        double GetDuration()            const   { return m_duration; }
+        double GetTicksPerSec()         const   { return m_ticksPerSec; }
+        double GetDurationSec()         const   { return m_ticksPerSec > 0.0 ? m_duration / m_ticksPerSec : 0.0; }
+
+        // Channels
+        void AddChannel(const AnimationNode& channel)   { m_channels.emplace_back(channel); }
+        const auto& GetChannels()               const   { return m_channels; }
+
+        // Replaces the channels with a compressed clip, the report (optional) has the size, and the round trip error if the settings ask to measure it
+        void Compress(const AnimationCompression::Settings& settings, AnimationCompression::Report* report = nullptr);
+        bool IsCompressed()                                 const { return !m_clip.IsEmpty(); }
+        const AnimationCompression::Clip& GetClip()         const { return m_clip; }
+
+        void Serialize(FileStream* stream) const;
+        void Deserialize(FileStream* stream);
 
     private:
         std::string m_name;
@@ -83,5 +90,6 @@ namespace Spartan
 
         // Each channel controls a single node
         std::vector<AnimationNode> m_channels;
+        AnimationCompression::Clip m_clip;
     };
 }
@@ -0,0 +1,388 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =====================
+#include "Spartan.h"
+#include "AnimationCompression.h"
+#include "Animation.h"
+#include "Skinning.h"
+//================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan::AnimationCompression
+{
+    // Longest run of keys a single interpolation is checked against, it bounds the reduction to linear time
+    static const uint32_t key_span_max = 256;
+
+    // Smallest-three components are within [-1/sqrt(2), 1/sqrt(2)]
+    static const float smallest_three_range = 0.70710678f;
+
+    struct SourceKey
+    {
+        float time;
+        float value[4];
+    };
+
+    static float key_fraction(const float time, const float time_a, const float time_b)
+    {
+        return time_b > time_a ? Helper::Saturate((time - time_a) / (time_b - time_a)) : 0.0f;
+    }
+
+    static void interpolate(const TrackType type, const float* a, const float* b, const float fraction, float* result)
+    {
+        if (type == TrackType::Rotation)
+        {
+            const Quaternion q = Skinning::nlerp(Quaternion(a[0], a[1], a[2], a[3]), Quaternion(b[0], b[1], b[2], b[3]), fraction);
+            result[0] = q.x; result[1] = q.y; result[2] = q.z; result[3] = q.w;
+            return;
+        }
+
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            result[i] = a[i] + (b[i] - a[i]) * fraction;
+        }
+        result[3] = 0.0f;
+    }
+
+    static float distance(const TrackType type, const float* a, const float* b)
+    {
+        // q and -q are the same rotation
+        float sign = 1.0f;
+        if (type == TrackType::Rotation && a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3] < 0.0f)
+        {
+            sign = -1.0f;
+        }
+
+        float result = 0.0f;
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            result = Helper::Max(result, Helper::Abs(a[i] - b[i] * sign));
+        }
+        return result;
+    }
+
+    // Indices of the keys that have to be kept for every removed key to be within the error of the interpolation
+    static vector<uint32_t> reduce(const TrackType type, const vector<SourceKey>& keys, const float error)
+    {
+        const uint32_t key_count = static_cast<uint32_t>(keys.size());
+
+        // Constant tracks only need one key
+        bool is_constant = true;
+        for (uint32_t i = 1; i < key_count && is_constant; i++)
+        {
+            is_constant = distance(type, keys[0].value, keys[i].value) <= error;
+        }
+        if (is_constant)
+            return { 0 };
+
+        auto is_within_error = [type, &keys, error](const uint32_t start, const uint32_t end)
+        {
+            float value[4];
+            for (uint32_t i = start + 1; i < end; i++)
+            {
+                interpolate(type, keys[start].value, keys[end].value, key_fraction(keys[i].time, keys[start].time, keys[end].time), value);
+                if (distance(type, value, keys[i].value) > error)
+                    return false;
+            }
+            return true;
+        };
+
+        vector<uint32_t> kept = { 0 };
+        uint32_t start = 0;
+        while (start + 1 < key_count)
+        {
+            uint32_t end = start + 1;
+            while (end + 1 < key_count && end + 1 - start <= key_span_max && is_within_error(start, end + 1))
+            {
+                end++;
+            }
+
+            kept.emplace_back(end);
+            start = end;
+        }
+
+        return kept;
+    }
+
+    static uint16_t quantize_unorm16(const float value)
+    {
+        return static_cast<uint16_t>(Helper::Saturate(value) * 65535.0f + 0.5f);
+    }
+
+    static void encode(const Track& track, const float* value, uint16_t* encoded)
+    {
+        if (track.type != TrackType::Rotation)
+        {
+            encoded[0] = quantize_unorm16(track.range_extent.x > 0.0f ? (value[0] - track.range_min.x) / track.range_extent.x : 0.0f);
+            encoded[1] = quantize_unorm16(track.range_extent.y > 0.0f ? (value[1] - track.range_min.y) / track.range_extent.y : 0.0f);
+            encoded[2] = quantize_unorm16(track.range_extent.z > 0.0f ? (value[2] - track.range_min.z) / track.range_extent.z : 0.0f);
+            return;
+        }
+
+        // Smallest-three, the largest component is dropped (and made positive) as it follows from the others.
+        // Its index takes 2 bits and the other components 15 bits each, 47 of the 48 bits.
+        uint32_t largest = 0;
+        for (uint32_t i = 1; i < 4; i++)
+        {
+            if (Helper::Abs(value[i]) > Helper::Abs(value[largest]))
+            {
+                largest = i;
+            }
+        }
+        const float sign = value[largest] < 0.0f ? -1.0f : 1.0f;
+
+        uint64_t bits  = static_cast<uint64_t>(largest) << 45;
+        uint32_t shift = 30;
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            if (i == largest)
+                continue;
+
+            const float normalized  = (value[i] * sign / smallest_three_range) * 0.5f + 0.5f;
+            const uint64_t quantized = static_cast<uint64_t>(Helper::Saturate(normalized) * 32767.0f + 0.5f);
+            bits                    |= quantized << shift;
+            shift                   -= 15;
+        }
+
+        encoded[0] = static_cast<uint16_t>(bits);
+        encoded[1] = static_cast<uint16_t>(bits >> 16);
+        encoded[2] = static_cast<uint16_t>(bits >> 32);
+    }
+
+    static void decode(const Track& track, const uint16_t* encoded, float* value)
+    {
+        if (track.type != TrackType::Rotation)
+        {
+            value[0] = track.range_min.x + track.range_extent.x * (encoded[0] / 65535.0f);
+            value[1] = track.range_min.y + track.range_extent.y * (encoded[1] / 65535.0f);
+            value[2] = track.range_min.z + track.range_extent.z * (encoded[2] / 65535.0f);
+            value[3] = 0.0f;
+            return;
+        }
+
+        const uint64_t bits     = static_cast<uint64_t>(encoded[0]) | (static_cast<uint64_t>(encoded[1]) << 16) | (static_cast<uint64_t>(encoded[2]) << 32);
+        const uint32_t largest  = static_cast<uint32_t>(bits >> 45) & 3;
+
+        float sum      = 0.0f;
+        uint32_t shift = 30;
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            if (i == largest)
+                continue;
+
+            const float normalized = static_cast<float>((bits >> shift) & 0x7fff) / 32767.0f;
+            value[i]               = (normalized * 2.0f - 1.0f) * smallest_three_range;
+            sum                    += value[i] * value[i];
+            shift                  -= 15;
+        }
+        value[largest] = Helper::Sqrt(Helper::Max(1.0f - sum, 0.0f));
+    }
+
+    void compress(const vector<AnimationNode>& channels, const double ticks_per_sec, const Settings& settings, Clip* clip)
+    {
+        clip->tracks.clear();
+        clip->keys.clear();
+
+        const double seconds_per_tick = ticks_per_sec > 0.0 ? 1.0 / ticks_per_sec : 1.0;
+
+        // The position error is relative to the largest translation
+        float translation_max = 0.0f;
+        for (const AnimationNode& channel : channels)
+        {
+            for (const KeyVector& key : channel.positionFrames)
+            {
+                translation_max = Helper::Max(translation_max, Helper::Max3(Helper::Abs(key.value.x), Helper::Abs(key.value.y), Helper::Abs(key.value.z)));
+            }
+        }
+
+        // A key with the time it's needed at, which is when playback passes the previous key of its track
+        struct StreamKey
+        {
+            float time_needed;
+            Key key;
+        };
+        vector<StreamKey> stream;
+
+        auto add_track = [&](const int32_t bone, const TrackType type, vector<SourceKey>& keys)
+        {
+            if (keys.empty() || clip->tracks.size() >= numeric_limits<uint16_t>::max())
+                return;
+
+            // Keys at the same time can't be interpolated between, and rotations have to stay in the same hemisphere to interpolate the short way
+            vector<SourceKey> unique_keys;
+            for (SourceKey& key : keys)
+            {
+                if (!unique_keys.empty() && key.time <= unique_keys.back().time)
+                    continue;
+
+                if (type == TrackType::Rotation && !unique_keys.empty())
+                {
+                    const float* previous = unique_keys.back().value;
+                    if (previous[0] * key.value[0] + previous[1] * key.value[1] + previous[2] * key.value[2] + previous[3] * key.value[3] < 0.0f)
+                    {
+                        for (float& component : key.value)
+                        {
+                            component = -component;
+                        }
+                    }
+                }
+
+                unique_keys.emplace_back(key);
+            }
+
+            const float error =
+                type == TrackType::Position ? settings.error_position * Helper::Max(translation_max, Helper::EPSILON) :
+                type == TrackType::Rotation ? settings.error_rotation :
+                settings.error_scale;
+            const vector<uint32_t> kept = reduce(type, unique_keys, error);
+
+            Track track;
+            track.bone      = bone;
+            track.type      = type;
+            track.key_count = static_cast<uint32_t>(kept.size());
+            if (type != TrackType::Rotation)
+            {
+                Vector3 range_max = Vector3(-numeric_limits<float>::max());
+                track.range_min   = Vector3(numeric_limits<float>::max());
+                for (const uint32_t index : kept)
+                {
+                    const float* value  = unique_keys[index].value;
+                    track.range_min     = Vector3(Helper::Min(track.range_min.x, value[0]), Helper::Min(track.range_min.y, value[1]), Helper::Min(track.range_min.z, value[2]));
+                    range_max           = Vector3(Helper::Max(range_max.x, value[0]), Helper::Max(range_max.y, value[1]), Helper::Max(range_max.z, value[2]));
+                }
+                track.range_extent = range_max - track.range_min;
+            }
+
+            const uint16_t track_index = static_cast<uint16_t>(clip->tracks.size());
+            for (uint32_t i = 0; i < static_cast<uint32_t>(kept.size()); i++)
+            {
+                StreamKey& stream_key   = stream.emplace_back();
+                stream_key.time_needed  = i == 0 ? -numeric_limits<float>::max() : unique_keys[kept[i - 1]].time;
+                stream_key.key.time     = unique_keys[kept[i]].time;
+                stream_key.key.track    = track_index;
+                encode(track, unique_keys[kept[i]].value, stream_key.key.value);
+            }
+
+            clip->tracks.emplace_back(track);
+        };
+
+        vector<SourceKey> keys;
+        for (const AnimationNode& channel : channels)
+        {
+            if (channel.bone < 0)
+                continue;
+
+            keys.clear();
+            for (const KeyVector& key : channel.positionFrames)
+            {
+                keys.push_back({ static_cast<float>(key.time * seconds_per_tick), { key.value.x, key.value.y, key.value.z, 0.0f } });
+            }
+            add_track(channel.bone, TrackType::Position, keys);
+
+            keys.clear();
+            for (const KeyQuaternion& key : channel.rotationFrames)
+            {
+                keys.push_back({ static_cast<float>(key.time * seconds_per_tick), { key.value.x, key.value.y, key.value.z, key.value.w } });
+            }
+            add_track(channel.bone, TrackType::Rotation, keys);
+
+            keys.clear();
+            for (const KeyVector& key : channel.scaleFrames)
+            {
+                keys.push_back({ static_cast<float>(key.time * seconds_per_tick), { key.value.x, key.value.y, key.value.z, 0.0f } });
+            }
+            add_track(channel.bone, TrackType::Scale, keys);
+        }
+
+        // Interleave the tracks in the order playback needs their keys (a track's keys stay in order as the sort is stable)
+        stable_sort(stream.begin(), stream.end(), [](const StreamKey& a, const StreamKey& b) { return a.time_needed < b.time_needed; });
+        clip->keys.reserve(stream.size());
+        for (const StreamKey& stream_key : stream)
+        {
+            clip->keys.emplace_back(stream_key.key);
+        }
+    }
+
+    void sample(const Clip& clip, Cursor* cursor, const float time_sec, Skinning::BoneTransform* pose, const uint32_t bone_count)
+    {
+        // Start over for a different clip or when going back in time
+        if (cursor->clip != &clip || time_sec < cursor->time)
+        {
+            cursor->clip     = &clip;
+            cursor->position = 0;
+            cursor->windows.assign(clip.tracks.size(), Cursor::Window());
+        }
+        cursor->time = time_sec;
+
+        // Advance through the stream, every key that is read moves its track's window one key forward
+        const uint32_t key_count = static_cast<uint32_t>(clip.keys.size());
+        while (cursor->position < key_count)
+        {
+            const Key& key          = clip.keys[cursor->position];
+            Cursor::Window& window  = cursor->windows[key.track];
+
+            const float time_needed = window.has_next ? window.time_next : -numeric_limits<float>::max();
+            if (time_needed > time_sec)
+                break;
+
+            window.time_previous = window.time_next;
+            window.has_previous  = window.has_next;
+            memcpy(window.previous, window.next, sizeof(window.next));
+
+            decode(clip.tracks[key.track], key.value, window.next);
+            window.time_next = key.time;
+            window.has_next  = true;
+
+            cursor->position++;
+        }
+
+        // Interpolate the decoded keys
+        float value[4];
+        for (uint32_t i = 0; i < static_cast<uint32_t>(clip.tracks.size()); i++)
+        {
+            const Track& track            = clip.tracks[i];
+            const Cursor::Window& window  = cursor->windows[i];
+            if (!window.has_next || track.bone < 0 || static_cast<uint32_t>(track.bone) >= bone_count)
+                continue;
+
+            if (window.has_previous)
+            {
+                interpolate(track.type, window.previous, window.next, key_fraction(time_sec, window.time_previous, window.time_next), value);
+            }
+            else
+            {
+                memcpy(value, window.next, sizeof(value));
+            }
+
+            Skinning::BoneTransform& bone = pose[track.bone];
+            switch (track.type)
+            {
+                case TrackType::Position:   bone.position = Vector3(value[0], value[1], value[2]);              break;
+                case TrackType::Rotation:   bone.rotation = Quaternion(value[0], value[1], value[2], value[3]); break;
+                case TrackType::Scale:      bone.scale    = Vector3(value[0], value[1], value[2]);              break;
+            }
+        }
+    }
+}
@@ -0,0 +1,120 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ============================
+#include <vector>
+#include "../Core/Spartan_Definitions.h"
+#include "../Math/Vector3.h"
+//=======================================
+
+namespace Spartan
+{
+    struct AnimationNode;
+    namespace Skinning { struct BoneTransform; }
+}
+
+namespace Spartan::AnimationCompression
+{
+    // How far a removed key may deviate from the interpolation of the keys which are kept around it
+    struct Settings
+    {
+        float error_position    = 0.0005f; // relative to the largest translation of the clip, so it doesn't depend on the units of the model
+        float error_rotation    = 0.0005f; // per quaternion component, roughly half the angle in radians
+        float error_scale       = 0.0005f;
+        bool measure            = false;   // debugging, fills in the errors and the throughput of the report by sampling the whole clip (slow)
+    };
+
+    enum class TrackType : uint16_t
+    {
+        Position,
+        Rotation,
+        Scale
+    };
+
+    // Positions and scales are quantised within the range of their track
+    struct Track
+    {
+        int32_t bone                    = -1;
+        TrackType type                  = TrackType::Position;
+        uint32_t key_count              = 0;
+        Math::Vector3 range_min         = Math::Vector3::Zero;
+        Math::Vector3 range_extent      = Math::Vector3::Zero;
+    };
+
+    // 12 bytes, where a full precision key takes 24
+    struct Key
+    {
+        float time          = 0.0f;             // seconds
+        uint16_t track      = 0;
+        uint16_t value[3]   = { 0, 0, 0 };      // a smallest-three rotation, or a position/scale within the range of the track
+    };
+
+    // The keys of all the tracks are interleaved in a single stream, ordered by when playback needs them (the time of the previous key of their track).
+    // Playing forward reads the stream front to back, only seeking backwards has to start over.
+    struct Clip
+    {
+        std::vector<Track> tracks;
+        std::vector<Key> keys;
+
+        bool IsEmpty()      const { return keys.empty(); }
+        uint32_t GetSize()  const { return static_cast<uint32_t>(tracks.size() * sizeof(Track) + keys.size() * sizeof(Key)); }
+    };
+
+    // A playback position in a clip, it holds the decoded keys on either side of it for every track
+    struct Cursor
+    {
+        struct Window
+        {
+            float time_previous = 0.0f;
+            float time_next     = 0.0f;
+            float previous[4]   = { 0.0f, 0.0f, 0.0f, 0.0f };
+            float next[4]       = { 0.0f, 0.0f, 0.0f, 0.0f };
+            bool has_previous   = false;
+            bool has_next       = false;
+        };
+
+        const Clip* clip    = nullptr;
+        uint32_t position   = 0;
+        float time          = 0.0f;
+        std::vector<Window> windows;
+    };
+
+    struct Report
+    {
+        uint32_t key_count_before   = 0;
+        uint32_t key_count_after    = 0;
+        uint32_t size_before        = 0;    // bytes
+        uint32_t size_after         = 0;
+        float error_position        = 0.0f; // largest round trip errors, at every source key and in between (only when measured)
+        float error_rotation        = 0.0f; // degrees
+        float error_scale           = 0.0f;
+        float poses_per_ms_before   = 0.0f; // sampling throughput while playing forward (only when measured)
+        float poses_per_ms_after    = 0.0f;
+    };
+
+    // Removes the keys which are within the error of their neighbours' interpolation, quantises the rest and interleaves them
+    void compress(const std::vector<AnimationNode>& channels, double ticks_per_sec, const Settings& settings, Clip* clip);
+
+    // Samples the clip at a time in seconds, bones which the clip doesn't have tracks for are left untouched
+    void sample(const Clip& clip, Cursor* cursor, float time_sec, Skinning::BoneTransform* pose, uint32_t bone_count);
+}
@@ -25,7 +25,6 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Renderer.h"
 #include "../../RHI/RHI_Vertex.h"
 #include "../../RHI/RHI_VertexBuffer.h"
-#include "../../RHI/RHI_IndexBuffer.h"
 #include "../../Resource/ResourceCache.h"
 #include "../../Resource/Import/FontImporter.h"
 #include "../../Core/Stopwatch.h"
@@ -42,14 +41,38 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+    // Decodes UTF-8, malformed sequences are skipped
+    static void utf8_to_char_codes(const string& text, vector<uint32_t>* char_codes)
+    {
+        char_codes->clear();
+
+        for (size_t i = 0; i < text.size();)
+        {
+            const uint8_t lead = static_cast<uint8_t>(text[i]);
+            uint32_t length    = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xe ? 3 : (lead >> 3) == 0x1e ? 4 : 0;
+            if (length == 0 || i + length > text.size())
+            {
+                i++;
+                continue;
+            }
+
+            uint32_t char_code = length == 1 ? lead : lead & (0xff >> (length + 1));
+            for (uint32_t j = 1; j < length; j++)
+            {
+                char_code = (char_code << 6) | (static_cast<uint8_t>(text[i + j]) & 0x3f);
+            }
+
+            char_codes->emplace_back(char_code);
+            i += length;
+        }
+    }
+
     Font::Font(Context* context, const string& file_path, const int font_size, const Vector4& color) : IResource(context, ResourceType::Font)
     {
         m_rhi_device        = m_context->GetSubsystem<Renderer>()->GetRhiDevice();
         m_vertex_buffer     = make_shared<RHI_VertexBuffer>(m_rhi_device);
-        m_index_buffer      = make_shared<RHI_IndexBuffer>(m_rhi_device);
-        m_char_max_width    = 0;
-        m_char_max_height   = 0;
         m_color             = color;
+        m_glyph_indices_ascii.fill(numeric_limits<uint32_t>::max());
         
         SetSize(font_size);
         Font::LoadFromFile(file_path);
@@ -74,125 +97,220 @@ namespace Spartan
             return false;
         }
 
-        // Find max character height (todo, actually get spacing from FreeType)
-        for (const auto& char_info : m_glyphs)
-        {
-            m_char_max_width    = Helper::Max<int>(char_info.second.width, m_char_max_width);
-            m_char_max_height   = Helper::Max<int>(char_info.second.height, m_char_max_height);
-        }
-        
         LOG_INFO("Loading \"%s\" took %d ms", FileSystem::GetFileNameFromFilePath(file_path).c_str(), static_cast<int>(timer.GetElapsedTimeMs()));
         return true;
     }
 
-    void Font::SetText(const string& text, const Vector2& position)
+    void Font::AddText(const string& text, const Vector2& position)
     {
-        const bool same_text    = text == m_current_text;
-        const bool has_buffers  = (m_vertex_buffer && m_index_buffer);
-
-        if (same_text || !has_buffers)
+        if (text.empty())
             return;
 
-        Vector2 pen = position;
-        m_current_text = text;
-        m_vertices.clear();
+        utf8_to_char_codes(text, &m_char_codes);
 
-        // Draw each letter onto a quad.
-        for (auto text_char : m_current_text)
+        // Add any glyphs which the atlas doesn't have yet
         {
-            Glyph& glyph = m_glyphs[text_char];
+            vector<uint32_t> char_codes_missing;
+            for (const uint32_t char_code : m_char_codes)
+            {
+                if (char_code != ASCII_TAB && char_code != ASCII_NEW_LINE && !HasGlyph(char_code))
+                {
+                    char_codes_missing.emplace_back(char_code);
+                }
+            }
+
+            if (!char_codes_missing.empty())
+            {
+                sort(char_codes_missing.begin(), char_codes_missing.end());
+                char_codes_missing.erase(unique(char_codes_missing.begin(), char_codes_missing.end()), char_codes_missing.end());
+                m_context->GetSubsystem<ResourceCache>()->GetFontImporter()->LoadGlyphs(this, char_codes_missing);
+            }
+        }
 
-            if (text_char == ASCII_TAB)
+        const float scale           = GetScale();
+        const Glyph* glyph_space    = GetGlyph(ASCII_SPACE);
+        const float space_offset    = glyph_space ? glyph_space->horizontal_advance * scale : 0.0f;
+        Vector2 pen                 = position;
+        m_vertices.reserve(m_vertices.size() + m_char_codes.size() * 4);
+
+        // Append a quad for each visible character
+        for (const uint32_t char_code : m_char_codes)
+        {
+            if (char_code == ASCII_TAB)
             {
-                const uint32_t space_offset         = m_glyphs[ASCII_SPACE].horizontal_advance;
                 const uint32_t space_count          = 8; // spaces in a typical terminal
-                const uint32_t tab_spacing          = space_offset * space_count;
+                const uint32_t tab_spacing          = Helper::Max(static_cast<uint32_t>(space_offset * space_count), 1u);
                 const uint32_t offset_from_start    = static_cast<uint32_t>(Math::Helper::Abs(pen.x - position.x));
                 const uint32_t next_column_index    = (offset_from_start / tab_spacing) + 1;
                 const uint32_t offset_to_column     = (next_column_index * tab_spacing) - offset_from_start;
                 pen.x                               += offset_to_column;
+                continue;
             }
-            else if (text_char == ASCII_NEW_LINE)
+
+            if (char_code == ASCII_NEW_LINE)
             {
-                pen.y -= m_char_max_height;
+                pen.y -= Helper::Round(m_line_height * scale);
                 pen.x = position.x;
+                continue;
             }
-            else if (text_char == ASCII_SPACE)
-            {
-                // Advance
-                pen.x += glyph.horizontal_advance;
-            }
-            else // Any other char
+
+            const Glyph* glyph = GetGlyph(char_code);
+            if (!glyph)
+                continue;
+
+            // Whitespace has no quad
+            if (glyph->width != 0.0f)
             {
-                // First triangle in quad.        
-                m_vertices.emplace_back(pen.x + glyph.offset_x,                 pen.y + glyph.offset_y,                  0.0f, glyph.uv_x_left,  glyph.uv_y_top);       // top left
-                m_vertices.emplace_back(pen.x + glyph.offset_x  + glyph.width,  pen.y + glyph.offset_y - glyph.height,   0.0f, glyph.uv_x_right, glyph.uv_y_bottom);    // bottom right
-                m_vertices.emplace_back(pen.x + glyph.offset_x,                 pen.y + glyph.offset_y - glyph.height,   0.0f, glyph.uv_x_left,  glyph.uv_y_bottom);    // bottom left
-                // Second triangle in quad.
-                m_vertices.emplace_back(pen.x + glyph.offset_x,                 pen.y + glyph.offset_y,                  0.0f, glyph.uv_x_left,  glyph.uv_y_top);       // top left
-                m_vertices.emplace_back(pen.x + glyph.offset_x  + glyph.width,  pen.y + glyph.offset_y,                  0.0f, glyph.uv_x_right, glyph.uv_y_top);       // top right
-                m_vertices.emplace_back(pen.x + glyph.offset_x  + glyph.width,  pen.y + glyph.offset_y - glyph.height,   0.0f, glyph.uv_x_right, glyph.uv_y_bottom);    // bottom right
-
-                // Advance
-                pen.x += glyph.horizontal_advance;
+                const float left        = pen.x + glyph->offset_x * scale;
+                const float right       = left + glyph->width * scale;
+                const float top         = pen.y + glyph->offset_y * scale;
+                const float bottom      = top - glyph->height * scale;
+
+                // Texture coordinates are in atlas pixels until the upload, as the atlas can still grow during the frame
+                const float atlas_left   = static_cast<float>(glyph->atlas_x);
+                const float atlas_right  = atlas_left + glyph->width;
+                const float atlas_top    = static_cast<float>(glyph->atlas_y);
+                const float atlas_bottom = atlas_top + glyph->height;
+
+                m_vertices.emplace_back(left,  top,    0.0f, atlas_left,  atlas_top);      // top left
+                m_vertices.emplace_back(right, top,    0.0f, atlas_right, atlas_top);      // top right
+                m_vertices.emplace_back(left,  bottom, 0.0f, atlas_left,  atlas_bottom);   // bottom left
+                m_vertices.emplace_back(right, bottom, 0.0f, atlas_right, atlas_bottom);   // bottom right
             }
-        }
-        m_vertices.shrink_to_fit();
-        
-        m_indices.clear();
-        for (uint32_t i = 0; i < m_vertices.size(); i++)
-        {
-            m_indices.emplace_back(i);
-        }
 
-        UpdateBuffers(m_vertices, m_indices);
+            // Advance
+            pen.x += glyph->horizontal_advance * scale;
+        }
     }
 
-    void Font::SetSize(const uint32_t size)
+    void Font::ClearText()
     {
-        m_font_size = Helper::Clamp<uint32_t>(size, 8, 50);
+        m_vertices.clear();
     }
 
-    bool Font::UpdateBuffers(vector<RHI_Vertex_PosTex>& vertices, vector<uint32_t>& indices) const
+    bool Font::UpdateVertexBuffer(const uint32_t frame_slot, const uint32_t slot_count)
     {
-        if (!m_context || !m_vertex_buffer || !m_index_buffer)
+        m_quad_count = static_cast<uint32_t>(m_vertices.size() / 4);
+        if (m_quad_count == 0)
+            return true;
+
+        if (!m_vertex_buffer || frame_slot >= slot_count)
         {
             LOG_ERROR_INVALID_INTERNALS();
+            m_vertices.clear();
+            m_quad_count = 0;
             return false;
         }
 
-        // Grow buffers (if needed)
-        if (vertices.size() > m_vertex_buffer->GetVertexCount())
+        // Grow (if needed), the buffer has a range per frame slot so that the GPU never reads what is being written
+        const uint32_t vertex_count = static_cast<uint32_t>(m_vertices.size());
+        if (vertex_count > m_vertex_capacity || slot_count != m_slot_count)
         {
-            // Vertex buffer
-            if (!m_vertex_buffer->CreateDynamic<RHI_Vertex_PosTex>(static_cast<uint32_t>(vertices.size())))
+            m_vertex_capacity   = Helper::Max(Helper::Max(vertex_count, m_vertex_capacity * 2), 4096u);
+            m_slot_count        = slot_count;
+
+            if (!m_vertex_buffer->CreateDynamic<RHI_Vertex_PosTex>(m_vertex_capacity * m_slot_count))
             {
                 LOG_ERROR("Failed to update vertex buffer.");
+                m_vertex_capacity   = 0;
+                m_quad_count        = 0;
+                m_vertices.clear();
                 return false;
             }
+        }
+
+        // Upload the batch and start a new one
+        bool mapped = false;
+        m_vertex_offset = frame_slot * m_vertex_capacity;
+        if (RHI_Vertex_PosTex* vertex_buffer = static_cast<RHI_Vertex_PosTex*>(m_vertex_buffer->Map()))
+        {
+            const float atlas_width_inverse  = 1.0f / static_cast<float>(Helper::Max(m_atlas_data.width, 1u));
+            const float atlas_height_inverse = 1.0f / static_cast<float>(Helper::Max(m_atlas_data.height, 1u));
 
-            // Index buffer
-            if (!m_index_buffer->CreateDynamic<uint32_t>(static_cast<uint32_t>(indices.size())))
+            vertex_buffer += m_vertex_offset;
+            for (uint32_t i = 0; i < vertex_count; i++)
             {
-                LOG_ERROR("Failed to update index buffer.");
-                return false;
+                vertex_buffer[i]        = m_vertices[i];
+                vertex_buffer[i].tex[0] *= atlas_width_inverse;
+                vertex_buffer[i].tex[1] *= atlas_height_inverse;
             }
+
+            mapped = m_vertex_buffer->Unmap();
+        }
+        m_vertices.clear();
+
+        if (!mapped)
+        {
+            m_quad_count = 0;
         }
 
-        bool mapped_vertex = false;
-        if (const auto vertex_buffer = static_cast<RHI_Vertex_PosTex*>(m_vertex_buffer->Map()))
+        return mapped;
+    }
+
+    uint32_t Font::GetGlyphIndex(const uint32_t char_code) const
+    {
+        if (char_code < m_glyph_indices_ascii.size())
+            return m_glyph_indices_ascii[char_code];
+
+        const auto it = m_glyph_indices.find(char_code);
+        return it != m_glyph_indices.end() ? it->second : numeric_limits<uint32_t>::max();
+    }
+
+    const Glyph* Font::GetGlyph(const uint32_t char_code) const
+    {
+        const uint32_t index = GetGlyphIndex(char_code);
+        return index != numeric_limits<uint32_t>::max() ? &m_glyphs[index] : nullptr;
+    }
+
+    void Font::SetGlyph(const uint32_t char_code, const Glyph& glyph)
+    {
+        const uint32_t index = GetGlyphIndex(char_code);
+        if (index != numeric_limits<uint32_t>::max())
         {
-            copy(vertices.begin(), vertices.end(), vertex_buffer);
-            mapped_vertex = m_vertex_buffer->Unmap();
+            m_glyphs[index] = glyph;
+            return;
         }
 
-        bool mapped_index = false;
-        if (const auto index_buffer = static_cast<uint32_t*>(m_index_buffer->Map()))
+        const uint32_t index_new = static_cast<uint32_t>(m_glyphs.size());
+        m_glyphs.emplace_back(glyph);
+
+        if (char_code < m_glyph_indices_ascii.size())
+        {
+            m_glyph_indices_ascii[char_code] = index_new;
+        }
+        else
         {
-            copy(indices.begin(), indices.end(), index_buffer);
-            mapped_index = m_index_buffer->Unmap();
+            m_glyph_indices[char_code] = index_new;
         }
+    }
+
+    void Font::SetSize(const uint32_t size)
+    {
+        // Only scales the glyphs, the atlas stays the same
+        m_font_size = Helper::Clamp<uint32_t>(size, 8, 50);
+    }
+
+    float Font::GetScale() const
+    {
+        // The size is in points, at 96 DPI
+        return (m_font_size * 96.0f / 72.0f) / static_cast<float>(font_sdf_size);
+    }
+
+    Vector2 Font::GetOutlineThresholds() const
+    {
+        if (m_outline == Font_Outline_None || m_outline_size == 0)
+            return Vector2(0.5f, 0.5f);
+
+        // The outline size is in screen pixels, a distance field value of 1 spans two spreads at the size of the distance field
+        const float width = Helper::Min(m_outline_size / GetScale() / (2.0f * font_sdf_spread), 0.5f);
+
+        if (m_outline == Font_Outline_Edge)
+            return Vector2(0.5f - width * 0.5f, 0.5f + width * 0.5f);
 
-        return mapped_vertex && mapped_index;
+        if (m_outline == Font_Outline_Negative)
+            return Vector2(0.5f, 0.5f + width);
+
+        return Vector2(0.5f - width, 0.5f); // Font_Outline_Positive
     }
+
 }
@@ -21,15 +21,21 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES ==============================
+//= INCLUDES ===============================
 #include <memory>
+#include <array>
+#include <vector>
 #include <unordered_map>
 #include "Glyph.h"
 #include "../../RHI/RHI_Definition.h"
 #include "../../Resource/IResource.h"
 #include "../../Math/Vector4.h"
 #include "../../Core/Spartan_Definitions.h"
-//=========================================
+//==========================================
+
+//= FORWARD DECLARATIONS =
+struct FT_FaceRec_;
+//========================
 
 namespace Spartan
 {
@@ -38,6 +44,25 @@ namespace Spartan
         class Vector2;
     }
 
+    // Glyphs are rasterised once at this size (in pixels) and scaled to any font size,
+    // their distance fields extend this many pixels beyond the edges, which also bounds the outline size.
+    static const uint32_t font_sdf_size     = 32;
+    static const uint32_t font_sdf_spread   = 8;
+
+    // Quads are indexed with 16 bits, a batch with more quads than this takes more than one draw
+    static const uint32_t font_batch_quads_per_draw = 16384;
+
+    // CPU side of the atlas, glyphs are packed into shelves
+    struct FontAtlas
+    {
+        std::vector<std::byte> pixels;
+        uint32_t width          = 0;
+        uint32_t height         = 0;
+        uint32_t shelf_x        = 0;
+        uint32_t shelf_y        = 0;
+        uint32_t shelf_height   = 0;
+    };
+
     enum Font_Hinting_Type
     {
         Font_Hinting_None,
@@ -64,7 +89,10 @@ namespace Spartan
         bool LoadFromFile(const std::string& file_path) override;
         //======================================================
 
-        void SetText(const std::string& text, const Math::Vector2& position);
+        // Text is batched, strings are appended as quads during the frame and uploaded together
+        void AddText(const std::string& text, const Math::Vector2& position);
+        bool UpdateVertexBuffer(uint32_t frame_slot, uint32_t slot_count);
+        void ClearText();
         void SetSize(uint32_t size);
 
         const Math::Vector4& GetColor()                                 const { return m_color; }
@@ -79,22 +107,33 @@ namespace Spartan
         void SetOutlineSize(const uint32_t outline_size)                      { m_outline_size = outline_size; }
         const uint32_t GetOutlineSize()                                 const { return m_outline_size; }
 
+        // A single distance field atlas serves all sizes and outlines
         const auto& GetAtlas()                                          const { return m_atlas; }
         void SetAtlas(const std::shared_ptr<RHI_Texture>& atlas)              { m_atlas = atlas; }
+        FontAtlas& GetAtlasData()                                             { return m_atlas_data; }
 
-        const auto& GetAtlasOutline()                                   const { return m_atlas_outline; }
-        void SetAtlasOutline(const std::shared_ptr<RHI_Texture>& atlas)       { m_atlas_outline = atlas; }
+        // Distance field values (0.5 is the edge of a glyph) between which the outline is drawn, the fill is above the second one
+        Math::Vector2 GetOutlineThresholds() const;
 
-        RHI_IndexBuffer* GetIndexBuffer()                               const { return m_index_buffer.get(); }
+        // The uploaded batch, four vertices per quad starting at the vertex offset, drawn with the renderer's quad index buffer
         RHI_VertexBuffer* GetVertexBuffer()                             const { return m_vertex_buffer.get(); }
-        uint32_t GetIndexCount()                                        const { return static_cast<uint32_t>(m_indices.size()); }
+        uint32_t GetVertexOffset()                                      const { return m_vertex_offset; }
+        uint32_t GetQuadCount()                                         const { return m_quad_count; }
+
         uint32_t GetSize()                                              const { return m_font_size; }
-        void SetGlyph(const uint32_t char_code, const Glyph& glyph)              { m_glyphs[char_code] = glyph; }
+        float GetScale()                                                const;
+        void SetGlyph(uint32_t char_code, const Glyph& glyph);
+        const Glyph* GetGlyph(uint32_t char_code) const;
+        bool HasGlyph(const uint32_t char_code)                         const { return GetGlyph(char_code) != nullptr; }
+        uint32_t GetGlyphCount()                                        const { return static_cast<uint32_t>(m_glyphs.size()); }
+        void SetLineHeight(const float line_height)                           { m_line_height = line_height; }
+        FT_FaceRec_* GetFace()                                          const { return m_face; }
+        void SetFace(FT_FaceRec_* face)                                       { m_face = face; }
         Font_Hinting_Type GetHinting()                                  const { return m_hinting; }
         auto GetForceAutohint()                                         const { return m_force_autohint; }
             
     private:    
-        bool UpdateBuffers(std::vector<RHI_Vertex_PosTex>& vertices, std::vector<uint32_t>& indices) const;
+        uint32_t GetGlyphIndex(uint32_t char_code) const;
 
         uint32_t m_font_size            = 14;
         uint32_t m_outline_size         = 2;
@@ -103,16 +142,24 @@ namespace Spartan
         Font_Outline_Type m_outline     = Font_Outline_Positive;
         Math::Vector4 m_color           = Math::Vector4(1.0f, 1.0f, 1.0f, 1.0f);
         Math::Vector4 m_color_outline   = Math::Vector4(0.0f, 0.0f, 0.0f, 1.0f);
-        std::string m_current_text;
-        uint32_t m_char_max_width;
-        uint32_t m_char_max_height;
+        float m_line_height             = 0.0f;
+        FT_FaceRec_* m_face             = nullptr; // owned by the importer
         std::shared_ptr<RHI_Texture> m_atlas;
-        std::shared_ptr<RHI_Texture> m_atlas_outline;
-        std::unordered_map<uint32_t, Glyph> m_glyphs;
-        std::shared_ptr<RHI_VertexBuffer> m_vertex_buffer;
-        std::shared_ptr<RHI_IndexBuffer> m_index_buffer;
-        std::vector<RHI_Vertex_PosTex> m_vertices;
-        std::vector<uint32_t> m_indices;    
+        FontAtlas m_atlas_data;
         std::shared_ptr<RHI_Device> m_rhi_device;
+
+        // Glyphs are stored flat, ASCII characters index them directly and everything else goes through a map
+        std::vector<Glyph> m_glyphs;
+        std::array<uint32_t, 128> m_glyph_indices_ascii;
+        std::unordered_map<uint32_t, uint32_t> m_glyph_indices;
+
+        // Batch, the vertex buffer has a range per frame that can be in flight
+        std::vector<uint32_t> m_char_codes;
+        std::vector<RHI_Vertex_PosTex> m_vertices;
+        std::shared_ptr<RHI_VertexBuffer> m_vertex_buffer;
+        uint32_t m_vertex_capacity      = 0; // per slot
+        uint32_t m_slot_count           = 0;
+        uint32_t m_vertex_offset        = 0;
+        uint32_t m_quad_count           = 0;
     };
 }
@@ -23,16 +23,15 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace Spartan
 {
+    // Metrics are in pixels at the size of the distance field and get scaled to the size of the font
     struct Glyph
     {
-        int32_t offset_x            = 0;
-        int32_t offset_y            = 0;
-        uint32_t width              = 0;
-        uint32_t height             = 0;
-        uint32_t horizontal_advance = 0;
-        float uv_x_left             = 0.0f;
-        float uv_x_right            = 0.0f;
-        float uv_y_top              = 0.0f;
-        float uv_y_bottom           = 0.0f;
+        float offset_x              = 0.0f;
+        float offset_y              = 0.0f;
+        float width                 = 0.0f;
+        float height                = 0.0f;
+        float horizontal_advance    = 0.0f;
+        uint32_t atlas_x            = 0;
+        uint32_t atlas_y            = 0;
     };
 }
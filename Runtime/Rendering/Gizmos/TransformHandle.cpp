@@ -198,22 +198,22 @@ namespace Spartan
         return m_handle_x.isEditing || m_handle_y.isEditing || m_handle_z.isEditing || m_handle_xyz.isEditing;
     }
 
-    const Matrix& TransformHandle::GetTransform(const Vector3& axis) const
+    Matrix TransformHandle::GetTransform(const Vector3& axis) const
     {
         if (axis == Vector3::Right)
         {
-            return m_handle_x.transform;
+            return m_model->GetVertexTransform() * m_handle_x.transform;
         }
         if (axis == Vector3::Up)
         {
-            return m_handle_y.transform;
+            return m_model->GetVertexTransform() * m_handle_y.transform;
         }
         if (axis == Vector3::Forward)
         {
-            return m_handle_z.transform;
+            return m_model->GetVertexTransform() * m_handle_z.transform;
         }
 
-        return m_handle_xyz.transform;
+        return m_model->GetVertexTransform() * m_handle_xyz.transform;
     }
 
     const Vector3& TransformHandle::GetColor(const Vector3& axis) const
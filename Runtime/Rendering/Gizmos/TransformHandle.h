@@ -95,7 +95,7 @@ namespace Spartan
 
         void Initialize(TransformHandle_Type type, Context* context);
         bool Update(TransformHandle_Space space, Entity* entity, Camera* camera, float handle_size, float handle_speed);
-        const Math::Matrix& GetTransform(const Math::Vector3& axis) const;
+        Math::Matrix GetTransform(const Math::Vector3& axis) const; // includes the vertex transform of the model, ready for drawing
         const Math::Vector3& GetColor(const Math::Vector3& axis) const;
         const RHI_VertexBuffer* GetVertexBuffer() const;
         const RHI_IndexBuffer* GetIndexBuffer() const;
@@ -0,0 +1,302 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =========================
+#include "Spartan.h"
+#include "LightClusters.h"
+#include "../Threading/Threading.h"
+#include <emmintrin.h>
+//====================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan::Math;
+//============================
+
+namespace Spartan
+{
+    LightClusters::LightClusters(Context* context)
+    {
+        m_min_x                 = vector<float>(cluster_count, 0.0f);
+        m_min_y                 = vector<float>(cluster_count, 0.0f);
+        m_min_z                 = vector<float>(cluster_count, 0.0f);
+        m_max_x                 = vector<float>(cluster_count, 0.0f);
+        m_max_y                 = vector<float>(cluster_count, 0.0f);
+        m_max_z                 = vector<float>(cluster_count, 0.0f);
+        m_masks                 = vector<uint32_t>(cluster_count * m_mask_words, 0);
+        m_cluster_offset_count  = vector<uint32_t>(cluster_count, 0);
+        m_indices               = vector<uint8_t>(max_indices, 0);
+        m_lights.reserve(max_lights);
+
+        // Without a context (e.g. headless tests), everything runs on the calling thread
+        m_threading = context ? context->GetSubsystem<Threading>() : nullptr;
+    }
+
+    void LightClusters::Begin(const Matrix& view, const Matrix& projection, const float near_plane, const float far_plane)
+    {
+        m_view          = view;
+        m_projection    = projection;
+        m_near_plane    = Helper::Max(near_plane, Helper::EPSILON);
+        m_far_plane     = Helper::Max(far_plane, m_near_plane + Helper::EPSILON);
+        m_lights.clear();
+
+        // Exponential slices, slice = log(z / near) / log(far / near) * grid_z
+        const float log_far_near    = log(m_far_plane / m_near_plane);
+        m_slice_scale               = static_cast<float>(grid_z) / log_far_near;
+        m_slice_bias                = -static_cast<float>(grid_z) * log(m_near_plane) / log_far_near;
+
+        // Compute the view space bounds of every cluster.
+        // For a perspective projection, ndc.x = x * m00 / z + m20, so x = (ndc.x - m20) * z / m00 (same for y).
+        for (uint32_t z = 0; z < grid_z; z++)
+        {
+            const float depth_near  = m_near_plane * pow(m_far_plane / m_near_plane, static_cast<float>(z) / grid_z);
+            const float depth_far   = m_near_plane * pow(m_far_plane / m_near_plane, static_cast<float>(z + 1) / grid_z);
+
+            for (uint32_t y = 0; y < grid_y; y++)
+            {
+                // Tiles go from the top of the screen to the bottom, like uvs
+                const float ndc_y_top       = 1.0f - 2.0f * static_cast<float>(y) / grid_y;
+                const float ndc_y_bottom    = 1.0f - 2.0f * static_cast<float>(y + 1) / grid_y;
+
+                for (uint32_t x = 0; x < grid_x; x++)
+                {
+                    const float ndc_x_left  = -1.0f + 2.0f * static_cast<float>(x) / grid_x;
+                    const float ndc_x_right = -1.0f + 2.0f * static_cast<float>(x + 1) / grid_x;
+
+                    const float x_values[4] =
+                    {
+                        (ndc_x_left  - m_projection.m20) * depth_near / m_projection.m00,
+                        (ndc_x_left  - m_projection.m20) * depth_far  / m_projection.m00,
+                        (ndc_x_right - m_projection.m20) * depth_near / m_projection.m00,
+                        (ndc_x_right - m_projection.m20) * depth_far  / m_projection.m00
+                    };
+
+                    const float y_values[4] =
+                    {
+                        (ndc_y_bottom - m_projection.m21) * depth_near / m_projection.m11,
+                        (ndc_y_bottom - m_projection.m21) * depth_far  / m_projection.m11,
+                        (ndc_y_top    - m_projection.m21) * depth_near / m_projection.m11,
+                        (ndc_y_top    - m_projection.m21) * depth_far  / m_projection.m11
+                    };
+
+                    const uint32_t index = GetClusterIndex(x, y, z);
+                    m_min_x[index] = Helper::Min(Helper::Min(x_values[0], x_values[1]), Helper::Min(x_values[2], x_values[3]));
+                    m_max_x[index] = Helper::Max(Helper::Max(x_values[0], x_values[1]), Helper::Max(x_values[2], x_values[3]));
+                    m_min_y[index] = Helper::Min(Helper::Min(y_values[0], y_values[1]), Helper::Min(y_values[2], y_values[3]));
+                    m_max_y[index] = Helper::Max(Helper::Max(y_values[0], y_values[1]), Helper::Max(y_values[2], y_values[3]));
+                    m_min_z[index] = depth_near;
+                    m_max_z[index] = depth_far;
+                }
+            }
+        }
+    }
+
+    bool LightClusters::AddLight(const Vector3& position, const float range)
+    {
+        if (m_lights.size() >= max_lights)
+            return false;
+
+        LightBounds& light  = m_lights.emplace_back();
+        light.center        = position * m_view;
+        light.radius        = Helper::Max(range, 0.0f);
+
+        // Depth slices, lights that are entirely behind the camera or beyond the far plane don't touch any cluster (empty range)
+        const float z_near = light.center.z - light.radius;
+        const float z_far  = light.center.z + light.radius;
+        if (z_far < m_near_plane || z_near > m_far_plane)
+        {
+            light.z_min = 1;
+            light.z_max = 0;
+            return true;
+        }
+        light.z_min = GetSlice(z_near);
+        light.z_max = GetSlice(z_far);
+
+        // Screen tiles, if the sphere crosses the near plane it can cover any of them
+        light.x_min = 0;
+        light.x_max = grid_x - 1;
+        light.y_min = 0;
+        light.y_max = grid_y - 1;
+        if (z_near > m_near_plane)
+        {
+            // Project the view space box around the sphere, using both its near and far depth keeps it conservative
+            float ndc_x_min = numeric_limits<float>::max();
+            float ndc_x_max = numeric_limits<float>::lowest();
+            float ndc_y_min = numeric_limits<float>::max();
+            float ndc_y_max = numeric_limits<float>::lowest();
+            for (const float depth : { z_near, z_far })
+            {
+                for (const float x : { light.center.x - light.radius, light.center.x + light.radius })
+                {
+                    const float ndc_x = x * m_projection.m00 / depth + m_projection.m20;
+                    ndc_x_min = Helper::Min(ndc_x_min, ndc_x);
+                    ndc_x_max = Helper::Max(ndc_x_max, ndc_x);
+                }
+
+                for (const float y : { light.center.y - light.radius, light.center.y + light.radius })
+                {
+                    const float ndc_y = y * m_projection.m11 / depth + m_projection.m21;
+                    ndc_y_min = Helper::Min(ndc_y_min, ndc_y);
+                    ndc_y_max = Helper::Max(ndc_y_max, ndc_y);
+                }
+            }
+
+            // Off screen
+            if (ndc_x_max < -1.0f || ndc_x_min > 1.0f || ndc_y_max < -1.0f || ndc_y_min > 1.0f)
+            {
+                light.z_min = 1;
+                light.z_max = 0;
+                return true;
+            }
+
+            // Convert to tiles (y goes from the top of the screen to the bottom)
+            const auto to_tile = [](const float value, const uint32_t count)
+            {
+                return static_cast<uint32_t>(Helper::Clamp(value * count, 0.0f, static_cast<float>(count - 1)));
+            };
+
+            light.x_min = to_tile((ndc_x_min + 1.0f) * 0.5f, grid_x);
+            light.x_max = to_tile((ndc_x_max + 1.0f) * 0.5f, grid_x);
+            light.y_min = to_tile((1.0f - ndc_y_max) * 0.5f, grid_y);
+            light.y_max = to_tile((1.0f - ndc_y_min) * 0.5f, grid_y);
+        }
+
+        return true;
+    }
+
+    void LightClusters::End()
+    {
+        fill(m_masks.begin(), m_masks.end(), 0);
+
+        // Each depth slice is owned by a single thread, so no synchronisation is needed when writing the masks
+        if (m_threading && !m_lights.empty())
+        {
+            m_threading->AddTaskLoop([this](uint32_t start, uint32_t end) { BinSlices(start, end); }, grid_z);
+        }
+        else
+        {
+            BinSlices(0, grid_z);
+        }
+
+        Compact();
+    }
+
+    uint32_t LightClusters::GetSlice(const float view_z) const
+    {
+        const float slice = log(Helper::Max(view_z, m_near_plane)) * m_slice_scale + m_slice_bias;
+        return static_cast<uint32_t>(Helper::Clamp(slice, 0.0f, static_cast<float>(grid_z - 1)));
+    }
+
+    void LightClusters::BinSlices(uint32_t slice_start, uint32_t slice_end)
+    {
+        const __m128 zero = _mm_setzero_ps();
+
+        for (uint32_t light_index = 0; light_index < static_cast<uint32_t>(m_lights.size()); light_index++)
+        {
+            const LightBounds& light = m_lights[light_index];
+
+            const uint32_t z_start  = Helper::Max(light.z_min, slice_start);
+            const uint32_t z_end    = Helper::Min(light.z_max + 1, slice_end);
+            if (z_start >= z_end)
+                continue;
+
+            const __m128 center_x   = _mm_set1_ps(light.center.x);
+            const __m128 center_y   = _mm_set1_ps(light.center.y);
+            const __m128 center_z   = _mm_set1_ps(light.center.z);
+            const __m128 radius_sq  = _mm_set1_ps(light.radius * light.radius);
+            const uint32_t word     = light_index / 32;
+            const uint32_t bit      = 1u << (light_index % 32);
+
+            for (uint32_t z = z_start; z < z_end; z++)
+            {
+                for (uint32_t y = light.y_min; y <= light.y_max; y++)
+                {
+                    // Test four clusters at a time, sphere vs box: the squared distance from the center to the box
+                    for (uint32_t x = light.x_min & ~3u; x <= light.x_max; x += 4)
+                    {
+                        const uint32_t index = GetClusterIndex(x, y, z);
+
+                        const __m128 dx = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_min_x[index]), center_x), zero), _mm_max_ps(_mm_sub_ps(center_x, _mm_loadu_ps(&m_max_x[index])), zero));
+                        const __m128 dy = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_min_y[index]), center_y), zero), _mm_max_ps(_mm_sub_ps(center_y, _mm_loadu_ps(&m_max_y[index])), zero));
+                        const __m128 dz = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_min_z[index]), center_z), zero), _mm_max_ps(_mm_sub_ps(center_z, _mm_loadu_ps(&m_max_z[index])), zero));
+
+                        const __m128 distance_sq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+                        const int inside = _mm_movemask_ps(_mm_cmple_ps(distance_sq, radius_sq));
+
+                        for (uint32_t lane = 0; lane < 4; lane++)
+                        {
+                            const uint32_t tile_x = x + lane;
+                            if ((inside & (1 << lane)) && tile_x >= light.x_min && tile_x <= light.x_max)
+                            {
+                                m_masks[(index + lane) * m_mask_words + word] |= bit;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void LightClusters::Compact()
+    {
+        const bool index_budget_exceeded_previous = IsIndexBudgetExceeded();
+        m_index_count           = 0;
+        m_index_dropped_count   = 0;
+
+        for (uint32_t cluster = 0; cluster < cluster_count; cluster++)
+        {
+            const uint32_t offset   = m_index_count;
+            uint32_t count          = 0;
+
+            for (uint32_t word = 0; word < m_mask_words; word++)
+            {
+                uint32_t mask = m_masks[cluster * m_mask_words + word];
+                while (mask != 0)
+                {
+                    // Extract the lowest set bit
+                    uint32_t bit = 0;
+                    while (!(mask & (1u << bit)))
+                    {
+                        bit++;
+                    }
+                    mask &= mask - 1;
+
+                    if (m_index_count >= max_indices)
+                    {
+                        m_index_dropped_count++;
+                        continue;
+                    }
+
+                    m_indices[m_index_count++] = static_cast<uint8_t>(word * 32 + bit);
+                    count++;
+                }
+            }
+
+            m_cluster_offset_count[cluster] = offset | (count << 16);
+        }
+
+        // The dropped lights are missing from some of the clusters, warn when it starts happening instead of every frame
+        if (IsIndexBudgetExceeded() && !index_budget_exceeded_previous)
+        {
+            LOG_WARNING("The light cluster index budget of %d has been exceeded, %d light references were dropped", max_indices, m_index_dropped_count);
+        }
+    }
+}
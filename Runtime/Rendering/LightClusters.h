@@ -0,0 +1,124 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =====================
+#include <vector>
+#include "../Math/Matrix.h"
+#include "../Math/Vector3.h"
+//================================
+
+namespace Spartan
+{
+    class Context;
+    class Threading;
+
+    // Clustered light binning.
+    // The view frustum is split into a grid of clusters (screen tiles x exponential depth slices) and the bounding spheres
+    // of the lights are tested against the view space bounds of the clusters (SSE, in parallel depth slices).
+    // The result is a compact list of light indices per cluster, which the clustered lighting shader walks per pixel.
+    class SPARTAN_CLASS LightClusters
+    {
+    public:
+        // Grid and budgets, must match Light_Clustered.hlsl
+        static const uint32_t grid_x        = 16;
+        static const uint32_t grid_y        = 8;
+        static const uint32_t grid_z        = 24;
+        static const uint32_t cluster_count = grid_x * grid_y * grid_z;
+        static const uint32_t max_lights    = 128;
+        static const uint32_t max_indices   = 16384;
+
+        LightClusters(Context* context);
+        ~LightClusters() = default;
+
+        // Clears the lights and computes the cluster bounds for the given camera
+        void Begin(const Math::Matrix& view, const Math::Matrix& projection, const float near_plane, const float far_plane);
+
+        // Adds the bounding sphere (world space) of a light, returns false when the light budget is exhausted
+        bool AddLight(const Math::Vector3& position, const float range);
+
+        // Bins the lights into the clusters
+        void End();
+
+        // Depth slice of a view space depth, computed as log(z) * scale + bias
+        uint32_t GetSlice(const float view_z) const;
+        float GetSliceScale()   const { return m_slice_scale; }
+        float GetSliceBias()    const { return m_slice_bias; }
+        static uint32_t GetClusterIndex(const uint32_t x, const uint32_t y, const uint32_t z) { return x + y * grid_x + z * grid_x * grid_y; }
+
+        // Results, offsets are stored in the low 16 bits and counts in the high 16 bits
+        uint32_t GetLightCount()                                const { return static_cast<uint32_t>(m_lights.size()); }
+        uint32_t GetClusterOffset(const uint32_t cluster)       const { return m_cluster_offset_count[cluster] & 0xFFFF; }
+        uint32_t GetClusterLightCount(const uint32_t cluster)   const { return m_cluster_offset_count[cluster] >> 16; }
+        const std::vector<uint32_t>& GetClusterOffsetCount()    const { return m_cluster_offset_count; }
+        const std::vector<uint8_t>& GetIndices()                const { return m_indices; }
+        uint32_t GetIndexCount()                                const { return m_index_count; }
+        uint32_t GetIndexDroppedCount()                         const { return m_index_dropped_count; } // light references which didn't fit the index budget
+        bool IsIndexBudgetExceeded()                            const { return m_index_dropped_count != 0; }
+
+    private:
+        struct LightBounds
+        {
+            Math::Vector3 center; // view space
+            float radius    = 0.0f;
+            uint32_t x_min  = 0;
+            uint32_t x_max  = 0;
+            uint32_t y_min  = 0;
+            uint32_t y_max  = 0;
+            uint32_t z_min  = 0;
+            uint32_t z_max  = 0;
+        };
+
+        void BinSlices(uint32_t slice_start, uint32_t slice_end);
+        void Compact();
+
+        // Cluster bounds (view space), structure of arrays so that four clusters along x can be tested at once
+        std::vector<float> m_min_x;
+        std::vector<float> m_min_y;
+        std::vector<float> m_min_z;
+        std::vector<float> m_max_x;
+        std::vector<float> m_max_y;
+        std::vector<float> m_max_z;
+
+        // One bit per light, per cluster
+        static const uint32_t m_mask_words = max_lights / 32;
+        std::vector<uint32_t> m_masks;
+
+        // Results
+        std::vector<uint32_t> m_cluster_offset_count;
+        std::vector<uint8_t> m_indices;
+        uint32_t m_index_count          = 0;
+        uint32_t m_index_dropped_count  = 0;
+
+        // State
+        std::vector<LightBounds> m_lights;
+        Math::Matrix m_view;
+        Math::Matrix m_projection;
+        float m_near_plane  = 0.1f;
+        float m_far_plane   = 1000.0f;
+        float m_slice_scale = 0.0f;
+        float m_slice_bias  = 0.0f;
+
+        // Dependencies
+        Threading* m_threading = nullptr;
+    };
+}
@@ -19,11 +19,12 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES =================
+//= INCLUDES =======================
 #include "Spartan.h"
 #include "Mesh.h"
 #include "../RHI/RHI_Vertex.h"
-//============================
+#include "../Threading/Threading.h"
+//==================================
 
 //= NAMESPACES ================
 using namespace std;
@@ -38,6 +39,11 @@ namespace Spartan
         m_vertices.shrink_to_fit();
         m_indices.clear();
         m_indices.shrink_to_fit();
+        m_skin.clear();
+        m_skin.shrink_to_fit();
+        m_ranges_pending.clear();
+        m_meshlets.clear();
+        m_meshlets.shrink_to_fit();
     }
 
     uint32_t Mesh::GetMemoryUsage() const
@@ -45,6 +51,8 @@ namespace Spartan
         uint32_t size = 0;
         size += uint32_t(m_vertices.size()    * sizeof(RHI_Vertex_PosTexNorTan));
         size += uint32_t(m_indices.size()    * sizeof(uint32_t));
+        size += uint32_t(m_meshlets.size()   * sizeof(MeshOptimizer::Meshlet));
+        size += uint32_t(m_skin.size()       * sizeof(BoneWeights));
 
         return size;
     }
@@ -68,6 +76,27 @@ namespace Spartan
         *vertices               = vector<RHI_Vertex_PosTexNorTan>(vertexFirst, vertexLast);
     }
 
+    void Mesh::Geometry_Grow(uint32_t indexCount, uint32_t vertexCount, uint32_t* indexOffset, uint32_t* vertexOffset)
+    {
+        if (indexOffset)
+        {
+            *indexOffset = static_cast<uint32_t>(m_indices.size());
+        }
+
+        if (vertexOffset)
+        {
+            *vertexOffset = static_cast<uint32_t>(m_vertices.size());
+        }
+
+        m_indices.resize(m_indices.size() + indexCount);
+        m_vertices.resize(m_vertices.size() + vertexCount);
+
+        if (Skin_IsEnabled())
+        {
+            Skin_Enable();
+        }
+    }
+
     void Mesh::Vertices_Append(const vector<RHI_Vertex_PosTexNorTan>& vertices, uint32_t* vertexOffset)
     {
         if (vertexOffset)
@@ -76,6 +105,11 @@ namespace Spartan
         }
 
         m_vertices.insert(m_vertices.end(), vertices.begin(), vertices.end());
+
+        if (Skin_IsEnabled())
+        {
+            Skin_Enable();
+        }
     }
 
     uint32_t Mesh::Vertices_Count() const
@@ -97,4 +131,107 @@ namespace Spartan
 
         m_indices.insert(m_indices.end(), indices.begin(), indices.end());
     }
+
+    uint32_t Mesh::Optimize(vector<MeshOptimizer::Report>* reports /*= nullptr*/, Threading* threading /*= nullptr*/)
+    {
+        const uint32_t range_count = static_cast<uint32_t>(m_ranges_pending.size());
+        if (range_count == 0)
+            return 0;
+
+        vector<MeshOptimizer::Report> _reports(range_count);
+        vector<vector<MeshOptimizer::Meshlet>> meshlets(range_count);
+
+        // The ranges don't overlap, so they can be optimised in parallel
+        auto optimize = [this, &_reports, &meshlets](uint32_t start, uint32_t end)
+        {
+            for (uint32_t i = start; i < end; i++)
+            {
+                const Mesh_Range& range = m_ranges_pending[i];
+
+                if (range.index_offset + range.index_count > m_indices.size() || range.vertex_offset + range.vertex_count > m_vertices.size())
+                {
+                    LOG_ERROR("Mesh range %u is out of bounds", i);
+                    continue;
+                }
+
+                const bool needs_remap = !range.lods.empty() || Skin_IsEnabled();
+                vector<uint32_t> vertex_remap;
+                if (!MeshOptimizer::optimize(&m_indices[range.index_offset], range.index_count, &m_vertices[range.vertex_offset], range.vertex_count, &_reports[i], needs_remap ? &vertex_remap : nullptr))
+                    continue;
+
+                // The bone weights follow their vertices
+                if (Skin_IsEnabled() && !vertex_remap.empty())
+                {
+                    BoneWeights* skin = &m_skin[range.vertex_offset];
+                    const vector<BoneWeights> skin_old(skin, skin + range.vertex_count);
+                    for (uint32_t j = 0; j < range.vertex_count; j++)
+                    {
+                        skin[vertex_remap[j]] = skin_old[j];
+                    }
+                }
+
+                MeshOptimizer::build_meshlets(&m_indices[range.index_offset], range.index_count, &m_vertices[range.vertex_offset], range.vertex_count, &meshlets[i]);
+                for (MeshOptimizer::Meshlet& meshlet : meshlets[i])
+                {
+                    meshlet.index_offset += range.index_offset;
+                }
+
+                // The levels of detail follow the vertices of the full geometry, they only need their own cache order
+                for (const Mesh_Lod& lod : range.lods)
+                {
+                    if (lod.index_offset + lod.index_count > m_indices.size())
+                    {
+                        LOG_ERROR("Mesh range %u has an out of bounds level of detail", i);
+                        continue;
+                    }
+
+                    uint32_t* indices = &m_indices[lod.index_offset];
+                    for (uint32_t j = 0; j < lod.index_count; j++)
+                    {
+                        indices[j] = vertex_remap[indices[j]];
+                    }
+
+                    MeshOptimizer::optimize_vertex_cache(indices, lod.index_count, range.vertex_count);
+                }
+            }
+        };
+
+        if (threading && range_count > 1)
+        {
+            threading->AddTaskLoop(optimize, range_count);
+        }
+        else
+        {
+            optimize(0, range_count);
+        }
+
+        m_ranges_pending.clear();
+
+        for (const vector<MeshOptimizer::Meshlet>& range_meshlets : meshlets)
+        {
+            m_meshlets.insert(m_meshlets.end(), range_meshlets.begin(), range_meshlets.end());
+        }
+        sort(m_meshlets.begin(), m_meshlets.end(), [](const MeshOptimizer::Meshlet& a, const MeshOptimizer::Meshlet& b) { return a.index_offset < b.index_offset; });
+
+        if (reports)
+        {
+            *reports = move(_reports);
+        }
+
+        return range_count;
+    }
+
+    const MeshOptimizer::Meshlet* Mesh::Meshlets_Find(const uint32_t index_offset, const uint32_t index_count, uint32_t* meshlet_count) const
+    {
+        const auto it = lower_bound(m_meshlets.begin(), m_meshlets.end(), index_offset, [](const MeshOptimizer::Meshlet& meshlet, const uint32_t offset) { return meshlet.index_offset < offset; });
+
+        uint32_t count = 0;
+        for (auto it_end = it; it_end != m_meshlets.end() && it_end->index_offset < index_offset + index_count; it_end++)
+        {
+            count++;
+        }
+
+        *meshlet_count = count;
+        return count != 0 ? &(*it) : nullptr;
+    }
 }
@@ -21,13 +21,34 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES =====================
+//= INCLUDES ======================
 #include <vector>
+#include "MeshOptimizer.h"
+#include "Skeleton.h"
 #include "../RHI/RHI_Definition.h"
-//================================
+//=================================
 
 namespace Spartan
 {
+    class Threading;
+
+    // Simplified indices of a range, they reference the same vertices
+    struct Mesh_Lod
+    {
+        uint32_t index_offset   = 0;
+        uint32_t index_count    = 0;
+    };
+
+    // A part of the geometry which is drawn on its own, its indices are relative to its vertex offset
+    struct Mesh_Range
+    {
+        uint32_t index_offset   = 0;
+        uint32_t index_count    = 0;
+        uint32_t vertex_offset  = 0;
+        uint32_t vertex_count   = 0;
+        std::vector<Mesh_Lod> lods;
+    };
+
     class Mesh
     {
     public:
@@ -45,6 +66,7 @@ namespace Spartan
             std::vector<RHI_Vertex_PosTexNorTan>* vertices
         );
         uint32_t GetMemoryUsage() const;
+        void Geometry_Grow(uint32_t indexCount, uint32_t vertexCount, uint32_t* indexOffset, uint32_t* vertexOffset); // the new ranges can then be filled in place (and concurrently)
 
         // Vertices
         void Vertex_Add(const RHI_Vertex_PosTexNorTan& vertex);
@@ -53,12 +75,26 @@ namespace Spartan
         std::vector<RHI_Vertex_PosTexNorTan>& Vertices_Get()                    { return m_vertices; }
         void Vertices_Set(const std::vector<RHI_Vertex_PosTexNorTan>& vertices) { m_vertices = vertices; }
 
+        // Skin, the bone weights of every vertex (empty if the mesh isn't skinned), kept in the same order as the vertices
+        void Skin_Enable()                                      { m_skin.resize(m_vertices.size()); }
+        bool Skin_IsEnabled()                             const { return !m_skin.empty(); }
+        std::vector<BoneWeights>& Skin_Get()                    { return m_skin; }
+
         // Indices
         void Index_Add(uint32_t index)                          { m_indices.emplace_back(index); }
         std::vector<uint32_t>& Indices_Get()                    { return m_indices; }
         void Indices_Set(const std::vector<uint32_t>& indices)  { m_indices = indices; }
         uint32_t Indices_Count() const                          { return static_cast<uint32_t>(m_indices.size()); }
         void Indices_Append(const std::vector<uint32_t>& indices, uint32_t* indexOffset);
+
+        // Optimisation (vertex cache, overdraw and vertex fetch), each range is optimised once
+        void Range_Add(const Mesh_Range& range) { m_ranges_pending.emplace_back(range); }
+        uint32_t Optimize(std::vector<MeshOptimizer::Report>* reports = nullptr, Threading* threading = nullptr);
+
+        // Meshlets, built for every range when it's optimised and sorted by index offset
+        std::vector<MeshOptimizer::Meshlet>& Meshlets_Get()                         { return m_meshlets; }
+        void Meshlets_Set(const std::vector<MeshOptimizer::Meshlet>& meshlets)      { m_meshlets = meshlets; }
+        const MeshOptimizer::Meshlet* Meshlets_Find(uint32_t index_offset, uint32_t index_count, uint32_t* meshlet_count) const;
     
         // Misc
         uint32_t GetTriangleCount() const { return Indices_Count() / 3; }
@@ -66,5 +102,8 @@ namespace Spartan
     private:
         std::vector<RHI_Vertex_PosTexNorTan> m_vertices;
         std::vector<uint32_t> m_indices;
+        std::vector<BoneWeights> m_skin;
+        std::vector<Mesh_Range> m_ranges_pending;
+        std::vector<MeshOptimizer::Meshlet> m_meshlets;
     };
 }
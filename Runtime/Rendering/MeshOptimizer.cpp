@@ -0,0 +1,828 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ==================
+#include "Spartan.h"
+#include "MeshOptimizer.h"
+#include "../RHI/RHI_Vertex.h"
+//=============================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan::MeshOptimizer
+{
+    namespace
+    {
+        // Post-transform cache entries assumed (fifo), conservative for current gpus
+        constexpr uint32_t cache_size           = 16;
+        // Overdraw clusters smaller than this aren't worth splitting for
+        constexpr uint32_t cluster_size_min     = 16;
+        constexpr uint32_t invalid_index        = numeric_limits<uint32_t>::max();
+
+        // A vertex is in the cache if fewer than cache_size misses happened since it was loaded
+        inline bool cache_miss(vector<uint32_t>& timestamps, uint32_t& time, const uint32_t vertex)
+        {
+            if (time - timestamps[vertex] > cache_size)
+            {
+                timestamps[vertex] = time++;
+                return true;
+            }
+
+            return false;
+        }
+
+        inline Vector3 position(const RHI_Vertex_PosTexNorTan& vertex)
+        {
+            return Vector3(vertex.pos[0], vertex.pos[1], vertex.pos[2]);
+        }
+
+        uint32_t skip_dead_end(vector<uint32_t>& dead_end, const vector<uint32_t>& live, uint32_t& cursor, const uint32_t vertex_count)
+        {
+            // Recently used vertices which still have triangles left
+            while (!dead_end.empty())
+            {
+                const uint32_t vertex = dead_end.back();
+                dead_end.pop_back();
+
+                if (live[vertex] > 0)
+                    return vertex;
+            }
+
+            // Otherwise, the next vertex in input order
+            for (; cursor < vertex_count; cursor++)
+            {
+                if (live[cursor] > 0)
+                    return cursor;
+            }
+
+            return invalid_index;
+        }
+
+        // Vertices are welded by their exact position
+        struct PositionKey
+        {
+            uint32_t bits[3];
+            bool operator==(const PositionKey& rhs) const { return bits[0] == rhs.bits[0] && bits[1] == rhs.bits[1] && bits[2] == rhs.bits[2]; }
+        };
+
+        struct PositionKeyHash
+        {
+            size_t operator()(const PositionKey& key) const
+            {
+                return static_cast<size_t>((key.bits[0] * 73856093u) ^ (key.bits[1] * 19349663u) ^ (key.bits[2] * 83492791u));
+            }
+        };
+
+        inline PositionKey position_key(const RHI_Vertex_PosTexNorTan& vertex)
+        {
+            PositionKey key;
+            memcpy(key.bits, vertex.pos, sizeof(key.bits));
+            return key;
+        }
+
+        inline uint64_t edge_key(const uint32_t a, const uint32_t b)
+        {
+            return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+        }
+
+        // Sum of squared distances to a set of planes (Garland and Heckbert 1997), in double precision as the terms cancel out
+        struct Quadric
+        {
+            double a00 = 0.0, a01 = 0.0, a02 = 0.0, a03 = 0.0;
+            double a11 = 0.0, a12 = 0.0, a13 = 0.0;
+            double a22 = 0.0, a23 = 0.0;
+            double a33 = 0.0;
+            double weight = 0.0;
+
+            void Add(const Quadric& q)
+            {
+                a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+                a11 += q.a11; a12 += q.a12; a13 += q.a13;
+                a22 += q.a22; a23 += q.a23;
+                a33 += q.a33;
+                weight += q.weight;
+            }
+
+            double Evaluate(const Vector3& p) const
+            {
+                const double x = p.x, y = p.y, z = p.z;
+                return a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z + a03 * x + a13 * y + a23 * z) + a33;
+            }
+        };
+
+        Quadric quadric_from_triangle(const Vector3& p0, const Vector3& p1, const Vector3& p2)
+        {
+            Quadric q;
+
+            const Vector3 normal = Vector3::Cross(p1 - p0, p2 - p0);
+            const float length   = normal.Length();
+            if (length == 0.0f)
+                return q;
+
+            const double area   = 0.5 * length;
+            const double a      = normal.x / length;
+            const double b      = normal.y / length;
+            const double c      = normal.z / length;
+            const double d      = -(a * p0.x + b * p0.y + c * p0.z);
+
+            q.a00 = area * a * a; q.a01 = area * a * b; q.a02 = area * a * c; q.a03 = area * a * d;
+            q.a11 = area * b * b; q.a12 = area * b * c; q.a13 = area * b * d;
+            q.a22 = area * c * c; q.a23 = area * c * d;
+            q.a33 = area * d * d;
+            q.weight = area;
+
+            return q;
+        }
+
+        // Squared distance the merged vertex would move away from the planes of both neighbourhoods, averaged by area
+        inline double collapse_cost(const Quadric& from, const Quadric& to, const Vector3& position)
+        {
+            const double weight = from.weight + to.weight;
+            return weight > 0.0 ? Helper::Max((from.Evaluate(position) + to.Evaluate(position)) / weight, 0.0) : 0.0;
+        }
+
+        // Moving a vertex must not turn any of its remaining triangles around
+        bool collapse_flips(const uint32_t* indices, const vector<uint32_t>& canonical, const vector<uint32_t>& adjacency, const vector<uint32_t>& adjacency_offsets, const RHI_Vertex_PosTexNorTan* vertices, const uint32_t from, const uint32_t to, const Vector3& position_to)
+        {
+            for (uint32_t j = adjacency_offsets[from]; j < adjacency_offsets[from + 1]; j++)
+            {
+                const uint32_t* triangle = &indices[adjacency[j] * 3];
+
+                // Triangles on the collapsed edge disappear
+                if (canonical[triangle[0]] == to || canonical[triangle[1]] == to || canonical[triangle[2]] == to)
+                    continue;
+
+                Vector3 p[3];
+                Vector3 p_moved[3];
+                for (uint32_t k = 0; k < 3; k++)
+                {
+                    p[k]        = position(vertices[triangle[k]]);
+                    p_moved[k]  = canonical[triangle[k]] == from ? position_to : p[k];
+                }
+
+                const Vector3 normal        = Vector3::Cross(p[1] - p[0], p[2] - p[0]);
+                const Vector3 normal_moved  = Vector3::Cross(p_moved[1] - p_moved[0], p_moved[2] - p_moved[0]);
+
+                if (Vector3::Dot(normal, normal_moved) <= 0.0f)
+                    return true;
+            }
+
+            return false;
+        }
+    }
+
+    Statistics analyze_vertex_cache(const uint32_t* indices, const uint32_t index_count, const uint32_t vertex_count)
+    {
+        Statistics statistics;
+
+        if (index_count < 3)
+            return statistics;
+
+        vector<uint32_t> timestamps(vertex_count, 0);
+        uint32_t time           = cache_size + 1;
+        uint32_t misses         = 0;
+        uint32_t vertices_used  = 0;
+
+        for (uint32_t i = 0; i < index_count; i++)
+        {
+            const bool first_use = timestamps[indices[i]] == 0;
+
+            if (cache_miss(timestamps, time, indices[i]))
+            {
+                misses++;
+                vertices_used += first_use ? 1 : 0;
+            }
+        }
+
+        statistics.acmr = static_cast<float>(misses) / static_cast<float>(index_count / 3);
+        statistics.atvr = static_cast<float>(misses) / static_cast<float>(vertices_used);
+
+        return statistics;
+    }
+
+    void optimize_vertex_cache(uint32_t* indices, const uint32_t index_count, const uint32_t vertex_count)
+    {
+        const uint32_t triangle_count = index_count / 3;
+
+        if (triangle_count == 0)
+            return;
+
+        // Triangles which haven't been emitted yet, per vertex
+        vector<uint32_t> live(vertex_count, 0);
+        for (uint32_t i = 0; i < index_count; i++)
+        {
+            live[indices[i]]++;
+        }
+
+        // Triangles which use each vertex
+        vector<uint32_t> adjacency_offsets(vertex_count + 1, 0);
+        for (uint32_t vertex = 0; vertex < vertex_count; vertex++)
+        {
+            adjacency_offsets[vertex + 1] = adjacency_offsets[vertex] + live[vertex];
+        }
+
+        vector<uint32_t> adjacency(index_count);
+        {
+            vector<uint32_t> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+            for (uint32_t i = 0; i < index_count; i++)
+            {
+                adjacency[fill[indices[i]]++] = i / 3;
+            }
+        }
+
+        vector<uint32_t> timestamps(vertex_count, 0);
+        vector<uint32_t> dead_end;
+        vector<uint32_t> candidates;
+        vector<bool> emitted(triangle_count, false);
+        vector<uint32_t> result(index_count);
+        dead_end.reserve(index_count);
+        candidates.reserve(64);
+
+        uint32_t time           = cache_size + 1;
+        uint32_t cursor         = 0;
+        uint32_t result_count   = 0;
+        uint32_t fan            = skip_dead_end(dead_end, live, cursor, vertex_count);
+
+        while (fan != invalid_index)
+        {
+            // Emit all the remaining triangles around the fanning vertex
+            candidates.clear();
+            for (uint32_t i = adjacency_offsets[fan]; i < adjacency_offsets[fan + 1]; i++)
+            {
+                const uint32_t triangle = adjacency[i];
+
+                if (emitted[triangle])
+                    continue;
+
+                for (uint32_t corner = 0; corner < 3; corner++)
+                {
+                    const uint32_t vertex       = indices[triangle * 3 + corner];
+                    result[result_count++]      = vertex;
+                    live[vertex]--;
+                    dead_end.emplace_back(vertex);
+                    candidates.emplace_back(vertex);
+                    cache_miss(timestamps, time, vertex);
+                }
+
+                emitted[triangle] = true;
+            }
+
+            // Continue with the oldest candidate which will still be in the cache once its own triangles are emitted
+            fan = invalid_index;
+            int32_t priority_best = -1;
+            for (const uint32_t vertex : candidates)
+            {
+                if (live[vertex] == 0)
+                    continue;
+
+                const uint32_t age  = time - timestamps[vertex];
+                int32_t priority    = 0;
+                if (age + 2 * live[vertex] <= cache_size)
+                {
+                    priority = static_cast<int32_t>(age);
+                }
+
+                if (priority > priority_best)
+                {
+                    priority_best   = priority;
+                    fan             = vertex;
+                }
+            }
+
+            if (fan == invalid_index)
+            {
+                fan = skip_dead_end(dead_end, live, cursor, vertex_count);
+            }
+        }
+
+        SP_ASSERT(result_count == triangle_count * 3);
+        copy(result.begin(), result.begin() + result_count, indices);
+    }
+
+    uint32_t optimize_overdraw(uint32_t* indices, const uint32_t index_count, const RHI_Vertex_PosTexNorTan* vertices, const uint32_t vertex_count, const float threshold)
+    {
+        const uint32_t triangle_count = index_count / 3;
+
+        if (triangle_count < cluster_size_min * 2)
+            return 1;
+
+        // Split into clusters, hard boundaries are where the cache was effectively flushed (all three vertices missed), so reordering them costs nothing.
+        // Soft boundaries are placed where the cluster so far is efficient enough that starting the next one with a cold cache stays within the threshold.
+        vector<uint32_t> clusters; // first triangle of each cluster
+        {
+            const float acmr_target = analyze_vertex_cache(indices, index_count, vertex_count).acmr * threshold;
+
+            vector<uint32_t> timestamps(vertex_count, 0);
+            uint32_t time               = cache_size + 1;
+            uint32_t cluster_misses     = 0;
+            uint32_t cluster_triangles  = 0;
+
+            for (uint32_t triangle = 0; triangle < triangle_count; triangle++)
+            {
+                uint32_t misses = 0;
+                misses += cache_miss(timestamps, time, indices[triangle * 3 + 0]) ? 1 : 0;
+                misses += cache_miss(timestamps, time, indices[triangle * 3 + 1]) ? 1 : 0;
+                misses += cache_miss(timestamps, time, indices[triangle * 3 + 2]) ? 1 : 0;
+
+                if (cluster_triangles == 0 || misses == 3)
+                {
+                    clusters.emplace_back(triangle);
+                    cluster_misses      = 0;
+                    cluster_triangles   = 0;
+                }
+
+                cluster_misses      += misses;
+                cluster_triangles   += 1;
+
+                if (cluster_triangles >= cluster_size_min && static_cast<float>(cluster_misses) <= acmr_target * static_cast<float>(cluster_triangles))
+                {
+                    // Start the next triangle with a cold cache, since the clusters will be reordered
+                    time                += cache_size + 1;
+                    cluster_triangles   = 0;
+                }
+            }
+        }
+
+        const uint32_t cluster_count = static_cast<uint32_t>(clusters.size());
+        if (cluster_count < 2)
+            return cluster_count;
+
+        // Area weighted centroid and normal of each cluster and the mesh
+        vector<Vector3> cluster_centroids(cluster_count, Vector3::Zero);
+        vector<Vector3> cluster_normals(cluster_count, Vector3::Zero);
+        Vector3 mesh_centroid   = Vector3::Zero;
+        float mesh_area         = 0.0f;
+        for (uint32_t cluster = 0; cluster < cluster_count; cluster++)
+        {
+            const uint32_t triangle_end = cluster + 1 < cluster_count ? clusters[cluster + 1] : triangle_count;
+            float cluster_area          = 0.0f;
+
+            for (uint32_t triangle = clusters[cluster]; triangle < triangle_end; triangle++)
+            {
+                const Vector3 p0        = position(vertices[indices[triangle * 3 + 0]]);
+                const Vector3 p1        = position(vertices[indices[triangle * 3 + 1]]);
+                const Vector3 p2        = position(vertices[indices[triangle * 3 + 2]]);
+                const Vector3 normal    = Vector3::Cross(p1 - p0, p2 - p0); // clockwise front faces, so this points outwards
+                const float area        = normal.Length();
+                const Vector3 centroid  = (p0 + p1 + p2) / 3.0f;
+
+                cluster_centroids[cluster]  += centroid * area;
+                cluster_normals[cluster]    += normal;
+                cluster_area                += area;
+                mesh_centroid               += centroid * area;
+            }
+
+            cluster_centroids[cluster]  = cluster_area > 0.0f ? cluster_centroids[cluster] / cluster_area : position(vertices[indices[clusters[cluster] * 3]]);
+            mesh_area                   += cluster_area;
+        }
+        mesh_centroid = mesh_area > 0.0f ? mesh_centroid / mesh_area : Vector3::Zero;
+
+        // Clusters which face away from the center are on the outside of the mesh, so they are drawn first
+        vector<float> sort_keys(cluster_count);
+        vector<uint32_t> order(cluster_count);
+        for (uint32_t cluster = 0; cluster < cluster_count; cluster++)
+        {
+            sort_keys[cluster]  = Vector3::Dot(cluster_centroids[cluster] - mesh_centroid, cluster_normals[cluster].Normalized());
+            order[cluster]      = cluster;
+        }
+        stable_sort(order.begin(), order.end(), [&sort_keys](const uint32_t a, const uint32_t b) { return sort_keys[a] > sort_keys[b]; });
+
+        // Emit the clusters in the new order
+        vector<uint32_t> result;
+        result.reserve(index_count);
+        for (const uint32_t cluster : order)
+        {
+            const uint32_t triangle_end = cluster + 1 < cluster_count ? clusters[cluster + 1] : triangle_count;
+            result.insert(result.end(), indices + clusters[cluster] * 3, indices + triangle_end * 3);
+        }
+        copy(result.begin(), result.end(), indices);
+
+        return cluster_count;
+    }
+
+    void optimize_vertex_fetch(uint32_t* indices, const uint32_t index_count, RHI_Vertex_PosTexNorTan* vertices, const uint32_t vertex_count, vector<uint32_t>* vertex_remap /*= nullptr*/)
+    {
+        vector<uint32_t> remap(vertex_count, invalid_index);
+        vector<RHI_Vertex_PosTexNorTan> result;
+        result.reserve(vertex_count);
+
+        for (uint32_t i = 0; i < index_count; i++)
+        {
+            uint32_t& vertex_new = remap[indices[i]];
+
+            if (vertex_new == invalid_index)
+            {
+                vertex_new = static_cast<uint32_t>(result.size());
+                result.emplace_back(vertices[indices[i]]);
+            }
+
+            indices[i] = vertex_new;
+        }
+
+        // Keep the unreferenced vertices, the vertex count of the mesh is fixed
+        for (uint32_t vertex = 0; vertex < vertex_count; vertex++)
+        {
+            if (remap[vertex] == invalid_index)
+            {
+                remap[vertex] = static_cast<uint32_t>(result.size());
+                result.emplace_back(vertices[vertex]);
+            }
+        }
+
+        copy(result.begin(), result.end(), vertices);
+
+        if (vertex_remap)
+        {
+            *vertex_remap = move(remap);
+        }
+    }
+
+    uint32_t build_meshlets(const uint32_t* indices, const uint32_t index_count, const RHI_Vertex_PosTexNorTan* vertices, const uint32_t vertex_count, vector<Meshlet>* meshlets)
+    {
+        if (!indices || !vertices || !meshlets || index_count % 3 != 0)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return 0;
+        }
+
+        const size_t meshlet_count_previous = meshlets->size();
+
+        // Vertices are marked with the meshlet which last used them
+        vector<uint32_t> vertex_meshlet(vertex_count, invalid_index);
+
+        // Bounds of a range of triangles
+        auto compute_bounds = [indices, vertices](Meshlet& meshlet)
+        {
+            const uint32_t* meshlet_indices = indices + meshlet.index_offset;
+
+            // Sphere around the box of the vertices
+            Vector3 box_min = position(vertices[meshlet_indices[0]]);
+            Vector3 box_max = box_min;
+            for (uint32_t i = 1; i < meshlet.index_count; i++)
+            {
+                const Vector3 p = position(vertices[meshlet_indices[i]]);
+                box_min = Vector3(Helper::Min(box_min.x, p.x), Helper::Min(box_min.y, p.y), Helper::Min(box_min.z, p.z));
+                box_max = Vector3(Helper::Max(box_max.x, p.x), Helper::Max(box_max.y, p.y), Helper::Max(box_max.z, p.z));
+            }
+
+            meshlet.center = (box_min + box_max) * 0.5f;
+            meshlet.radius = 0.0f;
+            for (uint32_t i = 0; i < meshlet.index_count; i++)
+            {
+                meshlet.radius = Helper::Max(meshlet.radius, Vector3::Distance(meshlet.center, position(vertices[meshlet_indices[i]])));
+            }
+
+            // Triangle normals, oriented like the vertex normals since the front face winding is up to the rasterizer state
+            Vector3 normals[meshlet_triangle_count_max];
+            Vector3 normal_sum = Vector3::Zero;
+            const uint32_t triangle_count = meshlet.index_count / 3;
+            for (uint32_t i = 0; i < triangle_count; i++)
+            {
+                const RHI_Vertex_PosTexNorTan& v0 = vertices[meshlet_indices[i * 3 + 0]];
+                const RHI_Vertex_PosTexNorTan& v1 = vertices[meshlet_indices[i * 3 + 1]];
+                const RHI_Vertex_PosTexNorTan& v2 = vertices[meshlet_indices[i * 3 + 2]];
+
+                Vector3 normal = Vector3::Cross(position(v1) - position(v0), position(v2) - position(v0));
+                const Vector3 normal_vertices(v0.nor[0] + v1.nor[0] + v2.nor[0], v0.nor[1] + v1.nor[1] + v2.nor[1], v0.nor[2] + v1.nor[2] + v2.nor[2]);
+                normal = Vector3::Dot(normal, normal_vertices) < 0.0f ? normal * -1.0f : normal;
+
+                const float length = normal.Length();
+                normals[i]  = length > 0.0f ? normal / length : Vector3::Zero;
+                normal_sum += normals[i];
+            }
+
+            // Normal cone, the meshlet faces away from any view direction within 90 degrees minus the cone's spread of the axis
+            meshlet.cone_cutoff = 1.0f;
+            const float length  = normal_sum.Length();
+            if (length == 0.0f)
+                return;
+
+            meshlet.cone_axis = normal_sum / length;
+            float dot_min     = 1.0f;
+            for (uint32_t i = 0; i < triangle_count; i++)
+            {
+                dot_min = Helper::Min(dot_min, Vector3::Dot(normals[i], meshlet.cone_axis));
+            }
+
+            // Cones wider than a hemisphere (or close to it) never face away entirely
+            if (dot_min > 0.1f)
+            {
+                meshlet.cone_cutoff = Helper::Sqrt(1.0f - dot_min * dot_min);
+            }
+        };
+
+        // Fill meshlets with triangles until either limit is reached, the order of the triangles is kept
+        Meshlet meshlet;
+        uint32_t meshlet_index        = static_cast<uint32_t>(meshlet_count_previous);
+        uint32_t meshlet_vertex_count = 0;
+        for (uint32_t i = 0; i < index_count; i += 3)
+        {
+            uint32_t vertices_new = 0;
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                vertices_new += vertex_meshlet[indices[i + k]] != meshlet_index ? 1 : 0;
+            }
+
+            if (meshlet_vertex_count + vertices_new > meshlet_vertex_count_max || meshlet.index_count / 3 == meshlet_triangle_count_max)
+            {
+                compute_bounds(meshlet);
+                meshlets->emplace_back(meshlet);
+
+                meshlet.index_offset    = i;
+                meshlet.index_count     = 0;
+                meshlet_vertex_count    = 0;
+                meshlet_index++;
+            }
+
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                uint32_t& vertex_meshlet_index = vertex_meshlet[indices[i + k]];
+                if (vertex_meshlet_index != meshlet_index)
+                {
+                    vertex_meshlet_index = meshlet_index;
+                    meshlet_vertex_count++;
+                }
+            }
+
+            meshlet.index_count += 3;
+        }
+
+        if (meshlet.index_count > 0)
+        {
+            compute_bounds(meshlet);
+            meshlets->emplace_back(meshlet);
+        }
+
+        return static_cast<uint32_t>(meshlets->size() - meshlet_count_previous);
+    }
+
+    uint32_t simplify(uint32_t* destination, const uint32_t* indices, const uint32_t index_count, const RHI_Vertex_PosTexNorTan* vertices, const uint32_t vertex_count, const uint32_t target_index_count, const float target_error, float* result_error /*= nullptr*/)
+    {
+        copy(indices, indices + index_count, destination);
+
+        if (result_error)
+        {
+            *result_error = 0.0f;
+        }
+
+        if (index_count <= target_index_count || index_count % 3 != 0)
+            return index_count;
+
+        // Vertices which only differ in their attributes (uv seams, hard edges) share a canonical vertex
+        vector<uint32_t> canonical(vertex_count);
+        vector<uint32_t> wedge_count(vertex_count, 0);
+        {
+            unordered_map<PositionKey, uint32_t, PositionKeyHash> positions;
+            positions.reserve(vertex_count);
+
+            for (uint32_t vertex = 0; vertex < vertex_count; vertex++)
+            {
+                const PositionKey key = position_key(vertices[vertex]);
+                canonical[vertex]     = positions.emplace(key, vertex).first->second;
+                wedge_count[canonical[vertex]]++;
+            }
+        }
+
+        // Lock vertices which can't move without changing the silhouette or the attributes: seams, borders and non-manifold edges
+        vector<uint8_t> locked(vertex_count, 0);
+        for (uint32_t vertex = 0; vertex < vertex_count; vertex++)
+        {
+            locked[vertex] = wedge_count[canonical[vertex]] > 1 ? 1 : 0;
+        }
+        {
+            unordered_map<uint64_t, uint32_t> edges;
+            edges.reserve(index_count);
+
+            for (uint32_t i = 0; i < index_count; i += 3)
+            {
+                for (uint32_t k = 0; k < 3; k++)
+                {
+                    const uint32_t a = canonical[indices[i + k]];
+                    const uint32_t b = canonical[indices[i + (k + 1) % 3]];
+                    edges[edge_key(a, b)]++;
+                }
+            }
+
+            for (const auto& edge : edges)
+            {
+                if (edge.second != 2)
+                {
+                    locked[static_cast<uint32_t>(edge.first >> 32)]         = 1;
+                    locked[static_cast<uint32_t>(edge.first & 0xffffffff)]  = 1;
+                }
+            }
+        }
+
+        // Error quadrics of the triangle planes around each canonical vertex, weighted by area
+        vector<Quadric> quadrics(vertex_count);
+        Vector3 extent_min = Vector3(numeric_limits<float>::max());
+        Vector3 extent_max = Vector3(numeric_limits<float>::lowest());
+        for (uint32_t i = 0; i < index_count; i += 3)
+        {
+            const Vector3 p0 = position(vertices[indices[i + 0]]);
+            const Vector3 p1 = position(vertices[indices[i + 1]]);
+            const Vector3 p2 = position(vertices[indices[i + 2]]);
+
+            const Quadric quadric = quadric_from_triangle(p0, p1, p2);
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                quadrics[canonical[indices[i + k]]].Add(quadric);
+            }
+
+            for (const Vector3& p : { p0, p1, p2 })
+            {
+                extent_min = Vector3(Helper::Min(extent_min.x, p.x), Helper::Min(extent_min.y, p.y), Helper::Min(extent_min.z, p.z));
+                extent_max = Vector3(Helper::Max(extent_max.x, p.x), Helper::Max(extent_max.y, p.y), Helper::Max(extent_max.z, p.z));
+            }
+        }
+
+        // The error is a distance relative to the mesh extent, the quadrics measure squared distances
+        const Vector3 extent    = extent_max - extent_min;
+        const float scale       = Helper::Max3(extent.x, extent.y, extent.z);
+        const double error_max  = static_cast<double>(target_error) * scale * target_error * scale;
+        double error_reached    = 0.0;
+
+        struct Collapse
+        {
+            uint32_t from;
+            uint32_t to;
+            double cost;
+        };
+
+        vector<Collapse> collapses;
+        vector<uint32_t> remap(vertex_count);
+        vector<uint8_t> touched(vertex_count);
+        vector<uint32_t> adjacency_offsets(vertex_count + 1);
+        vector<uint32_t> adjacency;
+
+        uint32_t count = index_count;
+        while (count > target_index_count)
+        {
+            // Triangles around each canonical vertex
+            fill(adjacency_offsets.begin(), adjacency_offsets.end(), 0);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                adjacency_offsets[canonical[destination[i]] + 1]++;
+            }
+            for (uint32_t vertex = 0; vertex < vertex_count; vertex++)
+            {
+                adjacency_offsets[vertex + 1] += adjacency_offsets[vertex];
+            }
+            adjacency.resize(count);
+            {
+                vector<uint32_t> cursor(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    adjacency[cursor[canonical[destination[i]]]++] = i / 3;
+                }
+            }
+
+            // Candidates, every edge in both directions. The target keeps the wedge of the triangle the edge came from.
+            collapses.clear();
+            for (uint32_t i = 0; i < count; i += 3)
+            {
+                for (uint32_t k = 0; k < 3; k++)
+                {
+                    const uint32_t a = destination[i + k];
+                    const uint32_t b = destination[i + (k + 1) % 3];
+
+                    if (!locked[a])
+                    {
+                        collapses.push_back({ a, b, collapse_cost(quadrics[canonical[a]], quadrics[canonical[b]], position(vertices[b])) });
+                    }
+
+                    if (!locked[b])
+                    {
+                        collapses.push_back({ b, a, collapse_cost(quadrics[canonical[b]], quadrics[canonical[a]], position(vertices[a])) });
+                    }
+                }
+            }
+            sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+            // Collapse the cheapest edges, a vertex (and its neighbourhood) can only change once per pass, so the flip tests stay valid.
+            // Every collapse removes about two triangles.
+            const uint32_t collapse_budget = (count - target_index_count) / 6 + 1;
+            uint32_t collapse_count        = 0;
+
+            for (uint32_t vertex = 0; vertex < vertex_count; vertex++)
+            {
+                remap[vertex] = vertex;
+            }
+            fill(touched.begin(), touched.end(), static_cast<uint8_t>(0));
+
+            for (const Collapse& collapse : collapses)
+            {
+                if (collapse_count >= collapse_budget || collapse.cost > error_max)
+                    break;
+
+                // Unlocked vertices have a single wedge, so they are their own canonical vertex
+                const uint32_t from = collapse.from;
+                const uint32_t to   = canonical[collapse.to];
+
+                if (from == to || touched[from] || touched[to])
+                    continue;
+
+                if (collapse_flips(destination, canonical, adjacency, adjacency_offsets, vertices, from, to, position(vertices[collapse.to])))
+                    continue;
+
+                remap[from] = collapse.to;
+                quadrics[to].Add(quadrics[from]);
+                error_reached = Helper::Max(error_reached, collapse.cost);
+
+                for (uint32_t j = adjacency_offsets[from]; j < adjacency_offsets[from + 1]; j++)
+                {
+                    const uint32_t triangle = adjacency[j];
+                    for (uint32_t k = 0; k < 3; k++)
+                    {
+                        touched[canonical[destination[triangle * 3 + k]]] = 1;
+                    }
+                }
+
+                collapse_count++;
+            }
+
+            if (collapse_count == 0)
+                break;
+
+            // Apply the collapses and drop the triangles which became degenerate
+            uint32_t write = 0;
+            for (uint32_t i = 0; i < count; i += 3)
+            {
+                const uint32_t a = remap[destination[i + 0]];
+                const uint32_t b = remap[destination[i + 1]];
+                const uint32_t c = remap[destination[i + 2]];
+
+                if (canonical[a] == canonical[b] || canonical[b] == canonical[c] || canonical[a] == canonical[c])
+                    continue;
+
+                destination[write++] = a;
+                destination[write++] = b;
+                destination[write++] = c;
+            }
+            count = write;
+        }
+
+        if (result_error)
+        {
+            *result_error = scale > 0.0f ? static_cast<float>(sqrt(error_reached)) / scale : 0.0f;
+        }
+
+        return count;
+    }
+
+    bool optimize(uint32_t* indices, const uint32_t index_count, RHI_Vertex_PosTexNorTan* vertices, const uint32_t vertex_count, Report* report /*= nullptr*/, vector<uint32_t>* vertex_remap /*= nullptr*/)
+    {
+        if (!indices || !vertices || index_count % 3 != 0)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return false;
+        }
+
+        for (uint32_t i = 0; i < index_count; i++)
+        {
+            if (indices[i] >= vertex_count)
+            {
+                LOG_ERROR("Index %u is out of range, the mesh has %u vertices", indices[i], vertex_count);
+                return false;
+            }
+        }
+
+        const Statistics before = analyze_vertex_cache(indices, index_count, vertex_count);
+
+        optimize_vertex_cache(indices, index_count, vertex_count);
+        const uint32_t cluster_count = optimize_overdraw(indices, index_count, vertices, vertex_count);
+        optimize_vertex_fetch(indices, index_count, vertices, vertex_count, vertex_remap);
+
+        if (report)
+        {
+            report->before          = before;
+            report->after           = analyze_vertex_cache(indices, index_count, vertex_count);
+            report->triangle_count  = index_count / 3;
+            report->cluster_count   = cluster_count;
+        }
+
+        return true;
+    }
+}
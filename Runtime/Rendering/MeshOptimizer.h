@@ -0,0 +1,87 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES ============================
+#include <vector>
+#include "../Core/Spartan_Definitions.h"
+#include "../RHI/RHI_Definition.h"
+#include "../Math/Vector3.h"
+//=======================================
+
+namespace Spartan::MeshOptimizer
+{
+    struct Statistics
+    {
+        float acmr = 0.0f; // average cache miss ratio, vertex transforms per triangle (0.5 is ideal for a regular grid, 3.0 is the worst)
+        float atvr = 0.0f; // average transform to vertex ratio, vertex transforms per referenced vertex (1.0 is ideal)
+    };
+
+    struct Report
+    {
+        Statistics before;
+        Statistics after;
+        uint32_t triangle_count = 0;
+        uint32_t cluster_count  = 0;
+    };
+
+    // Meshlet limits, small enough for a mesh shader workgroup
+    constexpr uint32_t meshlet_vertex_count_max     = 64;
+    constexpr uint32_t meshlet_triangle_count_max   = 124;
+
+    // A contiguous range of triangles, culled as a whole
+    struct Meshlet
+    {
+        uint32_t index_offset   = 0;
+        uint32_t index_count    = 0;
+        Math::Vector3 center    = Math::Vector3::Zero;   // bounding sphere
+        float radius            = 0.0f;
+        Math::Vector3 cone_axis = Math::Vector3::Zero;   // average normal
+        float cone_cutoff       = 1.0f;                  // sine of the normal cone's spread, 1.0 means it can't be back-face culled
+    };
+
+    // Simulates a fifo post-transform cache of the size the optimiser targets
+    Statistics analyze_vertex_cache(const uint32_t* indices, uint32_t index_count, uint32_t vertex_count);
+
+    // Reorders triangles for vertex cache locality (Tipsify, Sander et al. 2007)
+    void optimize_vertex_cache(uint32_t* indices, uint32_t index_count, uint32_t vertex_count);
+
+    // Splits the (cache optimised) triangle order into clusters and draws the clusters which face away from the mesh center first, so they occlude the rest.
+    // A cluster is only split where its cache efficiency stays within the threshold of the mesh, returns the cluster count.
+    uint32_t optimize_overdraw(uint32_t* indices, uint32_t index_count, const RHI_Vertex_PosTexNorTan* vertices, uint32_t vertex_count, float threshold = 1.05f);
+
+    // Reorders the vertices in the order they are first referenced, unreferenced vertices are moved to the end.
+    // The optional remap (old vertex to new vertex) can be used to update other index buffers of the same vertices.
+    void optimize_vertex_fetch(uint32_t* indices, uint32_t index_count, RHI_Vertex_PosTexNorTan* vertices, uint32_t vertex_count, std::vector<uint32_t>* vertex_remap = nullptr);
+
+    // Runs all of the above on a mesh whose indices are relative to its first vertex
+    bool optimize(uint32_t* indices, uint32_t index_count, RHI_Vertex_PosTexNorTan* vertices, uint32_t vertex_count, Report* report = nullptr, std::vector<uint32_t>* vertex_remap = nullptr);
+
+    // Splits the triangles into meshlets in their current order, so run it after the optimisations above. Offsets are relative to the indices passed in.
+    uint32_t build_meshlets(const uint32_t* indices, uint32_t index_count, const RHI_Vertex_PosTexNorTan* vertices, uint32_t vertex_count, std::vector<Meshlet>* meshlets);
+
+    // Simplifies a mesh with quadric error metrics (Garland and Heckbert 1997) by collapsing edges onto existing vertices, so the result indexes the same vertices.
+    // Borders, uv seams and hard edges are kept in place. Stops at the target index count or before the error, relative to the mesh extent, would exceed target_error.
+    // Returns the index count written to destination (which needs room for index_count indices).
+    uint32_t simplify(uint32_t* destination, const uint32_t* indices, uint32_t index_count, const RHI_Vertex_PosTexNorTan* vertices, uint32_t vertex_count, uint32_t target_index_count, float target_error, float* result_error = nullptr);
+}
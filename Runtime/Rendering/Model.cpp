@@ -19,13 +19,15 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES ================================
+//= INCLUDES =================================
 #include "Spartan.h"
 #include "Model.h"
 #include "Mesh.h"
+#include "Animation.h"
 #include "Renderer.h"
 #include "../IO/FileStream.h"
 #include "../Core/Stopwatch.h"
+#include "../Threading/Threading.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/Import/ModelImporter.h"
 #include "../World/Entity.h"
@@ -35,7 +37,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI/RHI_IndexBuffer.h"
 #include "../RHI/RHI_Texture2D.h"
 #include "../RHI/RHI_Vertex.h"
-//===========================================
+//============================================
 
 //= NAMESPACES ================
 using namespace std;
@@ -44,6 +46,11 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+    // Files start with the magic and the version, older ones (version 0) start with the length of the resource path, which is never the magic.
+    // Version 1 added the meshlets, the skin, the skeleton and the animations (and the levels of detail at the end of the indices).
+    static const uint32_t model_magic   = 0x53504D44; // SPMD
+    static const uint32_t model_version = 1;
+
     Model::Model(Context* context) : IResource(context, ResourceType::Model)
     {
         m_resource_manager    = m_context->GetSubsystem<ResourceCache>();
@@ -60,8 +67,14 @@ namespace Spartan
     {
         m_root_entity.reset();
         m_vertex_buffer.reset();
+        m_vertex_buffer_position.reset();
+        m_vertex_buffer_skin.reset();
+        m_vertex_buffer_position_skin.reset();
+        m_vertex_transform = Matrix::Identity;
         m_index_buffer.reset();
         m_mesh->Clear();
+        m_skeleton.Clear();
+        m_animations.clear();
         m_aabb.Undefine();
         m_normalized_scale = 1.0f;
         m_is_animated = false;
@@ -85,11 +98,71 @@ namespace Spartan
             if (!file->IsOpen())
                 return false;
 
-            SetResourceFilePath(file->ReadAs<string>());
+            uint32_t version    = 0;
+            string resource_file_path;
+            const uint32_t tag  = file->ReadAs<uint32_t>();
+            if (tag == model_magic)
+            {
+                version = file->ReadAs<uint32_t>();
+                file->Read(&resource_file_path);
+            }
+            else if (tag <= file->GetRemaining())
+            {
+                resource_file_path.resize(tag);
+                for (char& c : resource_file_path)
+                {
+                    c = static_cast<char>(file->ReadAs<unsigned char>());
+                }
+            }
+
+            if (version > model_version)
+            {
+                LOG_WARNING("\"%s\" was saved by a newer version (%d), it may not load correctly", file_path.c_str(), version);
+            }
+
+            SetResourceFilePath(resource_file_path);
             file->Read(&m_normalized_scale);
             file->Read(&m_mesh->Indices_Get());
             file->Read(&m_mesh->Vertices_Get());
 
+            if (version >= 1)
+            {
+                vector<MeshOptimizer::Meshlet>& meshlets = m_mesh->Meshlets_Get();
+                meshlets.resize(file->ReadAs<uint32_t>());
+                for (MeshOptimizer::Meshlet& meshlet : meshlets)
+                {
+                    file->Read(&meshlet.index_offset);
+                    file->Read(&meshlet.index_count);
+                    file->Read(&meshlet.center);
+                    file->Read(&meshlet.radius);
+                    file->Read(&meshlet.cone_axis);
+                    file->Read(&meshlet.cone_cutoff);
+                }
+
+                // Skin, skeleton and animations
+                vector<unsigned char> skin;
+                file->Read(&skin);
+                if (!skin.empty())
+                {
+                    m_mesh->Skin_Enable();
+                    memcpy(m_mesh->Skin_Get().data(), skin.data(), Helper::Min(skin.size(), m_mesh->Skin_Get().size() * sizeof(BoneWeights)));
+                }
+                m_skeleton.Deserialize(file.get());
+                m_animations.resize(file->ReadAs<uint32_t>());
+                for (shared_ptr<Animation>& animation : m_animations)
+                {
+                    animation = make_shared<Animation>(m_context);
+                    animation->Deserialize(file.get());
+                }
+            }
+            m_is_animated = !m_skeleton.IsEmpty();
+
+            if (!file->IsGood())
+            {
+                LOG_ERROR("\"%s\" is corrupt", file_path.c_str());
+                return false;
+            }
+
             UpdateGeometry();
         }
         // Load foreign format
@@ -110,19 +183,6 @@ namespace Spartan
             }
         }
 
-        // Compute memory usage
-        {
-            // Cpu
-            m_size_cpu = !m_mesh ? 0 : m_mesh->GetMemoryUsage();
-
-            // Gpu
-            if (m_vertex_buffer && m_index_buffer)
-            {
-                m_size_gpu = m_vertex_buffer->GetSizeGpu();
-                m_size_gpu += m_index_buffer->GetSizeGpu();
-            }
-        }
-
         LOG_INFO("Loading \"%s\" took %d ms", FileSystem::GetFileNameFromFilePath(file_path).c_str(), static_cast<int>(timer.GetElapsedTimeMs()));
 
         return true;
@@ -134,10 +194,37 @@ namespace Spartan
         if (!file->IsOpen())
             return false;
 
+        file->Write(model_magic);
+        file->Write(model_version);
         file->Write(GetResourceFilePath());
         file->Write(m_normalized_scale);
         file->Write(m_mesh->Indices_Get());
         file->Write(m_mesh->Vertices_Get());
+        const vector<MeshOptimizer::Meshlet>& meshlets = m_mesh->Meshlets_Get();
+        file->Write(static_cast<uint32_t>(meshlets.size()));
+        for (const MeshOptimizer::Meshlet& meshlet : meshlets)
+        {
+            file->Write(meshlet.index_offset);
+            file->Write(meshlet.index_count);
+            file->Write(meshlet.center);
+            file->Write(meshlet.radius);
+            file->Write(meshlet.cone_axis);
+            file->Write(meshlet.cone_cutoff);
+        }
+
+        // Skin, skeleton and animations
+        vector<unsigned char> skin(m_mesh->Skin_Get().size() * sizeof(BoneWeights));
+        if (!skin.empty())
+        {
+            memcpy(skin.data(), m_mesh->Skin_Get().data(), skin.size());
+        }
+        file->Write(skin);
+        m_skeleton.Serialize(file.get());
+        file->Write(static_cast<uint32_t>(m_animations.size()));
+        for (const shared_ptr<Animation>& animation : m_animations)
+        {
+            animation->Serialize(file.get());
+        }
 
         file->Close();
 
@@ -153,8 +240,24 @@ namespace Spartan
         }
 
         // Append indices and vertices to the main mesh
-        m_mesh->Indices_Append(indices, index_offset);
-        m_mesh->Vertices_Append(vertices, vertex_offset);
+        Mesh_Range range;
+        range.index_count   = static_cast<uint32_t>(indices.size());
+        range.vertex_count  = static_cast<uint32_t>(vertices.size());
+        m_mesh->Indices_Append(indices, &range.index_offset);
+        m_mesh->Vertices_Append(vertices, &range.vertex_offset);
+
+        // Optimised when the geometry is updated
+        m_mesh->Range_Add(range);
+
+        if (index_offset)
+        {
+            *index_offset = range.index_offset;
+        }
+
+        if (vertex_offset)
+        {
+            *vertex_offset = range.vertex_offset;
+        }
     }
 
     void Model::GetGeometry(const uint32_t index_offset, const uint32_t index_count, const uint32_t vertex_offset, const uint32_t vertex_count, vector<uint32_t>* indices, vector<RHI_Vertex_PosTexNorTan>* vertices) const
@@ -170,9 +273,24 @@ namespace Spartan
             return;
         }
 
+        GeometryOptimize();
+        m_aabb                = BoundingBox(m_mesh->Vertices_Get().data(), static_cast<uint32_t>(m_mesh->Vertices_Get().size()));
         GeometryCreateBuffers();
         m_normalized_scale    = GeometryComputeNormalizedScale();
-        m_aabb                = BoundingBox(m_mesh->Vertices_Get().data(), static_cast<uint32_t>(m_mesh->Vertices_Get().size()));
+
+        // Compute memory usage
+        {
+            // Cpu
+            m_size_cpu = !m_mesh ? 0 : m_mesh->GetMemoryUsage();
+
+            // Gpu
+            m_size_gpu = 0;
+            m_size_gpu += m_vertex_buffer          ? m_vertex_buffer->GetSizeGpu()          : 0;
+            m_size_gpu += m_vertex_buffer_position ? m_vertex_buffer_position->GetSizeGpu() : 0;
+            m_size_gpu += m_vertex_buffer_skin     ? m_vertex_buffer_skin->GetSizeGpu()     : 0;
+            m_size_gpu += m_vertex_buffer_position_skin ? m_vertex_buffer_position_skin->GetSizeGpu() : 0;
+            m_size_gpu += m_index_buffer           ? m_index_buffer->GetSizeGpu()           : 0;
+        }
     }
 
     void Model::AddMaterial(shared_ptr<Material>& material, const shared_ptr<Entity>& entity) const
@@ -218,13 +336,38 @@ namespace Spartan
         }
     }
 
+    void Model::GeometryOptimize() const
+    {
+        const Stopwatch timer;
+
+        vector<MeshOptimizer::Report> reports;
+        if (m_mesh->Optimize(&reports, m_context->GetSubsystem<Threading>()) == 0)
+            return;
+
+        const uint32_t mesh_count = static_cast<uint32_t>(reports.size());
+        for (uint32_t i = 0; i < mesh_count; i++)
+        {
+            const MeshOptimizer::Report& report = reports[i];
+
+            if (report.triangle_count == 0)
+                continue;
+
+            LOG_INFO("\"%s\" mesh %u/%u: %u triangles, %u clusters, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+                GetResourceName().c_str(), i + 1, mesh_count, report.triangle_count, report.cluster_count,
+                report.before.acmr, report.after.acmr, report.before.atvr, report.after.atvr
+            );
+        }
+
+        LOG_INFO("Optimising %u meshes took %.2f ms, %u meshlets", mesh_count, timer.GetElapsedTimeMs(), static_cast<uint32_t>(m_mesh->Meshlets_Get().size()));
+    }
+
     bool Model::GeometryCreateBuffers()
     {
         auto success = true;
 
         // Get geometry
-        const auto indices    = m_mesh->Indices_Get();
-        const auto vertices    = m_mesh->Vertices_Get();
+        const auto& indices     = m_mesh->Indices_Get();
+        const auto& vertices    = m_mesh->Vertices_Get();
 
         if (!indices.empty())
         {
@@ -243,12 +386,65 @@ namespace Spartan
 
         if (!vertices.empty())
         {
+            // Positions are packed relative to the bounds, the scale is uniform so that normals can be transformed by the same matrix
+            const Vector3 center        = m_aabb.GetCenter();
+            const Vector3 extents       = m_aabb.GetExtents();
+            const float scale           = Helper::Max(Helper::Max3(extents.x, extents.y, extents.z), Helper::EPSILON);
+            const float scale_inverse   = 1.0f / scale;
+            m_vertex_transform          = Matrix(center, Quaternion::Identity, Vector3(scale));
+
+            vector<RHI_Vertex_PosTexNorTan_Packed> vertices_packed;
+            vector<RHI_Vertex_Pos_Packed> vertices_position;
+            vertices_packed.reserve(vertices.size());
+            vertices_position.reserve(vertices.size());
+            for (const RHI_Vertex_PosTexNorTan& vertex : vertices)
+            {
+                vertices_packed.emplace_back(vertex, center, scale_inverse);
+                vertices_position.emplace_back(vertex, center, scale_inverse);
+            }
+
             m_vertex_buffer = make_shared<RHI_VertexBuffer>(m_rhi_device);
-            if (!m_vertex_buffer->Create(vertices))
+            if (!m_vertex_buffer->Create(vertices_packed))
             {
                 LOG_ERROR("Failed to create vertex buffer for \"%s\".", GetResourceName().c_str());
                 success = false;
             }
+
+            // Depth only passes read just the positions
+            m_vertex_buffer_position = make_shared<RHI_VertexBuffer>(m_rhi_device);
+            if (!m_vertex_buffer_position->Create(vertices_position))
+            {
+                LOG_ERROR("Failed to create position vertex buffer for \"%s\".", GetResourceName().c_str());
+                success = false;
+            }
+
+            // Skinned meshes also get both layouts with the bones and weights of every vertex, so they can be skinned by the vertex shaders
+            const vector<BoneWeights>& skin = m_mesh->Skin_Get();
+            if (skin.size() == vertices.size())
+            {
+                vector<RHI_Vertex_PosTexNorTanSkin_Packed> vertices_skin;
+                vector<RHI_Vertex_PosSkin_Packed> vertices_position_skin;
+                vertices_skin.reserve(vertices.size());
+                vertices_position_skin.reserve(vertices.size());
+                for (uint32_t i = 0; i < static_cast<uint32_t>(vertices.size()); i++)
+                {
+                    vertices_skin.emplace_back(vertices[i], center, scale_inverse, skin[i].bones, skin[i].weights);
+                    vertices_position_skin.emplace_back(vertices[i], center, scale_inverse, skin[i].bones, skin[i].weights);
+                }
+
+                m_vertex_buffer_skin            = make_shared<RHI_VertexBuffer>(m_rhi_device);
+                m_vertex_buffer_position_skin   = make_shared<RHI_VertexBuffer>(m_rhi_device);
+                if (!m_vertex_buffer_skin->Create(vertices_skin) || !m_vertex_buffer_position_skin->Create(vertices_position_skin))
+                {
+                    LOG_ERROR("Failed to create skinned vertex buffers for \"%s\".", GetResourceName().c_str());
+                    m_vertex_buffer_skin.reset();
+                    m_vertex_buffer_position_skin.reset();
+                }
+            }
+
+            const float size_unpacked   = static_cast<float>(vertices.size() * sizeof(RHI_Vertex_PosTexNorTan)) / 1024.0f;
+            const float size_packed     = static_cast<float>(vertices.size() * (sizeof(RHI_Vertex_PosTexNorTan_Packed) + sizeof(RHI_Vertex_Pos_Packed))) / 1024.0f;
+            LOG_INFO("\"%s\" vertex buffers: %.1f KB packed (with the position stream), %.1f KB unpacked", GetResourceName().c_str(), size_packed, size_unpacked);
         }
         else
         {
@@ -21,20 +21,23 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES =====================
+//= INCLUDES ======================
 #include <memory>
 #include <vector>
 #include "Material.h"
+#include "Skeleton.h"
 #include "../RHI/RHI_Definition.h"
 #include "../Resource/IResource.h"
 #include "../Math/BoundingBox.h"
-//================================
+#include "../Math/Matrix.h"
+//=================================
 
 namespace Spartan
 {
     class ResourceCache;
     class Entity;
     class Mesh;
+    class Animation;
     namespace Math{ class BoundingBox; }
 
     class SPARTAN_CLASS Model : public IResource, public std::enable_shared_from_this<Model>
@@ -74,23 +77,39 @@ namespace Spartan
         void AddMaterial(std::shared_ptr<Material>& material, const std::shared_ptr<Entity>& entity) const;
         void AddTexture(std::shared_ptr<Material>& material, Material_Property texture_type, const std::string& file_path);
 
+        // Animation, the skeleton is shared by the skinned meshes of the model
+        Skeleton& GetSkeleton()                                             { return m_skeleton; }
+        void AddAnimation(const std::shared_ptr<Animation>& animation)      { m_animations.emplace_back(animation); }
+        const std::vector<std::shared_ptr<Animation>>& GetAnimations() const { return m_animations; }
+
         // Misc
         bool IsAnimated()                           const { return m_is_animated; }
         void SetAnimated(const bool is_animated)          { m_is_animated = is_animated; }
         const RHI_IndexBuffer* GetIndexBuffer()     const { return m_index_buffer.get(); }
         const RHI_VertexBuffer* GetVertexBuffer()   const { return m_vertex_buffer.get(); }
+        const RHI_VertexBuffer* GetVertexBufferPosition() const { return m_vertex_buffer_position.get(); }
+        const RHI_VertexBuffer* GetVertexBufferSkin()   const { return m_vertex_buffer_skin.get(); }          // skinned meshes only, for skinning in the vertex shaders
+        const RHI_VertexBuffer* GetVertexBufferPositionSkin() const { return m_vertex_buffer_position_skin.get(); }
+        const Math::Matrix& GetVertexTransform()    const { return m_vertex_transform; } // packed positions to model space, prepended to the world transform when drawing
         auto GetSharedPtr()                                  { return shared_from_this(); }
 
     private:
         // Geometry
+        void GeometryOptimize() const;
         bool GeometryCreateBuffers();
         float GeometryComputeNormalizedScale() const;
 
         // Misc
         std::weak_ptr<Entity> m_root_entity;
         std::shared_ptr<RHI_VertexBuffer> m_vertex_buffer;
+        std::shared_ptr<RHI_VertexBuffer> m_vertex_buffer_position;
+        std::shared_ptr<RHI_VertexBuffer> m_vertex_buffer_skin;
+        std::shared_ptr<RHI_VertexBuffer> m_vertex_buffer_position_skin;
+        Math::Matrix m_vertex_transform = Math::Matrix::Identity;
         std::shared_ptr<RHI_IndexBuffer> m_index_buffer;
         std::shared_ptr<Mesh> m_mesh;
+        Skeleton m_skeleton;
+        std::vector<std::shared_ptr<Animation>> m_animations;
         Math::BoundingBox m_aabb;
         float m_normalized_scale    = 1.0f;
         bool m_is_animated            = false;
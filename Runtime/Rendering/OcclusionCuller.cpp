@@ -0,0 +1,395 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =========================
+#include "Spartan.h"
+#include "OcclusionCuller.h"
+#include "../RHI/RHI_Vertex.h"
+#include "../Threading/Threading.h"
+#include <emmintrin.h>
+//====================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan::Math;
+//============================
+
+namespace Spartan
+{
+    OcclusionCuller::OcclusionCuller(Context* context, uint32_t width /*= 256*/, uint32_t height /*= 128*/)
+    {
+        // The rasteriser processes 4 pixels at a time
+        m_width     = Helper::Max<uint32_t>((width + 3) & ~3u, 4);
+        m_height    = Helper::Max<uint32_t>(height, 1);
+        m_depth     = vector<float>(m_width * m_height, 0.0f);
+
+        // Allocate the hierarchical depth, down to 1x1
+        uint32_t mip_width  = m_width;
+        uint32_t mip_height = m_height;
+        while (mip_width > 1 || mip_height > 1)
+        {
+            mip_width   = Helper::Max<uint32_t>(mip_width / 2, 1);
+            mip_height  = Helper::Max<uint32_t>(mip_height / 2, 1);
+            m_depth_mips.emplace_back(mip_width * mip_height, 0.0f);
+        }
+
+        // Without a context (e.g. headless tests), everything runs on the calling thread
+        m_threading = context ? context->GetSubsystem<Threading>() : nullptr;
+    }
+
+    void OcclusionCuller::Begin(const Matrix& view_projection, const bool reverse_z)
+    {
+        m_view_projection   = view_projection;
+        m_reverse_z         = reverse_z;
+        m_triangle_count    = 0;
+        m_tested            = 0;
+        m_occluded          = 0;
+
+        m_occluders.clear();
+        fill(m_depth.begin(), m_depth.end(), 0.0f);
+    }
+
+    bool OcclusionCuller::AddOccluder(const vector<RHI_Vertex_PosTexNorTan>& vertices, const vector<uint32_t>& indices, uint32_t index_offset, uint32_t index_count, uint32_t vertex_offset, const Matrix& transform)
+    {
+        if (m_triangle_count >= m_triangle_budget)
+            return false;
+
+        if (index_count < 3 || index_offset + index_count > indices.size() || vertex_offset >= vertices.size())
+            return true;
+
+        Occluder& occluder       = m_occluders.emplace_back();
+        occluder.vertices        = vertices.data() + vertex_offset;
+        occluder.indices         = indices.data() + index_offset;
+        occluder.index_count     = index_count - (index_count % 3);
+        occluder.triangle_offset = m_triangle_count;
+        occluder.transform       = transform * m_view_projection;
+
+        m_triangle_count += occluder.index_count / 3;
+
+        return true;
+    }
+
+    void OcclusionCuller::End()
+    {
+        // Every occluder writes into its own pre-reserved range of triangles
+        m_triangles.resize(m_triangle_count);
+
+        const uint32_t occluder_count   = static_cast<uint32_t>(m_occluders.size());
+        const uint32_t band_count       = (m_height + m_band_rows - 1) / m_band_rows;
+
+        if (m_threading && occluder_count > 1)
+        {
+            m_threading->AddTaskLoop([this](uint32_t start, uint32_t end) { SetupTriangles(start, end); }, occluder_count);
+        }
+        else
+        {
+            SetupTriangles(0, occluder_count);
+        }
+
+        // Each band of rows is owned by a single thread, so no synchronisation is needed when writing depth
+        if (m_threading && m_triangle_count != 0)
+        {
+            m_threading->AddTaskLoop([this](uint32_t start, uint32_t end) { RasterizeRows(start, end); }, band_count);
+        }
+        else
+        {
+            RasterizeRows(0, band_count);
+        }
+
+        BuildHierarchicalDepth();
+    }
+
+    void OcclusionCuller::SetupTriangles(uint32_t occluder_start, uint32_t occluder_end)
+    {
+        const float width   = static_cast<float>(m_width);
+        const float height  = static_cast<float>(m_height);
+
+        for (uint32_t occluder_index = occluder_start; occluder_index < occluder_end; occluder_index++)
+        {
+            const Occluder& occluder = m_occluders[occluder_index];
+
+            for (uint32_t i = 0; i < occluder.index_count; i += 3)
+            {
+                Triangle& triangle  = m_triangles[occluder.triangle_offset + i / 3];
+                triangle.valid      = false;
+
+                // Transform to screen space
+                float x[3], y[3], d[3];
+                bool clipped = false;
+                for (uint32_t v = 0; v < 3; v++)
+                {
+                    const float* position   = occluder.vertices[occluder.indices[i + v]].pos;
+                    const Vector4 clip      = Vector4(position[0], position[1], position[2], 1.0f) * occluder.transform;
+
+                    // Triangles which cross the near plane are dropped, they can only make culling less aggressive
+                    if (clip.w <= Helper::EPSILON)
+                    {
+                        clipped = true;
+                        break;
+                    }
+
+                    const float w_inv   = 1.0f / clip.w;
+                    const float z       = clip.z * w_inv;
+                    d[v]                = m_reverse_z ? z : 1.0f - z;
+                    x[v]                = (clip.x * w_inv * 0.5f + 0.5f) * width;
+                    y[v]                = (clip.y * w_inv * -0.5f + 0.5f) * height;
+
+                    if (d[v] > 1.0f)
+                    {
+                        clipped = true;
+                        break;
+                    }
+                }
+
+                if (clipped)
+                    continue;
+
+                // Make the winding consistent, so both front and back faces rasterise
+                float area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+                if (area < 0.0f)
+                {
+                    swap(x[1], x[2]);
+                    swap(y[1], y[2]);
+                    swap(d[1], d[2]);
+                    area = -area;
+                }
+
+                if (area <= Helper::EPSILON)
+                    continue;
+
+                // Pixel bounds (clamped before the integer conversion, vertices can project far outside of the screen)
+                triangle.x_min = static_cast<int32_t>(floor(Helper::Clamp(Helper::Min3(x[0], x[1], x[2]), -1.0f, width)));
+                triangle.y_min = static_cast<int32_t>(floor(Helper::Clamp(Helper::Min3(y[0], y[1], y[2]), -1.0f, height)));
+                triangle.x_max = static_cast<int32_t>(ceil(Helper::Clamp(Helper::Max3(x[0], x[1], x[2]), -1.0f, width)));
+                triangle.y_max = static_cast<int32_t>(ceil(Helper::Clamp(Helper::Max3(y[0], y[1], y[2]), -1.0f, height)));
+                triangle.x_min = Helper::Max(triangle.x_min, 0);
+                triangle.y_min = Helper::Max(triangle.y_min, 0);
+                triangle.x_max = Helper::Min(triangle.x_max, static_cast<int32_t>(m_width) - 1);
+                triangle.y_max = Helper::Min(triangle.y_max, static_cast<int32_t>(m_height) - 1);
+                if (triangle.x_min > triangle.x_max || triangle.y_min > triangle.y_max)
+                    continue;
+
+                // Edge functions, positive inside
+                for (uint32_t e = 0; e < 3; e++)
+                {
+                    const uint32_t a    = e;
+                    const uint32_t b    = (e + 1) % 3;
+                    triangle.edge_a[e]  = y[a] - y[b];
+                    triangle.edge_b[e]  = x[b] - x[a];
+                    triangle.edge_c[e]  = -(triangle.edge_a[e] * x[a] + triangle.edge_b[e] * y[a]);
+                }
+
+                // Depth plane
+                const float dx1 = x[1] - x[0], dy1 = y[1] - y[0], dd1 = d[1] - d[0];
+                const float dx2 = x[2] - x[0], dy2 = y[2] - y[0], dd2 = d[2] - d[0];
+                triangle.depth_a = (dd1 * dy2 - dd2 * dy1) / area;
+                triangle.depth_b = (dd2 * dx1 - dd1 * dx2) / area;
+                triangle.depth_c = d[0] - triangle.depth_a * x[0] - triangle.depth_b * y[0];
+
+                triangle.valid = true;
+            }
+        }
+    }
+
+    void OcclusionCuller::RasterizeRows(uint32_t band_start, uint32_t band_end)
+    {
+        const int32_t row_start = static_cast<int32_t>(band_start * m_band_rows);
+        const int32_t row_end   = static_cast<int32_t>(Helper::Min(band_end * m_band_rows, m_height)) - 1;
+        if (row_start > row_end)
+            return;
+
+        const __m128 zero           = _mm_setzero_ps();
+        const __m128 pixel_offsets  = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+
+        for (const Triangle& triangle : m_triangles)
+        {
+            if (!triangle.valid || triangle.y_max < row_start || triangle.y_min > row_end)
+                continue;
+
+            const int32_t y_start = Helper::Max(triangle.y_min, row_start);
+            const int32_t y_end   = Helper::Min(triangle.y_max, row_end);
+            const int32_t x_start = triangle.x_min & ~3;
+
+            const __m128 edge_a0 = _mm_set1_ps(triangle.edge_a[0]);
+            const __m128 edge_a1 = _mm_set1_ps(triangle.edge_a[1]);
+            const __m128 edge_a2 = _mm_set1_ps(triangle.edge_a[2]);
+            const __m128 depth_a = _mm_set1_ps(triangle.depth_a);
+
+            for (int32_t y = y_start; y <= y_end; y++)
+            {
+                // Row constant part of the edge and depth equations
+                const float py          = static_cast<float>(y) + 0.5f;
+                const __m128 edge_row0  = _mm_set1_ps(triangle.edge_b[0] * py + triangle.edge_c[0]);
+                const __m128 edge_row1  = _mm_set1_ps(triangle.edge_b[1] * py + triangle.edge_c[1]);
+                const __m128 edge_row2  = _mm_set1_ps(triangle.edge_b[2] * py + triangle.edge_c[2]);
+                const __m128 depth_row  = _mm_set1_ps(triangle.depth_b * py + triangle.depth_c);
+                float* row              = &m_depth[y * m_width];
+
+                for (int32_t x = x_start; x <= triangle.x_max; x += 4)
+                {
+                    const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), pixel_offsets);
+
+                    // Coverage
+                    const __m128 edge0  = _mm_add_ps(_mm_mul_ps(edge_a0, px), edge_row0);
+                    const __m128 edge1  = _mm_add_ps(_mm_mul_ps(edge_a1, px), edge_row1);
+                    const __m128 edge2  = _mm_add_ps(_mm_mul_ps(edge_a2, px), edge_row2);
+                    const __m128 mask   = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edge0, zero), _mm_cmpge_ps(edge1, zero)), _mm_cmpge_ps(edge2, zero));
+                    if (_mm_movemask_ps(mask) == 0)
+                        continue;
+
+                    // Keep the nearest depth, uncovered lanes become zero which never wins
+                    const __m128 depth      = _mm_and_ps(mask, _mm_add_ps(_mm_mul_ps(depth_a, px), depth_row));
+                    const __m128 current    = _mm_loadu_ps(row + x);
+                    _mm_storeu_ps(row + x, _mm_max_ps(current, depth));
+                }
+            }
+        }
+    }
+
+    void OcclusionCuller::BuildHierarchicalDepth()
+    {
+        // Every texel keeps the farthest depth of the texels it covers in the previous level
+        const float* src    = m_depth.data();
+        uint32_t src_width  = m_width;
+        uint32_t src_height = m_height;
+
+        for (vector<float>& mip : m_depth_mips)
+        {
+            const uint32_t dst_width    = Helper::Max<uint32_t>(src_width / 2, 1);
+            const uint32_t dst_height   = Helper::Max<uint32_t>(src_height / 2, 1);
+
+            for (uint32_t y = 0; y < dst_height; y++)
+            {
+                // The last row/column also covers the remainder of odd dimensions
+                const uint32_t y0 = Helper::Min(y * 2, src_height - 1);
+                const uint32_t y1 = (y == dst_height - 1) ? src_height - 1 : y0 + 1;
+
+                for (uint32_t x = 0; x < dst_width; x++)
+                {
+                    const uint32_t x0 = Helper::Min(x * 2, src_width - 1);
+                    const uint32_t x1 = (x == dst_width - 1) ? src_width - 1 : x0 + 1;
+
+                    float farthest = 1.0f;
+                    for (uint32_t sy = y0; sy <= y1; sy++)
+                    {
+                        for (uint32_t sx = x0; sx <= x1; sx++)
+                        {
+                            farthest = Helper::Min(farthest, src[sy * src_width + sx]);
+                        }
+                    }
+
+                    mip[y * dst_width + x] = farthest;
+                }
+            }
+
+            src         = mip.data();
+            src_width   = dst_width;
+            src_height  = dst_height;
+        }
+    }
+
+    bool OcclusionCuller::IsVisible(const BoundingBox& box) const
+    {
+        m_tested++;
+
+        const Vector3& min = box.GetMin();
+        const Vector3& max = box.GetMax();
+
+        const Vector3 corners[8] =
+        {
+            min,
+            Vector3(max.x, min.y, min.z),
+            Vector3(min.x, max.y, min.z),
+            Vector3(max.x, max.y, min.z),
+            Vector3(min.x, min.y, max.z),
+            Vector3(max.x, min.y, max.z),
+            Vector3(min.x, max.y, max.z),
+            max
+        };
+
+        // Project to a screen rectangle and find the nearest depth
+        float x_min     = numeric_limits<float>::max();
+        float y_min     = numeric_limits<float>::max();
+        float x_max     = numeric_limits<float>::lowest();
+        float y_max     = numeric_limits<float>::lowest();
+        float nearest   = 0.0f;
+        for (const Vector3& corner : corners)
+        {
+            const Vector4 clip = Vector4(corner, 1.0f) * m_view_projection;
+
+            // Boxes which cross the near plane are always visible
+            if (clip.w <= Helper::EPSILON)
+                return true;
+
+            const float w_inv   = 1.0f / clip.w;
+            const float z       = clip.z * w_inv;
+            const float depth   = m_reverse_z ? z : 1.0f - z;
+            if (depth >= 1.0f)
+                return true;
+
+            const float x = (clip.x * w_inv * 0.5f + 0.5f) * m_width;
+            const float y = (clip.y * w_inv * -0.5f + 0.5f) * m_height;
+
+            x_min   = Helper::Min(x_min, x);
+            y_min   = Helper::Min(y_min, y);
+            x_max   = Helper::Max(x_max, x);
+            y_max   = Helper::Max(y_max, y);
+            nearest = Helper::Max(nearest, depth);
+        }
+
+        // Off-screen boxes are left to frustum culling
+        if (x_max < 0.0f || y_max < 0.0f || x_min >= m_width || y_min >= m_height)
+            return true;
+
+        const uint32_t px_min = static_cast<uint32_t>(Helper::Clamp(x_min, 0.0f, static_cast<float>(m_width - 1)));
+        const uint32_t py_min = static_cast<uint32_t>(Helper::Clamp(y_min, 0.0f, static_cast<float>(m_height - 1)));
+        const uint32_t px_max = static_cast<uint32_t>(Helper::Clamp(x_max, 0.0f, static_cast<float>(m_width - 1)));
+        const uint32_t py_max = static_cast<uint32_t>(Helper::Clamp(y_max, 0.0f, static_cast<float>(m_height - 1)));
+
+        // Pick the level where the rectangle covers at most 8x8 texels (a coarser level would overestimate the rectangle too much)
+        uint32_t level = 0;
+        while (level < m_depth_mips.size() && ((px_max >> level) - (px_min >> level) > 7 || (py_max >> level) - (py_min >> level) > 7))
+        {
+            level++;
+        }
+
+        const float* depth          = level == 0 ? m_depth.data() : m_depth_mips[level - 1].data();
+        const uint32_t level_width  = Helper::Max<uint32_t>(m_width >> level, 1);
+        const uint32_t level_height = Helper::Max<uint32_t>(m_height >> level, 1);
+        const uint32_t tx_min       = Helper::Min(px_min >> level, level_width - 1);
+        const uint32_t ty_min       = Helper::Min(py_min >> level, level_height - 1);
+        const uint32_t tx_max       = Helper::Min(px_max >> level, level_width - 1);
+        const uint32_t ty_max       = Helper::Min(py_max >> level, level_height - 1);
+
+        for (uint32_t y = ty_min; y <= ty_max; y++)
+        {
+            for (uint32_t x = tx_min; x <= tx_max; x++)
+            {
+                // Visible if the box is in front of the farthest occluder in this texel
+                if (nearest >= depth[y * level_width + x])
+                    return true;
+            }
+        }
+
+        m_occluded++;
+        return false;
+    }
+}
@@ -0,0 +1,124 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =====================
+#include <vector>
+#include <atomic>
+#include "../Math/Matrix.h"
+#include "../Math/BoundingBox.h"
+#include "../RHI/RHI_Definition.h"
+//================================
+
+namespace Spartan
+{
+    class Context;
+    class Threading;
+
+    // Software occlusion culling.
+    // Occluder triangles are rasterised into a low resolution depth buffer (SSE, in parallel row bands),
+    // a hierarchical depth is built from it and bounding boxes are tested against it.
+    // The depth is stored as "nearness" (1 is the near plane, 0 is the far plane/empty) for both reverse and conventional z.
+    class SPARTAN_CLASS OcclusionCuller
+    {
+    public:
+        OcclusionCuller(Context* context, uint32_t width = 256, uint32_t height = 128);
+        ~OcclusionCuller() = default;
+
+        // Clears the depth buffer and the occluders, the view projection is used by both the occluders and the tests
+        void Begin(const Math::Matrix& view_projection, const bool reverse_z);
+
+        // Adds the triangles of an occluder, returns false when the triangle budget is exhausted
+        bool AddOccluder(const std::vector<RHI_Vertex_PosTexNorTan>& vertices, const std::vector<uint32_t>& indices, uint32_t index_offset, uint32_t index_count, uint32_t vertex_offset, const Math::Matrix& transform);
+
+        // Rasterises the occluders and builds the hierarchical depth
+        void End();
+
+        // Tests a world space bounding box against the hierarchical depth (thread safe)
+        bool IsVisible(const Math::BoundingBox& box) const;
+
+        // Properties
+        uint32_t GetWidth()                         const { return m_width; }
+        uint32_t GetHeight()                        const { return m_height; }
+        const std::vector<float>& GetDepth()        const { return m_depth; }
+        uint32_t GetOccluderCount()                 const { return static_cast<uint32_t>(m_occluders.size()); }
+        uint32_t GetOccluderTriangleCount()         const { return m_triangle_count; }
+        uint32_t GetTriangleBudget()                const { return m_triangle_budget; }
+        void SetTriangleBudget(const uint32_t budget)     { m_triangle_budget = budget; }
+
+        // Stats (since the last Begin())
+        uint32_t GetTestedCount()                   const { return m_tested; }
+        uint32_t GetOccludedCount()                 const { return m_occluded; }
+
+    private:
+        struct Occluder
+        {
+            const RHI_Vertex_PosTexNorTan* vertices = nullptr;
+            const uint32_t* indices                 = nullptr;
+            uint32_t index_count                    = 0;
+            uint32_t triangle_offset                = 0;
+            Math::Matrix transform;
+        };
+
+        // Screen space triangle, ready for rasterisation
+        struct Triangle
+        {
+            float edge_a[3];
+            float edge_b[3];
+            float edge_c[3];
+            float depth_a;
+            float depth_b;
+            float depth_c;
+            int32_t x_min;
+            int32_t x_max;
+            int32_t y_min;
+            int32_t y_max;
+            bool valid;
+        };
+
+        void SetupTriangles(uint32_t occluder_start, uint32_t occluder_end);
+        void RasterizeRows(uint32_t band_start, uint32_t band_end);
+        void BuildHierarchicalDepth();
+
+        // Buffers
+        uint32_t m_width    = 0;
+        uint32_t m_height   = 0;
+        std::vector<float> m_depth;
+        std::vector<std::vector<float>> m_depth_mips;
+        std::vector<Occluder> m_occluders;
+        std::vector<Triangle> m_triangles;
+
+        // State
+        Math::Matrix m_view_projection;
+        bool m_reverse_z            = true;
+        uint32_t m_triangle_count   = 0;
+        uint32_t m_triangle_budget  = 100000;
+        const uint32_t m_band_rows  = 8;
+
+        // Stats
+        mutable std::atomic<uint32_t> m_tested      = 0;
+        mutable std::atomic<uint32_t> m_occluded    = 0;
+
+        // Dependencies
+        Threading* m_threading = nullptr;
+    };
+}
@@ -0,0 +1,644 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ======================
+#include "Spartan.h"
+#include "RenderGraph.h"
+#include "../RHI/RHI_Texture2D.h"
+#include "../RHI/RHI_CommandList.h"
+//=================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    static uint32_t get_bytes_per_pixel(const RHI_Format format)
+    {
+        switch (format)
+        {
+            case RHI_Format_R8_Unorm:               return 1;
+            case RHI_Format_R16_Uint:               return 2;
+            case RHI_Format_R16_Float:              return 2;
+            case RHI_Format_R32_Uint:               return 4;
+            case RHI_Format_R32_Float:              return 4;
+            case RHI_Format_R8G8_Unorm:             return 2;
+            case RHI_Format_R16G16_Float:           return 4;
+            case RHI_Format_R32G32_Float:           return 8;
+            case RHI_Format_R11G11B10_Float:        return 4;
+            case RHI_Format_R32G32B32_Float:        return 12;
+            case RHI_Format_R8G8B8A8_Unorm:         return 4;
+            case RHI_Format_R10G10B10A2_Unorm:      return 4;
+            case RHI_Format_R16G16B16A16_Snorm:     return 8;
+            case RHI_Format_R16G16B16A16_Float:     return 8;
+            case RHI_Format_R32G32B32A32_Float:     return 16;
+            case RHI_Format_D32_Float:              return 4;
+            case RHI_Format_D32_Float_S8X24_Uint:   return 8;
+            default:                                return 0;
+        }
+    }
+
+    static RHI_Image_Layout get_layout(const RenderGraph_Access access, const bool is_depth)
+    {
+        switch (access)
+        {
+            case RenderGraph_Access_Read:           return is_depth ? RHI_Image_Layout::Depth_Stencil_Read_Only_Optimal : RHI_Image_Layout::Shader_Read_Only_Optimal;
+            case RenderGraph_Access_Storage:        return RHI_Image_Layout::General;
+            case RenderGraph_Access_RenderTarget:   return RHI_Image_Layout::Color_Attachment_Optimal;
+            case RenderGraph_Access_DepthStencil:   return RHI_Image_Layout::Depth_Stencil_Attachment_Optimal;
+            default:                                return RHI_Image_Layout::Undefined;
+        }
+    }
+
+    uint64_t RenderGraph_TextureDesc::GetSize() const
+    {
+        return static_cast<uint64_t>(width) * height * array_size * get_bytes_per_pixel(format);
+    }
+
+    RenderGraph::RenderGraph(Context* context)
+    {
+        m_context = context;
+    }
+
+    void RenderGraph::Clear()
+    {
+        m_resources.clear();
+        m_passes.clear();
+        m_physical.clear();
+        m_pass_culled_count             = 0;
+        m_pass_async_count              = 0;
+        m_async_fork                    = -1;
+        m_async_join                    = -1;
+        m_barrier_count                 = 0;
+        m_transient_memory              = 0;
+        m_transient_memory_unaliased    = 0;
+        m_compiled                      = false;
+    }
+
+    uint32_t RenderGraph::AddTexture(const string& name, const RenderGraph_TextureDesc& desc, shared_ptr<RHI_Texture>* binding /*= nullptr*/)
+    {
+        Resource& resource  = m_resources.emplace_back();
+        resource.name       = name;
+        resource.desc       = desc;
+        resource.binding    = binding;
+        resource.imported   = false;
+
+        return static_cast<uint32_t>(m_resources.size() - 1);
+    }
+
+    uint32_t RenderGraph::ImportTexture(const string& name, shared_ptr<RHI_Texture>* binding /*= nullptr*/)
+    {
+        Resource& resource  = m_resources.emplace_back();
+        resource.name       = name;
+        resource.binding    = binding;
+        resource.imported   = true;
+
+        // The description is only needed to tell depth from color
+        if (binding && *binding)
+        {
+            resource.desc = RenderGraph_TextureDesc((*binding)->GetWidth(), (*binding)->GetHeight(), (*binding)->GetFormat(), (*binding)->GetArraySize(), (*binding)->GetFlags());
+        }
+
+        return static_cast<uint32_t>(m_resources.size() - 1);
+    }
+
+    void RenderGraph::SetOutput(const uint32_t resource)
+    {
+        SP_ASSERT(resource < m_resources.size());
+        m_resources[resource].output = true;
+    }
+
+    uint32_t RenderGraph::AddPass(const string& name, function<void(RHI_CommandList*)>&& execute, const bool never_cull /*= false*/)
+    {
+        Pass& pass      = m_passes.emplace_back();
+        pass.name       = name;
+        pass.execute    = move(execute);
+        pass.never_cull = never_cull;
+
+        return static_cast<uint32_t>(m_passes.size() - 1);
+    }
+
+    void RenderGraph::Read(const uint32_t pass, const uint32_t resource, const RenderGraph_Access access /*= RenderGraph_Access_Read*/)
+    {
+        SP_ASSERT(pass < m_passes.size() && resource < m_resources.size());
+        m_passes[pass].accesses.push_back({ resource, access, false });
+    }
+
+    void RenderGraph::Write(const uint32_t pass, const uint32_t resource, const RenderGraph_Access access)
+    {
+        SP_ASSERT(pass < m_passes.size() && resource < m_resources.size());
+        m_passes[pass].accesses.push_back({ resource, access, true });
+    }
+
+    void RenderGraph::SetAsync(const uint32_t pass)
+    {
+        SP_ASSERT(pass < m_passes.size());
+        m_passes[pass].async = true;
+    }
+
+    bool RenderGraph::Compile()
+    {
+        m_compiled = false;
+
+        for (const Resource& resource : m_resources)
+        {
+            if (!resource.imported && resource.desc.GetSize() == 0)
+            {
+                LOG_ERROR("Transient texture \"%s\" has an invalid description", resource.name.c_str());
+                return false;
+            }
+        }
+
+        Cull();
+        ComputeQueues();
+        ComputeLifetimes();
+        Alias();
+        ComputeBarriers();
+
+        m_compiled = true;
+        return true;
+    }
+
+    void RenderGraph::Execute(RHI_CommandList* cmd_list, RHI_CommandList* cmd_list_async /*= nullptr*/, RHI_Semaphore* semaphore_graphics /*= nullptr*/, RHI_Semaphore* semaphore_async /*= nullptr*/)
+    {
+        if (!m_compiled || !cmd_list)
+            return;
+
+        // Async passes need a command list on the compute queue, begun here so that it waits for it's previous submission
+        bool async = m_async_fork != -1 && cmd_list_async && semaphore_graphics && semaphore_async;
+        if (async)
+        {
+            if (cmd_list_async->Begin())
+            {
+                MeasureAsync(cmd_list, cmd_list_async);
+            }
+            else
+            {
+                LOG_ERROR("Failed to begin the async command list, async passes will execute on the graphics queue");
+                async = false;
+            }
+        }
+
+        // Acquire the transient textures, reusing the ones from previous frames when the descriptions match
+        vector<bool> taken(m_pool.size(), false);
+        for (Physical& physical : m_physical)
+        {
+            for (uint32_t i = 0; i < static_cast<uint32_t>(m_pool.size()); i++)
+            {
+                if (!taken[i] && m_pool[i].desc == physical.desc)
+                {
+                    physical.texture    = m_pool[i].texture;
+                    taken[i]            = true;
+                    break;
+                }
+            }
+
+            if (!physical.texture && m_context)
+            {
+                const RenderGraph_TextureDesc& desc = physical.desc;
+                physical.texture = make_shared<RHI_Texture2D>(m_context, desc.width, desc.height, desc.format, desc.array_size, desc.flags, "rt_transient_" + to_string(m_pool.size()));
+                m_pool.push_back(physical);
+                taken.push_back(true);
+            }
+        }
+
+        // Bind the transient textures, the ones that were culled get nothing
+        for (Resource& resource : m_resources)
+        {
+            if (resource.imported || !resource.binding)
+                continue;
+
+            *resource.binding = resource.physical != -1 ? m_physical[resource.physical].texture : nullptr;
+        }
+
+        AsyncTimestamps* timestamps = nullptr;
+        const auto join = [&]()
+        {
+            timestamps->async_end       = cmd_list_async->Timestamp_Write();
+            timestamps->graphics_end    = cmd_list->Timestamp_Write();
+
+            // Submit the async passes, the rest of the graphics work waits for them
+            cmd_list_async->End();
+            cmd_list_async->Submit(semaphore_async, m_async_value);
+            cmd_list->QueueWait(semaphore_async, m_async_value);
+        };
+
+        for (int32_t i = 0; i < static_cast<int32_t>(m_passes.size()); i++)
+        {
+            Pass& pass = m_passes[i];
+            if (pass.culled)
+                continue;
+
+            RHI_CommandList* cmd_list_pass = cmd_list;
+            if (async)
+            {
+                // Fork, submit everything recorded so far and have the compute queue wait for it
+                if (i == m_async_fork)
+                {
+                    m_async_value++;
+                    cmd_list->Split(semaphore_graphics, m_async_value);
+                    cmd_list_async->QueueWait(semaphore_graphics, m_async_value);
+
+                    timestamps                  = &m_async_timestamps.emplace_back();
+                    timestamps->cmd_list        = cmd_list;
+                    timestamps->cmd_list_async  = cmd_list_async;
+                    timestamps->graphics_start  = cmd_list->Timestamp_Write();
+                    timestamps->async_start     = cmd_list_async->Timestamp_Write();
+                }
+
+                // Join, the graphics work from here on waits for the compute queue
+                if (i == m_async_join)
+                {
+                    join();
+                    cmd_list->Split();
+                }
+
+                if (pass.async_queue)
+                {
+                    cmd_list_pass = cmd_list_async;
+                }
+            }
+
+            // Transitions happen before the pass begins, bindings are read now since passes are allowed to swap them
+            for (const RenderGraph_Barrier& barrier : pass.barriers)
+            {
+                const Resource& resource = m_resources[barrier.resource];
+
+                RHI_Texture* texture = nullptr;
+                if (resource.binding)
+                {
+                    texture = resource.binding->get();
+                }
+                else if (resource.physical != -1)
+                {
+                    texture = m_physical[resource.physical].texture.get();
+                }
+
+                if (texture)
+                {
+                    texture->SetLayout(barrier.layout_new, cmd_list_pass);
+                }
+            }
+
+            pass.execute(cmd_list_pass);
+        }
+
+        // Nothing joined before the end, so the final submission of the graphics work waits for the compute queue
+        if (async && m_async_join == static_cast<int32_t>(m_passes.size()))
+        {
+            join();
+        }
+    }
+
+    void RenderGraph::ReleaseTextures()
+    {
+        m_pool.clear();
+
+        for (Physical& physical : m_physical)
+        {
+            physical.texture = nullptr;
+        }
+
+        for (Resource& resource : m_resources)
+        {
+            if (!resource.imported && resource.binding)
+            {
+                *resource.binding = nullptr;
+            }
+        }
+    }
+
+    bool RenderGraph::IsDepth(const Resource& resource) const
+    {
+        return resource.desc.format == RHI_Format_D32_Float || resource.desc.format == RHI_Format_D32_Float_S8X24_Uint;
+    }
+
+    void RenderGraph::Cull()
+    {
+        // Walk the passes backwards, starting from the outputs. A pass survives if it writes to something that
+        // a surviving pass (or the output) needs, in which case everything it reads becomes needed as well.
+        vector<bool> needed(m_resources.size(), false);
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_resources.size()); i++)
+        {
+            needed[i] = m_resources[i].output;
+        }
+
+        m_pass_culled_count = 0;
+        for (int32_t i = static_cast<int32_t>(m_passes.size()) - 1; i >= 0; i--)
+        {
+            Pass& pass = m_passes[i];
+
+            bool alive = pass.never_cull;
+            for (const Access& access : pass.accesses)
+            {
+                alive = alive || (access.write && needed[access.resource]);
+            }
+
+            pass.culled = !alive;
+            if (pass.culled)
+            {
+                m_pass_culled_count++;
+                continue;
+            }
+
+            for (const Access& access : pass.accesses)
+            {
+                if (!access.write)
+                {
+                    needed[access.resource] = true;
+                }
+            }
+        }
+    }
+
+    void RenderGraph::ComputeQueues()
+    {
+        m_pass_async_count  = 0;
+        m_async_fork        = -1;
+        m_async_join        = -1;
+
+        // Textures touched by async passes and textures touched by graphics passes inside the window
+        vector<bool> touched_async(m_resources.size(), false);
+        vector<bool> written_graphics(m_resources.size(), false);
+        vector<bool> read_graphics(m_resources.size(), false);
+
+        for (int32_t i = 0; i < static_cast<int32_t>(m_passes.size()); i++)
+        {
+            Pass& pass          = m_passes[i];
+            pass.async_queue    = false;
+            if (pass.culled)
+                continue;
+
+            // An async pass can go to the compute queue as long as the window hasn't joined and it doesn't depend on a graphics pass inside the window
+            if (pass.async && m_async_join == -1)
+            {
+                // Imported textures are created by their owners, so they can only be accessed by the compute queue if they are shared with it
+                bool depends_on_graphics = false;
+                for (const Access& access : pass.accesses)
+                {
+                    const Resource& resource    = m_resources[access.resource];
+                    const bool shared           = !resource.imported || (resource.desc.flags & RHI_Texture_AsyncCompute);
+                    depends_on_graphics         = depends_on_graphics || !shared || written_graphics[access.resource] || (access.write && read_graphics[access.resource]);
+                }
+
+                if (!depends_on_graphics)
+                {
+                    pass.async_queue = true;
+                    m_pass_async_count++;
+
+                    if (m_async_fork == -1)
+                    {
+                        m_async_fork = i;
+                    }
+
+                    for (const Access& access : pass.accesses)
+                    {
+                        touched_async[access.resource] = true;
+                    }
+
+                    continue;
+                }
+            }
+
+            // A graphics pass inside the window either joins it or overlaps with it
+            if (m_async_fork != -1 && m_async_join == -1)
+            {
+                for (const Access& access : pass.accesses)
+                {
+                    if (touched_async[access.resource])
+                    {
+                        m_async_join = i;
+                        break;
+                    }
+                }
+
+                if (m_async_join == -1)
+                {
+                    for (const Access& access : pass.accesses)
+                    {
+                        (access.write ? written_graphics : read_graphics)[access.resource] = true;
+                    }
+                }
+            }
+        }
+
+        // If nothing depends on the async passes, the window joins at the end of the frame
+        if (m_async_fork != -1 && m_async_join == -1)
+        {
+            m_async_join = static_cast<int32_t>(m_passes.size());
+        }
+
+        // Transient textures which the compute queue touches are shared with it, the rest stay exclusive to the graphics queue
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_resources.size()); i++)
+        {
+            if (touched_async[i] && !m_resources[i].imported)
+            {
+                m_resources[i].desc.flags |= RHI_Texture_AsyncCompute;
+            }
+        }
+    }
+
+    void RenderGraph::ComputeLifetimes()
+    {
+        for (Resource& resource : m_resources)
+        {
+            resource.first_pass = -1;
+            resource.last_pass  = -1;
+        }
+
+        for (int32_t i = 0; i < static_cast<int32_t>(m_passes.size()); i++)
+        {
+            if (m_passes[i].culled)
+                continue;
+
+            for (const Access& access : m_passes[i].accesses)
+            {
+                Resource& resource = m_resources[access.resource];
+
+                if (resource.first_pass == -1)
+                {
+                    resource.first_pass = i;
+
+                    if (!resource.imported && !access.write)
+                    {
+                        LOG_WARNING("Pass \"%s\" reads transient texture \"%s\" before anything writes to it", m_passes[i].name.c_str(), resource.name.c_str());
+                    }
+                }
+
+                resource.last_pass = i;
+            }
+        }
+
+        // Outputs have to survive until the end of the frame
+        for (Resource& resource : m_resources)
+        {
+            if (resource.output && resource.first_pass != -1)
+            {
+                resource.last_pass = static_cast<int32_t>(m_passes.size());
+            }
+        }
+
+        // Async passes can execute at any point of the window, so the textures they touch have to live throughout it
+        if (m_async_fork != -1)
+        {
+            for (const Pass& pass : m_passes)
+            {
+                if (!pass.async_queue)
+                    continue;
+
+                for (const Access& access : pass.accesses)
+                {
+                    Resource& resource  = m_resources[access.resource];
+                    resource.first_pass = Math::Helper::Min(resource.first_pass, m_async_fork);
+                    resource.last_pass  = Math::Helper::Max(resource.last_pass, m_async_join);
+                }
+            }
+        }
+    }
+
+    void RenderGraph::Alias()
+    {
+        m_physical.clear();
+        m_transient_memory              = 0;
+        m_transient_memory_unaliased    = 0;
+
+        // Transient textures in the order they come to life
+        vector<uint32_t> transients;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_resources.size()); i++)
+        {
+            m_resources[i].physical = -1;
+
+            if (!m_resources[i].imported && m_resources[i].first_pass != -1)
+            {
+                transients.emplace_back(i);
+            }
+        }
+        stable_sort(transients.begin(), transients.end(), [this](const uint32_t a, const uint32_t b) { return m_resources[a].first_pass < m_resources[b].first_pass; });
+
+        // Give each one the first texture that matches its description and is free by the time it's needed
+        for (const uint32_t index : transients)
+        {
+            Resource& resource = m_resources[index];
+            m_transient_memory_unaliased += resource.desc.GetSize();
+
+            for (uint32_t i = 0; i < static_cast<uint32_t>(m_physical.size()); i++)
+            {
+                if (m_physical[i].desc == resource.desc && m_physical[i].last_pass < resource.first_pass)
+                {
+                    resource.physical = static_cast<int32_t>(i);
+                    break;
+                }
+            }
+
+            if (resource.physical == -1)
+            {
+                Physical& physical  = m_physical.emplace_back();
+                physical.desc       = resource.desc;
+                resource.physical   = static_cast<int32_t>(m_physical.size() - 1);
+                m_transient_memory  += resource.desc.GetSize();
+            }
+
+            m_physical[resource.physical].last_pass = resource.last_pass;
+        }
+    }
+
+    void RenderGraph::MeasureAsync(RHI_CommandList* cmd_list, RHI_CommandList* cmd_list_async)
+    {
+        // Both command lists have been waited for, so the timestamps of the last time they were used together can be read
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_async_timestamps.size()); i++)
+        {
+            const AsyncTimestamps timestamps = m_async_timestamps[i];
+            if (timestamps.cmd_list != cmd_list || timestamps.cmd_list_async != cmd_list_async)
+                continue;
+
+            m_async_timestamps.erase(m_async_timestamps.begin() + i);
+
+            const double graphics_start = cmd_list->Timestamp_GetMs(timestamps.graphics_start);
+            const double graphics_end   = cmd_list->Timestamp_GetMs(timestamps.graphics_end);
+            const double async_start    = cmd_list_async->Timestamp_GetMs(timestamps.async_start);
+            const double async_end      = cmd_list_async->Timestamp_GetMs(timestamps.async_end);
+            if (graphics_start == 0.0 || async_start == 0.0 || graphics_end < graphics_start || async_end < async_start)
+                return;
+
+            // The window starts when the graphics queue signals the fork, so time is measured from there
+            const double overlap_start  = Math::Helper::Max(graphics_start, async_start);
+            const double overlap_end    = Math::Helper::Min(graphics_end, async_end);
+            m_async_time                = static_cast<float>(async_end - graphics_start);
+            m_async_overlap             = static_cast<float>(Math::Helper::Max(overlap_end - overlap_start, 0.0));
+
+            return;
+        }
+    }
+
+    void RenderGraph::ComputeBarriers()
+    {
+        // Layouts are tracked per texture, imported textures are tracked by resource and transient textures by their aliased texture
+        vector<RHI_Image_Layout> layouts_imported(m_resources.size(), RHI_Image_Layout::Undefined);
+        vector<RHI_Image_Layout> layouts_physical(m_physical.size(), RHI_Image_Layout::Undefined);
+
+        m_barrier_count = 0;
+        for (Pass& pass : m_passes)
+        {
+            pass.barriers.clear();
+            if (pass.culled)
+                continue;
+
+            for (uint32_t i = 0; i < static_cast<uint32_t>(pass.accesses.size()); i++)
+            {
+                const Access& access        = pass.accesses[i];
+                const Resource& resource    = m_resources[access.resource];
+
+                // If a pass accesses a texture more than once, the write decides the layout
+                bool superseded = false;
+                for (uint32_t j = 0; j < static_cast<uint32_t>(pass.accesses.size()); j++)
+                {
+                    const Access& other = pass.accesses[j];
+                    if (j != i && other.resource == access.resource && ((other.write && !access.write) || (other.write == access.write && j > i)))
+                    {
+                        superseded = true;
+                        break;
+                    }
+                }
+
+                if (superseded)
+                    continue;
+
+                RHI_Image_Layout& layout_current    = resource.imported ? layouts_imported[access.resource] : layouts_physical[resource.physical];
+                const RHI_Image_Layout layout_new   = get_layout(access.access, IsDepth(resource));
+
+                // Untracked accesses leave the texture in an unknown layout
+                if (access.access == RenderGraph_Access_Untracked)
+                {
+                    layout_current = RHI_Image_Layout::Undefined;
+                    continue;
+                }
+
+                if (layout_current != layout_new)
+                {
+                    pass.barriers.push_back({ access.resource, layout_current, layout_new });
+                    layout_current = layout_new;
+                    m_barrier_count++;
+                }
+            }
+        }
+    }
+}
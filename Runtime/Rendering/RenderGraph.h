@@ -0,0 +1,217 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ====================
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+#include "../RHI/RHI_Definition.h"
+//===============================
+
+namespace Spartan
+{
+    class Context;
+
+    // How a pass accesses a texture, this determines the layout the texture is transitioned to before the pass executes
+    enum RenderGraph_Access : uint8_t
+    {
+        RenderGraph_Access_Read,            // sampled (depth formats are read as read-only depth-stencil)
+        RenderGraph_Access_Storage,         // unordered access
+        RenderGraph_Access_RenderTarget,    // color attachment
+        RenderGraph_Access_DepthStencil,    // depth-stencil attachment
+        RenderGraph_Access_Untracked        // dependency only, the pass transitions the texture itself (e.g. ping-ponged textures)
+    };
+
+    struct RenderGraph_TextureDesc
+    {
+        RenderGraph_TextureDesc() = default;
+        RenderGraph_TextureDesc(const uint32_t width, const uint32_t height, const RHI_Format format, const uint32_t array_size = 1, const uint16_t flags = 0)
+        {
+            this->width         = width;
+            this->height        = height;
+            this->format        = format;
+            this->array_size    = array_size;
+            this->flags         = flags;
+        }
+
+        uint64_t GetSize() const;
+
+        bool operator==(const RenderGraph_TextureDesc& rhs) const
+        {
+            return
+                width       == rhs.width        &&
+                height      == rhs.height       &&
+                format      == rhs.format       &&
+                array_size  == rhs.array_size   &&
+                flags       == rhs.flags;
+        }
+
+        uint32_t width      = 0;
+        uint32_t height     = 0;
+        RHI_Format format   = RHI_Format_Undefined;
+        uint32_t array_size = 1;
+        uint16_t flags      = 0;
+    };
+
+    struct RenderGraph_Barrier
+    {
+        uint32_t resource               = 0;
+        RHI_Image_Layout layout_old     = RHI_Image_Layout::Undefined; // undefined means unknown, which is the case for the first use of an imported texture
+        RHI_Image_Layout layout_new     = RHI_Image_Layout::Undefined;
+    };
+
+    // A frame graph.
+    // Passes declare the textures they read and write, then Compile() culls the passes which don't contribute to an output,
+    // computes the lifetime of the transient textures, aliases transient textures with matching descriptions and non-overlapping
+    // lifetimes and works out the layout transitions of every pass. Compilation doesn't touch the GPU, Execute() does.
+    //
+    // Compute passes can be marked as async, in which case they are recorded into a command list which runs on the compute queue.
+    // The async passes form a window which forks at the first of them (the graphics work recorded so far is submitted and the compute
+    // queue waits for it) and joins at the first graphics pass which touches a texture that an async pass touches (the compute work is
+    // submitted and the graphics queue waits for it). Graphics passes declared in between overlap with the async passes.
+    // Transient textures which async passes touch are shared with the compute queue, imported ones need RHI_Texture_AsyncCompute.
+    class SPARTAN_CLASS RenderGraph
+    {
+    public:
+        RenderGraph(Context* context);
+        ~RenderGraph() = default;
+
+        // Removes all passes and resources, transient textures are kept for reuse
+        void Clear();
+
+        // Resources, the binding (optional) is where the graph writes transient textures to and reads imported textures from
+        uint32_t AddTexture(const std::string& name, const RenderGraph_TextureDesc& desc, std::shared_ptr<RHI_Texture>* binding = nullptr);
+        uint32_t ImportTexture(const std::string& name, std::shared_ptr<RHI_Texture>* binding = nullptr);
+        void SetOutput(const uint32_t resource);
+
+        // Passes
+        uint32_t AddPass(const std::string& name, std::function<void(RHI_CommandList*)>&& execute, const bool never_cull = false);
+        void Read(const uint32_t pass, const uint32_t resource, const RenderGraph_Access access = RenderGraph_Access_Read);
+        void Write(const uint32_t pass, const uint32_t resource, const RenderGraph_Access access);
+        void SetAsync(const uint32_t pass); // compute only, stays on the graphics queue if it depends on a graphics pass inside the window or on an unshared import
+
+        // Culls, computes lifetimes, aliases and computes layout transitions (CPU only)
+        bool Compile();
+
+        // Acquires the transient textures and executes the passes which survived culling, issuing their transitions first.
+        // Without an async command list (and the timeline semaphores of the two queues), async passes are executed on the graphics command list.
+        void Execute(RHI_CommandList* cmd_list, RHI_CommandList* cmd_list_async = nullptr, RHI_Semaphore* semaphore_graphics = nullptr, RHI_Semaphore* semaphore_async = nullptr);
+
+        // Releases the transient textures (e.g. when the resolution changes, after a flush)
+        void ReleaseTextures();
+
+        // Compilation results
+        uint32_t GetPassCount()                                         const { return static_cast<uint32_t>(m_passes.size()); }
+        uint32_t GetPassCulledCount()                                   const { return m_pass_culled_count; }
+        bool IsPassCulled(const uint32_t pass)                          const { return m_passes[pass].culled; }
+        const std::vector<RenderGraph_Barrier>& GetBarriers(const uint32_t pass) const { return m_passes[pass].barriers; }
+        uint32_t GetBarrierCount()                                      const { return m_barrier_count; }
+        int32_t GetPhysicalIndex(const uint32_t resource)               const { return m_resources[resource].physical; }
+        uint32_t GetPhysicalCount()                                     const { return static_cast<uint32_t>(m_physical.size()); }
+        uint64_t GetTransientMemory()                                   const { return m_transient_memory; }
+        uint64_t GetTransientMemoryUnaliased()                          const { return m_transient_memory_unaliased; }
+        bool IsPassAsync(const uint32_t pass)                           const { return m_passes[pass].async_queue; }
+        uint32_t GetPassAsyncCount()                                    const { return m_pass_async_count; }
+
+        // Async compute timings, measured with GPU timestamps (available a few frames later, once the command lists have been waited for)
+        float GetAsyncTime()                                            const { return m_async_time; }    // ms, from the fork to the end of the async passes
+        float GetAsyncOverlap()                                         const { return m_async_overlap; } // ms, of the above, during which the graphics queue was busy
+
+    private:
+        struct Resource
+        {
+            std::string name;
+            RenderGraph_TextureDesc desc;
+            std::shared_ptr<RHI_Texture>* binding   = nullptr;
+            bool imported                           = false;
+            bool output                             = false;
+            int32_t first_pass                      = -1;
+            int32_t last_pass                       = -1;
+            int32_t physical                        = -1;
+        };
+
+        struct Access
+        {
+            uint32_t resource           = 0;
+            RenderGraph_Access access   = RenderGraph_Access_Read;
+            bool write                  = false;
+        };
+
+        struct Pass
+        {
+            std::string name;
+            std::function<void(RHI_CommandList*)> execute;
+            std::vector<Access> accesses;
+            std::vector<RenderGraph_Barrier> barriers;
+            bool never_cull     = false;
+            bool culled         = false;
+            bool async          = false; // requested
+            bool async_queue    = false; // decided by compilation
+        };
+
+        struct Physical
+        {
+            RenderGraph_TextureDesc desc;
+            int32_t last_pass                       = -1;
+            std::shared_ptr<RHI_Texture> texture;
+        };
+
+        // Timestamps which bracket the async window on both queues, kept per command list until the command list comes around again
+        struct AsyncTimestamps
+        {
+            RHI_CommandList* cmd_list       = nullptr;
+            RHI_CommandList* cmd_list_async = nullptr;
+            uint32_t graphics_start         = 0;
+            uint32_t graphics_end           = 0;
+            uint32_t async_start            = 0;
+            uint32_t async_end              = 0;
+        };
+
+        bool IsDepth(const Resource& resource) const;
+        void Cull();
+        void ComputeQueues();
+        void ComputeLifetimes();
+        void Alias();
+        void ComputeBarriers();
+        void MeasureAsync(RHI_CommandList* cmd_list, RHI_CommandList* cmd_list_async);
+
+        std::vector<Resource> m_resources;
+        std::vector<Pass> m_passes;
+        std::vector<Physical> m_physical;
+        std::vector<Physical> m_pool; // transient textures from previous frames
+        std::vector<AsyncTimestamps> m_async_timestamps;
+        uint32_t m_pass_culled_count            = 0;
+        uint32_t m_pass_async_count             = 0;
+        int32_t m_async_fork                    = -1;
+        int32_t m_async_join                    = -1;
+        uint64_t m_async_value                  = 0;
+        float m_async_time                      = 0.0f;
+        float m_async_overlap                   = 0.0f;
+        uint32_t m_barrier_count                = 0;
+        uint64_t m_transient_memory             = 0;
+        uint64_t m_transient_memory_unaliased   = 0;
+        bool m_compiled                         = false;
+        Context* m_context                      = nullptr;
+    };
+}
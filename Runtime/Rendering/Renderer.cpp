@@ -19,10 +19,15 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES ===================================
+//= INCLUDES ====================================
 #include "Spartan.h"
 #include "Renderer.h"
 #include "Model.h"
+#include "Mesh.h"
+#include "OcclusionCuller.h"
+#include "LightClusters.h"
+#include "RenderGraph.h"
+#include "ShaderGBuffer.h"
 #include "Font/Font.h"
 #include "../World/World.h"
 #include "../Display/Display.h"
@@ -31,14 +36,21 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Utilities/Sampling.h"
 #include "../Profiling/Profiler.h"
 #include "../Resource/ResourceCache.h"
+#include "../Threading/Threading.h"
 #include "../World/Entity.h"
 #include "../World/Components/Transform.h"
 #include "../World/Components/Renderable.h"
 #include "../World/Components/Camera.h"
 #include "../World/Components/Light.h"
+#include "../World/Components/Animator.h"
 #include "../RHI/RHI_Device.h"
 #include "../RHI/RHI_PipelineCache.h"
+#include "../RHI/RHI_ShaderCache.h"
 #include "../RHI/RHI_ConstantBuffer.h"
+#include "../RHI/RHI_StructuredBuffer.h"
+#include "../RHI/RHI_UploadAllocator.h"
+#include "../RHI/RHI_UploadManager.h"
+#include "../RHI/RHI_BindlessTable.h"
 #include "../RHI/RHI_CommandList.h"
 #include "../RHI/RHI_Texture2D.h"
 #include "../RHI/RHI_SwapChain.h"
@@ -46,7 +58,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI/RHI_DescriptorSetLayoutCache.h"
 #include "../RHI/RHI_Implementation.h"
 #include "../RHI/RHI_Semaphore.h"
-//==============================================
+//===============================================
 
 //= NAMESPACES ===============
 using namespace std;
@@ -55,6 +67,16 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+    // The clustered light buffer is bound as a single constant buffer, devices which can't bind all of it keep the per-light path
+    static bool light_clusters_supported()
+    {
+        if (sizeof(BufferLightClusters) <= RHI_Context::constant_buffer_size_max)
+            return true;
+
+        LOG_WARNING("The clustered light buffer (%u bytes) exceeds the constant buffer range of the device (%u bytes), lights will be drawn one by one", static_cast<uint32_t>(sizeof(BufferLightClusters)), RHI_Context::constant_buffer_size_max);
+        return false;
+    }
+
     Renderer::Renderer(Context* context) : ISubsystem(context)
     {
         // Options
@@ -75,6 +97,10 @@ namespace Spartan
         m_options |= Render_FilmGrain;
         m_options |= Render_ChromaticAberration;
         m_options |= Render_Ssgi;
+        m_options |= Render_OcclusionCulling;
+        m_options |= Render_ClusteredLighting;
+        m_options |= Render_ParallelRecording;
+        m_options |= Render_GpuSkinning;
 
         // Option values
         m_option_values[Renderer_Option_Value::Anisotropy]          = 16.0f;
@@ -107,6 +133,7 @@ namespace Spartan
         // Get required systems
         m_resource_cache    = m_context->GetSubsystem<ResourceCache>();
         m_profiler          = m_context->GetSubsystem<Profiler>();
+        m_threading         = m_context->GetSubsystem<Threading>();
 
         // Resolution, viewport and swapchain default to whatever the window size is
         const WindowData& window_data = m_context->m_engine->GetWindowData();
@@ -127,12 +154,47 @@ namespace Spartan
             return false;
         }
 
+        // Now that the device limits are known
+        if (GetOption(Render_ClusteredLighting) && !light_clusters_supported())
+        {
+            SetOption(Render_ClusteredLighting, false);
+        }
+
         // Create pipeline cache
-        m_pipeline_cache = make_shared<RHI_PipelineCache>(m_rhi_device.get());
+        m_pipeline_cache = make_shared<RHI_PipelineCache>(m_rhi_device.get(), m_resource_cache->GetResourceDirectory(ResourceDirectory::ShaderCache));
+        m_pipeline_cache->SetResolver([this](const string& name) -> Spartan_Object*
+        {
+            // G-Buffer shader variations are compiled on demand (as materials need them), so pre-warming has to compile them
+            const string prefix = "shader_gbuffer_p_";
+            if (name.rfind(prefix, 0) == 0)
+            {
+                const uint16_t flags = static_cast<uint16_t>(stoul(name.substr(prefix.size())));
+                return const_cast<ShaderGBuffer*>(ShaderGBuffer::GenerateVariation(m_context, flags));
+            }
+
+            return nullptr;
+        });
+
+        // Create shader cache (before any shader gets compiled)
+        m_shader_cache = make_shared<RHI_ShaderCache>(m_resource_cache->GetResourceDirectory(ResourceDirectory::ShaderCache));
 
         // Create descriptor set layout cache
         m_descriptor_set_layout_cache = make_shared<RHI_DescriptorSetLayoutCache>(m_rhi_device.get());
 
+        // Create upload allocator, the dynamic constant buffers are sub-allocated from it
+        m_upload_allocator = make_shared<RHI_UploadAllocator>(m_rhi_device, m_swap_chain_buffer_count);
+
+        // Create bindless table, the G-Buffer pass can use it to draw any material without rebinding textures (if the device supports descriptor indexing)
+        m_bindless_table = make_shared<RHI_BindlessTable>(m_rhi_device, m_swap_chain_buffer_count, m_max_material_instances);
+        m_pipeline_cache->RegisterObject("bindless_table", m_bindless_table.get());
+
+        // Create the descriptor set layout caches of the recording threads (plus one for the thread which records the primary command list)
+        m_recording_threads.resize(m_threading->GetThreadCount() + 1);
+        for (RecordingThread& recording_thread : m_recording_threads)
+        {
+            recording_thread.descriptor_set_layout_cache = make_shared<RHI_DescriptorSetLayoutCache>(m_rhi_device.get());
+        }
+
         // Create swap chain
         {
             m_swap_chain = make_shared<RHI_SwapChain>
@@ -152,6 +214,19 @@ namespace Spartan
                 LOG_ERROR("Failed to create swap chain");
                 return false;
             }
+
+            m_pipeline_cache->RegisterObject("swapchain_main", m_swap_chain.get());
+        }
+
+        // Async compute
+        {
+            for (uint32_t i = 0; i < m_swap_chain_buffer_count; i++)
+            {
+                m_cmd_lists_async.emplace_back(make_shared<RHI_CommandList>(i, m_swap_chain.get(), m_context, RHI_Queue_Compute));
+            }
+
+            m_semaphore_graphics    = make_shared<RHI_Semaphore>(m_rhi_device.get(), true, "async_compute_graphics");
+            m_semaphore_async       = make_shared<RHI_Semaphore>(m_rhi_device.get(), true, "async_compute");
         }
 
         // Full-screen quad
@@ -165,7 +240,17 @@ namespace Spartan
         m_gizmo_grid = make_unique<Grid>(m_rhi_device);
         m_gizmo_transform = make_unique<Transform_Gizmo>(m_context);
 
+        // Software occlusion culling
+        m_occlusion_culler = make_unique<OcclusionCuller>(m_context);
+
+        // Clustered lighting
+        m_light_clusters = make_unique<LightClusters>(m_context);
+
+        // Frame graph
+        m_render_graph = make_unique<RenderGraph>(m_context);
+
         CreateConstantBuffers();
+        CreateStructuredBuffers();
         CreateShaders();
         CreateDepthStencilStates();
         CreateRasterizerStates();
@@ -175,6 +260,9 @@ namespace Spartan
         CreateSamplers();
         CreateTextures();
 
+        // Create the pipelines which previous sessions used, so that they don't have to be created mid-frame
+        m_pipeline_cache->Prewarm(m_descriptor_set_layout_cache.get(), m_threading);
+
         if (!m_initialized)
         {
             // Log on-screen as the renderer is ready
@@ -191,6 +279,17 @@ namespace Spartan
     }
 
     void Renderer::Tick(float delta_time)
+    {
+        Render(delta_time);
+
+        // Text is batched for a single frame, drop what wasn't drawn (nothing is when the frame isn't rendered, or when the text pass doesn't run)
+        if (m_font)
+        {
+            m_font->ClearText();
+        }
+    }
+
+    void Renderer::Render(float delta_time)
     {
         if (!m_rhi_device || !m_rhi_device->IsInitialized())
             return;
@@ -208,6 +307,24 @@ namespace Spartan
         // Begin
         cmd_list->Begin();
 
+        // The command list has waited for it's previous submission, so the upload pages of this swapchain buffer can be recycled
+        m_upload_allocator->BeginFrame(m_swap_chain->GetCmdIndex());
+        m_bindless_table->BeginFrame(m_swap_chain->GetCmdIndex());
+
+        // Free descriptor sets which haven't been used for a while (no command list is recording at this point)
+        m_descriptor_set_layout_cache->BeginFrame();
+        for (RecordingThread& recording_thread : m_recording_threads)
+        {
+            recording_thread.descriptor_set_layout_cache->BeginFrame();
+        }
+
+        // Destroy the resources which the GPU is done with (after the descriptor sets, which might have been referring to them)
+        m_rhi_device->DeletionQueue_Parse();
+        if (RHI_UploadManager* upload_manager = m_rhi_device->GetUploadManager())
+        {
+            upload_manager->BeginFrame();
+        }
+
         // Only render when the world is not loading, as the command list will get flushed by the loading thread.
         if (!m_context->GetSubsystem<World>()->IsLoading())
         {
@@ -227,15 +344,6 @@ namespace Spartan
                 return;
             }
 
-            // Reset dynamic buffer indices when the swapchain resets to first buffer/command list
-            if (m_swap_chain->GetCmdIndex() == 0)
-            {
-                m_buffer_uber_offset_index      = 0;
-                m_buffer_frame_offset_index     = 0;
-                m_buffer_light_offset_index     = 0;
-                m_buffer_material_offset_index  = 0;
-            }
-
             // Update frame buffer
             {
                 if (m_update_ortho_proj || m_near_plane != m_camera->GetNearPlane() || m_far_plane != m_camera->GetFarPlane())
@@ -295,6 +403,15 @@ namespace Spartan
                 m_buffer_frame_cpu.frame                        = static_cast<uint32_t>(m_frame_num);
             }
 
+            // Skin the animated renderables into this frame's vertex buffers (before culling, which uses the bounds of their pose)
+            AnimatorsUpdate();
+
+            // Occlusion culling (uses the frame's unjittered view projection)
+            RenderablesOcclusionCull();
+
+            // Bin the unshadowed lights into the view frustum's clusters
+            LightClustersBuild();
+
             Pass_Main(cmd_list);
 
             DrawDebugTick(delta_time);
@@ -363,60 +480,19 @@ namespace Spartan
     }
 
     template<typename T>
-    bool update_dynamic_buffer(RHI_CommandList* cmd_list, RHI_ConstantBuffer* buffer_gpu, T& buffer_cpu, T& buffer_cpu_previous, uint32_t& offset_index)
+    bool update_dynamic_buffer(RHI_ConstantBuffer* buffer_gpu, T& buffer_cpu, T& buffer_cpu_previous)
     {
-        // Only update if needed
-        if (buffer_cpu == buffer_cpu_previous)
+        // Only update if needed, a dynamic buffer which was last updated in a previous frame points to memory which is about to be recycled
+        if (buffer_cpu == buffer_cpu_previous && !buffer_gpu->IsStale())
             return true;
 
-        offset_index++;
-
-        // Re-allocate buffer with double size (if needed)
-        if (buffer_gpu->IsDynamic())
-        {
-            if (offset_index >= buffer_gpu->GetOffsetCount())
-            {
-                cmd_list->Flush();
-                const uint32_t new_size = Math::Helper::NextPowerOfTwo(offset_index + 1);
-                if (!buffer_gpu->Create<T>(new_size))
-                {
-                    LOG_ERROR("Failed to re-allocate %s buffer with %d offsets", buffer_gpu->GetName().c_str(), new_size);
-                    return false;
-                }
-                LOG_INFO("Increased %s buffer offsets to %d, that's %d kb", buffer_gpu->GetName().c_str(), new_size, (new_size * buffer_gpu->GetStride()) / 1000);
-            }
-        }
-
-        // Set new buffer offset
-        if (buffer_gpu->IsDynamic())
-        {
-            buffer_gpu->SetOffsetIndexDynamic(offset_index);
-        }
-
-        // Map  
-        T* buffer = static_cast<T*>(buffer_gpu->Map());
-        if (!buffer)
-        {
-            LOG_ERROR("Failed to map buffer");
+        // Update, dynamic buffers are sub-allocated from the upload pages of this frame, so there is never a need to grow and flush
+        if (!buffer_gpu->Update(&buffer_cpu))
             return false;
-        }
-
-        const uint64_t size   = buffer_gpu->GetStride();
-        const uint64_t offset = offset_index * size;
 
-        // Update
-        if (buffer_gpu->IsDynamic())
-        {
-            memcpy(reinterpret_cast<std::byte*>(buffer) + offset, reinterpret_cast<std::byte*>(&buffer_cpu), size);
-        }
-        else
-        {
-            *buffer = buffer_cpu;
-        }
         buffer_cpu_previous = buffer_cpu;
 
-        // Unmap
-        return buffer_gpu->Unmap(offset, size);
+        return true;
     }
 
     bool Renderer::UpdateFrameBuffer(RHI_CommandList* cmd_list)
@@ -439,7 +515,7 @@ namespace Spartan
             return false;
         }
 
-        if (!update_dynamic_buffer<BufferFrame>(cmd_list, m_buffer_frame_gpu.get(), m_buffer_frame_cpu, m_buffer_frame_cpu_previous, m_buffer_frame_offset_index))
+        if (!update_dynamic_buffer<BufferFrame>(m_buffer_frame_gpu.get(), m_buffer_frame_cpu, m_buffer_frame_cpu_previous))
             return false;
 
         // Dynamic buffers with offsets have to be rebound whenever the offset changes
@@ -469,13 +545,44 @@ namespace Spartan
             m_buffer_material_cpu.mat_sheen_sheenTint_pad[i].y = material->GetProperty(Material_Sheen_Tint);
         }
 
-        if (!update_dynamic_buffer<BufferMaterial>(cmd_list, m_buffer_material_gpu.get(), m_buffer_material_cpu, m_buffer_material_cpu_previous, m_buffer_material_offset_index))
+        if (!update_dynamic_buffer<BufferMaterial>(m_buffer_material_gpu.get(), m_buffer_material_cpu, m_buffer_material_cpu_previous))
             return false;
 
         // Dynamic buffers with offsets have to be rebound whenever the offset changes
         return cmd_list->SetConstantBuffer(1, RHI_Shader_Pixel, m_buffer_material_gpu);
     }
 
+    uint32_t Renderer::AddBindlessMaterial(Material* material)
+    {
+        RHI_BindlessMaterial material_bindless;
+        material_bindless.color     = material->GetColorAlbedo();
+        material_bindless.tiling    = material->GetTiling();
+        material_bindless.offset    = material->GetOffset();
+        material_bindless.roughness = material->GetProperty(Material_Roughness);
+        material_bindless.metallic  = material->GetProperty(Material_Metallic);
+        material_bindless.normal    = material->GetProperty(Material_Normal);
+        material_bindless.height    = material->GetProperty(Material_Height);
+
+        // Textures which are still loading get an invalid index, in which case the shader falls back to the properties above
+        static const array<Material_Property, 8> texture_types =
+        {
+            Material_Color,
+            Material_Roughness,
+            Material_Metallic,
+            Material_Normal,
+            Material_Height,
+            Material_Occlusion,
+            Material_Emission,
+            Material_Mask
+        };
+        for (uint32_t i = 0; i < static_cast<uint32_t>(texture_types.size()); i++)
+        {
+            material_bindless.textures[i] = m_bindless_table->AddTexture(material->GetTexture_Ptr(texture_types[i]));
+        }
+
+        return m_bindless_table->AddMaterial(material_bindless);
+    }
+
     bool Renderer::UpdateUberBuffer(RHI_CommandList* cmd_list)
     {
         if (!cmd_list)
@@ -484,13 +591,29 @@ namespace Spartan
             return false;
         }
 
-        if (!update_dynamic_buffer<BufferUber>(cmd_list, m_buffer_uber_gpu.get(), m_buffer_uber_cpu, m_buffer_uber_cpu_previous, m_buffer_uber_offset_index))
+        if (!update_dynamic_buffer<BufferUber>(m_buffer_uber_gpu.get(), m_buffer_uber_cpu, m_buffer_uber_cpu_previous))
             return false;
 
         // Dynamic buffers with offsets have to be rebound whenever the offset changes
         return cmd_list->SetConstantBuffer(2, RHI_Shader_Vertex | RHI_Shader_Pixel | RHI_Shader_Compute, m_buffer_uber_gpu);
     }
 
+    bool Renderer::UpdateUberBuffer(RHI_CommandList* cmd_list, const uint32_t thread_index)
+    {
+        if (!cmd_list)
+        {
+            LOG_ERROR("Invalid command list");
+            return false;
+        }
+
+        RecordingThread& recording_thread = m_recording_threads[thread_index];
+        if (!update_dynamic_buffer<BufferUber>(recording_thread.buffer_uber_gpu.get(), recording_thread.buffer_uber_cpu, recording_thread.buffer_uber_cpu_previous))
+            return false;
+
+        // Dynamic buffers with offsets have to be rebound whenever the offset changes
+        return cmd_list->SetConstantBuffer(2, RHI_Shader_Vertex | RHI_Shader_Pixel | RHI_Shader_Compute, recording_thread.buffer_uber_gpu);
+    }
+
     bool Renderer::UpdateLightBuffer(RHI_CommandList* cmd_list, const Light* light)
     {
         if (!cmd_list)
@@ -510,6 +633,36 @@ namespace Spartan
             m_buffer_light_cpu.view_projection[i] = light->GetViewMatrix(i) * light->GetProjectionMatrix(i);
         }
 
+        m_buffer_light_cpu.intensity_range_angle_bias   = Vector4(GetLuminousIntensity(light), light->GetRange(), light->GetAngle(), GetOption(Render_ReverseZ) ? light->GetBias() : -light->GetBias());
+        m_buffer_light_cpu.color                        = light->GetColor();
+        m_buffer_light_cpu.normal_bias                  = light->GetNormalBias();
+        m_buffer_light_cpu.position                     = light->GetTransform()->GetPosition();
+        m_buffer_light_cpu.direction                    = light->GetDirection();
+
+        if (!update_dynamic_buffer<BufferLight>(m_buffer_light_gpu.get(), m_buffer_light_cpu, m_buffer_light_cpu_previous))
+            return false;
+
+        // Dynamic buffers with offsets have to be rebound whenever the offset changes
+        return cmd_list->SetConstantBuffer(3, RHI_Shader_Compute, m_buffer_light_gpu);
+    }
+
+    bool Renderer::UpdateLightClustersBuffer(RHI_CommandList* cmd_list)
+    {
+        if (!cmd_list)
+        {
+            LOG_ERROR("Invalid command list");
+            return false;
+        }
+
+        if (!update_dynamic_buffer<BufferLightClusters>(m_buffer_light_clusters_gpu.get(), m_buffer_light_clusters_cpu, m_buffer_light_clusters_cpu_previous))
+            return false;
+
+        // Dynamic buffers with offsets have to be rebound whenever the offset changes
+        return cmd_list->SetConstantBuffer(4, RHI_Shader_Compute, m_buffer_light_clusters_gpu);
+    }
+
+    float Renderer::GetLuminousIntensity(const Light* light) const
+    {
         // Convert luminous power to luminous intensity
         float luminous_intensity = light->GetIntensity() * m_camera->GetExposure();
         if (light->GetLightType() == LightType::Point)
@@ -523,17 +676,7 @@ namespace Spartan
             luminous_intensity *= 255.0f; // this is a hack, must fix whats my color units
         }
 
-        m_buffer_light_cpu.intensity_range_angle_bias   = Vector4(luminous_intensity, light->GetRange(), light->GetAngle(), GetOption(Render_ReverseZ) ? light->GetBias() : -light->GetBias());
-        m_buffer_light_cpu.color                        = light->GetColor();
-        m_buffer_light_cpu.normal_bias                  = light->GetNormalBias();
-        m_buffer_light_cpu.position                     = light->GetTransform()->GetPosition();
-        m_buffer_light_cpu.direction                    = light->GetDirection();
-
-        if (!update_dynamic_buffer<BufferLight>(cmd_list, m_buffer_light_gpu.get(), m_buffer_light_cpu, m_buffer_light_cpu_previous, m_buffer_light_offset_index))
-            return false;
-
-        // Dynamic buffers with offsets have to be rebound whenever the offset changes
-        return cmd_list->SetConstantBuffer(4, RHI_Shader_Pixel, m_buffer_light_gpu);
+        return luminous_intensity;
     }
 
     void Renderer::RenderablesAcquire(const Variant& entities_variant)
@@ -542,6 +685,7 @@ namespace Spartan
 
         // Clear previous state
         m_entities.clear();
+        m_entities_occluded.clear();
         m_camera = nullptr;
 
         vector<shared_ptr<Entity>> entities = entities_variant.Get<vector<shared_ptr<Entity>>>();
@@ -554,6 +698,7 @@ namespace Spartan
             Renderable* renderable  = entity->GetComponent<Renderable>();
             Light* light            = entity->GetComponent<Light>();
             Camera* camera          = entity->GetComponent<Camera>();
+            Animator* animator      = entity->GetComponent<Animator>();
 
             if (renderable)
             {
@@ -577,6 +722,11 @@ namespace Spartan
                 m_entities[Renderer_Object_Camera].emplace_back(entity.get());
                 m_camera = camera->GetPtrShared<Camera>();
             }
+
+            if (animator && renderable)
+            {
+                m_entities[Renderer_Object_Animator].emplace_back(entity.get());
+            }
         }
 
         RenderablesSort(&m_entities[Renderer_Object_Opaque]);
@@ -604,11 +754,399 @@ namespace Spartan
         });
     }
 
+    void Renderer::RenderablesOcclusionCull()
+    {
+        SCOPED_TIME_BLOCK(m_profiler);
+
+        // Clear previous state
+        m_entities_occluded[Renderer_Object_Opaque].clear();
+        m_entities_occluded[Renderer_Object_Transparent].clear();
+
+        if (!GetOption(Render_OcclusionCulling))
+            return;
+
+        m_occlusion_culler->Begin(m_buffer_frame_cpu.view_projection_unjittered, GetOption(Render_ReverseZ));
+
+        // Gather the visible occluders, the opaque renderables are only sorted when they are acquired so they are sorted here
+        const Vector3 camera_position = m_camera->GetTransform()->GetPosition();
+        m_occluders.clear();
+        for (Entity* entity : m_entities[Renderer_Object_Opaque])
+        {
+            Renderable* renderable = entity->GetRenderable();
+            if (!renderable || !renderable->IsOccluder())
+                continue;
+
+            Model* model = renderable->GeometryModel();
+            if (!model || !model->GetMesh())
+                continue;
+
+            if (!m_camera->IsInViewFrustrum(renderable))
+                continue;
+
+            m_occluders.emplace_back((renderable->GetAabb().GetCenter() - camera_position).LengthSquared(), entity);
+        }
+
+        // Add occluders front to back, so the nearest ones get the triangle budget first
+        sort(m_occluders.begin(), m_occluders.end(), [](const pair<float, Entity*>& a, const pair<float, Entity*>& b) { return a.first < b.first; });
+        for (const pair<float, Entity*>& occluder : m_occluders)
+        {
+            Entity* entity          = occluder.second;
+            Renderable* renderable  = entity->GetRenderable();
+            Mesh* mesh              = renderable->GeometryModel()->GetMesh().get();
+            if (!m_occlusion_culler->AddOccluder(mesh->Vertices_Get(), mesh->Indices_Get(), renderable->GeometryIndexOffset(), renderable->GeometryIndexCount(), renderable->GeometryVertexOffset(), entity->GetTransform()->GetMatrix()))
+                break;
+        }
+
+        if (m_occlusion_culler->GetOccluderCount() == 0)
+            return;
+
+        // Rasterise the occluders and build the hierarchical depth
+        m_occlusion_culler->End();
+
+        // Test the bounding boxes of the opaque and transparent renderables
+        Threading* threading = m_context->GetSubsystem<Threading>();
+        for (const Renderer_Object_Type object_type : { Renderer_Object_Opaque, Renderer_Object_Transparent })
+        {
+            const vector<Entity*>& entities = m_entities[object_type];
+            vector<uint8_t>& occluded       = m_entities_occluded[object_type];
+            occluded.assign(entities.size(), 0);
+
+            auto test = [this, &entities, &occluded](uint32_t start, uint32_t end)
+            {
+                for (uint32_t i = start; i < end; i++)
+                {
+                    if (Renderable* renderable = entities[i]->GetRenderable())
+                    {
+                        occluded[i] = m_occlusion_culler->IsVisible(renderable->GetAabb()) ? 0 : 1;
+                    }
+                }
+            };
+
+            threading->AddTaskLoop(test, static_cast<uint32_t>(entities.size()));
+        }
+
+        m_profiler->m_renderer_meshes_occluded  = m_occlusion_culler->GetOccludedCount();
+        m_profiler->m_renderer_occluders        = m_occlusion_culler->GetOccluderCount();
+    }
+
+    bool Renderer::IsLightClustered(const Light* light) const
+    {
+        // Shadow maps and volumetric lighting are bound per light, so those lights keep the per-light path
+        return
+            GetOption(Render_ClusteredLighting)                                 &&
+            light->GetIntensity() != 0.0f                                       &&
+            !light->GetShadowsEnabled()                                         &&
+            !(light->GetVolumetricEnabled() && GetOption(Render_VolumetricFog));
+    }
+
+    void Renderer::LightClustersBuild()
+    {
+        SCOPED_TIME_BLOCK(m_profiler);
+
+        // Clear previous state
+        const vector<Entity*>& entities = m_entities[Renderer_Object_Light];
+        m_lights_clustered.assign(entities.size(), 0);
+        m_buffer_light_clusters_cpu.params = Vector4::Zero;
+
+        // The clusters are built from a perspective frustum
+        if (!GetOption(Render_ClusteredLighting) || entities.empty() || m_camera->GetProjectionType() != Projection_Perspective)
+            return;
+
+        BufferLightClusters& buffer         = m_buffer_light_clusters_cpu;
+        const bool screen_space_shadows     = GetOption(Render_ScreenSpaceShadows);
+        auto write_light = [this, &buffer, screen_space_shadows](const Light* light, const uint32_t index)
+        {
+            const Vector4& color = light->GetColor();
+
+            uint32_t flags = 0;
+            flags |= light->GetLightType() == LightType::Spot                            ? 1 << 0 : 0;
+            flags |= (light->GetShadowsScreenSpaceEnabled() && screen_space_shadows)    ? 1 << 1 : 0;
+
+            buffer.position_range[index]    = Vector4(light->GetTransform()->GetPosition(), light->GetRange());
+            buffer.color_intensity[index]   = Vector4(color.x, color.y, color.z, GetLuminousIntensity(light));
+            buffer.direction_angle[index]   = Vector4(light->GetDirection(), light->GetAngle());
+            buffer.flags[index]             = flags;
+        };
+
+        // Directional lights go first, they are not binned as they affect every cluster
+        uint32_t directional_count = 0;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(entities.size()); i++)
+        {
+            Light* light = entities[i]->GetComponent<Light>();
+            if (!light || light->GetLightType() != LightType::Directional || !IsLightClustered(light))
+                continue;
+
+            if (directional_count >= LightClusters::max_lights)
+                break;
+
+            write_light(light, directional_count++);
+            m_lights_clustered[i] = 1;
+        }
+
+        // Point and spot lights get binned, any that don't fit the budget fall back to the per-light path
+        m_light_clusters->Begin(m_buffer_frame_cpu.view, m_camera->GetProjectionMatrix(), m_camera->GetNearPlane(), m_camera->GetFarPlane());
+        for (uint32_t i = 0; i < static_cast<uint32_t>(entities.size()); i++)
+        {
+            Light* light = entities[i]->GetComponent<Light>();
+            if (!light || light->GetLightType() == LightType::Directional || !IsLightClustered(light))
+                continue;
+
+            if (directional_count + m_light_clusters->GetLightCount() >= LightClusters::max_lights)
+                break;
+
+            if (!m_light_clusters->AddLight(light->GetTransform()->GetPosition(), light->GetRange()))
+                break;
+
+            write_light(light, directional_count + m_light_clusters->GetLightCount() - 1);
+            m_lights_clustered[i] = 1;
+        }
+        m_light_clusters->End();
+
+        // Upload
+        const uint32_t light_count = directional_count + m_light_clusters->GetLightCount();
+        buffer.params = Vector4(m_light_clusters->GetSliceScale(), m_light_clusters->GetSliceBias(), static_cast<float>(directional_count), static_cast<float>(light_count));
+        memcpy(buffer.cluster_offset_count.data(), m_light_clusters->GetClusterOffsetCount().data(), sizeof(buffer.cluster_offset_count));
+        memcpy(buffer.cluster_indices.data(), m_light_clusters->GetIndices().data(), sizeof(buffer.cluster_indices));
+
+        m_profiler->m_renderer_lights_clustered                 = light_count;
+        m_profiler->m_renderer_light_cluster_indices            = m_light_clusters->GetIndexCount();
+        m_profiler->m_renderer_light_cluster_indices_dropped    = m_light_clusters->GetIndexDroppedCount();
+    }
+
+    void Renderer::AnimatorsUpdate()
+    {
+        SCOPED_TIME_BLOCK(m_profiler);
+
+        const vector<Entity*>& entities = m_entities[Renderer_Object_Animator];
+        if (entities.empty())
+            return;
+
+        // Animators only touch their own state and buffers, so they are evaluated in parallel.
+        // When skinning on the GPU, every animator claims a range of the bone buffer for it's palette.
+        const Stopwatch timer;
+        const uint32_t frame_slot   = m_swap_chain->GetCmdIndex();
+        Matrix* bones               = GetOption(Render_GpuSkinning) ? m_bones_cpu.data() : nullptr;
+        atomic<uint32_t> evaluated  = 0;
+        atomic<uint32_t> bone_count = 0;
+        m_threading->AddTaskLoop([&entities, &evaluated, &bone_count, bones, frame_slot](uint32_t start, uint32_t end)
+        {
+            for (uint32_t i = start; i < end; i++)
+            {
+                Animator* animator = entities[i]->GetComponent<Animator>();
+                if (!animator)
+                    continue;
+
+                const uint32_t bone_count_animator  = bones ? animator->GetBoneCount() : 0;
+                const uint32_t bone_offset          = bone_count_animator ? bone_count.fetch_add(bone_count_animator) : 0;
+                if (bone_count_animator && bone_offset + bone_count_animator > m_max_bones)
+                {
+                    LOG_ERROR("Bone buffer has reached it's maximum capacity of %d elements. Consider increasing the size.", m_max_bones);
+                    continue;
+                }
+
+                evaluated += animator->Evaluate(frame_slot, bone_count_animator ? bones : nullptr, bone_offset) ? 1 : 0;
+            }
+        }, static_cast<uint32_t>(entities.size()));
+
+        // Upload the palettes of the frame
+        const uint32_t bone_count_total = Math::Helper::Min(bone_count.load(), m_max_bones);
+        if (bone_count_total != 0 && !m_bones_gpu->Update(m_bones_cpu.data(), bone_count_total))
+        {
+            LOG_ERROR("Failed to update the bone buffer");
+        }
+
+        m_profiler->m_renderer_animators        = evaluated;
+        m_profiler->m_renderer_animators_time   = timer.GetElapsedTimeMs();
+    }
+
+    uint32_t Renderer::DrawMeshlets(RHI_CommandList* cmd_list, const Renderable* renderable, const Matrix& transform) const
+    {
+        const uint32_t index_offset = renderable->GeometryIndexOffset();
+        const uint32_t index_count  = renderable->GeometryIndexCount();
+
+        uint32_t meshlet_count                  = 0;
+        const MeshOptimizer::Meshlet* meshlets  = renderable->GeometryModel()->GetMesh()->Meshlets_Find(index_offset, index_count, &meshlet_count);
+
+        // Nothing to gain from a single meshlet, the renderable itself has already been culled
+        if (meshlet_count <= 1)
+        {
+            cmd_list->DrawIndexed(index_count, index_offset, renderable->GeometryVertexOffset());
+            return index_count / 3;
+        }
+
+        // Meshlets are in model space, the normal cones only survive uniform scaling
+        const Vector3 camera_position   = m_camera->GetTransform()->GetPosition();
+        const Vector3 scale             = transform.GetScale().Abs();
+        const float scale_max           = Helper::Max3(scale.x, scale.y, scale.z);
+        const bool cone_culling         = Helper::Abs(scale.x - scale.y) < 0.001f * scale_max && Helper::Abs(scale.x - scale.z) < 0.001f * scale_max;
+
+        // Draw the visible meshlets, adjacent ones are merged into a single draw
+        uint32_t draw_offset        = 0;
+        uint32_t draw_count         = 0;
+        uint32_t triangles_drawn    = 0;
+        uint32_t meshlets_culled    = 0;
+        for (uint32_t i = 0; i <= meshlet_count; i++)
+        {
+            bool visible = false;
+            if (i < meshlet_count)
+            {
+                const MeshOptimizer::Meshlet& meshlet = meshlets[i];
+                const Vector3 center = transform * meshlet.center;
+                const float radius   = meshlet.radius * scale_max;
+
+                visible = m_camera->IsInViewFrustrum(center, Vector3(radius));
+
+                if (visible && cone_culling && meshlet.cone_cutoff < 1.0f)
+                {
+                    const Vector3 axis      = (transform * (meshlet.center + meshlet.cone_axis) - center).Normalized();
+                    const Vector3 direction = center - camera_position;
+                    visible = Vector3::Dot(direction, axis) < meshlet.cone_cutoff * direction.Length() + radius;
+                }
+
+                meshlets_culled += visible ? 0 : 1;
+            }
+
+            if (visible && draw_count != 0 && draw_offset + draw_count == meshlets[i].index_offset)
+            {
+                draw_count += meshlets[i].index_count;
+                continue;
+            }
+
+            if (draw_count != 0)
+            {
+                cmd_list->DrawIndexed(draw_count, draw_offset, renderable->GeometryVertexOffset());
+                triangles_drawn += draw_count / 3;
+                draw_count = 0;
+            }
+
+            if (visible)
+            {
+                draw_offset = meshlets[i].index_offset;
+                draw_count  = meshlets[i].index_count;
+            }
+        }
+
+        m_profiler->m_renderer_meshlets         += meshlet_count;
+        m_profiler->m_renderer_meshlets_culled  += meshlets_culled;
+
+        return triangles_drawn;
+    }
+
+    void Renderer::ShadowCastersAcquire(const Light* light, const uint32_t array_index, const vector<Entity*>& entities, const bool split_static, vector<Entity*>* casters_static, vector<Entity*>* casters_dynamic)
+    {
+        casters_static->clear();
+        casters_dynamic->clear();
+
+        // Receiver aware culling (directional lights only).
+        // Cascades cover a lot of space and a caster only matters if its shadow can land on something the camera sees, which means
+        // that it has to overlap the receivers on the light's view plane and be closer to the light than the furthest receiver.
+        // Volumetric fog samples the shadow map in thin air, so in that case everything in the cascade is a receiver.
+        const bool cull_receivers   = light->GetLightType() == LightType::Directional && !(light->GetVolumetricEnabled() && GetOption(Render_VolumetricFog));
+        const Matrix& view          = light->GetViewMatrix(array_index);
+        BoundingBox receivers;
+        const bool has_receivers    = !cull_receivers || ShadowReceiversBounds(light, array_index, &receivers);
+
+        for (Entity* entity : entities)
+        {
+            // Acquire renderable component
+            Renderable* renderable = entity->GetRenderable();
+            if (!renderable)
+                continue;
+
+            // Skip meshes that don't cast shadows
+            if (!renderable->GetCastShadows())
+                continue;
+
+            // Acquire geometry
+            Model* model = renderable->GeometryModel();
+            if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
+                continue;
+
+            // Acquire material
+            if (!renderable->GetMaterial())
+                continue;
+
+            // Skip objects outside of the view frustum
+            if (!has_receivers || !light->IsInViewFrustrum(renderable, array_index))
+            {
+                m_profiler->m_renderer_shadow_casters_culled++;
+                continue;
+            }
+
+            // Skip objects which can't cast a shadow on any of the receivers
+            if (cull_receivers)
+            {
+                const BoundingBox caster = renderable->GetAabb().Transform(view);
+
+                const bool overlaps =
+                    caster.GetMin().x <= receivers.GetMax().x && caster.GetMax().x >= receivers.GetMin().x &&
+                    caster.GetMin().y <= receivers.GetMax().y && caster.GetMax().y >= receivers.GetMin().y;
+
+                if (!overlaps || caster.GetMin().z > receivers.GetMax().z)
+                {
+                    m_profiler->m_renderer_shadow_casters_culled++;
+                    continue;
+                }
+            }
+
+            if (split_static && renderable->IsStatic() && !model->IsAnimated()) // skinned geometry changes every frame
+            {
+                casters_static->emplace_back(entity);
+            }
+            else
+            {
+                casters_dynamic->emplace_back(entity);
+            }
+        }
+    }
+
+    bool Renderer::ShadowReceiversBounds(const Light* light, const uint32_t array_index, BoundingBox* bounds)
+    {
+        if (!m_camera)
+            return false;
+
+        // Merge the bounds, in light space, of everything that the camera can see within the light's slice
+        const Matrix& view  = light->GetViewMatrix(array_index);
+        bool has_receivers  = false;
+        *bounds             = BoundingBox();
+
+        for (const Renderer_Object_Type object_type : { Renderer_Object_Opaque, Renderer_Object_Transparent })
+        {
+            const vector<Entity*>& entities = m_entities[object_type];
+            const vector<uint8_t>& occluded = m_entities_occluded[object_type];
+
+            for (uint32_t i = 0; i < static_cast<uint32_t>(entities.size()); i++)
+            {
+                Renderable* renderable = entities[i]->GetRenderable();
+                if (!renderable)
+                    continue;
+
+                if (i < occluded.size() && occluded[i])
+                    continue;
+
+                if (!m_camera->IsInViewFrustrum(renderable) || !light->IsInViewFrustrum(renderable, array_index))
+                    continue;
+
+                bounds->Merge(renderable->GetAabb().Transform(view));
+                has_receivers = true;
+            }
+        }
+
+        return has_receivers;
+    }
+
     void Renderer::Clear()
     {
         // Flush to remove references to entity resources that will be deallocated
         Flush();
         m_entities.clear();
+        m_entities_occluded.clear();
+        m_occluders.clear();
+        m_shadow_caster_lods.clear();
+        m_draw_calls.clear();
+        m_indirect_batches.clear();
+        m_indirect_batch_indices.clear();
+        m_indirect_material_indices.clear();
     }
 
     const shared_ptr<Spartan::RHI_Texture>& Renderer::GetEnvironmentTexture()
@@ -626,6 +1164,9 @@ namespace Spartan
 
     void Renderer::SetOption(Renderer_Option option, bool enable)
     {
+        if (option == Render_ClusteredLighting && enable && !GetOption(option) && !light_clusters_supported())
+            return;
+
         if (enable && !GetOption(option))
         {
             m_options |= option;
@@ -638,6 +1179,12 @@ namespace Spartan
         {
             return;
         }
+
+        // Only the render targets which async compute passes access are shared with the compute queue, so they have to be re-created
+        if (option == Render_AsyncCompute && m_initialized)
+        {
+            CreateRenderTextures();
+        }
     }
 
     void Renderer::SetOptionValue(Renderer_Option_Value option, float value)
@@ -738,12 +1285,76 @@ namespace Spartan
         return RHI_Context::texture_2d_dimension_max;
     }
 
+    RHI_DescriptorSetLayoutCache* Renderer::GetDescriptorLayoutSetCache(const uint32_t thread_index) const
+    {
+        return thread_index < m_recording_threads.size() ? m_recording_threads[thread_index].descriptor_set_layout_cache.get() : nullptr;
+    }
+
     void Renderer::SetGlobalShaderObjectTransform(RHI_CommandList* cmd_list, const Math::Matrix& transform)
     {
         m_buffer_uber_cpu.transform = transform;
         UpdateUberBuffer(cmd_list);
     }
 
+    void Renderer::RecordParallel(RHI_CommandList* cmd_list, const uint32_t draw_count, const function<void(RHI_CommandList*, const uint32_t, const uint32_t, const uint32_t)>& record)
+    {
+        // Has to be called after BeginRenderPass(), the draws [0, draw_count) are split into contiguous ranges, one per thread index.
+        // Every range is recorded into a secondary command list which the primary executes in order, so the draw order is preserved.
+
+        // Only split when there are enough draws to make up for the overhead of the secondary command lists
+        uint32_t thread_count = 1;
+        if (GetOption(Render_ParallelRecording))
+        {
+            thread_count = Math::Helper::Min(m_threading->GetThreadsAvailable() + 1, static_cast<uint32_t>(m_recording_threads.size()));
+            thread_count = Math::Helper::Min(thread_count, draw_count / m_recording_draws_per_thread_min);
+        }
+
+        // Acquire secondary command lists
+        m_cmd_lists_secondary.clear();
+        if (thread_count > 1)
+        {
+            for (uint32_t thread_index = 0; thread_index < thread_count; thread_index++)
+            {
+                RHI_CommandList* cmd_list_secondary = cmd_list->GetSecondary(thread_index);
+                if (!cmd_list_secondary)
+                {
+                    m_cmd_lists_secondary.clear();
+                    break;
+                }
+
+                m_cmd_lists_secondary.emplace_back(cmd_list_secondary);
+            }
+        }
+
+        // Record into the primary, if there is nothing to gain or the backend doesn't support secondary command lists
+        if (m_cmd_lists_secondary.empty())
+        {
+            record(cmd_list, 0, 0, draw_count);
+            return;
+        }
+
+        // Record, every range is recorded by exactly one thread (the current one included), and the loop returns once all of them are done
+        const uint32_t draws_per_thread = (draw_count + thread_count - 1) / thread_count;
+        auto record_ranges = [this, &record, draws_per_thread, draw_count](const uint32_t thread_index_start, const uint32_t thread_index_end)
+        {
+            for (uint32_t thread_index = thread_index_start; thread_index < thread_index_end; thread_index++)
+            {
+                RHI_CommandList* cmd_list_secondary = m_cmd_lists_secondary[thread_index];
+                const uint32_t start                = Math::Helper::Min(thread_index * draws_per_thread, draw_count);
+                const uint32_t end                  = Math::Helper::Min(start + draws_per_thread, draw_count);
+
+                if (cmd_list_secondary->Begin())
+                {
+                    record(cmd_list_secondary, thread_index, start, end);
+                    cmd_list_secondary->End();
+                }
+            }
+        };
+        m_threading->AddTaskLoop(record_ranges, thread_count);
+
+        cmd_list->ExecuteSecondary(m_cmd_lists_secondary);
+    }
+
     void Renderer::Stop()
     {
         // Notify stop
@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <unordered_map>
 #include <array>
 #include <atomic>
+#include <functional>
 #include "Renderer_ConstantBuffers.h"
 #include "Renderer_Enums.h"
 #include "Material.h"
@@ -39,6 +40,7 @@ namespace Spartan
 {
     // Forward declarations
     class Entity;
+    class Renderable;
     class Camera;
     class Light;
     class ResourceCache;
@@ -47,6 +49,11 @@ namespace Spartan
     class Grid;
     class Transform_Gizmo;
     class Profiler;
+    class Threading;
+    class OcclusionCuller;
+    class LightClusters;
+    class RenderGraph;
+    class Model;
 
     namespace Math
     {
@@ -146,12 +153,17 @@ namespace Spartan
         // Misc
         const std::shared_ptr<RHI_Device>& GetRhiDevice()           const { return m_rhi_device; }
         RHI_PipelineCache* GetPipelineCache()                       const { return m_pipeline_cache.get(); }
+        RHI_ShaderCache* GetShaderCache()                           const { return m_shader_cache.get(); }
         RHI_DescriptorSetLayoutCache* GetDescriptorLayoutSetCache() const { return m_descriptor_set_layout_cache.get(); }
+        RHI_UploadAllocator* GetUploadAllocator()                   const { return m_upload_allocator.get(); }
+        RHI_BindlessTable* GetBindlessTable()                       const { return m_bindless_table.get(); }
+        RHI_DescriptorSetLayoutCache* GetDescriptorLayoutSetCache(const uint32_t thread_index) const;
         RHI_Texture* GetFrameTexture()                              const { return m_render_targets.at(RendererRt::Frame_Ldr).get(); }
         auto GetFrameNum()                                          const { return m_frame_num; }
         std::shared_ptr<Camera> GetCamera()                         const { return m_camera; }
         auto IsInitialized()                                        const { return m_initialized; }
         auto GetShaders()                                           const { return m_shaders; }
+        Font* GetFont()                                             const { return m_font.get(); } // text added during a frame is batched and drawn on top of it
         uint32_t GetMaxResolution() const;
         void Clear();
 
@@ -161,6 +173,7 @@ namespace Spartan
     private:
         // Resource creation
         void CreateConstantBuffers();
+        void CreateStructuredBuffers();
         void CreateDepthStencilStates();
         void CreateRasterizerStates();
         void CreateBlendStates();
@@ -174,14 +187,18 @@ namespace Spartan
         void Pass_Main(RHI_CommandList* cmd_list);
         void Pass_UpdateFrameBuffer(RHI_CommandList* cmd_list);
         void Pass_LightDepth(RHI_CommandList* cmd_list, const Renderer_Object_Type object_type);
+        void Pass_LightDepthCasters(RHI_CommandList* cmd_list, RHI_PipelineState& pso, const Light* light, const uint32_t array_index, const std::vector<Entity*>& casters, const bool transparent_pass);
         void Pass_DepthPrePass(RHI_CommandList* cmd_list);
         void Pass_GBuffer(RHI_CommandList* cmd_list, const bool is_transparent_pass = false);
+        bool Pass_GBufferIndirect(RHI_CommandList* cmd_list, RHI_PipelineState& pso, uint32_t* material_index_last);
         void Pass_Ssgi(RHI_CommandList* cmd_list);
         void Pass_SsgiInject(RHI_CommandList* cmd_list);
         void Pass_Ssao(RHI_CommandList* cmd_list);
+        void Pass_SsaoBlur(RHI_CommandList* cmd_list);
         void Pass_SsrTrace(RHI_CommandList* cmd_list);
         void Pass_Reflections(RHI_CommandList* cmd_list, RHI_Texture* tex_out, RHI_Texture* tex_reflections);
         void Pass_Light(RHI_CommandList* cmd_list, const bool is_transparent_pass = false);
+        void Pass_LightClustered(RHI_CommandList* cmd_list, RHI_Texture* tex_diffuse, RHI_Texture* tex_specular, const bool is_transparent_pass);
         void Pass_LightComposition(RHI_CommandList* cmd_list, RHI_Texture* tex_out, const bool is_transparent_pass = false);
         void Pass_LightImageBased(RHI_CommandList* cmd_list, RHI_Texture* tex_out, const bool is_transparent_pass = false);
         void Pass_PostProcess(RHI_CommandList* cmd_list);
@@ -211,12 +228,41 @@ namespace Spartan
         // Constant buffers
         bool UpdateFrameBuffer(RHI_CommandList* cmd_list);
         bool UpdateMaterialBuffer(RHI_CommandList* cmd_list);
+        uint32_t AddBindlessMaterial(Material* material);
         bool UpdateUberBuffer(RHI_CommandList* cmd_list);
+        bool UpdateUberBuffer(RHI_CommandList* cmd_list, const uint32_t thread_index);
         bool UpdateLightBuffer(RHI_CommandList* cmd_list, const Light* light);
+        bool UpdateLightClustersBuffer(RHI_CommandList* cmd_list);
 
         // Misc
+        void Render(float delta_time);
         void RenderablesAcquire(const Variant& renderables);
         void RenderablesSort(std::vector<Entity*>* renderables);
+        void RenderablesOcclusionCull();
+        void LightClustersBuild();
+        void AnimatorsUpdate();
+        void RenderGraphBuild();
+        void RecordParallel(RHI_CommandList* cmd_list, const uint32_t draw_count, const std::function<void(RHI_CommandList*, const uint32_t, const uint32_t, const uint32_t)>& record);
+        bool IsLightClustered(const Light* light) const;
+        float GetLuminousIntensity(const Light* light) const;
+        void ShadowCastersAcquire(const Light* light, const uint32_t array_index, const std::vector<Entity*>& entities, const bool split_static, std::vector<Entity*>* casters_static, std::vector<Entity*>* casters_dynamic);
+        bool ShadowReceiversBounds(const Light* light, const uint32_t array_index, Math::BoundingBox* bounds);
+        uint32_t DrawMeshlets(RHI_CommandList* cmd_list, const Renderable* renderable, const Math::Matrix& transform) const;
+        bool SetPipelineStateSkinned(RHI_PipelineState& pso, const bool skinned) const; // swaps the vertex shader for (or back from) the variation which skins on the GPU
+
+        // The vertices a renderable is drawn from, skinned renderables use what their animator wrote for this frame,
+        // or the skinned buffers of the model and the bones the animator wrote (in which case the vertex shader has to skin them)
+        struct GeometryBinding
+        {
+            const RHI_VertexBuffer* vertex_buffer           = nullptr;
+            const RHI_VertexBuffer* vertex_buffer_position  = nullptr;
+            const Math::Matrix* vertex_transform            = nullptr;
+            uint32_t vertex_offset                          = 0;
+            uint32_t bone_offset                            = 0;
+            bool skinned                                    = false;
+            bool skinned_gpu                                = false;
+        };
+        static GeometryBinding GetGeometry(const Entity* entity, const Renderable* renderable, const Model* model);
 
         // Render textures
         std::unordered_map<RendererRt, std::shared_ptr<RHI_Texture>> m_render_targets;
@@ -286,6 +332,10 @@ namespace Spartan
         // Misc
         Math::Rectangle m_viewport_quad;
         std::unique_ptr<Font> m_font;
+        std::shared_ptr<RHI_IndexBuffer> m_font_quad_index_buffer; // static, shared by the text batches of all fonts
+        std::unique_ptr<OcclusionCuller> m_occlusion_culler;
+        std::unique_ptr<LightClusters> m_light_clusters;
+        std::unique_ptr<RenderGraph> m_render_graph;
         Math::Vector2 m_taa_jitter                  = Math::Vector2::Zero;
         Math::Vector2 m_taa_jitter_previous         = Math::Vector2::Zero;
         RendererRt m_render_target_debug            = RendererRt::Undefined;
@@ -303,41 +353,103 @@ namespace Spartan
         // RHI Core
         std::shared_ptr<RHI_Device> m_rhi_device;
         std::shared_ptr<RHI_PipelineCache> m_pipeline_cache;
+        std::shared_ptr<RHI_ShaderCache> m_shader_cache;
         std::shared_ptr<RHI_DescriptorSetLayoutCache> m_descriptor_set_layout_cache;
+        std::shared_ptr<RHI_UploadAllocator> m_upload_allocator;
+        std::shared_ptr<RHI_BindlessTable> m_bindless_table;
 
         // Swapchain
         static const uint8_t m_swap_chain_buffer_count = 3;
         std::shared_ptr<RHI_SwapChain> m_swap_chain;
 
+        // Async compute, a command list per swapchain buffer and a timeline semaphore per queue
+        std::vector<std::shared_ptr<RHI_CommandList>> m_cmd_lists_async;
+        std::shared_ptr<RHI_Semaphore> m_semaphore_graphics;
+        std::shared_ptr<RHI_Semaphore> m_semaphore_async;
+
         //= CONSTANT BUFFERS =====================================
         BufferFrame m_buffer_frame_cpu;
         BufferFrame m_buffer_frame_cpu_previous;
         std::shared_ptr<RHI_ConstantBuffer> m_buffer_frame_gpu;
-        uint32_t m_buffer_frame_offset_index = 0;
 
         BufferMaterial m_buffer_material_cpu;
         BufferMaterial m_buffer_material_cpu_previous;
         std::shared_ptr<RHI_ConstantBuffer> m_buffer_material_gpu;
-        uint32_t m_buffer_material_offset_index = 0;
 
         BufferUber m_buffer_uber_cpu;
         BufferUber m_buffer_uber_cpu_previous;
         std::shared_ptr<RHI_ConstantBuffer> m_buffer_uber_gpu;
-        uint32_t m_buffer_uber_offset_index = 0;
 
         BufferLight m_buffer_light_cpu;
         BufferLight m_buffer_light_cpu_previous;
         std::shared_ptr<RHI_ConstantBuffer> m_buffer_light_gpu;
-        uint32_t m_buffer_light_offset_index = 0;
+
+        BufferLightClusters m_buffer_light_clusters_cpu;
+        BufferLightClusters m_buffer_light_clusters_cpu_previous;
+        std::shared_ptr<RHI_ConstantBuffer> m_buffer_light_clusters_gpu;
         //========================================================
 
+        // GPU-driven drawing, instances are uploaded every frame, the arguments and counts are written by the culling shader
+        std::vector<BufferInstance> m_instances_cpu;
+        std::shared_ptr<RHI_StructuredBuffer> m_instances_gpu;
+        std::shared_ptr<RHI_StructuredBuffer> m_indirect_arguments;
+        std::shared_ptr<RHI_StructuredBuffer> m_indirect_count;
+
+        // GPU-driven batches, one per model, rebuilt every frame (and dropped along with the world, they point to it's models)
+        struct IndirectBatch
+        {
+            Model* model;
+            uint32_t instance_count;
+            uint32_t draw_offset;
+        };
+        std::vector<IndirectBatch> m_indirect_batches;
+        std::unordered_map<Model*, uint32_t> m_indirect_batch_indices;
+        std::unordered_map<uint32_t, std::pair<uint32_t, uint32_t>> m_indirect_material_indices; // material id to material index and bindless index
+
+        // GPU skinning, the animators write their bone matrices from the offset they are given, uploaded once per frame
+        std::vector<Math::Matrix> m_bones_cpu;
+        std::shared_ptr<RHI_StructuredBuffer> m_bones_gpu;
+
+        // Parallel recording, every thread index gets it's own uber buffer and descriptor pool so that it can record without locking
+        struct RecordingThread
+        {
+            BufferUber buffer_uber_cpu;
+            BufferUber buffer_uber_cpu_previous;
+            std::shared_ptr<RHI_ConstantBuffer> buffer_uber_gpu;
+            std::shared_ptr<RHI_DescriptorSetLayoutCache> descriptor_set_layout_cache;
+        };
+        std::vector<RecordingThread> m_recording_threads;
+        std::vector<RHI_CommandList*> m_cmd_lists_secondary;
+        const uint32_t m_recording_draws_per_thread_min = 32;
+
+        // Draws which have been culled and assigned a material instance up front, so that they can be recorded by any thread
+        struct DrawCall
+        {
+            Entity* entity;
+            Renderable* renderable;
+            Model* model;
+            Material* material;
+            uint32_t material_index;
+            uint32_t material_index_bindless;
+            uint32_t lod;
+            GeometryBinding geometry;
+        };
+        std::vector<DrawCall> m_draw_calls;
+
         // Entities and material references
         std::unordered_map<Renderer_Object_Type, std::vector<Entity*>> m_entities;
+        std::unordered_map<Renderer_Object_Type, std::vector<uint8_t>> m_entities_occluded; // parallel to m_entities, filled every frame
+        std::vector<std::pair<float, Entity*>> m_occluders; // visible occluders and their distance to the camera, filled every frame
+        std::vector<Entity*> m_shadow_casters_static;
+        std::vector<std::vector<Entity*>> m_shadow_casters_dynamic; // one list per shadow map slice
+        std::vector<uint32_t> m_shadow_caster_lods; // parallel to the casters being drawn, filled every shadow map slice
+        std::vector<uint8_t> m_lights_clustered; // parallel to m_entities[Renderer_Object_Light], filled every frame
         std::array<Material*, m_max_material_instances> m_material_instances;
         std::shared_ptr<Camera> m_camera;
 
         // Dependencies
         Profiler* m_profiler            = nullptr;
         ResourceCache* m_resource_cache = nullptr;
+        Threading* m_threading          = nullptr;
     };
 }
@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Math/Vector2.h"
 #include "../Math/Vector3.h"
 #include "../Math/Matrix.h"
+#include "LightClusters.h"
 //==========================
 
 namespace Spartan
@@ -147,7 +148,10 @@ namespace Spartan
         float mat_id;
         uint32_t mip_index;
         float is_transparent_pass;
-        float padding;
+        float mat_bindless_index;
+
+        uint32_t bone_offset;
+        uint32_t padding[3];
 
         bool operator==(const BufferUber& rhs) const
         {
@@ -155,6 +159,7 @@ namespace Spartan
                 transform           == rhs.transform            &&
                 transform_previous  == rhs.transform_previous   &&
                 mat_id              == rhs.mat_id               &&
+                mat_bindless_index  == rhs.mat_bindless_index   &&
                 mat_albedo          == rhs.mat_albedo           &&
                 mat_tiling_uv       == rhs.mat_tiling_uv        &&
                 mat_offset_uv       == rhs.mat_offset_uv        &&
@@ -168,12 +173,38 @@ namespace Spartan
                 blur_direction      == rhs.blur_direction       &&
                 mip_index           == rhs.mip_index            &&
                 is_transparent_pass == rhs.is_transparent_pass  &&
-                resolution          == rhs.resolution;
+                resolution          == rhs.resolution           &&
+                bone_offset         == rhs.bone_offset;
         }
 
         bool operator!=(const BufferUber& rhs) const { return !(*this == rhs); }
     };
     
+    // GPU-driven drawing - One per instance, read by the culling shader and the indirect G-Buffer vertex shader (structured buffer)
+    static const uint32_t m_max_instances = 8192;
+    struct BufferInstance
+    {
+        Math::Matrix transform;
+        Math::Matrix transform_previous;
+
+        Math::Vector3 aabb_min; // world space
+        uint32_t index_count;
+
+        Math::Vector3 aabb_max; // world space
+        uint32_t index_offset;
+
+        uint32_t vertex_offset;
+        uint32_t batch;         // index of the draw count of the model this instance belongs to
+        uint32_t batch_offset;  // index of the first draw argument of that model
+        uint32_t mat_id;
+
+        uint32_t mat_bindless_index;
+        uint32_t padding[3];
+    };
+
+    // GPU skinning - The bone matrices of every animator skinned by the vertex shaders this frame (structured buffer)
+    static const uint32_t m_max_bones = 8192;
+
     // Light buffer
     struct BufferLight
     {
@@ -195,4 +226,30 @@ namespace Spartan
                 direction                   == rhs.direction;
         }
     };
+
+    // Clustered light buffer - Updates once per frame
+    struct BufferLightClusters
+    {
+        Math::Vector4 params; // x: slice scale, y: slice bias, z: directional light count, w: light count
+        std::array<Math::Vector4, LightClusters::max_lights> position_range;
+        std::array<Math::Vector4, LightClusters::max_lights> color_intensity;
+        std::array<Math::Vector4, LightClusters::max_lights> direction_angle;
+        std::array<uint32_t, LightClusters::max_lights> flags;                      // bit 0: spot, bit 1: screen space shadows
+        std::array<uint32_t, LightClusters::cluster_count> cluster_offset_count;    // offset in the low 16 bits, count in the high 16 bits
+        std::array<uint32_t, LightClusters::max_indices / 4> cluster_indices;       // four 8-bit light indices per element
+
+        bool operator==(const BufferLightClusters& rhs) const
+        {
+            return
+                params                  == rhs.params               &&
+                position_range          == rhs.position_range       &&
+                color_intensity         == rhs.color_intensity      &&
+                direction_angle         == rhs.direction_angle      &&
+                flags                   == rhs.flags                &&
+                cluster_offset_count    == rhs.cluster_offset_count &&
+                cluster_indices         == rhs.cluster_indices;
+        }
+
+        bool operator!=(const BufferLightClusters& rhs) const { return !(*this == rhs); }
+    };
 }
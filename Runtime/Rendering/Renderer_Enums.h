@@ -71,7 +71,9 @@ namespace Spartan
         tex         = 31,
         tex2        = 32,
         font_atlas  = 33,
-        ssgi        = 34
+        ssgi        = 34,
+        instances   = 35,
+        bones       = 36
     };
 
     // Unordered access views bindings
@@ -83,15 +85,22 @@ namespace Spartan
         rgba        = 3,
         rgb2        = 4,
         rgb3        = 5,
-        array_rgba  = 6
+        array_rgba          = 6,
+        indirect_arguments  = 7,
+        indirect_count      = 8
     };
 
     // Shaders
     enum class RendererShader : uint8_t
     {
         Gbuffer_V,
+        Gbuffer_Indirect_V,
+        Gbuffer_Skinned_V,
         Gbuffer_P,
         Depth_V,
+        Depth_PositionOnly_V,
+        Depth_Skinned_V,
+        Depth_PositionOnly_Skinned_V,
         Depth_P,
         Quad_V,
         Texture_P,
@@ -122,6 +131,7 @@ namespace Spartan
         BrdfSpecularLut_C,
         Light_C,
         Light_Composition_C,
+        Light_Clustered_C,
         Light_ImageBased_P,
         Color_V,
         Color_P,
@@ -133,12 +143,14 @@ namespace Spartan
         SsrTrace_C,
         Reflections_P,
         Entity_V,
+        Entity_Skinned_V,
         Entity_Transform_P,
         BlurBox_P,
         BlurGaussian_P,
         BlurGaussianBilateral_P,
         Entity_Outline_P,
-        GenerateMips_C
+        GenerateMips_C,
+        Culling_C
     };
 
     // Render targets
@@ -199,7 +211,14 @@ namespace Spartan
         Render_ChromaticAberration      = 1 << 21,
         Render_Dithering                = 1 << 22,
         Render_ReverseZ                 = 1 << 23,
-        Render_DepthPrepass             = 1 << 24
+        Render_DepthPrepass             = 1 << 24,
+        Render_OcclusionCulling         = 1 << 25,
+        Render_ClusteredLighting        = 1 << 26,
+        Render_ParallelRecording        = 1 << 27,
+        Render_Bindless                 = 1 << 28,
+        Render_GpuDriven                = 1 << 29,
+        Render_AsyncCompute             = 1 << 30,
+        Render_GpuSkinning              = 1u << 31
     };
 
     // Renderer/graphics options values
@@ -229,6 +248,7 @@ namespace Spartan
         Renderer_Object_Opaque,
         Renderer_Object_Transparent,
         Renderer_Object_Light,
-        Renderer_Object_Camera
+        Renderer_Object_Camera,
+        Renderer_Object_Animator
     };
 }
@@ -19,12 +19,13 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES ==============================
+//= INCLUDES ===============================
 #include "Spartan.h"
 #include "Renderer.h"
 #include "Model.h"
 #include "ShaderGBuffer.h"
 #include "ShaderLight.h"
+#include "RenderGraph.h"
 #include "Font/Font.h"
 #include "Gizmos/Grid.h"
 #include "Gizmos/Transform_Gizmo.h"
@@ -35,12 +36,17 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI/RHI_PipelineState.h"
 #include "../RHI/RHI_Texture.h"
 #include "../RHI/RHI_SwapChain.h"
+#include "../RHI/RHI_BindlessTable.h"
+#include "../RHI/RHI_StructuredBuffer.h"
+#include "../RHI/RHI_Device.h"
+#include "../Utilities/Hash.h"
 #include "../World/Entity.h"
 #include "../World/Components/Camera.h"
 #include "../World/Components/Light.h"
 #include "../World/Components/Transform.h"
 #include "../World/Components/Renderable.h"
-//=========================================
+#include "../World/Components/Animator.h"
+//==========================================
 
 //= NAMESPACES ===============
 using namespace std;
@@ -49,6 +55,47 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+    static void count_triangles(Profiler* profiler, const Renderable* renderable, const uint32_t lod)
+    {
+        profiler->m_renderer_triangles           += renderable->GeometryIndexCount(lod) / 3;
+        profiler->m_renderer_triangles_lod_saved += (renderable->GeometryIndexCount() - renderable->GeometryIndexCount(lod)) / 3;
+    }
+
+    Renderer::GeometryBinding Renderer::GetGeometry(const Entity* entity, const Renderable* renderable, const Model* model)
+    {
+        GeometryBinding geometry;
+
+        // GetComponent() isn't const, but it doesn't modify the entity
+        const Animator* animator = model->IsAnimated() ? const_cast<Entity*>(entity)->GetComponent<Animator>() : nullptr;
+        if (animator && animator->HasSkinnedGeometry())
+        {
+            geometry.vertex_buffer          = animator->GetVertexBuffer();
+            geometry.vertex_buffer_position = animator->GetVertexBufferPosition();
+            geometry.vertex_transform       = &animator->GetVertexTransform();
+            geometry.vertex_offset          = animator->GetVertexOffset();
+            geometry.skinned                = true;
+        }
+        else if (animator && animator->HasPalette())
+        {
+            geometry.vertex_buffer          = model->GetVertexBufferSkin();
+            geometry.vertex_buffer_position = model->GetVertexBufferPositionSkin();
+            geometry.vertex_transform       = &Matrix::Identity; // the bones include the vertex transform of the model
+            geometry.vertex_offset          = renderable->GeometryVertexOffset();
+            geometry.bone_offset            = animator->GetPaletteOffset();
+            geometry.skinned                = true;
+            geometry.skinned_gpu            = true;
+        }
+        else
+        {
+            geometry.vertex_buffer          = model->GetVertexBuffer();
+            geometry.vertex_buffer_position = model->GetVertexBufferPosition();
+            geometry.vertex_transform       = &model->GetVertexTransform();
+            geometry.vertex_offset          = renderable->GeometryVertexOffset();
+        }
+
+        return geometry;
+    }
+
     void Renderer::SetGlobalSamplersAndConstantBuffers(RHI_CommandList* cmd_list) const
     {
         // Constant buffers
@@ -67,6 +114,39 @@ namespace Spartan
         cmd_list->SetSampler(6, m_sampler_anisotropic_wrap);
     }
 
+    bool Renderer::SetPipelineStateSkinned(RHI_PipelineState& pso, const bool skinned) const
+    {
+        // The vertex shaders which draw models, and their variations which skin on the GPU
+        static const array<pair<RendererShader, RendererShader>, 4> variations =
+        {
+            make_pair(RendererShader::Gbuffer_V,            RendererShader::Gbuffer_Skinned_V),
+            make_pair(RendererShader::Depth_V,              RendererShader::Depth_Skinned_V),
+            make_pair(RendererShader::Depth_PositionOnly_V, RendererShader::Depth_PositionOnly_Skinned_V),
+            make_pair(RendererShader::Entity_V,             RendererShader::Entity_Skinned_V)
+        };
+
+        for (const pair<RendererShader, RendererShader>& variation : variations)
+        {
+            RHI_Shader* shader_from = m_shaders.at(skinned ? variation.first : variation.second).get();
+            RHI_Shader* shader_to   = m_shaders.at(skinned ? variation.second : variation.first).get();
+            if (pso.shader_vertex != shader_from)
+                continue;
+
+            if (!shader_to->IsCompiled())
+                return false;
+
+            const bool position_only    = variation.first == RendererShader::Depth_PositionOnly_V;
+            pso.shader_vertex           = shader_to;
+            pso.vertex_buffer_stride    = static_cast<uint32_t>(skinned ?
+                (position_only ? sizeof(RHI_Vertex_PosSkin_Packed) : sizeof(RHI_Vertex_PosTexNorTanSkin_Packed)) :
+                (position_only ? sizeof(RHI_Vertex_Pos_Packed)     : sizeof(RHI_Vertex_PosTexNorTan_Packed)));
+
+            return true;
+        }
+
+        return false;
+    }
+
     void Renderer::Pass_Main(RHI_CommandList* cmd_list)
     {
         // Validate cmd list
@@ -75,73 +155,314 @@ namespace Spartan
 
         SCOPED_TIME_BLOCK(m_profiler);
 
+        // Declare the passes and the textures they access, then let the graph cull, alias and transition
+        RenderGraphBuild();
+        if (!m_render_graph->Compile())
+            return;
+
+        // Async compute, the command list is picked the same way the swapchain picks the graphics one
+        RHI_CommandList* cmd_list_async = nullptr;
+        if (GetOption(Render_AsyncCompute))
+        {
+            const uint32_t cmd_index = m_swap_chain->GetCmdIndex();
+            cmd_list_async = cmd_index < static_cast<uint32_t>(m_cmd_lists_async.size()) ? m_cmd_lists_async[cmd_index].get() : nullptr;
+        }
+
+        m_render_graph->Execute(cmd_list, cmd_list_async, m_semaphore_graphics.get(), m_semaphore_async.get());
+
+        // Profile
+        m_profiler->m_renderer_passes                       = m_render_graph->GetPassCount();
+        m_profiler->m_renderer_passes_culled                = m_render_graph->GetPassCulledCount();
+        m_profiler->m_renderer_transient_memory             = static_cast<uint32_t>(m_render_graph->GetTransientMemory() / (1024 * 1024));
+        m_profiler->m_renderer_transient_memory_unaliased   = static_cast<uint32_t>(m_render_graph->GetTransientMemoryUnaliased() / (1024 * 1024));
+        m_profiler->m_renderer_passes_async                 = cmd_list_async ? m_render_graph->GetPassAsyncCount() : 0;
+        m_profiler->m_renderer_async_time                   = m_render_graph->GetAsyncTime();
+        m_profiler->m_renderer_async_overlap                = m_render_graph->GetAsyncOverlap();
+    }
+
+    void Renderer::RenderGraphBuild()
+    {
+        RenderGraph& graph = *m_render_graph;
+        graph.Clear();
+
+        const uint32_t width                = static_cast<uint32_t>(m_resolution.x);
+        const uint32_t height               = static_cast<uint32_t>(m_resolution.y);
+        const bool draw_transparent_objects = !m_entities[Renderer_Object_Transparent].empty();
+        const bool do_ssao                  = GetOption(Render_Ssao);
+        const bool do_ssr                   = GetOption(Render_ScreenSpaceReflections);
+        const bool do_ssgi                  = GetOption(Render_Ssgi);
+        const bool do_async_compute         = GetOption(Render_AsyncCompute);
+
+        // Persistent textures, these are either history (read before they are written in a frame) or ping-ponged by swapping
+        unordered_map<RendererRt, uint32_t> rt;
+        const auto import_texture = [this, &graph, &rt](const RendererRt type, const char* name)
+        {
+            rt[type] = graph.ImportTexture(name, &m_render_targets[type]);
+            return rt[type];
+        };
+        const uint32_t shadow_maps      = graph.ImportTexture("shadow_maps"); // owned by the lights
+        const uint32_t brdf_lut         = import_texture(RendererRt::Brdf_Specular_Lut,   "brdf_specular_lut");
+        const uint32_t albedo           = import_texture(RendererRt::Gbuffer_Albedo,      "gbuffer_albedo");
+        const uint32_t normal           = import_texture(RendererRt::Gbuffer_Normal,      "gbuffer_normal");
+        const uint32_t material         = import_texture(RendererRt::Gbuffer_Material,    "gbuffer_material");
+        const uint32_t velocity         = import_texture(RendererRt::Gbuffer_Velocity,    "gbuffer_velocity");
+        const uint32_t depth            = import_texture(RendererRt::Gbuffer_Depth,       "gbuffer_depth");
+        const uint32_t ssao             = import_texture(RendererRt::Ssao,                "ssao_noisy");
+        const uint32_t ssao_blurred     = import_texture(RendererRt::Ssao_Blurred,        "ssao");
+        const uint32_t light_diffuse    = import_texture(RendererRt::Light_Diffuse,       "light_diffuse");
+        const uint32_t accumulation     = import_texture(RendererRt::Accumulation_Ssgi,   "accumulation_ssgi");
+        const uint32_t frame_hdr        = import_texture(RendererRt::Frame_Hdr,           "frame_hdr");
+        const uint32_t frame_hdr_2      = import_texture(RendererRt::Frame_Hdr_2,         "frame_hdr_2");
+        const uint32_t frame_ldr        = import_texture(RendererRt::Frame_Ldr,           "frame_ldr");
+        const uint32_t frame_ldr_2      = import_texture(RendererRt::Frame_Ldr_2,         "frame_ldr_2");
+        graph.SetOutput(frame_ldr);
+
+        // Transient textures, these only live within a frame so the graph can alias them
+        const auto add_texture = [this, &graph, &rt](const RendererRt type, const char* name, const RenderGraph_TextureDesc& desc)
+        {
+            rt[type] = graph.AddTexture(name, desc, &m_render_targets[type]);
+            return rt[type];
+        };
+        const RenderGraph_TextureDesc desc_light(width, height, RHI_Format_R11G11B10_Float);
+        const uint32_t light_specular               = add_texture(RendererRt::Light_Specular,               "light_specular",               desc_light);
+        const uint32_t light_volumetric             = add_texture(RendererRt::Light_Volumetric,             "light_volumetric",             desc_light);
+        const uint32_t light_diffuse_transparent    = add_texture(RendererRt::Light_Diffuse_Transparent,    "light_diffuse_transparent",    desc_light);
+        const uint32_t light_specular_transparent   = add_texture(RendererRt::Light_Specular_Transparent,   "light_specular_transparent",   desc_light);
+        const uint32_t ssgi                         = add_texture(RendererRt::Ssgi,                         "ssgi",                         desc_light);
+        const uint32_t ssr                          = add_texture(RendererRt::Ssr,                          "ssr",                          RenderGraph_TextureDesc(width, height, RHI_Format_R16G16B16A16_Snorm, 1, RHI_Texture_Storage));
+
         // Update frame constant buffer
-        Pass_UpdateFrameBuffer(cmd_list);
+        graph.AddPass("frame_buffer", [this](RHI_CommandList* cmd_list) { Pass_UpdateFrameBuffer(cmd_list); }, true);
 
         // Generate brdf specular lut (only runs once)
-        Pass_BrdfSpecularLut(cmd_list);
+        {
+            const uint32_t pass = graph.AddPass("brdf_specular_lut", [this](RHI_CommandList* cmd_list) { Pass_BrdfSpecularLut(cmd_list); });
+            graph.Write(pass, brdf_lut, RenderGraph_Access_Untracked);
+        }
 
-        const bool draw_transparent_objects = !m_entities[Renderer_Object_Transparent].empty();
-        
-        // Depth
+        // Shadow maps, with async compute they are declared after the passes which rely on the G-buffer, so that they render while those run on the compute queue
+        const auto add_light_depth_passes = [this, &graph, shadow_maps, draw_transparent_objects]()
         {
-            Pass_LightDepth(cmd_list, Renderer_Object_Opaque);
+            uint32_t pass = graph.AddPass("light_depth", [this](RHI_CommandList* cmd_list) { Pass_LightDepth(cmd_list, Renderer_Object_Opaque); });
+            graph.Write(pass, shadow_maps, RenderGraph_Access_Untracked);
+
             if (draw_transparent_objects)
             {
-                Pass_LightDepth(cmd_list, Renderer_Object_Transparent);
+                pass = graph.AddPass("light_depth_transparent", [this](RHI_CommandList* cmd_list) { Pass_LightDepth(cmd_list, Renderer_Object_Transparent); });
+                graph.Write(pass, shadow_maps, RenderGraph_Access_Untracked);
             }
-        
+        };
+
+        // Depth
+        {
+            if (!do_async_compute)
+            {
+                add_light_depth_passes();
+            }
+
             if (GetOption(Render_DepthPrepass))
             {
-                Pass_DepthPrePass(cmd_list);
+                const uint32_t pass = graph.AddPass("depth_prepass", [this](RHI_CommandList* cmd_list) { Pass_DepthPrePass(cmd_list); });
+                graph.Write(pass, depth, RenderGraph_Access_DepthStencil);
             }
         }
-        
-        // G-Buffer and lighting
+
+        // G-buffer
+        {
+            const uint32_t pass = graph.AddPass("gbuffer", [this](RHI_CommandList* cmd_list) { Pass_GBuffer(cmd_list); });
+            graph.Write(pass, albedo,   RenderGraph_Access_RenderTarget);
+            graph.Write(pass, normal,   RenderGraph_Access_RenderTarget);
+            graph.Write(pass, material, RenderGraph_Access_RenderTarget);
+            graph.Write(pass, velocity, RenderGraph_Access_RenderTarget);
+            graph.Write(pass, depth,    RenderGraph_Access_DepthStencil);
+        }
+
+        // Passes which rely on the G-buffer
         {
-            // G-buffer
-            Pass_GBuffer(cmd_list);
+            uint32_t pass = graph.AddPass("ssao", [this](RHI_CommandList* cmd_list) { Pass_Ssao(cmd_list); });
+            graph.Read(pass, normal);
+            graph.Read(pass, depth);
+            graph.Write(pass, ssao, RenderGraph_Access_Storage);
+            if (do_async_compute)
+            {
+                graph.SetAsync(pass);
+            }
+
+            pass = graph.AddPass("ssr_trace", [this](RHI_CommandList* cmd_list) { Pass_SsrTrace(cmd_list); });
+            graph.Read(pass, normal);
+            graph.Read(pass, depth);
+            graph.Read(pass, material);
+            graph.Write(pass, ssr, RenderGraph_Access_Storage);
+            if (do_async_compute)
+            {
+                graph.SetAsync(pass);
+            }
 
-            // Passes which really on the G-buffer
-            Pass_Ssao(cmd_list);
-            Pass_SsrTrace(cmd_list);
-            Pass_Ssgi(cmd_list);
+            pass = graph.AddPass("ssgi", [this](RHI_CommandList* cmd_list) { Pass_Ssgi(cmd_list); });
+            graph.Read(pass, albedo);
+            graph.Read(pass, normal);
+            graph.Read(pass, velocity);
+            graph.Read(pass, depth);
+            graph.Read(pass, light_diffuse); // previous frame
+            graph.Write(pass, ssgi,         RenderGraph_Access_Storage);
+            graph.Write(pass, accumulation, RenderGraph_Access_Untracked);
+            if (do_async_compute)
+            {
+                graph.SetAsync(pass);
+            }
 
-            // Lighting
-            Pass_Light(cmd_list);
+            if (do_async_compute)
+            {
+                add_light_depth_passes();
+            }
+
+            // The blur is a pixel shader pass, so it stays on the graphics queue and is where it joins the compute queue
+            pass = graph.AddPass("ssao_blur", [this](RHI_CommandList* cmd_list) { Pass_SsaoBlur(cmd_list); });
+            graph.Read(pass, ssao);
+            graph.Write(pass, ssao_blurred, RenderGraph_Access_Untracked); // bilateral blur ping-pongs
+        }
+
+        // Lighting
+        {
+            uint32_t pass = graph.AddPass("light", [this](RHI_CommandList* cmd_list) { Pass_Light(cmd_list); });
+            graph.Read(pass, albedo);
+            graph.Read(pass, normal);
+            graph.Read(pass, material);
+            graph.Read(pass, depth);
+            graph.Read(pass, shadow_maps, RenderGraph_Access_Untracked);
+            if (do_ssao)
+            {
+                graph.Read(pass, ssao_blurred);
+            }
+            graph.Write(pass, light_diffuse,    RenderGraph_Access_Storage);
+            graph.Write(pass, light_specular,   RenderGraph_Access_Storage);
+            graph.Write(pass, light_volumetric, RenderGraph_Access_Storage);
 
             // Injection of SSGI into the light buffers
-            Pass_SsgiInject(cmd_list);
+            if (do_ssgi)
+            {
+                pass = graph.AddPass("ssgi_inject", [this](RHI_CommandList* cmd_list) { Pass_SsgiInject(cmd_list); });
+                graph.Read(pass, ssgi);
+                graph.Write(pass, light_diffuse, RenderGraph_Access_Storage);
+            }
 
             // Composition of the light buffers (including volumetric fog)
-            Pass_LightComposition(cmd_list, m_render_targets[RendererRt::Frame_Hdr].get());
+            pass = graph.AddPass("light_composition", [this](RHI_CommandList* cmd_list) { Pass_LightComposition(cmd_list, m_render_targets[RendererRt::Frame_Hdr].get()); });
+            graph.Read(pass, albedo);
+            graph.Read(pass, normal);
+            graph.Read(pass, material);
+            graph.Read(pass, depth);
+            graph.Read(pass, light_diffuse);
+            graph.Read(pass, light_specular);
+            graph.Read(pass, light_volumetric);
+            graph.Write(pass, frame_hdr, RenderGraph_Access_Storage);
 
             // Image based lighting
-            Pass_LightImageBased(cmd_list, m_render_targets[RendererRt::Frame_Hdr].get());
+            pass = graph.AddPass("light_image_based", [this](RHI_CommandList* cmd_list) { Pass_LightImageBased(cmd_list, m_render_targets[RendererRt::Frame_Hdr].get()); });
+            graph.Read(pass, albedo);
+            graph.Read(pass, normal);
+            graph.Read(pass, material);
+            graph.Read(pass, depth);
+            graph.Read(pass, brdf_lut);
+            if (do_ssao)
+            {
+                graph.Read(pass, ssao_blurred);
+            }
+            graph.Write(pass, frame_hdr, RenderGraph_Access_RenderTarget);
 
             // If SSR is enabled, copy the frame so that SSR can use it to reflect from
-            if ((m_options & Render_ScreenSpaceReflections) != 0)
+            if (do_ssr)
             {
-                Pass_Copy(cmd_list, m_render_targets[RendererRt::Frame_Hdr].get(), m_render_targets[RendererRt::Frame_Hdr_2].get());
+                pass = graph.AddPass("copy_frame", [this](RHI_CommandList* cmd_list) { Pass_Copy(cmd_list, m_render_targets[RendererRt::Frame_Hdr].get(), m_render_targets[RendererRt::Frame_Hdr_2].get()); });
+                graph.Read(pass, frame_hdr);
+                graph.Write(pass, frame_hdr_2, RenderGraph_Access_Storage);
             }
 
             // Reflections - SSR & Environment
-            Pass_Reflections(cmd_list, m_render_targets[RendererRt::Frame_Hdr].get(), m_render_targets[RendererRt::Frame_Hdr_2].get());
-
-            // Lighting for transparent objects (a simpler version of the above)
-            if (draw_transparent_objects)
+            pass = graph.AddPass("reflections", [this](RHI_CommandList* cmd_list) { Pass_Reflections(cmd_list, m_render_targets[RendererRt::Frame_Hdr].get(), m_render_targets[RendererRt::Frame_Hdr_2].get()); });
+            graph.Read(pass, albedo);
+            graph.Read(pass, normal);
+            graph.Read(pass, material);
+            graph.Read(pass, depth);
+            graph.Read(pass, frame_hdr_2);
+            if (do_ssr)
             {
-                // Copy the frame so that transparency and refraction can sample from it
-                Pass_Copy(cmd_list, m_render_targets[RendererRt::Frame_Hdr].get(), m_render_targets[RendererRt::Frame_Hdr_2].get());
-
-                Pass_GBuffer(cmd_list, true);
-                Pass_Light(cmd_list, true);
-                Pass_LightComposition(cmd_list, m_render_targets[RendererRt::Frame_Hdr].get(), true);
-                Pass_LightImageBased(cmd_list, m_render_targets[RendererRt::Frame_Hdr].get(), true);
+                graph.Read(pass, ssr);
             }
+            graph.Write(pass, frame_hdr, RenderGraph_Access_RenderTarget);
+        }
+
+        // Lighting for transparent objects (a simpler version of the above)
+        if (draw_transparent_objects)
+        {
+            // Copy the frame so that transparency and refraction can sample from it
+            uint32_t pass = graph.AddPass("copy_frame_transparent", [this](RHI_CommandList* cmd_list) { Pass_Copy(cmd_list, m_render_targets[RendererRt::Frame_Hdr].get(), m_render_targets[RendererRt::Frame_Hdr_2].get()); });
+            graph.Read(pass, frame_hdr);
+            graph.Write(pass, frame_hdr_2, RenderGraph_Access_Storage);
+
+            pass = graph.AddPass("gbuffer_transparent", [this](RHI_CommandList* cmd_list) { Pass_GBuffer(cmd_list, true); });
+            graph.Write(pass, albedo,   RenderGraph_Access_RenderTarget);
+            graph.Write(pass, normal,   RenderGraph_Access_RenderTarget);
+            graph.Write(pass, material, RenderGraph_Access_RenderTarget);
+            graph.Write(pass, velocity, RenderGraph_Access_RenderTarget);
+            graph.Write(pass, depth,    RenderGraph_Access_DepthStencil);
+
+            pass = graph.AddPass("light_transparent", [this](RHI_CommandList* cmd_list) { Pass_Light(cmd_list, true); });
+            graph.Read(pass, albedo);
+            graph.Read(pass, normal);
+            graph.Read(pass, material);
+            graph.Read(pass, depth);
+            graph.Read(pass, shadow_maps, RenderGraph_Access_Untracked);
+            if (do_ssao)
+            {
+                graph.Read(pass, ssao_blurred);
+            }
+            graph.Write(pass, light_diffuse_transparent,    RenderGraph_Access_Storage);
+            graph.Write(pass, light_specular_transparent,   RenderGraph_Access_Storage);
+            graph.Write(pass, light_volumetric,             RenderGraph_Access_Storage);
+
+            pass = graph.AddPass("light_composition_transparent", [this](RHI_CommandList* cmd_list) { Pass_LightComposition(cmd_list, m_render_targets[RendererRt::Frame_Hdr].get(), true); });
+            graph.Read(pass, albedo);
+            graph.Read(pass, normal);
+            graph.Read(pass, material);
+            graph.Read(pass, depth);
+            graph.Read(pass, light_diffuse_transparent);
+            graph.Read(pass, light_specular_transparent);
+            graph.Read(pass, light_volumetric);
+            graph.Write(pass, frame_hdr, RenderGraph_Access_Storage);
+
+            pass = graph.AddPass("light_image_based_transparent", [this](RHI_CommandList* cmd_list) { Pass_LightImageBased(cmd_list, m_render_targets[RendererRt::Frame_Hdr].get(), true); });
+            graph.Read(pass, albedo);
+            graph.Read(pass, normal);
+            graph.Read(pass, material);
+            graph.Read(pass, depth);
+            graph.Read(pass, brdf_lut);
+            graph.Read(pass, frame_hdr_2); // refraction
+            if (do_ssao)
+            {
+                graph.Read(pass, ssao_blurred);
+            }
+            graph.Write(pass, frame_hdr, RenderGraph_Access_RenderTarget);
         }
 
-        Pass_PostProcess(cmd_list);
+        // Post-processing, the passes ping-pong by swapping the textures so they transition them themselves
+        {
+            const uint32_t pass = graph.AddPass("post_process", [this](RHI_CommandList* cmd_list) { Pass_PostProcess(cmd_list); });
+            graph.Read(pass, frame_hdr, RenderGraph_Access_Untracked);
+            graph.Read(pass, velocity);
+            graph.Read(pass, depth);
+            graph.Write(pass, frame_hdr_2,  RenderGraph_Access_Untracked);
+            graph.Write(pass, frame_ldr,    RenderGraph_Access_Untracked);
+            graph.Write(pass, frame_ldr_2,  RenderGraph_Access_Untracked);
+
+            // Keep the debug render target alive (if it's one that the graph knows about and something writes to it)
+            const bool debug_transparent    = m_render_target_debug == RendererRt::Light_Diffuse_Transparent || m_render_target_debug == RendererRt::Light_Specular_Transparent;
+            const auto it                   = rt.find(m_render_target_debug);
+            if (it != rt.end() && (draw_transparent_objects || !debug_transparent))
+            {
+                graph.Read(pass, it->second, RenderGraph_Access_Untracked);
+            }
+        }
     }
 
     void Renderer::Pass_UpdateFrameBuffer(RHI_CommandList* cmd_list)
@@ -164,11 +485,14 @@ namespace Spartan
         // All opaque objects are rendered from the lights point of view.
         // Opaque objects write their depth information to a depth buffer, using just a vertex shader.
         // Transparent objects, read the opaque depth but don't write their own, instead, they write their color information using a pixel shader.
-
-        // Acquire shader
-        RHI_Shader* shader_v = m_shaders[RendererShader::Depth_V].get();
-        RHI_Shader* shader_p = m_shaders[RendererShader::Depth_P].get();
-        if (!shader_v->IsCompiled() || !shader_p->IsCompiled())
+        // Static opaque objects are rendered into a cached depth buffer, which is only updated when the light or the static objects change.
+        // Every frame that cache is copied into the light's depth buffer and the dynamic opaque objects are rendered on top of it.
+
+        // Acquire shaders (opaque objects only need the position stream)
+        RHI_Shader* shader_v            = m_shaders[RendererShader::Depth_V].get();
+        RHI_Shader* shader_v_position   = m_shaders[RendererShader::Depth_PositionOnly_V].get();
+        RHI_Shader* shader_p            = m_shaders[RendererShader::Depth_P].get();
+        if (!shader_v->IsCompiled() || !shader_v_position->IsCompiled() || !shader_p->IsCompiled())
             return;
 
         // Get entities
@@ -182,7 +506,7 @@ namespace Spartan
         const auto& entities_light = m_entities[Renderer_Object_Light];
         for (uint32_t light_index = 0; light_index < entities_light.size(); light_index++)
         {
-            const Light* light = entities_light[light_index]->GetComponent<Light>();
+            Light* light = entities_light[light_index]->GetComponent<Light>();
 
             // Skip some obvious cases
             if (!light || !light->GetShadowsEnabled())
@@ -193,18 +517,33 @@ namespace Spartan
                 continue;
 
             // Acquire light's shadow maps
-            RHI_Texture* tex_depth = light->GetDepthTexture();
-            RHI_Texture* tex_color = light->GetColorTexture();
+            RHI_Texture* tex_depth          = light->GetDepthTexture();
+            RHI_Texture* tex_depth_static   = light->GetDepthTextureStatic();
+            RHI_Texture* tex_color          = light->GetColorTexture();
             if (!tex_depth)
                 continue;
 
+            // Only opaque objects are cached, transparent objects are always rendered on top of the final depth
+            const bool cache_static = !transparent_pass && tex_depth_static;
+
+            // Set appropriate rasterizer state
+            RHI_RasterizerState* rasterizer_state = m_rasterizer_light_point_spot.get();
+            if (light->GetLightType() == LightType::Directional)
+            {
+                // "Pancaking" - https://www.gamedev.net/forums/topic/639036-shadow-mapping-and-high-up-objects/
+                // It's basically a way to capture the silhouettes of potential shadow casters behind the light's view point.
+                // Of course we also have to make sure that the light doesn't cull them in the first place (this is done automatically by the light)
+                rasterizer_state = m_rasterizer_light_directional.get();
+            }
+
             // Set render state
             static RHI_PipelineState pso;
-            pso.shader_vertex                    = shader_v;
-            pso.vertex_buffer_stride             = static_cast<uint32_t>(sizeof(RHI_Vertex_PosTexNorTan)); // assume all vertex buffers have the same stride (which they do)
+            pso.shader_vertex                    = transparent_pass ? shader_v : shader_v_position;
+            pso.vertex_buffer_stride             = static_cast<uint32_t>(transparent_pass ? sizeof(RHI_Vertex_PosTexNorTan_Packed) : sizeof(RHI_Vertex_Pos_Packed)); // all models use the same layouts
             pso.shader_pixel                     = transparent_pass ? shader_p : nullptr;
             pso.blend_state                      = transparent_pass ? m_blend_alpha.get() : m_blend_disabled.get();
             pso.depth_stencil_state              = transparent_pass ? m_depth_stencil_r_off.get() : m_depth_stencil_rw_off.get();
+            pso.rasterizer_state                 = rasterizer_state;
             pso.render_target_color_textures[0]  = tex_color; // always bind so we can clear to white (in case there are now transparent objects)
             pso.render_target_depth_texture      = tex_depth;
             pso.clear_stencil                    = rhi_stencil_dont_care;
@@ -212,99 +551,184 @@ namespace Spartan
             pso.primitive_topology               = RHI_PrimitiveTopology_TriangleList;
             pso.pass_name                        = transparent_pass ? "Pass_LightDepth_Transparent" : "Pass_LightDepth";
 
-            for (uint32_t array_index = 0; array_index < tex_depth->GetArraySize(); array_index++)
+            // Set render state for the static cache
+            static RHI_PipelineState pso_static;
+            pso_static.shader_vertex                = shader_v_position;
+            pso_static.vertex_buffer_stride         = static_cast<uint32_t>(sizeof(RHI_Vertex_Pos_Packed));
+            pso_static.blend_state                  = m_blend_disabled.get();
+            pso_static.depth_stencil_state          = m_depth_stencil_rw_off.get();
+            pso_static.rasterizer_state             = rasterizer_state;
+            pso_static.render_target_depth_texture  = tex_depth_static;
+            pso_static.clear_depth                  = GetClearDepth();
+            pso_static.clear_stencil                = rhi_stencil_dont_care;
+            pso_static.viewport                     = tex_depth->GetViewport();
+            pso_static.primitive_topology           = RHI_PrimitiveTopology_TriangleList;
+            pso_static.pass_name                    = "Pass_LightDepth_Static";
+
+            // Acquire the casters of every slice and re-render the cached static casters of the slices which are out of date
+            const uint32_t array_size = tex_depth->GetArraySize();
+            m_shadow_casters_dynamic.resize(array_size);
+            for (uint32_t array_index = 0; array_index < array_size; array_index++)
             {
-                // Set render target texture array index
-                pso.render_target_color_texture_array_index          = array_index;
-                pso.render_target_depth_stencil_texture_array_index  = array_index;
+                ShadowCastersAcquire(light, array_index, entities, cache_static, &m_shadow_casters_static, &m_shadow_casters_dynamic[array_index]);
 
-                // Set clear values
-                pso.clear_color[0] = Vector4::One;
-                pso.clear_depth    = transparent_pass ? rhi_depth_load : GetClearDepth();
+                if (!cache_static)
+                    continue;
+
+                // The cache is valid as long as the light didn't change and the same static casters are in it, with the same geometry and material
+                uint32_t static_casters_hash = 0;
+                for (Entity* entity : m_shadow_casters_static)
+                {
+                    Utility::Hash::hash_combine(static_casters_hash, entity->GetId());
+                    Utility::Hash::hash_combine(static_casters_hash, entity->GetComponent<Renderable>()->GetRevision());
+                }
+
+                if (light->IsStaticShadowValid(array_index, static_casters_hash))
+                {
+                    m_profiler->m_renderer_shadow_slices_cached++;
+                    continue;
+                }
 
-                const Matrix& view_projection = light->GetViewMatrix(array_index) * light->GetProjectionMatrix(array_index);
+                pso_static.render_target_depth_stencil_texture_array_index = array_index;
 
-                // Set appropriate rasterizer state
-                if (light->GetLightType() == LightType::Directional)
+                if (!m_shadow_casters_static.empty())
                 {
-                    // "Pancaking" - https://www.gamedev.net/forums/topic/639036-shadow-mapping-and-high-up-objects/
-                    // It's basically a way to capture the silhouettes of potential shadow casters behind the light's view point.
-                    // Of course we also have to make sure that the light doesn't cull them in the first place (this is done automatically by the light)
-                    pso.rasterizer_state = m_rasterizer_light_directional.get();
+                    Pass_LightDepthCasters(cmd_list, pso_static, light, array_index, m_shadow_casters_static, false);
                 }
                 else
                 {
-                    pso.rasterizer_state = m_rasterizer_light_point_spot.get();
+                    cmd_list->ClearPipelineStateRenderTargets(pso_static);
                 }
 
-                // State tracking
-                bool render_pass_active     = false;
-                uint32_t m_set_material_id  = 0;
+                light->SetStaticShadowValid(array_index, static_casters_hash);
+            }
 
-                for (uint32_t entity_index = 0; entity_index < static_cast<uint32_t>(entities.size()); entity_index++)
-                {
-                    Entity* entity = entities[entity_index];
+            // Start from the static casters
+            if (cache_static)
+            {
+                cmd_list->Copy(tex_depth_static, tex_depth);
+            }
 
-                    // Acquire renderable component
-                    Renderable* renderable = entity->GetRenderable();
-                    if (!renderable)
-                        continue;
+            for (uint32_t array_index = 0; array_index < array_size; array_index++)
+            {
+                // Set render target texture array index
+                pso.render_target_color_texture_array_index          = array_index;
+                pso.render_target_depth_stencil_texture_array_index  = array_index;
 
-                    // Skip meshes that don't cast shadows
-                    if (!renderable->GetCastShadows())
-                        continue;
+                // Set clear values
+                pso.clear_color[0] = Vector4::One;
+                pso.clear_depth    = (transparent_pass || cache_static) ? rhi_depth_load : GetClearDepth();
 
-                    // Acquire geometry
-                    Model* model = renderable->GeometryModel();
-                    if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
-                        continue;
+                const vector<Entity*>& casters = m_shadow_casters_dynamic[array_index];
+                if (!casters.empty())
+                {
+                    Pass_LightDepthCasters(cmd_list, pso, light, array_index, casters, transparent_pass);
+                }
+                else if (!transparent_pass && (tex_color || !cache_static))
+                {
+                    // Nothing to render but the slice still has to be cleared
+                    cmd_list->ClearPipelineStateRenderTargets(pso);
+                }
+            }
+        }
+    }
 
-                    // Acquire material
-                    Material* material = renderable->GetMaterial();
-                    if (!material)
-                        continue;
+    void Renderer::Pass_LightDepthCasters(RHI_CommandList* cmd_list, RHI_PipelineState& pso, const Light* light, const uint32_t array_index, const vector<Entity*>& casters, const bool transparent_pass)
+    {
+        const Matrix& view_projection = light->GetViewMatrix(array_index) * light->GetProjectionMatrix(array_index);
 
-                    // Skip objects outside of the view frustum
-                    if (!light->IsInViewFrustrum(renderable, array_index))
-                        continue;
+        // Levels of detail are picked by the size of the casters in the shadow map (before recording, as the bounding boxes might update)
+        m_shadow_caster_lods.resize(casters.size());
+        for (uint32_t i = 0; i < static_cast<uint32_t>(casters.size()); i++)
+        {
+            m_shadow_caster_lods[i] = casters[i]->GetRenderable()->GeometryLodSelect(light->GetViewMatrix(array_index), light->GetProjectionMatrix(array_index));
+        }
 
-                    if (!render_pass_active)
-                    {
-                        render_pass_active = cmd_list->BeginRenderPass(pso);
-                    }
+        // Casters skinned on the GPU need the skinned variation of the vertex shader, so they are drawn in a render pass of their own
+        bool skinned_gpu            = false;
+        uint32_t skinned_gpu_count  = 0;
+        for (Entity* entity : casters)
+        {
+            Renderable* renderable = entity->GetRenderable();
+            skinned_gpu_count += GetGeometry(entity, renderable, renderable->GeometryModel()).skinned_gpu ? 1 : 0;
+        }
 
-                    // Bind material
-                    if (transparent_pass && m_set_material_id != material->GetId())
-                    {
-                        // Bind material textures
-                        RHI_Texture* tex_albedo = material->GetTexture_Ptr(Material_Color);
-                        cmd_list->SetTexture(RendererBindingsSrv::tex, tex_albedo ? tex_albedo : m_default_tex_white.get());
+        auto record = [this, &casters, &view_projection, transparent_pass, &skinned_gpu](RHI_CommandList* cmd_list, const uint32_t thread_index, const uint32_t start, const uint32_t end)
+        {
+            BufferUber& buffer_uber = m_recording_threads[thread_index].buffer_uber_cpu;
 
-                        // Update uber buffer with material properties
-                        m_buffer_uber_cpu.mat_albedo    = material->GetColorAlbedo();
-                        m_buffer_uber_cpu.mat_tiling_uv = material->GetTiling();
-                        m_buffer_uber_cpu.mat_offset_uv = material->GetOffset();
+            // State tracking
+            uint32_t set_material_id = 0;
 
-                        m_set_material_id = material->GetId();
-                    }
+            for (uint32_t i = start; i < end; i++)
+            {
+                // Casters have already been validated by ShadowCastersAcquire()
+                Entity* entity          = casters[i];
+                Renderable* renderable  = entity->GetRenderable();
+                Model* model            = renderable->GeometryModel();
+                Material* material      = renderable->GetMaterial();
+
+                const GeometryBinding geometry = GetGeometry(entity, renderable, model);
+                if (geometry.skinned_gpu != skinned_gpu)
+                    continue;
 
-                    // Bind geometry
-                    cmd_list->SetBufferIndex(model->GetIndexBuffer());
-                    cmd_list->SetBufferVertex(model->GetVertexBuffer());
+                // Bind material
+                if (transparent_pass && set_material_id != material->GetId())
+                {
+                    // Bind material textures
+                    RHI_Texture* tex_albedo = material->GetTexture_Ptr(Material_Color);
+                    cmd_list->SetTexture(RendererBindingsSrv::tex, tex_albedo ? tex_albedo : m_default_tex_white.get());
 
-                    // Update uber buffer with cascade transform
-                    m_buffer_uber_cpu.transform = entity->GetTransform()->GetMatrix() * view_projection;
-                    if (!UpdateUberBuffer(cmd_list))
-                        continue;
+                    // Update uber buffer with material properties
+                    buffer_uber.mat_albedo    = material->GetColorAlbedo();
+                    buffer_uber.mat_tiling_uv = material->GetTiling();
+                    buffer_uber.mat_offset_uv = material->GetOffset();
 
-                    cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
+                    set_material_id = material->GetId();
                 }
 
-                if (render_pass_active)
+                // Bind geometry
+                cmd_list->SetBufferIndex(model->GetIndexBuffer());
+                cmd_list->SetBufferVertex(transparent_pass ? geometry.vertex_buffer : geometry.vertex_buffer_position);
+
+                // Bind bones
+                if (geometry.skinned_gpu)
                 {
-                    cmd_list->EndRenderPass();
+                    cmd_list->SetStructuredBuffer(RendererBindingsSrv::bones, m_bones_gpu.get());
+                    buffer_uber.bone_offset = geometry.bone_offset;
                 }
+
+                // Update uber buffer with cascade transform
+                buffer_uber.transform = *geometry.vertex_transform * entity->GetTransform()->GetMatrix() * view_projection;
+                if (!UpdateUberBuffer(cmd_list, thread_index))
+                    continue;
+
+                const uint32_t lod = m_shadow_caster_lods[i];
+                cmd_list->DrawIndexed(renderable->GeometryIndexCount(lod), renderable->GeometryIndexOffset(lod), geometry.vertex_offset);
+                count_triangles(m_profiler, renderable, lod);
             }
+        };
+
+        if (!cmd_list->BeginRenderPass(pso))
+            return;
+
+        RecordParallel(cmd_list, static_cast<uint32_t>(casters.size()), record);
+        cmd_list->EndRenderPass();
+
+        // Draw the casters skinned on the GPU on top
+        if (skinned_gpu_count != 0 && SetPipelineStateSkinned(pso, true))
+        {
+            pso.clear_color.fill(rhi_color_load);
+            pso.clear_depth = rhi_depth_load;
+            skinned_gpu     = true;
+
+            if (cmd_list->BeginRenderPass(pso))
+            {
+                RecordParallel(cmd_list, static_cast<uint32_t>(casters.size()), record);
+                cmd_list->EndRenderPass();
+            }
+
+            SetPipelineStateSkinned(pso, false);
         }
     }
 
@@ -314,9 +738,10 @@ namespace Spartan
         // just their depth information into a depth map.
 
         // Acquire required resources/data
-        const auto& shader_depth    = m_shaders[RendererShader::Depth_V];
+        const auto& shader_depth    = m_shaders[RendererShader::Depth_PositionOnly_V];
         const auto& tex_depth       = m_render_targets[RendererRt::Gbuffer_Depth];
         const auto& entities        = m_entities[Renderer_Object_Opaque];
+        const auto& occluded        = m_entities_occluded[Renderer_Object_Opaque];
 
         // Ensure the shader has compiled
         if (!shader_depth->IsCompiled())
@@ -325,6 +750,7 @@ namespace Spartan
         // Set render state
         static RHI_PipelineState pso;
         pso.shader_vertex                = shader_depth.get();
+        pso.vertex_buffer_stride         = static_cast<uint32_t>(sizeof(RHI_Vertex_Pos_Packed));
         pso.shader_pixel                 = nullptr;
         pso.rasterizer_state             = m_rasterizer_cull_back_solid.get();
         pso.blend_state                  = m_blend_disabled.get();
@@ -335,17 +761,31 @@ namespace Spartan
         pso.primitive_topology           = RHI_PrimitiveTopology_TriangleList;
         pso.pass_name                    = "Pass_DepthPrePass";
 
-        // Record commands
-        if (cmd_list->BeginRenderPass(pso))
-        { 
+        // Record commands, what is skinned on the GPU is drawn last, with the skinned variation of the vertex shader
+        uint32_t skinned_gpu_count = 0;
+        for (const bool skinned_gpu : { false, true })
+        {
+            if (skinned_gpu)
+            {
+                if (skinned_gpu_count == 0 || !SetPipelineStateSkinned(pso, true))
+                    break;
+
+                pso.clear_depth = rhi_depth_load;
+            }
+
+            if (!cmd_list->BeginRenderPass(pso))
+                continue;
+
             if (!entities.empty())
             {
                 // Variables that help reduce state changes
                 uint32_t currently_bound_geometry = 0;
 
                 // Draw opaque
-                for (const auto& entity : entities)
+                for (uint32_t i = 0; i < static_cast<uint32_t>(entities.size()); i++)
                 {
+                    Entity* entity = entities[i];
+
                     // Get renderable
                     Renderable* renderable = entity->GetRenderable();
                     if (!renderable)
@@ -353,31 +793,65 @@ namespace Spartan
 
                     // Get geometry
                     Model* model = renderable->GeometryModel();
-                    if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
+                    if (!model || !model->GetVertexBufferPosition() || !model->GetIndexBuffer())
                         continue;
 
                     // Skip objects outside of the view frustum
                     if (!m_camera->IsInViewFrustrum(renderable))
                         continue;
 
+                    // Skip occluded objects
+                    if (i < occluded.size() && occluded[i])
+                        continue;
+
+                    // Skip what the other render pass draws
+                    const GeometryBinding geometry = GetGeometry(entity, renderable, model);
+                    if (geometry.skinned_gpu != skinned_gpu)
+                    {
+                        skinned_gpu_count += geometry.skinned_gpu ? 1 : 0;
+                        continue;
+                    }
+
                     // Bind geometry
-                    if (currently_bound_geometry != model->GetId())
+                    if (currently_bound_geometry != geometry.vertex_buffer_position->GetId())
                     {
                         cmd_list->SetBufferIndex(model->GetIndexBuffer());
-                        cmd_list->SetBufferVertex(model->GetVertexBuffer());
-                        currently_bound_geometry = model->GetId();
+                        cmd_list->SetBufferVertex(geometry.vertex_buffer_position);
+                        currently_bound_geometry = geometry.vertex_buffer_position->GetId();
+                    }
+
+                    // Bind bones
+                    if (geometry.skinned_gpu)
+                    {
+                        cmd_list->SetStructuredBuffer(RendererBindingsSrv::bones, m_bones_gpu.get());
+                        m_buffer_uber_cpu.bone_offset = geometry.bone_offset;
                     }
 
                     // Update uber buffer with entity transform
                     if (Transform* transform = entity->GetTransform())
                     {
                         // Update uber buffer with cascade transform
-                        m_buffer_uber_cpu.transform = transform->GetMatrix() * m_buffer_frame_cpu.view_projection;
+                        m_buffer_uber_cpu.transform = *geometry.vertex_transform * transform->GetMatrix() * m_buffer_frame_cpu.view_projection;
                         UpdateUberBuffer(cmd_list);
                     }
 
-                    // Draw    
-                    cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
+                    // Draw (the g-buffer picks the same level of detail, so the depth matches)
+                    const uint32_t lod = renderable->GeometryLodSelect(m_camera->GetViewMatrix(), m_camera->GetProjectionMatrix());
+                    if (geometry.skinned)
+                    {
+                        // The meshlet bounds and cones are of the bind pose
+                        cmd_list->DrawIndexed(renderable->GeometryIndexCount(lod), renderable->GeometryIndexOffset(lod), geometry.vertex_offset);
+                        count_triangles(m_profiler, renderable, lod);
+                    }
+                    else if (lod == 0)
+                    {
+                        m_profiler->m_renderer_triangles += DrawMeshlets(cmd_list, renderable, entity->GetTransform()->GetMatrix());
+                    }
+                    else
+                    {
+                        cmd_list->DrawIndexed(renderable->GeometryIndexCount(lod), renderable->GeometryIndexOffset(lod), renderable->GeometryVertexOffset());
+                        count_triangles(m_profiler, renderable, lod);
+                    }
                 }
             }
             cmd_list->EndRenderPass();
@@ -417,14 +891,36 @@ namespace Spartan
         pso.clear_depth                     = (is_transparent_pass || GetOption(Render_DepthPrepass)) ? rhi_depth_load : GetClearDepth();
         pso.clear_stencil                   = !is_transparent_pass ? 0 : rhi_stencil_dont_care;
         pso.viewport                        = tex_albedo->GetViewport();
-        pso.vertex_buffer_stride            = static_cast<uint32_t>(sizeof(RHI_Vertex_PosTexNorTan)); // assume all vertex buffers have the same stride (which they do)
+        pso.vertex_buffer_stride            = static_cast<uint32_t>(sizeof(RHI_Vertex_PosTexNorTan_Packed)); // all models use the same layout
         pso.primitive_topology              = RHI_PrimitiveTopology_TriangleList;
 
+        // With bindless materials, a single shader variation can draw every material, and changing material doesn't require new descriptor sets
+        const ShaderGBuffer* shader_p_bindless = nullptr;
+        if (GetOption(Render_Bindless) && m_bindless_table->IsValid())
+        {
+            shader_p_bindless = ShaderGBuffer::GenerateVariation(m_context, ShaderGBuffer::flag_bindless);
+            shader_p_bindless = shader_p_bindless->IsCompiled() ? shader_p_bindless : nullptr;
+        }
+        const bool bindless = shader_p_bindless != nullptr;
+        pso.bindless_table  = bindless ? m_bindless_table.get() : nullptr;
+
         bool cleared = false;
         uint32_t material_index = 0;
+        uint32_t material_index_bindless = rhi_bindless_index_invalid;
         uint32_t material_bound_id = 0;
         m_material_instances.fill(nullptr);
 
+        // Let the GPU cull and draw the opaque objects, if it can't, fall back to recording every draw.
+        // Skinned objects aren't part of the GPU-driven draws, so they are still recorded below (on top of what the GPU drew).
+        bool skinned_only = false;
+        if (!is_transparent_pass && GetOption(Render_GpuDriven) && Pass_GBufferIndirect(cmd_list, pso, &material_index))
+        {
+            skinned_only            = true;
+            cleared                 = true;
+            pso.shader_vertex       = shader_v;
+            pso.bindless_table      = bindless ? m_bindless_table.get() : nullptr;
+        }
+
         // Iterate through all the G-Buffer shader variations
         for (const auto& it : ShaderGBuffer::GetVariations())
         {
@@ -432,16 +928,25 @@ namespace Spartan
             if (!it.second->IsCompiled())
                 continue;
 
+            // Either draw everything with the bindless variation, or draw with every other variation
+            if (bindless != ((it.first & ShaderGBuffer::flag_bindless) != 0))
+                continue;
+
+            // The indirect variation is only used by GPU-driven drawing
+            if (it.first & ShaderGBuffer::flag_indirect)
+                continue;
+
             // Set pixel shader
             pso.shader_pixel = static_cast<RHI_Shader*>(it.second.get());
 
             // Set pass name
             pso.pass_name = is_transparent_pass ? "GBuffer_Transparent" : "GBuffer_Opaque";
 
-            bool render_pass_active = false;
             auto& entities = m_entities[is_transparent_pass ? Renderer_Object_Transparent : Renderer_Object_Opaque];
+            auto& occluded = m_entities_occluded[is_transparent_pass ? Renderer_Object_Transparent : Renderer_Object_Opaque];
 
-            // Record commands
+            // Acquire draw calls
+            m_draw_calls.clear();
             for (uint32_t i = 0; i < static_cast<uint32_t>(entities.size()); i++)
             {
                 Entity* entity = entities[i];
@@ -457,7 +962,7 @@ namespace Spartan
                     continue;
 
                 // Skip objects with different shader requirements
-                if (!static_cast<ShaderGBuffer*>(pso.shader_pixel)->IsSuitable(material->GetFlags()))
+                if (!bindless && !static_cast<ShaderGBuffer*>(pso.shader_pixel)->IsSuitable(material->GetFlags()))
                     continue;
 
                 // Skip transparent objects that won't contribute
@@ -469,35 +974,26 @@ namespace Spartan
                 if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
                     continue;
 
+                // Skip what the GPU-driven draws have already drawn
+                const GeometryBinding geometry = GetGeometry(entity, renderable, model);
+                if (skinned_only && !geometry.skinned)
+                    continue;
+
                 // Skip objects outside of the view frustum
                 if (!m_camera->IsInViewFrustrum(renderable))
                     continue;
 
-                if (!render_pass_active)
-                {
-                    // Reset clear values after the first render pass
-                    if (cleared)
-                    {
-                        pso.ResetClearValues();
-                    }
-
-                    render_pass_active = cmd_list->BeginRenderPass(pso);
-
-                    cleared = true;
-                }
-
-                // Set geometry (will only happen if not already set)
-                cmd_list->SetBufferIndex(model->GetIndexBuffer());
-                cmd_list->SetBufferVertex(model->GetVertexBuffer());
+                // Skip occluded objects
+                if (i < occluded.size() && occluded[i])
+                    continue;
 
-                // Bind material
+                // Keep track of used material instances (they get mapped to shaders)
                 const bool firs_run       = material_index == 0;
                 const bool new_material   = material_bound_id != material->GetId();
                 if (firs_run || new_material)
                 {
                     material_bound_id = material->GetId();
 
-                    // Keep track of used material instances (they get mapped to shaders)
                     if (material_index + 1 < m_material_instances.size())
                     {
                         // Advance index (0 is reserved for the sky)
@@ -505,60 +1001,343 @@ namespace Spartan
 
                         // Keep reference
                         m_material_instances[material_index] = material;
+
+                        // Copy the material to the bindless table, so shaders can look it up by index
+                        if (bindless)
+                        {
+                            material_index_bindless = AddBindlessMaterial(material);
+                        }
                     }
                     else
                     {
                         LOG_ERROR("Material instance array has reached it's maximum capacity of %d elements. Consider increasing the size.", m_max_material_instances);
                     }
+                }
 
-                    // Bind material textures
-                    cmd_list->SetTexture(RendererBindingsSrv::material_albedo,      material->GetTexture_Ptr(Material_Color));
-                    cmd_list->SetTexture(RendererBindingsSrv::material_roughness,   material->GetTexture_Ptr(Material_Roughness));
-                    cmd_list->SetTexture(RendererBindingsSrv::material_metallic,    material->GetTexture_Ptr(Material_Metallic));
-                    cmd_list->SetTexture(RendererBindingsSrv::material_normal,      material->GetTexture_Ptr(Material_Normal));
-                    cmd_list->SetTexture(RendererBindingsSrv::material_height,      material->GetTexture_Ptr(Material_Height));
-                    cmd_list->SetTexture(RendererBindingsSrv::material_occlusion,   material->GetTexture_Ptr(Material_Occlusion));
-                    cmd_list->SetTexture(RendererBindingsSrv::material_emission,    material->GetTexture_Ptr(Material_Emission));
-                    cmd_list->SetTexture(RendererBindingsSrv::material_mask,        material->GetTexture_Ptr(Material_Mask));
-                
-                    // Update uber buffer with material properties
-                    m_buffer_uber_cpu.mat_id            = static_cast<float>(material_index);
-                    m_buffer_uber_cpu.mat_albedo        = material->GetColorAlbedo();
-                    m_buffer_uber_cpu.mat_tiling_uv     = material->GetTiling();
-                    m_buffer_uber_cpu.mat_offset_uv     = material->GetOffset();
-                    m_buffer_uber_cpu.mat_roughness_mul = material->GetProperty(Material_Roughness);
-                    m_buffer_uber_cpu.mat_metallic_mul  = material->GetProperty(Material_Metallic);
-                    m_buffer_uber_cpu.mat_normal_mul    = material->GetProperty(Material_Normal);
-                    m_buffer_uber_cpu.mat_height_mul    = material->GetProperty(Material_Height);
-
-                    // Update constant buffer
-                    UpdateUberBuffer(cmd_list);
+                // Materials which didn't fit in the bindless table can't be drawn
+                if (bindless && material_index_bindless == rhi_bindless_index_invalid)
+                    continue;
+
+                const uint32_t lod = renderable->GeometryLodSelect(m_camera->GetViewMatrix(), m_camera->GetProjectionMatrix());
+                m_draw_calls.push_back({ entity, renderable, model, material, material_index, material_index_bindless, lod, geometry });
+            }
+
+            if (m_draw_calls.empty())
+                continue;
+
+            // Draws skinned on the GPU go last, they need the skinned variation of the vertex shader and so a render pass of their own
+            const auto draw_calls_skinned_gpu   = stable_partition(m_draw_calls.begin(), m_draw_calls.end(), [](const DrawCall& draw_call) { return !draw_call.geometry.skinned_gpu; });
+            const uint32_t draw_count           = static_cast<uint32_t>(draw_calls_skinned_gpu - m_draw_calls.begin());
+            const uint32_t draw_count_skinned   = static_cast<uint32_t>(m_draw_calls.end() - draw_calls_skinned_gpu);
+            uint32_t draw_call_first            = 0;
+
+            // Record commands
+            auto record = [this, bindless, &draw_call_first](RHI_CommandList* cmd_list, const uint32_t thread_index, const uint32_t start, const uint32_t end)
+            {
+                BufferUber& buffer_uber = m_recording_threads[thread_index].buffer_uber_cpu;
+
+                for (uint32_t i = draw_call_first + start; i < draw_call_first + end; i++)
+                {
+                    const DrawCall& draw_call = m_draw_calls[i];
+                    Material* material        = draw_call.material;
+
+                    // Set geometry (will only happen if not already set)
+                    cmd_list->SetBufferIndex(draw_call.model->GetIndexBuffer());
+                    cmd_list->SetBufferVertex(draw_call.geometry.vertex_buffer);
+
+                    // Bind bones
+                    if (draw_call.geometry.skinned_gpu)
+                    {
+                        cmd_list->SetStructuredBuffer(RendererBindingsSrv::bones, m_bones_gpu.get());
+                        buffer_uber.bone_offset = draw_call.geometry.bone_offset;
+                    }
+
+                    // Bind material (every range starts with no material bound)
+                    const bool range_start = i == draw_call_first + start;
+                    if (bindless && (range_start || m_draw_calls[i - 1].material != material))
+                    {
+                        // Textures and properties are read from the bindless table, only the indices change
+                        buffer_uber.mat_id              = static_cast<float>(draw_call.material_index);
+                        buffer_uber.mat_bindless_index  = static_cast<float>(draw_call.material_index_bindless);
+                        UpdateUberBuffer(cmd_list, thread_index);
+                    }
+                    else if (range_start || m_draw_calls[i - 1].material != material)
+                    {
+                        // Bind material textures
+                        cmd_list->SetTexture(RendererBindingsSrv::material_albedo,      material->GetTexture_Ptr(Material_Color));
+                        cmd_list->SetTexture(RendererBindingsSrv::material_roughness,   material->GetTexture_Ptr(Material_Roughness));
+                        cmd_list->SetTexture(RendererBindingsSrv::material_metallic,    material->GetTexture_Ptr(Material_Metallic));
+                        cmd_list->SetTexture(RendererBindingsSrv::material_normal,      material->GetTexture_Ptr(Material_Normal));
+                        cmd_list->SetTexture(RendererBindingsSrv::material_height,      material->GetTexture_Ptr(Material_Height));
+                        cmd_list->SetTexture(RendererBindingsSrv::material_occlusion,   material->GetTexture_Ptr(Material_Occlusion));
+                        cmd_list->SetTexture(RendererBindingsSrv::material_emission,    material->GetTexture_Ptr(Material_Emission));
+                        cmd_list->SetTexture(RendererBindingsSrv::material_mask,        material->GetTexture_Ptr(Material_Mask));
+
+                        // Update uber buffer with material properties
+                        buffer_uber.mat_id            = static_cast<float>(draw_call.material_index);
+                        buffer_uber.mat_albedo        = material->GetColorAlbedo();
+                        buffer_uber.mat_tiling_uv     = material->GetTiling();
+                        buffer_uber.mat_offset_uv     = material->GetOffset();
+                        buffer_uber.mat_roughness_mul = material->GetProperty(Material_Roughness);
+                        buffer_uber.mat_metallic_mul  = material->GetProperty(Material_Metallic);
+                        buffer_uber.mat_normal_mul    = material->GetProperty(Material_Normal);
+                        buffer_uber.mat_height_mul    = material->GetProperty(Material_Height);
+
+                        // Update constant buffer
+                        UpdateUberBuffer(cmd_list, thread_index);
+                    }
+
+                    // Update uber buffer with entity transform
+                    if (Transform* transform = draw_call.entity->GetTransform())
+                    {
+                        const Matrix& vertex_transform  = *draw_call.geometry.vertex_transform;
+                        buffer_uber.transform           = vertex_transform * transform->GetMatrix();
+                        buffer_uber.transform_previous  = vertex_transform * transform->GetMatrixPrevious();
+
+                        // Save matrix for velocity computation
+                        transform->SetWvpLastFrame(transform->GetMatrix());
+
+                        // Update object buffer
+                        if (!UpdateUberBuffer(cmd_list, thread_index))
+                            continue;
+                    }
+
+                    // Render
+                    if (draw_call.geometry.skinned)
+                    {
+                        cmd_list->DrawIndexed(draw_call.renderable->GeometryIndexCount(draw_call.lod), draw_call.renderable->GeometryIndexOffset(draw_call.lod), draw_call.geometry.vertex_offset);
+                        count_triangles(m_profiler, draw_call.renderable, draw_call.lod);
+                    }
+                    else if (draw_call.lod == 0)
+                    {
+                        // Full detail, the meshlets outside of the view or facing away are skipped
+                        m_profiler->m_renderer_triangles += DrawMeshlets(cmd_list, draw_call.renderable, draw_call.entity->GetTransform()->GetMatrix());
+                    }
+                    else
+                    {
+                        cmd_list->DrawIndexed(draw_call.renderable->GeometryIndexCount(draw_call.lod), draw_call.renderable->GeometryIndexOffset(draw_call.lod), draw_call.renderable->GeometryVertexOffset());
+                        count_triangles(m_profiler, draw_call.renderable, draw_call.lod);
+                    }
+                    m_profiler->m_renderer_meshes_rendered++;
                 }
-                
-                // Update uber buffer with entity transform
-                if (Transform* transform = entity->GetTransform())
+            };
+
+            for (const bool skinned_gpu : { false, true })
+            {
+                const uint32_t count = skinned_gpu ? draw_count_skinned : draw_count;
+                if (count == 0 || (skinned_gpu && !SetPipelineStateSkinned(pso, true)))
+                    continue;
+
+                // Reset clear values after the first render pass
+                if (cleared)
                 {
-                    m_buffer_uber_cpu.transform             = transform->GetMatrix();
-                    m_buffer_uber_cpu.transform_previous    = transform->GetMatrixPrevious();
+                    pso.ResetClearValues();
+                }
+                cleared = true;
 
-                    // Save matrix for velocity computation
-                    transform->SetWvpLastFrame(m_buffer_uber_cpu.transform);
+                draw_call_first = skinned_gpu ? draw_count : 0;
+                if (cmd_list->BeginRenderPass(pso))
+                {
+                    RecordParallel(cmd_list, count, record);
+                    cmd_list->EndRenderPass();
+                }
 
-                    // Update object buffer
-                    if (!UpdateUberBuffer(cmd_list))
-                        continue;
+                if (skinned_gpu)
+                {
+                    SetPipelineStateSkinned(pso, false);
                 }
-                
-                // Render
-                cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
-                m_profiler->m_renderer_meshes_rendered++;
             }
+        }
+    }
 
-            if (render_pass_active)
+    bool Renderer::Pass_GBufferIndirect(RHI_CommandList* cmd_list, RHI_PipelineState& pso, uint32_t* material_index_last)
+    {
+        // Every instance is drawn with the same shaders, so materials have to come from the bindless table,
+        // and the draw count of every model is written by the GPU, so the device has to be able to read it.
+        if (!m_bindless_table->IsValid() || !m_rhi_device->IsDrawIndirectCountSupported())
+            return false;
+
+        // Acquire shaders
+        const uint16_t shader_p_flags   = ShaderGBuffer::flag_bindless | ShaderGBuffer::flag_indirect;
+        RHI_Shader* shader_v            = m_shaders[RendererShader::Gbuffer_Indirect_V].get();
+        RHI_Shader* shader_c            = m_shaders[RendererShader::Culling_C].get();
+        if (!shader_v->IsCompiled() || !shader_c->IsCompiled() || !ShaderGBuffer::GenerateVariation(m_context, shader_p_flags)->IsCompiled())
+            return false;
+
+        auto& entities = m_entities[Renderer_Object_Opaque];
+        auto& occluded = m_entities_occluded[Renderer_Object_Opaque];
+
+        // The renderables of a model share it's vertex and index buffers, so each model is a batch
+        // of draws which only differ in their arguments, and the culling shader appends to them.
+        m_indirect_batches.clear();
+        m_indirect_batch_indices.clear();
+        m_indirect_material_indices.clear();
+        m_instances_cpu.clear();
+        uint32_t material_index = 0;
+
+        // Acquire instances
+        for (uint32_t i = 0; i < static_cast<uint32_t>(entities.size()); i++)
+        {
+            Entity* entity = entities[i];
+
+            // Get renderable
+            Renderable* renderable = entity->GetRenderable();
+            if (!renderable)
+                continue;
+
+            // Get material
+            Material* material = renderable->GetMaterial();
+            if (!material)
+                continue;
+
+            // Get geometry
+            Model* model = renderable->GeometryModel();
+            if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
+                continue;
+
+            // Skinned vertices live in the buffers of their animators, which the batches (a model each) can't reference, Pass_GBuffer() draws them
+            if (GetGeometry(entity, renderable, model).skinned)
+                continue;
+
+            // Get transform
+            Transform* transform = entity->GetTransform();
+            if (!transform)
+                continue;
+
+            // Skip occluded objects (the view frustum is tested by the culling shader)
+            if (i < occluded.size() && occluded[i])
+                continue;
+
+            if (m_instances_cpu.size() == m_max_instances)
             {
-                cmd_list->EndRenderPass();
+                LOG_ERROR("Instance buffer has reached it's maximum capacity of %d elements. Consider increasing the size.", m_max_instances);
+                break;
             }
+
+            // Keep track of used material instances (they get mapped to shaders) and copy them to the bindless table
+            auto it_material = m_indirect_material_indices.find(material->GetId());
+            if (it_material == m_indirect_material_indices.end())
+            {
+                if (material_index + 1 >= m_material_instances.size())
+                {
+                    LOG_ERROR("Material instance array has reached it's maximum capacity of %d elements. Consider increasing the size.", m_max_material_instances);
+                    continue;
+                }
+
+                // Advance index (0 is reserved for the sky)
+                material_index++;
+                m_material_instances[material_index] = material;
+                it_material = m_indirect_material_indices.emplace(material->GetId(), make_pair(material_index, AddBindlessMaterial(material))).first;
+            }
+
+            // Materials which didn't fit in the bindless table can't be drawn
+            if (it_material->second.second == rhi_bindless_index_invalid)
+                continue;
+
+            // Get batch
+            auto it_batch = m_indirect_batch_indices.find(model);
+            if (it_batch == m_indirect_batch_indices.end())
+            {
+                it_batch = m_indirect_batch_indices.emplace(model, static_cast<uint32_t>(m_indirect_batches.size())).first;
+                m_indirect_batches.push_back({ model, 0, 0 });
+            }
+            m_indirect_batches[it_batch->second].instance_count++;
+
+            const BoundingBox& aabb = renderable->GetAabb();
+            const uint32_t lod      = renderable->GeometryLodSelect(m_camera->GetViewMatrix(), m_camera->GetProjectionMatrix());
+
+            BufferInstance instance     = {};
+            instance.transform          = model->GetVertexTransform() * transform->GetMatrix();
+            instance.transform_previous = model->GetVertexTransform() * transform->GetMatrixPrevious();
+            instance.aabb_min           = aabb.GetMin();
+            instance.aabb_max           = aabb.GetMax();
+            instance.index_count        = renderable->GeometryIndexCount(lod);
+            instance.index_offset       = renderable->GeometryIndexOffset(lod);
+            instance.vertex_offset      = renderable->GeometryVertexOffset();
+            instance.batch              = it_batch->second;
+            instance.mat_id             = it_material->second.first;
+            instance.mat_bindless_index = it_material->second.second;
+            m_instances_cpu.push_back(instance);
+            count_triangles(m_profiler, renderable, lod); // submitted, the gpu culls some of them
+
+            // Save matrix for velocity computation
+            transform->SetWvpLastFrame(transform->GetMatrix());
+        }
+
+        if (m_instances_cpu.empty())
+            return false;
+
+        // Reserve a range of draw arguments for every batch
+        uint32_t draw_offset = 0;
+        for (IndirectBatch& batch : m_indirect_batches)
+        {
+            batch.draw_offset = draw_offset;
+            draw_offset += batch.instance_count;
         }
+
+        for (BufferInstance& instance : m_instances_cpu)
+        {
+            instance.batch_offset = m_indirect_batches[instance.batch].draw_offset;
+        }
+
+        // Upload instances
+        const uint32_t instance_count = static_cast<uint32_t>(m_instances_cpu.size());
+        if (!m_instances_gpu->Update(m_instances_cpu.data(), instance_count))
+            return false;
+
+        // Cull instances against the view frustum and write the draw arguments of the visible ones
+        {
+            static RHI_PipelineState pso_culling;
+            pso_culling.shader_compute  = shader_c;
+            pso_culling.pass_name       = "Pass_Culling";
+
+            // The culling shader appends to the draw counts
+            cmd_list->ClearStructuredBuffer(m_indirect_count.get());
+
+            if (!cmd_list->BeginRenderPass(pso_culling))
+                return false;
+
+            cmd_list->SetStructuredBuffer(RendererBindingsSrv::instances,           m_instances_gpu.get());
+            cmd_list->SetStructuredBuffer(RendererBindingsUav::indirect_arguments,  m_indirect_arguments.get());
+            cmd_list->SetStructuredBuffer(RendererBindingsUav::indirect_count,      m_indirect_count.get());
+            cmd_list->Dispatch((instance_count + 63) / 64, 1, 1, false); // the culling shader has 64 threads per group
+            cmd_list->EndRenderPass();
+
+            // Make the arguments and counts visible to the draws
+            cmd_list->InsertBarrier(m_indirect_arguments.get());
+            cmd_list->InsertBarrier(m_indirect_count.get());
+        }
+
+        // Draw
+        pso.shader_vertex   = shader_v;
+        pso.shader_pixel    = static_cast<RHI_Shader*>(ShaderGBuffer::GetVariations().at(shader_p_flags).get());
+        pso.bindless_table  = m_bindless_table.get();
+        pso.pass_name       = "GBuffer_Opaque";
+        if (!cmd_list->BeginRenderPass(pso))
+            return false;
+
+        cmd_list->SetStructuredBuffer(RendererBindingsSrv::instances, m_instances_gpu.get());
+
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_indirect_batches.size()); i++)
+        {
+            const IndirectBatch& batch = m_indirect_batches[i];
+
+            // Set geometry
+            cmd_list->SetBufferIndex(batch.model->GetIndexBuffer());
+            cmd_list->SetBufferVertex(batch.model->GetVertexBuffer());
+
+            // Render, up to one draw per instance of the model
+            cmd_list->DrawIndexedIndirectCount(m_indirect_arguments.get(), batch.draw_offset, m_indirect_count.get(), i, batch.instance_count);
+        }
+
+        cmd_list->EndRenderPass();
+
+        m_profiler->m_renderer_instances_gpu_driven += instance_count;
+
+        // Material instances which are added after these continue from here
+        *material_index_last = material_index;
+
+        return true;
     }
 
     void Renderer::Pass_Ssgi(RHI_CommandList* cmd_list)
@@ -657,7 +1436,6 @@ namespace Spartan
 
         // Acquire textures
         shared_ptr<RHI_Texture>& tex_ssao_noisy     = m_render_targets[RendererRt::Ssao];
-        shared_ptr<RHI_Texture>& tex_ssao_blurred   = m_render_targets[RendererRt::Ssao_Blurred];
         RHI_Texture* tex_depth                      = m_render_targets[RendererRt::Gbuffer_Depth].get();
         RHI_Texture* tex_normal                     = m_render_targets[RendererRt::Gbuffer_Normal].get();
 
@@ -683,21 +1461,31 @@ namespace Spartan
             cmd_list->SetTexture(RendererBindingsSrv::gbuffer_depth, tex_depth);
             cmd_list->Dispatch(thread_group_count_x, thread_group_count_y, thread_group_count_z, async);
             cmd_list->EndRenderPass();
-
-            // Bilateral blur
-            const auto sigma = 2.0f;
-            const auto pixel_stride = 2.0f;
-            Pass_BlurBilateralGaussian(
-                cmd_list,
-                tex_ssao_noisy,
-                tex_ssao_blurred,
-                sigma,
-                pixel_stride,
-                false
-            );
         }
     }
 
+    void Renderer::Pass_SsaoBlur(RHI_CommandList* cmd_list)
+    {
+        if ((m_options & Render_Ssao) == 0)
+            return;
+
+        // Acquire textures
+        shared_ptr<RHI_Texture>& tex_ssao_noisy     = m_render_targets[RendererRt::Ssao];
+        shared_ptr<RHI_Texture>& tex_ssao_blurred   = m_render_targets[RendererRt::Ssao_Blurred];
+
+        // Bilateral blur
+        const auto sigma = 2.0f;
+        const auto pixel_stride = 2.0f;
+        Pass_BlurBilateralGaussian(
+            cmd_list,
+            tex_ssao_noisy,
+            tex_ssao_blurred,
+            sigma,
+            pixel_stride,
+            false
+        );
+    }
+
     void Renderer::Pass_SsrTrace(RHI_CommandList* cmd_list)
     {
         if ((m_options & Render_ScreenSpaceReflections) == 0)
@@ -788,11 +1576,6 @@ namespace Spartan
 
     void Renderer::Pass_Light(RHI_CommandList* cmd_list, const bool is_transparent_pass /*= false*/)
     {
-        // Acquire lights
-        const vector<Entity*>& entities = m_entities[Renderer_Object_Light];
-        if (entities.empty())
-            return;
-
         // Acquire render targets
         RHI_Texture* tex_diffuse    = is_transparent_pass ? m_render_targets[RendererRt::Light_Diffuse_Transparent].get()   : m_render_targets[RendererRt::Light_Diffuse].get();
         RHI_Texture* tex_specular   = is_transparent_pass ? m_render_targets[RendererRt::Light_Specular_Transparent].get()  : m_render_targets[RendererRt::Light_Specular].get();
@@ -803,14 +1586,26 @@ namespace Spartan
         cmd_list->ClearRenderTarget(tex_specular,   0, 0, true, Vector4::Zero);
         cmd_list->ClearRenderTarget(tex_volumetric, 0, 0, true, Vector4::Zero);
 
+        // Acquire lights (after clearing, since the render targets can be aliased transient textures with stale content)
+        const vector<Entity*>& entities = m_entities[Renderer_Object_Light];
+        if (entities.empty())
+            return;
+
+        // Unshadowed lights, all of them in a single dispatch
+        Pass_LightClustered(cmd_list, tex_diffuse, tex_specular, is_transparent_pass);
+
         // Set render state
         static RHI_PipelineState pso;
         pso.pass_name = is_transparent_pass ? "Pass_Light_Transparent" : "Pass_Light_Opaque";
 
         // Iterate through all the light entities
-        for (const auto& entity : entities)
+        for (uint32_t i = 0; i < static_cast<uint32_t>(entities.size()); i++)
         {
-            if (Light* light = entity->GetComponent<Light>())
+            // Skip lights which were shaded by the clustered pass
+            if (i < m_lights_clustered.size() && m_lights_clustered[i])
+                continue;
+
+            if (Light* light = entities[i]->GetComponent<Light>())
             {
                 if (light->GetIntensity() != 0)
                 {
@@ -881,6 +1676,52 @@ namespace Spartan
         }
     }
 
+    void Renderer::Pass_LightClustered(RHI_CommandList* cmd_list, RHI_Texture* tex_diffuse, RHI_Texture* tex_specular, const bool is_transparent_pass)
+    {
+        // Only if the clusters have any lights
+        if (m_buffer_light_clusters_cpu.params.w == 0.0f)
+            return;
+
+        // Acquire shaders
+        RHI_Shader* shader_c = m_shaders[RendererShader::Light_Clustered_C].get();
+        if (!shader_c->IsCompiled())
+            return;
+
+        // Set render state
+        static RHI_PipelineState pso;
+        pso.shader_compute  = shader_c;
+        pso.pass_name       = is_transparent_pass ? "Pass_LightClustered_Transparent" : "Pass_LightClustered_Opaque";
+
+        // Draw
+        if (cmd_list->BeginRenderPass(pso))
+        {
+            // Update constant buffers (light pass will access the material buffer using material IDs)
+            UpdateMaterialBuffer(cmd_list);
+            UpdateLightClustersBuffer(cmd_list);
+
+            cmd_list->SetTexture(RendererBindingsUav::rgb,              tex_diffuse);
+            cmd_list->SetTexture(RendererBindingsUav::rgb2,             tex_specular);
+            cmd_list->SetTexture(RendererBindingsSrv::gbuffer_albedo,   m_render_targets[RendererRt::Gbuffer_Albedo]);
+            cmd_list->SetTexture(RendererBindingsSrv::gbuffer_normal,   m_render_targets[RendererRt::Gbuffer_Normal]);
+            cmd_list->SetTexture(RendererBindingsSrv::gbuffer_material, m_render_targets[RendererRt::Gbuffer_Material]);
+            cmd_list->SetTexture(RendererBindingsSrv::gbuffer_depth,    m_render_targets[RendererRt::Gbuffer_Depth]);
+            cmd_list->SetTexture(RendererBindingsSrv::ssao,             (m_options & Render_Ssao) ? m_render_targets[RendererRt::Ssao_Blurred] : m_default_tex_white);
+
+            // Update uber buffer
+            m_buffer_uber_cpu.resolution            = Vector2(static_cast<float>(tex_diffuse->GetWidth()), static_cast<float>(tex_diffuse->GetHeight()));
+            m_buffer_uber_cpu.is_transparent_pass   = is_transparent_pass;
+            UpdateUberBuffer(cmd_list);
+
+            const uint32_t thread_group_count_x = static_cast<uint32_t>(Math::Helper::Ceil(static_cast<float>(tex_diffuse->GetWidth()) / m_thread_group_count));
+            const uint32_t thread_group_count_y = static_cast<uint32_t>(Math::Helper::Ceil(static_cast<float>(tex_diffuse->GetHeight()) / m_thread_group_count));
+            const uint32_t thread_group_count_z = 1;
+            const bool async = false;
+
+            cmd_list->Dispatch(thread_group_count_x, thread_group_count_y, thread_group_count_z, async);
+            cmd_list->EndRenderPass();
+        }
+    }
+
     void Renderer::Pass_LightComposition(RHI_CommandList* cmd_list, RHI_Texture* tex_out, const bool is_transparent_pass /*= false*/)
     {
         // Acquire shaders
@@ -2235,22 +3076,35 @@ namespace Spartan
             pso.viewport                                 = tex_out->GetViewport();
             pso.pass_name                                = "Pass_Outline";
 
+            // Skinned on the GPU, the vertex shader has to skin too
+            const GeometryBinding geometry = GetGeometry(entity, renderable, model);
+            if (geometry.skinned_gpu && !SetPipelineStateSkinned(pso, true))
+                return;
+
             // Record commands
             if (cmd_list->BeginRenderPass(pso))
             {
+                // Bind bones
+                if (geometry.skinned_gpu)
+                {
+                    cmd_list->SetStructuredBuffer(RendererBindingsSrv::bones, m_bones_gpu.get());
+                    m_buffer_uber_cpu.bone_offset = geometry.bone_offset;
+                }
+
                  // Update uber buffer with entity transform
                 if (Transform* transform = entity->GetTransform())
                 {
-                    m_buffer_uber_cpu.transform     = transform->GetMatrix();
+                    m_buffer_uber_cpu.transform     = *geometry.vertex_transform * transform->GetMatrix();
                     m_buffer_uber_cpu.resolution    = Vector2(tex_out->GetWidth(), tex_out->GetHeight());
                     UpdateUberBuffer(cmd_list);
                 }
 
                 cmd_list->SetTexture(RendererBindingsSrv::gbuffer_depth, tex_depth);
                 cmd_list->SetTexture(RendererBindingsSrv::gbuffer_normal, tex_normal);
-                cmd_list->SetBufferVertex(model->GetVertexBuffer());
+                cmd_list->SetBufferVertex(geometry.vertex_buffer);
                 cmd_list->SetBufferIndex(model->GetIndexBuffer());
-                cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
+                const uint32_t lod = renderable->GeometryLodSelect(m_camera->GetViewMatrix(), m_camera->GetProjectionMatrix());
+                cmd_list->DrawIndexed(renderable->GeometryIndexCount(lod), renderable->GeometryIndexOffset(lod), geometry.vertex_offset);
                 cmd_list->EndRenderPass();
             }
         }
@@ -2258,12 +3112,20 @@ namespace Spartan
 
     void Renderer::Pass_Text(RHI_CommandList* cmd_list, RHI_Texture* tex_out)
     {
+        // Performance metrics
+        if ((m_options & Render_Debug_PerformanceMetrics) && !m_profiler->GetMetrics().empty())
+        {
+            const Vector2 text_pos = Vector2(-m_viewport.width * 0.5f + 5.0f, m_viewport.height * 0.5f - m_font->GetSize() - 2.0f);
+            m_font->AddText(m_profiler->GetMetrics(), text_pos);
+        }
+
+        // Upload everything that was added to the font this frame, this also starts the next batch
+        const bool has_text = m_font->UpdateVertexBuffer(m_swap_chain->GetCmdIndex(), m_swap_chain->GetBufferCount()) && m_font->GetQuadCount() != 0;
+
         // Early exit cases
-        const bool draw         = m_options & Render_Debug_PerformanceMetrics;
-        const bool empty        = m_profiler->GetMetrics().empty();
         const auto& shader_v    = m_shaders[RendererShader::Font_V];
         const auto& shader_p    = m_shaders[RendererShader::Font_P];
-        if (!draw || empty || !shader_v->IsCompiled() || !shader_p->IsCompiled())
+        if (!has_text || !m_font->GetAtlas() || !m_font_quad_index_buffer || !shader_v->IsCompiled() || !shader_p->IsCompiled())
             return;
 
         // Set render state
@@ -2279,40 +3141,28 @@ namespace Spartan
         pso.viewport                         = tex_out->GetViewport();
         pso.pass_name                        = "Pass_Text";
 
-        // Update text
-        const Vector2 text_pos = Vector2(-m_viewport.width * 0.5f + 5.0f, m_viewport.height * 0.5f - m_font->GetSize() - 2.0f);
-        m_font->SetText(m_profiler->GetMetrics(), text_pos);
-
-        // Draw outline
-        if (m_font->GetOutline() != Font_Outline_None && m_font->GetOutlineSize() != 0)
-        { 
-            if (cmd_list->BeginRenderPass(pso))
-            {
-                // Update uber buffer
-                m_buffer_uber_cpu.resolution    = Vector2(static_cast<float>(tex_out->GetWidth()), static_cast<float>(tex_out->GetHeight()));
-                m_buffer_uber_cpu.color         = m_font->GetColorOutline();
-                UpdateUberBuffer(cmd_list);
-
-                cmd_list->SetBufferIndex(m_font->GetIndexBuffer());
-                cmd_list->SetBufferVertex(m_font->GetVertexBuffer());
-                cmd_list->SetTexture(RendererBindingsSrv::font_atlas, m_font->GetAtlasOutline());
-                cmd_list->DrawIndexed(m_font->GetIndexCount());
-                cmd_list->EndRenderPass();
-            }
-        }
-
-        // Draw 
+        // Draw, the outline comes from the same distance field atlas as the text
         if (cmd_list->BeginRenderPass(pso))
         {
             // Update uber buffer
             m_buffer_uber_cpu.resolution    = Vector2(static_cast<float>(tex_out->GetWidth()), static_cast<float>(tex_out->GetHeight()));
             m_buffer_uber_cpu.color         = m_font->GetColor();
+            m_buffer_uber_cpu.mat_albedo    = m_font->GetColorOutline();
+            m_buffer_uber_cpu.mat_tiling_uv = m_font->GetOutlineThresholds();
             UpdateUberBuffer(cmd_list);
 
-            cmd_list->SetBufferIndex(m_font->GetIndexBuffer());
+            cmd_list->SetBufferIndex(m_font_quad_index_buffer.get());
             cmd_list->SetBufferVertex(m_font->GetVertexBuffer());
             cmd_list->SetTexture(RendererBindingsSrv::font_atlas, m_font->GetAtlas());
-            cmd_list->DrawIndexed(m_font->GetIndexCount());
+
+            // The whole batch shares the atlas, so it's a single draw unless it has more quads than 16-bit indices can address
+            const uint32_t quad_count = m_font->GetQuadCount();
+            for (uint32_t quad_start = 0; quad_start < quad_count; quad_start += font_batch_quads_per_draw)
+            {
+                const uint32_t quads = Helper::Min(quad_count - quad_start, font_batch_quads_per_draw);
+                cmd_list->DrawIndexed(quads * 6, 0, m_font->GetVertexOffset() + quad_start * 4);
+            }
+
             cmd_list->EndRenderPass();
         }
     }
@@ -19,22 +19,26 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES ============================
+//= INCLUDES =============================
 #include "Spartan.h"
 #include "Renderer.h"
 #include "ShaderGBuffer.h"
 #include "ShaderLight.h"
+#include "RenderGraph.h"
 #include "Font/Font.h"
 #include "../Resource/ResourceCache.h"
 #include "../RHI/RHI_Texture2D.h"
+#include "../RHI/RHI_IndexBuffer.h"
 #include "../RHI/RHI_Shader.h"
 #include "../RHI/RHI_Sampler.h"
 #include "../RHI/RHI_BlendState.h"
 #include "../RHI/RHI_ConstantBuffer.h"
+#include "../RHI/RHI_StructuredBuffer.h"
 #include "../RHI/RHI_RasterizerState.h"
 #include "../RHI/RHI_DepthStencilState.h"
 #include "../RHI/RHI_SwapChain.h"
-//=======================================
+#include "../RHI/RHI_PipelineCache.h"
+//========================================
 
 //= NAMESPACES ===============
 using namespace std;
@@ -45,19 +49,41 @@ namespace Spartan
 {
     void Renderer::CreateConstantBuffers()
     {
-        bool is_dynamic = true;
+        // All dynamic buffers are sub-allocated from the same pages, which are recycled once per swapchain buffer
+        RHI_UploadAllocator* upload_allocator = m_upload_allocator.get();
 
-        m_buffer_frame_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device, "frame", is_dynamic);
-        m_buffer_frame_gpu->Create<BufferFrame>(m_swap_chain_buffer_count);
+        m_buffer_frame_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device, "frame", upload_allocator);
+        m_buffer_frame_gpu->Create<BufferFrame>();
 
-        m_buffer_material_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device, "material", is_dynamic);
-        m_buffer_material_gpu->Create<BufferMaterial>(m_swap_chain_buffer_count);
+        m_buffer_material_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device, "material", upload_allocator);
+        m_buffer_material_gpu->Create<BufferMaterial>();
 
-        m_buffer_uber_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device, "uber", is_dynamic);
-        m_buffer_uber_gpu->Create<BufferUber>(64);
+        m_buffer_uber_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device, "uber", upload_allocator);
+        m_buffer_uber_gpu->Create<BufferUber>();
 
-        m_buffer_light_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device, "light", is_dynamic);
-        m_buffer_light_gpu->Create<BufferLight>(m_swap_chain_buffer_count);
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_recording_threads.size()); i++)
+        {
+            m_recording_threads[i].buffer_uber_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device, "uber_thread_" + to_string(i), upload_allocator);
+            m_recording_threads[i].buffer_uber_gpu->Create<BufferUber>();
+        }
+
+        m_buffer_light_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device, "light", upload_allocator);
+        m_buffer_light_gpu->Create<BufferLight>();
+
+        m_buffer_light_clusters_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device, "light_clusters", upload_allocator);
+        m_buffer_light_clusters_gpu->Create<BufferLightClusters>();
+    }
+
+    void Renderer::CreateStructuredBuffers()
+    {
+        m_instances_gpu = make_shared<RHI_StructuredBuffer>(m_rhi_device, static_cast<uint32_t>(sizeof(BufferInstance)), m_max_instances, "instances", m_upload_allocator.get());
+
+        // Every instance can end up being a draw, and in the worst case every instance is a model of it's own
+        m_indirect_arguments    = make_shared<RHI_StructuredBuffer>(m_rhi_device, static_cast<uint32_t>(sizeof(RHI_DrawIndexedIndirectArguments)), m_max_instances, "indirect_arguments");
+        m_indirect_count        = make_shared<RHI_StructuredBuffer>(m_rhi_device, static_cast<uint32_t>(sizeof(uint32_t)), m_max_instances, "indirect_count");
+
+        m_bones_gpu = make_shared<RHI_StructuredBuffer>(m_rhi_device, static_cast<uint32_t>(sizeof(Matrix)), m_max_bones, "bones", m_upload_allocator.get());
+        m_bones_cpu.resize(m_max_bones);
     }
 
     void Renderer::CreateDepthStencilStates()
@@ -68,6 +94,13 @@ namespace Spartan
         m_depth_stencil_r_off   = make_shared<RHI_DepthStencilState>(m_rhi_device, true,    false,  GetComparisonFunction(), false, false,  RHI_Comparison_Never);  // depth
         m_depth_stencil_off_r   = make_shared<RHI_DepthStencilState>(m_rhi_device, false,   false,  RHI_Comparison_Never,    true,  false,  RHI_Comparison_Equal);  // depth + stencil
         m_depth_stencil_rw_w    = make_shared<RHI_DepthStencilState>(m_rhi_device, true,    true,   GetComparisonFunction(), false,  true,  RHI_Comparison_Always); // depth + stencil
+
+        // Register them, so that pipelines which use them can be pre-warmed
+        m_pipeline_cache->RegisterObject("depth_stencil_off_off",   m_depth_stencil_off_off.get());
+        m_pipeline_cache->RegisterObject("depth_stencil_rw_off",    m_depth_stencil_rw_off.get());
+        m_pipeline_cache->RegisterObject("depth_stencil_r_off",     m_depth_stencil_r_off.get());
+        m_pipeline_cache->RegisterObject("depth_stencil_off_r",     m_depth_stencil_off_r.get());
+        m_pipeline_cache->RegisterObject("depth_stencil_rw_w",      m_depth_stencil_rw_w.get());
     }
 
     void Renderer::CreateRasterizerStates()
@@ -79,6 +112,12 @@ namespace Spartan
         m_rasterizer_cull_back_wireframe    = make_shared<RHI_RasterizerState>(m_rhi_device, RHI_Cull_Back, RHI_Fill_Wireframe, true,  false, true);
         m_rasterizer_light_point_spot       = make_shared<RHI_RasterizerState>(m_rhi_device, RHI_Cull_Back, RHI_Fill_Solid,     true,  false, false, depth_bias,         m_depth_bias_clamp, depth_bias_slope_scaled);
         m_rasterizer_light_directional      = make_shared<RHI_RasterizerState>(m_rhi_device, RHI_Cull_Back, RHI_Fill_Solid,     false, false, false, depth_bias * 0.1f,  m_depth_bias_clamp, depth_bias_slope_scaled);
+
+        // Register them, so that pipelines which use them can be pre-warmed
+        m_pipeline_cache->RegisterObject("rasterizer_cull_back_solid",        m_rasterizer_cull_back_solid.get());
+        m_pipeline_cache->RegisterObject("rasterizer_cull_back_wireframe",    m_rasterizer_cull_back_wireframe.get());
+        m_pipeline_cache->RegisterObject("rasterizer_light_point_spot",       m_rasterizer_light_point_spot.get());
+        m_pipeline_cache->RegisterObject("rasterizer_light_directional",      m_rasterizer_light_directional.get());
     }
 
     void Renderer::CreateBlendStates()
@@ -87,6 +126,11 @@ namespace Spartan
         m_blend_disabled    = make_shared<RHI_BlendState>(m_rhi_device, false);
         m_blend_alpha       = make_shared<RHI_BlendState>(m_rhi_device, true, RHI_Blend_Src_Alpha,  RHI_Blend_Inv_Src_Alpha,    RHI_Blend_Operation_Add, RHI_Blend_One, RHI_Blend_One, RHI_Blend_Operation_Add);
         m_blend_additive    = make_shared<RHI_BlendState>(m_rhi_device, true, RHI_Blend_One,        RHI_Blend_One,              RHI_Blend_Operation_Add, RHI_Blend_One, RHI_Blend_One, RHI_Blend_Operation_Add);
+
+        // Register them, so that pipelines which use them can be pre-warmed
+        m_pipeline_cache->RegisterObject("blend_disabled",  m_blend_disabled.get());
+        m_pipeline_cache->RegisterObject("blend_alpha",     m_blend_alpha.get());
+        m_pipeline_cache->RegisterObject("blend_additive",  m_blend_additive.get());
     }
 
     void Renderer::CreateSamplers()
@@ -113,21 +157,26 @@ namespace Spartan
 
         Flush();
 
+        // Transient textures (the light targets, SSGI and SSR) are created by the render graph, release the old ones
+        if (m_render_graph)
+        {
+            m_render_graph->ReleaseTextures();
+        }
+
+        // The targets which the async compute passes (SSAO, SSR and SSGI) access have to be shared with the compute queue
+        const uint16_t flags_async = GetOption(Render_AsyncCompute) ? RHI_Texture_AsyncCompute : 0;
+
         // G-Buffer
         // Stencil is used to mask transparent objects and also has a read only version
         // From and below Texture_Format_R8G8B8A8_UNORM, normals have noticeable banding
-        m_render_targets[RendererRt::Gbuffer_Albedo]   = make_shared<RHI_Texture2D>(m_context, width, height, RHI_Format_R8G8B8A8_Unorm,       1, 0,                                   "rt_gbuffer_albedo");
-        m_render_targets[RendererRt::Gbuffer_Normal]   = make_shared<RHI_Texture2D>(m_context, width, height, RHI_Format_R16G16B16A16_Float,   1, 0,                                   "rt_gbuffer_normal");
-        m_render_targets[RendererRt::Gbuffer_Material] = make_shared<RHI_Texture2D>(m_context, width, height, RHI_Format_R8G8B8A8_Unorm,       1, 0,                                   "rt_gbuffer_material");
-        m_render_targets[RendererRt::Gbuffer_Velocity] = make_shared<RHI_Texture2D>(m_context, width, height, RHI_Format_R16G16_Float,         1, 0,                                   "rt_gbuffer_velocity");
-        m_render_targets[RendererRt::Gbuffer_Depth]    = make_shared<RHI_Texture2D>(m_context, width, height, RHI_Format_D32_Float_S8X24_Uint, 1, RHI_Texture_DepthStencilReadOnly,    "gbuffer_depth");
+        m_render_targets[RendererRt::Gbuffer_Albedo]   = make_shared<RHI_Texture2D>(m_context, width, height, RHI_Format_R8G8B8A8_Unorm,       1, flags_async,                                     "rt_gbuffer_albedo");
+        m_render_targets[RendererRt::Gbuffer_Normal]   = make_shared<RHI_Texture2D>(m_context, width, height, RHI_Format_R16G16B16A16_Float,   1, flags_async,                                     "rt_gbuffer_normal");
+        m_render_targets[RendererRt::Gbuffer_Material] = make_shared<RHI_Texture2D>(m_context, width, height, RHI_Format_R8G8B8A8_Unorm,       1, flags_async,                                     "rt_gbuffer_material");
+        m_render_targets[RendererRt::Gbuffer_Velocity] = make_shared<RHI_Texture2D>(m_context, width, height, RHI_Format_R16G16_Float,         1, flags_async,                                     "rt_gbuffer_velocity");
+        m_render_targets[RendererRt::Gbuffer_Depth]    = make_shared<RHI_Texture2D>(m_context, width, height, RHI_Format_D32_Float_S8X24_Uint, 1, RHI_Texture_DepthStencilReadOnly | flags_async,  "gbuffer_depth");
 
-        // Light
-        m_render_targets[RendererRt::Light_Diffuse]                = make_unique<RHI_Texture2D>(m_context, width, height, RHI_Format_R11G11B10_Float, 1, 0, "rt_light_diffuse");
-        m_render_targets[RendererRt::Light_Diffuse_Transparent]    = make_unique<RHI_Texture2D>(m_context, width, height, RHI_Format_R11G11B10_Float, 1, 0, "rt_light_diffuse_transparent");
-        m_render_targets[RendererRt::Light_Specular]               = make_unique<RHI_Texture2D>(m_context, width, height, RHI_Format_R11G11B10_Float, 1, 0, "rt_light_specular");
-        m_render_targets[RendererRt::Light_Specular_Transparent]   = make_unique<RHI_Texture2D>(m_context, width, height, RHI_Format_R11G11B10_Float, 1, 0, "rt_light_specular_transparent");
-        m_render_targets[RendererRt::Light_Volumetric]             = make_unique<RHI_Texture2D>(m_context, width, height, RHI_Format_R11G11B10_Float, 1, 0, "rt_light_volumetric");
+        // Light (diffuse is read by SSGI before lighting runs, so it persists across frames)
+        m_render_targets[RendererRt::Light_Diffuse] = make_unique<RHI_Texture2D>(m_context, width, height, RHI_Format_R11G11B10_Float, 1, flags_async, "rt_light_diffuse");
 
         // BRDF Specular Lut
         m_render_targets[RendererRt::Brdf_Specular_Lut] = make_unique<RHI_Texture2D>(m_context, 400, 400, RHI_Format_R8G8_Unorm, 1, 0, "rt_brdf_specular_lut");
@@ -144,18 +193,12 @@ namespace Spartan
         m_render_targets[RendererRt::Dof_Half_2]   = make_unique<RHI_Texture2D>(m_context, width * 0.5f, height * 0.5f, RHI_Format_R16G16B16A16_Float, 1, 0, "rt_dof_half_2"); // Investigate using less bits but have an alpha channel
 
         // HBAO
-        m_render_targets[RendererRt::Ssao]          = make_unique<RHI_Texture2D>(m_context, width, height, RHI_Format_R8_Unorm, 1, 0, "rt_ssao_noisy");
+        m_render_targets[RendererRt::Ssao]          = make_unique<RHI_Texture2D>(m_context, width, height, RHI_Format_R8_Unorm, 1, flags_async, "rt_ssao_noisy");
         m_render_targets[RendererRt::Ssao_Blurred]  = make_unique<RHI_Texture2D>(m_context, width, height, RHI_Format_R8_Unorm, 1, 0, "rt_ssao");
 
-        // SSGI
-        m_render_targets[RendererRt::Ssgi] = make_unique<RHI_Texture2D>(m_context, width, height, RHI_Format_R11G11B10_Float, 1, 0, "rt_ssgi");
-
-        // SSR
-        m_render_targets[RendererRt::Ssr] = make_shared<RHI_Texture2D>(m_context, width, height, RHI_Format_R16G16B16A16_Snorm, 1, RHI_Texture_Storage, "rt_ssr");
-
         // Accumulation
         m_render_targets[RendererRt::Accumulation_Taa]  = make_unique<RHI_Texture2D>(m_context, width, height, RHI_Format_R16G16B16A16_Float, 1, 0, "rt_accumulation_taa");
-        m_render_targets[RendererRt::Accumulation_Ssgi] = make_unique<RHI_Texture2D>(m_context, width, height, RHI_Format_R11G11B10_Float, 1, 0, "rt_accumulation_ssgi");
+        m_render_targets[RendererRt::Accumulation_Ssgi] = make_unique<RHI_Texture2D>(m_context, width, height, RHI_Format_R11G11B10_Float, 1, flags_async, "rt_accumulation_ssgi");
 
         // Bloom
         {
@@ -175,6 +218,16 @@ namespace Spartan
                 );
             }
         }
+
+        // Register them, so that pipelines which use them can be pre-warmed
+        for (const auto& it : m_render_targets)
+        {
+            m_pipeline_cache->RegisterObject("rt_" + to_string(static_cast<uint32_t>(it.first)), it.second.get());
+        }
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_render_tex_bloom.size()); i++)
+        {
+            m_pipeline_cache->RegisterObject("rt_bloom_" + to_string(i), m_render_tex_bloom[i].get());
+        }
     }
 
     void Renderer::CreateShaders()
@@ -188,7 +241,22 @@ namespace Spartan
 
         // G-Buffer
         m_shaders[RendererShader::Gbuffer_V] = make_shared<RHI_Shader>(m_context);
-        m_shaders[RendererShader::Gbuffer_V]->CompileAsync<RHI_Vertex_PosTexNorTan>(RHI_Shader_Vertex, dir_shaders + "GBuffer.hlsl");
+        m_shaders[RendererShader::Gbuffer_V]->CompileAsync<RHI_Vertex_PosTexNorTan_Packed>(RHI_Shader_Vertex, dir_shaders + "GBuffer.hlsl");
+
+        // G-Buffer - GPU-driven, transforms are read from the instance buffer
+        m_shaders[RendererShader::Gbuffer_Indirect_V] = make_shared<RHI_Shader>(m_context);
+        m_shaders[RendererShader::Gbuffer_Indirect_V]->AddDefine("INDIRECT");
+        m_shaders[RendererShader::Gbuffer_Indirect_V]->CompileAsync<RHI_Vertex_PosTexNorTan_Packed>(RHI_Shader_Vertex, dir_shaders + "GBuffer.hlsl");
+
+        // G-Buffer - GPU skinning, vertices are transformed by the bones they are weighted to
+        m_shaders[RendererShader::Gbuffer_Skinned_V] = make_shared<RHI_Shader>(m_context);
+        m_shaders[RendererShader::Gbuffer_Skinned_V]->AddDefine("SKINNED");
+        m_shaders[RendererShader::Gbuffer_Skinned_V]->CompileAsync<RHI_Vertex_PosTexNorTanSkin_Packed>(RHI_Shader_Vertex, dir_shaders + "GBuffer.hlsl");
+
+        // Culling - Writes the indirect arguments of the visible instances
+        m_shaders[RendererShader::Culling_C] = make_shared<RHI_Shader>(m_context);
+        m_shaders[RendererShader::Culling_C]->AddDefine("INDIRECT");
+        m_shaders[RendererShader::Culling_C]->CompileAsync(RHI_Shader_Compute, dir_shaders + "Culling.hlsl");
 
         // Quad
         {
@@ -203,7 +271,21 @@ namespace Spartan
 
         // Depth Vertex
         m_shaders[RendererShader::Depth_V] = make_shared<RHI_Shader>(m_context);
-        m_shaders[RendererShader::Depth_V]->CompileAsync<RHI_Vertex_PosTex>(RHI_Shader_Vertex, dir_shaders + "Depth.hlsl");
+        m_shaders[RendererShader::Depth_V]->CompileAsync<RHI_Vertex_PosTexNorTan_Packed>(RHI_Shader_Vertex, dir_shaders + "Depth.hlsl");
+
+        // Depth Vertex - Reads the position stream of models
+        m_shaders[RendererShader::Depth_PositionOnly_V] = make_shared<RHI_Shader>(m_context);
+        m_shaders[RendererShader::Depth_PositionOnly_V]->AddDefine("POSITION_ONLY");
+        m_shaders[RendererShader::Depth_PositionOnly_V]->CompileAsync<RHI_Vertex_Pos_Packed>(RHI_Shader_Vertex, dir_shaders + "Depth.hlsl");
+
+        // Depth Vertex - GPU skinning
+        m_shaders[RendererShader::Depth_Skinned_V] = make_shared<RHI_Shader>(m_context);
+        m_shaders[RendererShader::Depth_Skinned_V]->AddDefine("SKINNED");
+        m_shaders[RendererShader::Depth_Skinned_V]->CompileAsync<RHI_Vertex_PosTexNorTanSkin_Packed>(RHI_Shader_Vertex, dir_shaders + "Depth.hlsl");
+        m_shaders[RendererShader::Depth_PositionOnly_Skinned_V] = make_shared<RHI_Shader>(m_context);
+        m_shaders[RendererShader::Depth_PositionOnly_Skinned_V]->AddDefine("POSITION_ONLY");
+        m_shaders[RendererShader::Depth_PositionOnly_Skinned_V]->AddDefine("SKINNED");
+        m_shaders[RendererShader::Depth_PositionOnly_Skinned_V]->CompileAsync<RHI_Vertex_PosSkin_Packed>(RHI_Shader_Vertex, dir_shaders + "Depth.hlsl");
         m_shaders[RendererShader::Depth_P] = make_shared<RHI_Shader>(m_context);
         m_shaders[RendererShader::Depth_P]->CompileAsync(RHI_Shader_Pixel, dir_shaders + "Depth.hlsl");
 
@@ -330,6 +412,9 @@ namespace Spartan
             m_shaders[RendererShader::Light_Composition_C] = make_shared<RHI_Shader>(m_context);
             m_shaders[RendererShader::Light_Composition_C]->CompileAsync(RHI_Shader_Compute, dir_shaders + "Light_Composition.hlsl");
 
+            m_shaders[RendererShader::Light_Clustered_C] = make_shared<RHI_Shader>(m_context);
+            m_shaders[RendererShader::Light_Clustered_C]->CompileAsync(RHI_Shader_Compute, dir_shaders + "Light_Clustered.hlsl");
+
             m_shaders[RendererShader::Light_ImageBased_P] = make_shared<RHI_Shader>(m_context);
             m_shaders[RendererShader::Light_ImageBased_P]->CompileAsync(RHI_Shader_Pixel, dir_shaders + "Light_ImageBased.hlsl");
         }
@@ -354,7 +439,10 @@ namespace Spartan
 
         // Entity
         m_shaders[RendererShader::Entity_V] = make_shared<RHI_Shader>(m_context);
-        m_shaders[RendererShader::Entity_V]->CompileAsync<RHI_Vertex_PosTexNorTan>(RHI_Shader_Vertex, dir_shaders + "Entity.hlsl");
+        m_shaders[RendererShader::Entity_V]->CompileAsync<RHI_Vertex_PosTexNorTan_Packed>(RHI_Shader_Vertex, dir_shaders + "Entity.hlsl");
+        m_shaders[RendererShader::Entity_Skinned_V] = make_shared<RHI_Shader>(m_context);
+        m_shaders[RendererShader::Entity_Skinned_V]->AddDefine("SKINNED");
+        m_shaders[RendererShader::Entity_Skinned_V]->CompileAsync<RHI_Vertex_PosTexNorTanSkin_Packed>(RHI_Shader_Vertex, dir_shaders + "Entity.hlsl");
 
         // Entity - Transform
         m_shaders[RendererShader::Entity_Transform_P] = make_shared<RHI_Shader>(m_context);
@@ -405,6 +493,12 @@ namespace Spartan
             m_shaders[RendererShader::DebugChannelRgbGammaCorrect_C]->AddDefine("RGB_CHANNEL_GAMMA_CORRECT");
             m_shaders[RendererShader::DebugChannelRgbGammaCorrect_C]->CompileAsync(RHI_Shader_Compute, dir_shaders + "Debug.hlsl");
         }
+
+        // Register them, so that pipelines which use them can be pre-warmed
+        for (const auto& it : m_shaders)
+        {
+            m_pipeline_cache->RegisterObject("shader_" + to_string(static_cast<uint32_t>(it.first)), it.second.get());
+        }
     }
 
     void Renderer::CreateFonts()
@@ -414,6 +508,25 @@ namespace Spartan
 
         // Load a font (used for performance metrics)
         m_font = make_unique<Font>(m_context, dir_font + "CalibriBold.ttf", 12, Vector4(0.8f, 0.8f, 0.8f, 1.0f));
+
+        // Text is batched as quads of four vertices, so the indices never change
+        vector<uint16_t> indices(font_batch_quads_per_draw * 6);
+        for (uint32_t i = 0; i < font_batch_quads_per_draw; i++)
+        {
+            const uint16_t vertex = static_cast<uint16_t>(i * 4);
+            indices[i * 6 + 0] = vertex + 0; // top left
+            indices[i * 6 + 1] = vertex + 3; // bottom right
+            indices[i * 6 + 2] = vertex + 2; // bottom left
+            indices[i * 6 + 3] = vertex + 0; // top left
+            indices[i * 6 + 4] = vertex + 1; // top right
+            indices[i * 6 + 5] = vertex + 3; // bottom right
+        }
+
+        m_font_quad_index_buffer = make_shared<RHI_IndexBuffer>(m_rhi_device);
+        if (!m_font_quad_index_buffer->Create(indices))
+        {
+            LOG_ERROR("Failed to create the font quad index buffer");
+        }
     }
 
     void Renderer::CreateTextures()
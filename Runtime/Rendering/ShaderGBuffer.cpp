@@ -19,12 +19,14 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES =========================
+//= INCLUDES ==========================
 #include "Spartan.h"
 #include "ShaderGBuffer.h"
 #include "Material.h"
+#include "Renderer.h"
 #include "../Resource/ResourceCache.h"
-//====================================
+#include "../RHI/RHI_PipelineCache.h"
+//=====================================
 
 //= NAMESPACES =====
 using namespace std;
@@ -57,15 +59,18 @@ namespace Spartan
         // Make new
         shared_ptr<ShaderGBuffer> shader = make_shared<ShaderGBuffer>(context, flags);
 
-        // Add defines based on flag properties
-        shader->AddDefine("ALBEDO_MAP",     (flags & Material_Color)      ? "1" : "0");
-        shader->AddDefine("ROUGHNESS_MAP",  (flags & Material_Roughness)  ? "1" : "0");
-        shader->AddDefine("METALLIC_MAP",   (flags & Material_Metallic)   ? "1" : "0");
-        shader->AddDefine("NORMAL_MAP",     (flags & Material_Normal)     ? "1" : "0");
-        shader->AddDefine("HEIGHT_MAP",     (flags & Material_Height)     ? "1" : "0");
-        shader->AddDefine("OCCLUSION_MAP",  (flags & Material_Occlusion)  ? "1" : "0");
-        shader->AddDefine("EMISSION_MAP",   (flags & Material_Emission)   ? "1" : "0");
-        shader->AddDefine("MASK_MAP",       (flags & Material_Mask)       ? "1" : "0");
+        // Add defines based on flag properties (the bindless variation checks which textures a material has at runtime)
+        const bool bindless = flags & flag_bindless;
+        shader->AddDefine("ALBEDO_MAP",     (bindless || (flags & Material_Color))      ? "1" : "0");
+        shader->AddDefine("ROUGHNESS_MAP",  (bindless || (flags & Material_Roughness))  ? "1" : "0");
+        shader->AddDefine("METALLIC_MAP",   (bindless || (flags & Material_Metallic))   ? "1" : "0");
+        shader->AddDefine("NORMAL_MAP",     (bindless || (flags & Material_Normal))     ? "1" : "0");
+        shader->AddDefine("HEIGHT_MAP",     (bindless || (flags & Material_Height))     ? "1" : "0");
+        shader->AddDefine("OCCLUSION_MAP",  (bindless || (flags & Material_Occlusion))  ? "1" : "0");
+        shader->AddDefine("EMISSION_MAP",   (bindless || (flags & Material_Emission))   ? "1" : "0");
+        shader->AddDefine("MASK_MAP",       (bindless || (flags & Material_Mask))       ? "1" : "0");
+        shader->AddDefine("BINDLESS",       bindless                                    ? "1" : "0");
+        shader->AddDefine("INDIRECT",       (flags & flag_indirect)                     ? "1" : "0");
 
         // Compile
         shader->CompileAsync(RHI_Shader_Pixel, file_path);
@@ -73,6 +78,12 @@ namespace Spartan
         // Save
         m_variations[flags] = shader;
 
+        // Register it, so that pipelines which use it can be pre-warmed
+        if (RHI_PipelineCache* pipeline_cache = context->GetSubsystem<Renderer>()->GetPipelineCache())
+        {
+            pipeline_cache->RegisterObject("shader_gbuffer_p_" + to_string(flags), shader.get());
+        }
+
         return shader.get();
     }
 }
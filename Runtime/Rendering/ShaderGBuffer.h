@@ -40,6 +40,12 @@ namespace Spartan
         static const ShaderGBuffer* GenerateVariation(Context* context, const uint16_t flags);
         static const auto& GetVariations() { return m_variations; }
 
+        // A single variation which reads all materials from the bindless table
+        static const uint16_t flag_bindless = 1 << 15;
+
+        // Reads the material indices from the vertex shader instead of the uber buffer (GPU-driven drawing, requires bindless)
+        static const uint16_t flag_indirect = 1 << 14;
+
     private:
         static ShaderGBuffer* Compile(Context* context, const uint16_t flags);
 
@@ -0,0 +1,88 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =================
+#include "Spartan.h"
+#include "Skeleton.h"
+#include "../IO/FileStream.h"
+//============================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    int32_t Skeleton::AddBone(const Bone& bone)
+    {
+        if (m_bones.size() >= bone_count_max)
+        {
+            LOG_ERROR("Bone \"%s\" exceeds the limit of %u bones", bone.name.c_str(), bone_count_max);
+            return -1;
+        }
+
+        if (bone.parent >= static_cast<int32_t>(m_bones.size()))
+        {
+            LOG_ERROR("The parent of bone \"%s\" has to be added first", bone.name.c_str());
+            return -1;
+        }
+
+        m_bones.emplace_back(bone);
+        return static_cast<int32_t>(m_bones.size()) - 1;
+    }
+
+    int32_t Skeleton::FindBone(const string& name) const
+    {
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_bones.size()); i++)
+        {
+            if (m_bones[i].name == name)
+                return static_cast<int32_t>(i);
+        }
+
+        return -1;
+    }
+
+    void Skeleton::Serialize(FileStream* stream) const
+    {
+        stream->Write(static_cast<uint32_t>(m_bones.size()));
+        for (const Bone& bone : m_bones)
+        {
+            stream->Write(bone.name);
+            stream->Write(bone.parent);
+            stream->Write(bone.position);
+            stream->Write(bone.rotation);
+            stream->Write(bone.scale);
+        }
+    }
+
+    void Skeleton::Deserialize(FileStream* stream)
+    {
+        m_bones.resize(stream->ReadAs<uint32_t>());
+        for (Bone& bone : m_bones)
+        {
+            stream->Read(&bone.name);
+            stream->Read(&bone.parent);
+            stream->Read(&bone.position);
+            stream->Read(&bone.rotation);
+            stream->Read(&bone.scale);
+        }
+    }
+}
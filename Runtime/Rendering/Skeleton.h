@@ -0,0 +1,76 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ============================
+#include <vector>
+#include <string>
+#include "../Core/Spartan_Definitions.h"
+#include "../Math/Vector3.h"
+#include "../Math/Quaternion.h"
+//=======================================
+
+namespace Spartan
+{
+    class FileStream;
+
+    // A node of the skeleton, its bind pose is relative to its parent
+    struct Bone
+    {
+        std::string name;
+        int32_t parent              = -1; // parents always come before their children
+        Math::Vector3 position      = Math::Vector3::Zero;
+        Math::Quaternion rotation   = Math::Quaternion::Identity;
+        Math::Vector3 scale         = Math::Vector3::One;
+    };
+
+    // The four most influential bones of a vertex, the weights are normalised to add up to 255
+    struct BoneWeights
+    {
+        uint8_t bones[4]    = { 0, 0, 0, 0 };
+        uint8_t weights[4]  = { 0, 0, 0, 0 };
+    };
+
+    class SPARTAN_CLASS Skeleton
+    {
+    public:
+        // Bones are referenced by 8-bit indices
+        static constexpr uint32_t bone_count_max = 256;
+
+        Skeleton() = default;
+        ~Skeleton() = default;
+
+        // Returns the index of the bone, or -1 if the skeleton is full (or the parent doesn't precede it)
+        int32_t AddBone(const Bone& bone);
+        int32_t FindBone(const std::string& name) const;
+        const std::vector<Bone>& GetBones() const   { return m_bones; }
+        uint32_t GetBoneCount()             const   { return static_cast<uint32_t>(m_bones.size()); }
+        bool IsEmpty()                      const   { return m_bones.empty(); }
+        void Clear()                                { m_bones.clear(); }
+
+        void Serialize(FileStream* stream) const;
+        void Deserialize(FileStream* stream);
+
+    private:
+        std::vector<Bone> m_bones;
+    };
+}
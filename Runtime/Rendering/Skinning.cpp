@@ -0,0 +1,380 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==================
+#include "Spartan.h"
+#include "Skinning.h"
+#include "Skeleton.h"
+#include "Animation.h"
+#include "../RHI/RHI_Vertex.h"
+#include <emmintrin.h>
+//=============================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan::Skinning
+{
+    static BoneMatrix to_bone_matrix(const BoneTransform& transform)
+    {
+        const Quaternion& q = transform.rotation;
+        const Vector3& s    = transform.scale;
+        const Vector3& t    = transform.position;
+
+        const float xx = q.x * q.x; const float yy = q.y * q.y; const float zz = q.z * q.z;
+        const float xy = q.x * q.y; const float xz = q.x * q.z; const float yz = q.y * q.z;
+        const float wx = q.w * q.x; const float wy = q.w * q.y; const float wz = q.w * q.z;
+
+        // Same as Matrix(position, rotation, scale)
+        BoneMatrix matrix;
+        matrix.rows[0][0] = s.x * (1.0f - 2.0f * (yy + zz)); matrix.rows[0][1] = s.x * 2.0f * (xy + wz);          matrix.rows[0][2] = s.x * 2.0f * (xz - wy);          matrix.rows[0][3] = 0.0f;
+        matrix.rows[1][0] = s.y * 2.0f * (xy - wz);          matrix.rows[1][1] = s.y * (1.0f - 2.0f * (zz + xx)); matrix.rows[1][2] = s.y * 2.0f * (yz + wx);          matrix.rows[1][3] = 0.0f;
+        matrix.rows[2][0] = s.z * 2.0f * (xz + wy);          matrix.rows[2][1] = s.z * 2.0f * (yz - wx);          matrix.rows[2][2] = s.z * (1.0f - 2.0f * (yy + xx)); matrix.rows[2][3] = 0.0f;
+        matrix.rows[3][0] = t.x;                             matrix.rows[3][1] = t.y;                             matrix.rows[3][2] = t.z;                             matrix.rows[3][3] = 1.0f;
+        return matrix;
+    }
+
+    // a then b
+    static void multiply(const BoneMatrix& a, const BoneMatrix& b, BoneMatrix* result)
+    {
+        const __m128 b0 = _mm_load_ps(b.rows[0]);
+        const __m128 b1 = _mm_load_ps(b.rows[1]);
+        const __m128 b2 = _mm_load_ps(b.rows[2]);
+        const __m128 b3 = _mm_load_ps(b.rows[3]);
+
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            __m128 row = _mm_mul_ps(_mm_set1_ps(a.rows[i][0]), b0);
+            row        = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.rows[i][1]), b1));
+            row        = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.rows[i][2]), b2));
+            row        = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.rows[i][3]), b3));
+            _mm_store_ps(result->rows[i], row);
+        }
+    }
+
+    // Index of the last key at or before the time
+    template<typename T>
+    static uint32_t find_key(const vector<T>& keys, const double time)
+    {
+        const auto it = upper_bound(keys.begin(), keys.end(), time, [](const double time, const T& key) { return time < key.time; });
+        return it == keys.begin() ? 0 : static_cast<uint32_t>(it - keys.begin()) - 1;
+    }
+
+    template<typename T>
+    static float key_fraction(const vector<T>& keys, const uint32_t index, const double time)
+    {
+        if (index + 1 >= keys.size())
+            return 0.0f;
+
+        const double span = keys[index + 1].time - keys[index].time;
+        return span > 0.0 ? static_cast<float>(Helper::Clamp((time - keys[index].time) / span, 0.0, 1.0)) : 0.0f;
+    }
+
+    static Vector3 lerp(const Vector3& a, const Vector3& b, const float t)
+    {
+        return a + (b - a) * t;
+    }
+
+    Quaternion nlerp(const Quaternion& a, const Quaternion& b, const float t)
+    {
+        const float dot  = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+        const float sign = dot < 0.0f ? -1.0f : 1.0f;
+
+        Quaternion result(
+            a.x + (b.x * sign - a.x) * t,
+            a.y + (b.y * sign - a.y) * t,
+            a.z + (b.z * sign - a.z) * t,
+            a.w + (b.w * sign - a.w) * t
+        );
+        result.Normalize();
+        return result;
+    }
+
+    template<typename T, typename F>
+    static auto sample_keys(const vector<T>& keys, const double time, F interpolate)
+    {
+        const uint32_t index = find_key(keys, time);
+        const float fraction = key_fraction(keys, index, time);
+        return fraction > 0.0f ? interpolate(keys[index].value, keys[index + 1].value, fraction) : keys[index].value;
+    }
+
+    BoneMatrix to_bone_matrix(const Matrix& matrix)
+    {
+        BoneMatrix result;
+        result.rows[0][0] = matrix.m00; result.rows[0][1] = matrix.m01; result.rows[0][2] = matrix.m02; result.rows[0][3] = 0.0f;
+        result.rows[1][0] = matrix.m10; result.rows[1][1] = matrix.m11; result.rows[1][2] = matrix.m12; result.rows[1][3] = 0.0f;
+        result.rows[2][0] = matrix.m20; result.rows[2][1] = matrix.m21; result.rows[2][2] = matrix.m22; result.rows[2][3] = 0.0f;
+        result.rows[3][0] = matrix.m30; result.rows[3][1] = matrix.m31; result.rows[3][2] = matrix.m32; result.rows[3][3] = 1.0f;
+        return result;
+    }
+
+    void pose_bind(const Skeleton& skeleton, BoneTransform* pose)
+    {
+        const vector<Bone>& bones = skeleton.GetBones();
+        for (uint32_t i = 0; i < static_cast<uint32_t>(bones.size()); i++)
+        {
+            pose[i].position = bones[i].position;
+            pose[i].rotation = bones[i].rotation;
+            pose[i].scale    = bones[i].scale;
+        }
+    }
+
+    void sample(const Animation& animation, const double time_sec, BoneTransform* pose, const uint32_t bone_count)
+    {
+        const double time = time_sec * animation.GetTicksPerSec();
+
+        for (const AnimationNode& channel : animation.GetChannels())
+        {
+            if (channel.bone < 0 || static_cast<uint32_t>(channel.bone) >= bone_count)
+                continue;
+
+            BoneTransform& bone = pose[channel.bone];
+
+            if (!channel.positionFrames.empty())
+            {
+                bone.position = sample_keys(channel.positionFrames, time, lerp);
+            }
+
+            if (!channel.rotationFrames.empty())
+            {
+                bone.rotation = sample_keys(channel.rotationFrames, time, nlerp);
+            }
+
+            if (!channel.scaleFrames.empty())
+            {
+                bone.scale = sample_keys(channel.scaleFrames, time, lerp);
+            }
+        }
+    }
+
+    void sample(const Animation& animation, AnimationCompression::Cursor* cursor, const double time_sec, BoneTransform* pose, const uint32_t bone_count)
+    {
+        if (animation.IsCompressed())
+        {
+            AnimationCompression::sample(animation.GetClip(), cursor, static_cast<float>(time_sec), pose, bone_count);
+            return;
+        }
+
+        sample(animation, time_sec, pose, bone_count);
+    }
+
+    void blend(BoneTransform* pose, const BoneTransform* other, const uint32_t bone_count, const float weight)
+    {
+        for (uint32_t i = 0; i < bone_count; i++)
+        {
+            pose[i].position = lerp(pose[i].position, other[i].position, weight);
+            pose[i].rotation = nlerp(pose[i].rotation, other[i].rotation, weight);
+            pose[i].scale    = lerp(pose[i].scale, other[i].scale, weight);
+        }
+    }
+
+    void compute_palette(const Skeleton& skeleton, const BoneTransform* pose, const BoneMatrix* offsets, const BoneMatrix& root_to_mesh, BoneMatrix* globals, BoneMatrix* palette)
+    {
+        const vector<Bone>& bones = skeleton.GetBones();
+        const uint32_t bone_count = static_cast<uint32_t>(bones.size());
+
+        // Parents come first, so their model space transform is always ready
+        for (uint32_t i = 0; i < bone_count; i++)
+        {
+            const BoneMatrix local = to_bone_matrix(pose[i]);
+
+            if (bones[i].parent < 0)
+            {
+                globals[i] = local;
+            }
+            else
+            {
+                multiply(local, globals[bones[i].parent], &globals[i]);
+            }
+        }
+
+        for (uint32_t i = 0; i < bone_count; i++)
+        {
+            BoneMatrix offset_global;
+            multiply(offsets[i], globals[i], &offset_global);
+            multiply(offset_global, root_to_mesh, &palette[i]);
+        }
+    }
+
+    static inline __m128 normalize3(const __m128 v)
+    {
+        // x*x + y*y + z*z in every lane
+        const __m128 squares = _mm_mul_ps(v, v);
+        __m128 dot           = _mm_add_ps(squares, _mm_shuffle_ps(squares, squares, _MM_SHUFFLE(3, 0, 2, 1)));
+        dot                  = _mm_add_ps(dot, _mm_shuffle_ps(squares, squares, _MM_SHUFFLE(3, 1, 0, 2)));
+        dot                  = _mm_max_ps(dot, _mm_set1_ps(1e-12f));
+        return _mm_div_ps(v, _mm_sqrt_ps(dot));
+    }
+
+    static inline void store3(const __m128 v, float* destination)
+    {
+        alignas(16) float values[4];
+        _mm_store_ps(values, v);
+        destination[0] = values[0];
+        destination[1] = values[1];
+        destination[2] = values[2];
+    }
+
+    void skin(
+        const RHI_Vertex_PosTexNorTan* vertices,
+        const BoneWeights* weights,
+        const uint32_t vertex_count,
+        const BoneMatrix* palette,
+        RHI_Vertex_PosTexNorTan* vertices_out,
+        Vector3* bounds_min,
+        Vector3* bounds_max
+    )
+    {
+        const __m128 weight_scale = _mm_set1_ps(1.0f / 255.0f);
+        __m128 position_min       = _mm_set1_ps(numeric_limits<float>::max());
+        __m128 position_max       = _mm_set1_ps(-numeric_limits<float>::max());
+
+        for (uint32_t i = 0; i < vertex_count; i++)
+        {
+            const RHI_Vertex_PosTexNorTan& vertex = vertices[i];
+            const BoneWeights& influence          = weights[i];
+
+            // Blend the matrices of the bones which influence the vertex
+            __m128 r0 = _mm_setzero_ps();
+            __m128 r1 = _mm_setzero_ps();
+            __m128 r2 = _mm_setzero_ps();
+            __m128 r3 = _mm_setzero_ps();
+            for (uint32_t j = 0; j < 4; j++)
+            {
+                if (influence.weights[j] == 0)
+                    continue;
+
+                const BoneMatrix& bone = palette[influence.bones[j]];
+                const __m128 weight    = _mm_mul_ps(_mm_set1_ps(static_cast<float>(influence.weights[j])), weight_scale);
+                r0 = _mm_add_ps(r0, _mm_mul_ps(_mm_load_ps(bone.rows[0]), weight));
+                r1 = _mm_add_ps(r1, _mm_mul_ps(_mm_load_ps(bone.rows[1]), weight));
+                r2 = _mm_add_ps(r2, _mm_mul_ps(_mm_load_ps(bone.rows[2]), weight));
+                r3 = _mm_add_ps(r3, _mm_mul_ps(_mm_load_ps(bone.rows[3]), weight));
+            }
+
+            // Position
+            __m128 position = _mm_mul_ps(_mm_set1_ps(vertex.pos[0]), r0);
+            position        = _mm_add_ps(position, _mm_mul_ps(_mm_set1_ps(vertex.pos[1]), r1));
+            position        = _mm_add_ps(position, _mm_mul_ps(_mm_set1_ps(vertex.pos[2]), r2));
+            position        = _mm_add_ps(position, r3);
+            position_min    = _mm_min_ps(position_min, position);
+            position_max    = _mm_max_ps(position_max, position);
+
+            // Normal
+            __m128 normal = _mm_mul_ps(_mm_set1_ps(vertex.nor[0]), r0);
+            normal        = _mm_add_ps(normal, _mm_mul_ps(_mm_set1_ps(vertex.nor[1]), r1));
+            normal        = _mm_add_ps(normal, _mm_mul_ps(_mm_set1_ps(vertex.nor[2]), r2));
+
+            // Tangent
+            __m128 tangent = _mm_mul_ps(_mm_set1_ps(vertex.tan[0]), r0);
+            tangent        = _mm_add_ps(tangent, _mm_mul_ps(_mm_set1_ps(vertex.tan[1]), r1));
+            tangent        = _mm_add_ps(tangent, _mm_mul_ps(_mm_set1_ps(vertex.tan[2]), r2));
+
+            RHI_Vertex_PosTexNorTan& vertex_out = vertices_out[i];
+            store3(position, vertex_out.pos);
+            store3(normalize3(normal), vertex_out.nor);
+            store3(normalize3(tangent), vertex_out.tan);
+            vertex_out.tex[0] = vertex.tex[0];
+            vertex_out.tex[1] = vertex.tex[1];
+        }
+
+        alignas(16) float values[4];
+        _mm_store_ps(values, position_min);
+        *bounds_min = Vector3(values[0], values[1], values[2]);
+        _mm_store_ps(values, position_max);
+        *bounds_max = Vector3(values[0], values[1], values[2]);
+    }
+
+    void compute_bone_bounds(const RHI_Vertex_PosTexNorTan* vertices, const BoneWeights* weights, const uint32_t vertex_count, const uint32_t bone_count, BoundingBox* bone_bounds)
+    {
+        vector<Vector3> bounds_min(bone_count, Vector3::Infinity);
+        vector<Vector3> bounds_max(bone_count, Vector3::InfinityNeg);
+
+        for (uint32_t i = 0; i < vertex_count; i++)
+        {
+            const Vector3 position(vertices[i].pos[0], vertices[i].pos[1], vertices[i].pos[2]);
+            for (uint32_t j = 0; j < 4; j++)
+            {
+                const uint32_t bone = weights[i].bones[j];
+                if (weights[i].weights[j] == 0 || bone >= bone_count)
+                    continue;
+
+                Vector3& bone_min = bounds_min[bone];
+                Vector3& bone_max = bounds_max[bone];
+                bone_min = Vector3(Helper::Min(bone_min.x, position.x), Helper::Min(bone_min.y, position.y), Helper::Min(bone_min.z, position.z));
+                bone_max = Vector3(Helper::Max(bone_max.x, position.x), Helper::Max(bone_max.y, position.y), Helper::Max(bone_max.z, position.z));
+            }
+        }
+
+        for (uint32_t i = 0; i < bone_count; i++)
+        {
+            bone_bounds[i] = bounds_min[i].x <= bounds_max[i].x ? BoundingBox(bounds_min[i], bounds_max[i]) : BoundingBox();
+        }
+    }
+
+    void compute_pose_bounds(const BoneMatrix* palette, const BoundingBox* bone_bounds, const uint32_t bone_count, Vector3* bounds_min, Vector3* bounds_max)
+    {
+        float pose_min[3] = { numeric_limits<float>::max(), numeric_limits<float>::max(), numeric_limits<float>::max() };
+        float pose_max[3] = { -numeric_limits<float>::max(), -numeric_limits<float>::max(), -numeric_limits<float>::max() };
+
+        for (uint32_t i = 0; i < bone_count; i++)
+        {
+            const BoundingBox& bounds = bone_bounds[i];
+            if (!bounds.Defined())
+                continue;
+
+            // The transformed box is the center transformed, plus the extents along every axis of the matrix
+            const BoneMatrix& m     = palette[i];
+            const Vector3 center    = bounds.GetCenter();
+            const Vector3 extents   = bounds.GetExtents();
+            for (uint32_t axis = 0; axis < 3; axis++)
+            {
+                const float c = center.x * m.rows[0][axis] + center.y * m.rows[1][axis] + center.z * m.rows[2][axis] + m.rows[3][axis];
+                const float e = extents.x * Helper::Abs(m.rows[0][axis]) + extents.y * Helper::Abs(m.rows[1][axis]) + extents.z * Helper::Abs(m.rows[2][axis]);
+                pose_min[axis] = Helper::Min(pose_min[axis], c - e);
+                pose_max[axis] = Helper::Max(pose_max[axis], c + e);
+            }
+        }
+
+        *bounds_min = Vector3(pose_min[0], pose_min[1], pose_min[2]);
+        *bounds_max = Vector3(pose_max[0], pose_max[1], pose_max[2]);
+    }
+
+    void compute_palette_gpu(const BoneMatrix* palette, const uint32_t bone_count, const Matrix& vertex_transform, Matrix* palette_gpu)
+    {
+        const BoneMatrix transform = to_bone_matrix(vertex_transform);
+
+        for (uint32_t i = 0; i < bone_count; i++)
+        {
+            BoneMatrix bone;
+            multiply(transform, palette[i], &bone);
+
+            palette_gpu[i] = Matrix(
+                bone.rows[0][0], bone.rows[0][1], bone.rows[0][2], bone.rows[0][3],
+                bone.rows[1][0], bone.rows[1][1], bone.rows[1][2], bone.rows[1][3],
+                bone.rows[2][0], bone.rows[2][1], bone.rows[2][2], bone.rows[2][3],
+                bone.rows[3][0], bone.rows[3][1], bone.rows[3][2], bone.rows[3][3]
+            );
+        }
+    }
+}
@@ -0,0 +1,92 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ============================
+#include "../Core/Spartan_Definitions.h"
+#include "../RHI/RHI_Definition.h"
+#include "../Math/Matrix.h"
+#include "../Math/BoundingBox.h"
+#include "AnimationCompression.h"
+//=======================================
+
+namespace Spartan
+{
+    class Animation;
+    class Skeleton;
+    struct BoneWeights;
+}
+
+namespace Spartan::Skinning
+{
+    // A bone relative to its parent, this is what animations are sampled and blended as
+    struct BoneTransform
+    {
+        Math::Vector3 position      = Math::Vector3::Zero;
+        Math::Quaternion rotation   = Math::Quaternion::Identity;
+        Math::Vector3 scale         = Math::Vector3::One;
+    };
+
+    // An affine transform as four rows for SSE, a point is transformed as x * row0 + y * row1 + z * row2 + row3
+    struct alignas(16) BoneMatrix
+    {
+        float rows[4][4];
+    };
+
+    BoneMatrix to_bone_matrix(const Math::Matrix& matrix);
+
+    // Resets the pose to the bind pose of the skeleton
+    void pose_bind(const Skeleton& skeleton, BoneTransform* pose);
+
+    // Samples the channels (or the compressed clip) of an animation at a time in seconds, bones the animation doesn't have a channel for are left untouched
+    void sample(const Animation& animation, double time_sec, BoneTransform* pose, uint32_t bone_count);
+    void sample(const Animation& animation, AnimationCompression::Cursor* cursor, double time_sec, BoneTransform* pose, uint32_t bone_count);
+
+    // Normalised lerp along the shortest arc, close enough to a slerp for the small steps between keys
+    Math::Quaternion nlerp(const Math::Quaternion& a, const Math::Quaternion& b, float t);
+
+    // Blends a pose towards another one, a weight of 0 keeps the pose and a weight of 1 replaces it
+    void blend(BoneTransform* pose, const BoneTransform* other, uint32_t bone_count, float weight);
+
+    // Skinning matrices, each one is offset (mesh to bone space) * model space bone * root_to_mesh (skeleton root to mesh space).
+    // The globals are scratch memory for the model space bones, one per bone.
+    void compute_palette(const Skeleton& skeleton, const BoneTransform* pose, const BoneMatrix* offsets, const BoneMatrix& root_to_mesh, BoneMatrix* globals, BoneMatrix* palette);
+
+    // Transforms vertices by the weighted sum of their bone matrices, normals and tangents are renormalised. The bounds of the output positions are returned.
+    void skin(
+        const RHI_Vertex_PosTexNorTan* vertices,
+        const BoneWeights* weights,
+        uint32_t vertex_count,
+        const BoneMatrix* palette,
+        RHI_Vertex_PosTexNorTan* vertices_out,
+        Math::Vector3* bounds_min,
+        Math::Vector3* bounds_max
+    );
+
+    // The bind pose bounds of the vertices each bone influences (undefined for bones without any), the skinned vertices always
+    // lie within those bounds transformed by the matrices of their bones, so bounding a pose doesn't require skinning it.
+    void compute_bone_bounds(const RHI_Vertex_PosTexNorTan* vertices, const BoneWeights* weights, uint32_t vertex_count, uint32_t bone_count, Math::BoundingBox* bone_bounds);
+    void compute_pose_bounds(const BoneMatrix* palette, const Math::BoundingBox* bone_bounds, uint32_t bone_count, Math::Vector3* bounds_min, Math::Vector3* bounds_max);
+
+    // The palette as the vertex shaders read it, the vertex transform (packed positions to mesh space) is folded into every bone
+    void compute_palette_gpu(const BoneMatrix* palette, uint32_t bone_count, const Math::Matrix& vertex_transform, Math::Matrix* palette_gpu);
+}
@@ -19,12 +19,13 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES =========================
+//= INCLUDES ==========================
 #include "Spartan.h"
 #include "FontImporter.h"
 #include "../../RHI/RHI_Texture2D.h"
 #include "../../Rendering/Font/Font.h"
-//====================================
+#include "../../Threading/Threading.h"
+//=====================================
 
 //= NAMESPACES ===============
 using namespace std;
@@ -33,12 +34,13 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
-    // Properties of the texture font atlas which holds all visible ASCII characters
-    static const uint32_t GLYPH_START    = 32;
-    static const uint32_t GLYPH_END        = 127;
-    static const uint32_t ATLAS_WIDTH    = 512;
+    // Glyphs which are loaded up front, all visible ASCII characters
+    static const uint32_t GLYPH_START       = 32;
+    static const uint32_t GLYPH_END         = 127;
 
-    static FT_UInt32 g_glyph_load_flags = 0;
+    // The atlas grows in height as glyphs are added
+    static const uint32_t ATLAS_WIDTH       = 512;
+    static const uint32_t ATLAS_HEIGHT_MAX  = 4096;
 
     // FreeType questionable design, but it's free, so we just write this namespace and forget about it
     namespace ft_helper
@@ -198,177 +200,123 @@ namespace Spartan
             return flags;
         }
 
-        inline bool load_glyph(const FT_Face& face, const uint32_t char_code, const uint32_t flags = g_glyph_load_flags)
+        inline bool load_glyph(const FT_Face& face, const uint32_t char_code, const uint32_t flags)
         {
             return ft_helper::handle_error(FT_Load_Char(face, char_code, flags));
         }
+    }
+
+    // Signed distance fields, computed from the coverage of the glyph so that the edge is placed with sub-pixel precision
+    namespace sdf
+    {
+        static const float infinity = 1e20f;
 
-        inline void get_character_max_dimensions(uint32_t* max_width, uint32_t* max_height, FT_Face& face, const uint32_t outline_size)
+        // Squared euclidean distance transform along one dimension (Felzenszwalb & Huttenlocher)
+        static void distance_transform_1d(float* grid, const uint32_t offset, const uint32_t stride, const uint32_t length, float* f, float* z, uint32_t* v)
         {
-            uint32_t width  = 0;
-            uint32_t height = 0;
+            for (uint32_t i = 0; i < length; i++)
+            {
+                f[i] = grid[offset + i * stride];
+            }
+
+            uint32_t k = 0;
+            v[0]       = 0;
+            z[0]       = -infinity;
+            z[1]       = infinity;
 
-            for (uint32_t char_code = GLYPH_START; char_code < GLYPH_END; char_code++)
+            auto intersection = [f](const uint32_t q, const uint32_t r)
             {
-                if (!load_glyph(face, char_code))
-                    continue;
+                return (f[q] - f[r] + static_cast<float>(q * q) - static_cast<float>(r * r)) / static_cast<float>(2 * q - 2 * r);
+            };
 
-                FT_Bitmap* bitmap   = &face->glyph->bitmap;
-                width               = Helper::Max<uint32_t>(width,  bitmap->width);
-                height                = Helper::Max<uint32_t>(height, bitmap->rows);
+            for (uint32_t q = 1; q < length; q++)
+            {
+                // z[0] is -infinity, so k never goes below zero
+                float s = intersection(q, v[k]);
+                while (s <= z[k])
+                {
+                    k--;
+                    s = intersection(q, v[k]);
+                }
+
+                k++;
+                v[k]     = q;
+                z[k]     = s;
+                z[k + 1] = infinity;
             }
 
-            *max_width  = width  + outline_size * 2;
-            *max_height = height + outline_size * 2;
-        }
+            k = 0;
+            for (uint32_t q = 0; q < length; q++)
+            {
+                while (z[k + 1] < static_cast<float>(q))
+                {
+                    k++;
+                }
 
-        inline void get_texture_atlas_dimensions(uint32_t* atlas_width, uint32_t* atlas_height, uint32_t* atlas_cell_width, uint32_t* atlas_cell_height, FT_Face& face, const uint32_t outline_size)
-        {
-            uint32_t max_width  = 0;
-            uint32_t max_height = 0;
-            get_character_max_dimensions(&max_width, &max_height, face, outline_size);
-
-            const uint32_t glyph_count    = GLYPH_END - GLYPH_START;
-            const uint32_t glyphs_per_row = ATLAS_WIDTH / max_width;
-            const uint32_t row_count      = static_cast<uint32_t>(Helper::Ceil(float(glyph_count) / float(glyphs_per_row)));
-
-            *atlas_width        = ATLAS_WIDTH;
-            *atlas_height       = max_height * row_count;
-            *atlas_cell_width   = max_width;
-            *atlas_cell_height  = max_height;
+                const float distance          = static_cast<float>(q) - static_cast<float>(v[k]);
+                grid[offset + q * stride]     = distance * distance + f[v[k]];
+            }
         }
 
-        inline void get_bitmap(ft_bitmap* bitmap, const Font* font, const FT_Stroker& stroker, FT_Face& ft_font, const uint32_t char_code)
+        static void distance_transform_2d(vector<float>& grid, const uint32_t width, const uint32_t height)
         {
-            // Load glyph
-            if (!load_glyph(ft_font, char_code, stroker ? FT_LOAD_NO_BITMAP : g_glyph_load_flags))
-                return;
-
-            FT_Bitmap* bitmap_temp = nullptr; // will deallocate it's buffer the moment will load another glyph
+            const uint32_t length = Helper::Max(width, height);
+            vector<float> f(length);
+            vector<float> z(length + 1);
+            vector<uint32_t> v(length);
 
-            // Get bitmap
-            if (!stroker)
+            for (uint32_t x = 0; x < width; x++)
             {
-                bitmap_temp = &ft_font->glyph->bitmap;
-            }
-            else
-            {
-                if (ft_font->glyph->format == FT_GLYPH_FORMAT_OUTLINE)
-                {
-                    FT_Glyph glyph;
-                    if (handle_error(FT_Get_Glyph(ft_font->glyph, &glyph)))
-                    {
-                        bool stroked = false;
-
-                        if (font->GetOutline() == Font_Outline_Edge)
-                        {
-                            stroked = handle_error(FT_Glyph_Stroke(&glyph, stroker, true));
-                        }
-                        else if (font->GetOutline() == Font_Outline_Positive)
-                        {
-                            stroked = handle_error(FT_Glyph_StrokeBorder(&glyph, stroker, false, true));
-                        }
-                        else if (font->GetOutline() == Font_Outline_Negative)
-                        {
-                            stroked = handle_error(FT_Glyph_StrokeBorder(&glyph, stroker, true, true));
-                        }
-
-                        if (stroked)
-                        {
-                            if (handle_error(FT_Glyph_To_Bitmap(&glyph, FT_RENDER_MODE_NORMAL, nullptr, true)))
-                            {
-                                bitmap_temp = &reinterpret_cast<FT_BitmapGlyph>(glyph)->bitmap;
-                            }
-                        }
-                    }
-                }
-                else
-                {
-                    LOG_ERROR("Can't apply outline as the glyph doesn't have an outline format");
-                    bitmap_temp = &ft_font->glyph->bitmap;
-                }
+                distance_transform_1d(grid.data(), x, width, height, f.data(), z.data(), v.data());
             }
 
-            // Copy bitmap
-            if (bitmap_temp && bitmap_temp->buffer)
-            { 
-                bitmap->width        = bitmap_temp->width;
-                bitmap->height       = bitmap_temp->rows;
-                bitmap->pixel_mode   = bitmap_temp->pixel_mode;
-                bitmap->buffer       = new unsigned char[bitmap->width * bitmap->height];
-                memcpy(bitmap->buffer, bitmap_temp->buffer, bitmap->width * bitmap->height);
+            for (uint32_t y = 0; y < height; y++)
+            {
+                distance_transform_1d(grid.data(), y * width, 1, width, f.data(), z.data(), v.data());
             }
         }
 
-        inline void copy_to_atlas(vector<std::byte>& atlas, const ft_bitmap& bitmap, const Vector2& pen, const uint32_t atlas_width, const uint32_t outline_size)
+        // Converts a coverage bitmap to a distance field with a border of font_sdf_spread pixels, 0.5 is the edge and 0 or 1 are a spread away from it
+        static void generate(const vector<unsigned char>& coverage, const uint32_t width, const uint32_t height, vector<std::byte>* distance_field)
         {
-            for (uint32_t glyph_y = 0; glyph_y < bitmap.height; glyph_y++)
+            const uint32_t sdf_width    = width + font_sdf_spread * 2;
+            const uint32_t sdf_height   = height + font_sdf_spread * 2;
+            const uint32_t pixel_count  = sdf_width * sdf_height;
+
+            // Outside distances are measured to the glyph, inside distances to the background
+            vector<float> outside(pixel_count, infinity);
+            vector<float> inside(pixel_count, 0.0f);
+            for (uint32_t y = 0; y < height; y++)
             {
-                for (uint32_t glyph_x = 0; glyph_x < bitmap.width; glyph_x++)
+                for (uint32_t x = 0; x < width; x++)
                 {
-                    // Compute 
-                    uint32_t atlas_x = static_cast<uint32_t>(pen.x + glyph_x);
-                    uint32_t atlas_y = static_cast<uint32_t>(pen.y + glyph_y);
-
-                    // In case there is an outline, the text has to offset away from the outline's edge
-                    atlas_x += outline_size;
-                    atlas_y += outline_size;
-
-                    // Ensure we are not doing any wrong math
-                    const uint32_t atlas_pos = atlas_x + atlas_y * atlas_width;
-                    SP_ASSERT(atlas.size() > atlas_pos);
+                    const float alpha    = coverage[x + y * width] / 255.0f;
+                    const uint32_t index = (x + font_sdf_spread) + (y + font_sdf_spread) * sdf_width;
 
-                    switch (bitmap.pixel_mode)
+                    if (alpha >= 1.0f)
                     {
-                    case FT_PIXEL_MODE_MONO: {
-                        // implement if it's ever needed
-                    } break;
-
-                    case FT_PIXEL_MODE_GRAY: {
-                        atlas[atlas_pos] = static_cast<std::byte>(bitmap.buffer[glyph_x + glyph_y * bitmap.width]);
-                    } break;
-
-                    case FT_PIXEL_MODE_BGRA: {
-                        // implement if it's ever needed
-                    } break;
-
-                    default:
-                        LOG_ERROR("Font uses unsupported pixel format");
-                        break;
+                        outside[index]  = 0.0f;
+                        inside[index]   = infinity;
+                    }
+                    else if (alpha > 0.0f)
+                    {
+                        const float d   = 0.5f - alpha;
+                        outside[index]  = d > 0.0f ? d * d : 0.0f;
+                        inside[index]   = d < 0.0f ? d * d : 0.0f;
                     }
                 }
             }
-        }
 
-        inline Glyph get_glyph(const FT_Face& ft_font, const uint32_t char_code, const Vector2& pen, const uint32_t atlas_width, const uint32_t atlas_height, const uint32_t outline_size)
-        {
-            // The glyph metrics refer to whatever the last loaded glyph was, this is up to the caller of the function
-            FT_Glyph_Metrics& metrics = ft_font->glyph->metrics; 
-
-            Glyph glyph                 = {};
-            glyph.offset_x              = metrics.horiBearingX >> 6;
-            glyph.offset_y              = metrics.horiBearingY >> 6;
-            glyph.width                 = (metrics.width >> 6) + outline_size * 2;
-            glyph.height                = (metrics.height >> 6) + outline_size * 2;
-            glyph.horizontal_advance    = metrics.horiAdvance >> 6;
-            glyph.uv_x_left             = static_cast<float>(pen.x)                 / static_cast<float>(atlas_width);
-            glyph.uv_x_right            = static_cast<float>(pen.x + glyph.width)   / static_cast<float>(atlas_width);
-            glyph.uv_y_top              = static_cast<float>(pen.y)                 / static_cast<float>(atlas_height);
-            glyph.uv_y_bottom           = static_cast<float>(pen.y + glyph.height)  / static_cast<float>(atlas_height);
-
-            // Kerning is the process of adjusting the position of two subsequent glyph images 
-            // in a string of text in order to improve the general appearance of text. 
-            // For example, if a glyph for an uppercase ‘A’ is followed by a glyph for an 
-            // uppercase ‘V’, the space between the two glyphs can be slightly reduced to 
-            // avoid extra ‘diagonal whitespace’.
-            if (char_code >= 1 && FT_HAS_KERNING(ft_font))
+            distance_transform_2d(outside, sdf_width, sdf_height);
+            distance_transform_2d(inside, sdf_width, sdf_height);
+
+            distance_field->resize(pixel_count);
+            for (uint32_t i = 0; i < pixel_count; i++)
             {
-                FT_Vector kerningVec;
-                FT_Get_Kerning(ft_font, char_code - 1, char_code, FT_KERNING_DEFAULT, &kerningVec);
-                glyph.horizontal_advance += kerningVec.x >> 6;
+                const float distance    = Helper::Sqrt(outside[i]) - Helper::Sqrt(inside[i]);
+                const float value       = Helper::Saturate(0.5f - distance / (2.0f * font_sdf_spread));
+                (*distance_field)[i]    = static_cast<std::byte>(value * 255.0f + 0.5f);
             }
-
-            return glyph;
         }
     }
 
@@ -380,10 +328,6 @@ namespace Spartan
         if (!ft_helper::handle_error(FT_Init_FreeType(&m_library)))
             return;
 
-        // Initialize stroker
-        if (!ft_helper::handle_error(FT_Stroker_New(m_library, &m_stroker)))
-            return;
-
         // Get version
         FT_Int major;
         FT_Int minor;
@@ -394,122 +338,197 @@ namespace Spartan
 
     FontImporter::~FontImporter()
     {
-        FT_Stroker_Done(m_stroker);
+        for (FT_FaceRec_* face : m_faces)
+        {
+            ft_helper::handle_error(FT_Done_Face(face));
+        }
+
         ft_helper::handle_error(FT_Done_FreeType(m_library));
     }
 
     bool FontImporter::LoadFromFile(Font* font, const string& file_path)
     {
-        // Load font (called face)
-        FT_Face ft_font = nullptr;
-        if (!ft_helper::handle_error(FT_New_Face(m_library, file_path.c_str(), 0, &ft_font)))
         {
-            ft_helper::handle_error(FT_Done_Face(ft_font));
-            return false;
-        }
+            lock_guard<mutex> lock(m_mutex);
 
-        // Set font size
-        if (!ft_helper::handle_error(FT_Set_Char_Size(
-            ft_font,                // handle to face object
-            0,                        // char_width in 1/64th of points 
-            font->GetSize() * 64,    // char_height in 1/64th of points
-            96,                        // horizontal device resolution
-            96)))                    // vertical device resolution
-        {
-            ft_helper::handle_error(FT_Done_Face(ft_font));
-            return false;
+            // Load font (called face), it stays loaded so that glyphs can be added as they are needed
+            FT_Face ft_font = nullptr;
+            if (!ft_helper::handle_error(FT_New_Face(m_library, file_path.c_str(), 0, &ft_font)))
+                return false;
+
+            // Glyphs are rasterised once, at the size of the distance field, and scaled to whatever size the font is drawn at
+            if (!ft_helper::handle_error(FT_Set_Pixel_Sizes(ft_font, 0, font_sdf_size)))
+            {
+                ft_helper::handle_error(FT_Done_Face(ft_font));
+                return false;
+            }
+
+            m_faces.emplace_back(ft_font);
+            font->SetFace(ft_font);
+            font->SetLineHeight(static_cast<float>(ft_font->size->metrics.height >> 6));
         }
 
-        // Set outline size
-        const uint32_t outline_size   = (font->GetOutline() != Font_Outline_None) ? font->GetOutlineSize() : 0;
-        const bool outline            = outline_size != 0;
-        if (outline)
+        vector<uint32_t> char_codes;
+        for (uint32_t char_code = GLYPH_START; char_code < GLYPH_END; char_code++)
         {
-            FT_Stroker_Set(m_stroker, outline_size * 64, FT_STROKER_LINECAP_ROUND, FT_STROKER_LINEJOIN_ROUND, 0);
+            char_codes.emplace_back(char_code);
         }
 
-        g_glyph_load_flags = ft_helper::get_load_flags(font);
+        return LoadGlyphs(font, char_codes);
+    }
+
+    bool FontImporter::LoadGlyphs(Font* font, const vector<uint32_t>& char_codes)
+    {
+        lock_guard<mutex> lock(m_mutex);
 
-        // Get the size of the font atlas texture (if an outline is requested, it accounts for a big enough atlas)
-        uint32_t atlas_width        = 0;
-        uint32_t atlas_height       = 0;
-        uint32_t atlas_cell_width   = 0;
-        uint32_t atlas_cell_height  = 0;
-        ft_helper::get_texture_atlas_dimensions(&atlas_width, &atlas_height, &atlas_cell_width, &atlas_cell_height, ft_font, outline_size);
+        FT_Face ft_font = font->GetFace();
+        if (!ft_font || char_codes.empty())
+            return false;
 
-        // Atlas for text
-        vector<std::byte> atlas_text(atlas_width * atlas_height);
-        atlas_text.reserve(atlas_text.size());
+        const Stopwatch stopwatch;
 
-        // Atlas for outline (if needed)
-        vector<std::byte> atlas_outline;
-        if (outline_size != 0)
+        struct GlyphBitmap
         {
-            atlas_outline.resize(atlas_text.size());
-            atlas_outline.reserve(atlas_text.size());
-        }
+            uint32_t char_code = 0;
+            uint32_t width     = 0;
+            uint32_t height    = 0;
+            vector<unsigned char> coverage;
+            vector<std::byte> distance_field;
+            Glyph glyph;
+        };
+        vector<GlyphBitmap> bitmaps;
+        bitmaps.reserve(char_codes.size());
 
-        // Go through each glyph
-        Vector2 pen = 0.0f;
-        bool writting_started = false;
-        for (uint32_t char_code = GLYPH_START; char_code < GLYPH_END; char_code++)
+        // Rasterise, FreeType faces can't be used from multiple threads
+        const FT_UInt32 load_flags = ft_helper::get_load_flags(font);
+        for (const uint32_t char_code : char_codes)
         {
-            // Load text bitmap
-            ft_helper::ft_bitmap bitmap_text;
-            ft_helper::get_bitmap(&bitmap_text, font, nullptr, ft_font, char_code);
+            if (font->HasGlyph(char_code))
+                continue;
 
-            // Load glyph bitmap (if needeD)
-            ft_helper::ft_bitmap bitmap_outline;
-            if (outline)
+            // Characters which fail to load get an empty glyph, so that they are not attempted again every time they are drawn
+            if (!ft_helper::load_glyph(ft_font, char_code, load_flags))
             {
-                ft_helper::get_bitmap(&bitmap_outline, font, m_stroker, ft_font, char_code);
+                LOG_WARNING("Failed to load character %u, it will not be displayed", char_code);
+                bitmaps.emplace_back().char_code = char_code;
+                continue;
             }
 
-            // Advance pen
-            // Whitespace characters don't have a buffer and don't write on the atlas, hence no need to advance the pen in these cases.
-            if (bitmap_text.buffer && writting_started)
+            const FT_Bitmap& bitmap_ft      = ft_font->glyph->bitmap;
+            const FT_Glyph_Metrics& metrics = ft_font->glyph->metrics;
+
+            GlyphBitmap& bitmap                 = bitmaps.emplace_back();
+            bitmap.char_code                    = char_code;
+            bitmap.glyph.horizontal_advance     = static_cast<float>(metrics.horiAdvance >> 6);
+
+            // Whitespace characters only advance the pen
+            if (!bitmap_ft.buffer || bitmap_ft.pixel_mode != FT_PIXEL_MODE_GRAY)
+                continue;
+
+            bitmap.width  = bitmap_ft.width;
+            bitmap.height = bitmap_ft.rows;
+            bitmap.coverage.resize(bitmap.width * bitmap.height);
+            for (uint32_t y = 0; y < bitmap.height; y++)
             {
-                // Advance column
-                pen.x += atlas_cell_width;
+                memcpy(bitmap.coverage.data() + y * bitmap.width, bitmap_ft.buffer + y * bitmap_ft.pitch, bitmap.width);
+            }
 
-                // Advance row
-                if (pen.x + atlas_cell_width > atlas_width)
+            // The quad covers the border of the distance field too
+            bitmap.glyph.offset_x   = static_cast<float>(ft_font->glyph->bitmap_left) - font_sdf_spread;
+            bitmap.glyph.offset_y   = static_cast<float>(ft_font->glyph->bitmap_top) + font_sdf_spread;
+            bitmap.glyph.width      = static_cast<float>(bitmap.width + font_sdf_spread * 2);
+            bitmap.glyph.height     = static_cast<float>(bitmap.height + font_sdf_spread * 2);
+        }
+        const float time_raster = stopwatch.GetElapsedTimeMs();
+
+        // Distance fields, in parallel
+        m_context->GetSubsystem<Threading>()->AddTaskLoop([&bitmaps](uint32_t start, uint32_t end)
+        {
+            for (uint32_t i = start; i < end; i++)
+            {
+                GlyphBitmap& bitmap = bitmaps[i];
+                if (!bitmap.coverage.empty())
                 {
-                    pen.x = 0;
-                    pen.y += atlas_cell_height;
+                    sdf::generate(bitmap.coverage, bitmap.width, bitmap.height, &bitmap.distance_field);
                 }
             }
+        }, static_cast<uint32_t>(bitmaps.size()));
+        const float time_sdf = stopwatch.GetElapsedTimeMs() - time_raster;
 
-            // Copy to atlas buffers
-            if (bitmap_text.buffer)
+        // Pack into shelves, tallest glyphs first so that the shelves waste less space
+        vector<uint32_t> order(bitmaps.size());
+        for (uint32_t i = 0; i < static_cast<uint32_t>(order.size()); i++)
+        {
+            order[i] = i;
+        }
+        sort(order.begin(), order.end(), [&bitmaps](const uint32_t a, const uint32_t b) { return bitmaps[a].glyph.height > bitmaps[b].glyph.height; });
+
+        FontAtlas& atlas            = font->GetAtlasData();
+        const uint32_t height_old   = atlas.height;
+        if (atlas.width == 0)
+        {
+            atlas.width  = ATLAS_WIDTH;
+            atlas.height = 64;
+            atlas.pixels.assign(atlas.width * atlas.height, std::byte{ 0 });
+        }
+
+        uint32_t glyphs_packed = 0;
+        for (const uint32_t index : order)
+        {
+            GlyphBitmap& bitmap = bitmaps[index];
+            if (!bitmap.distance_field.empty())
             {
-                ft_helper::copy_to_atlas(atlas_text, bitmap_text, pen, atlas_width, outline_size);
+                const uint32_t width  = static_cast<uint32_t>(bitmap.glyph.width);
+                const uint32_t height = static_cast<uint32_t>(bitmap.glyph.height);
+
+                // Next shelf
+                if (atlas.shelf_x + width > atlas.width)
+                {
+                    atlas.shelf_x       = 0;
+                    atlas.shelf_y       += atlas.shelf_height;
+                    atlas.shelf_height  = 0;
+                }
+
+                // Grow
+                while (atlas.shelf_y + height > atlas.height && atlas.height < ATLAS_HEIGHT_MAX)
+                {
+                    atlas.height *= 2;
+                    atlas.pixels.resize(atlas.width * atlas.height, std::byte{ 0 });
+                }
 
-                if (bitmap_outline.buffer)
+                if (width > atlas.width || atlas.shelf_y + height > atlas.height)
                 {
-                    ft_helper::copy_to_atlas(atlas_outline, bitmap_outline, pen, atlas_width, 0);
+                    LOG_ERROR("The font atlas is full, character %u will not be displayed", bitmap.char_code);
+                    bitmap.glyph = Glyph();
                 }
+                else
+                {
+                    for (uint32_t y = 0; y < height; y++)
+                    {
+                        memcpy(&atlas.pixels[atlas.shelf_x + (atlas.shelf_y + y) * atlas.width], &bitmap.distance_field[y * width], width);
+                    }
 
-                writting_started = true;
+                    bitmap.glyph.atlas_x = atlas.shelf_x;
+                    bitmap.glyph.atlas_y = atlas.shelf_y;
+                    atlas.shelf_x        += width;
+                    atlas.shelf_height   = Helper::Max(atlas.shelf_height, height);
+                    glyphs_packed++;
+                }
             }
 
-            // Get glyph
-            font->SetGlyph(char_code, ft_helper::get_glyph(ft_font, char_code, pen, atlas_width, atlas_height, outline_size));
+            font->SetGlyph(bitmap.char_code, bitmap.glyph);
         }
 
-        // Free face
-        ft_helper::handle_error(FT_Done_Face(ft_font));
-
-        // Create a texture with of font atlas and a texture of the font outline atlas
+        if (glyphs_packed != 0 || atlas.height != height_old)
         {
-            font->SetAtlas(move(static_pointer_cast<RHI_Texture>(make_shared<RHI_Texture2D>(m_context, atlas_width, atlas_height, RHI_Format_R8_Unorm, atlas_text))));
-
-            if (outline_size != 0)
-            {
-                font->SetAtlasOutline(move(static_pointer_cast<RHI_Texture>(make_shared<RHI_Texture2D>(m_context, atlas_width, atlas_height, RHI_Format_R8_Unorm, atlas_outline))));
-            }
+            font->SetAtlas(static_pointer_cast<RHI_Texture>(make_shared<RHI_Texture2D>(m_context, atlas.width, atlas.height, RHI_Format_R8_Unorm, atlas.pixels)));
         }
 
+        LOG_INFO("%u glyphs in %.2f ms (raster %.2f ms, distance fields %.2f ms), atlas %ux%u (%.0f KB) with %u glyphs for all sizes and outlines",
+            static_cast<uint32_t>(bitmaps.size()), stopwatch.GetElapsedTimeMs(), time_raster, time_sdf,
+            atlas.width, atlas.height, atlas.pixels.size() / 1024.0f, font->GetGlyphCount()
+        );
+
         return true;
     }
 }
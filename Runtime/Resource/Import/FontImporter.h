@@ -21,14 +21,16 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES ==============================
+//= INCLUDES ===============================
 #include <string>
+#include <vector>
+#include <mutex>
 #include "../../Core/Spartan_Definitions.h"
-//=========================================
+//==========================================
 
 //= FORWARD DECLARATIONS =
 struct FT_LibraryRec_;
-struct FT_StrokerRec_;
+struct FT_FaceRec_;
 //========================
 
 namespace Spartan
@@ -44,9 +46,13 @@ namespace Spartan
 
         bool LoadFromFile(Font* font, const std::string& file_path);
 
+        // Adds glyphs to the atlas of a font, glyphs which it already has are skipped
+        bool LoadGlyphs(Font* font, const std::vector<uint32_t>& char_codes);
+
     private:
-        Context* m_context            = nullptr;
-        FT_LibraryRec_* m_library    = nullptr;
-        FT_StrokerRec_* m_stroker   = nullptr;
+        Context* m_context              = nullptr;
+        FT_LibraryRec_* m_library       = nullptr;
+        std::vector<FT_FaceRec_*> m_faces;
+        std::mutex m_mutex;
     };
 }
@@ -19,7 +19,7 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES =========================
+//= INCLUDES ==========================
 #include "Spartan.h"
 #include "ImageImporter.h"
 #define FREEIMAGE_LIB
@@ -27,7 +27,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <Utilities.h>
 #include "../../Threading/Threading.h"
 #include "../../RHI/RHI_Texture2D.h"
-//====================================
+#include "MipGenerator.h"
+//=====================================
 
 //= NAMESPACES =====
 using namespace std;
@@ -37,23 +38,6 @@ namespace Spartan::freeimage_helper
 {
     static FREE_IMAGE_FILTER rescale_filter = FILTER_BOX;
 
-    // A struct that rescaling threads will work with
-    struct RescaleJob
-    {
-        uint32_t width           = 0;
-        uint32_t height          = 0;
-        uint32_t channel_count   = 0;
-        vector<std::byte>* data  = nullptr;
-        bool done                = false;
-
-        RescaleJob(const uint32_t width, const uint32_t height, const uint32_t channel_count)
-        {
-            this->width         = width;
-            this->height        = height;
-            this->channel_count = channel_count;
-        }
-    };
-
     inline uint32_t get_bytes_per_channel(FIBITMAP* bitmap)
     {
         if (!bitmap)
@@ -215,7 +199,22 @@ namespace Spartan
         // If the texture supports mipmaps, generate them
         if (generate_mipmaps)
         {
-            GenerateMipmaps(bitmap, texture, image_width, image_height, image_channel_count);
+            MipGenerator::Description desc;
+            desc.width                      = image_width;
+            desc.height                     = image_height;
+            desc.channel_count              = image_channel_count;
+            desc.bytes_per_channel          = image_bytes_per_channel;
+            desc.srgb                       = texture->GetSrgb();
+            desc.preserve_alpha_coverage    = desc.srgb && image_is_transparent; // color is the only alpha tested texture
+
+            vector<vector<std::byte>> mips;
+            if (MipGenerator::generate(desc, mip, mips, m_context->GetSubsystem<Threading>()))
+            {
+                for (vector<std::byte>& mip_data : mips)
+                {
+                    texture->AddMip() = move(mip_data);
+                }
+            }
         }
 
         // Free memory 
@@ -257,67 +256,6 @@ namespace Spartan
         return true;
     }
 
-    void ImageImporter::GenerateMipmaps(FIBITMAP* bitmap, RHI_Texture* texture, uint32_t width, uint32_t height, uint32_t channels)
-    {
-        if (!texture)
-        {
-            LOG_ERROR_INVALID_PARAMETER();
-            return;
-        }
-    
-        // Create a RescaleJob for every mip that we need
-        vector<freeimage_helper::RescaleJob> jobs;
-        while (width > 1 && height > 1)
-        {
-            width    = Math::Helper::Max(width / 2, static_cast<uint32_t>(1));
-            height    = Math::Helper::Max(height / 2, static_cast<uint32_t>(1));
-            jobs.emplace_back(width, height, channels);
-            
-            // Resize the RHI_Texture vector accordingly
-            const auto size = width * height * channels;
-            std::vector<std::byte>& mip = texture->AddMip();
-            mip.reserve(size);
-            mip.resize(size);
-        }
-
-        // Pass data pointers (now that the RHI_Texture mip vector has been constructed)
-        for (uint32_t i = 0; i < jobs.size(); i++)
-        {
-            // reminder: i + 1 because the 0 mip is the default image size
-            jobs[i].data = &texture->GetMip(i + 1);
-        }
-
-        // Parallelize mipmap generation using multiple threads (because FreeImage_Rescale() using FILTER_LANCZOS3 is expensive)
-        auto threading = m_context->GetSubsystem<Threading>();
-        for (auto& job : jobs)
-        {
-            threading->AddTask([this, &job, &bitmap]()
-            {
-                const auto bitmap_scaled = FreeImage_Rescale(bitmap, job.width, job.height, freeimage_helper::rescale_filter);
-                if (!GetBitsFromFibitmap(job.data, bitmap_scaled, job.width, job.height, job.channel_count))
-                {
-                    LOG_ERROR("Failed to create mip level %dx%d", job.width, job.height);
-                }
-                FreeImage_Unload(bitmap_scaled);
-                job.done = true;
-            });
-        }
-
-        // Wait until all mipmaps have been generated
-        auto ready = false;
-        while (!ready)
-        {
-            ready = true;
-            for (const auto& job : jobs)
-            {
-                if (!job.done)
-                {
-                    ready = false;
-                }
-            }
-        }
-    }
-
     FIBITMAP* ImageImporter::ApplyBitmapCorrections(FIBITMAP* bitmap) const
     {
         if (!bitmap)
@@ -44,7 +44,6 @@ namespace Spartan
 
     private:    
         bool GetBitsFromFibitmap(std::vector<std::byte>* data, FIBITMAP* bitmap, uint32_t width, uint32_t height, uint32_t channels) const;
-        void GenerateMipmaps(FIBITMAP* bitmap, RHI_Texture* texture, uint32_t width, uint32_t height, uint32_t channels);
         FIBITMAP* ApplyBitmapCorrections(FIBITMAP* bitmap) const;
         FIBITMAP* _FreeImage_ConvertTo32Bits(FIBITMAP* bitmap) const;
         FIBITMAP* _FreeImage_Rescale(FIBITMAP* bitmap, uint32_t width, uint32_t height) const;
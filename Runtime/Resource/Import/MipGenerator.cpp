@@ -0,0 +1,422 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ==========================
+#include "Spartan.h"
+#include "MipGenerator.h"
+#include "../../Threading/Threading.h"
+#include <array>
+#include <emmintrin.h>
+//=====================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan::MipGenerator
+{
+    namespace
+    {
+        constexpr float kaiser_alpha            = 4.0f;
+        constexpr float kaiser_radius           = 1.5f; // in texels of the destination mip
+        constexpr uint32_t rows_min_parallel    = 64;   // smaller mips aren't worth the threading overhead
+
+        // Lookup tables for the conversions between 8 bit and linear values
+        struct Tables
+        {
+            float unorm_to_float[256];
+            float srgb_to_linear[256];
+            uint8_t linear_to_srgb[4096];
+
+            Tables()
+            {
+                for (uint32_t i = 0; i < 256; i++)
+                {
+                    const float value   = i / 255.0f;
+                    unorm_to_float[i]   = value;
+                    srgb_to_linear[i]   = value <= 0.04045f ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+                }
+
+                for (uint32_t i = 0; i < 4096; i++)
+                {
+                    const float value   = i / 4095.0f;
+                    const float srgb    = value <= 0.0031308f ? value * 12.92f : 1.055f * powf(value, 1.0f / 2.4f) - 0.055f;
+                    linear_to_srgb[i]   = static_cast<uint8_t>(srgb * 255.0f + 0.5f);
+                }
+            }
+        };
+
+        const Tables& get_tables()
+        {
+            static const Tables tables;
+            return tables;
+        }
+
+        float bessel_i0(const float x)
+        {
+            // Power series, it converges quickly for the arguments the kaiser window uses
+            const float x_half_squared = x * x * 0.25f;
+            float sum   = 1.0f;
+            float term  = 1.0f;
+            for (uint32_t k = 1; k < 20; k++)
+            {
+                term *= x_half_squared / static_cast<float>(k * k);
+                sum  += term;
+            }
+
+            return sum;
+        }
+
+        float kaiser(const float x)
+        {
+            if (fabsf(x) >= kaiser_radius)
+                return 0.0f;
+
+            const float t       = x / kaiser_radius;
+            const float sinc    = x == 0.0f ? 1.0f : sinf(Helper::PI * x) / (Helper::PI * x);
+            return sinc * bessel_i0(kaiser_alpha * sqrtf(1.0f - t * t)) / bessel_i0(kaiser_alpha);
+        }
+
+        // The source texels (and their weights) which contribute to each texel of the destination mip, along one axis
+        struct Axis
+        {
+            vector<uint32_t> first;     // per destination texel, offset into the arrays below
+            vector<uint32_t> count;     // per destination texel
+            vector<uint32_t> indices;   // source texels, clamped to the edges
+            vector<float> weights;      // normalized
+        };
+
+        Axis compute_axis(const uint32_t size_src, const uint32_t size_dst, const Filter filter)
+        {
+            Axis axis;
+            axis.first.resize(size_dst);
+            axis.count.resize(size_dst);
+
+            const float scale = static_cast<float>(size_src) / static_cast<float>(size_dst);
+            for (uint32_t i = 0; i < size_dst; i++)
+            {
+                axis.first[i] = static_cast<uint32_t>(axis.weights.size());
+
+                float weight_sum = 0.0f;
+                const auto add_tap = [&axis, &weight_sum, size_src](const int32_t index, const float weight)
+                {
+                    if (weight == 0.0f)
+                        return;
+
+                    axis.indices.emplace_back(static_cast<uint32_t>(Helper::Clamp<int32_t>(index, 0, static_cast<int32_t>(size_src) - 1)));
+                    axis.weights.emplace_back(weight);
+                    weight_sum += weight;
+                };
+
+                if (filter == Filter::Box)
+                {
+                    // Weighted by how much of each source texel is covered, which also handles odd sizes
+                    const float start   = i * scale;
+                    const float end     = start + scale;
+                    for (int32_t j = static_cast<int32_t>(floorf(start)); j < static_cast<int32_t>(ceilf(end)); j++)
+                    {
+                        add_tap(j, Helper::Min(end, j + 1.0f) - Helper::Max(start, static_cast<float>(j)));
+                    }
+                }
+                else
+                {
+                    const float center = (i + 0.5f) * scale;
+                    const float radius = kaiser_radius * scale;
+                    for (int32_t j = static_cast<int32_t>(floorf(center - radius)); j <= static_cast<int32_t>(ceilf(center + radius)); j++)
+                    {
+                        add_tap(j, kaiser((j + 0.5f - center) / scale));
+                    }
+                }
+
+                axis.count[i] = static_cast<uint32_t>(axis.weights.size()) - axis.first[i];
+                for (uint32_t k = axis.first[i]; k < axis.weights.size(); k++)
+                {
+                    axis.weights[k] /= weight_sum;
+                }
+            }
+
+            return axis;
+        }
+
+        // Converts a row to four linear floats per texel
+        void decode_row(const Description& desc, const bool srgb, const std::byte* src, const uint32_t width, float* dst)
+        {
+            const uint32_t channel_count = desc.channel_count;
+
+            if (desc.bytes_per_channel == 1)
+            {
+                const Tables& tables    = get_tables();
+                const uint8_t* texels   = reinterpret_cast<const uint8_t*>(src);
+                const float* color      = srgb ? tables.srgb_to_linear : tables.unorm_to_float;
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    for (uint32_t c = 0; c < 4; c++)
+                    {
+                        dst[x * 4 + c] = c < channel_count ? (c < 3 ? color : tables.unorm_to_float)[texels[x * channel_count + c]] : 0.0f;
+                    }
+                }
+            }
+            else
+            {
+                const float* texels = reinterpret_cast<const float*>(src);
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    for (uint32_t c = 0; c < 4; c++)
+                    {
+                        dst[x * 4 + c] = c < channel_count ? texels[x * channel_count + c] : 0.0f;
+                    }
+                }
+            }
+        }
+
+        // Converts four linear floats per texel back to the format of the image
+        void encode_row(const Description& desc, const bool srgb, const float* src, const uint32_t width, std::byte* dst)
+        {
+            const uint32_t channel_count = desc.channel_count;
+
+            if (desc.bytes_per_channel == 1)
+            {
+                const Tables& tables    = get_tables();
+                uint8_t* texels         = reinterpret_cast<uint8_t*>(dst);
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    for (uint32_t c = 0; c < channel_count; c++)
+                    {
+                        const float value = Helper::Saturate(src[x * 4 + c]);
+                        texels[x * channel_count + c] = (srgb && c < 3) ? tables.linear_to_srgb[static_cast<uint32_t>(value * 4095.0f + 0.5f)] : static_cast<uint8_t>(value * 255.0f + 0.5f);
+                    }
+                }
+            }
+            else
+            {
+                float* texels = reinterpret_cast<float*>(dst);
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    for (uint32_t c = 0; c < channel_count; c++)
+                    {
+                        texels[x * channel_count + c] = src[x * 4 + c];
+                    }
+                }
+            }
+        }
+
+        void filter_row(const Axis& axis, const float* src, const uint32_t width_dst, float* dst)
+        {
+            for (uint32_t x = 0; x < width_dst; x++)
+            {
+                const uint32_t tap_start    = axis.first[x];
+                const uint32_t tap_end      = tap_start + axis.count[x];
+
+                __m128 sum = _mm_setzero_ps();
+                for (uint32_t k = tap_start; k < tap_end; k++)
+                {
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(src + axis.indices[k] * 4), _mm_set1_ps(axis.weights[k])));
+                }
+
+                _mm_storeu_ps(dst + x * 4, sum);
+            }
+        }
+
+        // Generates a band of rows of the destination mip, the source rows it needs are filtered horizontally once and then vertically
+        void generate_band(const Description& desc, const bool srgb, const std::byte* src, const uint32_t width_src, const Axis& axis_x, const Axis& axis_y, const uint32_t width_dst, std::byte* dst, const uint32_t row_start, const uint32_t row_end)
+        {
+            if (row_start >= row_end)
+                return;
+
+            // The source rows the band needs
+            uint32_t src_min = numeric_limits<uint32_t>::max();
+            uint32_t src_max = 0;
+            for (uint32_t k = axis_y.first[row_start]; k < axis_y.first[row_end - 1] + axis_y.count[row_end - 1]; k++)
+            {
+                src_min = Helper::Min(src_min, axis_y.indices[k]);
+                src_max = Helper::Max(src_max, axis_y.indices[k]);
+            }
+
+            const uint32_t texel_size   = desc.channel_count * desc.bytes_per_channel;
+            const uint64_t pitch_src    = static_cast<uint64_t>(width_src) * texel_size;
+            const uint64_t pitch_dst    = static_cast<uint64_t>(width_dst) * texel_size;
+            const uint32_t floats_dst   = width_dst * 4;
+
+            // Horizontal
+            vector<float> row_decoded(width_src * 4);
+            vector<float> rows(static_cast<size_t>(src_max - src_min + 1) * floats_dst);
+            for (uint32_t y = src_min; y <= src_max; y++)
+            {
+                decode_row(desc, srgb, src + y * pitch_src, width_src, row_decoded.data());
+                filter_row(axis_x, row_decoded.data(), width_dst, rows.data() + static_cast<size_t>(y - src_min) * floats_dst);
+            }
+
+            // Vertical
+            vector<float> row_filtered(floats_dst);
+            for (uint32_t y = row_start; y < row_end; y++)
+            {
+                fill(row_filtered.begin(), row_filtered.end(), 0.0f);
+
+                const uint32_t tap_start    = axis_y.first[y];
+                const uint32_t tap_end      = tap_start + axis_y.count[y];
+                for (uint32_t k = tap_start; k < tap_end; k++)
+                {
+                    const float* row    = rows.data() + static_cast<size_t>(axis_y.indices[k] - src_min) * floats_dst;
+                    const __m128 weight = _mm_set1_ps(axis_y.weights[k]);
+                    for (uint32_t i = 0; i < floats_dst; i += 4)
+                    {
+                        _mm_storeu_ps(&row_filtered[i], _mm_add_ps(_mm_loadu_ps(&row_filtered[i]), _mm_mul_ps(_mm_loadu_ps(row + i), weight)));
+                    }
+                }
+
+                encode_row(desc, srgb, row_filtered.data(), width_dst, dst + y * pitch_dst);
+            }
+        }
+
+        void compute_alpha_histogram(const vector<std::byte>& data, array<uint32_t, 256>& histogram)
+        {
+            histogram.fill(0);
+
+            const uint8_t* texels = reinterpret_cast<const uint8_t*>(data.data());
+            for (size_t i = 3; i < data.size(); i += 4)
+            {
+                histogram[texels[i]]++;
+            }
+        }
+
+        // The fraction of texels which pass the alpha test, if alpha was scaled
+        float compute_alpha_coverage(const array<uint32_t, 256>& histogram, const float scale, const float reference)
+        {
+            uint64_t passed = 0;
+            uint64_t total  = 0;
+            for (uint32_t alpha = 0; alpha < 256; alpha++)
+            {
+                total  += histogram[alpha];
+                passed += Helper::Min(alpha / 255.0f * scale, 1.0f) > reference ? histogram[alpha] : 0;
+            }
+
+            return total != 0 ? static_cast<float>(passed) / static_cast<float>(total) : 0.0f;
+        }
+
+        // Scales alpha so that the coverage matches the one of the top mip (coverage only grows with the scale, so binary search it)
+        void preserve_alpha_coverage(vector<std::byte>& data, const float coverage, const float reference)
+        {
+            array<uint32_t, 256> histogram;
+            compute_alpha_histogram(data, histogram);
+
+            float scale     = 1.0f;
+            float scale_min = 0.0f;
+            float scale_max = 4.0f;
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                const float coverage_scaled = compute_alpha_coverage(histogram, scale, reference);
+                if (coverage_scaled == coverage)
+                    break;
+
+                (coverage_scaled < coverage ? scale_min : scale_max) = scale;
+                scale = (scale_min + scale_max) * 0.5f;
+            }
+
+            if (scale == 1.0f)
+                return;
+
+            uint8_t* texels = reinterpret_cast<uint8_t*>(data.data());
+            for (size_t i = 3; i < data.size(); i += 4)
+            {
+                texels[i] = static_cast<uint8_t>(Helper::Min(texels[i] * scale + 0.5f, 255.0f));
+            }
+        }
+    }
+
+    bool generate(const Description& desc, const vector<std::byte>& mip_0, vector<vector<std::byte>>& mips, Threading* threading /*= nullptr*/)
+    {
+        const bool valid_channels   = desc.channel_count >= 1 && desc.channel_count <= 4;
+        const bool valid_bytes      = desc.bytes_per_channel == 1 || desc.bytes_per_channel == 4;
+        if (desc.width == 0 || desc.height == 0 || !valid_channels || !valid_bytes)
+        {
+            LOG_ERROR("Unsupported image (%dx%d, %d channels, %d bytes per channel)", desc.width, desc.height, desc.channel_count, desc.bytes_per_channel);
+            return false;
+        }
+
+        const uint32_t texel_size = desc.channel_count * desc.bytes_per_channel;
+        if (mip_0.size() < static_cast<size_t>(desc.width) * desc.height * texel_size)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return false;
+        }
+
+        // Gamma only applies to the color channels of 8 bit images and only 8 bit images with alpha are alpha tested
+        const bool srgb             = desc.srgb && desc.bytes_per_channel == 1 && desc.channel_count >= 3;
+        const bool alpha_coverage   = desc.preserve_alpha_coverage && desc.bytes_per_channel == 1 && desc.channel_count == 4;
+
+        // The coverage every mip should match
+        float coverage = 0.0f;
+        if (alpha_coverage)
+        {
+            array<uint32_t, 256> histogram;
+            compute_alpha_histogram(mip_0, histogram);
+            coverage = compute_alpha_coverage(histogram, 1.0f, desc.alpha_reference);
+        }
+
+        // Each mip reads the previous one, so reserve them all upfront to keep them in place
+        uint32_t mip_count = 0;
+        for (uint32_t size = Helper::Max(desc.width, desc.height); size > 1; size /= 2)
+        {
+            mip_count++;
+        }
+        mips.reserve(mips.size() + mip_count);
+
+        uint32_t width      = desc.width;
+        uint32_t height     = desc.height;
+        const std::byte* src     = mip_0.data();
+        while (width > 1 || height > 1)
+        {
+            const uint32_t width_dst    = Helper::Max(width / 2, 1u);
+            const uint32_t height_dst   = Helper::Max(height / 2, 1u);
+            const Axis axis_x           = compute_axis(width, width_dst, desc.filter);
+            const Axis axis_y           = compute_axis(height, height_dst, desc.filter);
+
+            vector<std::byte>& mip = mips.emplace_back(static_cast<size_t>(width_dst) * height_dst * texel_size);
+
+            const auto generate_rows = [&desc, srgb, src, width, &axis_x, &axis_y, width_dst, &mip](uint32_t row_start, uint32_t row_end)
+            {
+                generate_band(desc, srgb, src, width, axis_x, axis_y, width_dst, mip.data(), row_start, row_end);
+            };
+
+            if (threading && height_dst >= rows_min_parallel)
+            {
+                threading->AddTaskLoop(generate_rows, height_dst);
+            }
+            else
+            {
+                generate_rows(0, height_dst);
+            }
+
+            if (alpha_coverage)
+            {
+                preserve_alpha_coverage(mip, coverage, desc.alpha_reference);
+            }
+
+            src     = mip.data();
+            width   = width_dst;
+            height  = height_dst;
+        }
+
+        return true;
+    }
+}
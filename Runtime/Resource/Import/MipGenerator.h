@@ -0,0 +1,58 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES ==============================
+#include <vector>
+#include <cstddef>
+#include "../../Core/Spartan_Definitions.h"
+//=========================================
+
+namespace Spartan
+{
+    class Threading;
+}
+
+namespace Spartan::MipGenerator
+{
+    enum class Filter
+    {
+        Box,    // averages the texels covered by each texel of the next mip
+        Kaiser  // kaiser windowed sinc, keeps the mips sharper
+    };
+
+    struct Description
+    {
+        uint32_t width                  = 0;
+        uint32_t height                 = 0;
+        uint32_t channel_count          = 0;     // 1 to 4
+        uint32_t bytes_per_channel      = 0;     // 1 (unorm) or 4 (float)
+        bool srgb                       = false; // the color channels are gamma encoded, so they are filtered in linear space
+        bool preserve_alpha_coverage    = false; // keeps the fraction of texels which pass the alpha test the same across mips
+        float alpha_reference           = 0.6f;  // the alpha test threshold, same as the G-Buffer's mask threshold
+        Filter filter                   = Filter::Kaiser;
+    };
+
+    // Generates the full mip chain (down to 1x1) below the given mip, each mip is filtered from the previous one and bands of rows are processed in parallel
+    bool generate(const Description& desc, const std::vector<std::byte>& mip_0, std::vector<std::vector<std::byte>>& mips, Threading* threading = nullptr);
+}
@@ -19,19 +19,24 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES =================================
+//= INCLUDES ==================================
 #include "Spartan.h"
 #include "ModelImporter.h"
 #include "AssimpHelper.h"
 #include "../ProgressTracker.h"
-#include "../../RHI/RHI_Texture.h"
+#include "../ResourceCache.h"
+#include "../../RHI/RHI_Texture2D.h"
 #include "../../Rendering/Model.h"
+#include "../../Rendering/Mesh.h"
 #include "../../Rendering/Animation.h"
 #include "../../Rendering/Material.h"
 #include "../../World/World.h"
 #include "../../World/Components/Renderable.h"
+#include "../../World/Components/Animator.h"
 #include "../../RHI/RHI_Vertex.h"
-//============================================
+#include "../../Threading/Threading.h"
+#include <unordered_set>
+//=============================================
 
 //= NAMESPACES ================
 using namespace std;
@@ -41,6 +46,55 @@ using namespace Assimp;
 
 namespace Spartan
 {
+    // Engine texture, Assimp texture pbr, Assimp texture legacy (fallback)
+    struct texture_slot
+    {
+        Material_Property type_spartan;
+        aiTextureType type_assimp_pbr;
+        aiTextureType type_assimp_legacy;
+    };
+
+    static const texture_slot texture_slots[] =
+    {
+        { Material_Color,     aiTextureType_BASE_COLOR,        aiTextureType_DIFFUSE   },
+        { Material_Roughness, aiTextureType_DIFFUSE_ROUGHNESS, aiTextureType_SHININESS }, // Use specular as fallback
+        { Material_Metallic,  aiTextureType_METALNESS,         aiTextureType_AMBIENT   }, // Use ambient as fallback
+        { Material_Normal,    aiTextureType_NORMAL_CAMERA,     aiTextureType_NORMALS   },
+        { Material_Occlusion, aiTextureType_AMBIENT_OCCLUSION, aiTextureType_LIGHTMAP  },
+        { Material_Occlusion, aiTextureType_LIGHTMAP,          aiTextureType_LIGHTMAP  },
+        { Material_Emission,  aiTextureType_EMISSION_COLOR,    aiTextureType_EMISSIVE  },
+        { Material_Height,    aiTextureType_HEIGHT,            aiTextureType_NONE      },
+        { Material_Mask,      aiTextureType_OPACITY,           aiTextureType_NONE      }
+    };
+
+    // Levels of detail generated per mesh (including the full one), each aims for half the triangles of the previous one.
+    // The allowed error (relative to the mesh extent) doubles with every level, it matches the screen sizes the renderable switches at.
+    static const uint32_t lod_count             = 4;
+    static const float lod_error                = 0.005f;
+    static const uint32_t lod_index_count_min   = 256 * 3; // smaller meshes aren't worth it
+
+    // Returns the (validated) file path of the texture a material has for a slot, empty if there isn't one
+    static string get_texture_path(const aiMaterial* assimp_material, const texture_slot& slot, const string& model_path, aiTextureType* type_assimp_out = nullptr)
+    {
+        aiTextureType type_assimp   = assimp_material->GetTextureCount(slot.type_assimp_pbr)    > 0 ? slot.type_assimp_pbr      : aiTextureType_NONE;
+        type_assimp                 = assimp_material->GetTextureCount(slot.type_assimp_legacy) > 0 ? slot.type_assimp_legacy   : type_assimp;
+
+        aiString texture_path;
+        if (assimp_material->GetTextureCount(type_assimp) == 0 || assimp_material->GetTexture(type_assimp, 0, &texture_path) != AI_SUCCESS)
+            return "";
+
+        const string deduced_path = AssimpHelper::texture_validate_path(texture_path.data, model_path);
+        if (!FileSystem::IsSupportedImageFile(deduced_path))
+            return "";
+
+        if (type_assimp_out)
+        {
+            *type_assimp_out = type_assimp;
+        }
+
+        return deduced_path;
+    }
+
     ModelImporter::ModelImporter(Context* context)
     {
         m_context    = context;
@@ -101,7 +155,6 @@ namespace Spartan
             aiProcess_GenSmoothNormals |
             aiProcess_JoinIdenticalVertices |
             aiProcess_OptimizeMeshes |              // reduce the number of meshes         
-            aiProcess_ImproveCacheLocality |        // re-order triangles for better vertex cache locality.
             aiProcess_RemoveRedundantMaterials |    // remove redundant/unreferenced materials.
             aiProcess_LimitBoneWeights |
             aiProcess_SplitLargeMeshes |
@@ -115,11 +168,15 @@ namespace Spartan
             aiProcess_Debone;
 
         // aiProcess_FixInfacingNormals - is not reliable and fails often.
+        // aiProcess_ImproveCacheLocality - not needed, the model optimises the geometry of its meshes (see MeshOptimizer).
         // aiProcess_OptimizeGraph      - works but because it merges as nodes as possible, you can't really click and select anything other than the entire thing.
 
         // Read the 3D model file from disk
+        Stopwatch timer;
         if (const aiScene* scene = importer.ReadFile(file_path, importer_flags))
         {
+            const float time_read = timer.GetElapsedTimeMs();
+
             // Update progress tracking
             int job_count = 0;
             AssimpHelper::compute_node_count(scene->mRootNode, &job_count);
@@ -134,12 +191,40 @@ namespace Spartan
             new_entity->SetName(params.name); // Set custom name, which is more descriptive than "RootNode"
             params.model->SetRootEntity(new_entity);
 
-            // Parse all nodes, starting from the root node and continuing recursively
+            // Parse all nodes, starting from the root node and continuing recursively (this creates the entities and gathers the meshes)
+            timer.Start();
             ParseNode(scene->mRootNode, params, nullptr, new_entity.get());
+            const float time_nodes = timer.GetElapsedTimeMs();
+
+            // Build the skeleton from the nodes which the meshes are skinned to
+            LoadSkeleton(params);
+
+            // Load the textures in parallel (each one once), then the materials which reference them
+            timer.Start();
+            LoadTextures(params);
+            LoadMaterials(params);
+            const float time_materials = timer.GetElapsedTimeMs();
+
+            // Convert the meshes in parallel, into ranges of the model geometry which are reserved upfront
+            timer.Start();
+            LoadMeshes(params);
+            const float time_meshes = timer.GetElapsedTimeMs();
+
             // Parse animations
             ParseAnimations(params);
             // Update model geometry
             model->UpdateGeometry();
+
+            LOG_INFO("\"%s\": read %.0f ms, nodes %.0f ms, %d textures and %d materials %.0f ms, %d meshes %.0f ms",
+                params.name.c_str(),
+                time_read,
+                time_nodes,
+                static_cast<uint32_t>(params.textures.size()),
+                scene->mNumMaterials,
+                time_materials,
+                static_cast<uint32_t>(params.meshes.size()),
+                time_meshes
+            );
         }
         else
         {
@@ -151,7 +236,7 @@ namespace Spartan
         return params.scene != nullptr;
     }
 
-    void ModelImporter::ParseNode(const aiNode* assimp_node, const ModelParams& params, Entity* parent_node, Entity* new_entity)
+    void ModelImporter::ParseNode(const aiNode* assimp_node, ModelParams& params, Entity* parent_node, Entity* new_entity)
     {
         if (parent_node) // parent node is already set
         {
@@ -182,7 +267,7 @@ namespace Spartan
         ProgressTracker::Get().IncrementJobsDone(ProgressType::ModelImporter);
     }
 
-    void ModelImporter::ParseNodeMeshes(const aiNode* assimp_node, Entity* new_entity, const ModelParams& params)
+    void ModelImporter::ParseNodeMeshes(const aiNode* assimp_node, Entity* new_entity, ModelParams& params)
     {
         for (uint32_t i = 0; i < assimp_node->mNumMeshes; i++)
         {
@@ -202,14 +287,27 @@ namespace Spartan
             // Set entity name
             entity->SetName(_name);
 
-            // Process mesh
-            LoadMesh(assimp_mesh, entity, params);
-            entity->SetActive(true);
+            // Gather the mesh, it's processed once all of them are known
+            ModelMesh& mesh     = params.meshes.emplace_back();
+            mesh.assimp_mesh    = assimp_mesh;
+            mesh.entity         = entity;
+
+            // Skinned vertices end up relative to the root node, so they have to be brought back into the space of the mesh
+            mesh.node_transform = Matrix::Identity;
+            for (const aiNode* node = assimp_node; node && node != params.scene->mRootNode; node = node->mParent)
+            {
+                mesh.node_transform = mesh.node_transform * AssimpHelper::ai_matrix4_x4_to_matrix(node->mTransformation);
+            }
         }
     }
 
     void ModelImporter::ParseAnimations(const ModelParams& params)
     {
+        // Animations can only drive the bones of the skeleton
+        Skeleton& skeleton = params.model->GetSkeleton();
+        if (skeleton.IsEmpty())
+            return;
+
         for (uint32_t i = 0; i < params.scene->mNumAnimations; i++)
         {
             const auto assimp_animation = params.scene->mAnimations[i];
@@ -227,6 +325,9 @@ namespace Spartan
                 AnimationNode animation_node;
 
                 animation_node.name = assimp_node_anim->mNodeName.C_Str();
+                animation_node.bone = skeleton.FindBone(animation_node.name);
+                if (animation_node.bone < 0)
+                    continue;
 
                 // Position keys
                 for (uint32_t k = 0; k < static_cast<uint32_t>(assimp_node_anim->mNumPositionKeys); k++)
@@ -240,7 +341,7 @@ namespace Spartan
                 // Rotation keys
                 for (uint32_t k = 0; k < static_cast<uint32_t>(assimp_node_anim->mNumRotationKeys); k++)
                 {
-                    const auto time = assimp_node_anim->mPositionKeys[k].mTime;
+                    const auto time = assimp_node_anim->mRotationKeys[k].mTime;
                     const auto value = AssimpHelper::to_quaternion(assimp_node_anim->mRotationKeys[k].mValue);
 
                     animation_node.rotationFrames.emplace_back(KeyQuaternion{ time, value });
@@ -249,28 +350,224 @@ namespace Spartan
                 // Scaling keys
                 for (uint32_t k = 0; k < static_cast<uint32_t>(assimp_node_anim->mNumScalingKeys); k++)
                 {
-                    const auto time = assimp_node_anim->mPositionKeys[k].mTime;
+                    const auto time = assimp_node_anim->mScalingKeys[k].mTime;
                     const auto value = AssimpHelper::to_vector3(assimp_node_anim->mScalingKeys[k].mValue);
 
                     animation_node.scaleFrames.emplace_back(KeyVector{ time, value });
                 }
+
+                animation->AddChannel(animation_node);
             }
+
+            // Drop the keys which interpolation can recreate and quantise the rest
+            AnimationCompression::Report report;
+            animation->Compress(AnimationCompression::Settings(), &report);
+            LOG_INFO("Animation \"%s\": %u keys (%.1f KB) compressed to %u keys (%.1f KB)",
+                animation->GetName().c_str(),
+                report.key_count_before, report.size_before / 1024.0f,
+                report.key_count_after, report.size_after / 1024.0f
+            );
+
+            params.model->AddAnimation(animation);
         }
     }
 
-    void ModelImporter::LoadMesh(aiMesh* assimp_mesh, Entity* entity_parent, const ModelParams& params)
+    void ModelImporter::LoadTextures(ModelParams& params)
     {
-        if (!assimp_mesh || !entity_parent)
+        if (!params.scene->HasMaterials())
+            return;
+
+        ProgressTracker::Get().SetStatus(ProgressType::ModelImporter, "Loading textures...");
+
+        // Gather the textures of the materials which are used, each one once
+        vector<bool> material_used(params.scene->mNumMaterials, false);
+        for (const ModelMesh& mesh : params.meshes)
         {
-            LOG_ERROR_INVALID_PARAMETER();
+            material_used[mesh.assimp_mesh->mMaterialIndex] = true;
+        }
+
+        ResourceCache* resource_cache = m_context->GetSubsystem<ResourceCache>();
+        vector<pair<string, shared_ptr<RHI_Texture>>> textures_to_load;
+        for (uint32_t i = 0; i < params.scene->mNumMaterials; i++)
+        {
+            if (!material_used[i] || !params.scene->mMaterials[i])
+                continue;
+
+            for (const texture_slot& slot : texture_slots)
+            {
+                const string path = get_texture_path(params.scene->mMaterials[i], slot, params.file_path);
+                if (path.empty())
+                    continue;
+
+                if (!params.textures.count(path))
+                {
+                    // Textures which are already cached don't have to be loaded again
+                    if (shared_ptr<RHI_Texture2D> texture = resource_cache->GetByName<RHI_Texture2D>(FileSystem::GetFileNameNoExtensionFromFilePath(path)))
+                    {
+                        params.textures[path] = texture;
+                        continue;
+                    }
+
+                    const bool generate_mipmaps = true;
+                    shared_ptr<RHI_Texture> texture = make_shared<RHI_Texture2D>(m_context, generate_mipmaps);
+                    params.textures[path] = texture;
+                    textures_to_load.emplace_back(path, texture);
+                }
+
+                // Color is gamma encoded, which the mips have to respect
+                if (slot.type_spartan == Material_Color && params.textures[path]->GetLoadState() == LoadState::Idle)
+                {
+                    params.textures[path]->SetSrgb(true);
+                }
+            }
+        }
+
+        // Decode, generate mips and upload in parallel
+        m_context->GetSubsystem<Threading>()->AddTaskLoop([&textures_to_load](uint32_t start, uint32_t end)
+        {
+            for (uint32_t i = start; i < end; i++)
+            {
+                textures_to_load[i].second->LoadFromFile(textures_to_load[i].first);
+            }
+        }, static_cast<uint32_t>(textures_to_load.size()));
+    }
+
+    void ModelImporter::LoadMaterials(ModelParams& params)
+    {
+        if (!params.scene->HasMaterials())
+            return;
+
+        // Materials are shared by the meshes which use them
+        params.materials.resize(params.scene->mNumMaterials);
+        for (const ModelMesh& mesh : params.meshes)
+        {
+            shared_ptr<Material>& material = params.materials[mesh.assimp_mesh->mMaterialIndex];
+            if (!material)
+            {
+                material = LoadMaterial(params.scene->mMaterials[mesh.assimp_mesh->mMaterialIndex], params);
+            }
+        }
+    }
+
+    void ModelImporter::LoadMeshes(ModelParams& params)
+    {
+        if (params.meshes.empty())
             return;
+
+        ProgressTracker::Get().SetStatus(ProgressType::ModelImporter, "Loading meshes...");
+
+        // Reserve a range of the model geometry for each mesh
+        uint32_t index_count    = 0;
+        uint32_t vertex_count   = 0;
+        for (ModelMesh& mesh : params.meshes)
+        {
+            mesh.index_offset   = index_count;
+            mesh.vertex_offset  = vertex_count;
+            index_count         += mesh.assimp_mesh->mNumFaces * 3;
+            vertex_count        += mesh.assimp_mesh->mNumVertices;
+        }
+
+        uint32_t index_offset   = 0;
+        uint32_t vertex_offset  = 0;
+        params.model->GetMesh()->Geometry_Grow(index_count, vertex_count, &index_offset, &vertex_offset);
+        for (ModelMesh& mesh : params.meshes)
+        {
+            mesh.index_offset   += index_offset;
+            mesh.vertex_offset  += vertex_offset;
+        }
+
+        // Bone weights are stored alongside the vertices
+        if (!params.model->GetSkeleton().IsEmpty())
+        {
+            params.model->GetMesh()->Skin_Enable();
+        }
+
+        // Convert them in parallel
+        m_context->GetSubsystem<Threading>()->AddTaskLoop([this, &params](uint32_t start, uint32_t end)
+        {
+            for (uint32_t i = start; i < end; i++)
+            {
+                LoadMesh(params.meshes[i], params);
+                LoadSkin(params.meshes[i], params);
+            }
+        }, static_cast<uint32_t>(params.meshes.size()));
+
+        // Hook them up to their entities (components can only be added from one thread)
+        for (ModelMesh& mesh : params.meshes)
+        {
+            const aiMesh* assimp_mesh = mesh.assimp_mesh;
+            Entity* entity            = mesh.entity;
+
+            // Add a renderable component to this entity
+            auto renderable = entity->AddComponent<Renderable>();
+
+            // Set the geometry
+            renderable->GeometrySet(
+                entity->GetName(),
+                mesh.index_offset,
+                assimp_mesh->mNumFaces * 3,
+                mesh.vertex_offset,
+                assimp_mesh->mNumVertices,
+                mesh.aabb,
+                params.model
+            );
+
+            // Levels of detail are appended after all the meshes, they reference the vertices of their mesh
+            vector<Mesh_Lod> lods;
+            for (const vector<uint32_t>& lod_indices : mesh.lods)
+            {
+                Mesh_Lod& lod   = lods.emplace_back();
+                lod.index_count = static_cast<uint32_t>(lod_indices.size());
+                params.model->GetMesh()->Indices_Append(lod_indices, &lod.index_offset);
+                renderable->GeometryAddLod(lod.index_offset, lod.index_count);
+            }
+
+            // Material
+            if (assimp_mesh->mMaterialIndex < params.materials.size())
+            {
+                if (shared_ptr<Material>& material = params.materials[assimp_mesh->mMaterialIndex])
+                {
+                    params.model->AddMaterial(material, entity->GetPtrShared());
+                }
+            }
+
+            // Optimised by the model, before its buffers are created
+            Mesh_Range range;
+            range.index_offset  = mesh.index_offset;
+            range.index_count   = assimp_mesh->mNumFaces * 3;
+            range.vertex_offset = mesh.vertex_offset;
+            range.vertex_count  = assimp_mesh->mNumVertices;
+            range.lods          = move(lods);
+            params.model->GetMesh()->Range_Add(range);
+
+            // Skinned meshes are animated by the skeleton of the model, the offsets take them into the space of each bone
+            Skeleton& skeleton = params.model->GetSkeleton();
+            if (assimp_mesh->HasBones() && !skeleton.IsEmpty())
+            {
+                vector<Matrix> bone_offsets(skeleton.GetBoneCount(), Matrix::Identity);
+                for (uint32_t i = 0; i < assimp_mesh->mNumBones; i++)
+                {
+                    const int32_t bone = skeleton.FindBone(assimp_mesh->mBones[i]->mName.C_Str());
+                    if (bone >= 0)
+                    {
+                        bone_offsets[bone] = AssimpHelper::ai_matrix4_x4_to_matrix(assimp_mesh->mBones[i]->mOffsetMatrix);
+                    }
+                }
+
+                entity->AddComponent<Animator>()->SetBinding(bone_offsets, Matrix::Invert(mesh.node_transform));
+            }
+
+            entity->SetActive(true);
         }
+    }
 
+    void ModelImporter::LoadMesh(ModelMesh& mesh, const ModelParams& params) const
+    {
+        const aiMesh* assimp_mesh   = mesh.assimp_mesh;
         const uint32_t vertex_count = assimp_mesh->mNumVertices;
-        const uint32_t index_count  = assimp_mesh->mNumFaces * 3;
 
         // Vertices
-        vector<RHI_Vertex_PosTexNorTan> vertices = vector<RHI_Vertex_PosTexNorTan>(vertex_count);
+        RHI_Vertex_PosTexNorTan* vertices = params.model->GetMesh()->Vertices_Get().data() + mesh.vertex_offset;
         {
             for (uint32_t i = 0; i < vertex_count; i++)
             {
@@ -312,7 +609,7 @@ namespace Spartan
         }
 
         // Indices
-        vector<uint32_t> indices = vector<uint32_t>(index_count);
+        uint32_t* indices = params.model->GetMesh()->Indices_Get().data() + mesh.index_offset;
         {
             // Get indices by iterating through each face of the mesh.
             for (uint32_t face_index = 0; face_index < assimp_mesh->mNumFaces; face_index++)
@@ -326,80 +623,171 @@ namespace Spartan
             }
         }
 
-        // Compute AABB (before doing move operation on vertices)
-        const auto aabb = BoundingBox(vertices.data(), static_cast<uint32_t>(vertices.size()));
-
-        // Add the mesh to the model
-        uint32_t index_offset;
-        uint32_t vertex_offset;
-        params.model->AppendGeometry(move(indices), move(vertices), &index_offset, &vertex_offset);
-
-        // Add a renderable component to this entity
-        auto renderable    = entity_parent->AddComponent<Renderable>();
-
-        // Set the geometry
-        renderable->GeometrySet(
-            entity_parent->GetName(),
-            index_offset,
-            static_cast<uint32_t>(indices.size()),
-            vertex_offset,
-            static_cast<uint32_t>(vertices.size()),
-            aabb,
-            params.model
-        );
-
-        // Material
-        if (params.scene->HasMaterials())
-        {
-            // Get aiMaterial
-            const auto assimp_material = params.scene->mMaterials[assimp_mesh->mMaterialIndex];
-            // Convert it and add it to the model
-            shared_ptr<Material> material = LoadMaterial(assimp_material, params);
-            params.model->AddMaterial(material, entity_parent->GetPtrShared());
+        // Compute AABB
+        mesh.aabb = BoundingBox(vertices, vertex_count);
+
+        // Levels of detail, each one is simplified from the previous one
+        const uint32_t index_count = assimp_mesh->mNumFaces * 3;
+        if (index_count >= lod_index_count_min)
+        {
+            vector<uint32_t> lod_indices(index_count);
+            const uint32_t* source      = indices;
+            uint32_t source_index_count = index_count;
+
+            for (uint32_t lod = 1; lod < lod_count; lod++)
+            {
+                const uint32_t target_index_count = (index_count >> lod) / 3 * 3;
+                const float target_error          = lod_error * static_cast<float>(1 << (lod - 1));
+                const uint32_t lod_index_count    = MeshOptimizer::simplify(lod_indices.data(), source, source_index_count, vertices, vertex_count, target_index_count, target_error);
+
+                // Stop once the error limit keeps the level from being meaningfully simpler
+                if (lod_index_count == 0 || lod_index_count > source_index_count / 4 * 3)
+                    break;
+
+                mesh.lods.emplace_back(lod_indices.begin(), lod_indices.begin() + lod_index_count);
+                source              = mesh.lods.back().data();
+                source_index_count  = lod_index_count;
+            }
         }
+    }
 
-        // Bones
-        LoadBones(assimp_mesh, params);
+    // Marks the nodes which are bones or have bones below them, a skeleton needs all of them to pose its bones
+    static bool mark_skeleton_nodes(const aiNode* node, const unordered_set<string>& bone_names, unordered_set<const aiNode*>* nodes)
+    {
+        bool is_part = bone_names.count(node->mName.C_Str()) != 0;
+        for (uint32_t i = 0; i < node->mNumChildren; i++)
+        {
+            is_part |= mark_skeleton_nodes(node->mChildren[i], bone_names, nodes);
+        }
+
+        if (is_part)
+        {
+            nodes->insert(node);
+        }
+
+        return is_part;
     }
 
-    void ModelImporter::LoadBones(const aiMesh* assimp_mesh, const ModelParams& params)
+    static void add_skeleton_nodes(const aiNode* node, const int32_t parent, const unordered_set<const aiNode*>& nodes, Skeleton* skeleton)
     {
-        // Maximum number of bones per mesh
-        // Must not be higher than same const in skinning shader
-        constexpr uint8_t MAX_BONES = 64;
-        // Maximum number of bones per vertex
-        constexpr uint8_t MAX_BONES_PER_VERTEX = 4;
-
-        //for (uint32_t i = 0; i < assimp_mesh->mNumBones; i++)
-        //{
-        //    uint32_t index = 0;
-
-        //    assert(assimp_mesh->mNumBones <= MAX_BONES);
-
-        //    string name = assimp_mesh->mBones[i]->mName.data;
-
-        //    if (boneMapping.find(name) == boneMapping.end())
-        //    {
-        //        // Bone not present, add new one
-        //        index = numBones;
-        //        numBones++;
-        //        BoneInfo bone;
-        //        boneInfo.push_back(bone);
-        //        boneInfo[index].offset = pMesh->mBones[i]->mOffsetMatrix;
-        //        boneMapping[name] = index;
-        //    }
-        //    else
-        //    {
-        //        index = boneMapping[name];
-        //    }
-
-        //    for (uint32_t j = 0; j < assimp_mesh->mBones[i]->mNumWeights; j++)
-        //    {
-        //        uint32_t vertexID = vertexOffset + pMesh->mBones[i]->mWeights[j].mVertexId;
-        //        Bones[vertexID].add(index, pMesh->mBones[i]->mWeights[j].mWeight);
-        //    }
-        //}
-        //boneTransforms.resize(numBones);
+        int32_t index = parent;
+        if (nodes.count(node))
+        {
+            const Matrix transform = AssimpHelper::ai_matrix4_x4_to_matrix(node->mTransformation);
+
+            Bone bone;
+            bone.name       = node->mName.C_Str();
+            bone.parent     = parent;
+            bone.position   = transform.GetTranslation();
+            bone.rotation   = transform.GetRotation();
+            bone.scale      = transform.GetScale();
+            index           = skeleton->AddBone(bone);
+            if (index < 0)
+                return;
+        }
+
+        for (uint32_t i = 0; i < node->mNumChildren; i++)
+        {
+            add_skeleton_nodes(node->mChildren[i], index, nodes, skeleton);
+        }
+    }
+
+    void ModelImporter::LoadSkeleton(ModelParams& params)
+    {
+        // Gather the names of the bones which the meshes are skinned to
+        unordered_set<string> bone_names;
+        for (const ModelMesh& mesh : params.meshes)
+        {
+            for (uint32_t i = 0; i < mesh.assimp_mesh->mNumBones; i++)
+            {
+                bone_names.insert(mesh.assimp_mesh->mBones[i]->mName.C_Str());
+            }
+        }
+
+        if (bone_names.empty())
+            return;
+
+        // The skeleton is made of the nodes below the root (the root entity carries the root node's transform), parents first
+        unordered_set<const aiNode*> nodes;
+        const aiNode* root = params.scene->mRootNode;
+        for (uint32_t i = 0; i < root->mNumChildren; i++)
+        {
+            mark_skeleton_nodes(root->mChildren[i], bone_names, &nodes);
+        }
+
+        Skeleton& skeleton = params.model->GetSkeleton();
+        for (uint32_t i = 0; i < root->mNumChildren; i++)
+        {
+            add_skeleton_nodes(root->mChildren[i], -1, nodes, &skeleton);
+        }
+
+        if (skeleton.GetBoneCount() != nodes.size())
+        {
+            LOG_WARNING("\"%s\" has more than %u bones, it won't be animated", params.name.c_str(), Skeleton::bone_count_max);
+            skeleton.Clear();
+            return;
+        }
+
+        params.model->SetAnimated(true);
+    }
+
+    void ModelImporter::LoadSkin(const ModelMesh& mesh, const ModelParams& params) const
+    {
+        const aiMesh* assimp_mesh = mesh.assimp_mesh;
+        Mesh* model_mesh          = params.model->GetMesh().get();
+        if (!model_mesh->Skin_IsEnabled() || !assimp_mesh->HasBones())
+            return;
+
+        // Keep the four most influential bones of every vertex
+        const uint32_t vertex_count = assimp_mesh->mNumVertices;
+        vector<array<pair<float, uint8_t>, 4>> influences(vertex_count);
+        for (uint32_t i = 0; i < assimp_mesh->mNumBones; i++)
+        {
+            const aiBone* assimp_bone = assimp_mesh->mBones[i];
+            const int32_t bone        = params.model->GetSkeleton().FindBone(assimp_bone->mName.C_Str());
+            if (bone < 0)
+                continue;
+
+            for (uint32_t j = 0; j < assimp_bone->mNumWeights; j++)
+            {
+                const aiVertexWeight& weight = assimp_bone->mWeights[j];
+                if (weight.mVertexId >= vertex_count)
+                    continue;
+
+                // The weakest influence is the last one, replace it if this one is stronger and keep the order
+                array<pair<float, uint8_t>, 4>& influence = influences[weight.mVertexId];
+                if (weight.mWeight <= influence[3].first)
+                    continue;
+
+                influence[3] = { weight.mWeight, static_cast<uint8_t>(bone) };
+                for (uint32_t k = 3; k > 0 && influence[k].first > influence[k - 1].first; k--)
+                {
+                    swap(influence[k], influence[k - 1]);
+                }
+            }
+        }
+
+        // Quantise the weights so that they add up to 255 (the rounding error goes to the strongest bone)
+        BoneWeights* weights = model_mesh->Skin_Get().data() + mesh.vertex_offset;
+        for (uint32_t i = 0; i < vertex_count; i++)
+        {
+            const array<pair<float, uint8_t>, 4>& influence = influences[i];
+            const float sum = influence[0].first + influence[1].first + influence[2].first + influence[3].first;
+            if (sum <= 0.0f)
+            {
+                weights[i].weights[0] = 255; // unweighted vertices follow the first bone
+                continue;
+            }
+
+            uint32_t total = 0;
+            for (uint32_t j = 0; j < 4; j++)
+            {
+                weights[i].bones[j]   = influence[j].second;
+                weights[i].weights[j] = static_cast<uint8_t>(influence[j].first / sum * 255.0f + 0.5f);
+                total                 += weights[i].weights[j];
+            }
+            weights[i].weights[0] = static_cast<uint8_t>(static_cast<int32_t>(weights[i].weights[0]) + 255 - static_cast<int32_t>(total));
+        }
     }
 
     shared_ptr<Material> ModelImporter::LoadMaterial(aiMaterial* assimp_material, const ModelParams& params)
@@ -428,64 +816,40 @@ namespace Spartan
 
         material->SetColorAlbedo(Vector4(color_diffuse.r, color_diffuse.g, color_diffuse.b, opacity.r));
 
-        // TEXTURES
-        const auto load_mat_tex = [&params, &assimp_material, &material](const Material_Property type_spartan, const aiTextureType type_assimp_pbr, const aiTextureType type_assimp_legacy)
+        // TEXTURES (loaded upfront)
+        for (const texture_slot& slot : texture_slots)
         {
-            aiTextureType type_assimp   = assimp_material->GetTextureCount(type_assimp_pbr)     > 0 ? type_assimp_pbr       : aiTextureType_NONE;
-            type_assimp                 = assimp_material->GetTextureCount(type_assimp_legacy)  > 0 ? type_assimp_legacy    : type_assimp;
+            aiTextureType type_assimp = aiTextureType_NONE;
+            const string path = get_texture_path(assimp_material, slot, params.file_path, &type_assimp);
+            const auto it = params.textures.find(path);
+            if (path.empty() || it == params.textures.end() || it->second->GetLoadState() == LoadState::Failed)
+                continue;
+
+            const Material_Property type_spartan    = slot.type_spartan;
+            const shared_ptr<RHI_Texture>& texture  = it->second;
+            material->SetTextureSlot(type_spartan, texture);
+
+            if (type_assimp == aiTextureType_BASE_COLOR || type_assimp == aiTextureType_DIFFUSE)
+            {
+                // FIX: materials that have a diffuse texture should not be tinted black/gray
+                material->SetColorAlbedo(Vector4::One);
+            }
 
-            aiString texture_path;
-            if (assimp_material->GetTextureCount(type_assimp) > 0)
+            // Some models (or Assimp) pass a normal map as a height map
+            // auto textureType others pass a height map as a normal map, we try to fix that.
+            if (type_spartan == Material_Normal || type_spartan == Material_Height)
             {
-                if (AI_SUCCESS == assimp_material->GetTexture(type_assimp, 0, &texture_path))
+                auto proper_type = type_spartan;
+                proper_type = (proper_type == Material_Normal && texture->GetGrayscale()) ? Material_Height : proper_type;
+                proper_type = (proper_type == Material_Height && !texture->GetGrayscale()) ? Material_Normal : proper_type;
+
+                if (proper_type != type_spartan)
                 {
-                    const auto deduced_path = AssimpHelper::texture_validate_path(texture_path.data, params.file_path);
-                    if (FileSystem::IsSupportedImageFile(deduced_path))
-                    {
-                        params.model->AddTexture(material, type_spartan, AssimpHelper::texture_validate_path(texture_path.data, params.file_path));
-
-                        if (type_assimp == aiTextureType_BASE_COLOR || type_assimp == aiTextureType_DIFFUSE)
-                        {
-                            // FIX: materials that have a diffuse texture should not be tinted black/gray
-                            material->SetColorAlbedo(Vector4::One);
-                        }
-
-                        // Some models (or Assimp) pass a normal map as a height map
-                        // auto textureType others pass a height map as a normal map, we try to fix that.
-                        if (type_spartan == Material_Normal || type_spartan == Material_Height)
-                        {
-                            if (const auto texture = material->GetTexture_PtrShared(type_spartan))
-                            {
-                                auto proper_type = type_spartan;
-                                proper_type = (proper_type == Material_Normal && texture->GetGrayscale()) ? Material_Height : proper_type;
-                                proper_type = (proper_type == Material_Height && !texture->GetGrayscale()) ? Material_Normal : proper_type;
-
-                                if (proper_type != type_spartan)
-                                {
-                                    material->SetTextureSlot(type_spartan, shared_ptr<RHI_Texture>());
-                                    material->SetTextureSlot(proper_type, texture);
-                                }
-                            }
-                            else
-                            {
-                                LOG_ERROR("Failed to get texture");
-                            }
-                        }
-                    }
+                    material->SetTextureSlot(type_spartan, shared_ptr<RHI_Texture>());
+                    material->SetTextureSlot(proper_type, texture);
                 }
             }
-        };
-
-        // Engine texture,               Assimp texture pbr,                 Assimp texture legacy (fallback)
-        load_mat_tex(Material_Color,     aiTextureType_BASE_COLOR,           aiTextureType_DIFFUSE);
-        load_mat_tex(Material_Roughness, aiTextureType_DIFFUSE_ROUGHNESS,    aiTextureType_SHININESS);   // Use specular as fallback
-        load_mat_tex(Material_Metallic,  aiTextureType_METALNESS,            aiTextureType_AMBIENT);     // Use ambient as fallback
-        load_mat_tex(Material_Normal,    aiTextureType_NORMAL_CAMERA,        aiTextureType_NORMALS);
-        load_mat_tex(Material_Occlusion, aiTextureType_AMBIENT_OCCLUSION,    aiTextureType_LIGHTMAP);
-        load_mat_tex(Material_Occlusion, aiTextureType_LIGHTMAP,             aiTextureType_LIGHTMAP);
-        load_mat_tex(Material_Emission,  aiTextureType_EMISSION_COLOR,       aiTextureType_EMISSIVE);
-        load_mat_tex(Material_Height,    aiTextureType_HEIGHT,               aiTextureType_NONE);
-        load_mat_tex(Material_Mask,      aiTextureType_OPACITY,              aiTextureType_NONE);
+        }
 
         return material;
     }
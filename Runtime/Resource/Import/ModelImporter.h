@@ -21,11 +21,15 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES ==============================
+//= INCLUDES ===============================
 #include <memory>
 #include <string>
+#include <vector>
+#include <unordered_map>
 #include "../../Core/Spartan_Definitions.h"
-//=========================================
+#include "../../Math/BoundingBox.h"
+#include "../../Math/Matrix.h"
+//==========================================
 
 struct aiNode;
 struct aiScene;
@@ -39,6 +43,19 @@ namespace Spartan
     class Entity;
     class Model;
     class World;
+    class RHI_Texture;
+
+    // A mesh gathered while parsing the nodes, it's converted (in parallel) once all of them are known
+    struct ModelMesh
+    {
+        aiMesh* assimp_mesh     = nullptr;
+        Entity* entity          = nullptr;
+        uint32_t index_offset   = 0;
+        uint32_t vertex_offset  = 0;
+        Math::BoundingBox aabb;
+        std::vector<std::vector<uint32_t>> lods; // simplified indices, appended to the model once all meshes are loaded
+        Math::Matrix node_transform;             // the transform of the mesh's node relative to the root node, skinning is relative to it
+    };
 
     struct ModelParams
     {
@@ -51,6 +68,11 @@ namespace Spartan
         bool has_animation;
         Model* model            = nullptr;
         const aiScene* scene    = nullptr;
+
+        // Import state
+        std::vector<ModelMesh> meshes;
+        std::vector<std::shared_ptr<Material>> materials;                       // indexed like the scene's materials
+        std::unordered_map<std::string, std::shared_ptr<RHI_Texture>> textures; // keyed by file path, each one is loaded once
     };
 
     class SPARTAN_CLASS ModelImporter
@@ -63,13 +85,17 @@ namespace Spartan
 
     private:
         // Parsing
-        void ParseNode(const aiNode* assimp_node, const ModelParams& params, Entity* parent_node = nullptr, Entity* new_entity = nullptr);
-        void ParseNodeMeshes(const aiNode* assimp_node, Entity* new_entity, const ModelParams& params);
+        void ParseNode(const aiNode* assimp_node, ModelParams& params, Entity* parent_node = nullptr, Entity* new_entity = nullptr);
+        void ParseNodeMeshes(const aiNode* assimp_node, Entity* new_entity, ModelParams& params);
         void ParseAnimations(const ModelParams& params);
 
         // Loading
-        void LoadMesh(aiMesh* assimp_mesh, Entity* entity_parent, const ModelParams& params);
-        void LoadBones(const aiMesh* assimp_mesh, const ModelParams& params);
+        void LoadTextures(ModelParams& params);
+        void LoadMaterials(ModelParams& params);
+        void LoadMeshes(ModelParams& params);
+        void LoadMesh(ModelMesh& mesh, const ModelParams& params) const; // thread safe, it only writes to the range reserved for the mesh
+        void LoadSkeleton(ModelParams& params);
+        void LoadSkin(const ModelMesh& mesh, const ModelParams& params) const; // thread safe, like LoadMesh()
         std::shared_ptr<Material> LoadMaterial(aiMaterial* assimp_material, const ModelParams& params);
 
         // Dependencies
@@ -51,6 +51,7 @@ namespace Spartan
         AddResourceDirectory(ResourceDirectory::Fonts,           data_dir + "fonts");
         AddResourceDirectory(ResourceDirectory::Icons,           data_dir + "icons");
         AddResourceDirectory(ResourceDirectory::Scripts,         data_dir + "scripts");
+        AddResourceDirectory(ResourceDirectory::ShaderCache,     data_dir + "shader_cache");
         AddResourceDirectory(ResourceDirectory::ShaderCompiler,  data_dir + "shader_compiler");
         AddResourceDirectory(ResourceDirectory::Shaders,         data_dir + "shaders");
         AddResourceDirectory(ResourceDirectory::Textures,        data_dir + "textures");
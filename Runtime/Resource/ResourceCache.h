@@ -40,6 +40,7 @@ namespace Spartan
         Fonts,
         Icons,
         Scripts,
+        ShaderCache,
         ShaderCompiler,
         Shaders,
         Textures
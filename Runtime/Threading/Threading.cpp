@@ -74,14 +74,8 @@ namespace Spartan
 
     uint32_t Threading::GetThreadsAvailable() const
     {
-        uint32_t available_threads = m_thread_count;
-
-        for (const auto& task : m_tasks)
-        {
-            available_threads -= task->IsExecuting() ? 1 : 0;
-        }
-
-        return available_threads;
+        // Tasks leave the queue before they execute, so the workers keep track of themselves
+        return m_thread_count - m_threads_busy;
     }
 
     void Threading::Flush(bool remove_queued /*= false*/)
@@ -89,6 +83,7 @@ namespace Spartan
         // Clear any queued tasks
         if (remove_queued)
         {
+            lock_guard<mutex> lock(m_mutex_tasks);
             m_tasks.clear();
         }
 
@@ -120,11 +115,17 @@ namespace Spartan
             // Remove it from the queue.
             m_tasks.pop_front();
 
+            // Mark this thread as busy
+            m_threads_busy++;
+
             // Unlock the mutex
             lock.unlock();
 
             // Execute the task.
             task->Execute();
+            task = nullptr;
+
+            m_threads_busy--;
         }
     }
 }
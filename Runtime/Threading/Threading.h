@@ -21,16 +21,17 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES ==================
+//= INCLUDES ===================
 #include <vector>
 #include <thread>
 #include <mutex>
 #include <deque>
+#include <atomic>
 #include <unordered_map>
 #include <functional>
 #include "../Logging/Log.h"
 #include "../Core/ISubsystem.h"
-//=============================
+//==============================
 
 namespace Spartan
 {
@@ -82,34 +83,53 @@ namespace Spartan
         template <typename Function>
         void AddTaskLoop(Function&& function, uint32_t range)
         {
-            uint32_t available_threads  = GetThreadsAvailable();
-            vector<bool> tasks_done     = vector<bool>(available_threads, false);
-            const uint32_t task_count   = available_threads + 1; // plus one for the current thread
-
-            uint32_t start  = 0;
-            uint32_t end    = 0;
-            for (uint32_t i = 0; i < available_threads; i++)
+            // The loop is split into chunks which are claimed by whoever gets to them first, the calling thread included.
+            // The calling thread only ever executes chunks of this loop, so it never picks up unrelated work while it waits,
+            // and if the workers are busy (or the caller is a worker itself) it simply ends up doing all of them.
+            struct LoopState
             {
-                start   = (range / task_count) * i;
-                end     = start + (range / task_count);
-
-                // Kick off task
-                AddTask([&function, &tasks_done, i, start, end] { function(start, end); tasks_done[i] = true; });
-            }
+                std::atomic<uint32_t> chunk_next    = 0;
+                std::atomic<uint32_t> chunks_done   = 0;
+                std::mutex mutex;
+                std::condition_variable condition_var;
+            };
+
+            const uint32_t available_threads    = GetThreadsAvailable();
+            const uint32_t chunk_count          = available_threads + 1; // plus one for the current thread
+            const auto state                    = std::make_shared<LoopState>();
+            const auto function_ptr             = &function;
+
+            // Returns false once there are no chunks left to claim. The function is only touched after a successful
+            // claim, which can't happen after the loop has returned, so helper tasks which start late are harmless.
+            auto execute_chunk = [state, function_ptr, chunk_count, range]()
+            {
+                const uint32_t chunk = state->chunk_next++;
+                if (chunk >= chunk_count)
+                    return false;
 
-            // Do last task in the current thread
-            function(end, range);
+                const uint32_t start = static_cast<uint32_t>((static_cast<uint64_t>(range) * chunk) / chunk_count);
+                const uint32_t end   = static_cast<uint32_t>((static_cast<uint64_t>(range) * (chunk + 1)) / chunk_count);
+                (*function_ptr)(start, end);
 
-            // Wait till the threads are done
-            uint32_t tasks = 0;
-            while (tasks != tasks_done.size())
-            {
-                tasks = 0;
-                for (const bool job_done : tasks_done)
+                if (++state->chunks_done == chunk_count)
                 {
-                    tasks += job_done ? 1 : 0;
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    state->condition_var.notify_all();
                 }
+
+                return true;
+            };
+
+            for (uint32_t i = 0; i < available_threads; i++)
+            {
+                AddTask([execute_chunk]() { execute_chunk(); });
             }
+
+            while (execute_chunk()) {}
+
+            // Wait for the chunks which workers are still executing
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->condition_var.wait(lock, [&state, chunk_count]() { return state->chunks_done == chunk_count; });
         }
 
         // Get the number of threads used
@@ -132,6 +152,7 @@ namespace Spartan
         std::vector<std::thread> m_threads;
         std::deque<std::shared_ptr<Task>> m_tasks;
         std::mutex m_mutex_tasks;
+        std::atomic<uint32_t> m_threads_busy = 0;
         std::condition_variable m_condition_var;
         std::unordered_map<std::thread::id, std::string> m_thread_names;
         bool m_stopping;
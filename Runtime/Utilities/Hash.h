@@ -29,4 +29,19 @@ namespace Spartan::Utility::Hash
         std::hash<T> hasher;
         seed ^= hasher(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
     }
+
+    // 64-bit FNV-1a, for keys which are too important to be left to a 32-bit hash_combine()
+    static const uint64_t fnv1a_64_offset = 0xcbf29ce484222325;
+
+    inline uint64_t fnv1a_64(const void* data, const size_t size, uint64_t hash = fnv1a_64_offset)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3;
+        }
+
+        return hash;
+    }
 }
@@ -0,0 +1,353 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===========================
+#include "Spartan.h"
+#include "Animator.h"
+#include "Renderable.h"
+#include "../Entity.h"
+#include "../../IO/FileStream.h"
+#include "../../Rendering/Model.h"
+#include "../../Rendering/Mesh.h"
+#include "../../Rendering/Animation.h"
+#include "../../Rendering/Renderer.h"
+#include "../../RHI/RHI_Vertex.h"
+#include "../../RHI/RHI_VertexBuffer.h"
+#include "../../RHI/RHI_SwapChain.h"
+//======================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan
+{
+    static void write_matrix(FileStream* stream, const Skinning::BoneMatrix& matrix)
+    {
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            for (uint32_t j = 0; j < 3; j++)
+            {
+                stream->Write(matrix.rows[i][j]);
+            }
+        }
+    }
+
+    static void read_matrix(FileStream* stream, Skinning::BoneMatrix* matrix)
+    {
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            for (uint32_t j = 0; j < 3; j++)
+            {
+                stream->Read(&matrix->rows[i][j]);
+            }
+            matrix->rows[i][3] = i == 3 ? 1.0f : 0.0f;
+        }
+    }
+
+    Animator::Animator(Context* context, Entity* entity, uint32_t id /*= 0*/) : IComponent(context, entity, id)
+    {
+        m_root_to_mesh = Skinning::to_bone_matrix(Matrix::Identity);
+
+        REGISTER_ATTRIBUTE_VALUE_VALUE(m_animation_index, uint32_t);
+        REGISTER_ATTRIBUTE_VALUE_VALUE(m_speed, float);
+        REGISTER_ATTRIBUTE_VALUE_VALUE(m_looping, bool);
+        REGISTER_ATTRIBUTE_VALUE_VALUE(m_bone_offsets, vector<Skinning::BoneMatrix>);
+        REGISTER_ATTRIBUTE_VALUE_VALUE(m_root_to_mesh, Skinning::BoneMatrix);
+    }
+
+    void Animator::OnTick(float delta_time)
+    {
+        if (!GetAnimation(m_animation_index))
+            return;
+
+        m_time = AdvanceTime(m_time, m_animation_index, delta_time);
+
+        if (m_crossfading)
+        {
+            m_time_next         = AdvanceTime(m_time_next, m_animation_index_next, delta_time);
+            m_crossfade_time    += delta_time * m_speed;
+
+            if (m_crossfade_time >= m_crossfade_duration)
+            {
+                m_animation_index   = m_animation_index_next;
+                m_time              = m_time_next;
+                m_crossfading       = false;
+                swap(m_cursor, m_cursor_next);
+            }
+        }
+
+        // Buffers can only be created from the main thread, evaluation happens later in the frame.
+        // They are only needed for skinning on the CPU, the vertex shaders skin the buffers of the model.
+        const Model* model = GetModel();
+        const bool skin_gpu = m_context->GetSubsystem<Renderer>()->GetOption(Render_GpuSkinning) && model && model->GetVertexBufferSkin();
+        if (!m_vertex_buffer && !skin_gpu)
+        {
+            CreateBuffers();
+        }
+    }
+
+    void Animator::Serialize(FileStream* stream)
+    {
+        stream->Write(m_animation_index);
+        stream->Write(m_speed);
+        stream->Write(m_looping);
+
+        stream->Write(static_cast<uint32_t>(m_bone_offsets.size()));
+        for (const Skinning::BoneMatrix& offset : m_bone_offsets)
+        {
+            write_matrix(stream, offset);
+        }
+        write_matrix(stream, m_root_to_mesh);
+    }
+
+    void Animator::Deserialize(FileStream* stream)
+    {
+        stream->Read(&m_animation_index);
+        stream->Read(&m_speed);
+        stream->Read(&m_looping);
+
+        // Bones are referenced by 8-bit indices, anything above that is a corrupt (or foreign) stream
+        const uint32_t bone_count = stream->ReadAs<uint32_t>();
+        if (bone_count > Skeleton::bone_count_max)
+        {
+            LOG_ERROR("Invalid bone count of %u, the animator of \"%s\" will not play", bone_count, GetEntityName().c_str());
+            m_bone_offsets.clear();
+            return;
+        }
+
+        m_bone_offsets.resize(bone_count);
+        for (Skinning::BoneMatrix& offset : m_bone_offsets)
+        {
+            read_matrix(stream, &offset);
+        }
+        read_matrix(stream, &m_root_to_mesh);
+    }
+
+    void Animator::Play(const uint32_t animation_index, const float crossfade_sec /*= 0.0f*/)
+    {
+        if (!GetAnimation(animation_index))
+        {
+            LOG_ERROR("Animation %u doesn't exist", animation_index);
+            return;
+        }
+
+        if (crossfade_sec <= 0.0f)
+        {
+            m_animation_index   = animation_index;
+            m_time              = 0.0;
+            m_crossfading       = false;
+            return;
+        }
+
+        m_animation_index_next  = animation_index;
+        m_time_next             = 0.0;
+        m_crossfade_duration    = crossfade_sec;
+        m_crossfade_time        = 0.0f;
+        m_crossfading           = true;
+    }
+
+    void Animator::SetBinding(const vector<Matrix>& bone_offsets, const Matrix& root_to_mesh)
+    {
+        m_bone_offsets.resize(bone_offsets.size());
+        for (uint32_t i = 0; i < static_cast<uint32_t>(bone_offsets.size()); i++)
+        {
+            m_bone_offsets[i] = Skinning::to_bone_matrix(bone_offsets[i]);
+        }
+
+        m_root_to_mesh = Skinning::to_bone_matrix(root_to_mesh);
+    }
+
+    bool Animator::Evaluate(const uint32_t frame_slot, Matrix* palette /*= nullptr*/, const uint32_t palette_offset /*= 0*/)
+    {
+        m_evaluated         = false;
+        m_evaluated_palette = false;
+
+        Renderable* renderable = m_entity->GetRenderable();
+        if (!renderable)
+            return false;
+
+        // Until there is a pose, the renderable is drawn (and culled) in the bind pose
+        renderable->SetBoundingBoxPose(BoundingBox());
+
+        Model* model = GetModel();
+        const Animation* animation = GetAnimation(m_animation_index);
+        if (!model || !animation)
+            return false;
+
+        // Skinning on the GPU reads the skinned buffers of the model, without them the vertices are skinned into the buffers of the frame slot
+        const bool skin_gpu = palette && model->GetVertexBufferSkin();
+        if (!skin_gpu && (!m_mapped || !m_mapped_position || frame_slot >= m_slot_count))
+            return false;
+
+        Skeleton& skeleton          = model->GetSkeleton();
+        const uint32_t bone_count   = skeleton.GetBoneCount();
+        if (m_bone_offsets.size() != bone_count)
+            return false;
+
+        // Sample the pose, blending into the next animation if there is one
+        m_pose.resize(bone_count);
+        Skinning::pose_bind(skeleton, m_pose.data());
+        Skinning::sample(*animation, &m_cursor, m_time, m_pose.data(), bone_count);
+
+        if (m_crossfading)
+        {
+            if (const Animation* animation_next = GetAnimation(m_animation_index_next))
+            {
+                m_pose_next.resize(bone_count);
+                Skinning::pose_bind(skeleton, m_pose_next.data());
+                Skinning::sample(*animation_next, &m_cursor_next, m_time_next, m_pose_next.data(), bone_count);
+                Skinning::blend(m_pose.data(), m_pose_next.data(), bone_count, Helper::Saturate(m_crossfade_time / Helper::Max(m_crossfade_duration, Helper::EPSILON)));
+            }
+        }
+
+        // Skin
+        m_globals.resize(bone_count);
+        m_palette.resize(bone_count);
+        Skinning::compute_palette(skeleton, m_pose.data(), m_bone_offsets.data(), m_root_to_mesh, m_globals.data(), m_palette.data());
+
+        Mesh* mesh                      = model->GetMesh().get();
+        const uint32_t vertex_offset    = renderable->GeometryVertexOffset();
+        Vector3 bounds_min;
+        Vector3 bounds_max;
+
+        if (skin_gpu)
+        {
+            const uint32_t vertex_count = renderable->GeometryVertexCount();
+            if (vertex_offset + vertex_count > mesh->Vertices_Count())
+                return false;
+
+            // The bind pose bounds of every bone only have to be computed once, the pose is bounded by transforming them
+            if (m_bone_bounds.size() != bone_count)
+            {
+                m_bone_bounds.resize(bone_count);
+                Skinning::compute_bone_bounds(&mesh->Vertices_Get()[vertex_offset], &mesh->Skin_Get()[vertex_offset], vertex_count, bone_count, m_bone_bounds.data());
+            }
+            Skinning::compute_pose_bounds(m_palette.data(), m_bone_bounds.data(), bone_count, &bounds_min, &bounds_max);
+            Skinning::compute_palette_gpu(m_palette.data(), bone_count, model->GetVertexTransform(), palette + palette_offset);
+
+            if (bounds_min.x <= bounds_max.x)
+            {
+                renderable->SetBoundingBoxPose(BoundingBox(bounds_min, bounds_max));
+            }
+
+            m_palette_offset    = palette_offset;
+            m_evaluated_palette = true;
+            return true;
+        }
+
+        m_vertices_skinned.resize(m_vertex_count);
+        Skinning::skin(&mesh->Vertices_Get()[vertex_offset], &mesh->Skin_Get()[vertex_offset], m_vertex_count, m_palette.data(), m_vertices_skinned.data(), &bounds_min, &bounds_max);
+
+        // Pack relative to the bounds of the pose, like the model does for the bind pose
+        const Vector3 center        = (bounds_min + bounds_max) * 0.5f;
+        const Vector3 extents       = (bounds_max - bounds_min) * 0.5f;
+        const float scale           = Helper::Max(Helper::Max3(extents.x, extents.y, extents.z), Helper::EPSILON);
+        const float scale_inverse   = 1.0f / scale;
+        m_vertex_transform          = Matrix(center, Quaternion::Identity, Vector3(scale));
+        m_vertex_offset             = frame_slot * m_vertex_count;
+
+        RHI_Vertex_PosTexNorTan_Packed* vertices    = m_mapped + m_vertex_offset;
+        RHI_Vertex_Pos_Packed* vertices_position    = m_mapped_position + m_vertex_offset;
+        for (uint32_t i = 0; i < m_vertex_count; i++)
+        {
+            vertices[i]          = RHI_Vertex_PosTexNorTan_Packed(m_vertices_skinned[i], center, scale_inverse);
+            vertices_position[i] = RHI_Vertex_Pos_Packed(m_vertices_skinned[i], center, scale_inverse);
+        }
+
+        // Skinned positions are in the space of the bind pose, so culling can use the bounds as they are
+        renderable->SetBoundingBoxPose(BoundingBox(bounds_min, bounds_max));
+
+        m_evaluated = true;
+        return true;
+    }
+
+    uint32_t Animator::GetBoneCount() const
+    {
+        Model* model = GetModel();
+        return model && GetAnimation(m_animation_index) ? model->GetSkeleton().GetBoneCount() : 0;
+    }
+
+    Model* Animator::GetModel() const
+    {
+        const Renderable* renderable = m_entity->GetRenderable();
+        Model* model                 = renderable ? renderable->GeometryModel() : nullptr;
+        return model && model->IsAnimated() ? model : nullptr;
+    }
+
+    const Animation* Animator::GetAnimation(const uint32_t index) const
+    {
+        const Model* model = GetModel();
+        if (!model || index >= model->GetAnimations().size())
+            return nullptr;
+
+        return model->GetAnimations()[index].get();
+    }
+
+    bool Animator::CreateBuffers()
+    {
+        Model* model = GetModel();
+        if (!model || !model->GetMesh()->Skin_IsEnabled())
+            return false;
+
+        const Renderable* renderable = m_entity->GetRenderable();
+        if (renderable->GeometryVertexOffset() + renderable->GeometryVertexCount() > model->GetMesh()->Vertices_Count())
+            return false;
+
+        // A range per frame that can be in flight, so the GPU never reads what is being written
+        Renderer* renderer                      = m_context->GetSubsystem<Renderer>();
+        const shared_ptr<RHI_Device>& rhi_device = renderer->GetRhiDevice();
+        m_slot_count                            = renderer->GetSwapChain() ? renderer->GetSwapChain()->GetBufferCount() : 0;
+        m_vertex_count                          = renderable->GeometryVertexCount();
+        if (m_slot_count == 0 || m_vertex_count == 0)
+            return false;
+
+        m_vertex_buffer             = make_shared<RHI_VertexBuffer>(rhi_device);
+        m_vertex_buffer_position    = make_shared<RHI_VertexBuffer>(rhi_device);
+        if (!m_vertex_buffer->CreateDynamic<RHI_Vertex_PosTexNorTan_Packed>(m_vertex_count * m_slot_count) || !m_vertex_buffer_position->CreateDynamic<RHI_Vertex_Pos_Packed>(m_vertex_count * m_slot_count))
+        {
+            LOG_ERROR("Failed to create the skinned vertex buffers of \"%s\"", GetEntityName().c_str());
+            return false;
+        }
+
+        // The mapping is persistent, so evaluation can write from any thread
+        m_mapped            = static_cast<RHI_Vertex_PosTexNorTan_Packed*>(m_vertex_buffer->Map());
+        m_mapped_position   = static_cast<RHI_Vertex_Pos_Packed*>(m_vertex_buffer_position->Map());
+
+        return m_mapped && m_mapped_position;
+    }
+
+    double Animator::AdvanceTime(double time, const uint32_t animation_index, const float delta_time) const
+    {
+        const Animation* animation = GetAnimation(animation_index);
+        if (!animation)
+            return 0.0;
+
+        const double duration = animation->GetDurationSec();
+        time += static_cast<double>(delta_time) * m_speed;
+
+        if (duration <= 0.0)
+            return 0.0;
+
+        return m_looping ? fmod(fmod(time, duration) + duration, duration) : Helper::Clamp(time, 0.0, duration);
+    }
+}
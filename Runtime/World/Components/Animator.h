@@ -0,0 +1,125 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =========================
+#include <vector>
+#include <memory>
+#include "IComponent.h"
+#include "../../Rendering/Skinning.h"
+#include "../../RHI/RHI_Vertex.h"
+//====================================
+
+namespace Spartan
+{
+    class Model;
+    class Animation;
+    class RHI_VertexBuffer;
+
+    // Plays the animations of a skinned model and skins the geometry of the entity's renderable, either on the CPU or by handing
+    // the bone matrices to the vertex shaders. The renderer evaluates all the animators of a frame in parallel and then draws.
+    class SPARTAN_CLASS Animator : public IComponent
+    {
+    public:
+        Animator(Context* context, Entity* entity, uint32_t id = 0);
+        ~Animator() = default;
+
+        //= ICOMPONENT ===============================
+        void OnTick(float delta_time) override;
+        void Serialize(FileStream* stream) override;
+        void Deserialize(FileStream* stream) override;
+        //============================================
+
+        // Playback, a cross-fade blends from the current animation into the next one
+        void Play(uint32_t animation_index, float crossfade_sec = 0.0f);
+        uint32_t GetAnimationIndex()    const { return m_animation_index; }
+        float GetTime()                 const { return static_cast<float>(m_time); }
+        void SetSpeed(float speed)            { m_speed = speed; }
+        float GetSpeed()                const { return m_speed; }
+        void SetLooping(bool looping)         { m_looping = looping; }
+        bool GetLooping()               const { return m_looping; }
+
+        // How the skin of the mesh binds to the skeleton of the model, set on import.
+        // There is an offset (mesh to bone space) per bone, and the transform from the skeleton's root to the mesh.
+        void SetBinding(const std::vector<Math::Matrix>& bone_offsets, const Math::Matrix& root_to_mesh);
+
+        // Samples, blends and skins into the vertex buffers of a frame slot, animators can be evaluated concurrently.
+        // With a palette, the vertices are left to the vertex shaders and the bone matrices are written from the palette offset on.
+        bool Evaluate(uint32_t frame_slot, Math::Matrix* palette = nullptr, uint32_t palette_offset = 0);
+        uint32_t GetBoneCount() const;
+
+        // The palette range of the last evaluation, if it was skinned on the GPU
+        bool HasPalette()                                       const { return m_evaluated_palette; }
+        uint32_t GetPaletteOffset()                             const { return m_palette_offset; }
+
+        // The skinned geometry of the last evaluation, it replaces the geometry of the renderable
+        bool HasSkinnedGeometry()                               const { return m_evaluated; }
+        const RHI_VertexBuffer* GetVertexBuffer()               const { return m_vertex_buffer.get(); }
+        const RHI_VertexBuffer* GetVertexBufferPosition()       const { return m_vertex_buffer_position.get(); }
+        uint32_t GetVertexOffset()                              const { return m_vertex_offset; }
+        const Math::Matrix& GetVertexTransform()                const { return m_vertex_transform; }
+
+    private:
+        Model* GetModel() const;
+        const Animation* GetAnimation(uint32_t index) const;
+        bool CreateBuffers();
+        double AdvanceTime(double time, uint32_t animation_index, float delta_time) const;
+
+        // Playback
+        uint32_t m_animation_index      = 0;
+        uint32_t m_animation_index_next = 0;
+        double m_time                   = 0.0;
+        double m_time_next              = 0.0;
+        float m_speed                   = 1.0f;
+        bool m_looping                  = true;
+        float m_crossfade_duration      = 0.0f;
+        float m_crossfade_time          = 0.0f;
+        bool m_crossfading              = false;
+
+        // Binding
+        std::vector<Skinning::BoneMatrix> m_bone_offsets;
+        Skinning::BoneMatrix m_root_to_mesh;
+
+        // Evaluation state
+        std::vector<Skinning::BoneTransform> m_pose;
+        std::vector<Skinning::BoneTransform> m_pose_next;
+        AnimationCompression::Cursor m_cursor;
+        AnimationCompression::Cursor m_cursor_next;
+        std::vector<Skinning::BoneMatrix> m_globals;
+        std::vector<Skinning::BoneMatrix> m_palette;
+        std::vector<RHI_Vertex_PosTexNorTan> m_vertices_skinned;
+        std::vector<Math::BoundingBox> m_bone_bounds;
+
+        // Skinned geometry, a range of vertices per frame slot
+        std::shared_ptr<RHI_VertexBuffer> m_vertex_buffer;
+        std::shared_ptr<RHI_VertexBuffer> m_vertex_buffer_position;
+        RHI_Vertex_PosTexNorTan_Packed* m_mapped            = nullptr;
+        RHI_Vertex_Pos_Packed* m_mapped_position            = nullptr;
+        uint32_t m_vertex_count                             = 0;
+        uint32_t m_slot_count                               = 0;
+        uint32_t m_vertex_offset                            = 0;
+        Math::Matrix m_vertex_transform                     = Math::Matrix::Identity;
+        bool m_evaluated                                    = false;
+        uint32_t m_palette_offset                           = 0;
+        bool m_evaluated_palette                            = false;
+    };
+}
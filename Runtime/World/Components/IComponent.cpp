@@ -19,7 +19,7 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES =============
+//= INCLUDES ==============
 #include "Spartan.h"
 #include "IComponent.h"
 #include "Light.h"
@@ -35,8 +35,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Renderable.h"
 #include "Transform.h"
 #include "Terrain.h"
+#include "Animator.h"
 #include "../Entity.h"
-//========================
+//=========================
 
 //= NAMESPACES =====
 using namespace std;
@@ -83,4 +84,5 @@ namespace Spartan
     REGISTER_COMPONENT(Environment,        ComponentType::Environment)
     REGISTER_COMPONENT(Terrain,         ComponentType::Terrain)
     REGISTER_COMPONENT(Transform,        ComponentType::Transform)
+    REGISTER_COMPONENT(Animator,         ComponentType::Animator)
 }
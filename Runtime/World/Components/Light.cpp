@@ -110,6 +110,9 @@ namespace Spartan
         // Update shadow map(s)
         if (m_shadows_enabled)
         {
+            const array<Matrix, 6> matrix_view_previous         = m_matrix_view;
+            const array<Matrix, 6> matrix_projection_previous   = m_matrix_projection;
+
             if (m_light_type == LightType::Directional)
             {
                 ComputeCascadeSplits();
@@ -125,6 +128,16 @@ namespace Spartan
                     ComputeProjectionMatrix(i);
                 }
             }
+
+            // The cached static shadows of a slice were rendered with it's previous matrices. The cascades are snapped to
+            // texels, so they only change once the camera has moved by a texel (and not with every camera movement or rotation).
+            for (uint32_t i = 0; i < static_cast<uint32_t>(m_shadow_map.slices.size()) && i < static_cast<uint32_t>(m_matrix_view.size()); i++)
+            {
+                if (m_matrix_view[i] != matrix_view_previous[i] || m_matrix_projection[i] != matrix_projection_previous[i])
+                {
+                    m_shadow_map.slices[i].static_dirty = true;
+                }
+            }
         }
 
         m_is_dirty = false;
@@ -424,6 +437,19 @@ namespace Spartan
                 // Compute min and max
                 shadow_slice.max = radius;
                 shadow_slice.min = -radius;
+
+                // Snap the center to the texels of the shadow map (in light space), so that the cascade moves in whole texels
+                const uint32_t resolution   = m_shadow_map.texture_depth ? m_shadow_map.texture_depth->GetWidth() : 0;
+                if (resolution != 0)
+                {
+                    const Matrix light_rotation = Matrix::CreateLookAtLH(Vector3::Zero, GetDirection(), Vector3::Up);
+                    const float texel_size      = (radius * 2.0f) / static_cast<float>(resolution);
+                    Vector3 center_light        = shadow_slice.center * light_rotation;
+                    center_light.x              = Helper::Floor(center_light.x / texel_size) * texel_size;
+                    center_light.y              = Helper::Floor(center_light.y / texel_size) * texel_size;
+                    center_light.z              = Helper::Floor(center_light.z / texel_size) * texel_size;
+                    shadow_slice.center         = center_light * Matrix::Invert(light_rotation);
+                }
             }
         }
     }
@@ -447,7 +473,8 @@ namespace Spartan
         // Early exit if this light casts no shadows
         if (!m_shadows_enabled)
         {
-            m_shadow_map.texture_depth = nullptr;
+            m_shadow_map.texture_depth          = nullptr;
+            m_shadow_map.texture_depth_static   = nullptr;
             return;
         }
 
@@ -458,7 +485,8 @@ namespace Spartan
 
         if (GetLightType() == LightType::Directional)
         {
-            m_shadow_map.texture_depth = make_unique<RHI_Texture2D>(m_context, resolution, resolution, RHI_Format_D32_Float, m_cascade_count);
+            m_shadow_map.texture_depth          = make_unique<RHI_Texture2D>(m_context, resolution, resolution, RHI_Format_D32_Float, m_cascade_count);
+            m_shadow_map.texture_depth_static   = make_unique<RHI_Texture2D>(m_context, resolution, resolution, RHI_Format_D32_Float, m_cascade_count);
 
             if (m_shadows_transparent_enabled)
             {
@@ -469,7 +497,8 @@ namespace Spartan
         }
         else if (GetLightType() == LightType::Point)
         {
-            m_shadow_map.texture_depth = make_unique<RHI_TextureCube>(m_context, resolution, resolution, RHI_Format_D32_Float);
+            m_shadow_map.texture_depth          = make_unique<RHI_TextureCube>(m_context, resolution, resolution, RHI_Format_D32_Float);
+            m_shadow_map.texture_depth_static   = make_unique<RHI_TextureCube>(m_context, resolution, resolution, RHI_Format_D32_Float);
 
             if (m_shadows_transparent_enabled)
             {
@@ -480,7 +509,8 @@ namespace Spartan
         }
         else if (GetLightType() == LightType::Spot)
         {
-            m_shadow_map.texture_depth  = make_unique<RHI_Texture2D>(m_context, resolution, resolution, RHI_Format_D32_Float, 1);
+            m_shadow_map.texture_depth          = make_unique<RHI_Texture2D>(m_context, resolution, resolution, RHI_Format_D32_Float, 1);
+            m_shadow_map.texture_depth_static   = make_unique<RHI_Texture2D>(m_context, resolution, resolution, RHI_Format_D32_Float, 1);
 
             if (m_shadows_transparent_enabled)
             {
@@ -491,6 +521,28 @@ namespace Spartan
         }
     }
 
+    bool Light::IsStaticShadowValid(uint32_t index, uint32_t static_casters_hash) const
+    {
+        if (index >= static_cast<uint32_t>(m_shadow_map.slices.size()))
+            return false;
+
+        const ShadowSlice& shadow_slice = m_shadow_map.slices[index];
+        return !shadow_slice.static_dirty && shadow_slice.static_casters_hash == static_casters_hash;
+    }
+
+    void Light::SetStaticShadowValid(uint32_t index, uint32_t static_casters_hash)
+    {
+        if (index >= static_cast<uint32_t>(m_shadow_map.slices.size()))
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return;
+        }
+
+        ShadowSlice& shadow_slice           = m_shadow_map.slices[index];
+        shadow_slice.static_casters_hash    = static_casters_hash;
+        shadow_slice.static_dirty           = false;
+    }
+
     bool Light::IsInViewFrustrum(Renderable* renderable, uint32_t index) const
     {
         const auto box          = renderable->GetAabb();
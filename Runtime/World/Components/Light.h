@@ -51,12 +51,17 @@ namespace Spartan
         Math::Vector3 max       = Math::Vector3::Zero;
         Math::Vector3 center    = Math::Vector3::Zero;
         Math::Frustum frustum;
+
+        // Static shadow caching
+        uint32_t static_casters_hash    = 0;
+        bool static_dirty               = true;
     };
 
     struct ShadowMap
     {
         std::shared_ptr<RHI_Texture> texture_color;
         std::shared_ptr<RHI_Texture> texture_depth;
+        std::shared_ptr<RHI_Texture> texture_depth_static; // static casters only, copied into texture_depth before the dynamic casters are rendered
         std::vector<ShadowSlice> slices;
     };
 
@@ -118,9 +123,14 @@ namespace Spartan
 
         RHI_Texture* GetDepthTexture() const { return m_shadow_map.texture_depth.get(); }
         RHI_Texture* GetColorTexture() const { return m_shadow_map.texture_color.get(); }
+        RHI_Texture* GetDepthTextureStatic() const { return m_shadow_map.texture_depth_static.get(); }
         uint32_t GetShadowArraySize() const;
         void CreateShadowMap();
 
+        // A slice of the static shadow map has to be re-rendered when the light or the static casters that it contains have changed
+        bool IsStaticShadowValid(uint32_t index, uint32_t static_casters_hash) const;
+        void SetStaticShadowValid(uint32_t index, uint32_t static_casters_hash);
+
         bool IsInViewFrustrum(Renderable* renderable, uint32_t index) const;
 
     private:
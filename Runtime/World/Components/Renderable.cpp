@@ -38,6 +38,14 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+    // Screen height fraction the bounding sphere has to drop below for each level of detail after the first
+    static const float lod_screen_sizes[] = { 0.25f, 0.125f, 0.0625f };
+
+    // Streams start with the magic and the version, older ones (version 0) start with the geometry type, which is never the magic.
+    // Version 1 added the levels of detail and the occluder flag.
+    static const uint32_t renderable_magic      = 0x53505245; // SPRE
+    static const uint32_t renderable_version    = 1;
+
     inline void build(const Geometry_Type type, Renderable* renderable)
     {    
         Model* model = new Model(renderable->GetContext());
@@ -108,13 +116,31 @@ namespace Spartan
         REGISTER_ATTRIBUTE_VALUE_VALUE(m_geometryVertexOffset,  uint32_t);
         REGISTER_ATTRIBUTE_VALUE_VALUE(m_geometryVertexCount,   uint32_t);
         REGISTER_ATTRIBUTE_VALUE_VALUE(m_geometryName,          string);
+        REGISTER_ATTRIBUTE_VALUE_VALUE(m_geometry_lods,         vector<Renderable_Lod>);
         REGISTER_ATTRIBUTE_VALUE_VALUE(m_model,                 Model*);
         REGISTER_ATTRIBUTE_VALUE_VALUE(m_bounding_box,          BoundingBox);
         REGISTER_ATTRIBUTE_GET_SET(Geometry_Type, GeometrySet,  Geometry_Type);
     }
 
+    void Renderable::OnTick(float delta_time)
+    {
+        // Count the frames for which the transform didn't change
+        if (m_static_transform != GetTransform()->GetMatrix())
+        {
+            m_static_transform      = GetTransform()->GetMatrix();
+            m_static_frame_count    = 0;
+        }
+        else if (m_static_frame_count < m_static_frame_threshold)
+        {
+            m_static_frame_count++;
+        }
+    }
+
     void Renderable::Serialize(FileStream* stream)
     {
+        stream->Write(renderable_magic);
+        stream->Write(renderable_version);
+
         // Mesh
         stream->Write(static_cast<uint32_t>(m_geometry_type));
         stream->Write(m_geometryIndexOffset);
@@ -123,9 +149,16 @@ namespace Spartan
         stream->Write(m_geometryVertexCount);
         stream->Write(m_bounding_box);
         stream->Write(m_model ? m_model->GetResourceName() : "");
+        stream->Write(static_cast<uint32_t>(m_geometry_lods.size()));
+        for (const Renderable_Lod& lod : m_geometry_lods)
+        {
+            stream->Write(lod.index_offset);
+            stream->Write(lod.index_count);
+        }
 
         // Material
         stream->Write(m_cast_shadows);
+        stream->Write(m_occluder);
         stream->Write(m_material_default);
         if (!m_material_default)
         {
@@ -135,8 +168,21 @@ namespace Spartan
 
     void Renderable::Deserialize(FileStream* stream)
     {
+        uint32_t version        = 0;
+        uint32_t geometry_type  = stream->ReadAs<uint32_t>();
+        if (geometry_type == renderable_magic)
+        {
+            version         = stream->ReadAs<uint32_t>();
+            geometry_type   = stream->ReadAs<uint32_t>();
+        }
+
+        if (version > renderable_version)
+        {
+            LOG_WARNING("Renderable was saved by a newer version (%d), it may not load correctly", version);
+        }
+
         // Geometry
-        m_geometry_type         = static_cast<Geometry_Type>(stream->ReadAs<uint32_t>());
+        m_geometry_type         = static_cast<Geometry_Type>(geometry_type);
         m_geometryIndexOffset   = stream->ReadAs<uint32_t>();
         m_geometryIndexCount    = stream->ReadAs<uint32_t>();
         m_geometryVertexOffset  = stream->ReadAs<uint32_t>();
@@ -145,6 +191,12 @@ namespace Spartan
         string model_name;
         stream->Read(&model_name);
         m_model = m_context->GetSubsystem<ResourceCache>()->GetByName<Model>(model_name).get();
+        m_geometry_lods.resize(version >= 1 ? stream->ReadAs<uint32_t>() : 0);
+        for (Renderable_Lod& lod : m_geometry_lods)
+        {
+            lod.index_offset = stream->ReadAs<uint32_t>();
+            lod.index_count  = stream->ReadAs<uint32_t>();
+        }
 
         // If it was a default mesh, we have to reconstruct it
         if (m_geometry_type != Geometry_Custom) 
@@ -154,6 +206,10 @@ namespace Spartan
 
         // Material
         stream->Read(&m_cast_shadows);
+        if (version >= 1)
+        {
+            stream->Read(&m_occluder);
+        }
         stream->Read(&m_material_default);
         if (m_material_default)
         {
@@ -182,6 +238,8 @@ namespace Spartan
         m_geometryVertexCount   = vertex_count;
         m_bounding_box          = bounding_box;
         m_model                 = model;
+        m_geometry_lods.clear();
+        m_revision++;
     }
 
     void Renderable::GeometrySet(const Geometry_Type type)
@@ -215,13 +273,35 @@ namespace Spartan
         // Updated if dirty
         if (m_last_transform != GetTransform()->GetMatrix() || !m_aabb.Defined())
         {
-            m_aabb = m_bounding_box.Transform(GetTransform()->GetMatrix());
+            m_aabb = (m_bounding_box_pose.Defined() ? m_bounding_box_pose : m_bounding_box).Transform(GetTransform()->GetMatrix());
             m_last_transform = GetTransform()->GetMatrix();
         }
 
         return m_aabb;
     }
 
+    uint32_t Renderable::GeometryLodSelect(const Matrix& view, const Matrix& projection)
+    {
+        if (m_geometry_lods.empty())
+            return 0;
+
+        const BoundingBox& aabb = GetAabb();
+        const Vector3 center    = view * aabb.GetCenter();
+        const float radius      = aabb.GetExtents().Length();
+
+        // Radius over half the screen height, the perspective divide is w (the view depth) and 1 for orthographic projections
+        const float w           = center.z * projection.m23 + projection.m33;
+        const float screen_size = radius * projection.m11 / Helper::Max(w, Helper::EPSILON);
+
+        uint32_t lod = 0;
+        while (lod < m_geometry_lods.size() && lod < size(lod_screen_sizes) && screen_size < lod_screen_sizes[lod])
+        {
+            lod++;
+        }
+
+        return lod;
+    }
+
     // All functions (set/load) resolve to this
     shared_ptr<Material> Renderable::SetMaterial(const shared_ptr<Material>& material)
     {
@@ -235,6 +315,7 @@ namespace Spartan
         shared_ptr<Material> _material = m_context->GetSubsystem<ResourceCache>()->Cache(material);
 
         m_material = _material.get();
+        m_revision++;
 
         // Set to false otherwise material won't serialize/deserialize
         m_material_default = false;
@@ -39,6 +39,13 @@ namespace Spartan
         class Vector3;
     }
 
+    // A simplified version of the geometry, it indexes the same vertices
+    struct Renderable_Lod
+    {
+        uint32_t index_offset   = 0;
+        uint32_t index_count    = 0;
+    };
+
     enum Geometry_Type
     {
         Geometry_Custom,
@@ -56,6 +63,7 @@ namespace Spartan
         ~Renderable() = default;
 
         //= ICOMPONENT ===============================
+        void OnTick(float delta_time) override;
         void Serialize(FileStream* stream) override;
         void Deserialize(FileStream* stream) override;
         //============================================
@@ -73,15 +81,24 @@ namespace Spartan
         void GeometryClear();
         void GeometrySet(Geometry_Type type);
         void GeometryGet(std::vector<uint32_t>* indices, std::vector<RHI_Vertex_PosTexNorTan>* vertices) const;
-        uint32_t GeometryIndexOffset()              const { return m_geometryIndexOffset; }
-        uint32_t GeometryIndexCount()               const { return m_geometryIndexCount; }
-        uint32_t GeometryVertexOffset()             const { return m_geometryVertexOffset; }
-        uint32_t GeometryVertexCount()              const { return m_geometryVertexCount; }
-        Geometry_Type GeometryType()                const { return m_geometry_type; }
-        const std::string& GeometryName()           const { return m_geometryName; }
-        Model* GeometryModel()                      const { return m_model; }
-        const Math::BoundingBox& GetBoundingBox()   const { return m_bounding_box; }
+        uint32_t GeometryIndexOffset(uint32_t lod = 0)  const { return lod == 0 ? m_geometryIndexOffset : m_geometry_lods[lod - 1].index_offset; }
+        uint32_t GeometryIndexCount(uint32_t lod = 0)   const { return lod == 0 ? m_geometryIndexCount  : m_geometry_lods[lod - 1].index_count; }
+        uint32_t GeometryVertexOffset()                 const { return m_geometryVertexOffset; }
+        uint32_t GeometryVertexCount()                  const { return m_geometryVertexCount; }
+        Geometry_Type GeometryType()                    const { return m_geometry_type; }
+        const std::string& GeometryName()               const { return m_geometryName; }
+        Model* GeometryModel()                          const { return m_model; }
+        const Math::BoundingBox& GetBoundingBox()       const { return m_bounding_box; }
         const Math::BoundingBox& GetAabb();
+
+        // Animated renderables are bounded by the pose they are drawn in (set by their animator every frame), an undefined box reverts to the bind pose
+        void SetBoundingBoxPose(const Math::BoundingBox& bounding_box) { m_bounding_box_pose = bounding_box; m_aabb = Math::BoundingBox(); }
+
+        // Levels of detail, level 0 is the geometry above and every level after it has fewer triangles
+        void GeometryAddLod(uint32_t index_offset, uint32_t index_count) { m_geometry_lods.push_back({ index_offset, index_count }); m_revision++; }
+        uint32_t GeometryLodCount() const { return static_cast<uint32_t>(m_geometry_lods.size()) + 1; }
+        // Picks a level by the size the bounding sphere projects to on the screen (works for perspective and orthographic projections)
+        uint32_t GeometryLodSelect(const Math::Matrix& view, const Math::Matrix& projection);
         //=====================================================================================================
 
         //= MATERIAL ====================================================================
@@ -100,6 +117,16 @@ namespace Spartan
         //= PROPERTIES ===================================================================
         void SetCastShadows(const bool cast_shadows)    { m_cast_shadows = cast_shadows; }
         auto GetCastShadows() const                     { return m_cast_shadows; }
+
+        // Occluders are rasterised by the software occlusion culling, they should be large and simple (walls, floors, etc.)
+        void SetOccluder(const bool occluder)           { m_occluder = occluder; }
+        auto IsOccluder() const                         { return m_occluder; }
+
+        // Renderables that haven't moved for a number of frames are static, the renderer caches their shadows
+        bool IsStatic() const                           { return m_static_frame_count >= m_static_frame_threshold; }
+
+        // Changes whenever the geometry or the material changes, so that what's cached from them (like shadows) can tell it's out of date
+        uint32_t GetRevision() const                    { return m_revision; }
         //================================================================================
 
     private:
@@ -109,10 +136,17 @@ namespace Spartan
         uint32_t m_geometryVertexOffset;
         uint32_t m_geometryVertexCount;
         Geometry_Type m_geometry_type;
+        std::vector<Renderable_Lod> m_geometry_lods;
         Math::BoundingBox m_bounding_box;
+        Math::BoundingBox m_bounding_box_pose;
         Math::BoundingBox m_aabb;
         Math::Matrix m_last_transform   = Math::Matrix::Identity;
+        Math::Matrix m_static_transform = Math::Matrix::Identity;
+        uint32_t m_static_frame_count   = 0;
+        static const uint32_t m_static_frame_threshold = 30;
+        uint32_t m_revision             = 0;
         bool m_cast_shadows             = true;
+        bool m_occluder                 = false;
         bool m_material_default;
         Model* m_model          = nullptr;
         Material* m_material    = nullptr;
@@ -19,7 +19,7 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES ========================
+//= INCLUDES =========================
 #include "Spartan.h"
 #include "Entity.h"
 #include "World.h"
@@ -36,8 +36,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Components/AudioSource.h"
 #include "Components/AudioListener.h"
 #include "Components/Terrain.h"
+#include "Components/Animator.h"
 #include "../IO/FileStream.h"
-//===================================
+//====================================
 
 //= NAMESPACES =====
 using namespace std;
@@ -295,6 +296,7 @@ namespace Spartan
             case ComponentType::Environment:    return AddComponent<Environment>(id);
             case ComponentType::Transform:        return AddComponent<Transform>(id);
             case ComponentType::Terrain:           return AddComponent<Terrain>(id);
+            case ComponentType::Animator:          return AddComponent<Animator>(id);
             case ComponentType::Unknown:        return nullptr;
             default:                            return nullptr;
         }